@@ -0,0 +1,317 @@
+#include "calibration_store.h"
+
+#include <android/log.h>
+#include <array>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utility>
+
+#include "file_utils.h"
+#include "hash.h"
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.Calibration";
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, kLogTag, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+namespace {
+
+constexpr char kMapMagic[8] = {'N', 'S', 'U', 'N', 'D', 'I', 'S', 'T'};
+
+// On-disk layout: [MapHeader][float coords * 2 * width * height]
+struct MapHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t key;
+    int32_t width;
+    int32_t height;
+    float intrinsics[5];
+    uint32_t payloadChecksum;
+};
+
+static_assert(sizeof(MapHeader) == 56, "MapHeader layout changed");
+
+/// Every calibration value that affects a map, in a fixed order
+std::array<float, 20> calibrationWords(const CameraCalibration& c) {
+    return {
+        c.fx, c.fy, c.cx, c.cy, c.skew,
+        c.distortion[0], c.distortion[1], c.distortion[2], c.distortion[3], c.distortion[4],
+        c.poseRotation[0], c.poseRotation[1], c.poseRotation[2], c.poseRotation[3],
+        c.poseTranslation[0], c.poseTranslation[1], c.poseTranslation[2],
+        static_cast<float>(c.activeArrayWidth), static_cast<float>(c.activeArrayHeight),
+        static_cast<float>((c.hasIntrinsics ? 1 : 0) | (c.hasDistortion ? 2 : 0))
+    };
+}
+
+bool sameCalibration(const CameraCalibration& a, const CameraCalibration& b) {
+    return calibrationWords(a) == calibrationWords(b) && a.hasPose == b.hasPose &&
+           a.poseReference == b.poseReference;
+}
+
+}  // namespace
+
+PinholeIntrinsics scaledIntrinsics(const CameraCalibration& calibration, int32_t width, int32_t height) {
+    PinholeIntrinsics out;
+    const int32_t activeWidth = calibration.activeArrayWidth;
+    const int32_t activeHeight = calibration.activeArrayHeight;
+    if (activeWidth <= 0 || activeHeight <= 0 || width <= 0 || height <= 0) {
+        return out;
+    }
+
+    // Centered crop of the active array to the stream aspect ratio
+    float scale = 0.0f;
+    float offsetX = 0.0f;
+    float offsetY = 0.0f;
+    if (static_cast<int64_t>(width) * activeHeight > static_cast<int64_t>(activeWidth) * height) {
+        scale = static_cast<float>(width) / static_cast<float>(activeWidth);
+        offsetY = 0.5f * (static_cast<float>(activeHeight) - static_cast<float>(height) / scale);
+    } else {
+        scale = static_cast<float>(height) / static_cast<float>(activeHeight);
+        offsetX = 0.5f * (static_cast<float>(activeWidth) - static_cast<float>(width) / scale);
+    }
+
+    out.fx = calibration.fx * scale;
+    out.fy = calibration.fy * scale;
+    out.cx = (calibration.cx - offsetX) * scale;
+    out.cy = (calibration.cy - offsetY) * scale;
+    out.skew = calibration.skew * scale;
+    return out;
+}
+
+std::shared_ptr<UndistortionMap> buildUndistortionMap(const CameraCalibration& calibration,
+                                                      int32_t width, int32_t height) {
+    if (!calibration.hasIntrinsics || width <= 0 || height <= 0) {
+        return nullptr;
+    }
+
+    auto map = std::make_shared<UndistortionMap>();
+    map->width = width;
+    map->height = height;
+    map->intrinsics = scaledIntrinsics(calibration, width, height);
+    map->coords.resize(2 * static_cast<size_t>(width) * static_cast<size_t>(height));
+
+    const PinholeIntrinsics& k = map->intrinsics;
+    const float invFy = 1.0f / k.fy;
+    const float invFx = 1.0f / k.fx;
+
+    float* out = map->coords.data();
+    for (int32_t v = 0; v < height; ++v) {
+        const float y = (static_cast<float>(v) - k.cy) * invFy;
+        for (int32_t u = 0; u < width; ++u) {
+            const float x = (static_cast<float>(u) - k.cx - k.skew * y) * invFx;
+            projectDistorted(calibration, k, x, y, out[0], out[1]);
+            out += 2;
+        }
+    }
+    return map;
+}
+
+CalibrationStore::CalibrationStore(std::string cacheDir, std::string fingerprint)
+    : cacheDir_(std::move(cacheDir)),
+      fingerprintHash_(fnv1a64(fingerprint)) {}
+
+void CalibrationStore::update(const std::vector<CameraInfo>& cameras) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unordered_map<std::string, CameraCalibration> next;
+    for (const auto& camera : cameras) {
+        next.emplace(camera.id, camera.calibration);
+    }
+
+    for (auto it = maps_.begin(); it != maps_.end();) {
+        const auto found = next.find(it->second.cameraId);
+        const auto previous = calibrations_.find(it->second.cameraId);
+        const bool unchanged = found != next.end() && previous != calibrations_.end() &&
+                               sameCalibration(found->second, previous->second);
+        it = unchanged ? std::next(it) : maps_.erase(it);
+    }
+
+    bool changed = next.size() != calibrations_.size();
+    for (const auto& [id, calibration] : next) {
+        const auto previous = calibrations_.find(id);
+        changed = changed || previous == calibrations_.end() ||
+                  !sameCalibration(calibration, previous->second);
+    }
+    if (changed) {
+        ++generation_;
+    }
+
+    size_t withIntrinsics = 0;
+    for (const auto& [id, calibration] : next) {
+        withIntrinsics += calibration.hasIntrinsics ? 1 : 0;
+    }
+    calibrations_ = std::move(next);
+    LOGI("Calibration for %zu cameras (%zu with intrinsics)", calibrations_.size(), withIntrinsics);
+}
+
+std::optional<CameraCalibration> CalibrationStore::calibration(const std::string& cameraId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = calibrations_.find(cameraId);
+    if (it == calibrations_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::optional<RigidTransform> CalibrationStore::imuFromCamera(const std::string& cameraId) const {
+    const auto calib = calibration(cameraId);
+    if (!calib || !calib->hasPose || calib->poseReference != LensPoseReference::Gyroscope) {
+        return std::nullopt;
+    }
+
+    // The HAL reports the rotation from the reference frame into the camera frame
+    const Quat cameraFromImu = normalized(Quat{calib->poseRotation[3], calib->poseRotation[0],
+                                               calib->poseRotation[1], calib->poseRotation[2]});
+    RigidTransform transform;
+    transform.rotation = conjugate(cameraFromImu);
+    transform.translation = {calib->poseTranslation[0], calib->poseTranslation[1],
+                             calib->poseTranslation[2]};
+    return transform;
+}
+
+std::shared_ptr<const UndistortionMap> CalibrationStore::undistortionMap(
+        const std::string& cameraId, int32_t width, int32_t height) {
+    // Built under the lock: generation is a one-off per stream size and a
+    // concurrent caller wants the same map anyway
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto calib = calibrations_.find(cameraId);
+    if (calib == calibrations_.end() || !calib->second.hasIntrinsics) {
+        return nullptr;
+    }
+
+    const uint64_t key = mapKey(cameraId, calib->second, width, height);
+    if (const auto cached = maps_.find(key); cached != maps_.end()) {
+        return cached->second.map;
+    }
+
+    std::shared_ptr<UndistortionMap> map = loadMap(key, width, height);
+    if (map) {
+        LOGI("Loaded undistortion map for camera %s (%dx%d)", cameraId.c_str(), width, height);
+    } else {
+        map = buildUndistortionMap(calib->second, width, height);
+        if (!map) {
+            return nullptr;
+        }
+        LOGI("Built undistortion map for camera %s (%dx%d)", cameraId.c_str(), width, height);
+        storeMap(key, *map);
+    }
+
+    maps_[key] = {cameraId, map};
+    return map;
+}
+
+size_t CalibrationStore::cameraCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return calibrations_.size();
+}
+
+uint64_t CalibrationStore::generation() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+}
+
+uint64_t CalibrationStore::mapKey(const std::string& cameraId, const CameraCalibration& calibration,
+                                  int32_t width, int32_t height) const {
+    const auto words = calibrationWords(calibration);
+    const int32_t dims[3] = {width, height, static_cast<int32_t>(kMapFormatVersion)};
+    uint64_t key = fnv1a64(cameraId, fingerprintHash_);
+    key = fnv1a64(words.data(), sizeof(words), key);
+    return fnv1a64(dims, sizeof(dims), key);
+}
+
+std::string CalibrationStore::mapPath(uint64_t key) const {
+    char name[40];
+    std::snprintf(name, sizeof(name), "/undistort_%016" PRIx64 ".bin", key);
+    return cacheDir_ + name;
+}
+
+std::shared_ptr<UndistortionMap> CalibrationStore::loadMap(uint64_t key, int32_t width,
+                                                           int32_t height) const {
+    if (cacheDir_.empty()) {
+        return nullptr;
+    }
+    const std::string path = mapPath(key);
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    auto map = std::make_shared<UndistortionMap>();
+    MapHeader header{};
+    bool ok = readAll(fd, &header, sizeof(header)) &&
+              std::memcmp(header.magic, kMapMagic, sizeof(kMapMagic)) == 0 &&
+              header.version == kMapFormatVersion &&
+              header.headerSize == sizeof(MapHeader) &&
+              header.key == key && header.width == width && header.height == height;
+    if (ok) {
+        map->width = width;
+        map->height = height;
+        map->intrinsics = {header.intrinsics[0], header.intrinsics[1], header.intrinsics[2],
+                           header.intrinsics[3], header.intrinsics[4]};
+        map->coords.resize(2 * static_cast<size_t>(width) * static_cast<size_t>(height));
+        const size_t bytes = map->coords.size() * sizeof(float);
+        char extra = 0;
+        ok = readAll(fd, map->coords.data(), bytes) &&
+             ::read(fd, &extra, 1) == 0 &&
+             fnv1a32(reinterpret_cast<const uint8_t*>(map->coords.data()), bytes) ==
+                 header.payloadChecksum;
+    }
+    ::close(fd);
+
+    if (!ok) {
+        LOGW("Undistortion map %s invalid, rebuilding", path.c_str());
+        ::unlink(path.c_str());
+        return nullptr;
+    }
+    return map;
+}
+
+bool CalibrationStore::storeMap(uint64_t key, const UndistortionMap& map) const {
+    if (cacheDir_.empty()) {
+        return false;
+    }
+
+    const size_t bytes = map.coords.size() * sizeof(float);
+    MapHeader header{};
+    std::memcpy(header.magic, kMapMagic, sizeof(kMapMagic));
+    header.version = kMapFormatVersion;
+    header.headerSize = sizeof(MapHeader);
+    header.key = key;
+    header.width = map.width;
+    header.height = map.height;
+    const PinholeIntrinsics& k = map.intrinsics;
+    const float intrinsics[5] = {k.fx, k.fy, k.cx, k.cy, k.skew};
+    std::memcpy(header.intrinsics, intrinsics, sizeof(intrinsics));
+    header.payloadChecksum = fnv1a32(reinterpret_cast<const uint8_t*>(map.coords.data()), bytes);
+
+    // Temp file plus rename: a concurrent reader never sees a partial map
+    const std::string path = mapPath(key);
+    const std::string tmpPath = path + ".tmp";
+    const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        LOGE("Failed to create %s", tmpPath.c_str());
+        return false;
+    }
+
+    const bool ok = writeAll(fd, &header, sizeof(header)) &&
+                    writeAll(fd, map.coords.data(), bytes) &&
+                    ::fsync(fd) == 0;
+    ::close(fd);
+
+    if (!ok || ::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        LOGE("Failed to write undistortion map %s", path.c_str());
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace nativesensor
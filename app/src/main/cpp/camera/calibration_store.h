@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "camera_data.h"
+#include "geometry.h"
+
+namespace nativesensor {
+
+/// Pinhole intrinsics of one output stream, in stream pixels
+struct PinholeIntrinsics {
+    float fx = 0.0f;
+    float fy = 0.0f;
+    float cx = 0.0f;
+    float cy = 0.0f;
+    float skew = 0.0f;
+};
+
+/// Per-pixel sampling positions that undistort a stream of one camera.
+/// Entry (x, y) holds the distorted source position to sample for output
+/// pixel (x, y) of an ideal pinhole image with `intrinsics`.
+struct UndistortionMap {
+    int32_t width = 0;
+    int32_t height = 0;
+    PinholeIntrinsics intrinsics;
+    std::vector<float> coords;      // Interleaved (srcX, srcY), row-major
+};
+
+/// Pixel position of the normalized image point (x, y) = (X/Z, Y/Z) under
+/// the ACAMERA_LENS_DISTORTION model ([k1, k2, k3, p1, p2], Brown-Conrady)
+inline void projectDistorted(const CameraCalibration& calibration, const PinholeIntrinsics& k,
+                             float x, float y, float& u, float& v) {
+    float xd = x;
+    float yd = y;
+    if (calibration.hasDistortion) {
+        const float* d = calibration.distortion;
+        const float r2 = x * x + y * y;
+        const float radial = 1.0f + r2 * (d[0] + r2 * (d[1] + r2 * d[2]));
+        xd = x * radial + 2.0f * d[3] * x * y + d[4] * (r2 + 2.0f * x * x);
+        yd = y * radial + d[3] * (r2 + 2.0f * y * y) + 2.0f * d[4] * x * y;
+    }
+    u = k.fx * xd + k.skew * yd + k.cx;
+    v = k.fy * yd + k.cy;
+}
+
+/// Intrinsics for a width x height stream. The camera crops the active array
+/// to the stream's aspect ratio around its center, then scales.
+[[nodiscard]]
+PinholeIntrinsics scaledIntrinsics(const CameraCalibration& calibration, int32_t width, int32_t height);
+
+/// Evaluate the ACAMERA_LENS_DISTORTION model for every output pixel
+[[nodiscard]]
+std::shared_ptr<UndistortionMap> buildUndistortionMap(const CameraCalibration& calibration,
+                                                      int32_t width, int32_t height);
+
+/// Per-device store of camera calibration (intrinsics, distortion, lens pose)
+/// and lazily generated undistortion maps.
+///
+/// Maps are built on first request for a (camera, stream size) pair, kept in
+/// memory and persisted under the cache directory keyed by device fingerprint
+/// and calibration, so later sessions load them instead of recomputing.
+/// Thread-safe.
+class CalibrationStore {
+public:
+    /// Bump whenever the map file layout or the distortion model changes
+    static constexpr uint32_t kMapFormatVersion = 1;
+
+    /// @param cacheDir Directory for persisted maps; empty keeps them in memory only
+    /// @param fingerprint Device/build fingerprint the maps are keyed by
+    CalibrationStore(std::string cacheDir, std::string fingerprint);
+
+    CalibrationStore(const CalibrationStore&) = delete;
+    CalibrationStore& operator=(const CalibrationStore&) = delete;
+
+    /// Replace the calibration set from an enumeration; maps of cameras whose
+    /// calibration changed are dropped
+    void update(const std::vector<CameraInfo>& cameras);
+
+    [[nodiscard]]
+    std::optional<CameraCalibration> calibration(const std::string& cameraId) const;
+
+    /// Camera pose in the IMU (gyroscope) frame, if the HAL reports lens pose
+    /// relative to the gyroscope. Camera axes: x along the sensor's long side,
+    /// y along the short side, z along the optical axis.
+    [[nodiscard]]
+    std::optional<RigidTransform> imuFromCamera(const std::string& cameraId) const;
+
+    /// Undistortion map for a stream size; nullptr if the camera has no
+    /// intrinsics. Built (or loaded from disk) on first use, shared afterwards.
+    [[nodiscard]]
+    std::shared_ptr<const UndistortionMap> undistortionMap(const std::string& cameraId,
+                                                           int32_t width, int32_t height);
+
+    [[nodiscard]]
+    size_t cameraCount() const;
+
+    /// Incremented whenever update() changes any camera's calibration, so
+    /// consumers can cheaply tell when derived data must be rebuilt
+    [[nodiscard]]
+    uint64_t generation() const;
+
+private:
+    [[nodiscard]] uint64_t mapKey(const std::string& cameraId, const CameraCalibration& calibration,
+                                  int32_t width, int32_t height) const;
+    [[nodiscard]] std::string mapPath(uint64_t key) const;
+    [[nodiscard]] std::shared_ptr<UndistortionMap> loadMap(uint64_t key, int32_t width,
+                                                           int32_t height) const;
+    bool storeMap(uint64_t key, const UndistortionMap& map) const;
+
+    const std::string cacheDir_;
+    const uint64_t fingerprintHash_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, CameraCalibration> calibrations_;
+    uint64_t generation_ = 0;
+    struct CachedMap {
+        std::string cameraId;
+        std::shared_ptr<const UndistortionMap> map;
+    };
+    std::unordered_map<uint64_t, CachedMap> maps_;
+};
+
+}  // namespace nativesensor
@@ -22,6 +22,39 @@ enum class CameraFacing : int32_t {
     External = 2
 };
 
+/// Reference frame of ACAMERA_LENS_POSE_* (matches the NDK enum)
+enum class LensPoseReference : int32_t {
+    PrimaryCamera = 0,  // Relative to the primary camera of the same facing
+    Gyroscope = 1,      // Relative to the gyroscope (IMU extrinsics)
+    Undefined = 2,
+    Automotive = 3
+};
+
+/// Static lens calibration reported by the camera HAL.
+/// Intrinsics are in pixels of the pre-correction active array; use
+/// scaledIntrinsics() for a specific output stream size.
+struct CameraCalibration {
+    // ACAMERA_LENS_INTRINSIC_CALIBRATION: [fx, fy, cx, cy, s]
+    float fx = 0.0f;
+    float fy = 0.0f;
+    float cx = 0.0f;
+    float cy = 0.0f;
+    float skew = 0.0f;
+    // ACAMERA_LENS_DISTORTION: radial k1..k3, tangential p1, p2
+    float distortion[5] = {};
+    // ACAMERA_LENS_POSE_*: rotation from the reference frame into the camera
+    // frame as (x, y, z, w), and the optical center in the reference frame (m)
+    float poseRotation[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    float poseTranslation[3] = {};
+    LensPoseReference poseReference = LensPoseReference::Undefined;
+    // ACAMERA_SENSOR_INFO_PRE_CORRECTION_ACTIVE_ARRAY_SIZE
+    int32_t activeArrayWidth = 0;
+    int32_t activeArrayHeight = 0;
+    bool hasIntrinsics = false;
+    bool hasDistortion = false;
+    bool hasPose = false;
+};
+
 /// Camera metadata for enumeration and display
 struct CameraInfo {
     std::string id;
@@ -32,6 +65,7 @@ struct CameraInfo {
     int32_t maxFps = 0;
     bool isPhysicalCamera = false;
     std::string physicalCameraIds;  // Comma-separated for logical cameras
+    CameraCalibration calibration;
 };
 
 /// Camera frame statistics
@@ -43,12 +77,42 @@ struct CameraStats {
 };
 
 /// Frame metadata passed with each captured frame
-struct [[maybe_unused]] FrameMetadata {
-    [[maybe_unused]] int64_t timestampNs = 0;
+struct FrameMetadata {
+    std::string cameraId;
+    int64_t timestampNs = 0;    // ACAMERA_SENSOR_TIMESTAMP (start of exposure)
     int32_t width = 0;
     int32_t height = 0;
-    [[maybe_unused]] int32_t format = 0;
-    [[maybe_unused]] int64_t frameNumber = 0;
+    int32_t format = 0;
+    int64_t frameNumber = 0;
+    int64_t exposureTimeNs = 0; // ACAMERA_SENSOR_EXPOSURE_TIME (0 = unknown)
+    int64_t rollingShutterSkewNs = 0; // ACAMERA_SENSOR_ROLLING_SHUTTER_SKEW, first to last row (0 = unknown)
+    float motionBlurPx = -1.0f; // Gyro-estimated blur, set by MotionBlurGate (< 0 = not scored)
+    int64_t resultNs = 0;       // Boot time the capture result arrived (0 = unknown)
 };
 
+/// Fixed-size digest of FrameMetadata for lock-free latest-value mailboxes
+struct FrameInfo {
+    char cameraId[16] = {};     // Truncated, NUL-terminated
+    int64_t timestampNs = 0;
+    int64_t frameNumber = 0;
+    int64_t exposureTimeNs = 0;
+    int64_t resultNs = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t format = 0;
+};
+
+inline FrameInfo toFrameInfo(const FrameMetadata& frame) noexcept {
+    FrameInfo info;
+    frame.cameraId.copy(info.cameraId, sizeof(info.cameraId) - 1);
+    info.timestampNs = frame.timestampNs;
+    info.frameNumber = frame.frameNumber;
+    info.exposureTimeNs = frame.exposureTimeNs;
+    info.resultNs = frame.resultNs;
+    info.width = frame.width;
+    info.height = frame.height;
+    info.format = frame.format;
+    return info;
+}
+
 }  // namespace nativesensor
@@ -46,8 +46,12 @@ CameraManager::~CameraManager() {
     }
 }
 
-std::vector<CameraInfo> CameraManager::enumerateCameras() {
+std::vector<CameraInfo> CameraManager::enumerateCameras(bool forceRefresh) {
     std::lock_guard<std::mutex> lock(mutex_);
+    if (cameraCacheValid_ && !forceRefresh) {
+        return cameraCache_;
+    }
+
     std::vector<CameraInfo> cameras;
 
     if (!cameraManager_) {
@@ -74,18 +78,29 @@ std::vector<CameraInfo> CameraManager::enumerateCameras() {
             info.clusterType = classifyCamera(info, id);
             cameras.push_back(std::move(info));
 
-            LOGI("Camera[%d]: id=%s, %dx%d@%dfps, facing=%d, cluster=%d",
-                 i, id, info.width, info.height, info.maxFps,
-                 static_cast<int>(info.facing), static_cast<int>(info.clusterType));
+            const CameraInfo& added = cameras.back();
+            LOGI("Camera[%d]: id=%s, %dx%d@%dfps, facing=%d, cluster=%d, calibration=%d/%d/%d",
+                 i, id, added.width, added.height, added.maxFps,
+                 static_cast<int>(added.facing), static_cast<int>(added.clusterType),
+                 added.calibration.hasIntrinsics, added.calibration.hasDistortion,
+                 added.calibration.hasPose);
         } else {
             LOGW("Skipping invalid camera %s (resolution %dx%d)", id, info.width, info.height);
         }
     }
 
     ACameraManager_deleteCameraIdList(cameraIds);
+    cameraCache_ = cameras;
+    cameraCacheValid_ = true;
     return cameras;
 }
 
+void CameraManager::seedCache(std::vector<CameraInfo> cameras) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cameraCache_ = std::move(cameras);
+    cameraCacheValid_ = true;
+}
+
 bool CameraManager::queryCharacteristics(const char* cameraId, CameraInfo& outInfo) {
     ACameraMetadata* metadata = nullptr;
     camera_status_t status = ACameraManager_getCameraCharacteristics(
@@ -158,12 +173,16 @@ bool CameraManager::queryCharacteristics(const char* cameraId, CameraInfo& outIn
         outInfo.isPhysicalCamera = false;
         // Parse null-separated physical camera IDs
         std::string ids;
-        const char* ptr = reinterpret_cast<const char*>(physicalEntry.data.u8);
-        for (uint32_t j = 0; j < physicalEntry.count; ++j) {
-            if (ptr[j] == '\0' && j + 1 < physicalEntry.count) {
-                if (!ids.empty()) ids += ",";
-                ids += std::string(ptr);
-                ptr = reinterpret_cast<const char*>(physicalEntry.data.u8) + j + 1;
+        const char* base = reinterpret_cast<const char*>(physicalEntry.data.u8);
+        uint32_t start = 0;
+        for (uint32_t j = 0; j <= physicalEntry.count; ++j) {
+            // The last id may lack its terminator
+            if (j == physicalEntry.count || base[j] == '\0') {
+                if (j > start) {
+                    if (!ids.empty()) ids += ",";
+                    ids.append(base + start, j - start);
+                }
+                start = j + 1;
             }
         }
         if (!ids.empty()) {
@@ -173,10 +192,61 @@ bool CameraManager::queryCharacteristics(const char* cameraId, CameraInfo& outIn
         outInfo.isPhysicalCamera = true;  // No physical IDs = this is a physical camera
     }
 
+    queryCalibration(metadata, outInfo.calibration);
+
     ACameraMetadata_free(metadata);
     return outInfo.width > 0 && outInfo.height > 0;
 }
 
+void CameraManager::queryCalibration(const ACameraMetadata* metadata,
+                                     CameraCalibration& outCalibration) {
+    ACameraMetadata_const_entry entry;
+
+    if (ACameraMetadata_getConstEntry(metadata,
+            ACAMERA_SENSOR_INFO_PRE_CORRECTION_ACTIVE_ARRAY_SIZE, &entry) == ACAMERA_OK &&
+        entry.count >= 4) {
+        // (left, top, width, height); intrinsics are relative to this rectangle
+        outCalibration.activeArrayWidth = entry.data.i32[2];
+        outCalibration.activeArrayHeight = entry.data.i32[3];
+    }
+
+    if (ACameraMetadata_getConstEntry(metadata,
+            ACAMERA_LENS_INTRINSIC_CALIBRATION, &entry) == ACAMERA_OK && entry.count >= 5) {
+        outCalibration.fx = entry.data.f[0];
+        outCalibration.fy = entry.data.f[1];
+        outCalibration.cx = entry.data.f[2];
+        outCalibration.cy = entry.data.f[3];
+        outCalibration.skew = entry.data.f[4];
+        outCalibration.hasIntrinsics = outCalibration.fx > 0.0f && outCalibration.fy > 0.0f &&
+                                       outCalibration.activeArrayWidth > 0 &&
+                                       outCalibration.activeArrayHeight > 0;
+    }
+
+    if (ACameraMetadata_getConstEntry(metadata, ACAMERA_LENS_DISTORTION, &entry) == ACAMERA_OK &&
+        entry.count >= 5) {
+        std::copy(entry.data.f, entry.data.f + 5, outCalibration.distortion);
+        outCalibration.hasDistortion = true;
+    }
+
+    ACameraMetadata_const_entry translation;
+    if (ACameraMetadata_getConstEntry(metadata, ACAMERA_LENS_POSE_ROTATION, &entry) == ACAMERA_OK &&
+        entry.count >= 4 &&
+        ACameraMetadata_getConstEntry(metadata,
+            ACAMERA_LENS_POSE_TRANSLATION, &translation) == ACAMERA_OK &&
+        translation.count >= 3) {
+        std::copy(entry.data.f, entry.data.f + 4, outCalibration.poseRotation);
+        std::copy(translation.data.f, translation.data.f + 3, outCalibration.poseTranslation);
+        outCalibration.hasPose = true;
+
+        // Before API 28 the reference was always the primary camera
+        outCalibration.poseReference = LensPoseReference::PrimaryCamera;
+        if (ACameraMetadata_getConstEntry(metadata,
+                ACAMERA_LENS_POSE_REFERENCE, &entry) == ACAMERA_OK && entry.count >= 1) {
+            outCalibration.poseReference = static_cast<LensPoseReference>(entry.data.u8[0]);
+        }
+    }
+}
+
 CameraClusterType CameraManager::classifyCamera(const CameraInfo& info, const std::string& id) {
     std::string lowerId = toLower(id);
 
@@ -21,9 +21,14 @@ public:
     CameraManager(const CameraManager&) = delete;
     CameraManager& operator=(const CameraManager&) = delete;
 
-    /// Enumerate all available cameras with metadata
+    /// Enumerate all available cameras with metadata.
+    /// Results are cached after the first successful enumeration.
+    /// @param forceRefresh Re-query ACameraManager instead of using the cache
     [[nodiscard]]
-    std::vector<CameraInfo> enumerateCameras();
+    std::vector<CameraInfo> enumerateCameras(bool forceRefresh = false);
+
+    /// Pre-populate the enumeration cache (e.g. from the persistent capability cache)
+    void seedCache(std::vector<CameraInfo> cameras);
 
     /// Get the native camera manager handle (for CameraStream use)
     [[nodiscard]]
@@ -40,8 +45,13 @@ private:
     /// Query camera characteristics
     bool queryCharacteristics(const char* cameraId, CameraInfo& outInfo);
 
+    /// Read lens intrinsics, distortion and pose tags (all optional)
+    static void queryCalibration(const ACameraMetadata* metadata, CameraCalibration& outCalibration);
+
     ACameraManager* cameraManager_ = nullptr;
     std::mutex mutex_;
+    std::vector<CameraInfo> cameraCache_;
+    bool cameraCacheValid_ = false;
 };
 
 }  // namespace nativesensor
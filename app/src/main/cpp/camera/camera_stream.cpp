@@ -1,6 +1,8 @@
 #include "camera_stream.h"
 
 #include <android/log.h>
+#include <algorithm>
+#include <cstring>
 #include <ctime>
 
 namespace {
@@ -49,6 +51,10 @@ bool CameraStream::startPreview(const std::string& cameraId,
     if (streaming_.load(std::memory_order_acquire)) {
         LOGI("Switching from camera %s to %s", currentCameraId_.c_str(), cameraId.c_str());
         cleanup();
+    } else if (cameraDevice_) {
+        // Disconnected or failed: the device callbacks only flag it, we still hold the handles
+        LOGI("Releasing lost camera %s", currentCameraId_.c_str());
+        cleanup();
     }
 
     if (!manager_.isValid()) {
@@ -67,6 +73,16 @@ bool CameraStream::startPreview(const std::string& cameraId,
     ANativeWindow_acquire(surface_);
     statsCallback_ = std::move(statsCallback);
     currentCameraId_ = cameraId;
+    {
+        std::lock_guard<std::mutex> frameLock(frameCallbackMutex_);
+        frameTemplate_ = FrameMetadata{};
+        frameTemplate_.cameraId = cameraId;
+        frameTemplate_.width = ANativeWindow_getWidth(surface_);
+        frameTemplate_.height = ANativeWindow_getHeight(surface_);
+        frameTemplate_.format = ANativeWindow_getFormat(surface_);
+        exposures_ = {};
+        nextExposure_ = 0;
+    }
 
     // Reset statistics
     frameCount_.store(0, std::memory_order_release);
@@ -148,6 +164,14 @@ bool CameraStream::startPreview(const std::string& cameraId,
         return false;
     }
 
+    // Optional CPU analysis output; preview still runs if it can't be added
+    if (analysisPool_ && !addAnalysisOutput()) {
+        LOGW("Analysis output unavailable for camera %s, preview only", cameraId.c_str());
+    }
+    if (stillWidth_ > 0 && stillHeight_ > 0 && !addStillOutput()) {
+        LOGW("Still output unavailable for camera %s", cameraId.c_str());
+    }
+
     // Setup session callbacks
     sessionCallbacks_.context = this;
     sessionCallbacks_.onClosed = onSessionClosed;
@@ -197,10 +221,148 @@ bool CameraStream::startPreview(const std::string& cameraId,
     return true;
 }
 
+bool CameraStream::addAnalysisOutput() {
+    constexpr int32_t kMaxImages = 4;
+    media_status_t mediaStatus = AImageReader_new(analysisPool_->width(), analysisPool_->height(),
+                                                  AIMAGE_FORMAT_YUV_420_888, kMaxImages,
+                                                  &analysisReader_);
+    if (mediaStatus != AMEDIA_OK || !analysisReader_) {
+        LOGE("Failed to create analysis image reader: %d", mediaStatus);
+        return false;
+    }
+
+    analysisListener_.context = this;
+    analysisListener_.onImageAvailable = onImageAvailable;
+    AImageReader_setImageListener(analysisReader_, &analysisListener_);
+
+    ANativeWindow* window = nullptr;
+    if (AImageReader_getWindow(analysisReader_, &window) != AMEDIA_OK || !window) {
+        LOGE("Failed to get analysis reader window");
+        return false;
+    }
+
+    // The window is owned by the reader; released with AImageReader_delete
+    if (ACameraOutputTarget_create(window, &analysisTarget_) != ACAMERA_OK ||
+        ACaptureRequest_addTarget(captureRequest_, analysisTarget_) != ACAMERA_OK ||
+        ACaptureSessionOutput_create(window, &analysisOutput_) != ACAMERA_OK ||
+        ACaptureSessionOutputContainer_add(outputContainer_, analysisOutput_) != ACAMERA_OK) {
+        LOGE("Failed to attach analysis output");
+        return false;
+    }
+
+    analysisFrameNumber_ = 0;
+    LOGI("Analysis output %dx%d attached", analysisPool_->width(), analysisPool_->height());
+    return true;
+}
+
+bool CameraStream::addStillOutput() {
+    // One JPEG in flight to the listener plus one being captured
+    constexpr int32_t kMaxImages = 2;
+    constexpr uint8_t kJpegQuality = 90;
+    media_status_t mediaStatus = AImageReader_new(stillWidth_, stillHeight_, AIMAGE_FORMAT_JPEG,
+                                                  kMaxImages, &stillReader_);
+    if (mediaStatus != AMEDIA_OK || !stillReader_) {
+        LOGE("Failed to create still image reader: %d", mediaStatus);
+        return false;
+    }
+
+    stillListener_.context = this;
+    stillListener_.onImageAvailable = onStillAvailable;
+    stillCaptureCallbacks_ = {};
+    stillCaptureCallbacks_.context = this;
+    stillCaptureCallbacks_.onCaptureFailed = onStillFailed;
+    stillCaptureCallbacks_.onCaptureSequenceAborted = onStillSequenceAborted;
+    stillCaptureCallbacks_.onCaptureBufferLost = onStillBufferLost;
+    AImageReader_setImageListener(stillReader_, &stillListener_);
+
+    ANativeWindow* window = nullptr;
+    if (AImageReader_getWindow(stillReader_, &window) != AMEDIA_OK || !window) {
+        LOGE("Failed to get still reader window");
+        return false;
+    }
+
+    // Own request so the repeating request never targets the JPEG stream
+    if (ACameraOutputTarget_create(window, &stillTarget_) != ACAMERA_OK ||
+        ACameraDevice_createCaptureRequest(cameraDevice_, TEMPLATE_STILL_CAPTURE, &stillRequest_) != ACAMERA_OK ||
+        ACaptureRequest_addTarget(stillRequest_, stillTarget_) != ACAMERA_OK ||
+        ACaptureSessionOutput_create(window, &stillOutput_) != ACAMERA_OK ||
+        ACaptureSessionOutputContainer_add(outputContainer_, stillOutput_) != ACAMERA_OK) {
+        LOGE("Failed to attach still output");
+        return false;
+    }
+    ACaptureRequest_setEntry_u8(stillRequest_, ACAMERA_JPEG_QUALITY, 1, &kJpegQuality);
+
+    LOGI("Still output %dx%d attached", stillWidth_, stillHeight_);
+    return true;
+}
+
+void CameraStream::setStillOutput(int32_t width, int32_t height) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stillWidth_ = width;
+    stillHeight_ = height;
+}
+
+bool CameraStream::captureStill(StillCallback onStill) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!streaming_.load(std::memory_order_acquire) || !stillRequest_ || !stillOutput_) {
+        return false;
+    }
+
+    // Queued first: the JPEG can arrive before capture() returns. Not held
+    // across capture(), which may wait on the threads delivering stills.
+    uint64_t ticket = 0;
+    {
+        std::lock_guard<std::mutex> stillLock(stillMutex_);
+        ticket = nextStillTicket_++;
+        pendingStills_.push_back({ticket, kUnknownSequence, std::move(onStill)});
+    }
+    int sequenceId = kUnknownSequence;
+    const camera_status_t status = ACameraCaptureSession_capture(
+        captureSession_, &stillCaptureCallbacks_, 1, &stillRequest_, &sequenceId);
+
+    StillCallback failed;
+    {
+        std::lock_guard<std::mutex> stillLock(stillMutex_);
+        const auto it = std::find_if(pendingStills_.begin(), pendingStills_.end(),
+                                     [ticket](const PendingStill& still) { return still.ticket == ticket; });
+        const auto unclaimed = std::find(unclaimedFailures_.begin(), unclaimedFailures_.end(), sequenceId);
+        const bool failedEarly = status == ACAMERA_OK && unclaimed != unclaimedFailures_.end();
+        unclaimedFailures_.clear();
+        if (status != ACAMERA_OK) {
+            LOGE("Failed to capture still: %d", status);
+            if (it != pendingStills_.end()) {
+                pendingStills_.erase(it);
+            }
+            return false;
+        }
+        if (it == pendingStills_.end()) {
+            return true;    // Already delivered or failed
+        }
+        if (failedEarly) {
+            failed = std::move(it->callback);
+            pendingStills_.erase(it);
+        } else {
+            it->sequenceId = sequenceId;
+        }
+    }
+    if (failed) {
+        failed(nullptr, 0, 0);
+    }
+    return true;
+}
+
+void CameraStream::setAnalysisOutput(std::shared_ptr<FramePool> pool, AnalysisFrameCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> frameLock(frameCallbackMutex_);
+    analysisPool_ = std::move(pool);
+    analysisCallback_ = std::move(callback);
+}
+
 void CameraStream::stopPreview() {
     std::lock_guard<std::mutex> lock(mutex_);
     
-    if (!streaming_.load(std::memory_order_acquire)) {
+    // A disconnected or failed device is no longer streaming but still holds its handles
+    if (!streaming_.load(std::memory_order_acquire) && !cameraDevice_) {
         return;
     }
 
@@ -223,10 +385,56 @@ void CameraStream::cleanup() {
     }
 
     if (captureRequest_) {
+        if (analysisTarget_) {
+            ACaptureRequest_removeTarget(captureRequest_, analysisTarget_);
+        }
         ACaptureRequest_free(captureRequest_);
         captureRequest_ = nullptr;
     }
 
+    if (analysisTarget_) {
+        ACameraOutputTarget_free(analysisTarget_);
+        analysisTarget_ = nullptr;
+    }
+
+    if (analysisOutput_) {
+        if (outputContainer_) {
+            ACaptureSessionOutputContainer_remove(outputContainer_, analysisOutput_);
+        }
+        ACaptureSessionOutput_free(analysisOutput_);
+        analysisOutput_ = nullptr;
+    }
+
+    if (analysisReader_) {
+        // Blocks until a running onImageAvailable returned
+        AImageReader_delete(analysisReader_);
+        analysisReader_ = nullptr;
+    }
+
+    if (stillRequest_) {
+        ACaptureRequest_free(stillRequest_);
+        stillRequest_ = nullptr;
+    }
+
+    if (stillTarget_) {
+        ACameraOutputTarget_free(stillTarget_);
+        stillTarget_ = nullptr;
+    }
+
+    if (stillOutput_) {
+        if (outputContainer_) {
+            ACaptureSessionOutputContainer_remove(outputContainer_, stillOutput_);
+        }
+        ACaptureSessionOutput_free(stillOutput_);
+        stillOutput_ = nullptr;
+    }
+
+    if (stillReader_) {
+        AImageReader_delete(stillReader_);
+        stillReader_ = nullptr;
+    }
+    failPendingStills();
+
     if (outputTarget_) {
         ACameraOutputTarget_free(outputTarget_);
         outputTarget_ = nullptr;
@@ -265,6 +473,11 @@ CameraStats CameraStream::getStats() const {
     return stats;
 }
 
+void CameraStream::setFrameCallback(FrameCallback callback) {
+    std::lock_guard<std::mutex> lock(frameCallbackMutex_);
+    frameCallback_ = std::move(callback);
+}
+
 void CameraStream::updateStats(int64_t timestampNs) {
     const int64_t now = getBootTimeNs();
     frameCount_.fetch_add(1, std::memory_order_relaxed);
@@ -329,9 +542,213 @@ void CameraStream::onCaptureStarted(void* context, ACameraCaptureSession* /*sess
     self->updateStats(timestamp);
 }
 
-void CameraStream::onCaptureCompleted(void* /*context*/, ACameraCaptureSession* /*session*/,
-                                       ACaptureRequest* /*request*/, const ACameraMetadata* /*result*/) {
-    // Frame completed - could extract additional metadata here if needed
+void CameraStream::onImageAvailable(void* context, AImageReader* reader) {
+    auto* self = static_cast<CameraStream*>(context);
+
+    AImage* image = nullptr;
+    if (AImageReader_acquireLatestImage(reader, &image) != AMEDIA_OK || !image) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(self->frameCallbackMutex_);
+    FrameRef frame;
+    uint8_t* luma = nullptr;
+    int lumaLength = 0;
+    int32_t rowStride = 0;
+    if (self->analysisPool_ && self->analysisCallback_ &&
+        AImage_getPlaneData(image, 0, &luma, &lumaLength) == AMEDIA_OK &&
+        AImage_getPlaneRowStride(image, 0, &rowStride) == AMEDIA_OK) {
+        frame = self->analysisPool_->acquire();
+        if (!frame) {
+            self->analysisDropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    if (frame) {
+        // Copy out so the reader slot is returned right away
+        int32_t width = 0;
+        int32_t height = 0;
+        AImage_getWidth(image, &width);
+        AImage_getHeight(image, &height);
+        width = std::min(width, frame->width());
+        height = std::min(height, frame->height());
+        for (int32_t y = 0; y < height; ++y) {
+            std::memcpy(frame->row(y), luma + static_cast<ptrdiff_t>(y) * rowStride,
+                        static_cast<size_t>(width));
+        }
+
+        frame->metadata.cameraId = self->frameTemplate_.cameraId;
+        frame->metadata.width = width;
+        frame->metadata.height = height;
+        frame->metadata.format = AIMAGE_FORMAT_YUV_420_888;
+        frame->metadata.frameNumber = self->analysisFrameNumber_++;
+        AImage_getTimestamp(image, &frame->metadata.timestampNs);
+        const ExposureRecord& exposure = self->exposureFor(frame->metadata.timestampNs);
+        frame->metadata.exposureTimeNs = exposure.exposureTimeNs;
+        frame->metadata.rollingShutterSkewNs = exposure.rollingShutterSkewNs;
+    }
+    AImage_delete(image);
+
+    if (frame) {
+        self->analysisCallback_(frame);
+    }
+}
+
+void CameraStream::onStillAvailable(void* context, AImageReader* reader) {
+    auto* self = static_cast<CameraStream*>(context);
+
+    AImage* image = nullptr;
+    if (AImageReader_acquireNextImage(reader, &image) != AMEDIA_OK || !image) {
+        return;
+    }
+
+    StillCallback onStill;
+    {
+        std::lock_guard<std::mutex> lock(self->stillMutex_);
+        if (!self->pendingStills_.empty()) {
+            onStill = std::move(self->pendingStills_.front().callback);
+            self->pendingStills_.pop_front();
+        }
+    }
+
+    uint8_t* data = nullptr;
+    int length = 0;
+    int64_t timestampNs = 0;
+    if (!onStill) {
+        LOGW("Still image without a pending capture");
+    } else if (AImage_getPlaneData(image, 0, &data, &length) == AMEDIA_OK && length > 0) {
+        AImage_getTimestamp(image, &timestampNs);
+        onStill(data, static_cast<size_t>(length), timestampNs);
+    } else {
+        LOGW("Still image without data");
+        onStill(nullptr, 0, 0);
+    }
+    AImage_delete(image);
+}
+
+void CameraStream::onStillFailed(void* context, ACameraCaptureSession* /*session*/,
+                                 ACaptureRequest* /*request*/, ACameraCaptureFailure* failure) {
+    // With wasImageCaptured the JPEG still arrives
+    if (failure && !failure->wasImageCaptured) {
+        LOGW("Still capture %d failed: reason %d", failure->sequenceId, failure->reason);
+        static_cast<CameraStream*>(context)->failStill(failure->sequenceId);
+    }
+}
+
+void CameraStream::onStillSequenceAborted(void* context, ACameraCaptureSession* /*session*/, int sequenceId) {
+    LOGW("Still capture %d aborted", sequenceId);
+    static_cast<CameraStream*>(context)->failStill(sequenceId);
+}
+
+void CameraStream::onStillBufferLost(void* context, ACameraCaptureSession* /*session*/,
+                                     ACaptureRequest* /*request*/, ANativeWindow* /*window*/,
+                                     int64_t frameNumber) {
+    // No sequence ID here, but stills are one-frame captures taken in order:
+    // the lost JPEG is the oldest one outstanding
+    auto* self = static_cast<CameraStream*>(context);
+    StillCallback onStill;
+    {
+        std::lock_guard<std::mutex> lock(self->stillMutex_);
+        if (self->pendingStills_.empty()) {
+            return;
+        }
+        onStill = std::move(self->pendingStills_.front().callback);
+        self->pendingStills_.pop_front();
+    }
+    LOGW("Still buffer of frame %lld lost", static_cast<long long>(frameNumber));
+    onStill(nullptr, 0, 0);
+}
+
+void CameraStream::failStill(int sequenceId) {
+    StillCallback onStill;
+    {
+        std::lock_guard<std::mutex> lock(stillMutex_);
+        const auto it = std::find_if(pendingStills_.begin(), pendingStills_.end(),
+                                     [sequenceId](const PendingStill& still) {
+                                         return still.sequenceId == sequenceId;
+                                     });
+        if (it == pendingStills_.end()) {
+            // captureStill() claims it once capture() returns the ID
+            const bool capturing = std::any_of(pendingStills_.begin(), pendingStills_.end(),
+                                               [](const PendingStill& still) {
+                                                   return still.sequenceId == kUnknownSequence;
+                                               });
+            if (capturing) {
+                unclaimedFailures_.push_back(sequenceId);
+            }
+            return;
+        }
+        onStill = std::move(it->callback);
+        pendingStills_.erase(it);
+    }
+    onStill(nullptr, 0, 0);
+}
+
+void CameraStream::failPendingStills() {
+    std::deque<PendingStill> pending;
+    {
+        std::lock_guard<std::mutex> lock(stillMutex_);
+        pending.swap(pendingStills_);
+        unclaimedFailures_.clear();
+    }
+    if (!pending.empty()) {
+        LOGW("Dropping %zu pending stills", pending.size());
+    }
+    for (auto& still : pending) {
+        still.callback(nullptr, 0, 0);
+    }
+}
+
+void CameraStream::onCaptureCompleted(void* context, ACameraCaptureSession* /*session*/,
+                                       ACaptureRequest* /*request*/, const ACameraMetadata* result) {
+    auto* self = static_cast<CameraStream*>(context);
+
+    int64_t timestampNs = 0;
+    int64_t exposureTimeNs = 0;
+    int64_t skewNs = 0;
+    ACameraMetadata_const_entry entry{};
+    if (result && ACameraMetadata_getConstEntry(result, ACAMERA_SENSOR_TIMESTAMP, &entry) == ACAMERA_OK &&
+        entry.count > 0) {
+        timestampNs = entry.data.i64[0];
+    }
+    if (result && ACameraMetadata_getConstEntry(result, ACAMERA_SENSOR_EXPOSURE_TIME, &entry) == ACAMERA_OK &&
+        entry.count > 0) {
+        exposureTimeNs = entry.data.i64[0];
+    }
+    if (result && ACameraMetadata_getConstEntry(result, ACAMERA_SENSOR_ROLLING_SHUTTER_SKEW, &entry) == ACAMERA_OK &&
+        entry.count > 0) {
+        skewNs = entry.data.i64[0];
+    }
+
+    std::lock_guard<std::mutex> lock(self->frameCallbackMutex_);
+    if (exposureTimeNs > 0) {
+        self->exposures_[self->nextExposure_] = {timestampNs, exposureTimeNs, skewNs};
+        self->nextExposure_ = (self->nextExposure_ + 1) % kExposureHistory;
+    }
+    if (!self->frameCallback_) {
+        return;
+    }
+
+    FrameMetadata frame = self->frameTemplate_;
+    frame.frameNumber = self->frameTemplate_.frameNumber++;
+    if (timestampNs > 0) {
+        frame.timestampNs = timestampNs;
+    }
+    frame.exposureTimeNs = exposureTimeNs;
+    frame.rollingShutterSkewNs = skewNs;
+    frame.resultNs = getBootTimeNs();
+    self->frameCallback_(frame);
+}
+
+const CameraStream::ExposureRecord& CameraStream::exposureFor(int64_t timestampNs) const {
+    // Exact match, else the newest result: auto-exposure changes slowly
+    const ExposureRecord& newest = exposures_[(nextExposure_ + kExposureHistory - 1) % kExposureHistory];
+    for (const auto& record : exposures_) {
+        if (record.timestampNs == timestampNs && record.exposureTimeNs > 0) {
+            return record;
+        }
+    }
+    return newest;
 }
 
 }  // namespace nativesensor
@@ -8,18 +8,33 @@
 #include <functional>
 #include <memory>
 #include <thread>
+#include <array>
 #include <atomic>
+#include <deque>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "camera_data.h"
 #include "camera_manager.h"
+#include "frame_pool.h"
 
 namespace nativesensor {
 
 /// Callback for frame statistics updates
 using CameraStatsCallback = std::function<void(const CameraStats&)>;
 
+/// Callback invoked on the camera callback thread for every completed frame
+using FrameCallback = std::function<void(const FrameMetadata&)>;
+
+/// Callback invoked on the image reader thread with the luma plane of a frame
+using AnalysisFrameCallback = std::function<void(const FrameRef&)>;
+
+/// Callback invoked on the still reader thread with one camera-encoded JPEG;
+/// the bytes are only valid during the call. A still the camera failed or
+/// dropped gets null data and size 0 instead, on whichever thread found out.
+using StillCallback = std::function<void(const uint8_t* data, size_t size, int64_t timestampNs)>;
+
 /// Zero-copy camera stream using AImageReader with ANativeWindow output
 class CameraStream {
 public:
@@ -49,6 +64,31 @@ public:
     [[nodiscard]]
     CameraStats getStats() const;
 
+    /// Set the per-frame callback (e.g. a pipeline source). Safe to call while streaming;
+    /// keep it cheap since it runs on the camera callback thread.
+    void setFrameCallback(FrameCallback callback);
+
+    /// Additionally stream frames to the CPU: a YUV AImageReader at the pool's
+    /// size is added to the session and each frame's luma plane is copied into
+    /// a pool buffer. Takes effect on the next startPreview(); pass a null pool
+    /// to disable. The pool must outlive the stream.
+    void setAnalysisOutput(std::shared_ptr<FramePool> pool, AnalysisFrameCallback callback);
+
+    /// Analysis frames dropped because the pool was exhausted
+    [[nodiscard]]
+    int64_t analysisDroppedFrames() const { return analysisDropped_.load(std::memory_order_relaxed); }
+
+    /// Additionally add a JPEG AImageReader at width x height to the session so
+    /// captureStill() can take hardware-encoded stills without touching the
+    /// repeating request. Takes effect on the next startPreview(); a zero size
+    /// disables. Not every device supports a third output next to analysis.
+    void setStillOutput(int32_t width, int32_t height);
+
+    /// Queue a one-shot capture on the still output; `onStill` is called
+    /// exactly once, with the JPEG or the failure. False if not streaming or
+    /// the session has no still output (`onStill` is not called then).
+    bool captureStill(StillCallback onStill);
+
     /// Get the currently active camera ID
     [[nodiscard]] [[maybe_unused]]
     std::string getCurrentCameraId() const {
@@ -57,7 +97,7 @@ public:
     }
 
 private:
-    // Camera device callbacks
+    // Camera device callbacks; they only mark the stream stopped, stop/startPreview() release it
     static void onDeviceDisconnected(void* context, ACameraDevice* device);
     static void onDeviceError(void* context, ACameraDevice* device, int error);
 
@@ -72,6 +112,21 @@ private:
     static void onCaptureCompleted(void* context, ACameraCaptureSession* session,
                                     ACaptureRequest* request, const ACameraMetadata* result);
 
+    // Analysis image reader callback
+    static void onImageAvailable(void* context, AImageReader* reader);
+
+    // Still (JPEG) image reader and capture callbacks
+    static void onStillAvailable(void* context, AImageReader* reader);
+    static void onStillFailed(void* context, ACameraCaptureSession* session, ACaptureRequest* request,
+                              ACameraCaptureFailure* failure);
+    static void onStillSequenceAborted(void* context, ACameraCaptureSession* session, int sequenceId);
+    static void onStillBufferLost(void* context, ACameraCaptureSession* session, ACaptureRequest* request,
+                                  ANativeWindow* window, int64_t frameNumber);
+    void failStill(int sequenceId);
+    void failPendingStills();
+
+    bool addAnalysisOutput();
+    bool addStillOutput();
     void cleanup();
     void updateStats(int64_t timestampNs);
 
@@ -102,6 +157,56 @@ private:
     float lastLatencyMs_{0.0f};         // Latency = now - eventTimestamp
     int64_t lastCallbackTimeNs_{0};     // For periodic callback throttling
 
+    // Per-frame metadata delivery (own mutex: set from any thread, read per frame)
+    std::mutex frameCallbackMutex_;
+    FrameCallback frameCallback_;
+    FrameMetadata frameTemplate_;       // Camera id and surface geometry for this session
+
+    // Exposure times and readout skew from recent capture results, matched to
+    // analysis images by sensor timestamp (results and images arrive in either order)
+    struct ExposureRecord {
+        int64_t timestampNs = 0;
+        int64_t exposureTimeNs = 0;
+        int64_t rollingShutterSkewNs = 0;
+    };
+    static constexpr size_t kExposureHistory = 8;
+    std::array<ExposureRecord, kExposureHistory> exposures_{};
+    size_t nextExposure_ = 0;
+    [[nodiscard]] const ExposureRecord& exposureFor(int64_t timestampNs) const;
+
+    // CPU analysis output (optional second session output)
+    std::shared_ptr<FramePool> analysisPool_;
+    AnalysisFrameCallback analysisCallback_;
+    AImageReader* analysisReader_ = nullptr;
+    ACaptureSessionOutput* analysisOutput_ = nullptr;
+    ACameraOutputTarget* analysisTarget_ = nullptr;
+    AImageReader_ImageListener analysisListener_{};
+    int64_t analysisFrameNumber_ = 0;
+    std::atomic<int64_t> analysisDropped_{0};
+
+    // Hardware JPEG stills (optional output, captured on demand)
+    int32_t stillWidth_ = 0;
+    int32_t stillHeight_ = 0;
+    AImageReader* stillReader_ = nullptr;
+    ACaptureSessionOutput* stillOutput_ = nullptr;
+    ACameraOutputTarget* stillTarget_ = nullptr;
+    ACaptureRequest* stillRequest_ = nullptr;
+    AImageReader_ImageListener stillListener_{};
+    // One per queued capture, in capture order. JPEGs carry no sequence ID
+    // but arrive in order, so each goes to the oldest entry; failures name
+    // their sequence and take theirs out of the line.
+    static constexpr int kUnknownSequence = -1;
+    struct PendingStill {
+        uint64_t ticket = 0;
+        int sequenceId = kUnknownSequence;  // Until capture() returns it
+        StillCallback callback;
+    };
+    std::mutex stillMutex_;
+    std::deque<PendingStill> pendingStills_;
+    uint64_t nextStillTicket_ = 0;
+    std::vector<int> unclaimedFailures_;    // Failed before capture() returned their ID
+    ACameraCaptureSession_captureCallbacks stillCaptureCallbacks_{};
+
     // Callback structs (must persist for lifetime of camera session)
     ACameraDevice_StateCallbacks deviceCallbacks_{};
     ACameraCaptureSession_stateCallbacks sessionCallbacks_{};
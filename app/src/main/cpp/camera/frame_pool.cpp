@@ -0,0 +1,50 @@
+#include "frame_pool.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace nativesensor {
+
+FramePool::FramePool(int32_t width, int32_t height, size_t capacity)
+    : width_(width),
+      height_(height),
+      stride_(static_cast<int32_t>((static_cast<size_t>(width) + kAlignment - 1) / kAlignment * kAlignment)),
+      free_(capacity) {
+    // One allocation for all buffers; each starts on its own aligned boundary
+    const size_t frameBytes = static_cast<size_t>(stride_) * static_cast<size_t>(height_);
+    storage_ = static_cast<uint8_t*>(std::aligned_alloc(kAlignment, frameBytes * capacity));
+    if (!storage_) {
+        throw std::bad_alloc();
+    }
+
+    buffers_.reserve(capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+        buffers_.push_back(std::unique_ptr<FrameBuffer>(
+            new FrameBuffer(this, width_, height_, stride_, storage_ + i * frameBytes)));
+        free_.tryPush(buffers_.back().get());
+    }
+}
+
+FramePool::~FramePool() {
+    std::free(storage_);
+}
+
+FrameRef FramePool::acquire() {
+    FrameBuffer* buffer = nullptr;
+    if (!free_.tryPop(buffer)) {
+        exhausted_.fetch_add(1, std::memory_order_relaxed);
+        return {};
+    }
+    buffer->metadata = FrameMetadata{};
+    buffer->refs_.store(1, std::memory_order_relaxed);
+    outstanding_.fetch_add(1, std::memory_order_relaxed);
+    return FrameRef(buffer);
+}
+
+void FramePool::recycle(FrameBuffer* buffer) noexcept {
+    // Capacity equals the buffer count, so this never fails
+    free_.tryPush(buffer);
+    outstanding_.fetch_sub(1, std::memory_order_release);
+}
+
+}  // namespace nativesensor
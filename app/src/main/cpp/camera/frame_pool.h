@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "camera_data.h"
+
+namespace nativesensor {
+
+class FramePool;
+
+/// 8-bit single-channel image (the luma plane of a camera frame) in storage
+/// owned by a FramePool. Rows are `stride` bytes apart and 64-byte aligned.
+class FrameBuffer {
+public:
+    FrameMetadata metadata;
+
+    [[nodiscard]] int32_t width() const noexcept { return width_; }
+    [[nodiscard]] int32_t height() const noexcept { return height_; }
+    [[nodiscard]] int32_t stride() const noexcept { return stride_; }
+
+    [[nodiscard]] uint8_t* data() noexcept { return data_; }
+    [[nodiscard]] const uint8_t* data() const noexcept { return data_; }
+
+    [[nodiscard]] uint8_t* row(int32_t y) noexcept { return data_ + static_cast<ptrdiff_t>(y) * stride_; }
+    [[nodiscard]] const uint8_t* row(int32_t y) const noexcept {
+        return data_ + static_cast<ptrdiff_t>(y) * stride_;
+    }
+
+private:
+    friend class FramePool;
+    friend class FrameRef;
+
+    FrameBuffer(FramePool* pool, int32_t width, int32_t height, int32_t stride, uint8_t* data)
+        : width_(width), height_(height), stride_(stride), data_(data), pool_(pool) {}
+
+    const int32_t width_;
+    const int32_t height_;
+    const int32_t stride_;
+    uint8_t* const data_;
+    FramePool* const pool_;
+    std::atomic<int32_t> refs_{0};
+};
+
+/// Reference-counted handle to a pooled frame. Copies share the buffer; the
+/// last handle to go away returns it to its pool. No allocation per frame.
+class FrameRef {
+public:
+    FrameRef() noexcept = default;
+    FrameRef(const FrameRef& other) noexcept : buffer_(other.buffer_) { retain(); }
+    FrameRef(FrameRef&& other) noexcept : buffer_(other.buffer_) { other.buffer_ = nullptr; }
+    ~FrameRef() { release(); }
+
+    FrameRef& operator=(const FrameRef& other) noexcept {
+        if (this != &other) {
+            release();
+            buffer_ = other.buffer_;
+            retain();
+        }
+        return *this;
+    }
+
+    FrameRef& operator=(FrameRef&& other) noexcept {
+        if (this != &other) {
+            release();
+            buffer_ = other.buffer_;
+            other.buffer_ = nullptr;
+        }
+        return *this;
+    }
+
+    void reset() noexcept {
+        release();
+        buffer_ = nullptr;
+    }
+
+    [[nodiscard]] FrameBuffer* get() const noexcept { return buffer_; }
+    FrameBuffer* operator->() const noexcept { return buffer_; }
+    FrameBuffer& operator*() const noexcept { return *buffer_; }
+    explicit operator bool() const noexcept { return buffer_ != nullptr; }
+
+private:
+    friend class FramePool;
+
+    /// Adopt a buffer whose count was already set to 1
+    explicit FrameRef(FrameBuffer* buffer) noexcept : buffer_(buffer) {}
+
+    void retain() const noexcept {
+        if (buffer_) {
+            buffer_->refs_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void release() noexcept;
+
+    FrameBuffer* buffer_ = nullptr;
+};
+
+/// Fixed set of preallocated frame buffers of one size, shared between the
+/// camera thread and pipeline stages without heap traffic. acquire() is
+/// lock-free and fails (instead of allocating) when every buffer is in use.
+/// The pool must outlive every FrameRef it handed out.
+class FramePool {
+public:
+    /// @param capacity Number of buffers (> 0), allocated up front
+    FramePool(int32_t width, int32_t height, size_t capacity);
+    ~FramePool();
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /// Take a free buffer; empty ref if the pool is exhausted
+    [[nodiscard]]
+    FrameRef acquire();
+
+    [[nodiscard]] int32_t width() const noexcept { return width_; }
+    [[nodiscard]] int32_t height() const noexcept { return height_; }
+    [[nodiscard]] int32_t stride() const noexcept { return stride_; }
+    [[nodiscard]] size_t capacity() const noexcept { return buffers_.size(); }
+
+    /// Buffers currently not referenced by anyone
+    [[nodiscard]] size_t available() const noexcept { return free_.sizeApprox(); }
+
+    /// True once every buffer handed out has been returned. A pool that no
+    /// longer hands out buffers may be destroyed as soon as this holds.
+    [[nodiscard]] bool idle() const noexcept { return outstanding_.load(std::memory_order_acquire) == 0; }
+
+    /// Number of acquire() calls that found the pool empty
+    [[nodiscard]] int64_t exhaustedCount() const noexcept {
+        return exhausted_.load(std::memory_order_relaxed);
+    }
+
+private:
+    friend class FrameRef;
+
+    static constexpr size_t kAlignment = 64;
+
+    void recycle(FrameBuffer* buffer) noexcept;
+
+    const int32_t width_;
+    const int32_t height_;
+    const int32_t stride_;
+    uint8_t* storage_ = nullptr;
+    std::vector<std::unique_ptr<FrameBuffer>> buffers_;
+    BoundedQueue<FrameBuffer*> free_;
+    std::atomic<int64_t> exhausted_{0};
+    // Buffers handed out and not yet recycled; the last access recycle()
+    // makes to the pool
+    std::atomic<size_t> outstanding_{0};
+};
+
+inline void FrameRef::release() noexcept {
+    if (buffer_ && buffer_->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        buffer_->pool_->recycle(buffer_);
+    }
+}
+
+}  // namespace nativesensor
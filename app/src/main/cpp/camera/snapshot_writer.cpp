@@ -0,0 +1,284 @@
+#include "snapshot_writer.h"
+
+#include <algorithm>
+#include <android/log.h>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <utility>
+#include <zlib.h>
+
+#include "file_utils.h"
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.Snapshot";
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, kLogTag, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+namespace {
+
+constexpr uint8_t kPngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+constexpr size_t kIhdrSize = 13;
+constexpr size_t kChunkOverhead = 12;       // Length, type and CRC
+constexpr uint8_t kPngGray8 = 0;            // Color type 0 at bit depth 8
+constexpr uint8_t kPngFilterSub = 1;        // Difference to the left neighbour
+
+void putBigEndian(uint8_t* dst, uint32_t value) noexcept {
+    dst[0] = static_cast<uint8_t>(value >> 24);
+    dst[1] = static_cast<uint8_t>(value >> 16);
+    dst[2] = static_cast<uint8_t>(value >> 8);
+    dst[3] = static_cast<uint8_t>(value);
+}
+
+/// Fill in length and CRC of the chunk whose data (dataSize bytes) follows
+/// the 8-byte length and type at out[offset]
+void sealChunk(std::vector<uint8_t>& out, size_t offset, size_t dataSize) {
+    putBigEndian(out.data() + offset, static_cast<uint32_t>(dataSize));
+    const uLong crc = crc32(crc32(0L, Z_NULL, 0), out.data() + offset + 4,
+                            static_cast<uInt>(dataSize + 4));
+    putBigEndian(out.data() + offset + 8 + dataSize, static_cast<uint32_t>(crc));
+}
+
+size_t beginChunk(std::vector<uint8_t>& out, const char* type, size_t dataSize) {
+    const size_t offset = out.size();
+    out.resize(offset + kChunkOverhead + dataSize);
+    std::memcpy(out.data() + offset + 4, type, 4);
+    return offset;
+}
+
+int64_t elapsedUs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+bool encodeGrayPng(const uint8_t* data, int32_t width, int32_t height, int32_t stride,
+                   std::vector<uint8_t>& out) {
+    out.clear();
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    out.resize(sizeof(kPngSignature));
+    std::memcpy(out.data(), kPngSignature, sizeof(kPngSignature));
+
+    const size_t ihdr = beginChunk(out, "IHDR", kIhdrSize);
+    uint8_t* header = out.data() + ihdr + 8;
+    putBigEndian(header, static_cast<uint32_t>(width));
+    putBigEndian(header + 4, static_cast<uint32_t>(height));
+    header[8] = 8;
+    header[9] = kPngGray8;
+    header[10] = 0;     // Deflate
+    header[11] = 0;     // Adaptive filtering with five basic types
+    header[12] = 0;     // Not interlaced
+    sealChunk(out, ihdr, kIhdrSize);
+
+    // Camera images are smooth enough that the Sub filter with the fastest
+    // deflate level gets most of the size win at a fraction of the cost
+    z_stream stream{};
+    if (deflateInit(&stream, Z_BEST_SPEED) != Z_OK) {
+        return false;
+    }
+    const auto rowBytes = static_cast<size_t>(width) + 1;
+    const uLong bound = deflateBound(&stream, static_cast<uLong>(rowBytes * static_cast<size_t>(height)));
+    const size_t idat = beginChunk(out, "IDAT", bound);
+
+    std::vector<uint8_t> filtered(rowBytes);
+    filtered[0] = kPngFilterSub;
+    stream.next_out = out.data() + idat + 8;
+    stream.avail_out = static_cast<uInt>(bound);
+    int status = Z_OK;
+    for (int32_t y = 0; y < height && status == Z_OK; ++y) {
+        const uint8_t* row = data + static_cast<ptrdiff_t>(y) * stride;
+        filtered[1] = row[0];
+        for (int32_t x = 1; x < width; ++x) {
+            filtered[static_cast<size_t>(x) + 1] = static_cast<uint8_t>(row[x] - row[x - 1]);
+        }
+        stream.next_in = filtered.data();
+        stream.avail_in = static_cast<uInt>(rowBytes);
+        status = deflate(&stream, y + 1 == height ? Z_FINISH : Z_NO_FLUSH);
+    }
+    const size_t compressed = stream.total_out;
+    deflateEnd(&stream);
+    if (status != Z_STREAM_END) {
+        out.clear();
+        return false;
+    }
+
+    out.resize(idat + kChunkOverhead + compressed);
+    sealChunk(out, idat, compressed);
+    sealChunk(out, beginChunk(out, "IEND", 0), 0);
+    return true;
+}
+
+SnapshotWriter::SnapshotWriter(size_t maxPending)
+    : maxPending_(std::max<size_t>(maxPending, 1)),
+      thread_(&SnapshotWriter::encoderLoop, this) {}
+
+SnapshotWriter::~SnapshotWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+bool SnapshotWriter::reserve() {
+    ++stats_.requested;
+    if (pending_ >= maxPending_) {
+        ++stats_.rejected;
+        return false;
+    }
+    ++pending_;
+    return true;
+}
+
+bool SnapshotWriter::request(const std::string& cameraId, std::string path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!reserve()) {
+        LOGW("Snapshot of camera %s rejected: %zu pending", cameraId.c_str(), pending_);
+        return false;
+    }
+    requests_.push_back({cameraId, std::move(path)});
+    waitingFrames_.store(requests_.size(), std::memory_order_release);
+    return true;
+}
+
+void SnapshotWriter::cancel(const std::string& cameraId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto cancelled = std::remove_if(requests_.begin(), requests_.end(),
+        [&cameraId](const FrameRequest& request) { return request.cameraId == cameraId; });
+    const auto count = static_cast<size_t>(requests_.end() - cancelled);
+    if (count == 0) {
+        return;
+    }
+    requests_.erase(cancelled, requests_.end());
+    waitingFrames_.store(requests_.size(), std::memory_order_release);
+    pending_ -= count;
+    stats_.failed += static_cast<int64_t>(count);
+    LOGW("Cancelled %zu snapshots of camera %s", count, cameraId.c_str());
+}
+
+void SnapshotWriter::process(const FrameRef& frame) {
+    if (waitingFrames_.load(std::memory_order_acquire) == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Every waiting request for this camera gets this frame
+        bool matched = false;
+        for (auto it = requests_.begin(); it != requests_.end();) {
+            if (it->cameraId != frame->metadata.cameraId) {
+                ++it;
+                continue;
+            }
+            jobs_.push_back({std::move(it->path), frame, {}});
+            it = requests_.erase(it);
+            matched = true;
+        }
+        if (!matched) {
+            return;
+        }
+        waitingFrames_.store(requests_.size(), std::memory_order_release);
+    }
+    cv_.notify_one();
+}
+
+bool SnapshotWriter::submitEncoded(std::string path, const uint8_t* data, size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!reserve()) {
+            LOGW("Encoded snapshot %s rejected: %zu pending", path.c_str(), pending_);
+            return false;
+        }
+        jobs_.push_back({std::move(path), FrameRef{}, std::vector<uint8_t>(data, data + size)});
+    }
+    cv_.notify_one();
+    return true;
+}
+
+SnapshotStats SnapshotWriter::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void SnapshotWriter::encoderLoop() {
+    pthread_setname_np(pthread_self(), "ns-snapshot");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+        if (stopping_) {
+            break;
+        }
+        Job job = std::move(jobs_.front());
+        jobs_.pop_front();
+
+        lock.unlock();
+        write(job);
+        job = Job{};        // Returns the frame to its pool before the next wait
+        lock.lock();
+        --pending_;
+    }
+    if (!jobs_.empty() || !requests_.empty()) {
+        LOGW("Discarding %zu pending snapshots", jobs_.size() + requests_.size());
+    }
+}
+
+void SnapshotWriter::write(Job& job) {
+    float encodeMs = 0.0f;
+    const std::vector<uint8_t>* bytes = &job.encoded;
+    if (job.frame) {
+        const auto start = std::chrono::steady_clock::now();
+        const FrameRef& frame = job.frame;
+        const bool encoded = encodeGrayPng(frame->data(), frame->width(), frame->height(),
+                                           frame->stride(), buffer_);
+        encodeMs = static_cast<float>(elapsedUs(start)) / 1000.0f;
+        if (!encoded) {
+            LOGE("Failed to encode snapshot %s", job.path.c_str());
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++stats_.failed;
+            return;
+        }
+        bytes = &buffer_;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::string tmpPath = job.path + ".tmp";
+    const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    bool ok = fd >= 0;
+    if (ok) {
+        ok = writeAll(fd, bytes->data(), bytes->size()) && ::fsync(fd) == 0;
+        ::close(fd);
+        ok = ok && ::rename(tmpPath.c_str(), job.path.c_str()) == 0;
+        if (!ok) {
+            ::unlink(tmpPath.c_str());
+        }
+    }
+    const float writeMs = static_cast<float>(elapsedUs(start)) / 1000.0f;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ok) {
+        LOGE("Failed to write snapshot %s", job.path.c_str());
+        ++stats_.failed;
+        return;
+    }
+    ++stats_.written;
+    if (job.frame) {
+        stats_.lastEncodeMs = encodeMs;
+    } else {
+        ++stats_.hardware;
+    }
+    stats_.lastWriteMs = writeMs;
+    stats_.lastBytes = static_cast<int64_t>(bytes->size());
+    LOGI("Snapshot written: %s (%zu bytes)", job.path.c_str(), bytes->size());
+}
+
+}  // namespace nativesensor
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frame_pool.h"
+
+namespace nativesensor {
+
+/// Encode a width x height 8-bit grayscale image as a PNG (Sub filter, fast
+/// deflate). Returns false if zlib fails; `out` is replaced.
+bool encodeGrayPng(const uint8_t* data, int32_t width, int32_t height, int32_t stride,
+                   std::vector<uint8_t>& out);
+
+/// Snapshot counters
+struct SnapshotStats {
+    int64_t requested = 0;
+    int64_t written = 0;
+    int64_t failed = 0;                 // Encode or file errors, or the stream stopped first
+    int64_t rejected = 0;               // Too many snapshots pending
+    int64_t hardware = 0;               // Written from a camera-encoded JPEG
+    float lastEncodeMs = 0.0f;          // Software PNG encode of the last frame
+    float lastWriteMs = 0.0f;
+    int64_t lastBytes = 0;
+};
+
+/// On-demand stills written by a dedicated encoder thread, so neither the
+/// camera callbacks nor the pipeline wait on compression or storage.
+///
+/// Two sources: camera-encoded JPEGs (CameraStream::captureStill) are handed
+/// over as bytes; otherwise request() takes the camera's next analysis frame,
+/// holding its pool buffer (no copy) until it is encoded as a grayscale PNG.
+/// Files appear atomically (temp file plus rename). process() runs on one
+/// pipeline thread; everything else may be called from anywhere.
+class SnapshotWriter {
+public:
+    /// At most maxPending snapshots waiting for a frame or the encoder, which
+    /// also bounds the analysis buffers held back from the camera
+    explicit SnapshotWriter(size_t maxPending = 2);
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    /// Write the camera's next analysis frame to `path` as PNG; false if too
+    /// many snapshots are pending
+    bool request(const std::string& cameraId, std::string path);
+
+    /// Drop requests still waiting for a frame of the camera (stream stopped)
+    void cancel(const std::string& cameraId);
+
+    /// Pipeline sink on the analysis frames: hands the frame to the encoder if
+    /// a request waits for its camera. One atomic load when none does.
+    void process(const FrameRef& frame);
+
+    /// Write an already encoded image (camera JPEG) to `path`; false if too
+    /// many snapshots are pending
+    bool submitEncoded(std::string path, const uint8_t* data, size_t size);
+
+    [[nodiscard]]
+    SnapshotStats getStats() const;
+
+private:
+    struct Job {
+        std::string path;
+        FrameRef frame;                 // Encoded here if set
+        std::vector<uint8_t> encoded;   // Written as is otherwise
+    };
+    struct FrameRequest {
+        std::string cameraId;
+        std::string path;
+    };
+
+    [[nodiscard]] bool reserve();
+    void encoderLoop();
+    void write(Job& job);
+
+    const size_t maxPending_;
+    std::atomic<size_t> waitingFrames_{0};      // requests_.size(), for the lock-free check
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<FrameRequest> requests_;
+    std::deque<Job> jobs_;
+    size_t pending_ = 0;                        // Requests plus queued and encoding jobs
+    bool stopping_ = false;
+    SnapshotStats stats_;
+
+    std::vector<uint8_t> buffer_;               // Encoder-thread PNG output
+    std::thread thread_;
+};
+
+}  // namespace nativesensor
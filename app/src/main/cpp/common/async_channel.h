@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "sensor_types.h"
+#include "task.h"
+#include "thread_pool.h"
+
+namespace nativesensor {
+
+/// Default timestamp projection for AsyncChannel::until(): the item's timestampNs
+struct MemberTimestamp {
+    template<typename T>
+    TimestampNs operator()(const T& item) const noexcept { return item.timestampNs; }
+};
+
+/// Sensor stream a coroutine can `co_await` instead of taking callbacks on
+/// the producer's thread.
+///
+/// Producers (sensor thread, camera callbacks, pipeline sinks) push without
+/// blocking; when the queue is full the oldest item is dropped. One consumer
+/// coroutine awaits nextBatch(), next() or until(). A suspended consumer is
+/// resumed as a pool task, never on the producer's thread, so the
+/// processing it does between awaits can take as long as it needs.
+template<typename T>
+class AsyncChannel {
+public:
+    /// @param priority Priority of the consumer's resumptions on the pool
+    /// @param capacity Queue size, at least 2 so an eviction never empties it
+    AsyncChannel(ThreadPool& pool, size_t capacity, TaskPriority priority = TaskPriority::Analysis)
+        : queue_(std::max<size_t>(capacity, 2)), pool_(pool), priority_(priority) {}
+
+    AsyncChannel(const AsyncChannel&) = delete;
+    AsyncChannel& operator=(const AsyncChannel&) = delete;
+
+    /// Queue an item and wake the consumer. Safe from any thread; never blocks.
+    void push(const T& item) {
+        if (closed_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        if (!queue_.tryPush(item)) {
+            T evicted;
+            while (!queue_.tryPush(item)) {
+                if (queue_.tryPop(evicted)) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+        wake();
+    }
+
+    /// End the stream: the consumer drains what's queued, then its awaits
+    /// return empty. Later pushes are ignored.
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        wake();
+    }
+
+    [[nodiscard]]
+    bool closed() const noexcept { return closed_.load(std::memory_order_acquire); }
+
+    /// Items evicted because the consumer fell behind
+    [[nodiscard]]
+    int64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+    /// `co_await nextBatch()`: everything queued (at most maxItems), waiting
+    /// for the first item if there is none. Empty only once closed.
+    [[nodiscard]]
+    auto nextBatch(size_t maxItems = std::numeric_limits<size_t>::max()) noexcept {
+        return BatchAwaiter{*this, maxItems > 0 ? maxItems : 1, {}};
+    }
+
+    /// `co_await next()`: the next item; nullopt once closed
+    [[nodiscard]]
+    auto next() noexcept {
+        return NextAwaiter{{*this, 1, {}}};
+    }
+
+    /// `co_await until(t)`: every item up to timestamp t, completing once an
+    /// item at or past t arrived (or the channel closed). Items past t stay
+    /// queued for the next await.
+    template<typename Timestamp = MemberTimestamp>
+    Task<std::vector<T>> until(TimestampNs target, Timestamp timestampOf = {}) {
+        std::vector<T> result;
+        while (true) {
+            std::vector<T> batch = co_await nextBatch();
+            if (batch.empty()) {
+                co_return result;
+            }
+            for (auto it = batch.begin(); it != batch.end(); ++it) {
+                const TimestampNs timestamp = timestampOf(*it);
+                if (timestamp <= target) {
+                    result.push_back(std::move(*it));
+                }
+                if (timestamp >= target) {
+                    const auto rest = timestamp == target ? std::next(it) : it;
+                    pending_.insert(pending_.begin(), std::make_move_iterator(rest),
+                                    std::make_move_iterator(batch.end()));
+                    co_return result;
+                }
+            }
+        }
+    }
+
+private:
+    struct BatchAwaiter {
+        AsyncChannel& channel;
+        size_t maxItems;
+        std::vector<T> items;
+
+        bool await_ready() {
+            channel.take(items, maxItems);
+            return !items.empty() || channel.closed();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return channel.park(handle.address());
+        }
+
+        std::vector<T> await_resume() {
+            channel.take(items, maxItems);
+            return std::move(items);
+        }
+    };
+
+    struct NextAwaiter : BatchAwaiter {
+        std::optional<T> await_resume() {
+            std::vector<T> items = BatchAwaiter::await_resume();
+            if (items.empty()) {
+                return std::nullopt;
+            }
+            return std::move(items.front());
+        }
+    };
+
+    /// Consumer side: move items into `out` until it holds maxItems; true if any moved
+    bool take(std::vector<T>& out, size_t maxItems) {
+        const size_t before = out.size();
+        while (out.size() < maxItems && !pending_.empty()) {
+            out.push_back(std::move(pending_.front()));
+            pending_.pop_front();
+        }
+        T item;
+        while (out.size() < maxItems) {
+            if (queue_.tryPop(item)) {
+                out.push_back(std::move(item));
+            } else if (out.size() == before && !queue_.emptyApprox()) {
+                // A push claimed its slot but hasn't published it yet
+                std::this_thread::yield();
+            } else {
+                break;
+            }
+        }
+        return out.size() > before;
+    }
+
+    /// Publish the suspended consumer for the next push (or close) to resume.
+    /// False if it was reclaimed because there is something to take already.
+    bool park(void* address) {
+        // Exchanges on waiter_ are totally ordered: either wake() sees the
+        // address, or this acquires its push (or close) for the re-check. Once
+        // published, the consumer may be resumed at any moment, so nothing but
+        // the address is touched until it is reclaimed.
+        waiter_.exchange(address, std::memory_order_acq_rel);
+        if (queue_.emptyApprox() && !closed()) {
+            return true;
+        }
+        // If a producer claimed it in between, that producer resumes it
+        return waiter_.exchange(nullptr, std::memory_order_acq_rel) == nullptr;
+    }
+
+    void wake() {
+        // An exchange rather than a load, see park()
+        if (void* address = waiter_.exchange(nullptr, std::memory_order_acq_rel)) {
+            pool_.submit([this, address] {
+                // The consumer may have taken this push before it parked; if
+                // nothing is left, park it again rather than hand it nothing
+                if (queue_.emptyApprox() && !closed() && park(address)) {
+                    return;
+                }
+                std::coroutine_handle<>::from_address(address).resume();
+            }, priority_);
+        }
+    }
+
+    BoundedQueue<T> queue_;
+    std::deque<T> pending_;                     // Consumer only: handed back by until()
+    ThreadPool& pool_;
+    const TaskPriority priority_;
+
+    std::atomic<void*> waiter_{nullptr};        // Suspended consumer, claimed by whoever wakes it
+    std::atomic<bool> closed_{false};
+    std::atomic<int64_t> dropped_{0};
+};
+
+}  // namespace nativesensor
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace nativesensor {
+
+/// Slots a BoundedQueue allocates for a requested capacity: the next power
+/// of two, at least 2. A full queue holds this many items.
+constexpr size_t boundedQueueCapacity(size_t requested) noexcept {
+    size_t capacity = 2;
+    while (capacity < requested) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+/// Lock-free bounded multi-producer multi-consumer queue (Vyukov).
+/// Each cell carries a sequence number, so producers and consumers only
+/// contend on a single CAS of their own position counter.
+/// Capacity is rounded up by boundedQueueCapacity().
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity)
+        : capacity_(boundedQueueCapacity(capacity)),
+          mask_(capacity_ - 1),
+          buffer_(std::make_unique<Cell[]>(capacity_)) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            buffer_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /// Push an element. Returns false if the queue is full.
+    template<typename U>
+    bool tryPush(U&& item) noexcept {
+        Cell* cell;
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &buffer_[pos & mask_];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::forward<U>(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Pop an element. Returns false if the queue is empty.
+    bool tryPop(T& item) noexcept {
+        Cell* cell;
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &buffer_[pos & mask_];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(cell->data);
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Approximate number of queued elements (exact when quiescent)
+    [[nodiscard]]
+    size_t sizeApprox() const noexcept {
+        const size_t head = enqueuePos_.load(std::memory_order_acquire);
+        const size_t tail = dequeuePos_.load(std::memory_order_acquire);
+        return head >= tail ? head - tail : 0;
+    }
+
+    [[nodiscard]]
+    bool emptyApprox() const noexcept { return sizeApprox() == 0; }
+
+    [[nodiscard]]
+    size_t capacity() const noexcept { return capacity_; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T data{};
+    };
+
+    static constexpr size_t kCacheLine = 64;
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Cell[]> buffer_;
+
+    // Separate cache lines so producers and consumers don't false-share
+    alignas(kCacheLine) std::atomic<size_t> enqueuePos_{0};
+    alignas(kCacheLine) std::atomic<size_t> dequeuePos_{0};
+};
+
+}  // namespace nativesensor
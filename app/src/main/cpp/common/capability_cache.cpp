@@ -0,0 +1,403 @@
+#include "capability_cache.h"
+
+#include <android/log.h>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <utility>
+
+#include "file_utils.h"
+#include "hash.h"
+
+#if defined(__ANDROID__)
+#include <sys/system_properties.h>
+#endif
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.Cache";
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, kLogTag, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+namespace {
+
+constexpr char kMagic[8] = {'N', 'S', 'C', 'A', 'P', 'S', '\0', '\0'};
+
+// On-disk layout: [FileHeader][SensorRecord * n][CameraRecord * m][string table]
+// All offsets are relative to the start of the payload (right after the header).
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t fingerprintHash;
+    uint32_t sensorCount;
+    uint32_t cameraCount;
+    uint32_t stringsOffset;
+    uint32_t payloadSize;
+    uint32_t payloadChecksum;
+    uint32_t reserved;
+};
+
+struct SensorRecord {
+    int32_t handle;
+    int32_t type;
+    int32_t minDelayUs;
+    int32_t fifoReserved;
+    float maxFrequencyHz;
+    uint32_t nameOffset;
+    uint32_t vendorOffset;
+};
+
+struct CameraRecord {
+    uint32_t idOffset;
+    int32_t facing;
+    int32_t clusterType;
+    int32_t width;
+    int32_t height;
+    int32_t maxFps;
+    uint32_t isPhysicalCamera;
+    uint32_t physicalIdsOffset;
+    // CameraCalibration
+    float intrinsics[5];
+    float distortion[5];
+    float poseRotation[4];
+    float poseTranslation[3];
+    int32_t poseReference;
+    int32_t activeArrayWidth;
+    int32_t activeArrayHeight;
+    uint32_t calibrationFlags;
+};
+
+constexpr uint32_t kHasIntrinsics = 1u << 0;
+constexpr uint32_t kHasDistortion = 1u << 1;
+constexpr uint32_t kHasPose = 1u << 2;
+
+static_assert(sizeof(FileHeader) == 48, "FileHeader layout changed");
+static_assert(sizeof(SensorRecord) == 28, "SensorRecord layout changed");
+static_assert(sizeof(CameraRecord) == 116, "CameraRecord layout changed");
+
+/// Null-terminated string table builder
+class StringTable {
+public:
+    uint32_t add(const char* str) {
+        const auto offset = static_cast<uint32_t>(data_.size());
+        const char* s = str ? str : "";
+        data_.insert(data_.end(), s, s + std::strlen(s) + 1);
+        return offset;
+    }
+
+    [[nodiscard]] const std::vector<char>& data() const noexcept { return data_; }
+
+private:
+    std::vector<char> data_;
+};
+
+bool sameString(const char* a, const char* b) noexcept {
+    return std::strcmp(a ? a : "", b ? b : "") == 0;
+}
+
+void packCalibration(const CameraCalibration& calibration, CameraRecord& record) noexcept {
+    const float intrinsics[5] = {calibration.fx, calibration.fy, calibration.cx,
+                                 calibration.cy, calibration.skew};
+    std::memcpy(record.intrinsics, intrinsics, sizeof(intrinsics));
+    std::memcpy(record.distortion, calibration.distortion, sizeof(record.distortion));
+    std::memcpy(record.poseRotation, calibration.poseRotation, sizeof(record.poseRotation));
+    std::memcpy(record.poseTranslation, calibration.poseTranslation, sizeof(record.poseTranslation));
+    record.poseReference = static_cast<int32_t>(calibration.poseReference);
+    record.activeArrayWidth = calibration.activeArrayWidth;
+    record.activeArrayHeight = calibration.activeArrayHeight;
+    record.calibrationFlags = (calibration.hasIntrinsics ? kHasIntrinsics : 0u) |
+                              (calibration.hasDistortion ? kHasDistortion : 0u) |
+                              (calibration.hasPose ? kHasPose : 0u);
+}
+
+CameraCalibration unpackCalibration(const CameraRecord& record) noexcept {
+    CameraCalibration calibration;
+    calibration.fx = record.intrinsics[0];
+    calibration.fy = record.intrinsics[1];
+    calibration.cx = record.intrinsics[2];
+    calibration.cy = record.intrinsics[3];
+    calibration.skew = record.intrinsics[4];
+    std::memcpy(calibration.distortion, record.distortion, sizeof(record.distortion));
+    std::memcpy(calibration.poseRotation, record.poseRotation, sizeof(record.poseRotation));
+    std::memcpy(calibration.poseTranslation, record.poseTranslation, sizeof(record.poseTranslation));
+    calibration.poseReference = static_cast<LensPoseReference>(record.poseReference);
+    calibration.activeArrayWidth = record.activeArrayWidth;
+    calibration.activeArrayHeight = record.activeArrayHeight;
+    calibration.hasIntrinsics = (record.calibrationFlags & kHasIntrinsics) != 0;
+    calibration.hasDistortion = (record.calibrationFlags & kHasDistortion) != 0;
+    calibration.hasPose = (record.calibrationFlags & kHasPose) != 0;
+    return calibration;
+}
+
+/// Field-wise comparison; byte comparison would trip over struct padding
+bool sameCalibration(const CameraCalibration& a, const CameraCalibration& b) noexcept {
+    CameraRecord ra{};
+    CameraRecord rb{};
+    packCalibration(a, ra);
+    packCalibration(b, rb);
+    return std::memcmp(&ra, &rb, sizeof(CameraRecord)) == 0;
+}
+
+}  // namespace
+
+CapabilityCache::CapabilityCache(std::string path, std::string fingerprint)
+    : path_(std::move(path)),
+      fingerprint_(std::move(fingerprint)),
+      fingerprintHash_(fnv1a64(fingerprint_)) {}
+
+CapabilityCache::~CapabilityCache() {
+    unmap();
+}
+
+void CapabilityCache::unmap() noexcept {
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+        mapping_ = nullptr;
+        mappingSize_ = 0;
+    }
+}
+
+bool CapabilityCache::load() {
+    unmap();
+    valid_ = false;
+    sensors_.clear();
+    cameras_.clear();
+
+    const int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGI("No capability cache at %s", path_.c_str());
+        return false;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        LOGW("Capability cache too small, ignoring");
+        ::close(fd);
+        return false;
+    }
+
+    mappingSize_ = static_cast<size_t>(st.st_size);
+    mapping_ = mmap(nullptr, mappingSize_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping_ == MAP_FAILED) {
+        LOGE("Failed to map capability cache");
+        mapping_ = nullptr;
+        mappingSize_ = 0;
+        return false;
+    }
+
+    const auto* base = static_cast<const uint8_t*>(mapping_);
+    FileHeader header{};
+    std::memcpy(&header, base, sizeof(header));
+
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kFormatVersion ||
+        header.headerSize != sizeof(FileHeader)) {
+        LOGW("Capability cache format mismatch (version %u), ignoring", header.version);
+        unmap();
+        return false;
+    }
+
+    if (header.fingerprintHash != fingerprintHash_) {
+        LOGI("Capability cache belongs to a different device/build, ignoring");
+        unmap();
+        return false;
+    }
+
+    const uint8_t* payload = base + sizeof(FileHeader);
+    const size_t recordsSize = header.sensorCount * sizeof(SensorRecord) +
+                               header.cameraCount * sizeof(CameraRecord);
+    if (sizeof(FileHeader) + header.payloadSize != mappingSize_ ||
+        header.stringsOffset != recordsSize ||
+        header.stringsOffset > header.payloadSize ||
+        fnv1a32(payload, header.payloadSize) != header.payloadChecksum) {
+        LOGW("Capability cache corrupt, ignoring");
+        unmap();
+        return false;
+    }
+
+    const char* strings = reinterpret_cast<const char*>(payload + header.stringsOffset);
+    const size_t stringsSize = header.payloadSize - header.stringsOffset;
+    // The table is null-terminated by construction; guard the last byte anyway
+    if (stringsSize == 0 || strings[stringsSize - 1] != '\0') {
+        LOGW("Capability cache string table corrupt, ignoring");
+        unmap();
+        return false;
+    }
+    auto stringAt = [&](uint32_t offset) -> const char* {
+        return offset < stringsSize ? strings + offset : "";
+    };
+
+    const uint8_t* cursor = payload;
+    sensors_.reserve(header.sensorCount);
+    for (uint32_t i = 0; i < header.sensorCount; ++i, cursor += sizeof(SensorRecord)) {
+        SensorRecord record{};
+        std::memcpy(&record, cursor, sizeof(record));
+
+        SensorInfo info{};
+        info.handle = record.handle;
+        info.type = static_cast<SensorType>(record.type);
+        info.name = stringAt(record.nameOffset);
+        info.vendor = stringAt(record.vendorOffset);
+        info.minDelayUs = record.minDelayUs;
+        info.maxFrequencyHz = record.maxFrequencyHz;
+        info.fifoReserved = record.fifoReserved;
+        sensors_.push_back(info);
+    }
+
+    cameras_.reserve(header.cameraCount);
+    for (uint32_t i = 0; i < header.cameraCount; ++i, cursor += sizeof(CameraRecord)) {
+        CameraRecord record{};
+        std::memcpy(&record, cursor, sizeof(record));
+
+        CameraInfo info;
+        info.id = stringAt(record.idOffset);
+        info.facing = static_cast<CameraFacing>(record.facing);
+        info.clusterType = static_cast<CameraClusterType>(record.clusterType);
+        info.width = record.width;
+        info.height = record.height;
+        info.maxFps = record.maxFps;
+        info.isPhysicalCamera = record.isPhysicalCamera != 0;
+        info.physicalCameraIds = stringAt(record.physicalIdsOffset);
+        info.calibration = unpackCalibration(record);
+        cameras_.push_back(std::move(info));
+    }
+
+    valid_ = true;
+    LOGI("Capability cache hit: %zu sensors, %zu cameras", sensors_.size(), cameras_.size());
+    return true;
+}
+
+bool CapabilityCache::matches(const std::vector<SensorInfo>& sensors,
+                              const std::vector<CameraInfo>& cameras) const {
+    if (!valid_ || sensors.size() != sensors_.size() || cameras.size() != cameras_.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < sensors.size(); ++i) {
+        const auto& a = sensors[i];
+        const auto& b = sensors_[i];
+        if (a.handle != b.handle || a.type != b.type || a.minDelayUs != b.minDelayUs ||
+            a.fifoReserved != b.fifoReserved || a.maxFrequencyHz != b.maxFrequencyHz ||
+            !sameString(a.name, b.name) || !sameString(a.vendor, b.vendor)) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < cameras.size(); ++i) {
+        const auto& a = cameras[i];
+        const auto& b = cameras_[i];
+        if (a.id != b.id || a.facing != b.facing || a.clusterType != b.clusterType ||
+            a.width != b.width || a.height != b.height || a.maxFps != b.maxFps ||
+            a.isPhysicalCamera != b.isPhysicalCamera ||
+            a.physicalCameraIds != b.physicalCameraIds ||
+            !sameCalibration(a.calibration, b.calibration)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CapabilityCache::store(const std::vector<SensorInfo>& sensors,
+                            const std::vector<CameraInfo>& cameras) const {
+    StringTable strings;
+    std::vector<SensorRecord> sensorRecords;
+    std::vector<CameraRecord> cameraRecords;
+    sensorRecords.reserve(sensors.size());
+    cameraRecords.reserve(cameras.size());
+
+    for (const auto& sensor : sensors) {
+        SensorRecord record{};
+        record.handle = sensor.handle;
+        record.type = static_cast<int32_t>(sensor.type);
+        record.minDelayUs = sensor.minDelayUs;
+        record.fifoReserved = sensor.fifoReserved;
+        record.maxFrequencyHz = sensor.maxFrequencyHz;
+        record.nameOffset = strings.add(sensor.name);
+        record.vendorOffset = strings.add(sensor.vendor);
+        sensorRecords.push_back(record);
+    }
+
+    for (const auto& camera : cameras) {
+        CameraRecord record{};
+        record.idOffset = strings.add(camera.id.c_str());
+        record.facing = static_cast<int32_t>(camera.facing);
+        record.clusterType = static_cast<int32_t>(camera.clusterType);
+        record.width = camera.width;
+        record.height = camera.height;
+        record.maxFps = camera.maxFps;
+        record.isPhysicalCamera = camera.isPhysicalCamera ? 1 : 0;
+        record.physicalIdsOffset = strings.add(camera.physicalCameraIds.c_str());
+        packCalibration(camera.calibration, record);
+        cameraRecords.push_back(record);
+    }
+    if (strings.data().empty()) {
+        strings.add("");
+    }
+
+    std::vector<uint8_t> payload;
+    const size_t sensorBytes = sensorRecords.size() * sizeof(SensorRecord);
+    const size_t cameraBytes = cameraRecords.size() * sizeof(CameraRecord);
+    payload.resize(sensorBytes + cameraBytes + strings.data().size());
+    std::memcpy(payload.data(), sensorRecords.data(), sensorBytes);
+    std::memcpy(payload.data() + sensorBytes, cameraRecords.data(), cameraBytes);
+    std::memcpy(payload.data() + sensorBytes + cameraBytes,
+                strings.data().data(), strings.data().size());
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.headerSize = sizeof(FileHeader);
+    header.fingerprintHash = fingerprintHash_;
+    header.sensorCount = static_cast<uint32_t>(sensorRecords.size());
+    header.cameraCount = static_cast<uint32_t>(cameraRecords.size());
+    header.stringsOffset = static_cast<uint32_t>(sensorBytes + cameraBytes);
+    header.payloadSize = static_cast<uint32_t>(payload.size());
+    header.payloadChecksum = fnv1a32(payload.data(), payload.size());
+
+    const std::string tmpPath = path_ + ".tmp";
+    const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        LOGE("Failed to create %s", tmpPath.c_str());
+        return false;
+    }
+
+    const bool ok = writeAll(fd, &header, sizeof(header)) &&
+                    writeAll(fd, payload.data(), payload.size()) &&
+                    ::fsync(fd) == 0;
+    ::close(fd);
+
+    if (!ok || ::rename(tmpPath.c_str(), path_.c_str()) != 0) {
+        LOGE("Failed to write capability cache %s", path_.c_str());
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+
+    LOGI("Capability cache written: %zu sensors, %zu cameras, %zu bytes",
+         sensors.size(), cameras.size(), sizeof(header) + payload.size());
+    return true;
+}
+
+std::string CapabilityCache::deviceFingerprint() {
+#if defined(__ANDROID__)
+    char value[PROP_VALUE_MAX] = {};
+    if (__system_property_get("ro.build.fingerprint", value) > 0) {
+        return value;
+    }
+#endif
+    struct utsname name{};
+    if (uname(&name) == 0) {
+        return std::string(name.nodename) + "/" + name.release + "/" + name.machine;
+    }
+    return "unknown";
+}
+
+}  // namespace nativesensor
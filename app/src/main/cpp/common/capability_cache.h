@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "camera_data.h"
+#include "sensor_types.h"
+
+namespace nativesensor {
+
+/// Persistent, versioned cache of device capabilities (IMU sensor list and
+/// camera enumeration results, including lens calibration) that don't change
+/// between app launches.
+///
+/// The file is memory-mapped read-only at startup and validated cheaply
+/// (magic, format version, device fingerprint hash, payload checksum).
+/// Sensor name/vendor strings point into the mapping, which stays alive for
+/// the lifetime of this object. Writes go to a temp file followed by an
+/// atomic rename, so a concurrent reader never observes a partial file.
+class CapabilityCache {
+public:
+    /// Bump whenever the file layout or classification heuristics change
+    static constexpr uint32_t kFormatVersion = 3;
+
+    /// @param path Cache file path (e.g. <cacheDir>/capabilities.bin)
+    /// @param fingerprint Device/build fingerprint the cache is keyed by
+    CapabilityCache(std::string path, std::string fingerprint);
+    ~CapabilityCache();
+
+    CapabilityCache(const CapabilityCache&) = delete;
+    CapabilityCache& operator=(const CapabilityCache&) = delete;
+
+    /// Map and validate the cache file. Returns true on a valid hit.
+    bool load();
+
+    /// Check if load() found a valid cache
+    [[nodiscard]]
+    bool isValid() const noexcept { return valid_; }
+
+    /// Cached IMU sensors (valid only if isValid())
+    [[nodiscard]]
+    const std::vector<SensorInfo>& sensors() const noexcept { return sensors_; }
+
+    /// Cached cameras (valid only if isValid())
+    [[nodiscard]]
+    const std::vector<CameraInfo>& cameras() const noexcept { return cameras_; }
+
+    /// Check whether fresh enumeration results equal the cached ones
+    [[nodiscard]]
+    bool matches(const std::vector<SensorInfo>& sensors,
+                 const std::vector<CameraInfo>& cameras) const;
+
+    /// Serialize and atomically replace the cache file.
+    /// Does not affect the currently mapped contents.
+    bool store(const std::vector<SensorInfo>& sensors,
+               const std::vector<CameraInfo>& cameras) const;
+
+    /// Fingerprint of the running device and OS build
+    [[nodiscard]]
+    static std::string deviceFingerprint();
+
+private:
+    void unmap() noexcept;
+
+    std::string path_;
+    std::string fingerprint_;
+    uint64_t fingerprintHash_ = 0;
+
+    void* mapping_ = nullptr;
+    size_t mappingSize_ = 0;
+    bool valid_ = false;
+
+    std::vector<SensorInfo> sensors_;
+    std::vector<CameraInfo> cameras_;
+};
+
+}  // namespace nativesensor
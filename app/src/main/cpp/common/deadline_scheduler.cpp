@@ -0,0 +1,216 @@
+#include "deadline_scheduler.h"
+
+#include <android/log.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <ctime>
+
+#include "time_utils.h"
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.Deadline";
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+namespace {
+
+// Smoothing gains of the work estimator (RFC 6298 alpha/beta)
+constexpr double kWorkMeanGain = 1.0 / 8.0;
+constexpr double kWorkDevGain = 1.0 / 4.0;
+constexpr double kWorkDevFactor = 4.0;
+
+// Gain of the vsync period estimate
+constexpr double kPeriodGain = 1.0 / 16.0;
+
+constexpr float kNsToUs = 1'000.0f;
+
+}  // namespace
+
+TimestampNs BootFrameClock::nowNs() const {
+    return getBootTimeNs();
+}
+
+void BootFrameClock::sleepUntil(TimestampNs targetNs) {
+    struct timespec ts{};
+    ts.tv_sec = static_cast<time_t>(targetNs / kNsPerSecond);
+    ts.tv_nsec = static_cast<long>(targetNs % kNsPerSecond);
+    while (clock_nanosleep(CLOCK_BOOTTIME, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+void SimulatedFrameClock::sleepUntil(TimestampNs targetNs) {
+    TimestampNs now = nowNs_.load(std::memory_order_acquire);
+    while (now < targetNs &&
+           !nowNs_.compare_exchange_weak(now, targetNs, std::memory_order_acq_rel)) {
+    }
+}
+
+DeadlineScheduler::DeadlineScheduler(FrameClock& clock, DeadlineSchedulerConfig config)
+    : clock_(clock),
+      config_(config),
+      periodEstimateNs_(static_cast<double>(config.defaultPeriodNs)) {}
+
+DeadlineScheduler::~DeadlineScheduler() {
+    stop();
+}
+
+void DeadlineScheduler::onVsync(const FrameTimeline& timeline) {
+    std::lock_guard<std::mutex> lock(timelineMutex_);
+    if (hasTimeline_ && timeline.vsyncNs > lastTimeline_.vsyncNs) {
+        // Missed callbacks show up as multi-period gaps; fold them back to one period
+        const double delta = static_cast<double>(timeline.vsyncNs - lastTimeline_.vsyncNs);
+        const double periods = std::max(1.0, std::round(delta / periodEstimateNs_));
+        periodEstimateNs_ += (delta / periods - periodEstimateNs_) * kPeriodGain;
+    }
+    lastTimeline_ = timeline;
+    hasTimeline_ = true;
+}
+
+int64_t DeadlineScheduler::periodNs() const {
+    std::lock_guard<std::mutex> lock(timelineMutex_);
+    return static_cast<int64_t>(periodEstimateNs_);
+}
+
+int64_t DeadlineScheduler::workBudgetNs() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return static_cast<int64_t>(workMeanNs_ + kWorkDevFactor * workDevNs_);
+}
+
+TimestampNs DeadlineScheduler::plannedStartNs(const FrameTimeline& frame) const {
+    const int64_t budget = std::clamp(workBudgetNs(), config_.minWorkEstimateNs, periodNs());
+    return frame.deadlineNs - budget - config_.safetyMarginNs;
+}
+
+FrameTimeline DeadlineScheduler::nextFrame(TimestampNs nowNs) const {
+    FrameTimeline frame;
+    int64_t period;
+    {
+        std::lock_guard<std::mutex> lock(timelineMutex_);
+        period = static_cast<int64_t>(periodEstimateNs_);
+        if (hasTimeline_) {
+            frame = lastTimeline_;
+        } else {
+            frame.vsyncNs = nowNs + period;
+            frame.deadlineNs = frame.vsyncNs + config_.deadlineOffsetNs;
+            frame.presentNs = frame.vsyncNs + config_.presentOffsetNs;
+        }
+    }
+
+    // Extrapolate whole periods until the planned start is still ahead of us
+    const TimestampNs start = plannedStartNs(frame);
+    if (start < nowNs && period > 0) {
+        const int64_t periods = (nowNs - start + period - 1) / period;
+        frame.vsyncNs += periods * period;
+        frame.deadlineNs += periods * period;
+        frame.presentNs += periods * period;
+    }
+    return frame;
+}
+
+bool DeadlineScheduler::runFrame(const FrameTimeline& frame, const FrameTask& task) {
+    const TimestampNs plannedNs = plannedStartNs(frame);
+    clock_.sleepUntil(plannedNs);
+
+    const TimestampNs startNs = clock_.nowNs();
+    const TimestampNs inputNs = task ? task(frame) : 0;
+    const TimestampNs finishNs = clock_.nowNs();
+
+    const auto workNs = static_cast<double>(finishNs - startNs);
+    const bool met = finishNs <= frame.deadlineNs;
+
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    if (stats_.frames == 0) {
+        workMeanNs_ = workNs;
+        workDevNs_ = workNs / 2.0;
+    } else {
+        const double error = workNs - workMeanNs_;
+        workMeanNs_ += error * kWorkMeanGain;
+        workDevNs_ += (std::abs(error) - workDevNs_) * kWorkDevGain;
+    }
+
+    stats_.frames++;
+    if (!met) {
+        stats_.misses++;
+    }
+    stats_.maxWorkUs = std::max(stats_.maxWorkUs, static_cast<float>(workNs) / kNsToUs);
+    totalWorkNs_ += workNs;
+    totalSlackNs_ += static_cast<double>(frame.deadlineNs - finishNs);
+    totalWakeLateNs_ += static_cast<double>(std::max<int64_t>(0, startNs - plannedNs));
+    if (inputNs > 0) {
+        totalInputAgeNs_ += static_cast<double>(finishNs - inputNs);
+        inputFrames_++;
+    }
+    return met;
+}
+
+void DeadlineScheduler::start(FrameTask task) {
+    if (running_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    task_ = std::move(task);
+    thread_ = std::thread(&DeadlineScheduler::threadLoop, this);
+    LOGI("Deadline scheduler started");
+}
+
+void DeadlineScheduler::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    LOGI("Deadline scheduler stopped");
+}
+
+void DeadlineScheduler::threadLoop() {
+    TimestampNs lastVsyncNs = 0;
+    while (running_.load(std::memory_order_acquire)) {
+        FrameTimeline frame = nextFrame(clock_.nowNs());
+        const int64_t period = periodNs();
+
+        if (lastVsyncNs > 0 && period > 0) {
+            if (frame.vsyncNs - lastVsyncNs < period / 2) {
+                // Already served this frame; target the next one
+                frame.vsyncNs += period;
+                frame.deadlineNs += period;
+                frame.presentNs += period;
+            } else {
+                const int64_t gap = (frame.vsyncNs - lastVsyncNs + period / 2) / period;
+                if (gap > 1) {
+                    std::lock_guard<std::mutex> lock(statsMutex_);
+                    stats_.skipped += gap - 1;
+                }
+            }
+        }
+
+        runFrame(frame, task_);
+        lastVsyncNs = frame.vsyncNs;
+    }
+}
+
+DeadlineStats DeadlineScheduler::getStats() const {
+    const int64_t budget = std::clamp(workBudgetNs(), config_.minWorkEstimateNs, periodNs());
+    const int64_t period = periodNs();
+
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    DeadlineStats stats = stats_;
+    if (stats.frames > 0) {
+        const auto frames = static_cast<double>(stats.frames);
+        stats.avgWorkUs = static_cast<float>(totalWorkNs_ / frames) / kNsToUs;
+        stats.avgSlackUs = static_cast<float>(totalSlackNs_ / frames) / kNsToUs;
+        stats.avgWakeLateUs = static_cast<float>(totalWakeLateNs_ / frames) / kNsToUs;
+    }
+    if (inputFrames_ > 0) {
+        stats.avgInputAgeUs =
+            static_cast<float>(totalInputAgeNs_ / static_cast<double>(inputFrames_)) / kNsToUs;
+    }
+    stats.workBudgetUs = static_cast<float>(budget) / kNsToUs;
+    stats.vsyncPeriodMs = static_cast<float>(period) / static_cast<float>(kNsPerMs);
+    return stats;
+}
+
+}  // namespace nativesensor
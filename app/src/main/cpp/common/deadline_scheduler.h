@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "sensor_types.h"
+
+namespace nativesensor {
+
+/// Time source for frame-synchronous scheduling (CLOCK_BOOTTIME timebase)
+class FrameClock {
+public:
+    virtual ~FrameClock() = default;
+
+    [[nodiscard]]
+    virtual TimestampNs nowNs() const = 0;
+
+    /// Block until the clock reaches targetNs (returns at once if already past)
+    virtual void sleepUntil(TimestampNs targetNs) = 0;
+};
+
+/// Real clock: CLOCK_BOOTTIME with absolute-deadline sleeps
+class BootFrameClock final : public FrameClock {
+public:
+    [[nodiscard]]
+    TimestampNs nowNs() const override;
+    void sleepUntil(TimestampNs targetNs) override;
+};
+
+/// Deterministic clock for tests and offline simulation.
+/// Sleeping jumps virtual time forward; advance() models work duration.
+class SimulatedFrameClock final : public FrameClock {
+public:
+    explicit SimulatedFrameClock(TimestampNs startNs = 0) : nowNs_(startNs) {}
+
+    [[nodiscard]]
+    TimestampNs nowNs() const override { return nowNs_.load(std::memory_order_acquire); }
+
+    void sleepUntil(TimestampNs targetNs) override;
+
+    /// Move virtual time forward by deltaNs
+    void advance(int64_t deltaNs) { nowNs_.fetch_add(deltaNs, std::memory_order_acq_rel); }
+
+private:
+    std::atomic<TimestampNs> nowNs_;
+};
+
+/// One display frame
+struct FrameTimeline {
+    TimestampNs vsyncNs = 0;        // Vsync that starts the frame
+    TimestampNs deadlineNs = 0;     // Latest time the frame's pose must be ready
+    TimestampNs presentNs = 0;      // Expected presentation time (prediction target)
+};
+
+/// Scheduler tuning; offsets are only used until real timelines arrive
+struct DeadlineSchedulerConfig {
+    int64_t defaultPeriodNs = 16'666'667;       // 60 Hz
+    int64_t deadlineOffsetNs = -2'000'000;      // Deadline relative to vsync
+    int64_t presentOffsetNs = 16'666'667;       // Presentation relative to vsync
+    int64_t safetyMarginNs = 500'000;           // Slack for wakeup jitter
+    int64_t minWorkEstimateNs = 50'000;
+};
+
+/// Deadline statistics
+struct DeadlineStats {
+    int64_t frames = 0;             // Frames the task ran for
+    int64_t misses = 0;             // Frames finished after their deadline
+    int64_t skipped = 0;            // Frames that went by without a run
+    float avgWorkUs = 0.0f;         // Mean task duration
+    float maxWorkUs = 0.0f;         // Worst task duration
+    float workBudgetUs = 0.0f;      // Current work estimate used for planning
+    float avgSlackUs = 0.0f;        // Mean time left before the deadline at finish (negative = late)
+    float avgWakeLateUs = 0.0f;     // Mean delay between planned and actual start
+    float avgInputAgeUs = 0.0f;     // Mean age of the task's newest input at finish
+    float vsyncPeriodMs = 0.0f;     // Estimated display period
+};
+
+/// Runs a per-frame task (pose prediction) as late as possible before each
+/// display deadline, so it consumes the freshest IMU data yet finishes in time.
+///
+/// The start time is deadline - workBudget - safetyMargin, where the work
+/// budget tracks task duration with a smoothed mean plus four mean deviations
+/// (same estimator as TCP retransmission timeouts).
+class DeadlineScheduler {
+public:
+    /// Per-frame task. Returns the timestamp of the newest input it used (0 = none).
+    using FrameTask = std::function<TimestampNs(const FrameTimeline&)>;
+
+    explicit DeadlineScheduler(FrameClock& clock, DeadlineSchedulerConfig config = {});
+    ~DeadlineScheduler();
+
+    DeadlineScheduler(const DeadlineScheduler&) = delete;
+    DeadlineScheduler& operator=(const DeadlineScheduler&) = delete;
+
+    /// Feed a display timeline (Choreographer or simulated vsync). Thread-safe.
+    void onVsync(const FrameTimeline& timeline);
+
+    /// Earliest frame whose planned start is not in the past
+    [[nodiscard]]
+    FrameTimeline nextFrame(TimestampNs nowNs) const;
+
+    /// When work for the frame should start
+    [[nodiscard]]
+    TimestampNs plannedStartNs(const FrameTimeline& frame) const;
+
+    /// Sleep until the planned start, run the task and record statistics.
+    /// @return true if the task finished before the frame's deadline
+    bool runFrame(const FrameTimeline& frame, const FrameTask& task);
+
+    /// Run the task every frame on a dedicated thread
+    void start(FrameTask task);
+
+    /// Stop the frame thread (returns within about one frame)
+    void stop();
+
+    [[nodiscard]]
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    [[nodiscard]]
+    DeadlineStats getStats() const;
+
+private:
+    void threadLoop();
+    [[nodiscard]] int64_t workBudgetNs() const;
+    [[nodiscard]] int64_t periodNs() const;
+
+    FrameClock& clock_;
+    const DeadlineSchedulerConfig config_;
+
+    // Latest display timeline and period estimate
+    mutable std::mutex timelineMutex_;
+    FrameTimeline lastTimeline_;
+    bool hasTimeline_ = false;
+    double periodEstimateNs_;
+
+    // Work estimate and statistics
+    mutable std::mutex statsMutex_;
+    double workMeanNs_ = 0.0;
+    double workDevNs_ = 0.0;
+    DeadlineStats stats_;
+    double totalWorkNs_ = 0.0;
+    double totalSlackNs_ = 0.0;
+    double totalWakeLateNs_ = 0.0;
+    double totalInputAgeNs_ = 0.0;
+    int64_t inputFrames_ = 0;
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    FrameTask task_;
+};
+
+}  // namespace nativesensor
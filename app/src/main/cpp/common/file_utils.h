@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unistd.h>
+
+namespace nativesensor {
+
+/// write() until everything is written; false on error or short write
+inline bool writeAll(int fd, const void* data, size_t size) noexcept {
+    const auto* ptr = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        const ssize_t written = ::write(fd, ptr, size);
+        if (written <= 0) {
+            return false;
+        }
+        ptr += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+/// read() until `size` bytes arrived; false on error or early EOF
+inline bool readAll(int fd, void* data, size_t size) noexcept {
+    auto* ptr = static_cast<uint8_t*>(data);
+    while (size > 0) {
+        const ssize_t received = ::read(fd, ptr, size);
+        if (received <= 0) {
+            return false;
+        }
+        ptr += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+}  // namespace nativesensor
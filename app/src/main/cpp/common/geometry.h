@@ -0,0 +1,353 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "simd.h"
+#include "small_matrix.h"
+
+namespace nativesensor {
+
+/// 3-vector padded to one SIMD register. The pad lane is kept at zero.
+struct alignas(16) Vec3 {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    float pad = 0.0f;
+
+    constexpr Vec3() = default;
+    constexpr Vec3(float x_, float y_, float z_) : x(x_), y(y_), z(z_) {}
+
+    [[nodiscard]]
+    constexpr float operator[](size_t i) const { return i == 0 ? x : (i == 1 ? y : z); }
+};
+
+[[nodiscard]]
+constexpr Vec3 operator+(const Vec3& a, const Vec3& b) {
+    if (!simd::isConstantEvaluated()) {
+        Vec3 out;
+        simd::store(&out.x, simd::add(simd::load(&a.x), simd::load(&b.x)));
+        return out;
+    }
+    return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+[[nodiscard]]
+constexpr Vec3 operator-(const Vec3& a, const Vec3& b) {
+    if (!simd::isConstantEvaluated()) {
+        Vec3 out;
+        simd::store(&out.x, simd::sub(simd::load(&a.x), simd::load(&b.x)));
+        return out;
+    }
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+[[nodiscard]]
+constexpr Vec3 operator*(const Vec3& a, float s) {
+    if (!simd::isConstantEvaluated()) {
+        Vec3 out;
+        simd::store(&out.x, simd::mul(simd::load(&a.x), simd::splat(s)));
+        return out;
+    }
+    return {a.x * s, a.y * s, a.z * s};
+}
+
+[[nodiscard]]
+constexpr Vec3 operator*(float s, const Vec3& a) { return a * s; }
+
+[[nodiscard]]
+constexpr Vec3 operator-(const Vec3& a) { return a * -1.0f; }
+
+constexpr Vec3& operator+=(Vec3& a, const Vec3& b) { return a = a + b; }
+constexpr Vec3& operator-=(Vec3& a, const Vec3& b) { return a = a - b; }
+constexpr Vec3& operator*=(Vec3& a, float s) { return a = a * s; }
+
+[[nodiscard]]
+constexpr float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+namespace detail {
+/// a.yzx * b.zxy - a.zxy * b.yzx on registers; a zero pad lane stays 0
+inline simd::F4 cross(simd::F4 a, simd::F4 b) {
+    const simd::F4 lhs = simd::mul(simd::shuffle<1, 2, 0, 3>(a), simd::shuffle<2, 0, 1, 3>(b));
+    const simd::F4 rhs = simd::mul(simd::shuffle<2, 0, 1, 3>(a), simd::shuffle<1, 2, 0, 3>(b));
+    return simd::sub(lhs, rhs);
+}
+}  // namespace detail
+
+[[nodiscard]]
+constexpr Vec3 cross(const Vec3& a, const Vec3& b) {
+    if (!simd::isConstantEvaluated()) {
+        Vec3 out;
+        simd::store(&out.x, detail::cross(simd::load(&a.x), simd::load(&b.x)));
+        return out;
+    }
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+[[nodiscard]]
+inline float norm(const Vec3& v) { return std::sqrt(dot(v, v)); }
+
+[[nodiscard]]
+inline Vec3 normalized(const Vec3& v) {
+    const float n = norm(v);
+    return n > 0.0f ? v * (1.0f / n) : Vec3{};
+}
+
+/// 3x3 matrix stored as SIMD columns
+struct Mat3 {
+    Vec3 col[3];
+
+    [[nodiscard]]
+    static constexpr Mat3 identity() {
+        Mat3 out;
+        out.col[0] = {1.0f, 0.0f, 0.0f};
+        out.col[1] = {0.0f, 1.0f, 0.0f};
+        out.col[2] = {0.0f, 0.0f, 1.0f};
+        return out;
+    }
+
+    /// Build from row-major values
+    [[nodiscard]]
+    static constexpr Mat3 fromRows(const Vec3& r0, const Vec3& r1, const Vec3& r2) {
+        Mat3 out;
+        out.col[0] = {r0.x, r1.x, r2.x};
+        out.col[1] = {r0.y, r1.y, r2.y};
+        out.col[2] = {r0.z, r1.z, r2.z};
+        return out;
+    }
+
+    [[nodiscard]]
+    constexpr float operator()(size_t r, size_t c) const { return col[c][r]; }
+
+    [[nodiscard]]
+    constexpr Mat3 transposed() const {
+        return fromRows(col[0], col[1], col[2]);
+    }
+};
+
+/// M * v as a combination of columns (three multiply-adds in SIMD)
+[[nodiscard]]
+constexpr Vec3 operator*(const Mat3& m, const Vec3& v) {
+    if (!simd::isConstantEvaluated()) {
+        simd::F4 acc = simd::mul(simd::load(&m.col[0].x), simd::splat(v.x));
+        acc = simd::madd(simd::load(&m.col[1].x), simd::splat(v.y), acc);
+        acc = simd::madd(simd::load(&m.col[2].x), simd::splat(v.z), acc);
+        Vec3 out;
+        simd::store(&out.x, acc);
+        return out;
+    }
+    return m.col[0] * v.x + m.col[1] * v.y + m.col[2] * v.z;
+}
+
+[[nodiscard]]
+constexpr Mat3 operator*(const Mat3& a, const Mat3& b) {
+    Mat3 out;
+    for (size_t c = 0; c < 3; ++c) {
+        out.col[c] = a * b.col[c];
+    }
+    return out;
+}
+
+[[nodiscard]]
+constexpr Mat3 operator*(const Mat3& a, float s) {
+    Mat3 out;
+    for (size_t c = 0; c < 3; ++c) {
+        out.col[c] = a.col[c] * s;
+    }
+    return out;
+}
+
+[[nodiscard]]
+constexpr Mat3 operator+(const Mat3& a, const Mat3& b) {
+    Mat3 out;
+    for (size_t c = 0; c < 3; ++c) {
+        out.col[c] = a.col[c] + b.col[c];
+    }
+    return out;
+}
+
+/// Cross-product matrix: skew(a) * b == cross(a, b)
+[[nodiscard]]
+constexpr Mat3 skew(const Vec3& v) {
+    return Mat3::fromRows({0.0f, -v.z, v.y}, {v.z, 0.0f, -v.x}, {-v.y, v.x, 0.0f});
+}
+
+/// Unit quaternion (w, x, y, z) rotating body-frame vectors into the reference frame
+struct alignas(16) Quat {
+    float w = 1.0f;
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+
+    constexpr Quat() = default;
+    constexpr Quat(float w_, float x_, float y_, float z_) : w(w_), x(x_), y(y_), z(z_) {}
+
+    [[nodiscard]]
+    static constexpr Quat identity() { return {}; }
+
+    [[nodiscard]]
+    constexpr Vec3 vec() const { return {x, y, z}; }
+};
+
+namespace detail {
+// Keeps the x, y and z lanes, clears the pad
+alignas(16) inline constexpr float kVec3Lanes[4] = {1.0f, 1.0f, 1.0f, 0.0f};
+// Lane signs of the x, y and z terms of the SIMD Hamilton product
+alignas(16) inline constexpr float kQuatSignX[4] = {-1.0f, 1.0f, -1.0f, 1.0f};
+alignas(16) inline constexpr float kQuatSignY[4] = {-1.0f, 1.0f, 1.0f, -1.0f};
+alignas(16) inline constexpr float kQuatSignZ[4] = {-1.0f, -1.0f, 1.0f, 1.0f};
+}  // namespace detail
+
+/// Hamilton product
+[[nodiscard]]
+constexpr Quat operator*(const Quat& a, const Quat& b) {
+    if (!simd::isConstantEvaluated()) {
+        // Each lane of r = aw*B + ax*(-bx, bw, -bz, by) + ay*(-by, bz, bw, -bx) + az*(-bz, -by, bx, bw)
+        const simd::F4 vb = simd::load(&b.w);
+        simd::F4 acc = simd::mul(simd::splat(a.w), vb);
+        acc = simd::madd(simd::splat(a.x), simd::mul(simd::shuffle<1, 0, 3, 2>(vb), simd::load(detail::kQuatSignX)), acc);
+        acc = simd::madd(simd::splat(a.y), simd::mul(simd::shuffle<2, 3, 0, 1>(vb), simd::load(detail::kQuatSignY)), acc);
+        acc = simd::madd(simd::splat(a.z), simd::mul(simd::shuffle<3, 2, 1, 0>(vb), simd::load(detail::kQuatSignZ)), acc);
+        Quat out;
+        simd::store(&out.w, acc);
+        return out;
+    }
+    return {
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w
+    };
+}
+
+[[nodiscard]]
+constexpr Quat conjugate(const Quat& q) { return {q.w, -q.x, -q.y, -q.z}; }
+
+[[nodiscard]]
+constexpr float dot(const Quat& a, const Quat& b) {
+    return a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+[[nodiscard]]
+inline Quat normalized(const Quat& q) {
+    const float n = std::sqrt(dot(q, q));
+    if (n < 1e-6f) {
+        return {};
+    }
+    const float inv = 1.0f / n;
+    return {q.w * inv, q.x * inv, q.y * inv, q.z * inv};
+}
+
+/// Rotation matrix of a unit quaternion
+[[nodiscard]]
+constexpr Mat3 toMat3(const Quat& q) {
+    return Mat3::fromRows(
+        {1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y - q.w * q.z), 2.0f * (q.x * q.z + q.w * q.y)},
+        {2.0f * (q.x * q.y + q.w * q.z), 1.0f - 2.0f * (q.x * q.x + q.z * q.z), 2.0f * (q.y * q.z - q.w * q.x)},
+        {2.0f * (q.x * q.z - q.w * q.y), 2.0f * (q.y * q.z + q.w * q.x), 1.0f - 2.0f * (q.x * q.x + q.y * q.y)});
+}
+
+/// Rotate a vector: q * v * q^-1
+[[nodiscard]]
+constexpr Vec3 rotate(const Quat& q, const Vec3& v) {
+    if (!simd::isConstantEvaluated()) {
+        // Stay in registers: building u with q.vec() and reloading it costs
+        // a store-forwarding stall per call
+        const simd::F4 vq = simd::load(&q.w);
+        const simd::F4 u = simd::mul(simd::shuffle<1, 2, 3, 0>(vq), simd::load(detail::kVec3Lanes));
+        const simd::F4 vv = simd::load(&v.x);
+        const simd::F4 t = simd::mul(detail::cross(u, vv), simd::splat(2.0f));
+        Vec3 out;
+        simd::store(&out.x, simd::add(simd::madd(t, simd::splat(q.w), vv), detail::cross(u, t)));
+        return out;
+    }
+    const Vec3 u = q.vec();
+    const Vec3 t = cross(u, v) * 2.0f;
+    return v + t * q.w + cross(u, t);
+}
+
+namespace quat {
+
+constexpr float kSmallAngle = 1e-6f;
+
+/// Exponential map: quaternion of a rotation vector (axis * angle)
+[[nodiscard]]
+inline Quat fromRotationVector(const Vec3& r) {
+    const float angle = norm(r);
+    if (angle < kSmallAngle) {
+        return normalized(Quat{1.0f, 0.5f * r.x, 0.5f * r.y, 0.5f * r.z});
+    }
+    const float s = std::sin(0.5f * angle) / angle;
+    return {std::cos(0.5f * angle), r.x * s, r.y * s, r.z * s};
+}
+
+/// Logarithmic map: rotation vector of a unit quaternion (shortest arc)
+[[nodiscard]]
+inline Vec3 toRotationVector(const Quat& q) {
+    const float sign = q.w < 0.0f ? -1.0f : 1.0f;
+    const Vec3 v = q.vec();
+    const float vecNorm = norm(v);
+    if (vecNorm < kSmallAngle) {
+        return v * (2.0f * sign);
+    }
+    const float angle = 2.0f * std::atan2(vecNorm, sign * q.w);
+    return v * (sign * angle / vecNorm);
+}
+
+/// Shortest rotation taking unit vector `from` onto unit vector `to`
+[[nodiscard]]
+inline Quat fromTwoVectors(const Vec3& from, const Vec3& to) {
+    const Vec3 axis = cross(from, to);
+    const float sinAngle = norm(axis);
+    if (sinAngle < kSmallAngle) {
+        return dot(from, to) > 0.0f ? Quat{} : Quat{0.0f, 1.0f, 0.0f, 0.0f};
+    }
+    return fromRotationVector(axis * (std::atan2(sinAngle, dot(from, to)) / sinAngle));
+}
+
+/// Rotation angle between two orientations in radians
+[[nodiscard]]
+inline float angleBetween(const Quat& a, const Quat& b) {
+    return 2.0f * std::acos(std::min(1.0f, std::fabs(dot(a, b))));
+}
+
+}  // namespace quat
+
+/// Rigid transform: p_parent = rotation * p_child + translation
+struct RigidTransform {
+    Quat rotation;
+    Vec3 translation;
+};
+
+[[nodiscard]]
+constexpr Vec3 transformPoint(const RigidTransform& t, const Vec3& p) {
+    return rotate(t.rotation, p) + t.translation;
+}
+
+// Conversions to and from the general fixed-size matrices used for covariance
+
+[[nodiscard]]
+constexpr VecN<3> toVecN(const Vec3& v) {
+    VecN<3> out{};
+    out.m[0][0] = v.x;
+    out.m[1][0] = v.y;
+    out.m[2][0] = v.z;
+    return out;
+}
+
+[[nodiscard]]
+constexpr Vec3 toVec3(const VecN<3>& v) { return {v.m[0][0], v.m[1][0], v.m[2][0]}; }
+
+[[nodiscard]]
+constexpr MatN<3, 3> toMatN(const Mat3& m) {
+    MatN<3, 3> out{};
+    for (size_t r = 0; r < 3; ++r) {
+        for (size_t c = 0; c < 3; ++c) {
+            out.m[r][c] = m(r, c);
+        }
+    }
+    return out;
+}
+
+}  // namespace nativesensor
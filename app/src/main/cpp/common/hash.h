@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace nativesensor {
+
+/// FNV-1a: cheap enough to validate cache files on every launch
+[[nodiscard]]
+inline uint32_t fnv1a32(const uint8_t* data, size_t size) noexcept {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/// 64-bit FNV-1a, continuing from `hash` so keys can be built from several parts
+[[nodiscard]]
+inline uint64_t fnv1a64(const void* data, size_t size,
+                        uint64_t hash = 14695981039346656037ull) noexcept {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+[[nodiscard]]
+inline uint64_t fnv1a64(const std::string& str, uint64_t hash = 14695981039346656037ull) noexcept {
+    return fnv1a64(str.data(), str.size(), hash);
+}
+
+}  // namespace nativesensor
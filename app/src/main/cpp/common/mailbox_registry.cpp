@@ -0,0 +1,66 @@
+#include "mailbox_registry.h"
+
+#include <android/log.h>
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.Mailbox";
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+const MailboxRegistry::Entry* MailboxRegistry::findEntry(StreamId id) const noexcept {
+    const size_t count = count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        if (entries_[i].id == id) {
+            return &entries_[i];
+        }
+    }
+    return nullptr;
+}
+
+bool MailboxRegistry::typeMismatch(const Entry& entry, const void* type) const {
+    if (entry.type == type) {
+        return false;
+    }
+    LOGE("Stream %u (%s) requested with a different payload type", entry.id, entry.name.c_str());
+    return true;
+}
+
+MailboxRegistry::MailboxBase* MailboxRegistry::append(StreamId id, const void* type, const char* name,
+                                                      std::unique_ptr<MailboxBase> box) {
+    const size_t count = count_.load(std::memory_order_relaxed);
+    if (count == kMaxStreams) {
+        LOGE("Mailbox registry full, can't add stream %u (%s)", id, name);
+        return nullptr;
+    }
+    Entry& entry = entries_[count];
+    entry.id = id;
+    entry.type = type;
+    entry.name = name;
+    entry.box = std::move(box);
+    // Readers scan up to count_, so the entry must be complete before it's counted
+    count_.store(count + 1, std::memory_order_release);
+    LOGI("Registered stream %u (%s)", id, name);
+    return entry.box.get();
+}
+
+std::vector<MailboxRegistry::StreamInfo> MailboxRegistry::streams() const {
+    const size_t count = count_.load(std::memory_order_acquire);
+    std::vector<StreamInfo> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Entry& entry = entries_[i];
+        result.push_back({entry.id, entry.name, entry.box->version()});
+    }
+    return result;
+}
+
+bool MailboxRegistry::readFloats(StreamId id, std::vector<float>& out) const {
+    const Entry* entry = findEntry(id);
+    return entry && entry->box->flatten(out);
+}
+
+}  // namespace nativesensor
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "triple_buffer.h"
+
+namespace nativesensor {
+
+using StreamId = uint32_t;
+
+/// Well-known streams; ids from kFirstCustom on are free for new producers
+namespace streams {
+constexpr StreamId kAccel = 1;              // ImuSample
+constexpr StreamId kGyro = 2;               // ImuSample
+constexpr StreamId kImuStats = 3;           // ImuStats over the last second
+constexpr StreamId kFusedState = 4;         // FusedState from the ESKF
+constexpr StreamId kFramePose = 5;          // PredictedPose for the next display frame
+constexpr StreamId kCameraFrame = 6;        // FrameInfo of the newest capture result
+constexpr StreamId kFrameImuSync = 7;       // IMU coverage of the newest capture result
+constexpr StreamId kFirstCustom = 256;
+}  // namespace streams
+
+/// Flattens a value for generic consumers (JNI); layout is up to the producer
+template<typename T>
+using MailboxFlatten = void (*)(const T& value, std::vector<float>& out);
+
+/// Registry of typed latest-value mailboxes (TripleBuffer) keyed by stream id,
+/// so any thread can read the freshest value of any stream without locks and
+/// a new stream needs no new accessors.
+///
+/// Mailboxes are created on first use and live as long as the registry.
+/// Creation takes a lock; lookups and reads are lock-free. Each mailbox has
+/// a single writer.
+class MailboxRegistry {
+public:
+    static constexpr size_t kMaxStreams = 64;
+
+    struct StreamInfo {
+        StreamId id = 0;
+        std::string name;
+        uint64_t version = 0;           // Stores so far
+    };
+
+    MailboxRegistry() = default;
+
+    MailboxRegistry(const MailboxRegistry&) = delete;
+    MailboxRegistry& operator=(const MailboxRegistry&) = delete;
+
+    /// The mailbox of `id`, created if needed. nullptr if `id` holds another
+    /// type or the registry is full.
+    template<typename T>
+    TripleBuffer<T>* mailbox(StreamId id, const char* name, MailboxFlatten<T> flatten = nullptr) {
+        MailboxBase* box = add(id, typeTag<T>(), name, [flatten] {
+            return std::unique_ptr<MailboxBase>(std::make_unique<TypedMailbox<T>>(flatten));
+        });
+        return box ? &static_cast<TypedMailbox<T>*>(box)->buffer : nullptr;
+    }
+
+    /// Lock-free lookup; nullptr if `id` doesn't exist or holds another type
+    template<typename T>
+    [[nodiscard]]
+    const TripleBuffer<T>* find(StreamId id) const noexcept {
+        const Entry* entry = findEntry(id);
+        if (!entry || entry->type != typeTag<T>()) {
+            return nullptr;
+        }
+        return &static_cast<const TypedMailbox<T>*>(entry->box.get())->buffer;
+    }
+
+    [[nodiscard]]
+    std::vector<StreamInfo> streams() const;
+
+    /// Newest value of `id` through its flatten function; false if the
+    /// stream doesn't exist, is empty or has no flatten function
+    bool readFloats(StreamId id, std::vector<float>& out) const;
+
+private:
+    struct MailboxBase {
+        virtual ~MailboxBase() = default;
+        [[nodiscard]] virtual uint64_t version() const noexcept = 0;
+        virtual bool flatten(std::vector<float>& out) const = 0;
+    };
+
+    template<typename T>
+    struct TypedMailbox final : MailboxBase {
+        explicit TypedMailbox(MailboxFlatten<T> flattenValue) : flattenValue(flattenValue) {}
+
+        [[nodiscard]] uint64_t version() const noexcept override { return buffer.version(); }
+
+        bool flatten(std::vector<float>& out) const override {
+            T value;
+            if (!flattenValue || !buffer.load(value)) {
+                return false;
+            }
+            out.clear();
+            flattenValue(value, out);
+            return true;
+        }
+
+        TripleBuffer<T> buffer;
+        const MailboxFlatten<T> flattenValue;
+    };
+
+    struct Entry {
+        StreamId id = 0;
+        const void* type = nullptr;
+        std::string name;
+        std::unique_ptr<MailboxBase> box;
+    };
+
+    /// One address per payload type, for the lookup type check
+    template<typename T>
+    static const void* typeTag() noexcept {
+        static const char tag = 0;
+        return &tag;
+    }
+
+    template<typename Make>
+    MailboxBase* add(StreamId id, const void* type, const char* name, Make make) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (const Entry* existing = findEntry(id)) {
+            return typeMismatch(*existing, type) ? nullptr : existing->box.get();
+        }
+        return append(id, type, name, make());
+    }
+
+    [[nodiscard]] const Entry* findEntry(StreamId id) const noexcept;
+    [[nodiscard]] bool typeMismatch(const Entry& entry, const void* type) const;
+    MailboxBase* append(StreamId id, const void* type, const char* name, std::unique_ptr<MailboxBase> box);
+
+    std::array<Entry, kMaxStreams> entries_{};
+    std::atomic<size_t> count_{0};              // Entries below are immutable once counted
+    std::mutex mutex_;
+};
+
+}  // namespace nativesensor
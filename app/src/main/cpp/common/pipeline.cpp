@@ -0,0 +1,92 @@
+#include "pipeline.h"
+
+#include <algorithm>
+
+namespace nativesensor {
+
+namespace {
+constexpr double kNsToUs = 1'000.0;
+}
+
+void PipelineNode::schedule() {
+    if (!pipeline_ || pipeline_->stopped_.load(std::memory_order_acquire)) {
+        return;
+    }
+    // Both sides use RMWs on scheduled_: either we observe false and submit, or
+    // run()'s clearing exchange acquires our push and sees the new item
+    if (!scheduled_.exchange(true, std::memory_order_acq_rel)) {
+        pipeline_->submitRun(this, priority_);
+    }
+}
+
+void PipelineNode::run() {
+    runs_.fetch_add(1, std::memory_order_relaxed);
+    drain();
+
+    scheduled_.exchange(false, std::memory_order_acq_rel);
+
+    // Items that arrived after drain() returned but before scheduled_ was
+    // cleared were not scheduled by their producer; pick them up here
+    if (hasPendingInput() && !pipeline_->stopped_.load(std::memory_order_acquire) &&
+        !scheduled_.exchange(true, std::memory_order_acq_rel)) {
+        pipeline_->submitRun(this, priority_);
+    }
+}
+
+void PipelineNode::recordItem(int64_t elapsedNs) noexcept {
+    processed_.fetch_add(1, std::memory_order_relaxed);
+    totalNs_.fetch_add(elapsedNs, std::memory_order_relaxed);
+
+    int64_t prevMax = maxNs_.load(std::memory_order_relaxed);
+    while (elapsedNs > prevMax &&
+           !maxNs_.compare_exchange_weak(prevMax, elapsedNs, std::memory_order_relaxed)) {
+    }
+}
+
+NodeStats PipelineNode::getStats() const {
+    NodeStats stats;
+    stats.name = name_;
+    stats.processed = processed_.load(std::memory_order_relaxed);
+    stats.runs = runs_.load(std::memory_order_relaxed);
+    if (stats.processed > 0) {
+        stats.avgItemUs = static_cast<float>(
+            static_cast<double>(totalNs_.load(std::memory_order_relaxed)) / stats.processed / kNsToUs);
+    }
+    stats.maxItemUs = static_cast<float>(
+        static_cast<double>(maxNs_.load(std::memory_order_relaxed)) / kNsToUs);
+    inboundCounters(stats.dropped, stats.queued);
+    return stats;
+}
+
+void Pipeline::submitRun(PipelineNode* node, TaskPriority priority) {
+    activeRuns_.fetch_add(1, std::memory_order_acq_rel);
+    pool_.submit([this, node] {
+        node->run();
+        runFinished();
+    }, priority);
+}
+
+void Pipeline::runFinished() {
+    if (activeRuns_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+        idleCv_.notify_all();
+    }
+}
+
+void Pipeline::stop() {
+    stopped_.store(true, std::memory_order_release);
+    std::unique_lock<std::mutex> lock(idleMutex_);
+    idleCv_.wait(lock, [this] { return activeRuns_.load(std::memory_order_acquire) == 0; });
+}
+
+std::vector<NodeStats> Pipeline::getStats() const {
+    std::lock_guard<std::mutex> lock(graphMutex_);
+    std::vector<NodeStats> stats;
+    stats.reserve(nodes_.size());
+    for (const auto& node : nodes_) {
+        stats.push_back(node->getStats());
+    }
+    return stats;
+}
+
+}  // namespace nativesensor
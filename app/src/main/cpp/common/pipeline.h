@@ -0,0 +1,355 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "thread_pool.h"
+
+namespace nativesensor {
+
+/// What an edge does when its queue is full
+enum class BackpressurePolicy : uint8_t {
+    DropNewest = 0,     // Discard the incoming item (keeps producer wait-free)
+    DropOldest = 1,     // Evict the oldest queued item to make room
+    Block = 2           // Spin-yield until space frees up; never use on sensor threads
+};
+
+/// Per-node timing statistics
+struct NodeStats {
+    std::string name;
+    int64_t processed = 0;      // Items handled (emitted, for sources)
+    int64_t dropped = 0;        // Items dropped on inbound edges
+    int64_t runs = 0;           // Scheduled drain runs
+    float avgItemUs = 0.0f;     // Mean processing time per item
+    float maxItemUs = 0.0f;     // Worst single-item processing time
+    int64_t queued = 0;         // Items currently waiting on inbound edges
+};
+
+class Pipeline;
+class PipelineNode;
+
+/// Type-erased edge interface used by the scheduler
+class EdgeBase {
+public:
+    virtual ~EdgeBase() = default;
+
+    [[nodiscard]] virtual bool hasItems() const noexcept = 0;
+    [[nodiscard]] virtual size_t depth() const noexcept = 0;
+
+    [[nodiscard]]
+    int64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+    /// A disabled edge takes no new items: producers skip it, so a consumer
+    /// whose inbound edges are all disabled never runs. Edges start enabled.
+    void setEnabled(bool enabled) noexcept { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    [[nodiscard]]
+    bool enabled() const noexcept { return enabled_.load(std::memory_order_relaxed); }
+
+protected:
+    std::atomic<int64_t> dropped_{0};
+    std::atomic<bool> enabled_{true};
+};
+
+/// Base class of all pipeline nodes. A node is never run concurrently with
+/// itself, so stage functions may keep state without locking.
+class PipelineNode {
+public:
+    PipelineNode(std::string name, TaskPriority priority)
+        : name_(std::move(name)), priority_(priority) {}
+    virtual ~PipelineNode() = default;
+
+    PipelineNode(const PipelineNode&) = delete;
+    PipelineNode& operator=(const PipelineNode&) = delete;
+
+    [[nodiscard]]
+    const std::string& name() const noexcept { return name_; }
+
+    [[nodiscard]]
+    NodeStats getStats() const;
+
+protected:
+    friend class Pipeline;
+    template<typename> friend class Edge;
+
+    /// Process everything currently queued on inbound edges
+    virtual void drain() {}
+
+    /// Check if any inbound edge has queued items
+    [[nodiscard]] virtual bool hasPendingInput() const noexcept { return false; }
+
+    /// Sum of dropped items and queue depth over inbound edges
+    virtual void inboundCounters(int64_t& dropped, int64_t& queued) const noexcept {
+        dropped = 0;
+        queued = 0;
+    }
+
+    /// Make sure a drain run is queued on the pool (at most one in flight)
+    void schedule();
+
+    void recordItem(int64_t elapsedNs) noexcept;
+
+    Pipeline* pipeline_ = nullptr;
+
+private:
+    void run();
+
+    std::string name_;
+    TaskPriority priority_;
+    std::atomic<bool> scheduled_{false};
+
+    std::atomic<int64_t> processed_{0};
+    std::atomic<int64_t> runs_{0};
+    std::atomic<int64_t> totalNs_{0};
+    std::atomic<int64_t> maxNs_{0};
+};
+
+/// Bounded lock-free queue between two nodes
+template<typename T>
+class Edge : public EdgeBase {
+public:
+    Edge(PipelineNode* consumer, size_t capacity, BackpressurePolicy policy)
+        : queue_(capacity), consumer_(consumer), policy_(policy) {}
+
+    /// Enqueue according to the backpressure policy and wake the consumer
+    void push(const T& item) {
+        if (!queue_.tryPush(item)) {
+            switch (policy_) {
+                case BackpressurePolicy::DropNewest:
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    consumer_->schedule();
+                    return;
+                case BackpressurePolicy::DropOldest: {
+                    T evicted;
+                    while (!queue_.tryPush(item)) {
+                        if (queue_.tryPop(evicted)) {
+                            dropped_.fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                    break;
+                }
+                case BackpressurePolicy::Block:
+                    consumer_->schedule();
+                    while (!queue_.tryPush(item)) {
+                        std::this_thread::yield();
+                    }
+                    break;
+            }
+        }
+        consumer_->schedule();
+    }
+
+    bool pop(T& item) noexcept { return queue_.tryPop(item); }
+
+    [[nodiscard]] bool hasItems() const noexcept override { return !queue_.emptyApprox(); }
+    [[nodiscard]] size_t depth() const noexcept override { return queue_.sizeApprox(); }
+
+private:
+    BoundedQueue<T> queue_;
+    PipelineNode* consumer_;
+    BackpressurePolicy policy_;
+};
+
+/// Node that produces items of type T
+template<typename T>
+class Emitter {
+public:
+    virtual ~Emitter() = default;
+
+protected:
+    friend class Pipeline;
+
+    void emit(const T& item) {
+        for (auto* edge : outputs_) {
+            if (edge->enabled()) {
+                edge->push(item);
+            }
+        }
+    }
+
+    std::vector<Edge<T>*> outputs_;
+};
+
+/// Node that consumes items of type T from one or more inbound edges
+template<typename T>
+class Receiver : public PipelineNode {
+public:
+    using PipelineNode::PipelineNode;
+
+protected:
+    friend class Pipeline;
+
+    /// Handle one input item
+    virtual void process(const T& item) = 0;
+
+    void drain() override {
+        T item;
+        for (auto* edge : inputs_) {
+            // Bounded per run so a busy edge can't monopolize a worker;
+            // leftovers trigger a reschedule
+            for (size_t n = 0; n < kMaxItemsPerRun && edge->pop(item); ++n) {
+                const auto start = std::chrono::steady_clock::now();
+                process(item);
+                recordItem(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+            }
+        }
+    }
+
+    [[nodiscard]] bool hasPendingInput() const noexcept override {
+        for (auto* edge : inputs_) {
+            if (edge->hasItems()) return true;
+        }
+        return false;
+    }
+
+    void inboundCounters(int64_t& dropped, int64_t& queued) const noexcept override {
+        dropped = 0;
+        queued = 0;
+        for (auto* edge : inputs_) {
+            dropped += edge->dropped();
+            queued += static_cast<int64_t>(edge->depth());
+        }
+    }
+
+    std::vector<Edge<T>*> inputs_;
+
+private:
+    static constexpr size_t kMaxItemsPerRun = 256;
+};
+
+/// Entry point fed by an external producer (sensor thread, camera callback)
+template<typename T>
+class SourceNode : public PipelineNode, public Emitter<T> {
+public:
+    explicit SourceNode(std::string name)
+        : PipelineNode(std::move(name), TaskPriority::Tracking) {}
+
+    /// Fan an item out to all connected edges. Lock-free unless an edge uses Block.
+    void push(const T& item) {
+        this->emit(item);
+        recordItem(0);
+    }
+};
+
+/// Transform stage: fn returns true to emit `out` downstream
+template<typename In, typename Out>
+class StageNode : public Receiver<In>, public Emitter<Out> {
+public:
+    using Fn = std::function<bool(const In&, Out&)>;
+
+    StageNode(std::string name, Fn fn, TaskPriority priority)
+        : Receiver<In>(std::move(name), priority), fn_(std::move(fn)) {}
+
+protected:
+    void process(const In& item) override {
+        Out out{};
+        if (fn_(item, out)) {
+            this->emit(out);
+        }
+    }
+
+private:
+    Fn fn_;
+};
+
+/// Terminal stage
+template<typename T>
+class SinkNode : public Receiver<T> {
+public:
+    using Fn = std::function<void(const T&)>;
+
+    SinkNode(std::string name, Fn fn, TaskPriority priority)
+        : Receiver<T>(std::move(name), priority), fn_(std::move(fn)) {}
+
+protected:
+    void process(const T& item) override { fn_(item); }
+
+private:
+    Fn fn_;
+};
+
+/// Dataflow graph of sensor processing stages scheduled on a ThreadPool.
+/// Build the graph (add nodes, connect edges) before pushing data into sources.
+class Pipeline {
+public:
+    explicit Pipeline(ThreadPool& pool) : pool_(pool) {}
+    ~Pipeline() { stop(); }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    template<typename T>
+    SourceNode<T>* addSource(std::string name) {
+        return adopt(std::make_unique<SourceNode<T>>(std::move(name)));
+    }
+
+    template<typename In, typename Out>
+    StageNode<In, Out>* addStage(std::string name, typename StageNode<In, Out>::Fn fn,
+                                 TaskPriority priority = TaskPriority::Analysis) {
+        return adopt(std::make_unique<StageNode<In, Out>>(std::move(name), std::move(fn), priority));
+    }
+
+    template<typename T>
+    SinkNode<T>* addSink(std::string name, typename SinkNode<T>::Fn fn,
+                         TaskPriority priority = TaskPriority::Analysis) {
+        return adopt(std::make_unique<SinkNode<T>>(std::move(name), std::move(fn), priority));
+    }
+
+    /// Connect a producer to a consumer through a bounded edge
+    template<typename T>
+    Edge<T>* connect(Emitter<T>* from, Receiver<T>* to, size_t capacity,
+                     BackpressurePolicy policy = BackpressurePolicy::DropOldest) {
+        auto edge = std::make_unique<Edge<T>>(to, capacity, policy);
+        auto* ptr = edge.get();
+        std::lock_guard<std::mutex> lock(graphMutex_);
+        edges_.push_back(std::move(edge));
+        from->outputs_.push_back(ptr);
+        to->inputs_.push_back(ptr);
+        return ptr;
+    }
+
+    /// Stop scheduling new runs and wait for in-flight runs to finish
+    void stop();
+
+    /// Timing statistics for every node, in insertion order
+    [[nodiscard]]
+    std::vector<NodeStats> getStats() const;
+
+private:
+    friend class PipelineNode;
+
+    template<typename NodeT>
+    NodeT* adopt(std::unique_ptr<NodeT> node) {
+        node->pipeline_ = this;
+        auto* ptr = node.get();
+        std::lock_guard<std::mutex> lock(graphMutex_);
+        nodes_.push_back(std::move(node));
+        return ptr;
+    }
+
+    void submitRun(PipelineNode* node, TaskPriority priority);
+    void runFinished();
+
+    ThreadPool& pool_;
+    mutable std::mutex graphMutex_;
+    std::vector<std::unique_ptr<PipelineNode>> nodes_;
+    std::vector<std::unique_ptr<EdgeBase>> edges_;
+
+    std::atomic<bool> stopped_{false};
+    std::atomic<int64_t> activeRuns_{0};
+    std::mutex idleMutex_;
+    std::condition_variable idleCv_;
+};
+
+}  // namespace nativesensor
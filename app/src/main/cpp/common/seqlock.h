@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace nativesensor {
+
+/// Single-writer, multi-reader snapshot of a trivially copyable value.
+///
+/// The writer never blocks and readers never block the writer: a reader
+/// copies the value and retries if the sequence changed underneath it.
+/// The payload lives in relaxed/acquire-release atomic words (no fences,
+/// no data races), so the pattern is sanitizer-clean.
+template<typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock payload must be trivially copyable");
+
+public:
+    SeqLock() { store(T{}); }
+    explicit SeqLock(const T& initial) { store(initial); }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    /// Publish a new value. Only one thread may call store().
+    void store(const T& value) noexcept {
+        std::array<uint64_t, kWords> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        const uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_relaxed);
+        // Release on each word keeps the odd sequence ordered before the payload
+        for (size_t i = 0; i < kWords; ++i) {
+            words_[i].store(words[i], std::memory_order_release);
+        }
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+
+    /// Read a consistent copy. Wait-free unless it races a store, in which
+    /// case it retries (a store is a handful of word writes).
+    [[nodiscard]]
+    T load() const noexcept {
+        std::array<uint64_t, kWords> words{};
+        while (true) {
+            const uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            // Acquire on each word keeps the re-check below after the copy
+            for (size_t i = 0; i < kWords; ++i) {
+                words[i] = words_[i].load(std::memory_order_acquire);
+            }
+            if (sequence_.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+        T value;
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+    /// Changes on every store; lets readers skip unchanged snapshots
+    [[nodiscard]]
+    uint64_t version() const noexcept { return sequence_.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> sequence_{0};
+    std::array<std::atomic<uint64_t>, kWords> words_{};
+};
+
+}  // namespace nativesensor
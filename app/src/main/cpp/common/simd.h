@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+
+// 4-lane float SIMD used by the sensor math types. NEON on arm64 (always
+// available there), SSE on x86 hosts, plain arrays elsewhere. Define
+// NATIVESENSOR_NO_SIMD to force the scalar path (benchmark baseline).
+#if !defined(NATIVESENSOR_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define NATIVESENSOR_SIMD_NEON 1
+#elif !defined(NATIVESENSOR_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#include <xmmintrin.h>
+#define NATIVESENSOR_SIMD_SSE 1
+#endif
+
+namespace nativesensor::simd {
+
+/// True while the compiler evaluates a constant expression, so constexpr
+/// math can fall back to scalar code and use intrinsics at runtime
+constexpr bool isConstantEvaluated() noexcept {
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 9)
+    return __builtin_is_constant_evaluated();
+#else
+    return true;    // Unknown compiler: always take the scalar path
+#endif
+}
+
+#if defined(NATIVESENSOR_SIMD_NEON)
+
+struct F4 { float32x4_t v; };
+
+inline F4 load(const float* p) { return {vld1q_f32(p)}; }
+inline void store(float* p, F4 a) { vst1q_f32(p, a.v); }
+inline F4 splat(float s) { return {vdupq_n_f32(s)}; }
+inline F4 add(F4 a, F4 b) { return {vaddq_f32(a.v, b.v)}; }
+inline F4 sub(F4 a, F4 b) { return {vsubq_f32(a.v, b.v)}; }
+inline F4 mul(F4 a, F4 b) { return {vmulq_f32(a.v, b.v)}; }
+/// a * b + c
+inline F4 madd(F4 a, F4 b, F4 c) { return {vfmaq_f32(c.v, a.v, b.v)}; }
+
+template<int I0, int I1, int I2, int I3>
+inline F4 shuffle(F4 a) {
+#if defined(__clang__)
+    return {__builtin_shufflevector(a.v, a.v, I0, I1, I2, I3)};
+#else
+    const float32x4_t r = {vgetq_lane_f32(a.v, I0), vgetq_lane_f32(a.v, I1),
+                           vgetq_lane_f32(a.v, I2), vgetq_lane_f32(a.v, I3)};
+    return {r};
+#endif
+}
+
+#elif defined(NATIVESENSOR_SIMD_SSE)
+
+struct F4 { __m128 v; };
+
+inline F4 load(const float* p) { return {_mm_loadu_ps(p)}; }
+inline void store(float* p, F4 a) { _mm_storeu_ps(p, a.v); }
+inline F4 splat(float s) { return {_mm_set1_ps(s)}; }
+inline F4 add(F4 a, F4 b) { return {_mm_add_ps(a.v, b.v)}; }
+inline F4 sub(F4 a, F4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline F4 mul(F4 a, F4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline F4 madd(F4 a, F4 b, F4 c) { return {_mm_add_ps(_mm_mul_ps(a.v, b.v), c.v)}; }
+
+template<int I0, int I1, int I2, int I3>
+inline F4 shuffle(F4 a) {
+    return {_mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(I3, I2, I1, I0))};
+}
+
+#else
+
+struct F4 { float v[4]; };
+
+inline F4 load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void store(float* p, F4 a) {
+    for (int i = 0; i < 4; ++i) p[i] = a.v[i];
+}
+inline F4 splat(float s) { return {{s, s, s, s}}; }
+inline F4 add(F4 a, F4 b) { return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}}; }
+inline F4 sub(F4 a, F4 b) { return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}}; }
+inline F4 mul(F4 a, F4 b) { return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}}; }
+inline F4 madd(F4 a, F4 b, F4 c) { return add(mul(a, b), c); }
+
+template<int I0, int I1, int I2, int I3>
+inline F4 shuffle(F4 a) { return {{a.v[I0], a.v[I1], a.v[I2], a.v[I3]}}; }
+
+#endif
+
+/// y[i] += a * x[i] for i < n (row update of matrix products)
+inline void axpy(float a, const float* x, float* y, size_t n) {
+    size_t i = 0;
+#if defined(NATIVESENSOR_SIMD_NEON) || defined(NATIVESENSOR_SIMD_SSE)
+    const F4 scale = splat(a);
+    for (; i + 4 <= n; i += 4) {
+        store(y + i, madd(scale, load(x + i), load(y + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        y[i] += a * x[i];
+    }
+}
+
+}  // namespace nativesensor::simd
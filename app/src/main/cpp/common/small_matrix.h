@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#include "simd.h"
+
+namespace nativesensor {
+
+/// Fixed-size row-major float matrix with compile-time dimensions.
+/// Storage is inline (no heap), so filters can keep covariance and Jacobians
+/// on the stack and the compiler can fully unroll small products.
+template<size_t R, size_t C>
+struct MatN {
+    float m[R][C] = {};
+
+    static constexpr size_t kRows = R;
+    static constexpr size_t kCols = C;
+
+    [[nodiscard]]
+    static constexpr MatN zero() { return MatN{}; }
+
+    [[nodiscard]]
+    static constexpr MatN identity() {
+        static_assert(R == C, "identity() requires a square matrix");
+        MatN out{};
+        for (size_t i = 0; i < R; ++i) {
+            out.m[i][i] = 1.0f;
+        }
+        return out;
+    }
+
+    constexpr float& operator()(size_t r, size_t c) { return m[r][c]; }
+    constexpr float operator()(size_t r, size_t c) const { return m[r][c]; }
+
+    constexpr MatN& operator+=(const MatN& other) {
+        for (size_t r = 0; r < R; ++r) {
+            for (size_t c = 0; c < C; ++c) {
+                m[r][c] += other.m[r][c];
+            }
+        }
+        return *this;
+    }
+
+    constexpr MatN& operator-=(const MatN& other) {
+        for (size_t r = 0; r < R; ++r) {
+            for (size_t c = 0; c < C; ++c) {
+                m[r][c] -= other.m[r][c];
+            }
+        }
+        return *this;
+    }
+
+    constexpr MatN& operator*=(float s) {
+        for (size_t r = 0; r < R; ++r) {
+            for (size_t c = 0; c < C; ++c) {
+                m[r][c] *= s;
+            }
+        }
+        return *this;
+    }
+
+    [[nodiscard]]
+    constexpr MatN<C, R> transposed() const {
+        MatN<C, R> out{};
+        for (size_t r = 0; r < R; ++r) {
+            for (size_t c = 0; c < C; ++c) {
+                out.m[c][r] = m[r][c];
+            }
+        }
+        return out;
+    }
+
+    /// Copy of the BR x BC block starting at (row, col)
+    template<size_t BR, size_t BC>
+    [[nodiscard]]
+    constexpr MatN<BR, BC> block(size_t row, size_t col) const {
+        MatN<BR, BC> out{};
+        for (size_t r = 0; r < BR; ++r) {
+            for (size_t c = 0; c < BC; ++c) {
+                out.m[r][c] = m[row + r][col + c];
+            }
+        }
+        return out;
+    }
+
+    /// Overwrite the block starting at (row, col)
+    template<size_t BR, size_t BC>
+    constexpr void setBlock(size_t row, size_t col, const MatN<BR, BC>& value) {
+        for (size_t r = 0; r < BR; ++r) {
+            for (size_t c = 0; c < BC; ++c) {
+                m[row + r][col + c] = value.m[r][c];
+            }
+        }
+    }
+
+    /// Average with the transpose; keeps covariance symmetric against rounding drift
+    constexpr void symmetrize() {
+        static_assert(R == C, "symmetrize() requires a square matrix");
+        for (size_t r = 0; r < R; ++r) {
+            for (size_t c = r + 1; c < C; ++c) {
+                const float avg = 0.5f * (m[r][c] + m[c][r]);
+                m[r][c] = avg;
+                m[c][r] = avg;
+            }
+        }
+    }
+};
+
+template<size_t N>
+using VecN = MatN<N, 1>;
+
+template<size_t R, size_t C>
+[[nodiscard]]
+constexpr MatN<R, C> operator+(MatN<R, C> a, const MatN<R, C>& b) { return a += b; }
+
+template<size_t R, size_t C>
+[[nodiscard]]
+constexpr MatN<R, C> operator-(MatN<R, C> a, const MatN<R, C>& b) { return a -= b; }
+
+template<size_t R, size_t C>
+[[nodiscard]]
+constexpr MatN<R, C> operator*(MatN<R, C> a, float s) { return a *= s; }
+
+template<size_t R, size_t K, size_t C>
+[[nodiscard]]
+constexpr MatN<R, C> operator*(const MatN<R, K>& a, const MatN<K, C>& b) {
+    MatN<R, C> out{};
+    for (size_t r = 0; r < R; ++r) {
+        for (size_t k = 0; k < K; ++k) {
+            const float ark = a.m[r][k];
+            if (ark == 0.0f) {
+                continue;   // Filter Jacobians are mostly sparse
+            }
+            // Row-times-scalar accumulate: vectorized across columns at runtime
+            if (simd::isConstantEvaluated()) {
+                for (size_t c = 0; c < C; ++c) {
+                    out.m[r][c] += ark * b.m[k][c];
+                }
+            } else {
+                simd::axpy(ark, b.m[k], out.m[r], C);
+            }
+        }
+    }
+    return out;
+}
+
+/// Solve A X = B for symmetric positive-definite A via Cholesky.
+/// Returns false (and leaves x untouched) if A is not positive definite.
+template<size_t N, size_t C>
+bool solveSpd(const MatN<N, N>& a, const MatN<N, C>& b, MatN<N, C>& x) {
+    MatN<N, N> l{};
+    for (size_t j = 0; j < N; ++j) {
+        float diag = a.m[j][j];
+        for (size_t k = 0; k < j; ++k) {
+            diag -= l.m[j][k] * l.m[j][k];
+        }
+        if (!(diag > 0.0f)) {
+            return false;
+        }
+        l.m[j][j] = std::sqrt(diag);
+        for (size_t i = j + 1; i < N; ++i) {
+            float sum = a.m[i][j];
+            for (size_t k = 0; k < j; ++k) {
+                sum -= l.m[i][k] * l.m[j][k];
+            }
+            l.m[i][j] = sum / l.m[j][j];
+        }
+    }
+
+    // Forward (L y = b) then backward (L^T x = y) substitution per column
+    MatN<N, C> y{};
+    for (size_t c = 0; c < C; ++c) {
+        for (size_t i = 0; i < N; ++i) {
+            float sum = b.m[i][c];
+            for (size_t k = 0; k < i; ++k) {
+                sum -= l.m[i][k] * y.m[k][c];
+            }
+            y.m[i][c] = sum / l.m[i][i];
+        }
+        for (size_t i = N; i-- > 0;) {
+            float sum = y.m[i][c];
+            for (size_t k = i + 1; k < N; ++k) {
+                sum -= l.m[k][i] * y.m[k][c];
+            }
+            y.m[i][c] = sum / l.m[i][i];
+        }
+    }
+    x = y;
+    return true;
+}
+
+}  // namespace nativesensor
@@ -0,0 +1,177 @@
+#include "startup_orchestrator.h"
+
+#include <android/log.h>
+#include <utility>
+
+#include "time_utils.h"
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.Startup";
+constexpr double kNsToMs = 1'000'000.0;
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, kLogTag, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+StartupOrchestrator::~StartupOrchestrator() {
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void StartupOrchestrator::add(const std::string& name, InitFn init,
+                              std::vector<std::string> dependencies) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (launched_) {
+        LOGE("Cannot add subsystem %s after launch", name.c_str());
+        return;
+    }
+    if (find(name)) {
+        LOGE("Subsystem %s already registered", name.c_str());
+        return;
+    }
+
+    Subsystem subsystem;
+    subsystem.name = name;
+    subsystem.init = std::move(init);
+    subsystem.dependencies = std::move(dependencies);
+    subsystem.future = subsystem.promise.get_future().share();
+    subsystem.timing.name = name;
+    subsystems_.push_back(std::move(subsystem));
+}
+
+void StartupOrchestrator::launch() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (launched_) {
+        return;
+    }
+    launched_ = true;
+    launchTimeNs_ = getBootTimeNs();
+
+    // subsystems_ is frozen from here on, so worker threads may index into it
+    threads_.reserve(subsystems_.size());
+    for (size_t i = 0; i < subsystems_.size(); ++i) {
+        threads_.emplace_back(&StartupOrchestrator::runSubsystem, this, i);
+    }
+    LOGI("Launched %zu subsystems", subsystems_.size());
+}
+
+bool StartupOrchestrator::isLaunched() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return launched_;
+}
+
+void StartupOrchestrator::runSubsystem(size_t index) {
+    Subsystem& self = subsystems_[index];
+
+    // Dependencies are registered before launch, so their futures are stable
+    bool depsReady = true;
+    for (const auto& dep : self.dependencies) {
+        if (!readiness(dep).get()) {
+            LOGW("Subsystem %s: dependency %s unavailable", self.name.c_str(), dep.c_str());
+            depsReady = false;
+        }
+    }
+
+    const TimestampNs start = getBootTimeNs();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        self.timing.startNs = start;
+    }
+
+    const bool ok = depsReady && self.init && self.init();
+    const TimestampNs end = getBootTimeNs();
+
+    std::vector<std::function<void()>> continuations;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        self.timing.endNs = end;
+        self.timing.ready = ok;
+        self.done = true;
+        continuations.swap(self.continuations);
+    }
+    self.promise.set_value(ok);
+
+    LOGI("Subsystem %s %s in %.2f ms", self.name.c_str(), ok ? "ready" : "FAILED",
+         static_cast<double>(end - start) / kNsToMs);
+
+    if (ok) {
+        for (auto& fn : continuations) {
+            fn();
+        }
+    }
+}
+
+StartupOrchestrator::Subsystem* StartupOrchestrator::find(const std::string& name) {
+    for (auto& subsystem : subsystems_) {
+        if (subsystem.name == name) {
+            return &subsystem;
+        }
+    }
+    return nullptr;
+}
+
+const StartupOrchestrator::Subsystem* StartupOrchestrator::find(const std::string& name) const {
+    return const_cast<StartupOrchestrator*>(this)->find(name);
+}
+
+std::shared_future<bool> StartupOrchestrator::readiness(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (const Subsystem* subsystem = find(name)) {
+        return subsystem->future;
+    }
+    std::promise<bool> missing;
+    missing.set_value(false);
+    return missing.get_future().share();
+}
+
+bool StartupOrchestrator::waitFor(const std::string& name) const {
+    if (!isLaunched()) {
+        LOGW("waitFor(%s) before launch", name.c_str());
+        return false;
+    }
+    return readiness(name).get();
+}
+
+void StartupOrchestrator::onReady(const std::string& name, std::function<void()> fn) {
+    bool runNow = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Subsystem* subsystem = find(name);
+        if (!subsystem) {
+            LOGE("onReady: unknown subsystem %s", name.c_str());
+            return;
+        }
+        if (subsystem->done) {
+            runNow = subsystem->timing.ready;
+        } else {
+            subsystem->continuations.push_back(std::move(fn));
+            return;
+        }
+    }
+    if (runNow) {
+        fn();
+    }
+}
+
+std::vector<SubsystemTiming> StartupOrchestrator::getTimings() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<SubsystemTiming> timings;
+    timings.reserve(subsystems_.size());
+    for (const auto& subsystem : subsystems_) {
+        timings.push_back(subsystem.timing);
+    }
+    return timings;
+}
+
+TimestampNs StartupOrchestrator::getLaunchTimeNs() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return launchTimeNs_;
+}
+
+}  // namespace nativesensor
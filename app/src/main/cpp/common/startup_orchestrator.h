@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sensor_types.h"
+
+namespace nativesensor {
+
+/// Timing breakdown for one subsystem's initialization
+struct SubsystemTiming {
+    std::string name;
+    TimestampNs startNs = 0;    // Boot time when the init function started (0 = not started)
+    TimestampNs endNs = 0;      // Boot time when it finished (0 = still running)
+    bool ready = false;         // Init function reported success
+};
+
+/// Parallel, off-main-thread initialization of native subsystems.
+/// Each subsystem runs on its own short-lived thread once its dependencies
+/// are ready, and exposes a readiness future so callers only block on what
+/// they actually need.
+class StartupOrchestrator {
+public:
+    /// Init function; returns false if the subsystem is unavailable
+    using InitFn = std::function<bool()>;
+
+    StartupOrchestrator() = default;
+    ~StartupOrchestrator();
+
+    StartupOrchestrator(const StartupOrchestrator&) = delete;
+    StartupOrchestrator& operator=(const StartupOrchestrator&) = delete;
+
+    /// Register a subsystem. Must be called before launch().
+    /// @param name Unique subsystem name
+    /// @param init Initialization function, run on a worker thread
+    /// @param dependencies Subsystems that must be ready before init runs
+    void add(const std::string& name, InitFn init, std::vector<std::string> dependencies = {});
+
+    /// Start all registered subsystems in parallel. Returns immediately.
+    void launch();
+
+    /// Check whether launch() has been called
+    [[nodiscard]]
+    bool isLaunched() const;
+
+    /// Readiness future for a subsystem (true = initialized successfully).
+    /// Unknown names yield an already-satisfied future with value false.
+    [[nodiscard]]
+    std::shared_future<bool> readiness(const std::string& name) const;
+
+    /// Block until the subsystem finished initializing; returns its success
+    bool waitFor(const std::string& name) const;
+
+    /// Run fn once the subsystem is ready: inline if it already is, otherwise
+    /// on the subsystem's init thread right after it completes successfully.
+    void onReady(const std::string& name, std::function<void()> fn);
+
+    /// Per-subsystem timing breakdown, in registration order
+    [[nodiscard]]
+    std::vector<SubsystemTiming> getTimings() const;
+
+    /// Boot time at which launch() was called
+    [[nodiscard]]
+    TimestampNs getLaunchTimeNs() const;
+
+private:
+    struct Subsystem {
+        std::string name;
+        InitFn init;
+        std::vector<std::string> dependencies;
+        std::promise<bool> promise;
+        std::shared_future<bool> future;
+        std::vector<std::function<void()>> continuations;
+        SubsystemTiming timing;
+        bool done = false;
+    };
+
+    void runSubsystem(size_t index);
+    [[nodiscard]] Subsystem* find(const std::string& name);
+    [[nodiscard]] const Subsystem* find(const std::string& name) const;
+
+    mutable std::mutex mutex_;
+    std::vector<Subsystem> subsystems_;
+    std::vector<std::thread> threads_;
+    TimestampNs launchTimeNs_ = 0;
+    bool launched_ = false;
+};
+
+}  // namespace nativesensor
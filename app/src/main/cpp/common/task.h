@@ -0,0 +1,189 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+#include "thread_pool.h"
+
+namespace nativesensor {
+
+/// Lazily started coroutine returning T. Awaiting a Task starts it and
+/// resumes the awaiter on whatever thread the task finishes on (symmetric
+/// transfer, no extra scheduling). An exception escaping a task terminates.
+template<typename T = void>
+class [[nodiscard]] Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> finished) const noexcept {
+            const std::coroutine_handle<> continuation = finished.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() const noexcept { std::terminate(); }
+
+    std::coroutine_handle<> continuation;
+};
+
+}  // namespace detail
+
+template<typename T>
+class [[nodiscard]] Task {
+public:
+    struct promise_type : detail::TaskPromiseBase {
+        Task get_return_object() noexcept {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        template<typename U>
+        void return_value(U&& value) {
+            result.emplace(std::forward<U>(value));
+        }
+
+        std::optional<T> result;
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    ~Task() { destroy(); }
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) const noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume() const { return std::move(*handle.promise().result); }
+        };
+        return Awaiter{handle_};
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    void destroy() noexcept {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template<>
+class [[nodiscard]] Task<void> {
+public:
+    struct promise_type : detail::TaskPromiseBase {
+        Task get_return_object() noexcept {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        void return_void() const noexcept {}
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    ~Task() { destroy(); }
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) const noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{handle_};
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    void destroy() noexcept {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/// `co_await resumeOn(pool)` continues the coroutine as a task on the pool
+[[nodiscard]]
+inline auto resumeOn(ThreadPool& pool, TaskPriority priority = TaskPriority::Analysis) noexcept {
+    struct Awaiter {
+        ThreadPool& pool;
+        TaskPriority priority;
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) const {
+            pool.submit([handle] { handle.resume(); }, priority);
+        }
+
+        void await_resume() const noexcept {}
+    };
+    return Awaiter{pool, priority};
+}
+
+namespace detail {
+
+/// Eagerly started, self-destroying coroutine that owns a spawned task
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+inline DetachedTask runDetached(ThreadPool& pool, TaskPriority priority, Task<void> task) {
+    co_await resumeOn(pool, priority);
+    co_await std::move(task);
+}
+
+}  // namespace detail
+
+/// Run a task to completion on the pool without awaiting it. Whatever the
+/// task references must outlive it.
+inline void spawn(ThreadPool& pool, Task<void> task, TaskPriority priority = TaskPriority::Analysis) {
+    detail::runDetached(pool, priority, std::move(task));
+}
+
+}  // namespace nativesensor
@@ -0,0 +1,344 @@
+#include "thread_pool.h"
+
+#include <android/log.h>
+#include <algorithm>
+#include <cstdio>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.Pool";
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+namespace {
+
+// Thieves only look this deep into a victim's deque for an affinity-compatible task
+constexpr size_t kStealScanDepth = 4;
+
+thread_local const ThreadPool* tlsPool = nullptr;
+thread_local size_t tlsWorkerIndex = 0;
+
+long readCpuMaxFreqKhz(int cpu) {
+    char path[96];
+    std::snprintf(path, sizeof(path),
+                  "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+    FILE* file = std::fopen(path, "r");
+    if (!file) {
+        return -1;
+    }
+    long freq = -1;
+    if (std::fscanf(file, "%ld", &freq) != 1) {
+        freq = -1;
+    }
+    std::fclose(file);
+    return freq;
+}
+
+void pinCurrentThread(const std::vector<int>& cpus) {
+    if (cpus.empty()) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        LOGW("Failed to pin worker to %zu cores", cpus.size());
+    }
+}
+
+}  // namespace
+
+CoreTopology ThreadPool::detectTopology() {
+    CoreTopology topology;
+    const long cpuCount = sysconf(_SC_NPROCESSORS_CONF);
+
+    std::vector<std::pair<int, long>> freqs;
+    for (int cpu = 0; cpu < cpuCount; ++cpu) {
+        const long freq = readCpuMaxFreqKhz(cpu);
+        if (freq > 0) {
+            freqs.emplace_back(cpu, freq);
+        }
+    }
+    if (freqs.empty()) {
+        return topology;
+    }
+
+    const auto [minIt, maxIt] = std::minmax_element(
+        freqs.begin(), freqs.end(),
+        [](const auto& a, const auto& b) { return a.second < b.second; });
+    const long minFreq = minIt->second;
+    if (minFreq == maxIt->second) {
+        return topology;  // Homogeneous: no big/little split
+    }
+
+    // Prime and mid clusters both count as "big"
+    for (const auto& [cpu, freq] : freqs) {
+        (freq > minFreq ? topology.bigCores : topology.littleCores).push_back(cpu);
+    }
+    return topology;
+}
+
+ThreadPool::ThreadPool(size_t workerCount) {
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    const CoreTopology topology = detectTopology();
+    size_t bigWorkers = 0;
+    if (topology.isHeterogeneous() && workerCount >= 2) {
+        const size_t totalCores = topology.bigCores.size() + topology.littleCores.size();
+        bigWorkers = (workerCount * topology.bigCores.size() + totalCores / 2) / totalCores;
+        bigWorkers = std::clamp<size_t>(bigWorkers, 1, workerCount - 1);
+    }
+
+    workers_.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        auto worker = std::make_unique<Worker>();
+        if (bigWorkers > 0) {
+            const bool big = i < bigWorkers;
+            worker->coreClass = big ? CoreAffinity::Big : CoreAffinity::Little;
+            worker->cpus = big ? topology.bigCores : topology.littleCores;
+        }
+        workers_.push_back(std::move(worker));
+    }
+    hasBig_ = bigWorkers > 0;
+    hasLittle_ = bigWorkers > 0 && bigWorkers < workerCount;
+
+    // Start threads only after workers_ is fully built
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i]->thread = std::thread(&ThreadPool::workerLoop, this, i);
+    }
+
+    LOGI("ThreadPool started: %zu workers (%zu big, %zu little)",
+         workers_.size(), bigWorkers, hasLittle_ ? workers_.size() - bigWorkers : 0);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_.store(true, std::memory_order_release);
+    }
+    sleepCv_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+bool ThreadPool::canRun(const Worker& worker, CoreAffinity affinity) const noexcept {
+    switch (affinity) {
+        case CoreAffinity::Any:
+            return true;
+        case CoreAffinity::Big:
+            return !hasBig_ || worker.coreClass == CoreAffinity::Big;
+        case CoreAffinity::Little:
+            return !hasLittle_ || worker.coreClass == CoreAffinity::Little;
+    }
+    return true;
+}
+
+size_t ThreadPool::pickWorker(CoreAffinity affinity) {
+    const size_t count = workers_.size();
+    const size_t start = nextWorker_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t index = (start + i) % count;
+        if (canRun(*workers_[index], affinity)) {
+            return index;
+        }
+    }
+    return start % count;
+}
+
+void ThreadPool::submit(Task task, TaskPriority priority, CoreAffinity affinity) {
+    if (!task) {
+        return;
+    }
+
+    size_t index;
+    if (tlsPool == this && canRun(*workers_[tlsWorkerIndex], affinity)) {
+        index = tlsWorkerIndex;
+    } else {
+        index = pickWorker(affinity);
+    }
+
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    inFlight_.fetch_add(1, std::memory_order_acq_rel);
+    {
+        Worker& worker = *workers_[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queues[static_cast<size_t>(priority)].push_back({std::move(task), affinity});
+        queued_[static_cast<size_t>(priority)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        workGeneration_.fetch_add(1, std::memory_order_release);
+    }
+    // A single wakeup may land on a worker that must not run a hinted task
+    if (affinity == CoreAffinity::Any) {
+        sleepCv_.notify_one();
+    } else {
+        sleepCv_.notify_all();
+    }
+}
+
+bool ThreadPool::next(size_t index, QueuedTask& out) {
+    for (size_t priority = 0; priority < kPriorityCount; ++priority) {
+        if (popLocal(index, priority, out)) {
+            return true;
+        }
+        // The counter spares locking every other deque while no worker holds
+        // work of this priority
+        if (queued_[priority].load(std::memory_order_relaxed) > 0 && steal(index, priority, out)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::popLocal(size_t index, size_t priority, QueuedTask& out) {
+    Worker& worker = *workers_[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    auto& queue = worker.queues[priority];
+    if (queue.empty()) {
+        return false;
+    }
+    out = std::move(queue.back());
+    queue.pop_back();
+    queued_[priority].fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool ThreadPool::steal(size_t thief, size_t priority, QueuedTask& out) {
+    const size_t count = workers_.size();
+    const Worker& self = *workers_[thief];
+
+    for (size_t offset = 1; offset < count; ++offset) {
+        Worker& victim = *workers_[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        auto& queue = victim.queues[priority];
+
+        const size_t depth = std::min(queue.size(), kStealScanDepth);
+        for (size_t i = 0; i < depth; ++i) {
+            if (canRun(self, queue[i].affinity)) {
+                out = std::move(queue[i]);
+                queue.erase(queue.begin() + static_cast<std::ptrdiff_t>(i));
+                queued_[priority].fetch_sub(1, std::memory_order_relaxed);
+                stolen_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPool::finishTask() {
+    executed_.fetch_add(1, std::memory_order_relaxed);
+    if (inFlight_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+        idleCv_.notify_all();
+    }
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    tlsPool = this;
+    tlsWorkerIndex = index;
+
+    char name[16];
+    std::snprintf(name, sizeof(name), "ns-worker-%zu", index);
+    pthread_setname_np(pthread_self(), name);
+    pinCurrentThread(workers_[index]->cpus);
+
+    while (true) {
+        // Read before scanning so a submit racing with the scan is never missed
+        const uint64_t seen = workGeneration_.load(std::memory_order_acquire);
+
+        QueuedTask task;
+        if (next(index, task)) {
+            task.fn();
+            finishTask();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        if (stopping_.load(std::memory_order_acquire)) {
+            break;
+        }
+        sleepCv_.wait(lock, [&] {
+            return stopping_.load(std::memory_order_acquire) ||
+                   workGeneration_.load(std::memory_order_acquire) != seen;
+        });
+    }
+
+    tlsPool = nullptr;
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(idleMutex_);
+    idleCv_.wait(lock, [this] { return inFlight_.load(std::memory_order_acquire) == 0; });
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn,
+                             TaskPriority priority) {
+    if (count <= 1 || workers_.empty()) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    // Helpers and the caller claim indices from a shared counter. Helpers that
+    // only start after everything is claimed exit without touching fn, so the
+    // job state is shared but fn may live on the caller's stack.
+    struct Job {
+        const std::function<void(size_t)>* fn = nullptr;
+        size_t count = 0;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    auto job = std::make_shared<Job>();
+    job->fn = &fn;
+    job->count = count;
+
+    auto work = [job] {
+        for (size_t i = job->next.fetch_add(1, std::memory_order_relaxed); i < job->count;
+             i = job->next.fetch_add(1, std::memory_order_relaxed)) {
+            (*job->fn)(i);
+            if (job->done.fetch_add(1, std::memory_order_acq_rel) + 1 == job->count) {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                job->cv.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(count - 1, workers_.size());
+    for (size_t i = 0; i < helpers; ++i) {
+        submit(work, priority);
+    }
+    work();
+
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->cv.wait(lock, [&] { return job->done.load(std::memory_order_acquire) == count; });
+}
+
+ThreadPoolStats ThreadPool::getStats() const {
+    ThreadPoolStats stats;
+    stats.submitted = submitted_.load(std::memory_order_relaxed);
+    stats.executed = executed_.load(std::memory_order_relaxed);
+    stats.stolen = stolen_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace nativesensor
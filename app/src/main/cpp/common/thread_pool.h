@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nativesensor {
+
+/// Task priority; lower value runs first
+enum class TaskPriority : uint8_t {
+    Tracking = 0,   // Pose/feature tracking on the motion-to-photon path
+    Analysis = 1,   // Per-frame analysis (metrics, depth, ...)
+    Logging = 2     // Recording, export, diagnostics
+};
+
+/// Core class a task prefers to run on (hint only)
+enum class CoreAffinity : uint8_t {
+    Any = 0,
+    Big = 1,        // Highest max-frequency cluster
+    Little = 2      // Lowest max-frequency cluster
+};
+
+/// Big/little core layout read from cpufreq
+struct CoreTopology {
+    std::vector<int> bigCores;
+    std::vector<int> littleCores;
+
+    /// True if the device has distinct big and little clusters
+    [[nodiscard]]
+    bool isHeterogeneous() const noexcept { return !bigCores.empty() && !littleCores.empty(); }
+};
+
+/// Thread pool counters
+struct ThreadPoolStats {
+    int64_t submitted = 0;
+    int64_t executed = 0;
+    int64_t stolen = 0;
+};
+
+/// Work-stealing thread pool for CPU-heavy per-frame processing.
+///
+/// Each worker owns one deque per priority. Owners pop their newest task
+/// (cache-warm LIFO), idle workers steal the oldest task from others (FIFO).
+/// Before a worker pops one of its own tasks it takes any queued work of a
+/// higher priority from the others, so the pool runs highest priority first
+/// (up to the affinity hints and tasks already running). On big.LITTLE devices workers are split
+/// across clusters and pinned to them; affinity hints route tasks to a
+/// matching worker and keep Little workers from stealing Big-hinted tasks.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /// @param workerCount Number of workers (0 = one per online core)
+    explicit ThreadPool(size_t workerCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Queue a task. Safe to call from any thread, including workers
+    /// (tasks submitted from a worker go to its own deque).
+    void submit(Task task,
+                TaskPriority priority = TaskPriority::Analysis,
+                CoreAffinity affinity = CoreAffinity::Any);
+
+    /// Block until every submitted task has finished
+    void waitIdle();
+
+    /// Run fn(i) for every i in [0, count) across the workers and return when
+    /// all calls have finished. The calling thread takes part, so this is safe
+    /// (and won't deadlock) from inside a task, e.g. a pipeline stage.
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn,
+                     TaskPriority priority = TaskPriority::Analysis);
+
+    [[nodiscard]]
+    size_t workerCount() const noexcept { return workers_.size(); }
+
+    [[nodiscard]]
+    ThreadPoolStats getStats() const;
+
+    /// Read big/little topology from /sys/devices/system/cpu
+    [[nodiscard]]
+    static CoreTopology detectTopology();
+
+private:
+    static constexpr size_t kPriorityCount = 3;
+
+    struct QueuedTask {
+        Task fn;
+        CoreAffinity affinity = CoreAffinity::Any;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<QueuedTask> queues[kPriorityCount];
+        CoreAffinity coreClass = CoreAffinity::Any;
+        std::vector<int> cpus;      // CPUs this worker is pinned to (empty = unpinned)
+        std::thread thread;
+    };
+
+    void workerLoop(size_t index);
+    bool next(size_t index, QueuedTask& out);
+    bool popLocal(size_t index, size_t priority, QueuedTask& out);
+    bool steal(size_t thief, size_t priority, QueuedTask& out);
+    [[nodiscard]] size_t pickWorker(CoreAffinity affinity);
+    [[nodiscard]] bool canRun(const Worker& worker, CoreAffinity affinity) const noexcept;
+    void finishTask();
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    bool hasBig_ = false;
+    bool hasLittle_ = false;
+
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> workGeneration_{0};   // Bumped on every submit
+    std::atomic<int64_t> inFlight_{0};          // Queued or running
+    std::atomic<size_t> nextWorker_{0};
+    std::atomic<int64_t> queued_[kPriorityCount] = {};   // Waiting tasks per priority, pool-wide
+
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCv_;
+    std::mutex idleMutex_;
+    std::condition_variable idleCv_;
+
+    std::atomic<int64_t> submitted_{0};
+    std::atomic<int64_t> executed_{0};
+    std::atomic<int64_t> stolen_{0};
+};
+
+}  // namespace nativesensor
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+
+#include "sensor_types.h"
+
+namespace nativesensor {
+
+constexpr int64_t kNsPerSecond = 1'000'000'000LL;
+constexpr int64_t kNsPerMs = 1'000'000LL;
+constexpr int64_t kNsPerUs = 1'000LL;
+
+/// Current CLOCK_BOOTTIME in nanoseconds (same timebase as sensor and camera timestamps)
+inline TimestampNs getBootTimeNs() noexcept {
+    struct timespec t{};
+    clock_gettime(CLOCK_BOOTTIME, &t);
+    return static_cast<int64_t>(t.tv_sec) * kNsPerSecond + t.tv_nsec;
+}
+
+}  // namespace nativesensor
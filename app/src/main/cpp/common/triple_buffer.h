@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace nativesensor {
+
+/// Single-writer, multi-reader latest-value mailbox over three slots.
+///
+/// Store n goes to slot n % 3 while readers are pointed at the slot of
+/// store n - 1, so the writer never touches the slot being handed out and
+/// never waits. A reader copies the newest slot and checks its sequence;
+/// the copy is only invalidated if two more stores complete during it, in
+/// which case it simply takes the newer value. Unlike SeqLock, a store
+/// racing a read doesn't force a retry. Payload words are atomics, so the
+/// pattern is sanitizer-clean.
+template<typename T>
+class TripleBuffer {
+    static_assert(std::is_trivially_copyable_v<T>, "TripleBuffer payload must be trivially copyable");
+
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /// Publish a new value. Only one thread may call store().
+    void store(const T& value) noexcept {
+        std::array<uint64_t, kWords> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        const uint64_t n = latest_.load(std::memory_order_relaxed) + 1;
+        Slot& slot = slots_[n % kSlots];
+        slot.sequence.store(2 * n - 1, std::memory_order_relaxed);
+        // Release on each word keeps the odd sequence ordered before the payload
+        for (size_t i = 0; i < kWords; ++i) {
+            slot.words[i].store(words[i], std::memory_order_release);
+        }
+        slot.sequence.store(2 * n, std::memory_order_release);
+        latest_.store(n, std::memory_order_release);
+    }
+
+    /// Copy the newest value; false if nothing was stored yet
+    bool load(T& out) const noexcept {
+        std::array<uint64_t, kWords> words{};
+        while (true) {
+            const uint64_t n = latest_.load(std::memory_order_acquire);
+            if (n == 0) {
+                return false;
+            }
+            const Slot& slot = slots_[n % kSlots];
+            // Acquire on each word keeps the re-check below after the copy
+            for (size_t i = 0; i < kWords; ++i) {
+                words[i] = slot.words[i].load(std::memory_order_acquire);
+            }
+            if (slot.sequence.load(std::memory_order_relaxed) == 2 * n) {
+                break;
+            }
+        }
+        std::memcpy(static_cast<void*>(&out), words.data(), sizeof(T));
+        return true;
+    }
+
+    /// Number of stores so far; lets readers skip unchanged values
+    [[nodiscard]]
+    uint64_t version() const noexcept { return latest_.load(std::memory_order_acquire); }
+
+private:
+    static constexpr size_t kSlots = 3;
+    static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::array<std::atomic<uint64_t>, kWords> words{};
+    };
+
+    std::array<Slot, kSlots> slots_{};
+    alignas(64) std::atomic<uint64_t> latest_{0};
+};
+
+}  // namespace nativesensor
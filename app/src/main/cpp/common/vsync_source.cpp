@@ -0,0 +1,101 @@
+#include "vsync_source.h"
+
+#include <android/log.h>
+#include <ctime>
+
+#include "time_utils.h"
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.Vsync";
+constexpr int kPollTimeoutMs = 100;
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+namespace {
+
+/// Choreographer reports CLOCK_MONOTONIC; the offset changes across suspend,
+/// so it is sampled on every frame
+int64_t monotonicToBootOffsetNs() noexcept {
+    struct timespec mono{};
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    const int64_t monoNs = static_cast<int64_t>(mono.tv_sec) * kNsPerSecond + mono.tv_nsec;
+    return getBootTimeNs() - monoNs;
+}
+
+}  // namespace
+
+VsyncSource::~VsyncSource() {
+    stop();
+}
+
+void VsyncSource::start(TimelineCallback callback) {
+    if (running_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    callback_ = std::move(callback);
+    thread_ = std::thread(&VsyncSource::threadLoop, this);
+    LOGI("VsyncSource started");
+}
+
+void VsyncSource::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    if (ALooper* looper = looper_.load(std::memory_order_acquire)) {
+        ALooper_wake(looper);
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    LOGI("VsyncSource stopped");
+}
+
+void VsyncSource::threadLoop() {
+    ALooper* looper = ALooper_prepare(ALOOPER_PREPARE_ALLOW_NON_CALLBACKS);
+    choreographer_ = AChoreographer_getInstance();
+    if (!looper || !choreographer_) {
+        LOGE("Failed to get AChoreographer for vsync thread");
+        running_.store(false, std::memory_order_release);
+        return;
+    }
+    looper_.store(looper, std::memory_order_release);
+
+    AChoreographer_postVsyncCallback(choreographer_, onVsync, this);
+    while (running_.load(std::memory_order_acquire)) {
+        // Callbacks are dispatched from inside pollOnce
+        ALooper_pollOnce(kPollTimeoutMs, nullptr, nullptr, nullptr);
+    }
+
+    looper_.store(nullptr, std::memory_order_release);
+}
+
+void VsyncSource::onVsync(const AChoreographerFrameCallbackData* data, void* context) {
+    auto* self = static_cast<VsyncSource*>(context);
+    if (!self->running_.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    const int64_t offsetNs = monotonicToBootOffsetNs();
+    const size_t index = AChoreographerFrameCallbackData_getPreferredFrameTimelineIndex(data);
+
+    FrameTimeline timeline;
+    timeline.vsyncNs = AChoreographerFrameCallbackData_getFrameTimeNanos(data) + offsetNs;
+    timeline.deadlineNs =
+        AChoreographerFrameCallbackData_getFrameTimelineDeadlineNanos(data, index) + offsetNs;
+    timeline.presentNs =
+        AChoreographerFrameCallbackData_getFrameTimelineExpectedPresentationTimeNanos(data, index) +
+        offsetNs;
+
+    if (self->callback_) {
+        self->callback_(timeline);
+    }
+
+    // Vsync callbacks are one-shot
+    AChoreographer_postVsyncCallback(self->choreographer_, onVsync, self);
+}
+
+}  // namespace nativesensor
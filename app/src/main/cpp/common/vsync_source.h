@@ -0,0 +1,46 @@
+#pragma once
+
+#include <android/choreographer.h>
+#include <android/looper.h>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "deadline_scheduler.h"
+
+namespace nativesensor {
+
+/// Delivers Choreographer frame timelines (vsync, latch deadline, expected
+/// presentation) from a dedicated looper thread, converted to CLOCK_BOOTTIME
+/// so they share a timebase with sensor timestamps.
+class VsyncSource {
+public:
+    using TimelineCallback = std::function<void(const FrameTimeline&)>;
+
+    VsyncSource() = default;
+    ~VsyncSource();
+
+    VsyncSource(const VsyncSource&) = delete;
+    VsyncSource& operator=(const VsyncSource&) = delete;
+
+    /// Start receiving vsync callbacks
+    void start(TimelineCallback callback);
+
+    /// Stop the vsync thread
+    void stop();
+
+    [[nodiscard]]
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+private:
+    static void onVsync(const AChoreographerFrameCallbackData* data, void* context);
+    void threadLoop();
+
+    TimelineCallback callback_;
+    std::atomic<bool> running_{false};
+    std::atomic<ALooper*> looper_{nullptr};
+    AChoreographer* choreographer_ = nullptr;
+    std::thread thread_;
+};
+
+}  // namespace nativesensor
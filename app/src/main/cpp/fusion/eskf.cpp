@@ -0,0 +1,395 @@
+#include "eskf.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "time_utils.h"
+
+namespace nativesensor {
+
+namespace {
+
+// Error-state block offsets
+constexpr size_t kPos = 0;
+constexpr size_t kVel = 3;
+constexpr size_t kAtt = 6;
+constexpr size_t kAccelBias = 9;
+constexpr size_t kGyroBias = 12;
+
+// Initial standard deviations
+constexpr float kInitPosStd = 0.01f;
+constexpr float kInitVelStd = 0.01f;
+constexpr float kInitTiltStd = 0.02f;
+constexpr float kInitYawStd = 0.5f;         // Unobservable until a camera update
+constexpr float kInitAccelBiasStd = 0.1f;
+constexpr float kInitGyroBiasStd = 0.01f;
+
+int64_t elapsedNs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+Eskf::Eskf(EskfConfig config)
+    : config_(config),
+      history_(config.historySize),
+      inbox_(config.measurementQueueSize) {
+    replay_.reserve(config.historySize + 1);
+    pending_.reserve(config.measurementQueueSize);
+    reset();
+}
+
+void Eskf::reset() {
+    nominal_ = Nominal{};
+    covariance_ = Covariance{};
+    timestampNs_ = 0;
+    initialized_ = false;
+    hasAccel_ = false;
+    alignmentSum_ = Vec3{};
+    alignmentCount_ = 0;
+    historyStart_ = 0;
+    historyCount_ = 0;
+    pending_.clear();
+    published_.store(FusedState{});
+}
+
+void Eskf::initialize(TimestampNs timestampNs, const Quat& orientation) {
+    nominal_ = Nominal{};
+    nominal_.orientation = normalized(orientation);
+
+    covariance_ = Covariance{};
+    const float stds[kStateDim] = {
+        kInitPosStd, kInitPosStd, kInitPosStd,
+        kInitVelStd, kInitVelStd, kInitVelStd,
+        kInitTiltStd, kInitTiltStd, kInitYawStd,
+        kInitAccelBiasStd, kInitAccelBiasStd, kInitAccelBiasStd,
+        kInitGyroBiasStd, kInitGyroBiasStd, kInitGyroBiasStd
+    };
+    for (size_t i = 0; i < kStateDim; ++i) {
+        covariance_.m[i][i] = stds[i] * stds[i];
+    }
+
+    timestampNs_ = timestampNs;
+    historyStart_ = 0;
+    historyCount_ = 0;
+    initialized_ = true;
+    publish();
+}
+
+void Eskf::alignGravity(const ImuSample& accel) {
+    alignmentSum_ += Vec3(accel.x, accel.y, accel.z);
+    if (++alignmentCount_ < config_.alignmentSamples) {
+        return;
+    }
+
+    // At rest the accelerometer measures the reaction to gravity: world +z in body frame
+    const float length = norm(alignmentSum_);
+    if (length < quat::kSmallAngle) {
+        alignmentSum_ = Vec3{};
+        alignmentCount_ = 0;
+        return;
+    }
+    initialize(accel.timestampNs, quat::fromTwoVectors(alignmentSum_ * (1.0f / length), {0.0f, 0.0f, 1.0f}));
+}
+
+void Eskf::addImuSample(const ImuSample& sample) {
+    if (sample.sensorType == SensorType::Accelerometer) {
+        latestAccel_ = Vec3(sample.x, sample.y, sample.z);
+        hasAccel_ = true;
+        if (!initialized_) {
+            alignGravity(sample);
+        }
+        return;
+    }
+    if (sample.sensorType != SensorType::Gyroscope || !initialized_ || !hasAccel_) {
+        return;
+    }
+
+    const int64_t dtNs = sample.timestampNs - timestampNs_;
+    if (dtNs <= 0) {
+        return;
+    }
+    if (dtNs > config_.maxGapNs) {
+        // Can't integrate or replay across a gap; restart history from here
+        timestampNs_ = sample.timestampNs;
+        historyStart_ = 0;
+        historyCount_ = 0;
+    } else {
+        advance(sample.timestampNs, latestAccel_, Vec3(sample.x, sample.y, sample.z));
+    }
+
+    applyPendingMeasurements();
+    publish();
+}
+
+bool Eskf::submitMeasurement(const PoseMeasurement& measurement) {
+    if (!inbox_.tryPush(measurement)) {
+        rejectedUpdates_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void Eskf::advance(TimestampNs endNs, const Vec3& accel, const Vec3& gyro) {
+    pushHistory({timestampNs_, nominal_, covariance_, accel, gyro});
+    propagate(accel, gyro, static_cast<float>(endNs - timestampNs_) / static_cast<float>(kNsPerSecond));
+    timestampNs_ = endNs;
+}
+
+void Eskf::propagate(const Vec3& accel, const Vec3& gyro, float dt) {
+    const auto start = std::chrono::steady_clock::now();
+
+    const Mat3 rotation = toMat3(nominal_.orientation);
+    const Vec3 accelBody = accel - nominal_.accelBias;
+    const Vec3 gyroBody = gyro - nominal_.gyroBias;
+    const Vec3 accelWorld = rotation * accelBody + Vec3(0.0f, 0.0f, -config_.gravity);
+    const Quat deltaRotation = quat::fromRotationVector(gyroBody * dt);
+
+    // Nominal state
+    nominal_.position += nominal_.velocity * dt + accelWorld * (0.5f * dt * dt);
+    nominal_.velocity += accelWorld * dt;
+    nominal_.orientation = normalized(nominal_.orientation * deltaRotation);
+
+    // Error-state transition
+    const Mat3 eye = Mat3::identity();
+    Covariance transition = Covariance::identity();
+    transition.setBlock(kPos, kVel, toMatN(eye * dt));
+    transition.setBlock(kVel, kAtt, toMatN(rotation * skew(accelBody) * -dt));
+    transition.setBlock(kVel, kAccelBias, toMatN(rotation * -dt));
+    transition.setBlock(kAtt, kAtt, toMatN(toMat3(deltaRotation).transposed()));
+    transition.setBlock(kAtt, kGyroBias, toMatN(eye * -dt));
+
+    covariance_ = transition * covariance_ * transition.transposed();
+
+    const float accelVar = config_.accelNoise * config_.accelNoise * dt;
+    const float gyroVar = config_.gyroNoise * config_.gyroNoise * dt;
+    const float accelBiasVar = config_.accelBiasWalk * config_.accelBiasWalk * dt;
+    const float gyroBiasVar = config_.gyroBiasWalk * config_.gyroBiasWalk * dt;
+    for (size_t i = 0; i < 3; ++i) {
+        covariance_.m[kVel + i][kVel + i] += accelVar;
+        covariance_.m[kAtt + i][kAtt + i] += gyroVar;
+        covariance_.m[kAccelBias + i][kAccelBias + i] += accelBiasVar;
+        covariance_.m[kGyroBias + i][kGyroBias + i] += gyroBiasVar;
+    }
+    covariance_.symmetrize();
+
+    propagations_.fetch_add(1, std::memory_order_relaxed);
+    propagateNs_.fetch_add(elapsedNs(start), std::memory_order_relaxed);
+}
+
+bool Eskf::update(const PoseMeasurement& measurement) {
+    const auto start = std::chrono::steady_clock::now();
+
+    // H selects position and attitude error: columns kPos..+3 and kAtt..+3
+    constexpr size_t kMeasDim = 6;
+    constexpr size_t kCols[kMeasDim] = {kPos, kPos + 1, kPos + 2, kAtt, kAtt + 1, kAtt + 2};
+
+    MatN<kStateDim, kMeasDim> pht{};     // P H^T
+    for (size_t r = 0; r < kStateDim; ++r) {
+        for (size_t c = 0; c < kMeasDim; ++c) {
+            pht.m[r][c] = covariance_.m[r][kCols[c]];
+        }
+    }
+
+    const float posVar = measurement.positionStdM * measurement.positionStdM;
+    const float attVar = measurement.orientationStdRad * measurement.orientationStdRad;
+    MatN<kMeasDim, kMeasDim> innovationCov{};
+    for (size_t r = 0; r < kMeasDim; ++r) {
+        for (size_t c = 0; c < kMeasDim; ++c) {
+            innovationCov.m[r][c] = pht.m[kCols[r]][c];
+        }
+        innovationCov.m[r][r] += r < 3 ? posVar : attVar;
+    }
+
+    VecN<kMeasDim> residual{};
+    for (size_t i = 0; i < 3; ++i) {
+        residual.m[i][0] = measurement.position[i] - nominal_.position[i];
+    }
+    residual.setBlock(3, 0, toVecN(quat::toRotationVector(conjugate(nominal_.orientation) * measurement.orientation)));
+
+    // Mahalanobis gate against outliers (tracking glitches)
+    VecN<kMeasDim> weighted{};
+    if (!solveSpd(innovationCov, residual, weighted)) {
+        rejectedUpdates_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (config_.gateChi2 > 0.0f && (residual.transposed() * weighted).m[0][0] > config_.gateChi2) {
+        rejectedUpdates_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // K = P H^T S^-1, computed as (S^-1 H P)^T since S and P are symmetric
+    MatN<kMeasDim, kStateDim> gainT{};
+    if (!solveSpd(innovationCov, pht.transposed(), gainT)) {
+        rejectedUpdates_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    const MatN<kStateDim, kMeasDim> gain = gainT.transposed();
+    const VecN<kStateDim> correction = gain * residual;
+
+    // Joseph form keeps P positive definite in float
+    Covariance ikh = Covariance::identity();
+    MatN<kMeasDim, kMeasDim> measurementCov{};
+    for (size_t c = 0; c < kMeasDim; ++c) {
+        for (size_t r = 0; r < kStateDim; ++r) {
+            ikh.m[r][kCols[c]] -= gain.m[r][c];
+        }
+        measurementCov.m[c][c] = c < 3 ? posVar : attVar;
+    }
+    covariance_ = ikh * covariance_ * ikh.transposed() + gain * measurementCov * gainT;
+    covariance_.symmetrize();
+
+    // Inject the error into the nominal state (reset Jacobian ~ identity)
+    nominal_.position += toVec3(correction.block<3, 1>(kPos, 0));
+    nominal_.velocity += toVec3(correction.block<3, 1>(kVel, 0));
+    nominal_.orientation = normalized(
+        nominal_.orientation * quat::fromRotationVector(toVec3(correction.block<3, 1>(kAtt, 0))));
+    nominal_.accelBias += toVec3(correction.block<3, 1>(kAccelBias, 0));
+    nominal_.gyroBias += toVec3(correction.block<3, 1>(kGyroBias, 0));
+
+    updates_.fetch_add(1, std::memory_order_relaxed);
+    updateNs_.fetch_add(elapsedNs(start), std::memory_order_relaxed);
+    return true;
+}
+
+void Eskf::applyPendingMeasurements() {
+    PoseMeasurement measurement;
+    while (inbox_.tryPop(measurement)) {
+        if (pending_.size() >= config_.measurementQueueSize) {
+            pending_.erase(pending_.begin());
+            rejectedUpdates_.fetch_add(1, std::memory_order_relaxed);
+        }
+        pending_.push_back(measurement);
+    }
+    if (pending_.empty()) {
+        return;
+    }
+
+    std::sort(pending_.begin(), pending_.end(),
+              [](const PoseMeasurement& a, const PoseMeasurement& b) {
+                  return a.timestampNs < b.timestampNs;
+              });
+
+    // Apply everything the IMU has caught up with; keep measurements from the future
+    size_t applied = 0;
+    while (applied < pending_.size() && pending_[applied].timestampNs <= timestampNs_) {
+        applyAt(pending_[applied]);
+        ++applied;
+    }
+    pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(applied));
+}
+
+bool Eskf::applyAt(const PoseMeasurement& measurement) {
+    const TimestampNs measNs = measurement.timestampNs;
+    if (measNs == timestampNs_) {
+        return update(measurement);
+    }
+
+    // Newest history entry at or before the measurement
+    size_t index = historyCount_;
+    while (index > 0 && historyAt(index - 1).timestampNs > measNs) {
+        --index;
+    }
+    if (index == 0) {
+        rejectedUpdates_.fetch_add(1, std::memory_order_relaxed);
+        return false;   // Older than the history window
+    }
+    const size_t first = index - 1;
+
+    // Save the inputs to replay, then roll back
+    const TimestampNs endNs = timestampNs_;
+    replay_.clear();
+    for (size_t i = first; i < historyCount_; ++i) {
+        const HistoryEntry& entry = historyAt(i);
+        replay_.push_back({entry.timestampNs, entry.accel, entry.gyro});
+    }
+    const HistoryEntry& restore = historyAt(first);
+    nominal_ = restore.state;
+    covariance_ = restore.covariance;
+    timestampNs_ = restore.timestampNs;
+    historyCount_ = first;
+
+    if (replay_.size() > 1) {
+        outOfOrderUpdates_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool updated = false;
+    for (size_t i = 0; i < replay_.size(); ++i) {
+        const ReplayStep& step = replay_[i];
+        const TimestampNs stepEndNs = i + 1 < replay_.size() ? replay_[i + 1].startNs : endNs;
+        if (i == 0) {
+            // Split the step that contains the measurement
+            if (measNs > timestampNs_) {
+                advance(measNs, step.accel, step.gyro);
+            }
+            updated = update(measurement);
+            if (stepEndNs > timestampNs_) {
+                advance(stepEndNs, step.accel, step.gyro);
+            }
+        } else {
+            advance(stepEndNs, step.accel, step.gyro);
+        }
+    }
+    repropagatedSteps_.fetch_add(static_cast<int64_t>(replay_.size()), std::memory_order_relaxed);
+    return updated;
+}
+
+void Eskf::pushHistory(const HistoryEntry& entry) {
+    if (history_.empty()) {
+        return;
+    }
+    if (historyCount_ == history_.size()) {
+        historyStart_ = (historyStart_ + 1) % history_.size();
+        --historyCount_;
+    }
+    historyAt(historyCount_++) = entry;
+}
+
+Eskf::HistoryEntry& Eskf::historyAt(size_t index) {
+    return history_[(historyStart_ + index) % history_.size()];
+}
+
+void Eskf::publish() {
+    FusedState state;
+    state.timestampNs = timestampNs_;
+    for (size_t i = 0; i < 3; ++i) {
+        state.position[i] = nominal_.position[i];
+        state.velocity[i] = nominal_.velocity[i];
+        state.accelBias[i] = nominal_.accelBias[i];
+        state.gyroBias[i] = nominal_.gyroBias[i];
+    }
+    state.orientation = nominal_.orientation;
+
+    float posVar = 0.0f;
+    float attVar = 0.0f;
+    for (size_t i = 0; i < 3; ++i) {
+        posVar += covariance_.m[kPos + i][kPos + i];
+        attVar += covariance_.m[kAtt + i][kAtt + i];
+    }
+    state.positionStdM = std::sqrt(posVar / 3.0f);
+    state.orientationStdRad = std::sqrt(attVar / 3.0f);
+    state.valid = initialized_;
+    published_.store(state);
+}
+
+EskfStats Eskf::getStats() const {
+    EskfStats stats;
+    stats.propagations = propagations_.load(std::memory_order_relaxed);
+    stats.updates = updates_.load(std::memory_order_relaxed);
+    stats.outOfOrderUpdates = outOfOrderUpdates_.load(std::memory_order_relaxed);
+    stats.rejectedUpdates = rejectedUpdates_.load(std::memory_order_relaxed);
+    stats.repropagatedSteps = repropagatedSteps_.load(std::memory_order_relaxed);
+    if (stats.propagations > 0) {
+        stats.avgPropagateUs = static_cast<float>(propagateNs_.load(std::memory_order_relaxed)) /
+                               static_cast<float>(stats.propagations) / static_cast<float>(kNsPerUs);
+    }
+    if (stats.updates > 0) {
+        stats.avgUpdateUs = static_cast<float>(updateNs_.load(std::memory_order_relaxed)) /
+                            static_cast<float>(stats.updates) / static_cast<float>(kNsPerUs);
+    }
+    return stats;
+}
+
+}  // namespace nativesensor
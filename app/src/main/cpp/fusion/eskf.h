@@ -0,0 +1,180 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "geometry.h"
+#include "imu_data.h"
+#include "seqlock.h"
+
+namespace nativesensor {
+
+/// Camera-derived pose of the device in the world frame (visual odometry,
+/// marker tracking, ...), stamped with the frame's exposure time
+struct PoseMeasurement {
+    TimestampNs timestampNs = 0;
+    float position[3] = {};             // m
+    Quat orientation;
+    float positionStdM = 0.01f;
+    float orientationStdRad = 0.01f;
+};
+
+/// Fused device state, world frame with z up
+struct FusedState {
+    TimestampNs timestampNs = 0;
+    float position[3] = {};             // m
+    float velocity[3] = {};             // m/s
+    Quat orientation;                  // body -> world
+    float accelBias[3] = {};            // m/s^2
+    float gyroBias[3] = {};             // rad/s
+    float positionStdM = 0.0f;          // RMS of position standard deviations
+    float orientationStdRad = 0.0f;     // RMS of attitude standard deviations
+    bool valid = false;                 // False until gravity alignment finished
+};
+
+/// Noise model and buffering
+struct EskfConfig {
+    float accelNoise = 0.02f;           // m/s^2/sqrt(Hz)
+    float gyroNoise = 0.002f;           // rad/s/sqrt(Hz)
+    float accelBiasWalk = 1e-3f;        // m/s^3/sqrt(Hz)
+    float gyroBiasWalk = 1e-5f;         // rad/s^2/sqrt(Hz)
+    float gravity = 9.81f;              // m/s^2
+    float gateChi2 = 22.46f;            // 6-DoF innovation gate (99.9%); 0 disables
+    size_t historySize = 256;           // Propagation steps kept for late measurements
+    size_t measurementQueueSize = 64;
+    int alignmentSamples = 20;          // Accel samples averaged for initial roll/pitch
+    int64_t maxGapNs = 100'000'000;     // Longer IMU gaps skip propagation
+};
+
+/// Filter counters
+struct EskfStats {
+    int64_t propagations = 0;
+    int64_t updates = 0;
+    int64_t outOfOrderUpdates = 0;      // Updates that rolled back more than one step
+    int64_t rejectedUpdates = 0;        // Too old, gated or numerically failed
+    int64_t repropagatedSteps = 0;
+    float avgPropagateUs = 0.0f;
+    float avgUpdateUs = 0.0f;
+};
+
+/// Error-state Kalman filter fusing full-rate IMU propagation with
+/// frame-rate camera pose measurements.
+///
+/// Nominal state: position, velocity, orientation, accel and gyro bias.
+/// Error state (15): dp, dv, dtheta (local), dba, dbg. Every propagation step
+/// is kept in a short history so a measurement that arrives late (camera
+/// processing takes longer than IMU delivery) is applied at its own timestamp
+/// and the newer IMU steps are re-propagated on top of it.
+///
+/// addImuSample() and the step functions must run on one thread (a pipeline
+/// node). submitMeasurement(), getState() and getStats() are thread-safe.
+class Eskf {
+public:
+    static constexpr size_t kStateDim = 15;
+    using Covariance = MatN<kStateDim, kStateDim>;
+
+    explicit Eskf(EskfConfig config = {});
+
+    Eskf(const Eskf&) = delete;
+    Eskf& operator=(const Eskf&) = delete;
+
+    /// Feed an IMU sample. Gyro samples drive propagation with the latest
+    /// accel sample held; queued measurements are applied afterwards.
+    void addImuSample(const ImuSample& sample);
+
+    /// Queue a camera measurement from any thread. Returns false if the queue is full.
+    bool submitMeasurement(const PoseMeasurement& measurement);
+
+    /// Latest fused state (lock-free)
+    [[nodiscard]]
+    FusedState getState() const { return published_.load(); }
+
+    [[nodiscard]]
+    EskfStats getStats() const;
+
+    /// Start over: realign gravity on the next samples
+    void reset();
+
+    /// Single propagation step with bias-uncorrected IMU readings
+    void propagate(const Vec3& accel, const Vec3& gyro, float dt);
+
+    /// Apply a measurement at the current filter time
+    bool update(const PoseMeasurement& measurement);
+
+    /// Initialize at a known state (skips gravity alignment)
+    void initialize(TimestampNs timestampNs, const Quat& orientation);
+
+    [[nodiscard]]
+    const Covariance& covariance() const { return covariance_; }
+
+private:
+    struct Nominal {
+        Vec3 position;
+        Vec3 velocity;
+        Quat orientation;
+        Vec3 accelBias;
+        Vec3 gyroBias;
+    };
+
+    /// State at `timestampNs` and the IMU input that propagated it to the next entry
+    struct HistoryEntry {
+        TimestampNs timestampNs = 0;
+        Nominal state;
+        Covariance covariance;
+        Vec3 accel;
+        Vec3 gyro;
+    };
+
+    /// IMU input of one history step, replayed after a late measurement
+    struct ReplayStep {
+        TimestampNs startNs = 0;
+        Vec3 accel;
+        Vec3 gyro;
+    };
+
+    /// Record the current state in history, then propagate to endNs
+    void advance(TimestampNs endNs, const Vec3& accel, const Vec3& gyro);
+    void applyPendingMeasurements();
+    bool applyAt(const PoseMeasurement& measurement);
+    void alignGravity(const ImuSample& accel);
+    void publish();
+
+    // History ring buffer, oldest first
+    void pushHistory(const HistoryEntry& entry);
+    [[nodiscard]] HistoryEntry& historyAt(size_t index);
+
+    const EskfConfig config_;
+
+    // Filter-thread state
+    Nominal nominal_{};
+    Covariance covariance_{};
+    TimestampNs timestampNs_ = 0;
+    bool initialized_ = false;
+    Vec3 latestAccel_{};
+    bool hasAccel_ = false;
+    Vec3 alignmentSum_{};
+    int alignmentCount_ = 0;
+
+    std::vector<HistoryEntry> history_;
+    size_t historyStart_ = 0;
+    size_t historyCount_ = 0;
+    std::vector<ReplayStep> replay_;
+
+    BoundedQueue<PoseMeasurement> inbox_;
+    std::vector<PoseMeasurement> pending_;
+
+    SeqLock<FusedState> published_;
+
+    std::atomic<int64_t> propagations_{0};
+    std::atomic<int64_t> updates_{0};
+    std::atomic<int64_t> outOfOrderUpdates_{0};
+    std::atomic<int64_t> rejectedUpdates_{0};
+    std::atomic<int64_t> repropagatedSteps_{0};
+    std::atomic<int64_t> propagateNs_{0};
+    std::atomic<int64_t> updateNs_{0};
+};
+
+}  // namespace nativesensor
@@ -0,0 +1,79 @@
+#include "pose_predictor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "time_utils.h"
+
+namespace nativesensor {
+
+void PosePredictor::addSample(const ImuSample& sample) {
+    if (sample.sensorType != SensorType::Gyroscope) {
+        return;
+    }
+
+    const Vec3 omega(sample.x, sample.y, sample.z);
+    const int64_t dtNs = sample.timestampNs - state_.timestampNs;
+
+    if (state_.valid && dtNs <= 0) {
+        return;     // Out-of-order or duplicate sample
+    }
+    if (!state_.valid || dtNs > config_.maxGapNs) {
+        // (Re)start: keep orientation across gaps, but drop rate history
+        state_.timestampNs = sample.timestampNs;
+        state_.angularVelocity = omega;
+        state_.angularAccel = Vec3{};
+        state_.valid = true;
+        published_.store(state_);
+        return;
+    }
+
+    const float dt = static_cast<float>(dtNs) / static_cast<float>(kNsPerSecond);
+
+    // Midpoint rule over the interval between samples
+    const Quat delta = quat::fromRotationVector((state_.angularVelocity + omega) * (0.5f * dt));
+    state_.orientation = normalized(state_.orientation * delta);
+
+    const Vec3 diff = (omega - state_.angularVelocity) * (1.0f / dt);
+    const Vec3 raw(std::clamp(diff.x, -config_.maxAngularAccel, config_.maxAngularAccel),
+                   std::clamp(diff.y, -config_.maxAngularAccel, config_.maxAngularAccel),
+                   std::clamp(diff.z, -config_.maxAngularAccel, config_.maxAngularAccel));
+    state_.angularAccel += (raw - state_.angularAccel) * config_.angularAccelGain;
+    state_.angularVelocity = omega;
+    state_.timestampNs = sample.timestampNs;
+
+    published_.store(state_);
+}
+
+PredictedPose PosePredictor::predictPose(TimestampNs targetNs) const {
+    const State state = published_.load();
+
+    PredictedPose pose;
+    pose.targetNs = targetNs;
+    if (!state.valid) {
+        return pose;
+    }
+
+    const int64_t horizonNs = std::clamp(targetNs - state.timestampNs,
+                                         -config_.maxHorizonNs, config_.maxHorizonNs);
+    const float dt = static_cast<float>(horizonNs) / static_cast<float>(kNsPerSecond);
+
+    // Constant angular acceleration: theta = w*dt + a*dt^2/2
+    const Vec3 rotation = state.angularVelocity * dt + state.angularAccel * (0.5f * dt * dt);
+    const Vec3 velocity = state.angularVelocity + state.angularAccel * dt;
+    pose.angularVelocity[0] = velocity.x;
+    pose.angularVelocity[1] = velocity.y;
+    pose.angularVelocity[2] = velocity.z;
+
+    pose.sourceNs = state.timestampNs;
+    pose.orientation = normalized(state.orientation * quat::fromRotationVector(rotation));
+    pose.valid = true;
+    return pose;
+}
+
+void PosePredictor::reset() {
+    state_ = State{};
+    published_.store(state_);
+}
+
+}  // namespace nativesensor
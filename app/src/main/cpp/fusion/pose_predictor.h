@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+#include "geometry.h"
+#include "imu_data.h"
+#include "seqlock.h"
+#include "sensor_types.h"
+
+namespace nativesensor {
+
+/// Orientation extrapolated to a target time
+struct PredictedPose {
+    TimestampNs targetNs = 0;           // Requested prediction time
+    TimestampNs sourceNs = 0;           // Newest gyro sample the prediction is based on
+    Quat orientation;
+    float angularVelocity[3] = {};      // rad/s in body frame, extrapolated to targetNs
+    bool valid = false;                 // False until the first gyro samples arrived
+};
+
+/// Predictor tuning
+struct PosePredictorConfig {
+    int64_t maxHorizonNs = 100'000'000;     // Predictions further out are clamped
+    int64_t maxGapNs = 100'000'000;         // Longer gyro gaps restart integration
+    float angularAccelGain = 0.2f;          // Smoothing of angular acceleration (0 = first order)
+    float maxAngularAccel = 100.0f;         // rad/s^2 clamp against gyro noise spikes
+};
+
+/// Low-latency orientation predictor for motion-to-photon compensation.
+///
+/// The IMU thread integrates gyro samples into an orientation and smoothed
+/// angular acceleration, then publishes the state through a SeqLock. Any
+/// thread can extrapolate that state to a target time in constant time
+/// without locks. Orientation is relative to the first integrated sample
+/// (no gravity alignment; the fusion filter provides the absolute pose).
+class PosePredictor {
+public:
+    explicit PosePredictor(PosePredictorConfig config = {}) : config_(config) {}
+
+    PosePredictor(const PosePredictor&) = delete;
+    PosePredictor& operator=(const PosePredictor&) = delete;
+
+    /// Feed an IMU sample; non-gyro samples are ignored. Single producer.
+    void addSample(const ImuSample& sample);
+
+    /// Extrapolate orientation and angular velocity to targetNs. Any thread.
+    [[nodiscard]]
+    PredictedPose predictPose(TimestampNs targetNs) const;
+
+    /// Drop the integrated orientation (next sample restarts from identity).
+    /// Must be called from the producer thread or while it is stopped.
+    void reset();
+
+private:
+    /// Published state; trivially copyable for the SeqLock
+    struct State {
+        TimestampNs timestampNs = 0;
+        Quat orientation;
+        Vec3 angularVelocity;
+        Vec3 angularAccel;
+        bool valid = false;
+    };
+
+    const PosePredictorConfig config_;
+    SeqLock<State> published_;
+    State state_;       // Producer-side working copy
+};
+
+}  // namespace nativesensor
@@ -0,0 +1,116 @@
+#include "gyro_history.h"
+
+#include <algorithm>
+
+namespace nativesensor {
+
+namespace {
+
+constexpr float kNsToSeconds = 1e-9f;
+
+/// Rate at time t on the line between two samples
+Vec3 interpolate(const GyroReading& older, const GyroReading& newer, TimestampNs t) {
+    const int64_t span = newer.timestampNs - older.timestampNs;
+    if (span <= 0) {
+        return newer.rate;
+    }
+    const float alpha = static_cast<float>(t - older.timestampNs) / static_cast<float>(span);
+    return older.rate + (newer.rate - older.rate) * alpha;
+}
+
+}  // namespace
+
+void GyroHistory::addSample(const ImuSample& sample) noexcept {
+    if (sample.sensorType != SensorType::Gyroscope) {
+        return;
+    }
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[head % kCapacity];
+    // Release on each word: a reader that sees any of them also sees the
+    // head that made this write a lap, and rejects its scan
+    slot.timestampNs.store(sample.timestampNs, std::memory_order_release);
+    slot.x.store(sample.x, std::memory_order_release);
+    slot.y.store(sample.y, std::memory_order_release);
+    slot.z.store(sample.z, std::memory_order_release);
+    head_.store(head + 1, std::memory_order_release);
+}
+
+template<typename Visitor>
+bool GyroHistory::scanBack(TimestampNs beginNs, TimestampNs endNs, Visitor&& visit) const {
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    if (head == 0 || endNs < beginNs) {
+        return false;
+    }
+    const uint64_t oldest = head > kCapacity ? head - kCapacity : 0;
+
+    // Acquire loads keep the overwrite check below after every slot read
+    const auto read = [this](uint64_t index) {
+        const Slot& slot = slots_[index % kCapacity];
+        return GyroReading{slot.timestampNs.load(std::memory_order_acquire),
+                           {slot.x.load(std::memory_order_acquire),
+                            slot.y.load(std::memory_order_acquire),
+                            slot.z.load(std::memory_order_acquire)}};
+    };
+
+    uint64_t index = head - 1;
+    GyroReading sample = read(index);
+    if (sample.timestampNs < endNs - kMaxHoldNs) {
+        return false;   // Gyro stopped or lags behind the window
+    }
+    visit(sample);
+    bool covered = sample.timestampNs <= beginNs;
+    while (!covered && index > oldest) {
+        sample = read(--index);
+        visit(sample);
+        covered = sample.timestampNs <= beginNs;
+    }
+
+    // The writer may have lapped the oldest slots we read
+    return covered && index + kCapacity > head_.load(std::memory_order_acquire);
+}
+
+std::optional<Vec3> GyroHistory::integrate(TimestampNs beginNs, TimestampNs endNs) const noexcept {
+    // Trapezoid-integrate each interval's overlap with the window, holding
+    // the newest rate up to endNs
+    Vec3 rotation;
+    GyroReading newer{};
+    bool first = true;
+    const bool ok = scanBack(beginNs, endNs, [&](const GyroReading& older) {
+        if (first) {
+            if (older.timestampNs < endNs) {
+                const TimestampNs from = std::max(older.timestampNs, beginNs);
+                rotation += older.rate * (static_cast<float>(endNs - from) * kNsToSeconds);
+            }
+            first = false;
+        } else {
+            const TimestampNs from = std::max(older.timestampNs, beginNs);
+            const TimestampNs to = std::min(newer.timestampNs, endNs);
+            if (to > from) {
+                const Vec3 mean = (interpolate(older, newer, from) + interpolate(older, newer, to)) * 0.5f;
+                rotation += mean * (static_cast<float>(to - from) * kNsToSeconds);
+            }
+        }
+        newer = older;
+    });
+    if (!ok) {
+        return std::nullopt;
+    }
+    return rotation;
+}
+
+bool GyroHistory::window(TimestampNs beginNs, TimestampNs endNs, std::vector<GyroReading>& out) const {
+    out.clear();
+    if (!scanBack(beginNs, endNs, [&out](const GyroReading& sample) { out.push_back(sample); })) {
+        out.clear();
+        return false;
+    }
+    std::reverse(out.begin(), out.end());
+    return true;
+}
+
+TimestampNs GyroHistory::latestTimestampNs() const noexcept {
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    return head == 0 ? 0 : slots_[(head - 1) % kCapacity].timestampNs.load(std::memory_order_relaxed);
+}
+
+}  // namespace nativesensor
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "geometry.h"
+#include "imu_data.h"
+#include "sensor_types.h"
+
+namespace nativesensor {
+
+/// One gyro rate measurement
+struct GyroReading {
+    TimestampNs timestampNs = 0;
+    Vec3 rate;                          // rad/s, gyro frame
+};
+
+/// Recent gyroscope samples for questions about a past time window, such as
+/// how far the device turned while a camera frame was exposed.
+///
+/// Single writer (the IMU thread), any number of lock-free readers. Like
+/// SeqLock, slots are atomic words: a reader that races the writer detects
+/// samples overwritten during its scan instead of reading torn values.
+class GyroHistory {
+public:
+    /// Ring size; half a second at 2 kHz
+    static constexpr size_t kCapacity = 1024;
+
+    /// The newest sample's rate is held at most this long past its timestamp
+    static constexpr int64_t kMaxHoldNs = 5'000'000;
+
+    GyroHistory() = default;
+
+    GyroHistory(const GyroHistory&) = delete;
+    GyroHistory& operator=(const GyroHistory&) = delete;
+
+    /// Append a sample; non-gyro samples are ignored. Single producer.
+    void addSample(const ImuSample& sample) noexcept;
+
+    /// Rotation vector (rad, gyro frame) accumulated over [beginNs, endNs],
+    /// integrating the rate linearly between samples. Empty if the history
+    /// does not cover the window (too old, or gyro not running yet).
+    [[nodiscard]]
+    std::optional<Vec3> integrate(TimestampNs beginNs, TimestampNs endNs) const noexcept;
+
+    /// Copy the samples spanning [beginNs, endNs] into `out`, oldest first:
+    /// from the last one at or before beginNs through the newest one (which
+    /// may end up to kMaxHoldNs before endNs). False if not covered.
+    bool window(TimestampNs beginNs, TimestampNs endNs, std::vector<GyroReading>& out) const;
+
+    /// Timestamp of the newest sample (0 before the first one)
+    [[nodiscard]]
+    TimestampNs latestTimestampNs() const noexcept;
+
+private:
+    /// Visit samples newest to oldest until one at or before beginNs. False if
+    /// the history doesn't reach endNs (minus the hold) or back to beginNs,
+    /// or if the writer overwrote part of the visited range meanwhile.
+    template<typename Visitor>
+    bool scanBack(TimestampNs beginNs, TimestampNs endNs, Visitor&& visit) const;
+
+    struct Slot {
+        std::atomic<int64_t> timestampNs{0};
+        std::atomic<float> x{0.0f};
+        std::atomic<float> y{0.0f};
+        std::atomic<float> z{0.0f};
+    };
+
+    std::array<Slot, kCapacity> slots_{};
+    std::atomic<uint64_t> head_{0};     // Index one past the newest sample
+};
+
+}  // namespace nativesensor
@@ -0,0 +1,194 @@
+#include "imu_anomaly_detector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace nativesensor {
+
+namespace {
+
+// Intervals before the period estimate is trusted for dropouts
+constexpr int32_t kPeriodWarmupSamples = 16;
+constexpr float kPeriodSmoothing = 1.0f / 64.0f;
+
+bool sameBits(float a, float b) noexcept {
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+}  // namespace
+
+ImuAnomalyDetector::ImuAnomalyDetector(const ImuAnomalyConfig& config)
+    : config_(config), configVersion_(config_.version()), active_(config) {}
+
+void ImuAnomalyDetector::setConfig(const ImuAnomalyConfig& config) {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    config_.store(config);
+}
+
+void ImuAnomalyDetector::reset() {
+    resetRequested_.store(true, std::memory_order_release);
+}
+
+int64_t ImuAnomalyDetector::count(ImuAnomalyType type) const noexcept {
+    const auto index = static_cast<size_t>(type);
+    return index < counts_.size() ? counts_[index].load(std::memory_order_relaxed) : 0;
+}
+
+void ImuAnomalyDetector::process(const ImuSample* samples, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        process(samples[i]);
+    }
+}
+
+void ImuAnomalyDetector::process(const ImuSample& sample) {
+    if (resetRequested_.exchange(false, std::memory_order_acq_rel)) {
+        accel_ = {};
+        gyro_ = {};
+        inShock_ = false;
+        shockEndNs_ = 0;
+        freeFallStartNs_ = 0;
+        freeFallReported_ = false;
+    }
+    if (const uint64_t version = config_.version(); version != configVersion_) {
+        active_ = config_.load();
+        configVersion_ = version;
+    }
+
+    if (sample.sensorType == SensorType::Accelerometer) {
+        checkDropout(accel_, sample.sensorType, sample.timestampNs);
+        checkStuck(accel_, sample.sensorType, sample);
+        checkSaturation(accel_, sample.sensorType, sample, active_.accelRangeMs2, active_.shockThresholdMs2);
+        checkShockAndFreeFall(sample);
+    } else if (sample.sensorType == SensorType::Gyroscope) {
+        checkDropout(gyro_, sample.sensorType, sample.timestampNs);
+        checkStuck(gyro_, sample.sensorType, sample);
+        checkSaturation(gyro_, sample.sensorType, sample, active_.gyroRangeRadS, active_.gyroFlatTopMinRadS);
+    }
+}
+
+void ImuAnomalyDetector::checkDropout(SensorState& state, SensorType sensor, TimestampNs timestampNs) {
+    const TimestampNs lastNs = state.lastNs;
+    state.lastNs = timestampNs;
+    const int64_t intervalNs = timestampNs - lastNs;
+    if (lastNs == 0 || intervalNs <= 0) {
+        return;     // First sample, duplicate or out of order
+    }
+
+    const auto interval = static_cast<float>(intervalNs);
+    if (state.periodSamples >= kPeriodWarmupSamples) {
+        const float limit = std::max(static_cast<float>(active_.dropoutMinNs),
+                                     active_.dropoutPeriods * state.periodNs);
+        if (interval > limit) {
+            emit(ImuAnomalyType::Dropout, sensor, lastNs, intervalNs, interval * 1e-6f);
+            return;     // Gaps don't feed the period estimate
+        }
+    }
+    // Plain average while warming up, then slow exponential smoothing
+    ++state.periodSamples;
+    const float alpha = std::max(1.0f / static_cast<float>(state.periodSamples), kPeriodSmoothing);
+    state.periodNs += alpha * (interval - state.periodNs);
+}
+
+void ImuAnomalyDetector::checkStuck(SensorState& state, SensorType sensor, const ImuSample& sample) {
+    // Runs after the first sample; checkSaturation() updates `previous` afterwards
+    const bool same = state.stuckRun > 0 && sameBits(sample.x, state.axes[0].previous) &&
+                      sameBits(sample.y, state.axes[1].previous) && sameBits(sample.z, state.axes[2].previous);
+    if (!same) {
+        state.stuckRun = 1;
+        state.stuckReported = false;
+        return;
+    }
+    ++state.stuckRun;
+    if (!state.stuckReported && state.stuckRun >= std::max(active_.stuckSamples, 2)) {
+        state.stuckReported = true;
+        // The run started stuckRun - 1 intervals ago
+        const auto durationNs = static_cast<int64_t>(state.periodNs * static_cast<float>(state.stuckRun - 1));
+        emit(ImuAnomalyType::StuckAt, sensor, sample.timestampNs - durationNs, durationNs, sample.x);
+    }
+}
+
+void ImuAnomalyDetector::checkSaturation(SensorState& state, SensorType sensor, const ImuSample& sample,
+                                         float range, float flatTopMin) {
+    // Clipped: at the known full scale, or pinned to one value at a peak
+    const float values[3] = {sample.x, sample.y, sample.z};
+    const bool rangeKnown = range > 0.0f;
+    const float rangeLimit = range * active_.saturationFraction;
+    bool clipped = false;
+    float peak = 0.0f;
+    for (size_t axis = 0; axis < 3; ++axis) {
+        AxisState& a = state.axes[axis];
+        const float magnitude = std::fabs(values[axis]);
+        a.run = sameBits(values[axis], a.previous) ? a.run + 1 : 1;
+        a.previous = values[axis];
+        if ((rangeKnown && magnitude >= rangeLimit) ||
+            (magnitude >= flatTopMin && a.run >= std::max(active_.flatTopSamples, 2))) {
+            clipped = true;
+            peak = std::max(peak, magnitude);
+        }
+    }
+
+    if (clipped) {
+        if (!state.saturated) {
+            state.saturated = true;
+            state.saturationStartNs = sample.timestampNs;
+            state.saturationPeak = 0.0f;
+        }
+        state.saturationPeak = std::max(state.saturationPeak, peak);
+    } else if (state.saturated) {
+        state.saturated = false;
+        emit(ImuAnomalyType::Saturation, sensor, state.saturationStartNs,
+             sample.timestampNs - state.saturationStartNs, state.saturationPeak);
+    }
+}
+
+void ImuAnomalyDetector::checkShockAndFreeFall(const ImuSample& sample) {
+    const float magnitude = std::sqrt(sample.x * sample.x + sample.y * sample.y + sample.z * sample.z);
+    const TimestampNs t = sample.timestampNs;
+
+    if (magnitude >= active_.shockThresholdMs2) {
+        if (!inShock_) {
+            inShock_ = true;
+            shockStartNs_ = t;
+            shockPeak_ = 0.0f;
+        }
+        shockPeak_ = std::max(shockPeak_, magnitude);
+    } else if (inShock_) {
+        inShock_ = false;
+        // Rebounds within the holdoff belong to the previous impact
+        if (shockEndNs_ == 0 || shockStartNs_ - shockEndNs_ >= active_.shockHoldoffNs) {
+            emit(ImuAnomalyType::Shock, SensorType::Accelerometer, shockStartNs_, t - shockStartNs_, shockPeak_);
+        }
+        shockEndNs_ = t;
+    }
+
+    if (magnitude < active_.freeFallThresholdMs2) {
+        if (freeFallStartNs_ == 0) {
+            freeFallStartNs_ = t;
+            freeFallMin_ = magnitude;
+            freeFallReported_ = false;
+        }
+        freeFallMin_ = std::min(freeFallMin_, magnitude);
+        if (!freeFallReported_ && t - freeFallStartNs_ >= active_.freeFallMinNs) {
+            freeFallReported_ = true;
+            emit(ImuAnomalyType::FreeFall, SensorType::Accelerometer, freeFallStartNs_, t - freeFallStartNs_,
+                 freeFallMin_);
+        }
+    } else {
+        freeFallStartNs_ = 0;
+    }
+}
+
+void ImuAnomalyDetector::emit(ImuAnomalyType type, SensorType sensor, TimestampNs startNs, int64_t durationNs,
+                              float value) {
+    const ImuAnomaly event{type, sensor, startNs, durationNs, value};
+    counts_[static_cast<size_t>(type)].fetch_add(1, std::memory_order_relaxed);
+    if (!events_.tryPush(event)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (callback_) {
+        callback_(event);
+    }
+}
+
+}  // namespace nativesensor
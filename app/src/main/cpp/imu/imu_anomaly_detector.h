@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+#include "bounded_queue.h"
+#include "imu_data.h"
+#include "seqlock.h"
+#include "sensor_types.h"
+
+namespace nativesensor {
+
+enum class ImuAnomalyType : int32_t {
+    Shock = 1,          // Accel magnitude above the shock threshold
+    FreeFall = 2,       // Accel magnitude near zero for a while
+    Saturation = 3,     // An axis clipped at the sensor's full scale
+    StuckAt = 4,        // Bit-identical samples in a row
+    Dropout = 5,        // Gap between samples far above the nominal period
+};
+
+/// One detected anomaly
+struct ImuAnomaly {
+    ImuAnomalyType type = ImuAnomalyType::Shock;
+    SensorType sensor = SensorType::Accelerometer;
+    TimestampNs timestampNs = 0;        // Start of the episode
+    int64_t durationNs = 0;             // Episode length when reported
+    float value = 0.0f;                 // Peak (shock, saturation), minimum (free fall) or stuck x value
+};
+
+/// Detection thresholds; accel in m/s^2, gyro in rad/s
+struct ImuAnomalyConfig {
+    float shockThresholdMs2 = 39.2f;            // 4 g
+    int64_t shockHoldoffNs = 200'000'000;       // Rings of one impact stay one event
+    float freeFallThresholdMs2 = 2.0f;
+    int64_t freeFallMinNs = 80'000'000;         // About a 3 cm drop
+    float accelRangeMs2 = 0.0f;                 // Full scale; 0 = unknown, detect flat tops only
+    float gyroRangeRadS = 0.0f;
+    float saturationFraction = 0.995f;          // Of full scale
+    int32_t flatTopSamples = 3;                 // Identical peak values on an axis that count as clipped
+    float gyroFlatTopMinRadS = 8.7f;            // 500 dps; accel flat tops start at the shock threshold
+    int32_t stuckSamples = 100;
+    float dropoutPeriods = 5.0f;                // Gap in nominal sample periods
+    int64_t dropoutMinNs = 20'000'000;
+};
+
+/// Streaming detector for shocks, free fall, saturation, stuck-at values and
+/// dropouts on the accel and gyro streams.
+///
+/// Each rule is a small state machine per sensor, so memory is constant and
+/// a sample costs a handful of comparisons. Shock and saturation are reported
+/// when the episode ends (with its peak), free fall and stuck-at once they
+/// held long enough, dropouts when the late sample arrives. Events go into a
+/// bounded queue for any consumer and, optionally, to a callback on the
+/// producer thread. process() has a single producer (the IMU thread); the
+/// config may be replaced from anywhere and is picked up on the next sample.
+class ImuAnomalyDetector {
+public:
+    using EventCallback = std::function<void(const ImuAnomaly&)>;
+
+    static constexpr size_t kQueueCapacity = 256;
+
+    explicit ImuAnomalyDetector(const ImuAnomalyConfig& config = {});
+
+    ImuAnomalyDetector(const ImuAnomalyDetector&) = delete;
+    ImuAnomalyDetector& operator=(const ImuAnomalyDetector&) = delete;
+
+    /// Evaluate one sample (other sensor types are ignored)
+    void process(const ImuSample& sample);
+
+    /// Evaluate a batch in order
+    void process(const ImuSample* samples, size_t count);
+
+    void setConfig(const ImuAnomalyConfig& config);
+
+    /// Read-modify-write of the config that no other writer can interleave
+    /// with: `update` edits a copy of the current config
+    template<typename Update>
+    void updateConfig(Update&& update) {
+        std::lock_guard<std::mutex> lock(configMutex_);
+        ImuAnomalyConfig config = config_.load();
+        update(config);
+        config_.store(config);
+    }
+
+    [[nodiscard]]
+    ImuAnomalyConfig config() const { return config_.load(); }
+
+    /// Called on the producer thread for every event; keep it cheap.
+    /// Set before the first sample.
+    void setEventCallback(EventCallback callback) { callback_ = std::move(callback); }
+
+    /// Take the oldest queued event; false if none
+    bool poll(ImuAnomaly& event) noexcept { return events_.tryPop(event); }
+
+    /// Events detected so far, by type
+    [[nodiscard]]
+    int64_t count(ImuAnomalyType type) const noexcept;
+
+    /// Events lost because nobody drained the queue
+    [[nodiscard]]
+    int64_t droppedEvents() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+    /// Forget stream state (sensor switch or restart); counters are kept
+    void reset();
+
+private:
+    struct AxisState {
+        float previous = 0.0f;
+        int32_t run = 0;                // Samples equal to `previous`
+    };
+
+    struct SensorState {
+        TimestampNs lastNs = 0;
+        float periodNs = 0.0f;          // Smoothed nominal sample interval
+        int32_t periodSamples = 0;
+        std::array<AxisState, 3> axes{};
+        int32_t stuckRun = 0;
+        bool stuckReported = false;
+        bool saturated = false;
+        TimestampNs saturationStartNs = 0;
+        float saturationPeak = 0.0f;
+    };
+
+    void checkDropout(SensorState& state, SensorType sensor, TimestampNs timestampNs);
+    void checkStuck(SensorState& state, SensorType sensor, const ImuSample& sample);
+    void checkSaturation(SensorState& state, SensorType sensor, const ImuSample& sample,
+                         float range, float flatTopMin);
+    void checkShockAndFreeFall(const ImuSample& sample);
+    void emit(ImuAnomalyType type, SensorType sensor, TimestampNs startNs, int64_t durationNs, float value);
+
+    // Config snapshot, refreshed on the producer thread when the version changes
+    std::mutex configMutex_;                        // Serializes config writers
+    SeqLock<ImuAnomalyConfig> config_;
+    uint64_t configVersion_ = 0;
+    ImuAnomalyConfig active_;
+
+    // Producer-thread state
+    std::atomic<bool> resetRequested_{false};
+    SensorState accel_;
+    SensorState gyro_;
+    bool inShock_ = false;
+    TimestampNs shockStartNs_ = 0;
+    TimestampNs shockEndNs_ = 0;
+    float shockPeak_ = 0.0f;
+    TimestampNs freeFallStartNs_ = 0;
+    float freeFallMin_ = 0.0f;
+    bool freeFallReported_ = false;
+
+    EventCallback callback_;
+    BoundedQueue<ImuAnomaly> events_{kQueueCapacity};
+    std::array<std::atomic<int64_t>, 6> counts_{};
+    std::atomic<int64_t> dropped_{0};
+};
+
+}  // namespace nativesensor
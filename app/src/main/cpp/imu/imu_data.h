@@ -10,7 +10,7 @@ struct ImuSample {
     float y;
     float z;
     TimestampNs timestampNs;
-    [[maybe_unused]] SensorType sensorType;  // Reserved for multi-sensor disambiguation
+    SensorType sensorType;
 };
 
 /// IMU statistics for performance monitoring
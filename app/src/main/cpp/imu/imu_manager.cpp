@@ -28,9 +28,22 @@ constexpr int64_t kNsPerSecond = 1'000'000'000LL;
 constexpr double kNsToMs = 1'000'000.0;
 constexpr int kMicrosPerSecond = 1'000'000;
 
+/// [x, y, z, timestampMs], as nativeGetAccelData/nativeGetGyroData
+void flattenSample(const ImuSample& sample, std::vector<float>& out) {
+    out = {sample.x, sample.y, sample.z, static_cast<float>(static_cast<double>(sample.timestampNs) / kNsToMs)};
+}
+
+/// [accelHz, accelLatencyMs, gyroHz, gyroLatencyMs], as nativeGetStats
+void flattenStats(const ImuStats& stats, std::vector<float>& out) {
+    out = {stats.accelFrequencyHz, stats.accelLatencyMs, stats.gyroFrequencyHz, stats.gyroLatencyMs};
+}
+
 }  // namespace
 
-ImuManager::ImuManager() {
+ImuManager::ImuManager(MailboxRegistry& mailboxes)
+    : latestAccel_(mailboxes.mailbox<ImuSample>(streams::kAccel, "imu.accel", flattenSample)),
+      latestGyro_(mailboxes.mailbox<ImuSample>(streams::kGyro, "imu.gyro", flattenSample)),
+      latestStats_(mailboxes.mailbox<ImuStats>(streams::kImuStats, "imu.stats", flattenStats)) {
     sensorManager_ = ASensorManager_getInstanceForPackage(kPackageName);
     if (!sensorManager_) {
         LOGE("Failed to get ASensorManager instance");
@@ -59,17 +72,16 @@ void ImuManager::start(ImuCallback callback) {
     }
 
     callback_ = std::move(callback);
+    startTimeNs_.store(getBootTimeNs(), std::memory_order_release);
+    firstSampleNs_.store(0, std::memory_order_release);
     running_.store(true, std::memory_order_release);
 
     // Reset stats
     {
         std::lock_guard<std::mutex> lock(statsMutex_);
-        statsWindowStart_ = getBootTimeNs();
-        accelCount_ = 0;
-        gyroCount_ = 0;
-        accelLatencyTotal_ = 0;
-        gyroLatencyTotal_ = 0;
+        statsWindow_ = StatsWindow{getBootTimeNs()};
     }
+    publishedWindow_ = StatsWindow{getBootTimeNs()};
 
     sensorThread_ = std::thread(&ImuManager::sensorThreadLoop, this);
     LOGI("ImuManager started");
@@ -83,8 +95,8 @@ void ImuManager::stop() {
     running_.store(false, std::memory_order_release);
 
     // Wake up the looper to exit
-    if (looper_) {
-        ALooper_wake(looper_);
+    if (ALooper* looper = looper_.load(std::memory_order_acquire)) {
+        ALooper_wake(looper);
     }
 
     if (sensorThread_.joinable()) {
@@ -111,8 +123,9 @@ void ImuManager::switchSensors(int32_t accelHandle, int32_t gyroHandle) {
 
 void ImuManager::sensorThreadLoop() {
     // Create looper for this thread
-    looper_ = ALooper_prepare(ALOOPER_PREPARE_ALLOW_NON_CALLBACKS);
-    if (!looper_) {
+    ALooper* looper = ALooper_prepare(ALOOPER_PREPARE_ALLOW_NON_CALLBACKS);
+    looper_.store(looper, std::memory_order_release);
+    if (!looper) {
         LOGE("Failed to prepare ALooper");
         return;
     }
@@ -120,7 +133,7 @@ void ImuManager::sensorThreadLoop() {
     // Create event queue - poll directly without callback
     eventQueue_ = ASensorManager_createEventQueue(
         sensorManager_,
-        looper_,
+        looper,
         kLooperId,
         nullptr,
         nullptr
@@ -136,33 +149,37 @@ void ImuManager::sensorThreadLoop() {
     int sensorCount = ASensorManager_getSensorList(sensorManager_, &sensorList);
 
     // Select accelerometer
+    const ASensor* accel = nullptr;
     int32_t accelHandle = targetAccelHandle_.load(std::memory_order_acquire);
     if (accelHandle >= 0 && accelHandle < sensorCount) {
-        currentAccel_ = sensorList[accelHandle];
+        accel = sensorList[accelHandle];
     } else {
-        currentAccel_ = ASensorManager_getDefaultSensor(sensorManager_, ASENSOR_TYPE_ACCELEROMETER);
+        accel = ASensorManager_getDefaultSensor(sensorManager_, ASENSOR_TYPE_ACCELEROMETER);
     }
+    currentAccel_.store(accel, std::memory_order_release);
 
     // Select gyroscope
+    const ASensor* gyro = nullptr;
     int32_t gyroHandle = targetGyroHandle_.load(std::memory_order_acquire);
     if (gyroHandle >= 0 && gyroHandle < sensorCount) {
-        currentGyro_ = sensorList[gyroHandle];
+        gyro = sensorList[gyroHandle];
     } else {
-        currentGyro_ = ASensorManager_getDefaultSensor(sensorManager_, ASENSOR_TYPE_GYROSCOPE);
+        gyro = ASensorManager_getDefaultSensor(sensorManager_, ASENSOR_TYPE_GYROSCOPE);
     }
+    currentGyro_.store(gyro, std::memory_order_release);
 
     // Register sensors at MAXIMUM rate using minDelay for fastest hardware rate
-    if (currentAccel_) {
-        int minDelay = ASensor_getMinDelay(currentAccel_);
+    if (accel) {
+        int minDelay = ASensor_getMinDelay(accel);
         accelMinDelay_.store(minDelay, std::memory_order_release);
-        accelFifo_.store(ASensor_getFifoReservedEventCount(currentAccel_), std::memory_order_release);
+        accelFifo_.store(ASensor_getFifoReservedEventCount(accel), std::memory_order_release);
 
         // Use registerSensor with minDelay for maximum hardware rate
         // maxBatchReportLatencyUs = 0 means no batching, deliver immediately
-        ASensorEventQueue_registerSensor(eventQueue_, currentAccel_, minDelay, 0);
+        ASensorEventQueue_registerSensor(eventQueue_, accel, minDelay, 0);
 
         LOGI("Registered accelerometer: %s (minDelay=%dμs, fifo=%d)",
-             ASensor_getName(currentAccel_),
+             ASensor_getName(accel),
              accelMinDelay_.load(),
              accelFifo_.load());
     } else {
@@ -171,16 +188,16 @@ void ImuManager::sensorThreadLoop() {
         accelFifo_.store(0, std::memory_order_release);
     }
 
-    if (currentGyro_) {
-        int minDelay = ASensor_getMinDelay(currentGyro_);
+    if (gyro) {
+        int minDelay = ASensor_getMinDelay(gyro);
         gyroMinDelay_.store(minDelay, std::memory_order_release);
-        gyroFifo_.store(ASensor_getFifoReservedEventCount(currentGyro_), std::memory_order_release);
+        gyroFifo_.store(ASensor_getFifoReservedEventCount(gyro), std::memory_order_release);
 
         // Use registerSensor with minDelay for maximum hardware rate
-        ASensorEventQueue_registerSensor(eventQueue_, currentGyro_, minDelay, 0);
+        ASensorEventQueue_registerSensor(eventQueue_, gyro, minDelay, 0);
 
         LOGI("Registered gyroscope: %s (minDelay=%dμs, fifo=%d)",
-             ASensor_getName(currentGyro_),
+             ASensor_getName(gyro),
              gyroMinDelay_.load(),
              gyroFifo_.load());
     } else {
@@ -198,18 +215,18 @@ void ImuManager::sensorThreadLoop() {
     }
 
     // Cleanup
-    if (currentAccel_) {
-        ASensorEventQueue_disableSensor(eventQueue_, currentAccel_);
+    if (accel) {
+        ASensorEventQueue_disableSensor(eventQueue_, accel);
     }
-    if (currentGyro_) {
-        ASensorEventQueue_disableSensor(eventQueue_, currentGyro_);
+    if (gyro) {
+        ASensorEventQueue_disableSensor(eventQueue_, gyro);
     }
 
     ASensorManager_destroyEventQueue(sensorManager_, eventQueue_);
     eventQueue_ = nullptr;
-    looper_ = nullptr;
-    currentAccel_ = nullptr;
-    currentGyro_ = nullptr;
+    looper_.store(nullptr, std::memory_order_release);
+    currentAccel_.store(nullptr, std::memory_order_release);
+    currentGyro_.store(nullptr, std::memory_order_release);
 
     LOGI("Sensor thread exited");
 }
@@ -217,14 +234,16 @@ void ImuManager::sensorThreadLoop() {
 void ImuManager::drainEvents() {
     ASensorEvent event;
     const int64_t now = getBootTimeNs();
+    const ASensor* accel = currentAccel_.load(std::memory_order_relaxed);
+    const ASensor* gyro = currentGyro_.load(std::memory_order_relaxed);
 
     // Process ALL pending events in the queue
     while (ASensorEventQueue_getEvents(eventQueue_, &event, 1) > 0) {
         ImuSample sample{};
         sample.timestampNs = event.timestamp;
 
-        bool isAccel = currentAccel_ && event.type == ASensor_getType(currentAccel_);
-        bool isGyro = currentGyro_ && event.type == ASensor_getType(currentGyro_);
+        bool isAccel = accel && event.type == ASensor_getType(accel);
+        bool isGyro = gyro && event.type == ASensor_getType(gyro);
 
         if (isAccel) {
             sample.x = event.acceleration.x;
@@ -232,17 +251,8 @@ void ImuManager::drainEvents() {
             sample.z = event.acceleration.z;
             sample.sensorType = SensorType::Accelerometer;
 
-            // Update latest value
-            {
-                std::lock_guard<std::mutex> lock(dataMutex_);
-                latestAccel_ = sample;
-            }
-
-            // Update stats
-            {
-                std::lock_guard<std::mutex> lock(statsMutex_);
-                accelCount_++;
-                accelLatencyTotal_ += (now - event.timestamp);
+            if (latestAccel_) {
+                latestAccel_->store(sample);
             }
 
         } else if (isGyro) {
@@ -251,18 +261,24 @@ void ImuManager::drainEvents() {
             sample.z = event.vector.z;
             sample.sensorType = SensorType::Gyroscope;
 
-            // Update latest value
-            {
-                std::lock_guard<std::mutex> lock(dataMutex_);
-                latestGyro_ = sample;
+            if (latestGyro_) {
+                latestGyro_->store(sample);
             }
+        }
 
-            // Update stats
+        // Update stats
+        if (isAccel || isGyro) {
             {
                 std::lock_guard<std::mutex> lock(statsMutex_);
-                gyroCount_++;
-                gyroLatencyTotal_ += (now - event.timestamp);
+                statsWindow_.add(isAccel, now - event.timestamp);
             }
+            publishedWindow_.add(isAccel, now - event.timestamp);
+        }
+
+        if ((isAccel || isGyro) && firstSampleNs_.load(std::memory_order_relaxed) == 0) {
+            firstSampleNs_.store(now, std::memory_order_release);
+            LOGI("First IMU sample %.2f ms after start",
+                 static_cast<double>(now - startTimeNs_.load(std::memory_order_acquire)) / kNsToMs);
         }
 
         // Invoke callback for every sample
@@ -270,48 +286,73 @@ void ImuManager::drainEvents() {
             callback_(sample);
         }
     }
+
+    if (now - publishedWindow_.startNs >= kNsPerSecond) {
+        if (latestStats_) {
+            latestStats_->store(publishedWindow_.summarize(now));
+        }
+        publishedWindow_ = StatsWindow{now};
+    }
 }
 
 ImuSample ImuManager::getLatestAccel() const {
-    std::lock_guard<std::mutex> lock(dataMutex_);
-    return latestAccel_;
+    ImuSample sample{};
+    if (latestAccel_) {
+        latestAccel_->load(sample);
+    }
+    return sample;
 }
 
 ImuSample ImuManager::getLatestGyro() const {
-    std::lock_guard<std::mutex> lock(dataMutex_);
-    return latestGyro_;
+    ImuSample sample{};
+    if (latestGyro_) {
+        latestGyro_->load(sample);
+    }
+    return sample;
 }
 
 ImuStats ImuManager::getStats() {
     std::lock_guard<std::mutex> lock(statsMutex_);
 
     const int64_t now = getBootTimeNs();
-    const double dtSeconds = static_cast<double>(now - statsWindowStart_) / kNsPerSecond;
+    const ImuStats stats = statsWindow_.summarize(now);
+
+    // Reset counters
+    statsWindow_ = StatsWindow{now};
+
+    return stats;
+}
+
+void ImuManager::StatsWindow::add(bool accel, int64_t latencyNs) noexcept {
+    if (accel) {
+        accelCount++;
+        accelLatencyTotal += latencyNs;
+    } else {
+        gyroCount++;
+        gyroLatencyTotal += latencyNs;
+    }
+}
+
+ImuStats ImuManager::StatsWindow::summarize(int64_t nowNs) const noexcept {
+    const double dtSeconds = static_cast<double>(nowNs - startNs) / kNsPerSecond;
 
     ImuStats stats{};
 
     if (dtSeconds > 0.0) {
-        stats.accelFrequencyHz = static_cast<float>(accelCount_ / dtSeconds);
-        stats.gyroFrequencyHz = static_cast<float>(gyroCount_ / dtSeconds);
+        stats.accelFrequencyHz = static_cast<float>(accelCount / dtSeconds);
+        stats.gyroFrequencyHz = static_cast<float>(gyroCount / dtSeconds);
     }
 
-    if (accelCount_ > 0) {
+    if (accelCount > 0) {
         stats.accelLatencyMs = static_cast<float>(
-            static_cast<double>(accelLatencyTotal_) / accelCount_ / kNsToMs);
+            static_cast<double>(accelLatencyTotal) / accelCount / kNsToMs);
     }
 
-    if (gyroCount_ > 0) {
+    if (gyroCount > 0) {
         stats.gyroLatencyMs = static_cast<float>(
-            static_cast<double>(gyroLatencyTotal_) / gyroCount_ / kNsToMs);
+            static_cast<double>(gyroLatencyTotal) / gyroCount / kNsToMs);
     }
 
-    // Reset counters
-    statsWindowStart_ = now;
-    accelCount_ = 0;
-    gyroCount_ = 0;
-    accelLatencyTotal_ = 0;
-    gyroLatencyTotal_ = 0;
-
     return stats;
 }
 
@@ -321,12 +362,19 @@ ImuSensorMetadata ImuManager::getMetadata() const {
     meta.accelFifoReserved = accelFifo_.load(std::memory_order_acquire);
     meta.gyroMinDelayUs = gyroMinDelay_.load(std::memory_order_acquire);
     meta.gyroFifoReserved = gyroFifo_.load(std::memory_order_acquire);
-    meta.accelName = currentAccel_ ? ASensor_getName(currentAccel_) : "None";
-    meta.gyroName = currentGyro_ ? ASensor_getName(currentGyro_) : "None";
+    const ASensor* accel = currentAccel_.load(std::memory_order_acquire);
+    const ASensor* gyro = currentGyro_.load(std::memory_order_acquire);
+    meta.accelName = accel ? ASensor_getName(accel) : "None";
+    meta.gyroName = gyro ? ASensor_getName(gyro) : "None";
     return meta;
 }
 
-std::vector<SensorInfo> ImuManager::enumerateSensors() {
+std::vector<SensorInfo> ImuManager::enumerateSensors(bool forceRefresh) {
+    std::lock_guard<std::mutex> lock(enumMutex_);
+    if (sensorCacheValid_ && !forceRefresh) {
+        return sensorCache_;
+    }
+
     std::vector<SensorInfo> sensors;
 
     if (!sensorManager_) {
@@ -362,8 +410,16 @@ std::vector<SensorInfo> ImuManager::enumerateSensors() {
     }
 
     LOGI("Enumerated %zu IMU sensors", sensors.size());
+    sensorCache_ = sensors;
+    sensorCacheValid_ = true;
     return sensors;
 }
 
+void ImuManager::seedSensorCache(std::vector<SensorInfo> sensors) {
+    std::lock_guard<std::mutex> lock(enumMutex_);
+    sensorCache_ = std::move(sensors);
+    sensorCacheValid_ = true;
+}
+
 }  // namespace nativesensor
 
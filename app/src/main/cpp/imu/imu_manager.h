@@ -11,6 +11,7 @@
 #include <string>
 
 #include "imu_data.h"
+#include "mailbox_registry.h"
 #include "ring_buffer.h"
 #include "sensor_types.h"
 
@@ -21,9 +22,11 @@ using ImuCallback = std::function<void(const ImuSample&)>;
 
 /// High-frequency, low-latency IMU sensor manager.
 /// Uses ASensorManager with callback-based event queue.
+/// Latest samples and rolling stats go to the streams::kAccel, kGyro and
+/// kImuStats mailboxes of the registry passed in.
 class ImuManager {
 public:
-    ImuManager();
+    explicit ImuManager(MailboxRegistry& mailboxes);
     ~ImuManager();
 
     ImuManager(const ImuManager&) = delete;
@@ -38,15 +41,19 @@ public:
     /// Switch to specific sensors by handle
     void switchSensors(int32_t accelHandle, int32_t gyroHandle);
 
+    /// Check if the sensor manager was obtained successfully
+    [[nodiscard]]
+    bool isValid() const noexcept { return sensorManager_ != nullptr; }
+
     /// Check if sensors are running
     [[nodiscard]]
     bool isRunning() const noexcept { return running_.load(std::memory_order_acquire); }
 
-    /// Get the latest accelerometer sample (thread-safe)
+    /// Get the latest accelerometer sample (thread-safe, lock-free)
     [[nodiscard]]
     ImuSample getLatestAccel() const;
 
-    /// Get the latest gyroscope sample (thread-safe)
+    /// Get the latest gyroscope sample (thread-safe, lock-free)
     [[nodiscard]]
     ImuSample getLatestGyro() const;
 
@@ -57,8 +64,20 @@ public:
     [[nodiscard]]
     ImuSensorMetadata getMetadata() const;
 
-    /// Enumerate all available IMU sensors
-    std::vector<SensorInfo> enumerateSensors();
+    /// Enumerate all available IMU sensors.
+    /// The sensor list is static for the process lifetime, so the first
+    /// enumeration is cached and later calls return the cached copy.
+    /// @param forceRefresh Re-query ASensorManager instead of using the cache
+    std::vector<SensorInfo> enumerateSensors(bool forceRefresh = false);
+
+    /// Pre-populate the enumeration cache (e.g. from the persistent capability cache)
+    void seedSensorCache(std::vector<SensorInfo> sensors);
+
+    /// Boot time of the first sample delivered since start() (0 = none yet)
+    [[nodiscard]]
+    int64_t getFirstSampleTimeNs() const noexcept {
+        return firstSampleNs_.load(std::memory_order_acquire);
+    }
 
 private:
     void sensorThreadLoop();
@@ -74,27 +93,44 @@ private:
     std::atomic<bool> needsSensorSwitch_{false};
 
     ASensorManager* sensorManager_ = nullptr;
-    ALooper* looper_ = nullptr;
+    // Set by the sensor thread; stop() and getMetadata() read them from others
+    std::atomic<ALooper*> looper_{nullptr};
     ASensorEventQueue* eventQueue_ = nullptr;
-    const ASensor* currentAccel_ = nullptr;
-    const ASensor* currentGyro_ = nullptr;
-
-    mutable std::mutex dataMutex_;
-    ImuSample latestAccel_{};
-    ImuSample latestGyro_{};
+    std::atomic<const ASensor*> currentAccel_{nullptr};
+    std::atomic<const ASensor*> currentGyro_{nullptr};
+
+    struct StatsWindow {
+        int64_t startNs = 0;
+        int32_t accelCount = 0;
+        int32_t gyroCount = 0;
+        int64_t accelLatencyTotal = 0;
+        int64_t gyroLatencyTotal = 0;
+
+        void add(bool accel, int64_t latencyNs) noexcept;
+        [[nodiscard]] ImuStats summarize(int64_t nowNs) const noexcept;
+    };
+
+    // Latest samples and stats; readers (JNI, frame task) never block the sensor thread
+    TripleBuffer<ImuSample>* latestAccel_ = nullptr;
+    TripleBuffer<ImuSample>* latestGyro_ = nullptr;
+    TripleBuffer<ImuStats>* latestStats_ = nullptr;
+    StatsWindow publishedWindow_;               // Rolling second behind latestStats_, sensor thread only
 
     mutable std::mutex statsMutex_;
-    int64_t statsWindowStart_ = 0;
-    int32_t accelCount_ = 0;
-    int32_t gyroCount_ = 0;
-    int64_t accelLatencyTotal_ = 0;
-    int64_t gyroLatencyTotal_ = 0;
+    StatsWindow statsWindow_;                   // Since the last getStats()
+
+    std::atomic<int64_t> startTimeNs_{0};
+    std::atomic<int64_t> firstSampleNs_{0};
 
     std::atomic<int32_t> accelMinDelay_{0};
     std::atomic<int32_t> accelFifo_{0};
     std::atomic<int32_t> gyroMinDelay_{0};
     std::atomic<int32_t> gyroFifo_{0};
 
+    mutable std::mutex enumMutex_;
+    std::vector<SensorInfo> sensorCache_;
+    bool sensorCacheValid_ = false;
+
     static constexpr const char* kPackageName = "com.tw0b33rs.nativesensoraccess";
 };
 
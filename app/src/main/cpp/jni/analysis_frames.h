@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+
+#include "bounded_queue.h"
+
+/// Budget of the per-camera analysis frame pools behind the JNI pipeline.
+/// A pool holds what every holder can keep of one camera at once, so a slow
+/// branch drops its own frames instead of starving the others.
+namespace nativesensor::analysis {
+
+// Edges fed by the analysis source and the blur gate
+constexpr size_t kBlurGateEdgeCapacity = 4;
+constexpr size_t kFrameQualityEdgeCapacity = 2;
+constexpr size_t kSnapshotEdgeCapacity = 2;
+constexpr size_t kPreTriggerEdgeCapacity = 2;
+constexpr size_t kExportFramesEdgeCapacity = 2;
+constexpr size_t kRectifyEdgeCapacity = 2;
+constexpr size_t kStereoEdgeCapacity = 4;
+
+constexpr size_t kMaxPendingSnapshots = 2;
+constexpr size_t kExportFrameQueueCapacity = 4;
+
+/// Frames the edges hold when full, as their queues round capacities up
+constexpr size_t kEdgeFrames =
+    boundedQueueCapacity(kBlurGateEdgeCapacity) + boundedQueueCapacity(kFrameQualityEdgeCapacity) +
+    boundedQueueCapacity(kSnapshotEdgeCapacity) + boundedQueueCapacity(kPreTriggerEdgeCapacity) +
+    boundedQueueCapacity(kExportFramesEdgeCapacity) + boundedQueueCapacity(kRectifyEdgeCapacity) +
+    boundedQueueCapacity(kStereoEdgeCapacity);
+
+/// A DropOldest push holds the frame it evicted until it got its own in:
+/// one each for the two pushing nodes (the source and the blur gate)
+constexpr size_t kEvictedFrames = 2;
+
+/// Holders besides the edges: a frame in each of the 7 nodes reading them
+/// (blurGate, frameQuality, snapshots, preTrigger, exportFrames, undistort,
+/// stereo), the snapshot jobs, the export queue plus the frame being
+/// written, stereo's unmatched frame and the frame the camera is filling
+constexpr size_t kOtherFrames =
+    7 + kMaxPendingSnapshots + boundedQueueCapacity(kExportFrameQueueCapacity) + 1 + 1 + 1;
+
+constexpr size_t kPoolCapacity = kEdgeFrames + kEvictedFrames + kOtherFrames;
+
+}  // namespace nativesensor::analysis
@@ -5,23 +5,141 @@
 #include <vector>
 #include <unordered_map>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
 #include <android/log.h>
 #include <android/native_window_jni.h>
 
 #include "imu_manager.h"
 #include "camera_manager.h"
 #include "camera_stream.h"
+#include "calibration_store.h"
+#include "frame_pool.h"
+#include "undistorter.h"
+#include "stereo_depth.h"
+#include "motion_blur.h"
+#include "rolling_shutter.h"
+#include "frame_quality.h"
+#include "snapshot_writer.h"
+#include "pre_trigger_buffer.h"
+#include "session_metrics.h"
+#include "session_exporter.h"
+#include "stream_server.h"
+#include "shared_ring.h"
+#include "stream_protocol.h"
+#include "gyro_history.h"
+#include "imu_anomaly_detector.h"
 #include "jni_helpers.h"
+#include "analysis_frames.h"
+#include "startup_orchestrator.h"
+#include "capability_cache.h"
+#include "thread_pool.h"
+#include "task.h"
+#include "async_channel.h"
+#include "pipeline.h"
+#include "deadline_scheduler.h"
+#include "vsync_source.h"
+#include "pose_predictor.h"
+#include "eskf.h"
+#include "mailbox_registry.h"
+#include "time_utils.h"
 
 namespace {
 
 constexpr const char* kLogTag = "NativeSensor.JNI";
 
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, kLogTag, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, kLogTag, __VA_ARGS__)
 
 constexpr double kNsToMs = 1'000'000.0;
 
+/// [qw, qx, qy, qz, wx, wy, wz, horizonMs, valid]
+void flattenPose(const nativesensor::PredictedPose& pose, std::vector<float>& out) {
+    out = {
+        pose.orientation.w,
+        pose.orientation.x,
+        pose.orientation.y,
+        pose.orientation.z,
+        pose.angularVelocity[0],
+        pose.angularVelocity[1],
+        pose.angularVelocity[2],
+        static_cast<float>(static_cast<double>(pose.targetNs - pose.sourceNs) / kNsToMs),
+        pose.valid ? 1.0f : 0.0f
+    };
+}
+
+/// [px, py, pz, vx, vy, vz, qw, qx, qy, qz, positionStdM, orientationStdRad, valid]
+void flattenFusedState(const nativesensor::FusedState& state, std::vector<float>& out) {
+    out = {
+        state.position[0], state.position[1], state.position[2],
+        state.velocity[0], state.velocity[1], state.velocity[2],
+        state.orientation.w, state.orientation.x, state.orientation.y, state.orientation.z,
+        state.positionStdM,
+        state.orientationStdRad,
+        state.valid ? 1.0f : 0.0f
+    };
+}
+
+/// IMU coverage of a capture result, measured by the frameImuSync coroutine
+struct FrameImuSync {
+    int64_t frameNumber = 0;
+    nativesensor::TimestampNs timestampNs = 0;      // Start of exposure
+    nativesensor::TimestampNs exposureEndNs = 0;    // Last row, including rolling-shutter skew
+    int32_t samples = 0;                            // IMU samples up to exposureEndNs since the previous frame
+    float waitMs = 0.0f;                            // Time the IMU trailed the capture result
+};
+
+/// [frameNumber, timestampMs, exposureEndMs, samples, waitMs]
+void flattenFrameImuSync(const FrameImuSync& sync, std::vector<float>& out) {
+    out = {
+        static_cast<float>(sync.frameNumber),
+        static_cast<float>(static_cast<double>(sync.timestampNs) / kNsToMs),
+        static_cast<float>(static_cast<double>(sync.exposureEndNs) / kNsToMs),
+        static_cast<float>(sync.samples),
+        sync.waitMs
+    };
+}
+
+/// [frameNumber, timestampMs, exposureMs, resultLatencyMs, width, height, format]
+void flattenFrameInfo(const nativesensor::FrameInfo& frame, std::vector<float>& out) {
+    out = {
+        static_cast<float>(frame.frameNumber),
+        static_cast<float>(static_cast<double>(frame.timestampNs) / kNsToMs),
+        static_cast<float>(static_cast<double>(frame.exposureTimeNs) / kNsToMs),
+        frame.resultNs > 0 ? static_cast<float>(static_cast<double>(frame.resultNs - frame.timestampNs) / kNsToMs)
+                           : 0.0f,
+        static_cast<float>(frame.width),
+        static_cast<float>(frame.height),
+        static_cast<float>(frame.format)
+    };
+}
+
+/// Copy a Java string; false for a null string or when the VM is out of
+/// memory (an OutOfMemoryError is then pending)
+bool readString(JNIEnv* env, jstring value, std::string& out) {
+    const char* chars = value ? env->GetStringUTFChars(value, nullptr) : nullptr;
+    if (!chars) {
+        return false;
+    }
+    out = chars;
+    env->ReleaseStringUTFChars(value, chars);
+    return true;
+}
+
+jfloatArray toFloatArray(JNIEnv* env, const std::vector<float>& values) {
+    const auto size = static_cast<jsize>(values.size());
+    jfloatArray result = env->NewFloatArray(size);
+    env->SetFloatArrayRegion(result, 0, size, values.data());
+    return result;
+}
+
+// Latest value of every sensor stream (IMU samples and stats, poses, capture
+// results) by stream id; declared first so it outlives every producer
+nativesensor::MailboxRegistry g_mailboxes;
+
 // IMU manager singleton
 std::unique_ptr<nativesensor::ImuManager> g_imuManager;
 std::mutex g_imuMutex;
@@ -31,15 +149,504 @@ std::unique_ptr<nativesensor::CameraManager> g_cameraManager;
 std::unordered_map<std::string, std::unique_ptr<nativesensor::CameraStream>> g_cameraStreams;
 std::mutex g_cameraMutex;
 
+// Subsystems initialized in parallel off the main thread
+constexpr const char* kImuSubsystem = "imu";
+constexpr const char* kSensorEnumSubsystem = "sensorEnum";
+constexpr const char* kCameraSubsystem = "camera";
+constexpr const char* kCameraEnumSubsystem = "cameraEnum";
+constexpr const char* kCapabilityCacheSubsystem = "capabilityCache";
+constexpr const char* kCapabilityRefreshSubsystem = "capabilityRefresh";
+constexpr const char* kWorkersSubsystem = "workers";
+
+constexpr const char* kCapabilityCacheFile = "capabilities.bin";
+
+nativesensor::StartupOrchestrator g_startup;
+std::once_flag g_startupOnce;
+std::atomic<bool> g_imuStartRequested{false};
+
+// Persistent device-capability cache; lives for the process because cached
+// sensor names point into its mapping
+std::unique_ptr<nativesensor::CapabilityCache> g_capabilityCache;
+
+// Lens calibration and undistortion maps, filled from camera enumeration.
+// Maps persist next to the capability cache when a cache directory is known.
+std::unique_ptr<nativesensor::CalibrationStore> g_calibrationStore;
+
+// Shared worker pool for per-frame processing, created during startup
+std::unique_ptr<nativesensor::ThreadPool> g_threadPool;
+
+// Sensor processing graph on the worker pool. Sources are published only after
+// the graph is fully connected, so producers never see a half-built pipeline.
+std::unique_ptr<nativesensor::Pipeline> g_pipeline;
+std::atomic<nativesensor::SourceNode<nativesensor::ImuSample>*> g_imuSource{nullptr};
+std::atomic<nativesensor::SourceNode<nativesensor::FrameMetadata>*> g_frameSource{nullptr};
+std::atomic<nativesensor::SourceNode<nativesensor::FrameRef>*> g_analysisSource{nullptr};
+
+namespace analysis = nativesensor::analysis;
+
+// CPU copies of tracking-camera frames: per-camera pools (kept for the process
+// so in-flight frames outlive their stream, sized in analysis_frames.h), the
+// rectification and rolling-shutter stages and the newest corrected frame per
+// camera
+constexpr size_t kRectifiedPoolCapacity = 8;
+constexpr int32_t kMaxAnalysisPixels = 1280 * 1024;
+std::unordered_map<std::string, std::shared_ptr<nativesensor::FramePool>> g_analysisPools;
+std::unique_ptr<nativesensor::Undistorter> g_undistorter;
+std::unique_ptr<nativesensor::RollingShutterCorrector> g_rollingShutter;
+std::unordered_map<std::string, std::shared_ptr<const nativesensor::ShutterCorrectedFrame>> g_rectifiedFrames;
+std::mutex g_rectifiedMutex;
+
+// Exposure, sharpness and noise of each camera's newest analysis frame,
+// published with its stream stats
+std::unique_ptr<nativesensor::FrameQualityMonitor> g_frameQuality;
+
+// On-demand stills: camera-encoded JPEGs where enabled (cameras get the JPEG
+// output on their next preview start), PNGs of analysis frames otherwise
+std::unique_ptr<nativesensor::SnapshotWriter> g_snapshotWriter;
+std::atomic<bool> g_hardwareSnapshots{false};
+
+// Last 10 s of IMU samples and downscaled analysis frames, written on trigger
+std::unique_ptr<nativesensor::PreTriggerBuffer> g_preTrigger;
+
+// Per-frame and per-sample metrics of the running session, on disk for
+// offline analysis; swapped by start/stop while the sinks run
+std::shared_ptr<nativesensor::SessionMetrics> g_sessionMetrics;
+std::mutex g_metricsMutex;
+
+// MCAP export of the running session, fed by pipeline sinks; the stats of
+// the last finished export stay readable after stop
+std::shared_ptr<nativesensor::SessionExporter> g_sessionExporter;
+nativesensor::SessionExportStats g_lastExportStats;
+std::mutex g_exportMutex;
+
+// Live IMU samples and capture results for local clients over a Unix socket;
+// idle (one atomic load per sample) until a client subscribes
+nativesensor::StreamServer g_streamServer;
+
+// Broadcast ring of IMU samples that other processes map read-only, fed on
+// the sensor thread; created on first request and kept for the process lifetime
+std::unique_ptr<nativesensor::SharedRingWriter> g_imuRingOwner;
+std::atomic<nativesensor::SharedRingWriter*> g_imuRing{nullptr};
+std::mutex g_imuRingMutex;
+constexpr uint32_t kImuRingSlots = 4096;        // ~2.5 s of both IMU streams at 800 Hz
+
+// Stereo disparity of the selected tracking-camera pair and its newest result
+std::unique_ptr<nativesensor::StereoDepth> g_stereoDepth;
+std::shared_ptr<const nativesensor::StereoFrame> g_stereoFrame;
+std::mutex g_stereoMutex;
+
+// Frame-synchronous consumer: runs just before each display deadline on the
+// freshest IMU state, paced by Choreographer vsync
+nativesensor::BootFrameClock g_frameClock;
+std::unique_ptr<nativesensor::DeadlineScheduler> g_frameScheduler;
+std::unique_ptr<nativesensor::VsyncSource> g_vsyncSource;
+std::mutex g_frameMutex;
+
+// Gyro-driven orientation predictor, fed from the IMU thread and queried lock-free
+nativesensor::PosePredictor g_posePredictor;
+
+// Recent gyro samples, for the rotation during each camera exposure
+nativesensor::GyroHistory g_gyroHistory;
+
+// Shocks, free fall, clipping, stuck values and dropouts on the IMU streams;
+// events queue up until Kotlin polls them
+nativesensor::ImuAnomalyDetector g_anomalyDetector;
+
+// Drops motion-blurred analysis frames before rectification and stereo; the
+// stages behind it are what a skipped frame saves
+std::unique_ptr<nativesensor::MotionBlurGate> g_blurGate;
+constexpr const char* kBlurGatedStages[] = {"undistort", "rollingShutter", "stereo"};
+
+// Inbound edges of the optional analysis branches. They start disabled, so a
+// branch costs nothing per frame until something consumes its output: the
+// JNI switches below, a selected stereo pair or a running export. Set before
+// the sources are published and never changed afterwards.
+nativesensor::EdgeBase* g_blurGateEdge = nullptr;
+nativesensor::EdgeBase* g_rectifyEdge = nullptr;
+nativesensor::EdgeBase* g_stereoEdge = nullptr;
+nativesensor::EdgeBase* g_frameQualityEdge = nullptr;
+nativesensor::EdgeBase* g_preTriggerEdge = nullptr;
+nativesensor::EdgeBase* g_exportImuEdge = nullptr;
+nativesensor::EdgeBase* g_exportFramesEdge = nullptr;
+std::mutex g_branchMutex;
+
+// Pose predicted for the upcoming frame's presentation time by the frame task
+nativesensor::TripleBuffer<nativesensor::PredictedPose>* const g_framePose =
+    g_mailboxes.mailbox<nativesensor::PredictedPose>(nativesensor::streams::kFramePose, "pose.frame", flattenPose);
+
+// Visual-inertial fusion, driven by the "eskf" pipeline stage, which also
+// publishes each new state
+nativesensor::Eskf g_eskf;
+nativesensor::TripleBuffer<nativesensor::FusedState>* const g_fusedState =
+    g_mailboxes.mailbox<nativesensor::FusedState>(nativesensor::streams::kFusedState, "pose.fused",
+                                                 flattenFusedState);
+
+// Newest capture result of any camera, published by the "frameMailbox" sink
+nativesensor::TripleBuffer<nativesensor::FrameInfo>* const g_latestFrame =
+    g_mailboxes.mailbox<nativesensor::FrameInfo>(nativesensor::streams::kCameraFrame, "camera.frame",
+                                                flattenFrameInfo);
+
+// Awaitable IMU samples and capture results for coroutine consumers on the
+// worker pool, fed on the sensor and camera threads once the pipeline exists
+std::unique_ptr<nativesensor::AsyncChannel<nativesensor::ImuSample>> g_imuChannel;
+std::unique_ptr<nativesensor::AsyncChannel<nativesensor::FrameMetadata>> g_frameChannel;
+constexpr size_t kImuChannelCapacity = 4096;
+constexpr size_t kFrameChannelCapacity = 8;
+nativesensor::TripleBuffer<FrameImuSync>* const g_frameImuSync =
+    g_mailboxes.mailbox<FrameImuSync>(nativesensor::streams::kFrameImuSync, "camera.imuSync",
+                                      flattenFrameImuSync);
+constexpr size_t kEskfEdgeCapacity = 4096;
+constexpr size_t kMetricsEdgeCapacity = 4096;
+constexpr size_t kExportEdgeCapacity = 4096;
+
+std::shared_ptr<nativesensor::SessionMetrics> sessionMetrics() {
+    std::lock_guard<std::mutex> lock(g_metricsMutex);
+    return g_sessionMetrics;
+}
+
+std::shared_ptr<nativesensor::SessionExporter> sessionExporter() {
+    std::lock_guard<std::mutex> lock(g_exportMutex);
+    return g_sessionExporter;
+}
+
+/// For each capture result, wait until the IMU covers its exposure and
+/// publish how long that took; the channels' only consumer
+nativesensor::Task<void> trackFrameImuSync() {
+    while (auto frame = co_await g_frameChannel->next()) {
+        FrameImuSync sync;
+        sync.frameNumber = frame->frameNumber;
+        sync.timestampNs = frame->timestampNs;
+        sync.exposureEndNs = frame->timestampNs + frame->exposureTimeNs + frame->rollingShutterSkewNs;
+        const auto samples = co_await g_imuChannel->until(sync.exposureEndNs);
+        sync.samples = static_cast<int32_t>(samples.size());
+        if (frame->resultNs > 0) {
+            const auto waitNs = std::max<int64_t>(nativesensor::getBootTimeNs() - frame->resultNs, 0);
+            sync.waitMs = static_cast<float>(static_cast<double>(waitNs) / kNsToMs);
+        }
+        g_frameImuSync->store(sync);
+    }
+}
+
+/// Build the processing graph; called once the worker pool exists
+void buildPipeline() {
+    g_pipeline = std::make_unique<nativesensor::Pipeline>(*g_threadPool);
+    auto* imuSource = g_pipeline->addSource<nativesensor::ImuSample>("imu");
+    auto* frameSource = g_pipeline->addSource<nativesensor::FrameMetadata>("cameraFrames");
+
+    auto* eskf = g_pipeline->addSink<nativesensor::ImuSample>(
+        "eskf",
+        [](const nativesensor::ImuSample& sample) {
+            g_eskf.addImuSample(sample);
+            g_fusedState->store(g_eskf.getState());
+        },
+        nativesensor::TaskPriority::Tracking);
+    g_pipeline->connect<nativesensor::ImuSample>(imuSource, eskf, kEskfEdgeCapacity);
+
+    // Sinks never run concurrently, so this is the frame mailbox's only writer
+    auto* frameMailbox = g_pipeline->addSink<nativesensor::FrameMetadata>(
+        "frameMailbox",
+        [](const nativesensor::FrameMetadata& frame) { g_latestFrame->store(nativesensor::toFrameInfo(frame)); },
+        nativesensor::TaskPriority::Tracking);
+    g_pipeline->connect<nativesensor::FrameMetadata>(frameSource, frameMailbox, 2);
+
+    // Session metrics: every capture result and IMU sample, at logging priority
+    auto* imuMetrics = g_pipeline->addSink<nativesensor::ImuSample>(
+        "imuMetrics",
+        [](const nativesensor::ImuSample& sample) {
+            if (auto metrics = sessionMetrics()) {
+                metrics->addImuSample(sample);
+            }
+        },
+        nativesensor::TaskPriority::Logging);
+    g_pipeline->connect<nativesensor::ImuSample>(imuSource, imuMetrics, kMetricsEdgeCapacity);
+    auto* frameMetrics = g_pipeline->addSink<nativesensor::FrameMetadata>(
+        "frameMetrics",
+        [](const nativesensor::FrameMetadata& frame) {
+            if (auto metrics = sessionMetrics()) {
+                metrics->addFrame(frame);
+            }
+        },
+        nativesensor::TaskPriority::Logging);
+    g_pipeline->connect<nativesensor::FrameMetadata>(frameSource, frameMetrics, kMetricsEdgeCapacity);
+
+    // Session export: the sinks only queue; the exporter thread writes
+    auto* exportImu = g_pipeline->addSink<nativesensor::ImuSample>(
+        "exportImu",
+        [](const nativesensor::ImuSample& sample) {
+            if (auto exporter = sessionExporter()) {
+                exporter->addImuSample(sample);
+            }
+        },
+        nativesensor::TaskPriority::Logging);
+    g_exportImuEdge = g_pipeline->connect<nativesensor::ImuSample>(imuSource, exportImu, kExportEdgeCapacity);
+
+    // Socket streaming to local clients
+    auto* streamImu = g_pipeline->addSink<nativesensor::ImuSample>(
+        "streamImu",
+        [](const nativesensor::ImuSample& sample) { g_streamServer.publish(sample); },
+        nativesensor::TaskPriority::Logging);
+    g_pipeline->connect<nativesensor::ImuSample>(imuSource, streamImu, kExportEdgeCapacity);
+    auto* streamFrames = g_pipeline->addSink<nativesensor::FrameMetadata>(
+        "streamFrames",
+        [](const nativesensor::FrameMetadata& frame) { g_streamServer.publish(frame); },
+        nativesensor::TaskPriority::Logging);
+    g_pipeline->connect<nativesensor::FrameMetadata>(frameSource, streamFrames, kMetricsEdgeCapacity);
+
+    // Analysis frames pass the motion blur gate first
+    g_blurGate = std::make_unique<nativesensor::MotionBlurGate>(g_gyroHistory, *g_calibrationStore);
+    auto* analysisSource = g_pipeline->addSource<nativesensor::FrameRef>("analysisFrames");
+    auto* blurGate = g_pipeline->addStage<nativesensor::FrameRef, nativesensor::FrameRef>(
+        "blurGate",
+        [](const nativesensor::FrameRef& in, nativesensor::FrameRef& out) {
+            return g_blurGate->process(in, out);
+        });
+    g_blurGateEdge = g_pipeline->connect<nativesensor::FrameRef>(
+        analysisSource, blurGate, analysis::kBlurGateEdgeCapacity);
+
+    // Health metrics on every frame, blurred or not; newest frame only
+    g_frameQuality = std::make_unique<nativesensor::FrameQualityMonitor>();
+    auto* frameQuality = g_pipeline->addSink<nativesensor::FrameRef>(
+        "frameQuality",
+        [](const nativesensor::FrameRef& frame) { g_frameQuality->process(frame); });
+    g_frameQualityEdge = g_pipeline->connect<nativesensor::FrameRef>(
+        analysisSource, frameQuality, analysis::kFrameQualityEdgeCapacity);
+
+    // Software snapshots take the next analysis frame; encoding runs on the
+    // writer's own thread
+    g_snapshotWriter = std::make_unique<nativesensor::SnapshotWriter>(analysis::kMaxPendingSnapshots);
+    auto* snapshots = g_pipeline->addSink<nativesensor::FrameRef>(
+        "snapshots",
+        [](const nativesensor::FrameRef& frame) { g_snapshotWriter->process(frame); });
+    g_pipeline->connect<nativesensor::FrameRef>(analysisSource, snapshots, analysis::kSnapshotEdgeCapacity);
+
+    // Pre-trigger history keeps a few frames per second; IMU samples are
+    // added on the sensor thread once the sources are published
+    g_preTrigger = std::make_unique<nativesensor::PreTriggerBuffer>();
+    auto* preTrigger = g_pipeline->addSink<nativesensor::FrameRef>(
+        "preTrigger",
+        [](const nativesensor::FrameRef& frame) { g_preTrigger->addFrame(frame); });
+    g_preTriggerEdge = g_pipeline->connect<nativesensor::FrameRef>(
+        analysisSource, preTrigger, analysis::kPreTriggerEdgeCapacity);
+
+    // Session export takes every analysis frame it has room for
+    auto* exportFrames = g_pipeline->addSink<nativesensor::FrameRef>(
+        "exportFrames",
+        [](const nativesensor::FrameRef& frame) {
+            if (auto exporter = sessionExporter()) {
+                exporter->addFrame(frame);
+            }
+        },
+        nativesensor::TaskPriority::Logging);
+    g_exportFramesEdge = g_pipeline->connect<nativesensor::FrameRef>(
+        analysisSource, exportFrames, analysis::kExportFramesEdgeCapacity);
+
+    // Rectification then rolling-shutter correction: freshest frame wins,
+    // stale frames are dropped at the edges
+    g_undistorter = std::make_unique<nativesensor::Undistorter>(*g_calibrationStore, kRectifiedPoolCapacity);
+    auto* undistort = g_pipeline->addStage<nativesensor::FrameRef, nativesensor::FrameRef>(
+        "undistort",
+        [](const nativesensor::FrameRef& in, nativesensor::FrameRef& out) {
+            return g_undistorter->process(in, out);
+        });
+    g_rollingShutter = std::make_unique<nativesensor::RollingShutterCorrector>(
+        g_gyroHistory, *g_calibrationStore, *g_threadPool);
+    auto* rollingShutter = g_pipeline->addStage<nativesensor::FrameRef,
+                                                std::shared_ptr<const nativesensor::ShutterCorrectedFrame>>(
+        "rollingShutter",
+        [](const nativesensor::FrameRef& in,
+           std::shared_ptr<const nativesensor::ShutterCorrectedFrame>& out) {
+            return g_rollingShutter->process(in, out);
+        });
+    auto* rectified = g_pipeline->addSink<std::shared_ptr<const nativesensor::ShutterCorrectedFrame>>(
+        "rectifiedFrames",
+        [](const std::shared_ptr<const nativesensor::ShutterCorrectedFrame>& frame) {
+            std::lock_guard<std::mutex> lock(g_rectifiedMutex);
+            g_rectifiedFrames[frame->frame->metadata.cameraId] = frame;
+        });
+    g_rectifyEdge = g_pipeline->connect<nativesensor::FrameRef>(blurGate, undistort, analysis::kRectifyEdgeCapacity);
+    g_pipeline->connect<nativesensor::FrameRef>(undistort, rollingShutter, 2);
+    g_pipeline->connect<std::shared_ptr<const nativesensor::ShutterCorrectedFrame>>(rollingShutter, rectified, 1);
+
+    // Stereo depth on the raw frames (it rectifies pairs itself); room for one
+    // frame of each camera plus a spare
+    g_stereoDepth = std::make_unique<nativesensor::StereoDepth>(*g_calibrationStore, *g_threadPool);
+    auto* stereo = g_pipeline->addStage<nativesensor::FrameRef,
+                                        std::shared_ptr<const nativesensor::StereoFrame>>(
+        "stereo",
+        [](const nativesensor::FrameRef& in, std::shared_ptr<const nativesensor::StereoFrame>& out) {
+            return g_stereoDepth->process(in, out);
+        });
+    auto* stereoSink = g_pipeline->addSink<std::shared_ptr<const nativesensor::StereoFrame>>(
+        "stereoDepth",
+        [](const std::shared_ptr<const nativesensor::StereoFrame>& frame) {
+            std::lock_guard<std::mutex> lock(g_stereoMutex);
+            g_stereoFrame = frame;
+        });
+    g_stereoEdge = g_pipeline->connect<nativesensor::FrameRef>(blurGate, stereo, analysis::kStereoEdgeCapacity);
+    g_pipeline->connect<std::shared_ptr<const nativesensor::StereoFrame>>(stereo, stereoSink, 2);
+
+    g_imuChannel = std::make_unique<nativesensor::AsyncChannel<nativesensor::ImuSample>>(
+        *g_threadPool, kImuChannelCapacity);
+    g_frameChannel = std::make_unique<nativesensor::AsyncChannel<nativesensor::FrameMetadata>>(
+        *g_threadPool, kFrameChannelCapacity);
+    nativesensor::spawn(*g_threadPool, trackFrameImuSync());
+
+    for (auto* edge : {g_blurGateEdge, g_rectifyEdge, g_stereoEdge, g_frameQualityEdge, g_preTriggerEdge,
+                       g_exportImuEdge, g_exportFramesEdge}) {
+        edge->setEnabled(false);
+    }
+
+    g_imuSource.store(imuSource, std::memory_order_release);
+    g_frameSource.store(frameSource, std::memory_order_release);
+    g_analysisSource.store(analysisSource, std::memory_order_release);
+}
+
+/// Switch an analysis branch on or off; the blur gate runs while a branch
+/// behind it does. Workers must be ready.
+void setBranchEnabled(nativesensor::EdgeBase* edge, bool enabled) {
+    std::lock_guard<std::mutex> lock(g_branchMutex);
+    edge->setEnabled(enabled);
+    g_blurGateEdge->setEnabled(g_rectifyEdge->enabled() || g_stereoEdge->enabled());
+}
+
+/// Whether the capabilityCache subsystem found a valid cache (it must have finished)
+bool capabilityCacheHit() {
+    return g_capabilityCache && g_capabilityCache->isValid();
+}
+
+/// Launch parallel startup. The first caller wins: the app calls this with its
+/// cache directory as early as possible, any other JNI entry point launches
+/// without a persistent capability cache.
+void launchStartup(const std::string& cacheDir = {}) {
+    std::call_once(g_startupOnce, [&cacheDir] {
+        if (!cacheDir.empty()) {
+            g_capabilityCache = std::make_unique<nativesensor::CapabilityCache>(
+                cacheDir + "/" + kCapabilityCacheFile,
+                nativesensor::CapabilityCache::deviceFingerprint());
+        }
+        g_calibrationStore = std::make_unique<nativesensor::CalibrationStore>(
+            cacheDir, nativesensor::CapabilityCache::deviceFingerprint());
+
+        // Ready once the lookup finished, hit or miss: the enum subsystems
+        // depend on it and fall back to enumerating on a miss
+        g_startup.add(kCapabilityCacheSubsystem, [] {
+            if (g_capabilityCache) {
+                g_capabilityCache->load();
+            }
+            return true;
+        });
+        g_startup.add(kImuSubsystem, [] {
+            std::lock_guard<std::mutex> lock(g_imuMutex);
+            if (!g_imuManager) {
+                g_imuManager = std::make_unique<nativesensor::ImuManager>(g_mailboxes);
+            }
+            return g_imuManager->isValid();
+        });
+        // Enumeration counts as done even when it finds nothing, so the
+        // refresh still runs and rewrites a stale cache
+        g_startup.add(kSensorEnumSubsystem, [] {
+            if (capabilityCacheHit()) {
+                g_imuManager->seedSensorCache(g_capabilityCache->sensors());
+            } else if (g_imuManager->enumerateSensors().empty()) {
+                LOGW("No IMU sensors found");
+            }
+            return true;
+        }, {kImuSubsystem, kCapabilityCacheSubsystem});
+        g_startup.add(kCameraSubsystem, [] {
+            std::lock_guard<std::mutex> lock(g_cameraMutex);
+            if (!g_cameraManager) {
+                g_cameraManager = std::make_unique<nativesensor::CameraManager>();
+            }
+            return g_cameraManager->isValid();
+        });
+        g_startup.add(kCameraEnumSubsystem, [] {
+            if (capabilityCacheHit()) {
+                g_cameraManager->seedCache(g_capabilityCache->cameras());
+            }
+            const auto cameras = g_cameraManager->enumerateCameras();
+            if (cameras.empty()) {
+                LOGW("No cameras found");
+            }
+            g_calibrationStore->update(cameras);
+            return true;
+        }, {kCameraSubsystem, kCapabilityCacheSubsystem});
+
+        g_startup.add(kWorkersSubsystem, [] {
+            g_threadPool = std::make_unique<nativesensor::ThreadPool>();
+            buildPipeline();
+            return g_threadPool->workerCount() > 0;
+        });
+
+        // Background refresh: re-enumerate off the critical path and rewrite the
+        // cache only if the device reports something different
+        g_startup.add(kCapabilityRefreshSubsystem, [] {
+            if (!g_capabilityCache) {
+                return false;
+            }
+            auto sensors = g_imuManager->enumerateSensors(true);
+            auto cameras = g_cameraManager->enumerateCameras(true);
+            g_calibrationStore->update(cameras);
+            if (g_capabilityCache->matches(sensors, cameras)) {
+                return true;
+            }
+            return g_capabilityCache->store(sensors, cameras);
+        }, {kSensorEnumSubsystem, kCameraEnumSubsystem});
+
+        g_startup.launch();
+    });
+}
+
+/// Whether the worker pool and pipeline exist, without waiting for them
+bool workersReady() {
+    return g_startup.isLaunched() && g_startup.readiness(kWorkersSubsystem).wait_for(
+        std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+nativesensor::ThreadPool* getThreadPool() {
+    launchStartup();
+    g_startup.waitFor(kWorkersSubsystem);
+    return g_threadPool.get();
+}
+
+void startFrameScheduling() {
+    std::lock_guard<std::mutex> lock(g_frameMutex);
+    if (!g_frameScheduler) {
+        g_frameScheduler = std::make_unique<nativesensor::DeadlineScheduler>(g_frameClock);
+        g_vsyncSource = std::make_unique<nativesensor::VsyncSource>();
+    }
+    g_vsyncSource->start([](const nativesensor::FrameTimeline& timeline) {
+        g_frameScheduler->onVsync(timeline);
+    });
+    g_frameScheduler->start([](const nativesensor::FrameTimeline& frame) -> nativesensor::TimestampNs {
+        const auto pose = g_posePredictor.predictPose(frame.presentNs);
+        g_framePose->store(pose);
+        return pose.sourceNs;
+    });
+}
+
+void stopFrameScheduling() {
+    std::lock_guard<std::mutex> lock(g_frameMutex);
+    if (g_frameScheduler) {
+        g_frameScheduler->stop();
+        g_vsyncSource->stop();
+    }
+}
+
 nativesensor::ImuManager* getImuManager() {
+    launchStartup();
+    g_startup.waitFor(kImuSubsystem);
+
     std::lock_guard<std::mutex> lock(g_imuMutex);
     if (!g_imuManager) {
-        g_imuManager = std::make_unique<nativesensor::ImuManager>();
+        g_imuManager = std::make_unique<nativesensor::ImuManager>(g_mailboxes);
     }
     return g_imuManager.get();
 }
 
 nativesensor::CameraManager* getCameraManager() {
+    launchStartup();
+    g_startup.waitFor(kCameraSubsystem);
+
     std::lock_guard<std::mutex> lock(g_cameraMutex);
     if (!g_cameraManager) {
         g_cameraManager = std::make_unique<nativesensor::CameraManager>();
@@ -47,6 +654,51 @@ nativesensor::CameraManager* getCameraManager() {
     return g_cameraManager.get();
 }
 
+nativesensor::CalibrationStore* getCalibrationStore() {
+    launchStartup();
+    g_startup.waitFor(kCameraEnumSubsystem);
+    return g_calibrationStore.get();
+}
+
+/// CPU analysis pool for tracking cameras at their enumerated size; null for
+/// other cameras. Caller holds g_cameraMutex.
+std::shared_ptr<nativesensor::FramePool> analysisPoolFor(nativesensor::CameraManager& manager,
+                                                         const std::string& cameraId) {
+    if (auto it = g_analysisPools.find(cameraId); it != g_analysisPools.end()) {
+        return it->second;
+    }
+    for (const auto& camera : manager.enumerateCameras()) {
+        if (camera.id != cameraId) {
+            continue;
+        }
+        if (camera.clusterType != nativesensor::CameraClusterType::Avatar ||
+            camera.width * camera.height > kMaxAnalysisPixels) {
+            return nullptr;
+        }
+        auto pool = std::make_shared<nativesensor::FramePool>(
+            camera.width, camera.height, analysis::kPoolCapacity);
+        g_analysisPools[cameraId] = pool;
+        return pool;
+    }
+    return nullptr;
+}
+
+/// Give the stream a JPEG still output at the camera's enumerated size if
+/// hardware snapshots are enabled, none otherwise. Caller holds g_cameraMutex.
+void applyStillOutput(nativesensor::CameraManager& manager, nativesensor::CameraStream& stream,
+                      const std::string& cameraId) {
+    if (!g_hardwareSnapshots.load(std::memory_order_acquire)) {
+        stream.setStillOutput(0, 0);
+        return;
+    }
+    for (const auto& camera : manager.enumerateCameras()) {
+        if (camera.id == cameraId) {
+            stream.setStillOutput(camera.width, camera.height);
+            return;
+        }
+    }
+}
+
 nativesensor::CameraStream* getOrCreateCameraStream(const std::string& cameraId) {
     // Get manager first (uses the same mutex)
     auto* manager = getCameraManager();
@@ -55,6 +707,20 @@ nativesensor::CameraStream* getOrCreateCameraStream(const std::string& cameraId)
     auto it = g_cameraStreams.find(cameraId);
     if (it == g_cameraStreams.end()) {
         auto stream = std::make_unique<nativesensor::CameraStream>(*manager);
+        stream->setFrameCallback([](const nativesensor::FrameMetadata& frame) {
+            if (auto* source = g_frameSource.load(std::memory_order_acquire)) {
+                source->push(frame);
+                g_frameChannel->push(frame);
+            }
+        });
+        if (auto pool = analysisPoolFor(*manager, cameraId)) {
+            stream->setAnalysisOutput(std::move(pool), [](const nativesensor::FrameRef& frame) {
+                if (auto* source = g_analysisSource.load(std::memory_order_acquire)) {
+                    source->push(frame);
+                }
+            });
+        }
+        applyStillOutput(*manager, *stream, cameraId);
         auto* ptr = stream.get();
         g_cameraStreams[cameraId] = std::move(stream);
         return ptr;
@@ -69,18 +735,36 @@ void stopCameraStream(const std::string& cameraId) {
         it->second->stopPreview();
         g_cameraStreams.erase(it);
     }
+    // Its next analysis frame is never coming
+    if (workersReady() && g_snapshotWriter) {
+        g_snapshotWriter->cancel(cameraId);
+    }
 }
 
 void stopAllCameraStreams() {
     std::lock_guard<std::mutex> lock(g_cameraMutex);
+    const bool cancelSnapshots = workersReady() && g_snapshotWriter;
     for (auto& [id, stream] : g_cameraStreams) {
         stream->stopPreview();
+        if (cancelSnapshots) {
+            g_snapshotWriter->cancel(id);
+        }
     }
     g_cameraStreams.clear();
 }
 
-// No-op JNI_OnLoad, but required for JNI linkage
-JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
+/// Pose as float array, see flattenPose()
+jfloatArray poseToArray(JNIEnv* env, const nativesensor::PredictedPose& pose) {
+    std::vector<float> data;
+    flattenPose(pose, data);
+    return toFloatArray(env, data);
+}
+
+}  // namespace
+
+extern "C" {
+
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* /* reserved */) {
     JNIEnv* env;
     if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
         return JNI_ERR;
@@ -89,20 +773,135 @@ JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
     return JNI_VERSION_1_6;
 }
 
-}  // namespace
+/// Orderly teardown: producers first, then the graph they feed, then the pool
+/// running it, so no thread outlives what it touches. Startup never runs
+/// again, so the library is unusable afterwards.
+JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* /* vm */, void* /* reserved */) {
+    LOGI("Native sensor library unloading");
+    g_imuStartRequested.store(false, std::memory_order_release);
+    if (g_startup.isLaunched()) {
+        for (const char* subsystem : {kImuSubsystem, kSensorEnumSubsystem, kCameraSubsystem,
+                                      kCameraEnumSubsystem, kWorkersSubsystem, kCapabilityRefreshSubsystem}) {
+            (void)g_startup.waitFor(subsystem);
+        }
+    }
 
-extern "C" {
+    {
+        // Taken after the IMU start continuation, which also starts frame scheduling
+        std::lock_guard<std::mutex> lock(g_imuMutex);
+        if (g_imuManager) {
+            g_imuManager->stop();
+        }
+    }
+    stopFrameScheduling();
+    stopAllCameraStreams();
+    g_streamServer.stop();
+    if (auto exporter = sessionExporter()) {
+        exporter->finish();
+    }
+
+    if (g_pipeline) {
+        g_imuSource.store(nullptr, std::memory_order_release);
+        g_frameSource.store(nullptr, std::memory_order_release);
+        g_analysisSource.store(nullptr, std::memory_order_release);
+        g_pipeline->stop();
+        // Ends trackFrameImuSync(), which frees its coroutine frame on the pool
+        g_imuChannel->close();
+        g_frameChannel->close();
+        g_threadPool->waitIdle();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_frameMutex);
+        g_frameScheduler.reset();
+        g_vsyncSource.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_exportMutex);
+        g_sessionExporter.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_metricsMutex);
+        g_sessionMetrics.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_stereoMutex);
+        g_stereoFrame.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_rectifiedMutex);
+        g_rectifiedFrames.clear();
+    }
+    g_pipeline.reset();
+    g_stereoDepth.reset();
+    g_rollingShutter.reset();
+    g_undistorter.reset();
+    g_preTrigger.reset();
+    g_snapshotWriter.reset();
+    g_frameQuality.reset();
+    g_blurGate.reset();
+    g_imuChannel.reset();
+    g_frameChannel.reset();
+    g_threadPool.reset();
+    {
+        std::lock_guard<std::mutex> lock(g_cameraMutex);
+        g_analysisPools.clear();
+        g_cameraManager.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_imuMutex);
+        g_imuManager.reset();
+    }
+    LOGI("Native sensor library unloaded");
+}
 
 // Package: com.tw0b33rs.nativesensoraccess.sensor
 // Class: NativeSensorBridge
 
+JNIEXPORT void JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativePrepare(
+    JNIEnv* env,
+    jobject /* thiz */,
+    jstring cacheDir,
+    jboolean useCapabilityCache) {
+    std::string dir;
+    if (useCapabilityCache) {
+        readString(env, cacheDir, dir);     // Left empty for a null directory
+    }
+    LOGI("NativeSensorBridge.nativePrepare(%s)", dir.empty() ? "no capability cache" : dir.c_str());
+    launchStartup(dir);
+}
+
 JNIEXPORT void JNICALL
 Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeInit(
     JNIEnv* /* env */,
     jobject /* thiz */) {
     LOGI("NativeSensorBridge.nativeInit()");
-    auto* manager = getImuManager();
-    manager->start([](const nativesensor::ImuSample&) {});
+    launchStartup();
+
+    // Start on the IMU init thread once ASensorManager is ready, never blocking the caller
+    g_imuStartRequested.store(true, std::memory_order_release);
+    g_startup.onReady(kImuSubsystem, [] {
+        std::lock_guard<std::mutex> lock(g_imuMutex);
+        if (g_imuStartRequested.load(std::memory_order_acquire)) {
+            g_imuManager->start([](const nativesensor::ImuSample& sample) {
+                g_posePredictor.addSample(sample);
+                g_gyroHistory.addSample(sample);
+                g_anomalyDetector.process(sample);
+                if (auto* ring = g_imuRing.load(std::memory_order_acquire)) {
+                    const nativesensor::stream::ImuMessage message{
+                        sample.timestampNs, static_cast<int32_t>(sample.sensorType), sample.x, sample.y, sample.z};
+                    ring->publish(&message, sizeof(message));
+                }
+                if (auto* source = g_imuSource.load(std::memory_order_acquire)) {
+                    source->push(sample);
+                    g_preTrigger->addImuSample(sample);
+                    g_imuChannel->push(sample);
+                }
+            });
+            startFrameScheduling();
+        }
+    });
 }
 
 JNIEXPORT void JNICALL
@@ -110,9 +909,15 @@ Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeStop(
     JNIEnv* /* env */,
     jobject /* thiz */) {
     LOGI("NativeSensorBridge.nativeStop()");
+    g_imuStartRequested.store(false, std::memory_order_release);
+    // Under the lock of the IMU start continuation, which also starts frame
+    // scheduling: one that passed its check before the flag was cleared has
+    // finished, so nothing is started after the stop
+    std::lock_guard<std::mutex> lock(g_imuMutex);
     if (g_imuManager) {
         g_imuManager->stop();
     }
+    stopFrameScheduling();
 }
 
 JNIEXPORT jfloatArray JNICALL
@@ -209,16 +1014,528 @@ Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeSwitchSenso
     LOGI("Switching sensors - Accel: %d, Gyro: %d", accelHandle, gyroHandle);
     auto* manager = getImuManager();
     manager->switchSensors(accelHandle, gyroHandle);
+    g_anomalyDetector.reset();
 }
 
 JNIEXPORT jboolean JNICALL
 Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeIsRunning(
     JNIEnv* /* env */,
     jobject /* thiz */) {
+    std::lock_guard<std::mutex> lock(g_imuMutex);
     if (!g_imuManager) return JNI_FALSE;
     return g_imuManager->isRunning() ? JNI_TRUE : JNI_FALSE;
 }
 
+JNIEXPORT jstring JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetStartupTimings(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    // Format per line: name|startOffsetMs|durationMs|ready (-1 = not started/finished)
+    const int64_t launchNs = g_startup.getLaunchTimeNs();
+    std::ostringstream ss;
+    for (const auto& timing : g_startup.getTimings()) {
+        const double startMs = timing.startNs > 0
+            ? static_cast<double>(timing.startNs - launchNs) / kNsToMs : -1.0;
+        const double durationMs = timing.endNs > 0
+            ? static_cast<double>(timing.endNs - timing.startNs) / kNsToMs : -1.0;
+        ss << timing.name << "|"
+           << startMs << "|"
+           << durationMs << "|"
+           << (timing.ready ? 1 : 0) << "\n";
+    }
+
+    // Cold-start time to first sensor sample, measured from startup launch
+    std::lock_guard<std::mutex> lock(g_imuMutex);
+    const int64_t firstSampleNs = g_imuManager ? g_imuManager->getFirstSampleTimeNs() : 0;
+    ss << "firstSample|0|"
+       << (firstSampleNs > 0 ? static_cast<double>(firstSampleNs - launchNs) / kNsToMs : -1.0) << "|"
+       << (firstSampleNs > 0 ? 1 : 0) << "\n";
+    return env->NewStringUTF(ss.str().c_str());
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetPipelineStats(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    // Format per line: name|processed|avgItemUs|maxItemUs|dropped|queued
+    std::ostringstream ss;
+    if (workersReady() && g_pipeline) {
+        for (const auto& node : g_pipeline->getStats()) {
+            ss << node.name << "|"
+               << node.processed << "|"
+               << node.avgItemUs << "|"
+               << node.maxItemUs << "|"
+               << node.dropped << "|"
+               << node.queued << "\n";
+        }
+    }
+    return env->NewStringUTF(ss.str().c_str());
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetFrameDeadlineStats(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    nativesensor::DeadlineStats stats{};
+    {
+        std::lock_guard<std::mutex> lock(g_frameMutex);
+        if (g_frameScheduler) {
+            stats = g_frameScheduler->getStats();
+        }
+    }
+
+    jfloatArray result = env->NewFloatArray(9);
+    float data[9] = {
+        static_cast<float>(stats.frames),
+        static_cast<float>(stats.misses),
+        static_cast<float>(stats.skipped),
+        stats.avgWorkUs,
+        stats.workBudgetUs,
+        stats.avgSlackUs,
+        stats.avgWakeLateUs,
+        stats.avgInputAgeUs,
+        stats.vsyncPeriodMs
+    };
+    env->SetFloatArrayRegion(result, 0, 9, data);
+    return result;
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativePredictPose(
+    JNIEnv* env,
+    jobject /* thiz */,
+    jlong targetNs) {
+    // targetNs is CLOCK_BOOTTIME (SystemClock.elapsedRealtimeNanos); <= 0 means now
+    const nativesensor::TimestampNs target = targetNs > 0 ? targetNs : nativesensor::getBootTimeNs();
+    return poseToArray(env, g_posePredictor.predictPose(target));
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetFusedState(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    std::vector<float> data;
+    flattenFusedState(g_eskf.getState(), data);
+    return toFloatArray(env, data);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeSubmitPoseMeasurement(
+    JNIEnv* env,
+    jobject /* thiz */,
+    jlong timestampNs,
+    jfloatArray pose) {
+    // pose: [px, py, pz, qw, qx, qy, qz, positionStdM, orientationStdRad]
+    if (!pose || env->GetArrayLength(pose) < 9) {
+        return JNI_FALSE;
+    }
+    float data[9];
+    env->GetFloatArrayRegion(pose, 0, 9, data);
+
+    nativesensor::PoseMeasurement measurement;
+    measurement.timestampNs = timestampNs;
+    measurement.position[0] = data[0];
+    measurement.position[1] = data[1];
+    measurement.position[2] = data[2];
+    measurement.orientation = {data[3], data[4], data[5], data[6]};
+    measurement.positionStdM = data[7];
+    measurement.orientationStdRad = data[8];
+    return g_eskf.submitMeasurement(measurement) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetFramePose(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    nativesensor::PredictedPose pose;
+    g_framePose->load(pose);
+    return poseToArray(env, pose);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeTriggerCapture(
+    JNIEnv* env,
+    jobject /* thiz */,
+    jstring path) {
+    std::string file;
+    if (!readString(env, path, file) || !workersReady() || !g_preTrigger) {
+        return JNI_FALSE;
+    }
+    return g_preTrigger->trigger(std::move(file), nativesensor::getBootTimeNs()) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeSetPreTriggerFrames(
+    JNIEnv* /* env */,
+    jobject /* thiz */,
+    jboolean enabled) {
+    LOGI("NativeSensorBridge.nativeSetPreTriggerFrames(%d)", enabled);
+    if (getThreadPool()) {
+        setBranchEnabled(g_preTriggerEdge, enabled == JNI_TRUE);
+    }
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetPreTriggerStats(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    if (!workersReady() || !g_preTrigger) {
+        return env->NewFloatArray(0);
+    }
+    const auto stats = g_preTrigger->getStats();
+
+    // [triggers, rejected, written, failed, droppedFrames, lastImuSamples, lastFrames, lastBytes, lastDumpMs]
+    const float data[9] = {
+        static_cast<float>(stats.triggers),
+        static_cast<float>(stats.rejected),
+        static_cast<float>(stats.written),
+        static_cast<float>(stats.failed),
+        static_cast<float>(stats.droppedFrames),
+        static_cast<float>(stats.lastImuSamples),
+        static_cast<float>(stats.lastFrames),
+        static_cast<float>(stats.lastBytes),
+        stats.lastDumpMs
+    };
+    jfloatArray result = env->NewFloatArray(9);
+    env->SetFloatArrayRegion(result, 0, 9, data);
+    return result;
+}
+
+JNIEXPORT void JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeSetAnomalyThresholds(
+    JNIEnv* /* env */,
+    jobject /* thiz */,
+    jfloat shockMs2,
+    jfloat freeFallMs2,
+    jfloat accelRangeMs2,
+    jfloat gyroRangeRadS) {
+    LOGI("NativeSensorBridge.nativeSetAnomalyThresholds(shock %.1f, free fall %.1f, range %.1f / %.1f)",
+         shockMs2, freeFallMs2, accelRangeMs2, gyroRangeRadS);
+    g_anomalyDetector.updateConfig([&](nativesensor::ImuAnomalyConfig& config) {
+        config.shockThresholdMs2 = shockMs2;
+        config.freeFallThresholdMs2 = freeFallMs2;
+        config.accelRangeMs2 = accelRangeMs2;
+        config.gyroRangeRadS = gyroRangeRadS;
+    });
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativePollImuAnomalies(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    // One line per event: type|sensorType|timestampNs|durationNs|value
+    std::ostringstream ss;
+    nativesensor::ImuAnomaly event;
+    while (g_anomalyDetector.poll(event)) {
+        ss << static_cast<int>(event.type) << "|"
+           << static_cast<int>(event.sensor) << "|"
+           << event.timestampNs << "|"
+           << event.durationNs << "|"
+           << event.value << "\n";
+    }
+    return env->NewStringUTF(ss.str().c_str());
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetAnomalyCounts(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    using nativesensor::ImuAnomalyType;
+
+    // [shock, freeFall, saturation, stuckAt, dropout, droppedEvents]
+    const float data[6] = {
+        static_cast<float>(g_anomalyDetector.count(ImuAnomalyType::Shock)),
+        static_cast<float>(g_anomalyDetector.count(ImuAnomalyType::FreeFall)),
+        static_cast<float>(g_anomalyDetector.count(ImuAnomalyType::Saturation)),
+        static_cast<float>(g_anomalyDetector.count(ImuAnomalyType::StuckAt)),
+        static_cast<float>(g_anomalyDetector.count(ImuAnomalyType::Dropout)),
+        static_cast<float>(g_anomalyDetector.droppedEvents())
+    };
+    jfloatArray result = env->NewFloatArray(6);
+    env->SetFloatArrayRegion(result, 0, 6, data);
+    return result;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeStartMetrics(
+    JNIEnv* env,
+    jobject /* thiz */,
+    jstring directory) {
+    std::string dir;
+    if (!readString(env, directory, dir)) {
+        return JNI_FALSE;
+    }
+
+    LOGI("NativeSensorBridge.nativeStartMetrics(%s)", dir.c_str());
+    {
+        // Close the previous session first in case it used the same directory
+        std::lock_guard<std::mutex> lock(g_metricsMutex);
+        g_sessionMetrics.reset();
+    }
+    auto metrics = std::make_shared<nativesensor::SessionMetrics>(std::move(dir));
+    if (metrics->store().series().empty()) {
+        return JNI_FALSE;
+    }
+    std::lock_guard<std::mutex> lock(g_metricsMutex);
+    g_sessionMetrics = std::move(metrics);
+    return JNI_TRUE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeStopMetrics(
+    JNIEnv* /* env */,
+    jobject /* thiz */) {
+    LOGI("NativeSensorBridge.nativeStopMetrics()");
+    // Files are trimmed and closed once the last sink or query lets go
+    std::lock_guard<std::mutex> lock(g_metricsMutex);
+    g_sessionMetrics.reset();
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetMetricSeries(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    // One line per series: name|rows|rejected|column,column,... (the float
+    // columns, which nativeQueryMetrics aggregates)
+    std::ostringstream ss;
+    if (auto metrics = sessionMetrics()) {
+        for (const auto* series : metrics->store().series()) {
+            ss << series->name() << "|"
+               << series->rowCount() << "|"
+               << series->rejected() << "|";
+            for (size_t i = 0; i < series->columns().size(); ++i) {
+                ss << (i > 0 ? "," : "") << series->columns()[i];
+            }
+            ss << "\n";
+        }
+    }
+    return env->NewStringUTF(ss.str().c_str());
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeQueryMetrics(
+    JNIEnv* env,
+    jobject /* thiz */,
+    jstring series,
+    jstring column,
+    jlong beginNs,
+    jlong endNs,
+    jlong windowNs) {
+    std::string seriesName;
+    std::string columnName;
+    if (!readString(env, series, seriesName) || !readString(env, column, columnName)) {
+        return env->NewFloatArray(0);
+    }
+
+    auto metrics = sessionMetrics();
+    const auto* timeSeries = metrics ? metrics->store().find(seriesName) : nullptr;
+    if (!timeSeries) {
+        return env->NewFloatArray(0);
+    }
+    const auto windows = timeSeries->aggregate(timeSeries->columnIndex(columnName), beginNs, endNs, windowNs);
+
+    // 8 per window: [startOffsetMs (from beginNs), count, min, max, mean, p50, p95, p99]
+    constexpr size_t kFieldsPerWindow = 8;
+    std::vector<float> data;
+    data.reserve(windows.size() * kFieldsPerWindow);
+    for (const auto& window : windows) {
+        data.insert(data.end(), {
+            static_cast<float>(static_cast<double>(window.startNs - beginNs) * 1e-6),
+            static_cast<float>(window.count),
+            window.min,
+            window.max,
+            window.mean,
+            window.p50,
+            window.p95,
+            window.p99
+        });
+    }
+    jfloatArray result = env->NewFloatArray(static_cast<jsize>(data.size()));
+    env->SetFloatArrayRegion(result, 0, static_cast<jsize>(data.size()), data.data());
+    return result;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeStartExport(
+    JNIEnv* env,
+    jobject /* thiz */,
+    jstring path,
+    jboolean compress) {
+    std::string filePath;
+    if (!readString(env, path, filePath)) {
+        return JNI_FALSE;
+    }
+
+    LOGI("NativeSensorBridge.nativeStartExport(%s, compress=%d)", filePath.c_str(), compress);
+    if (!workersReady() || !g_calibrationStore) {
+        return JNI_FALSE;
+    }
+    std::shared_ptr<nativesensor::SessionExporter> previous;
+    {
+        std::lock_guard<std::mutex> lock(g_exportMutex);
+        previous = std::move(g_sessionExporter);
+    }
+    if (previous) {
+        previous->finish();
+    }
+
+    nativesensor::SessionExportConfig config;
+    config.frameQueueCapacity = analysis::kExportFrameQueueCapacity;
+    config.compression = compress ? nativesensor::McapCompression::Lz4 : nativesensor::McapCompression::None;
+    auto exporter = std::make_shared<nativesensor::SessionExporter>(std::move(filePath), *g_calibrationStore, config);
+    if (!exporter->ok()) {
+        return JNI_FALSE;
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_exportMutex);
+        g_sessionExporter = std::move(exporter);
+    }
+    setBranchEnabled(g_exportImuEdge, true);
+    setBranchEnabled(g_exportFramesEdge, true);
+    return JNI_TRUE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeStopExport(
+    JNIEnv* /* env */,
+    jobject /* thiz */) {
+    LOGI("NativeSensorBridge.nativeStopExport()");
+    std::shared_ptr<nativesensor::SessionExporter> exporter;
+    {
+        std::lock_guard<std::mutex> lock(g_exportMutex);
+        exporter = std::move(g_sessionExporter);
+    }
+    if (!exporter) {
+        return JNI_FALSE;
+    }
+    if (workersReady()) {
+        setBranchEnabled(g_exportImuEdge, false);
+        setBranchEnabled(g_exportFramesEdge, false);
+    }
+    // Sinks still holding the exporter see it closed and drop their data
+    const bool ok = exporter->finish();
+    std::lock_guard<std::mutex> lock(g_exportMutex);
+    g_lastExportStats = exporter->getStats();
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetExportStats(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    nativesensor::SessionExportStats stats;
+    if (auto exporter = sessionExporter()) {
+        stats = exporter->getStats();
+    } else {
+        std::lock_guard<std::mutex> lock(g_exportMutex);
+        stats = g_lastExportStats;
+    }
+
+    // [imuSamples, frames, droppedImu, droppedFrames, chunks, uncompressedMB, writtenMB, compressMs, busyMs]
+    constexpr float kBytesPerMb = 1024.0f * 1024.0f;
+    const float data[9] = {
+        static_cast<float>(stats.imuSamples),
+        static_cast<float>(stats.frames),
+        static_cast<float>(stats.droppedImu),
+        static_cast<float>(stats.droppedFrames),
+        static_cast<float>(stats.chunks),
+        static_cast<float>(stats.uncompressedBytes) / kBytesPerMb,
+        static_cast<float>(stats.bytesWritten) / kBytesPerMb,
+        stats.compressMs,
+        stats.busyMs
+    };
+    jfloatArray result = env->NewFloatArray(9);
+    env->SetFloatArrayRegion(result, 0, 9, data);
+    return result;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeStartStreamServer(
+    JNIEnv* env,
+    jobject /* thiz */,
+    jstring name) {
+    std::string socketName;
+    if (!readString(env, name, socketName)) {
+        return JNI_FALSE;
+    }
+
+    LOGI("NativeSensorBridge.nativeStartStreamServer(%s)", socketName.c_str());
+    return g_streamServer.start(socketName) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeStopStreamServer(
+    JNIEnv* /* env */,
+    jobject /* thiz */) {
+    LOGI("NativeSensorBridge.nativeStopStreamServer()");
+    g_streamServer.stop();
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetStreamServerStats(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    const nativesensor::StreamServerStats stats = g_streamServer.getStats();
+
+    // [clients, accepted, published, sent, dropped, ingestDropped, sentMB]
+    const float data[7] = {
+        static_cast<float>(stats.clients),
+        static_cast<float>(stats.accepted),
+        static_cast<float>(stats.published),
+        static_cast<float>(stats.sent),
+        static_cast<float>(stats.dropped),
+        static_cast<float>(stats.ingestDropped),
+        static_cast<float>(stats.bytesSent) / (1024.0f * 1024.0f)
+    };
+    jfloatArray result = env->NewFloatArray(7);
+    env->SetFloatArrayRegion(result, 0, 7, data);
+    return result;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetSharedImuRing(
+    JNIEnv* /* env */,
+    jobject /* thiz */) {
+    std::lock_guard<std::mutex> lock(g_imuRingMutex);
+    if (!g_imuRingOwner) {
+        auto ring = std::make_unique<nativesensor::SharedRingWriter>();
+        if (!ring->create("nativesensor-imu", kImuRingSlots, sizeof(nativesensor::stream::ImuMessage),
+                          static_cast<uint32_t>(nativesensor::stream::MessageType::Imu))) {
+            return -1;
+        }
+        g_imuRingOwner = std::move(ring);
+        g_imuRing.store(g_imuRingOwner.get(), std::memory_order_release);
+    }
+    return g_imuRingOwner->fd();
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeListStreams(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    // Format per line: id|name|version
+    std::ostringstream ss;
+    for (const auto& stream : g_mailboxes.streams()) {
+        ss << stream.id << "|"
+           << stream.name << "|"
+           << stream.version << "\n";
+    }
+    return env->NewStringUTF(ss.str().c_str());
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeReadStream(
+    JNIEnv* env,
+    jobject /* thiz */,
+    jint streamId) {
+    // Layout per stream, see its flatten function; empty until the first value
+    std::vector<float> data;
+    if (!g_mailboxes.readFloats(static_cast<nativesensor::StreamId>(streamId), data)) {
+        data.clear();
+    }
+    return toFloatArray(env, data);
+}
+
 // =============================================================================
 // Camera JNI Functions (CameraBridge)
 // =============================================================================
@@ -252,9 +1569,10 @@ Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeStartPreview(
     jobject /* thiz */,
     jstring cameraId,
     jobject surface) {
-    const char* idStr = env->GetStringUTFChars(cameraId, nullptr);
-    std::string id(idStr);
-    env->ReleaseStringUTFChars(cameraId, idStr);
+    std::string id;
+    if (!readString(env, cameraId, id)) {
+        return JNI_FALSE;
+    }
 
     LOGI("CameraBridge.nativeStartPreview(%s)", id.c_str());
 
@@ -289,9 +1607,10 @@ Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeStopCameraPreview
     JNIEnv* env,
     jobject /* thiz */,
     jstring cameraId) {
-    const char* idStr = env->GetStringUTFChars(cameraId, nullptr);
-    std::string id(idStr);
-    env->ReleaseStringUTFChars(cameraId, idStr);
+    std::string id;
+    if (!readString(env, cameraId, id)) {
+        return;
+    }
 
     LOGI("CameraBridge.nativeStopCameraPreview(%s)", id.c_str());
     stopCameraStream(id);
@@ -338,9 +1657,10 @@ Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetCameraStatsByI
     JNIEnv* env,
     jobject /* thiz */,
     jstring cameraId) {
-    const char* idStr = env->GetStringUTFChars(cameraId, nullptr);
-    std::string id(idStr);
-    env->ReleaseStringUTFChars(cameraId, idStr);
+    std::string id;
+    if (!readString(env, cameraId, id)) {
+        return env->NewFloatArray(0);
+    }
 
     std::lock_guard<std::mutex> lock(g_cameraMutex);
     auto it = g_cameraStreams.find(id);
@@ -350,14 +1670,22 @@ Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetCameraStatsByI
         stats = it->second->getStats();
     }
 
-    jfloatArray result = env->NewFloatArray(4);
-    float data[4] = {
+    // [fps, latencyMs, frameCount, droppedFrames], then if the camera has
+    // analysis frames [meanLuma, darkClip, brightClip, sharpness, noiseSigma,
+    // computeUs, histogram...]
+    std::vector<float> data = {
         stats.frameRateHz,
         stats.latencyMs,
         static_cast<float>(stats.frameCount),
         static_cast<float>(stats.droppedFrames)
     };
-    env->SetFloatArrayRegion(result, 0, 4, data);
+    if (const auto quality = workersReady() ? g_frameQuality->latest(id) : std::nullopt) {
+        data.insert(data.end(), {quality->meanLuma, quality->darkClipRatio, quality->brightClipRatio,
+                                 quality->sharpness, quality->noiseSigma, quality->computeUs});
+        data.insert(data.end(), quality->histogram.begin(), quality->histogram.end());
+    }
+    jfloatArray result = env->NewFloatArray(static_cast<jsize>(data.size()));
+    env->SetFloatArrayRegion(result, 0, static_cast<jsize>(data.size()), data.data());
     return result;
 }
 
@@ -380,9 +1708,10 @@ Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeIsCameraStreaming
     JNIEnv* env,
     jobject /* thiz */,
     jstring cameraId) {
-    const char* idStr = env->GetStringUTFChars(cameraId, nullptr);
-    std::string id(idStr);
-    env->ReleaseStringUTFChars(cameraId, idStr);
+    std::string id;
+    if (!readString(env, cameraId, id)) {
+        return JNI_FALSE;
+    }
 
     std::lock_guard<std::mutex> lock(g_cameraMutex);
     auto it = g_cameraStreams.find(id);
@@ -424,4 +1753,333 @@ Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetActiveStreamCo
     return count;
 }
 
-}  // extern "C"
\ No newline at end of file
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetCameraCalibration(
+    JNIEnv* env,
+    jobject /* thiz */,
+    jstring cameraId) {
+    std::string id;
+    if (!readString(env, cameraId, id)) {
+        return env->NewFloatArray(0);
+    }
+
+    const auto calibration = getCalibrationStore()->calibration(id);
+    if (!calibration) {
+        return env->NewFloatArray(0);
+    }
+
+    // [fx, fy, cx, cy, skew, k1, k2, k3, p1, p2, qx, qy, qz, qw, tx, ty, tz,
+    //  poseReference, activeWidth, activeHeight, hasIntrinsics, hasDistortion, hasPose]
+    const auto& c = *calibration;
+    const float data[23] = {
+        c.fx, c.fy, c.cx, c.cy, c.skew,
+        c.distortion[0], c.distortion[1], c.distortion[2], c.distortion[3], c.distortion[4],
+        c.poseRotation[0], c.poseRotation[1], c.poseRotation[2], c.poseRotation[3],
+        c.poseTranslation[0], c.poseTranslation[1], c.poseTranslation[2],
+        static_cast<float>(c.poseReference),
+        static_cast<float>(c.activeArrayWidth),
+        static_cast<float>(c.activeArrayHeight),
+        c.hasIntrinsics ? 1.0f : 0.0f,
+        c.hasDistortion ? 1.0f : 0.0f,
+        c.hasPose ? 1.0f : 0.0f
+    };
+    jfloatArray result = env->NewFloatArray(23);
+    env->SetFloatArrayRegion(result, 0, 23, data);
+    return result;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeSetStereoPair(
+    JNIEnv* env,
+    jobject /* thiz */,
+    jstring cameraA,
+    jstring cameraB) {
+    std::string a;
+    std::string b;
+    if (!readString(env, cameraA, a) || !readString(env, cameraB, b)) {
+        return JNI_FALSE;
+    }
+
+    LOGI("CameraBridge.nativeSetStereoPair(%s, %s)", a.c_str(), b.c_str());
+    getCalibrationStore();
+    if (!getThreadPool() || !g_stereoDepth) {
+        return JNI_FALSE;
+    }
+    if (!g_stereoDepth->setPair(a, b)) {
+        return JNI_FALSE;
+    }
+    setBranchEnabled(g_stereoEdge, true);
+    return JNI_TRUE;
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetStereoDepth(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    if (!workersReady() || !g_stereoDepth) {
+        return env->NewFloatArray(0);
+    }
+    std::shared_ptr<const nativesensor::StereoFrame> frame;
+    {
+        std::lock_guard<std::mutex> lock(g_stereoMutex);
+        frame = g_stereoFrame;
+    }
+    if (!frame) {
+        return env->NewFloatArray(0);
+    }
+
+    // Median over valid pixels via a histogram of fixed-point disparities
+    const auto& disparity = frame->disparity;
+    const int16_t maxValue = disparity.data.empty()
+        ? int16_t{0} : *std::max_element(disparity.data.begin(), disparity.data.end());
+    std::vector<uint32_t> histogram(static_cast<size_t>(std::max<int16_t>(maxValue, 0)) + 1, 0);
+    size_t valid = 0;
+    for (const int16_t value : disparity.data) {
+        if (value > 0) {
+            ++histogram[static_cast<size_t>(value)];
+            ++valid;
+        }
+    }
+    float medianDepth = 0.0f;
+    size_t seen = 0;
+    for (size_t value = 0; value < histogram.size() && valid > 0; ++value) {
+        seen += histogram[value];
+        if (seen * 2 >= valid) {
+            const float pixels = static_cast<float>(value) / nativesensor::DisparityMap::kScale;
+            medianDepth = frame->focalPx * frame->baseline / pixels;
+            break;
+        }
+    }
+
+    // [baselineM, focalPx, width, height, validFraction, medianDepthM, computeMs, droppedPairs]
+    const size_t total = std::max<size_t>(disparity.data.size(), 1);
+    const float data[8] = {
+        frame->baseline,
+        frame->focalPx,
+        static_cast<float>(disparity.width),
+        static_cast<float>(disparity.height),
+        static_cast<float>(valid) / static_cast<float>(total),
+        medianDepth,
+        frame->computeMs,
+        static_cast<float>(g_stereoDepth->droppedPairs())
+    };
+    jfloatArray result = env->NewFloatArray(8);
+    env->SetFloatArrayRegion(result, 0, 8, data);
+    return result;
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetMotionBlurStats(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    if (!workersReady() || !g_blurGate) {
+        return env->NewFloatArray(0);
+    }
+    const auto stats = g_blurGate->getStats();
+
+    // CPU saved: each skipped frame would have gone through every gated stage
+    float gatedItemUs = 0.0f;
+    for (const auto& node : g_pipeline->getStats()) {
+        for (const char* stage : kBlurGatedStages) {
+            if (node.name == stage) {
+                gatedItemUs += node.avgItemUs;
+            }
+        }
+    }
+    const float savedCpuMs = static_cast<float>(stats.skipped) * gatedItemUs / 1000.0f;
+
+    // [passed, skipped, unscored, meanBlurPx, maxBlurPx, thresholdPx, savedCpuMs]
+    const float data[7] = {
+        static_cast<float>(stats.passed),
+        static_cast<float>(stats.skipped),
+        static_cast<float>(stats.unscored),
+        stats.meanBlurPx,
+        stats.maxBlurPx,
+        stats.thresholdPx,
+        savedCpuMs
+    };
+    jfloatArray result = env->NewFloatArray(7);
+    env->SetFloatArrayRegion(result, 0, 7, data);
+    return result;
+}
+
+JNIEXPORT void JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeSetMaxMotionBlur(
+    JNIEnv* /* env */,
+    jobject /* thiz */,
+    jfloat maxBlurPx) {
+    LOGI("CameraBridge.nativeSetMaxMotionBlur(%.2f)", maxBlurPx);
+    if (getThreadPool() && g_blurGate) {
+        g_blurGate->setMaxBlurPx(maxBlurPx);
+    }
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetRollingShutterStats(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    if (!workersReady() || !g_rollingShutter) {
+        return env->NewFloatArray(0);
+    }
+    const auto stats = g_rollingShutter->getStats();
+
+    // [corrected, uncorrected, warped, dropped, avgComputeUs, lastSkewMs, lastMaxAngleDeg]
+    const float data[7] = {
+        static_cast<float>(stats.corrected),
+        static_cast<float>(stats.uncorrected),
+        static_cast<float>(stats.warped),
+        static_cast<float>(stats.dropped),
+        stats.avgComputeUs,
+        stats.lastSkewMs,
+        stats.lastMaxAngleDeg
+    };
+    jfloatArray result = env->NewFloatArray(7);
+    env->SetFloatArrayRegion(result, 0, 7, data);
+    return result;
+}
+
+JNIEXPORT void JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeSetRollingShutterWarp(
+    JNIEnv* /* env */,
+    jobject /* thiz */,
+    jboolean enabled) {
+    LOGI("CameraBridge.nativeSetRollingShutterWarp(%d)", enabled);
+    if (getThreadPool() && g_rollingShutter) {
+        g_rollingShutter->setWarpEnabled(enabled == JNI_TRUE);
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeSetRectificationEnabled(
+    JNIEnv* /* env */,
+    jobject /* thiz */,
+    jboolean enabled) {
+    LOGI("CameraBridge.nativeSetRectificationEnabled(%d)", enabled);
+    if (getThreadPool()) {
+        setBranchEnabled(g_rectifyEdge, enabled == JNI_TRUE);
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeSetFrameQualityEnabled(
+    JNIEnv* /* env */,
+    jobject /* thiz */,
+    jboolean enabled) {
+    LOGI("CameraBridge.nativeSetFrameQualityEnabled(%d)", enabled);
+    if (getThreadPool()) {
+        setBranchEnabled(g_frameQualityEdge, enabled == JNI_TRUE);
+    }
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeCorrectFeaturePoints(
+    JNIEnv* env,
+    jobject /* thiz */,
+    jstring cameraId,
+    jfloatArray points) {
+    std::string id;
+    if (!readString(env, cameraId, id)) {
+        return env->NewFloatArray(0);
+    }
+
+    std::shared_ptr<const nativesensor::ShutterCorrectedFrame> frame;
+    {
+        std::lock_guard<std::mutex> lock(g_rectifiedMutex);
+        const auto it = g_rectifiedFrames.find(id);
+        if (it != g_rectifiedFrames.end()) {
+            frame = it->second;
+        }
+    }
+    const jsize length = points ? env->GetArrayLength(points) : 0;
+    if (!frame || length % 2 != 0) {
+        return env->NewFloatArray(0);
+    }
+
+    // Points are corrected in place against the newest frame of the camera
+    std::vector<float> xy(static_cast<size_t>(length));
+    env->GetFloatArrayRegion(points, 0, length, xy.data());
+    frame->correctPoints(xy.data(), xy.data(), xy.size() / 2);
+    jfloatArray result = env->NewFloatArray(length);
+    env->SetFloatArrayRegion(result, 0, length, xy.data());
+    return result;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeRequestSnapshot(
+    JNIEnv* env,
+    jobject /* thiz */,
+    jstring cameraId,
+    jstring path) {
+    std::string id;
+    std::string file;
+    if (!readString(env, cameraId, id) || !readString(env, path, file) || !workersReady() || !g_snapshotWriter) {
+        return JNI_FALSE;
+    }
+
+    std::lock_guard<std::mutex> lock(g_cameraMutex);
+    const auto it = g_cameraStreams.find(id);
+    if (it == g_cameraStreams.end() || !it->second->isStreaming()) {
+        LOGW("Snapshot of camera %s: not streaming", id.c_str());
+        return JNI_FALSE;
+    }
+    // Hardware JPEG where the session has a still output, else the next analysis frame
+    const bool queued = it->second->captureStill(
+        [file](const uint8_t* data, size_t size, int64_t /* timestampNs */) {
+            if (!data) {
+                LOGW("Hardware snapshot %s lost by the camera", file.c_str());
+                return;
+            }
+            g_snapshotWriter->submitEncoded(file, data, size);
+        });
+    if (queued) {
+        return JNI_TRUE;
+    }
+    if (g_analysisPools.count(id) == 0) {
+        LOGW("Snapshot of camera %s: no still or analysis output", id.c_str());
+        return JNI_FALSE;
+    }
+    return g_snapshotWriter->request(id, std::move(file)) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeSetHardwareSnapshots(
+    JNIEnv* /* env */,
+    jobject /* thiz */,
+    jboolean enabled) {
+    LOGI("CameraBridge.nativeSetHardwareSnapshots(%d)", enabled);
+    g_hardwareSnapshots.store(enabled == JNI_TRUE, std::memory_order_release);
+
+    // Applies to running streams from their next preview start
+    auto* manager = getCameraManager();
+    std::lock_guard<std::mutex> lock(g_cameraMutex);
+    for (auto& [id, stream] : g_cameraStreams) {
+        applyStillOutput(*manager, *stream, id);
+    }
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetSnapshotStats(
+    JNIEnv* env,
+    jobject /* thiz */) {
+    if (!workersReady() || !g_snapshotWriter) {
+        return env->NewFloatArray(0);
+    }
+    const auto stats = g_snapshotWriter->getStats();
+
+    // [requested, written, failed, rejected, hardware, lastEncodeMs, lastWriteMs, lastBytes]
+    const float data[8] = {
+        static_cast<float>(stats.requested),
+        static_cast<float>(stats.written),
+        static_cast<float>(stats.failed),
+        static_cast<float>(stats.rejected),
+        static_cast<float>(stats.hardware),
+        stats.lastEncodeMs,
+        stats.lastWriteMs,
+        static_cast<float>(stats.lastBytes)
+    };
+    jfloatArray result = env->NewFloatArray(8);
+    env->SetFloatArrayRegion(result, 0, 8, data);
+    return result;
+}
+
+}  // extern "C"
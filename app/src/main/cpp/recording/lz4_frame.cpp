@@ -0,0 +1,162 @@
+#include "lz4_frame.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace nativesensor {
+
+namespace {
+
+constexpr uint32_t kFrameMagic = 0x184D2204;
+constexpr size_t kBlockMaxSize = 4 << 20;
+constexpr uint8_t kFrameFlags = 0x60;           // Version 01, independent blocks
+constexpr uint8_t kBlockDescriptor = 0x70;      // 4 MB blocks
+constexpr uint32_t kUncompressedBlock = 0x80000000u;
+
+constexpr size_t kMinMatch = 4;
+constexpr size_t kLastLiterals = 5;             // Format rule: a block ends with literals
+constexpr size_t kMatchSearchLimit = 12;        // Format rule: no match starts in the last 12 bytes
+constexpr size_t kMaxOffset = 65535;
+constexpr int kHashBits = 16;
+
+uint32_t read32(const uint8_t* p) noexcept {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+void put32(std::vector<uint8_t>& out, uint32_t value) {
+    const uint8_t bytes[4] = {static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8),
+                              static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24)};
+    out.insert(out.end(), bytes, bytes + 4);
+}
+
+uint32_t hash(uint32_t sequence) noexcept {
+    return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+uint32_t rotl(uint32_t x, int r) noexcept {
+    return (x << r) | (x >> (32 - r));
+}
+
+/// XXH32 of a short input (< 16 bytes), seed 0: the frame header checksum
+uint32_t xxh32Short(const uint8_t* data, size_t size) noexcept {
+    constexpr uint32_t kPrime1 = 2654435761u;
+    constexpr uint32_t kPrime2 = 2246822519u;
+    constexpr uint32_t kPrime3 = 3266489917u;
+    constexpr uint32_t kPrime4 = 668265263u;
+    constexpr uint32_t kPrime5 = 374761393u;
+    uint32_t h = kPrime5 + static_cast<uint32_t>(size);
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        h = rotl(h + read32(data + i) * kPrime3, 17) * kPrime4;
+    }
+    for (; i < size; ++i) {
+        h = rotl(h + data[i] * kPrime5, 11) * kPrime1;
+    }
+    h ^= h >> 15;
+    h *= kPrime2;
+    h ^= h >> 13;
+    h *= kPrime3;
+    h ^= h >> 16;
+    return h;
+}
+
+/// Length beyond a 4-bit token field: 255s then the remainder
+uint8_t* putLength(uint8_t* op, size_t length) noexcept {
+    for (; length >= 255; length -= 255) {
+        *op++ = 255;
+    }
+    *op++ = static_cast<uint8_t>(length);
+    return op;
+}
+
+uint8_t* putSequence(uint8_t* op, const uint8_t* literals, size_t literalLength, size_t offset,
+                     size_t matchLength) noexcept {
+    uint8_t* token = op++;
+    *token = static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+    if (literalLength >= 15) {
+        op = putLength(op, literalLength - 15);
+    }
+    std::memcpy(op, literals, literalLength);
+    op += literalLength;
+    if (matchLength == 0) {
+        return op;      // Last sequence: literals only
+    }
+    *op++ = static_cast<uint8_t>(offset);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    const size_t extra = matchLength - kMinMatch;
+    *token |= static_cast<uint8_t>(std::min<size_t>(extra, 15));
+    if (extra >= 15) {
+        op = putLength(op, extra - 15);
+    }
+    return op;
+}
+
+/// Compress one block into `dst` (room for the worst case); returns its size
+size_t compressBlock(const uint8_t* src, size_t size, uint8_t* dst, std::vector<uint32_t>& table) {
+    std::fill(table.begin(), table.end(), 0);
+    uint8_t* op = dst;
+    size_t anchor = 0;
+    if (size > kMatchSearchLimit) {
+        const size_t searchEnd = size - kMatchSearchLimit;
+        const size_t matchEnd = size - kLastLiterals;
+        size_t ip = 1;
+        table[hash(read32(src))] = 0;
+        while (ip < searchEnd) {
+            const uint32_t sequence = read32(src + ip);
+            uint32_t& slot = table[hash(sequence)];
+            const size_t candidate = slot;
+            slot = static_cast<uint32_t>(ip);
+            if (candidate >= ip || ip - candidate > kMaxOffset || read32(src + candidate) != sequence) {
+                // Skip faster through data that doesn't compress
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            size_t length = kMinMatch;
+            while (ip + length < matchEnd && src[candidate + length] == src[ip + length]) {
+                ++length;
+            }
+            op = putSequence(op, src + anchor, ip - anchor, ip - candidate, length);
+            ip += length;
+            anchor = ip;
+            if (ip < searchEnd) {
+                table[hash(read32(src + ip - 2))] = static_cast<uint32_t>(ip - 2);
+            }
+        }
+    }
+    op = putSequence(op, src + anchor, size - anchor, 0, 0);
+    return static_cast<size_t>(op - dst);
+}
+
+}  // namespace
+
+void lz4CompressFrame(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    put32(out, kFrameMagic);
+    const uint8_t descriptor[2] = {kFrameFlags, kBlockDescriptor};
+    out.insert(out.end(), descriptor, descriptor + 2);
+    out.push_back(static_cast<uint8_t>(xxh32Short(descriptor, 2) >> 8));
+
+    std::vector<uint32_t> table(size_t{1} << kHashBits);
+    for (size_t offset = 0; offset < size; offset += kBlockMaxSize) {
+        const size_t blockSize = std::min(kBlockMaxSize, size - offset);
+        const size_t header = out.size();
+        out.resize(header + 4 + blockSize + blockSize / 255 + 16);
+        const size_t compressed = compressBlock(data + offset, blockSize, out.data() + header + 4, table);
+        if (compressed < blockSize) {
+            out.resize(header + 4 + compressed);
+            out[header] = static_cast<uint8_t>(compressed);
+            out[header + 1] = static_cast<uint8_t>(compressed >> 8);
+            out[header + 2] = static_cast<uint8_t>(compressed >> 16);
+            out[header + 3] = static_cast<uint8_t>(compressed >> 24);
+        } else {
+            out.resize(header);
+            put32(out, static_cast<uint32_t>(blockSize) | kUncompressedBlock);
+            out.insert(out.end(), data + offset, data + offset + blockSize);
+        }
+    }
+    put32(out, 0);      // End mark
+}
+
+}  // namespace nativesensor
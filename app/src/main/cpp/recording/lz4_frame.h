@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nativesensor {
+
+/// Compress `size` bytes into one LZ4 frame (independent 4 MB blocks, no
+/// checksums), appended to `out`. Greedy single-pass matcher: about the
+/// speed of the reference LZ4 fast mode, a somewhat lower ratio. Blocks
+/// that don't shrink are stored raw.
+void lz4CompressFrame(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+}  // namespace nativesensor
@@ -0,0 +1,417 @@
+#include "mcap_writer.h"
+
+#include <algorithm>
+#include <android/log.h>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "file_utils.h"
+#include "lz4_frame.h"
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.Mcap";
+}
+
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+namespace {
+
+constexpr uint8_t kMagic[8] = {0x89, 'M', 'C', 'A', 'P', '0', '\r', '\n'};
+constexpr const char* kLibrary = "nativesensor";
+constexpr size_t kOutputBufferSize = 1 << 20;
+
+enum Opcode : uint8_t {
+    kHeader = 0x01,
+    kFooter = 0x02,
+    kSchema = 0x03,
+    kChannel = 0x04,
+    kMessage = 0x05,
+    kChunk = 0x06,
+    kMessageIndex = 0x07,
+    kChunkIndex = 0x08,
+    kStatistics = 0x0B,
+    kMetadata = 0x0C,
+    kMetadataIndex = 0x0D,
+    kSummaryOffset = 0x0E,
+    kDataEnd = 0x0F,
+};
+
+// Little-endian record fields
+
+void putU8(std::vector<uint8_t>& out, uint8_t value) {
+    out.push_back(value);
+}
+
+template<typename T>
+void putLe(std::vector<uint8_t>& out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i)));
+    }
+}
+
+template<typename T>
+void patchLe(std::vector<uint8_t>& out, size_t position, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out[position + i] = static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i));
+    }
+}
+
+void putString(std::vector<uint8_t>& out, const std::string& value) {
+    putLe<uint32_t>(out, static_cast<uint32_t>(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+void putKeyValues(std::vector<uint8_t>& out, const McapWriter::KeyValues& values) {
+    const size_t position = out.size();
+    putLe<uint32_t>(out, 0);
+    for (const auto& [key, value] : values) {
+        putString(out, key);
+        putString(out, value);
+    }
+    patchLe<uint32_t>(out, position, static_cast<uint32_t>(out.size() - position - 4));
+}
+
+/// Start a record in `out`; returns where its length goes
+size_t beginRecord(std::vector<uint8_t>& out, Opcode opcode) {
+    putU8(out, opcode);
+    const size_t position = out.size();
+    putLe<uint64_t>(out, 0);
+    return position;
+}
+
+void endRecord(std::vector<uint8_t>& out, size_t position) {
+    patchLe<uint64_t>(out, position, out.size() - position - 8);
+}
+
+}  // namespace
+
+McapWriter::~McapWriter() {
+    abandon();
+}
+
+bool McapWriter::open(const std::string& path, const McapWriterOptions& options) {
+    abandon();
+    options_ = options;
+    path_ = path;
+    tmpPath_ = path + ".tmp";
+    fd_ = ::open(tmpPath_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        LOGE("Failed to create %s", tmpPath_.c_str());
+        return false;
+    }
+
+    failed_ = false;
+    offset_ = 0;
+    output_.clear();
+    output_.reserve(kOutputBufferSize);
+    schemas_.clear();
+    channels_.clear();
+    chunkIndexes_.clear();
+    metadataIndexes_.clear();
+    chunk_.clear();
+    chunk_.reserve(options_.chunkSize + (options_.chunkSize >> 3));
+    chunkMessageIndex_.clear();
+    messageStartNs_ = 0;
+    messageEndNs_ = 0;
+    stats_ = {};
+
+    record_.assign(kMagic, kMagic + sizeof(kMagic));
+    const size_t header = beginRecord(record_, kHeader);
+    putString(record_, options_.profile);
+    putString(record_, kLibrary);
+    endRecord(record_, header);
+    return emit(record_);
+}
+
+uint16_t McapWriter::addSchema(const std::string& name, const std::string& encoding, const std::string& data) {
+    schemas_.push_back({name, encoding, data});
+    const auto id = static_cast<uint16_t>(schemas_.size());
+
+    record_.clear();
+    const size_t position = beginRecord(record_, kSchema);
+    putLe<uint16_t>(record_, id);
+    putString(record_, name);
+    putString(record_, encoding);
+    putString(record_, data);
+    endRecord(record_, position);
+    return emit(record_) ? id : 0;
+}
+
+uint16_t McapWriter::addChannel(uint16_t schemaId, const std::string& topic, const std::string& messageEncoding,
+                                const KeyValues& metadata) {
+    const auto id = static_cast<uint16_t>(channels_.size());
+    channels_.push_back({schemaId, topic, messageEncoding, metadata});
+
+    // Outside the open chunk, which is written later: still ahead of its messages
+    record_.clear();
+    const size_t position = beginRecord(record_, kChannel);
+    putLe<uint16_t>(record_, id);
+    putLe<uint16_t>(record_, schemaId);
+    putString(record_, topic);
+    putString(record_, messageEncoding);
+    putKeyValues(record_, metadata);
+    endRecord(record_, position);
+    failed_ = failed_ || !emit(record_);
+    return id;
+}
+
+bool McapWriter::writeMessage(uint16_t channelId, TimestampNs logTimeNs, const uint8_t* data, size_t size) {
+    if (fd_ < 0 || failed_ || channelId >= channels_.size()) {
+        return false;
+    }
+    Channel& channel = channels_[channelId];
+    const auto timeNs = static_cast<uint64_t>(logTimeNs);
+    if (chunk_.empty()) {
+        chunkStartNs_ = timeNs;
+        chunkEndNs_ = timeNs;
+    }
+    chunkStartNs_ = std::min(chunkStartNs_, timeNs);
+    chunkEndNs_ = std::max(chunkEndNs_, timeNs);
+    messageStartNs_ = stats_.messages == 0 ? timeNs : std::min(messageStartNs_, timeNs);
+    messageEndNs_ = std::max(messageEndNs_, timeNs);
+
+    chunkMessageIndex_[channelId].emplace_back(timeNs, chunk_.size());
+    putU8(chunk_, kMessage);
+    putLe<uint64_t>(chunk_, 2 + 4 + 8 + 8 + size);
+    putLe<uint16_t>(chunk_, channelId);
+    putLe<uint32_t>(chunk_, channel.sequence++);
+    putLe<uint64_t>(chunk_, timeNs);
+    putLe<uint64_t>(chunk_, timeNs);    // Publish time: no separate clock
+    chunk_.insert(chunk_.end(), data, data + size);
+    ++channel.messageCount;
+    ++stats_.messages;
+
+    return chunk_.size() < options_.chunkSize || flushChunk();
+}
+
+bool McapWriter::writeMetadata(const std::string& name, const KeyValues& metadata) {
+    if (fd_ < 0) {
+        return false;
+    }
+    record_.clear();
+    const size_t position = beginRecord(record_, kMetadata);
+    putString(record_, name);
+    putKeyValues(record_, metadata);
+    endRecord(record_, position);
+    metadataIndexes_.push_back({offset_, record_.size(), name});
+    return emit(record_);
+}
+
+bool McapWriter::flushChunk() {
+    if (chunk_.empty()) {
+        return !failed_;
+    }
+
+    const auto crc = static_cast<uint32_t>(crc32(0L, chunk_.data(), static_cast<uInt>(chunk_.size())));
+    const uint8_t* records = chunk_.data();
+    size_t recordsSize = chunk_.size();
+    std::string compression;
+    if (options_.compression == McapCompression::Lz4) {
+        const auto start = std::chrono::steady_clock::now();
+        compressed_.clear();
+        lz4CompressFrame(chunk_.data(), chunk_.size(), compressed_);
+        stats_.compressMs += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        records = compressed_.data();
+        recordsSize = compressed_.size();
+        compression = "lz4";
+    }
+
+    ChunkIndex index;
+    index.startNs = chunkStartNs_;
+    index.endNs = chunkEndNs_;
+    index.offset = offset_;
+    index.compressedSize = recordsSize;
+    index.uncompressedSize = chunk_.size();
+
+    // Header fields, then the records straight from their buffer
+    record_.clear();
+    putU8(record_, kChunk);
+    putLe<uint64_t>(record_, 8 + 8 + 8 + 4 + 4 + compression.size() + 8 + recordsSize);
+    putLe<uint64_t>(record_, chunkStartNs_);
+    putLe<uint64_t>(record_, chunkEndNs_);
+    putLe<uint64_t>(record_, chunk_.size());
+    putLe<uint32_t>(record_, crc);
+    putString(record_, compression);
+    putLe<uint64_t>(record_, recordsSize);
+    bool ok = emit(record_) && flushOutput() && writeAll(fd_, records, recordsSize);
+    failed_ = failed_ || !ok;
+    offset_ += recordsSize;
+    index.length = offset_ - index.offset;
+
+    const uint64_t messageIndexStart = offset_;
+    for (const auto& [channelId, entries] : chunkMessageIndex_) {
+        index.messageIndexOffsets[channelId] = offset_;
+        record_.clear();
+        const size_t position = beginRecord(record_, kMessageIndex);
+        putLe<uint16_t>(record_, channelId);
+        putLe<uint32_t>(record_, static_cast<uint32_t>(entries.size() * 16));
+        for (const auto& [timeNs, offset] : entries) {
+            putLe<uint64_t>(record_, timeNs);
+            putLe<uint64_t>(record_, offset);
+        }
+        endRecord(record_, position);
+        ok = ok && emit(record_);
+    }
+    index.messageIndexLength = offset_ - messageIndexStart;
+    chunkIndexes_.push_back(std::move(index));
+
+    ++stats_.chunks;
+    stats_.uncompressedBytes += static_cast<int64_t>(chunk_.size());
+    chunk_.clear();
+    chunkMessageIndex_.clear();
+    return ok;
+}
+
+bool McapWriter::finish() {
+    if (fd_ < 0 || !flushChunk()) {
+        abandon();
+        return false;
+    }
+
+    record_.clear();
+    const size_t dataEnd = beginRecord(record_, kDataEnd);
+    putLe<uint32_t>(record_, 0);
+    endRecord(record_, dataEnd);
+    bool ok = emit(record_);
+
+    // Summary: one group per record type, each located by a summary offset
+    const uint64_t summaryStart = offset_;
+    std::vector<std::pair<Opcode, std::pair<uint64_t, uint64_t>>> groups;
+    auto group = [&](Opcode opcode, size_t count, auto&& write) {
+        if (count == 0) {
+            return;
+        }
+        const uint64_t start = offset_;
+        for (size_t i = 0; i < count; ++i) {
+            record_.clear();
+            write(i);
+            ok = ok && emit(record_);
+        }
+        groups.push_back({opcode, {start, offset_ - start}});
+    };
+
+    group(kSchema, schemas_.size(), [&](size_t i) {
+        const size_t position = beginRecord(record_, kSchema);
+        putLe<uint16_t>(record_, static_cast<uint16_t>(i + 1));
+        putString(record_, schemas_[i].name);
+        putString(record_, schemas_[i].encoding);
+        putString(record_, schemas_[i].data);
+        endRecord(record_, position);
+    });
+    group(kChannel, channels_.size(), [&](size_t i) {
+        const Channel& channel = channels_[i];
+        const size_t position = beginRecord(record_, kChannel);
+        putLe<uint16_t>(record_, static_cast<uint16_t>(i));
+        putLe<uint16_t>(record_, channel.schemaId);
+        putString(record_, channel.topic);
+        putString(record_, channel.messageEncoding);
+        putKeyValues(record_, channel.metadata);
+        endRecord(record_, position);
+    });
+    group(kStatistics, 1, [&](size_t) {
+        const size_t position = beginRecord(record_, kStatistics);
+        putLe<uint64_t>(record_, static_cast<uint64_t>(stats_.messages));
+        putLe<uint16_t>(record_, static_cast<uint16_t>(schemas_.size()));
+        putLe<uint32_t>(record_, static_cast<uint32_t>(channels_.size()));
+        putLe<uint32_t>(record_, 0);    // Attachments
+        putLe<uint32_t>(record_, static_cast<uint32_t>(metadataIndexes_.size()));
+        putLe<uint32_t>(record_, static_cast<uint32_t>(chunkIndexes_.size()));
+        putLe<uint64_t>(record_, messageStartNs_);
+        putLe<uint64_t>(record_, messageEndNs_);
+        putLe<uint32_t>(record_, static_cast<uint32_t>(channels_.size() * 10));
+        for (size_t c = 0; c < channels_.size(); ++c) {
+            putLe<uint16_t>(record_, static_cast<uint16_t>(c));
+            putLe<uint64_t>(record_, channels_[c].messageCount);
+        }
+        endRecord(record_, position);
+    });
+    group(kChunkIndex, chunkIndexes_.size(), [&](size_t i) {
+        const ChunkIndex& index = chunkIndexes_[i];
+        const size_t position = beginRecord(record_, kChunkIndex);
+        putLe<uint64_t>(record_, index.startNs);
+        putLe<uint64_t>(record_, index.endNs);
+        putLe<uint64_t>(record_, index.offset);
+        putLe<uint64_t>(record_, index.length);
+        putLe<uint32_t>(record_, static_cast<uint32_t>(index.messageIndexOffsets.size() * 10));
+        for (const auto& [channelId, offset] : index.messageIndexOffsets) {
+            putLe<uint16_t>(record_, channelId);
+            putLe<uint64_t>(record_, offset);
+        }
+        putLe<uint64_t>(record_, index.messageIndexLength);
+        putString(record_, options_.compression == McapCompression::Lz4 ? "lz4" : "");
+        putLe<uint64_t>(record_, index.compressedSize);
+        putLe<uint64_t>(record_, index.uncompressedSize);
+        endRecord(record_, position);
+    });
+    group(kMetadataIndex, metadataIndexes_.size(), [&](size_t i) {
+        const MetadataIndex& index = metadataIndexes_[i];
+        const size_t position = beginRecord(record_, kMetadataIndex);
+        putLe<uint64_t>(record_, index.offset);
+        putLe<uint64_t>(record_, index.length);
+        putString(record_, index.name);
+        endRecord(record_, position);
+    });
+
+    const uint64_t summaryOffsetStart = offset_;
+    for (const auto& [opcode, range] : groups) {
+        record_.clear();
+        const size_t position = beginRecord(record_, kSummaryOffset);
+        putU8(record_, opcode);
+        putLe<uint64_t>(record_, range.first);
+        putLe<uint64_t>(record_, range.second);
+        endRecord(record_, position);
+        ok = ok && emit(record_);
+    }
+
+    record_.clear();
+    const size_t footer = beginRecord(record_, kFooter);
+    putLe<uint64_t>(record_, summaryStart);
+    putLe<uint64_t>(record_, summaryOffsetStart);
+    putLe<uint32_t>(record_, 0);
+    endRecord(record_, footer);
+    record_.insert(record_.end(), kMagic, kMagic + sizeof(kMagic));
+    ok = ok && emit(record_) && flushOutput() && ::fsync(fd_) == 0;
+    stats_.bytesWritten = static_cast<int64_t>(offset_);
+
+    ::close(fd_);
+    fd_ = -1;
+    if (!ok || ::rename(tmpPath_.c_str(), path_.c_str()) != 0) {
+        LOGE("Failed to write %s", path_.c_str());
+        ::unlink(tmpPath_.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool McapWriter::emit(const std::vector<uint8_t>& record) {
+    if (fd_ < 0 || failed_) {
+        return false;
+    }
+    output_.insert(output_.end(), record.begin(), record.end());
+    offset_ += record.size();
+    stats_.bytesWritten = static_cast<int64_t>(offset_);
+    return output_.size() < kOutputBufferSize || flushOutput();
+}
+
+bool McapWriter::flushOutput() {
+    if (!output_.empty()) {
+        failed_ = failed_ || !writeAll(fd_, output_.data(), output_.size());
+        output_.clear();
+    }
+    return !failed_;
+}
+
+void McapWriter::abandon() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+        ::unlink(tmpPath_.c_str());
+    }
+}
+
+}  // namespace nativesensor
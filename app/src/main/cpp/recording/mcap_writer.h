@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sensor_types.h"
+
+namespace nativesensor {
+
+enum class McapCompression : int32_t {
+    None = 0,
+    Lz4 = 1,
+};
+
+struct McapWriterOptions {
+    std::string profile = "ros2";
+    McapCompression compression = McapCompression::Lz4;
+    size_t chunkSize = 1 << 20;         // Uncompressed bytes per chunk
+};
+
+/// Chunk/byte counters of a writer
+struct McapWriterStats {
+    int64_t messages = 0;
+    int64_t chunks = 0;
+    int64_t uncompressedBytes = 0;      // Chunk records before compression
+    int64_t bytesWritten = 0;
+    float compressMs = 0.0f;            // Total time spent compressing
+};
+
+/// Writer for MCAP files (https://mcap.dev/spec): messages are grouped
+/// into chunks, optionally LZ4-compressed, each followed by its message
+/// indexes; finish() appends the summary (schemas, channels, statistics,
+/// chunk and metadata indexes, summary offsets) so readers can seek by
+/// time without scanning. CRCs are set on chunks; the data and summary
+/// CRCs are left 0 ("not computed"), which the spec allows.
+///
+/// Written to `path` + ".tmp" and renamed by finish(); an unfinished file
+/// is removed. Not thread-safe: one writer thread.
+class McapWriter {
+public:
+    using KeyValues = std::vector<std::pair<std::string, std::string>>;
+
+    McapWriter() = default;
+    ~McapWriter();
+
+    McapWriter(const McapWriter&) = delete;
+    McapWriter& operator=(const McapWriter&) = delete;
+
+    bool open(const std::string& path, const McapWriterOptions& options = {});
+
+    /// Register a schema; returns its id (0 on failure)
+    uint16_t addSchema(const std::string& name, const std::string& encoding, const std::string& data);
+
+    /// Register a channel; returns its id
+    uint16_t addChannel(uint16_t schemaId, const std::string& topic, const std::string& messageEncoding,
+                        const KeyValues& metadata = {});
+
+    bool writeMessage(uint16_t channelId, TimestampNs logTimeNs, const uint8_t* data, size_t size);
+
+    /// Name/value record outside the message stream (calibration, device info)
+    bool writeMetadata(const std::string& name, const KeyValues& metadata);
+
+    /// Close the last chunk, write the summary and footer, sync and publish
+    bool finish();
+
+    [[nodiscard]]
+    const McapWriterStats& stats() const noexcept { return stats_; }
+
+private:
+    struct Channel {
+        uint16_t schemaId = 0;
+        std::string topic;
+        std::string messageEncoding;
+        KeyValues metadata;
+        uint32_t sequence = 0;
+        uint64_t messageCount = 0;
+    };
+
+    struct Schema {
+        std::string name;
+        std::string encoding;
+        std::string data;
+    };
+
+    struct ChunkIndex {
+        uint64_t startNs = 0;
+        uint64_t endNs = 0;
+        uint64_t offset = 0;
+        uint64_t length = 0;
+        std::map<uint16_t, uint64_t> messageIndexOffsets;
+        uint64_t messageIndexLength = 0;
+        uint64_t compressedSize = 0;
+        uint64_t uncompressedSize = 0;
+    };
+
+    struct MetadataIndex {
+        uint64_t offset = 0;
+        uint64_t length = 0;
+        std::string name;
+    };
+
+    [[nodiscard]] bool flushChunk();
+    [[nodiscard]] bool emit(const std::vector<uint8_t>& record);
+    [[nodiscard]] bool flushOutput();
+    void abandon();
+
+    McapWriterOptions options_;
+    std::string path_;
+    std::string tmpPath_;
+    int fd_ = -1;
+    bool failed_ = false;
+    uint64_t offset_ = 0;               // File offset of the next emitted byte
+    std::vector<uint8_t> output_;       // Buffered file bytes
+    std::vector<uint8_t> record_;       // Scratch for one record
+
+    std::vector<Schema> schemas_;       // Id = index + 1
+    std::vector<Channel> channels_;     // Id = index
+    std::vector<ChunkIndex> chunkIndexes_;
+    std::vector<MetadataIndex> metadataIndexes_;
+
+    // Open chunk: uncompressed records plus per-channel (time, offset) index
+    std::vector<uint8_t> chunk_;
+    std::map<uint16_t, std::vector<std::pair<uint64_t, uint64_t>>> chunkMessageIndex_;
+    uint64_t chunkStartNs_ = 0;
+    uint64_t chunkEndNs_ = 0;
+    std::vector<uint8_t> compressed_;
+
+    uint64_t messageStartNs_ = 0;
+    uint64_t messageEndNs_ = 0;
+    McapWriterStats stats_;
+};
+
+}  // namespace nativesensor
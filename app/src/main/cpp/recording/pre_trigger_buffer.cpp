@@ -0,0 +1,279 @@
+#include "pre_trigger_buffer.h"
+
+#include <algorithm>
+#include <android/log.h>
+#include <chrono>
+#include <pthread.h>
+#include <utility>
+
+#include "recording_writer.h"
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.PreTrigger";
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, kLogTag, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+namespace {
+
+int32_t ceilDiv(int32_t a, int32_t b) noexcept {
+    return (a + b - 1) / b;
+}
+
+/// Box-filter `src` down by `factor` in both directions into `dst`
+void downscale(const FrameBuffer& src, int32_t factor, FrameBuffer& dst, int32_t width, int32_t height) {
+    if (factor == 1) {
+        for (int32_t y = 0; y < height; ++y) {
+            std::copy_n(src.row(y), width, dst.row(y));
+        }
+        return;
+    }
+    const int32_t area = factor * factor;
+    for (int32_t y = 0; y < height; ++y) {
+        uint8_t* out = dst.row(y);
+        for (int32_t x = 0; x < width; ++x) {
+            int32_t sum = 0;
+            for (int32_t dy = 0; dy < factor; ++dy) {
+                const uint8_t* in = src.row(y * factor + dy) + x * factor;
+                for (int32_t dx = 0; dx < factor; ++dx) {
+                    sum += in[dx];
+                }
+            }
+            out[x] = static_cast<uint8_t>((sum + area / 2) / area);
+        }
+    }
+}
+
+}  // namespace
+
+PreTriggerBuffer::PreTriggerBuffer(const PreTriggerConfig& config)
+    : config_(config),
+      frameSlots_(static_cast<size_t>(std::max<int64_t>(config.windowNs / std::max<int64_t>(config.frameIntervalNs, 1), 0)) + 1),
+      imuCapacity_(std::max<size_t>(config.imuCapacity, 1)),
+      imuSlots_(std::make_unique<ImuSlot[]>(imuCapacity_)) {
+    frozenImu_.reserve(imuCapacity_);
+}
+
+PreTriggerBuffer::~PreTriggerBuffer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void PreTriggerBuffer::addImuSample(const ImuSample& sample) noexcept {
+    const uint64_t head = imuHead_.load(std::memory_order_relaxed);
+    ImuSlot& slot = imuSlots_[head % imuCapacity_];
+    // Release on each word: a reader that sees any of them also sees the
+    // head that made this write a lap, and drops the sample
+    slot.timestampNs.store(sample.timestampNs, std::memory_order_release);
+    slot.sensorType.store(static_cast<int32_t>(sample.sensorType), std::memory_order_release);
+    slot.x.store(sample.x, std::memory_order_release);
+    slot.y.store(sample.y, std::memory_order_release);
+    slot.z.store(sample.z, std::memory_order_release);
+    imuHead_.store(head + 1, std::memory_order_release);
+}
+
+PreTriggerBuffer::CameraRing& PreTriggerBuffer::ringFor(const FrameRef& frame) {
+    const std::string& cameraId = frame->metadata.cameraId;
+    if (auto it = cameras_.find(cameraId); it != cameras_.end() && it->second.sourceWidth == frame->width() &&
+                                           it->second.sourceHeight == frame->height()) {
+        return it->second;
+    }
+
+    // First frame or a new size: frames of the old pool may still be frozen
+    const int32_t factor = std::max({ceilDiv(frame->width(), std::max(config_.maxFrameWidth, 1)),
+                                     ceilDiv(frame->height(), std::max(config_.maxFrameHeight, 1)), 1});
+    std::lock_guard<std::mutex> lock(framesMutex_);
+    CameraRing& ring = cameras_[cameraId];
+    if (ring.pool) {
+        retiredPools_.push_back(std::move(ring.pool));
+    }
+    ring.frames.assign(frameSlots_, FrameRef{});
+    ring.next = 0;
+    ring.lastKeptNs = 0;
+    ring.sourceWidth = frame->width();
+    ring.sourceHeight = frame->height();
+    ring.factor = factor;
+    ring.pool = std::make_unique<FramePool>(frame->width() / factor, frame->height() / factor,
+                                            frameSlots_ + frameSlots_ / 4 + 2);
+    LOGI("Keeping %zu frames of camera %s at %dx%d", frameSlots_, cameraId.c_str(),
+         ring.pool->width(), ring.pool->height());
+    return ring;
+}
+
+void PreTriggerBuffer::addFrame(const FrameRef& frame) {
+    CameraRing& ring = ringFor(frame);
+    const TimestampNs sinceKeptNs = frame->metadata.timestampNs - ring.lastKeptNs;
+    if (ring.lastKeptNs != 0 && sinceKeptNs >= 0 && sinceKeptNs < config_.frameIntervalNs) {
+        return;
+    }
+
+    FrameRef scaled = ring.pool->acquire();
+    if (!scaled) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.droppedFrames;
+        return;
+    }
+    downscale(*frame, ring.factor, *scaled, scaled->width(), scaled->height());
+    scaled->metadata = frame->metadata;
+    scaled->metadata.width = frame->width();
+    scaled->metadata.height = frame->height();
+    ring.lastKeptNs = frame->metadata.timestampNs;
+
+    std::lock_guard<std::mutex> lock(framesMutex_);
+    ring.frames[ring.next] = std::move(scaled);
+    ring.next = (ring.next + 1) % ring.frames.size();
+    std::erase_if(retiredPools_, [](const auto& pool) { return pool->idle(); });
+}
+
+bool PreTriggerBuffer::trigger(std::string path, TimestampNs triggerNs) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.triggers;
+        if (dumping_) {
+            ++stats_.rejected;
+            LOGW("Trigger rejected: still writing the previous window");
+            return false;
+        }
+        dumping_ = true;
+        pendingPath_ = std::move(path);
+        pendingTriggerNs_ = triggerNs;
+        if (!thread_.joinable()) {
+            thread_ = std::thread(&PreTriggerBuffer::dumpLoop, this);
+        }
+    }
+    cv_.notify_one();
+    return true;
+}
+
+PreTriggerStats PreTriggerBuffer::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void PreTriggerBuffer::freezeImu(TimestampNs beginNs, TimestampNs endNs) {
+    frozenImu_.clear();
+    const uint64_t capacity = imuCapacity_;
+    const uint64_t head = imuHead_.load(std::memory_order_acquire);
+    const uint64_t oldest = head > capacity ? head - capacity : 0;
+
+    // Newest to oldest; acquire loads keep the lap check below after the reads
+    uint64_t index = head;
+    uint64_t lastPushed = head;
+    while (index > oldest && frozenImu_.size() < capacity) {
+        const ImuSlot& slot = imuSlots_[--index % capacity];
+        const TimestampNs timestampNs = slot.timestampNs.load(std::memory_order_acquire);
+        if (timestampNs < beginNs) {
+            break;
+        }
+        const ImuSample sample{slot.x.load(std::memory_order_acquire),
+                               slot.y.load(std::memory_order_acquire),
+                               slot.z.load(std::memory_order_acquire),
+                               timestampNs,
+                               static_cast<SensorType>(slot.sensorType.load(std::memory_order_acquire))};
+        if (timestampNs <= endNs) {
+            frozenImu_.push_back(sample);
+            lastPushed = index;
+        }
+    }
+
+    // Samples the writer lapped during the scan are the oldest ones read
+    const uint64_t headNow = imuHead_.load(std::memory_order_acquire);
+    if (headNow > capacity) {
+        const uint64_t firstValid = headNow - capacity + 1;     // The slot being written may be torn
+        while (!frozenImu_.empty() && lastPushed < firstValid) {
+            frozenImu_.pop_back();
+            ++lastPushed;
+        }
+    }
+    std::reverse(frozenImu_.begin(), frozenImu_.end());
+}
+
+void PreTriggerBuffer::freezeFrames(TimestampNs beginNs, TimestampNs endNs) {
+    frozenFrames_.clear();
+    {
+        std::lock_guard<std::mutex> lock(framesMutex_);
+        for (const auto& [id, ring] : cameras_) {
+            for (const FrameRef& frame : ring.frames) {
+                if (frame && frame->metadata.timestampNs >= beginNs && frame->metadata.timestampNs <= endNs) {
+                    frozenFrames_.push_back(frame);
+                }
+            }
+        }
+    }
+    std::sort(frozenFrames_.begin(), frozenFrames_.end(), [](const FrameRef& a, const FrameRef& b) {
+        return a->metadata.timestampNs < b->metadata.timestampNs;
+    });
+}
+
+void PreTriggerBuffer::dumpLoop() {
+    pthread_setname_np(pthread_self(), "ns-pretrigger");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stopping_ || !pendingPath_.empty(); });
+        if (stopping_) {
+            break;
+        }
+        const std::string path = std::move(pendingPath_);
+        pendingPath_.clear();
+        const TimestampNs triggerNs = pendingTriggerNs_;
+
+        lock.unlock();
+        dump(path, triggerNs);
+        lock.lock();
+        dumping_ = false;
+    }
+}
+
+void PreTriggerBuffer::dump(const std::string& path, TimestampNs triggerNs) {
+    const auto start = std::chrono::steady_clock::now();
+    const TimestampNs beginNs = triggerNs - config_.windowNs;
+    freezeImu(beginNs, triggerNs);
+    freezeFrames(beginNs, triggerNs);
+    const size_t imuCount = frozenImu_.size();
+    const size_t frameCount = frozenFrames_.size();
+
+    // Merge both streams by timestamp; each frame goes back to its pool once written
+    RecordingWriter writer;
+    bool ok = writer.open(path, beginNs, triggerNs, triggerNs);
+    size_t imu = 0;
+    for (FrameRef& frame : frozenFrames_) {
+        while (ok && imu < imuCount && frozenImu_[imu].timestampNs <= frame->metadata.timestampNs) {
+            ok = writer.writeImu(frozenImu_[imu++]);
+        }
+        ok = ok && writer.writeFrame(frame->metadata, frame->data(), frame->width(), frame->height(),
+                                     frame->stride());
+        frame.reset();
+    }
+    while (ok && imu < imuCount) {
+        ok = writer.writeImu(frozenImu_[imu++]);
+    }
+    ok = ok && writer.finish();
+    frozenFrames_.clear();
+
+    const float dumpMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ok) {
+        ++stats_.failed;
+        LOGE("Failed to write pre-trigger window to %s", path.c_str());
+        return;
+    }
+    ++stats_.written;
+    stats_.lastImuSamples = static_cast<int64_t>(imuCount);
+    stats_.lastFrames = static_cast<int64_t>(frameCount);
+    stats_.lastBytes = static_cast<int64_t>(writer.bytesWritten());
+    stats_.lastDumpMs = dumpMs;
+    LOGI("Pre-trigger window written to %s: %zu IMU samples, %zu frames, %.1f ms",
+         path.c_str(), imuCount, frameCount, dumpMs);
+}
+
+}  // namespace nativesensor
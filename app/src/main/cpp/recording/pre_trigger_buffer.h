@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "frame_pool.h"
+#include "imu_data.h"
+#include "sensor_types.h"
+
+namespace nativesensor {
+
+/// What the pre-trigger buffer keeps
+struct PreTriggerConfig {
+    int64_t windowNs = 10'000'000'000;      // History written per trigger
+    size_t imuCapacity = 32768;             // IMU samples: 10 s of accel plus gyro at 1.6 kHz
+    int64_t frameIntervalNs = 200'000'000;  // At most one frame per camera per interval
+    int32_t maxFrameWidth = 320;            // Frames are box-downscaled by an integer factor to fit
+    int32_t maxFrameHeight = 320;
+};
+
+/// Pre-trigger counters
+struct PreTriggerStats {
+    int64_t triggers = 0;
+    int64_t rejected = 0;               // Triggered while the previous window was still being written
+    int64_t written = 0;
+    int64_t failed = 0;
+    int64_t droppedFrames = 0;          // Frame buffers all held by a dump
+    int64_t lastImuSamples = 0;
+    int64_t lastFrames = 0;
+    int64_t lastBytes = 0;
+    float lastDumpMs = 0.0f;
+};
+
+/// "Last N seconds" capture: IMU samples and low-resolution camera frames are
+/// kept continuously in fixed memory, and trigger() writes the window before
+/// the trigger time to a recording (recording_format.h) on a background
+/// thread while capture carries on.
+///
+/// IMU samples go into a lock-free ring written by the IMU thread (like
+/// GyroHistory); the dump copies its window out and drops samples the writer
+/// lapped meanwhile. Frames are decimated per camera and downscaled into
+/// per-camera pools with room for the window plus a spare, so a running dump
+/// (which releases frames as it writes them) only ever costs frames once the
+/// spare is used up. One dump at a time; a trigger during a dump is rejected.
+/// addImuSample() has a single producer, addFrame() runs on one pipeline
+/// thread; trigger() and getStats() may be called from anywhere.
+class PreTriggerBuffer {
+public:
+    explicit PreTriggerBuffer(const PreTriggerConfig& config = {});
+    ~PreTriggerBuffer();
+
+    PreTriggerBuffer(const PreTriggerBuffer&) = delete;
+    PreTriggerBuffer& operator=(const PreTriggerBuffer&) = delete;
+
+    /// Keep an IMU sample. Lock-free, single producer.
+    void addImuSample(const ImuSample& sample) noexcept;
+
+    /// Keep a downscaled copy of an analysis frame if its camera's interval passed
+    void addFrame(const FrameRef& frame);
+
+    /// Write [triggerNs - window, triggerNs] to `path` in the background.
+    /// False if the previous trigger is still being written.
+    bool trigger(std::string path, TimestampNs triggerNs);
+
+    [[nodiscard]]
+    PreTriggerStats getStats() const;
+
+private:
+    struct ImuSlot {
+        std::atomic<int64_t> timestampNs{0};
+        std::atomic<int32_t> sensorType{0};
+        std::atomic<float> x{0.0f};
+        std::atomic<float> y{0.0f};
+        std::atomic<float> z{0.0f};
+    };
+
+    struct CameraRing {
+        std::unique_ptr<FramePool> pool;
+        std::vector<FrameRef> frames;   // Circular, oldest at `next` once full
+        size_t next = 0;
+        TimestampNs lastKeptNs = 0;
+        int32_t sourceWidth = 0;
+        int32_t sourceHeight = 0;
+        int32_t factor = 1;
+    };
+
+    [[nodiscard]] CameraRing& ringFor(const FrameRef& frame);
+    void freezeImu(TimestampNs beginNs, TimestampNs endNs);
+    void freezeFrames(TimestampNs beginNs, TimestampNs endNs);
+    void dumpLoop();
+    void dump(const std::string& path, TimestampNs triggerNs);
+
+    const PreTriggerConfig config_;
+    const size_t frameSlots_;
+    const size_t imuCapacity_;
+
+    std::unique_ptr<ImuSlot[]> imuSlots_;
+    std::atomic<uint64_t> imuHead_{0};  // Index one past the newest sample
+
+    // Pipeline-thread rings; the mutex only covers storing and freezing refs
+    std::mutex framesMutex_;
+    std::unordered_map<std::string, CameraRing> cameras_;
+    // Pools replaced after a size change, freed once their frozen frames are back
+    std::vector<std::unique_ptr<FramePool>> retiredPools_;
+
+    // Dump thread, started by the first trigger
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+    bool stopping_ = false;
+    bool dumping_ = false;
+    std::string pendingPath_;
+    TimestampNs pendingTriggerNs_ = 0;
+    PreTriggerStats stats_;
+
+    // Frozen window, reused by every dump
+    std::vector<ImuSample> frozenImu_;
+    std::vector<FrameRef> frozenFrames_;
+};
+
+}  // namespace nativesensor
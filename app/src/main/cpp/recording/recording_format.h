@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nativesensor {
+
+/// On-disk layout of a sensor recording (.nsrec):
+///   [RecordingHeader][RecordHeader + payload] * n
+/// Records are in timestamp order; every payload starts with its fixed part,
+/// variable-length data follows. Little-endian, fields naturally aligned.
+namespace recording {
+
+constexpr char kMagic[8] = {'N', 'S', 'R', 'E', 'C', '\0', '\0', '\0'};
+constexpr uint32_t kFormatVersion = 1;
+
+struct RecordingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    int64_t startNs;                // Covered time range (CLOCK_BOOTTIME)
+    int64_t endNs;
+    int64_t triggerNs;              // 0 for continuous recordings
+    uint32_t recordCount;
+    uint32_t reserved;
+};
+
+enum class RecordType : uint32_t {
+    Imu = 1,
+    Frame = 2,
+};
+
+struct RecordHeader {
+    RecordType type;
+    uint32_t payloadSize;           // Bytes following this header
+    int64_t timestampNs;
+};
+
+/// One accelerometer or gyroscope sample
+struct ImuRecord {
+    int32_t sensorType;             // SensorType
+    float x;
+    float y;
+    float z;
+};
+
+/// Fixed part of a camera frame: followed by cameraIdLength bytes of id and
+/// width * height bytes of 8-bit luma, rows packed
+struct FrameRecord {
+    int64_t frameNumber;
+    int64_t exposureTimeNs;
+    int32_t width;
+    int32_t height;
+    int32_t sourceWidth;            // Before downscaling
+    int32_t sourceHeight;
+    uint16_t cameraIdLength;
+    uint16_t reserved[3];
+};
+
+static_assert(sizeof(RecordingHeader) == 48, "RecordingHeader layout");
+static_assert(sizeof(RecordHeader) == 16, "RecordHeader layout");
+static_assert(sizeof(ImuRecord) == 16, "ImuRecord layout");
+static_assert(sizeof(FrameRecord) == 40, "FrameRecord layout");
+
+}  // namespace recording
+
+}  // namespace nativesensor
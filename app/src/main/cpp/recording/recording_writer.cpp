@@ -0,0 +1,139 @@
+#include "recording_writer.h"
+
+#include <android/log.h>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "file_utils.h"
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.Recording";
+}
+
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+RecordingWriter::~RecordingWriter() {
+    abandon();
+}
+
+bool RecordingWriter::open(const std::string& path, TimestampNs startNs, TimestampNs endNs,
+                           TimestampNs triggerNs) {
+    abandon();
+    path_ = path;
+    tmpPath_ = path + ".tmp";
+    fd_ = ::open(tmpPath_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        LOGE("Failed to create %s", tmpPath_.c_str());
+        return false;
+    }
+
+    header_ = {};
+    std::memcpy(header_.magic, recording::kMagic, sizeof(recording::kMagic));
+    header_.version = recording::kFormatVersion;
+    header_.headerSize = sizeof(recording::RecordingHeader);
+    header_.startNs = startNs;
+    header_.endNs = endNs;
+    header_.triggerNs = triggerNs;
+    failed_ = false;
+    bytesWritten_ = 0;
+    buffer_.clear();
+    buffer_.reserve(kBufferSize);
+
+    // Rewritten with the record count by finish()
+    return append(&header_, sizeof(header_));
+}
+
+bool RecordingWriter::writeImu(const ImuSample& sample) {
+    const recording::ImuRecord record{static_cast<int32_t>(sample.sensorType), sample.x, sample.y, sample.z};
+    return appendRecord(recording::RecordType::Imu, sample.timestampNs, sizeof(record)) &&
+           append(&record, sizeof(record));
+}
+
+bool RecordingWriter::writeFrame(const FrameMetadata& metadata, const uint8_t* data, int32_t width,
+                                 int32_t height, int32_t stride) {
+    recording::FrameRecord record{};
+    record.frameNumber = metadata.frameNumber;
+    record.exposureTimeNs = metadata.exposureTimeNs;
+    record.width = width;
+    record.height = height;
+    record.sourceWidth = metadata.width;
+    record.sourceHeight = metadata.height;
+    record.cameraIdLength = static_cast<uint16_t>(std::min<size_t>(metadata.cameraId.size(), UINT16_MAX));
+
+    const size_t pixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+    if (!appendRecord(recording::RecordType::Frame, metadata.timestampNs,
+                      sizeof(record) + record.cameraIdLength + pixels) ||
+        !append(&record, sizeof(record)) ||
+        !append(metadata.cameraId.data(), record.cameraIdLength)) {
+        return false;
+    }
+    for (int32_t y = 0; y < height; ++y) {
+        if (!append(data + static_cast<ptrdiff_t>(y) * stride, static_cast<size_t>(width))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RecordingWriter::finish() {
+    if (fd_ < 0 || failed_ || !flush()) {
+        abandon();
+        return false;
+    }
+    const bool ok = ::pwrite(fd_, &header_, sizeof(header_), 0) == static_cast<ssize_t>(sizeof(header_)) &&
+                    ::fsync(fd_) == 0;
+    ::close(fd_);
+    fd_ = -1;
+    if (!ok || ::rename(tmpPath_.c_str(), path_.c_str()) != 0) {
+        LOGE("Failed to write recording %s", path_.c_str());
+        ::unlink(tmpPath_.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool RecordingWriter::appendRecord(recording::RecordType type, TimestampNs timestampNs, size_t payloadSize) {
+    const recording::RecordHeader record{type, static_cast<uint32_t>(payloadSize), timestampNs};
+    ++header_.recordCount;
+    return append(&record, sizeof(record));
+}
+
+bool RecordingWriter::append(const void* data, size_t size) {
+    if (fd_ < 0 || failed_) {
+        return false;
+    }
+    if (buffer_.size() + size > kBufferSize && !flush()) {
+        return false;
+    }
+    if (size >= kBufferSize) {
+        // Large payloads skip the buffer
+        failed_ = !writeAll(fd_, data, size);
+    } else {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        buffer_.insert(buffer_.end(), bytes, bytes + size);
+    }
+    bytesWritten_ += size;
+    return !failed_;
+}
+
+bool RecordingWriter::flush() {
+    if (!buffer_.empty()) {
+        failed_ = failed_ || !writeAll(fd_, buffer_.data(), buffer_.size());
+        buffer_.clear();
+    }
+    return !failed_;
+}
+
+void RecordingWriter::abandon() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+        ::unlink(tmpPath_.c_str());
+    }
+}
+
+}  // namespace nativesensor
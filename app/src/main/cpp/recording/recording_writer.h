@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "camera_data.h"
+#include "imu_data.h"
+#include "recording_format.h"
+
+namespace nativesensor {
+
+/// Streams records into a .nsrec file (recording_format.h) through a write
+/// buffer. The file is built under a temp name and only appears at `path`
+/// once finish() succeeded; an unfinished writer removes it on destruction.
+/// Records must be written in timestamp order. Not thread-safe.
+class RecordingWriter {
+public:
+    RecordingWriter() = default;
+    ~RecordingWriter();
+
+    RecordingWriter(const RecordingWriter&) = delete;
+    RecordingWriter& operator=(const RecordingWriter&) = delete;
+
+    /// Start a recording covering [startNs, endNs]
+    bool open(const std::string& path, TimestampNs startNs, TimestampNs endNs, TimestampNs triggerNs = 0);
+
+    bool writeImu(const ImuSample& sample);
+
+    /// Frame pixels (possibly downscaled) with the metadata of the camera
+    /// frame they came from; metadata.width/height give the source size
+    bool writeFrame(const FrameMetadata& metadata, const uint8_t* data, int32_t width, int32_t height,
+                    int32_t stride);
+
+    /// Flush, fill in the record count and move the file into place
+    bool finish();
+
+    [[nodiscard]] uint32_t recordCount() const noexcept { return header_.recordCount; }
+    [[nodiscard]] size_t bytesWritten() const noexcept { return bytesWritten_; }
+
+private:
+    static constexpr size_t kBufferSize = 256 * 1024;
+
+    bool append(const void* data, size_t size);
+    bool appendRecord(recording::RecordType type, TimestampNs timestampNs, size_t payloadSize);
+    bool flush();
+    void abandon();
+
+    std::string path_;
+    std::string tmpPath_;
+    int fd_ = -1;
+    bool failed_ = false;
+    recording::RecordingHeader header_{};
+    std::vector<uint8_t> buffer_;
+    size_t bytesWritten_ = 0;
+};
+
+}  // namespace nativesensor
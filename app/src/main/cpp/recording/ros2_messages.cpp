@@ -0,0 +1,212 @@
+#include "ros2_messages.h"
+
+#include <cstring>
+
+#include "calibration_store.h"
+
+namespace nativesensor {
+namespace ros2 {
+
+namespace {
+
+// Shared by every schema: the definitions std_msgs/Header depends on
+#define ROS2_HEADER_DEPENDENCIES \
+    "================================================================================\n" \
+    "MSG: std_msgs/Header\n" \
+    "builtin_interfaces/Time stamp\n" \
+    "string frame_id\n" \
+    "================================================================================\n" \
+    "MSG: builtin_interfaces/Time\n" \
+    "int32 sec\n" \
+    "uint32 nanosec\n"
+
+/// CDR little-endian stream; alignment counts from after the encapsulation header
+class CdrWriter {
+public:
+    explicit CdrWriter(std::vector<uint8_t>& out) : out_(out) {
+        out_.assign({0x00, 0x01, 0x00, 0x00});     // CDR_LE
+    }
+
+    void u8(uint8_t value) { out_.push_back(value); }
+    void u32(uint32_t value) { put(value); }
+    void i32(int32_t value) { put(value); }
+    void f64(double value) { put(value); }
+
+    void f64s(const double* values, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            put(values[i]);
+        }
+    }
+
+    void string(const std::string& value) {
+        put(static_cast<uint32_t>(value.size() + 1));
+        out_.insert(out_.end(), value.begin(), value.end());
+        out_.push_back(0);
+    }
+
+    /// uint8[] with `rows` rows of `width` bytes, `stride` apart
+    void bytes(const uint8_t* data, int32_t width, int32_t rows, int32_t stride) {
+        const size_t rowBytes = static_cast<size_t>(width);
+        put(static_cast<uint32_t>(rowBytes * static_cast<size_t>(rows)));
+        const size_t start = out_.size();
+        out_.resize(start + rowBytes * static_cast<size_t>(rows));
+        for (int32_t y = 0; y < rows; ++y) {
+            std::memcpy(out_.data() + start + rowBytes * static_cast<size_t>(y),
+                        data + static_cast<ptrdiff_t>(y) * stride, rowBytes);
+        }
+    }
+
+    void header(TimestampNs timestampNs, const std::string& frameId) {
+        i32(static_cast<int32_t>(timestampNs / 1'000'000'000));
+        u32(static_cast<uint32_t>(timestampNs % 1'000'000'000));
+        string(frameId);
+    }
+
+private:
+    template<typename T>
+    void put(T value) {
+        while ((out_.size() - 4) % sizeof(T) != 0) {
+            out_.push_back(0);
+        }
+        const size_t position = out_.size();
+        out_.resize(position + sizeof(T));
+        std::memcpy(out_.data() + position, &value, sizeof(T));
+    }
+
+    std::vector<uint8_t>& out_;
+};
+
+}  // namespace
+
+const char* const kImuSchemaName = "sensor_msgs/msg/Imu";
+const char* const kImuSchema =
+    "std_msgs/Header header\n"
+    "geometry_msgs/Quaternion orientation\n"
+    "float64[9] orientation_covariance\n"
+    "geometry_msgs/Vector3 angular_velocity\n"
+    "float64[9] angular_velocity_covariance\n"
+    "geometry_msgs/Vector3 linear_acceleration\n"
+    "float64[9] linear_acceleration_covariance\n"
+    ROS2_HEADER_DEPENDENCIES
+    "================================================================================\n"
+    "MSG: geometry_msgs/Quaternion\n"
+    "float64 x 0\n"
+    "float64 y 0\n"
+    "float64 z 0\n"
+    "float64 w 1\n"
+    "================================================================================\n"
+    "MSG: geometry_msgs/Vector3\n"
+    "float64 x\n"
+    "float64 y\n"
+    "float64 z\n";
+
+const char* const kImageSchemaName = "sensor_msgs/msg/Image";
+const char* const kImageSchema =
+    "std_msgs/Header header\n"
+    "uint32 height\n"
+    "uint32 width\n"
+    "string encoding\n"
+    "uint8 is_bigendian\n"
+    "uint32 step\n"
+    "uint8[] data\n"
+    ROS2_HEADER_DEPENDENCIES;
+
+const char* const kCameraInfoSchemaName = "sensor_msgs/msg/CameraInfo";
+const char* const kCameraInfoSchema =
+    "std_msgs/Header header\n"
+    "uint32 height\n"
+    "uint32 width\n"
+    "string distortion_model\n"
+    "float64[] d\n"
+    "float64[9] k\n"
+    "float64[9] r\n"
+    "float64[12] p\n"
+    "uint32 binning_x\n"
+    "uint32 binning_y\n"
+    "sensor_msgs/RegionOfInterest roi\n"
+    ROS2_HEADER_DEPENDENCIES
+    "================================================================================\n"
+    "MSG: sensor_msgs/RegionOfInterest\n"
+    "uint32 x_offset\n"
+    "uint32 y_offset\n"
+    "uint32 height\n"
+    "uint32 width\n"
+    "bool do_rectify\n";
+
+#undef ROS2_HEADER_DEPENDENCIES
+
+void serializeImu(const ImuSample& sample, const std::string& frameId, std::vector<uint8_t>& out) {
+    const double unavailable[9] = {-1.0, 0, 0, 0, 0, 0, 0, 0, 0};
+    const double unknown[9] = {};
+    const double vector[3] = {sample.x, sample.y, sample.z};
+    const double zero[3] = {};
+    const bool gyro = sample.sensorType == SensorType::Gyroscope;
+
+    CdrWriter cdr(out);
+    cdr.header(sample.timestampNs, frameId);
+    const double identity[4] = {0.0, 0.0, 0.0, 1.0};
+    cdr.f64s(identity, 4);
+    cdr.f64s(unavailable, 9);
+    cdr.f64s(gyro ? vector : zero, 3);
+    cdr.f64s(gyro ? unknown : unavailable, 9);
+    cdr.f64s(gyro ? zero : vector, 3);
+    cdr.f64s(gyro ? unavailable : unknown, 9);
+}
+
+void serializeImage(TimestampNs timestampNs, const std::string& frameId, const uint8_t* data,
+                    int32_t width, int32_t height, int32_t stride, std::vector<uint8_t>& out) {
+    CdrWriter cdr(out);
+    cdr.header(timestampNs, frameId);
+    cdr.u32(static_cast<uint32_t>(height));
+    cdr.u32(static_cast<uint32_t>(width));
+    cdr.string("mono8");
+    cdr.u8(0);
+    cdr.u32(static_cast<uint32_t>(width));
+    cdr.bytes(data, width, height, stride);
+}
+
+void serializeCameraInfo(TimestampNs timestampNs, const std::string& frameId, int32_t width, int32_t height,
+                         const CameraCalibration& calibration, std::vector<uint8_t>& out) {
+    double d[5] = {};
+    double k[9] = {};
+    const double r[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    double p[12] = {};
+    if (calibration.hasIntrinsics) {
+        const PinholeIntrinsics intrinsics = scaledIntrinsics(calibration, width, height);
+        const double camera[9] = {intrinsics.fx, intrinsics.skew, intrinsics.cx,
+                                  0.0, intrinsics.fy, intrinsics.cy,
+                                  0.0, 0.0, 1.0};
+        std::memcpy(k, camera, sizeof(k));
+        const double projection[12] = {intrinsics.fx, intrinsics.skew, intrinsics.cx, 0.0,
+                                       0.0, intrinsics.fy, intrinsics.cy, 0.0,
+                                       0.0, 0.0, 1.0, 0.0};
+        std::memcpy(p, projection, sizeof(p));
+    }
+    if (calibration.hasDistortion) {
+        // ACAMERA_LENS_DISTORTION is [k1, k2, k3, p1, p2]; plumb_bob wants [k1, k2, p1, p2, k3]
+        const float* distortion = calibration.distortion;
+        const double plumbBob[5] = {distortion[0], distortion[1], distortion[3], distortion[4], distortion[2]};
+        std::memcpy(d, plumbBob, sizeof(d));
+    }
+
+    CdrWriter cdr(out);
+    cdr.header(timestampNs, frameId);
+    cdr.u32(static_cast<uint32_t>(height));
+    cdr.u32(static_cast<uint32_t>(width));
+    cdr.string("plumb_bob");
+    cdr.u32(5);
+    cdr.f64s(d, 5);
+    cdr.f64s(k, 9);
+    cdr.f64s(r, 9);
+    cdr.f64s(p, 12);
+    cdr.u32(1);     // Binning
+    cdr.u32(1);
+    cdr.u32(0);     // Full-frame ROI
+    cdr.u32(0);
+    cdr.u32(0);
+    cdr.u32(0);
+    cdr.u8(0);
+}
+
+}  // namespace ros2
+}  // namespace nativesensor
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "camera_data.h"
+#include "imu_data.h"
+#include "sensor_types.h"
+
+namespace nativesensor {
+namespace ros2 {
+
+// Message definitions in "ros2msg" schema encoding, dependencies included
+extern const char* const kImuSchemaName;
+extern const char* const kImuSchema;
+extern const char* const kImageSchemaName;
+extern const char* const kImageSchema;
+extern const char* const kCameraInfoSchemaName;
+extern const char* const kCameraInfoSchema;
+
+// Serializers to CDR (little-endian, "cdr" message encoding); `out` is replaced
+
+/// sensor_msgs/msg/Imu with only the sample's own vector filled in; the
+/// other fields are marked unavailable (covariance[0] = -1)
+void serializeImu(const ImuSample& sample, const std::string& frameId, std::vector<uint8_t>& out);
+
+/// sensor_msgs/msg/Image, "mono8"
+void serializeImage(TimestampNs timestampNs, const std::string& frameId, const uint8_t* data,
+                    int32_t width, int32_t height, int32_t stride, std::vector<uint8_t>& out);
+
+/// sensor_msgs/msg/CameraInfo with "plumb_bob" distortion; all zero when
+/// `calibration` has no intrinsics
+void serializeCameraInfo(TimestampNs timestampNs, const std::string& frameId, int32_t width, int32_t height,
+                         const CameraCalibration& calibration, std::vector<uint8_t>& out);
+
+}  // namespace ros2
+}  // namespace nativesensor
@@ -0,0 +1,267 @@
+#include "session_exporter.h"
+
+#include <android/log.h>
+#include <chrono>
+#include <cstdio>
+#include <pthread.h>
+#include <utility>
+
+#include "calibration_store.h"
+#include "ros2_messages.h"
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.Export";
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, kLogTag, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+namespace {
+
+// Producers never signal the writer; it wakes on its own. 10 ms is ~16 IMU
+// samples and at most one frame per camera.
+constexpr auto kPollInterval = std::chrono::milliseconds(10);
+
+constexpr const char* kImuFrameId = "imu";
+
+std::string formatFloats(const float* values, size_t count) {
+    std::string text;
+    char number[32];
+    for (size_t i = 0; i < count; ++i) {
+        std::snprintf(number, sizeof(number), "%s%.9g", i > 0 ? " " : "", static_cast<double>(values[i]));
+        text += number;
+    }
+    return text;
+}
+
+std::string cameraFrameId(const std::string& cameraId) {
+    return "camera_" + cameraId;
+}
+
+}  // namespace
+
+SessionExporter::SessionExporter(std::string path, const CalibrationStore& calibration,
+                                 const SessionExportConfig& config)
+    : path_(std::move(path)),
+      calibration_(calibration),
+      config_(config),
+      imuQueue_(config.imuQueueCapacity),
+      frameQueue_(config.frameQueueCapacity) {
+    McapWriterOptions options;
+    options.compression = config_.compression;
+    options.chunkSize = config_.chunkSize;
+    opened_ = writer_.open(path_, options);
+    if (opened_) {
+        imuSchema_ = writer_.addSchema(ros2::kImuSchemaName, "ros2msg", ros2::kImuSchema);
+        imageSchema_ = writer_.addSchema(ros2::kImageSchemaName, "ros2msg", ros2::kImageSchema);
+        cameraInfoSchema_ = writer_.addSchema(ros2::kCameraInfoSchemaName, "ros2msg", ros2::kCameraInfoSchema);
+        accelChannel_ = writer_.addChannel(imuSchema_, "/imu/accel", "cdr");
+        gyroChannel_ = writer_.addChannel(imuSchema_, "/imu/gyro", "cdr");
+        opened_ = imuSchema_ != 0 && imageSchema_ != 0 && cameraInfoSchema_ != 0;
+    }
+    if (!opened_) {
+        LOGE("Failed to create export file %s", path_.c_str());
+        finished_ = true;
+        closed_.store(true, std::memory_order_relaxed);
+        return;
+    }
+    LOGI("Exporting session to %s (%s)", path_.c_str(),
+         config_.compression == McapCompression::Lz4 ? "lz4" : "uncompressed");
+    thread_ = std::thread(&SessionExporter::writerLoop, this);
+}
+
+SessionExporter::~SessionExporter() {
+    finish();
+}
+
+void SessionExporter::addImuSample(const ImuSample& sample) noexcept {
+    if (closed_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (!imuQueue_.tryPush(sample)) {
+        droppedImu_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void SessionExporter::addFrame(const FrameRef& frame) {
+    if (!frame || closed_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    const FrameMetadata& metadata = frame->metadata;
+    if (config_.frameIntervalNs > 0) {
+        auto [it, inserted] = lastFrameNs_.try_emplace(metadata.cameraId, metadata.timestampNs);
+        if (!inserted) {
+            if (metadata.timestampNs - it->second < config_.frameIntervalNs) {
+                return;
+            }
+            it->second = metadata.timestampNs;
+        }
+    }
+    if (!frameQueue_.tryPush(frame)) {
+        droppedFrames_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool SessionExporter::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (finished_) {
+            return result_;
+        }
+        finished_ = true;
+        stopping_ = true;
+    }
+    closed_.store(true, std::memory_order_relaxed);
+    cv_.notify_all();
+    thread_.join();
+
+    // The writer thread is gone: what it left in the queues is written here
+    const auto start = std::chrono::steady_clock::now();
+    bool ok = drain();
+    ok = writer_.finish() && ok;
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.busyMs += std::chrono::duration<float, std::milli>(elapsed).count();
+    const McapWriterStats& writerStats = writer_.stats();
+    stats_.chunks = writerStats.chunks;
+    stats_.uncompressedBytes = writerStats.uncompressedBytes;
+    stats_.bytesWritten = writerStats.bytesWritten;
+    stats_.compressMs = writerStats.compressMs;
+    result_ = ok;
+    if (ok) {
+        LOGI("Export finished: %s, %lld IMU samples, %lld frames, %lld bytes (%lld/%lld dropped)",
+             path_.c_str(), static_cast<long long>(stats_.imuSamples), static_cast<long long>(stats_.frames),
+             static_cast<long long>(stats_.bytesWritten),
+             static_cast<long long>(droppedImu_.load(std::memory_order_relaxed)),
+             static_cast<long long>(droppedFrames_.load(std::memory_order_relaxed)));
+    } else {
+        LOGE("Export to %s failed", path_.c_str());
+    }
+    return ok;
+}
+
+SessionExportStats SessionExporter::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SessionExportStats stats = stats_;
+    stats.droppedImu = droppedImu_.load(std::memory_order_relaxed);
+    stats.droppedFrames = droppedFrames_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void SessionExporter::writerLoop() {
+    pthread_setname_np(pthread_self(), "ns-export");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        cv_.wait_for(lock, kPollInterval, [this] { return stopping_; });
+        lock.unlock();
+        const auto start = std::chrono::steady_clock::now();
+        if (!drain() && !failed_) {
+            failed_ = true;
+            LOGE("Writing %s failed; further data is discarded", path_.c_str());
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        lock.lock();
+
+        stats_.busyMs += std::chrono::duration<float, std::milli>(elapsed).count();
+        const McapWriterStats& writerStats = writer_.stats();
+        stats_.chunks = writerStats.chunks;
+        stats_.uncompressedBytes = writerStats.uncompressedBytes;
+        stats_.bytesWritten = writerStats.bytesWritten;
+        stats_.compressMs = writerStats.compressMs;
+    }
+}
+
+bool SessionExporter::drain() {
+    bool ok = !failed_;
+    int64_t imuSamples = 0;
+    int64_t frames = 0;
+
+    ImuSample sample;
+    while (imuQueue_.tryPop(sample)) {
+        if (ok && writeImu(sample)) {
+            ++imuSamples;
+        } else {
+            ok = false;
+        }
+    }
+    FrameRef frame;
+    while (frameQueue_.tryPop(frame)) {
+        if (ok && writeFrame(frame)) {
+            ++frames;
+        } else {
+            ok = false;
+        }
+        frame = FrameRef{};     // Back to the camera's pool right away
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.imuSamples += imuSamples;
+    stats_.frames += frames;
+    return ok;
+}
+
+bool SessionExporter::writeImu(const ImuSample& sample) {
+    const bool gyro = sample.sensorType == SensorType::Gyroscope;
+    ros2::serializeImu(sample, kImuFrameId, message_);
+    return writer_.writeMessage(gyro ? gyroChannel_ : accelChannel_, sample.timestampNs,
+                                message_.data(), message_.size());
+}
+
+bool SessionExporter::writeFrame(const FrameRef& frame) {
+    const FrameMetadata& metadata = frame->metadata;
+    const std::string frameId = cameraFrameId(metadata.cameraId);
+    CameraChannels& channels = cameraChannels(metadata.cameraId);
+    const CameraCalibration calibration = calibration_.calibration(metadata.cameraId).value_or(CameraCalibration{});
+
+    if (!channels.calibrationWritten) {
+        // Once per camera, at the stream size the frames come in
+        McapWriter::KeyValues values = {
+            {"camera_id", metadata.cameraId},
+            {"width", std::to_string(frame->width())},
+            {"height", std::to_string(frame->height())},
+        };
+        if (calibration.hasIntrinsics) {
+            const PinholeIntrinsics k = scaledIntrinsics(calibration, frame->width(), frame->height());
+            const float intrinsics[5] = {k.fx, k.fy, k.cx, k.cy, k.skew};
+            values.emplace_back("intrinsics", formatFloats(intrinsics, 5));     // fx fy cx cy skew
+        }
+        if (calibration.hasDistortion) {
+            values.emplace_back("distortion", formatFloats(calibration.distortion, 5));    // k1 k2 k3 p1 p2
+        }
+        if (const auto pose = calibration_.imuFromCamera(metadata.cameraId)) {
+            const float rotation[4] = {pose->rotation.w, pose->rotation.x, pose->rotation.y, pose->rotation.z};
+            const float translation[3] = {pose->translation.x, pose->translation.y, pose->translation.z};
+            values.emplace_back("imu_from_camera.rotation", formatFloats(rotation, 4));     // w x y z
+            values.emplace_back("imu_from_camera.translation", formatFloats(translation, 3));
+        }
+        if (!writer_.writeMetadata("calibration/" + metadata.cameraId, values)) {
+            return false;
+        }
+        channels.calibrationWritten = true;
+    }
+
+    ros2::serializeImage(metadata.timestampNs, frameId, frame->data(), frame->width(), frame->height(),
+                         frame->stride(), message_);
+    if (!writer_.writeMessage(channels.image, metadata.timestampNs, message_.data(), message_.size())) {
+        return false;
+    }
+    ros2::serializeCameraInfo(metadata.timestampNs, frameId, frame->width(), frame->height(),
+                              calibration, message_);
+    return writer_.writeMessage(channels.info, metadata.timestampNs, message_.data(), message_.size());
+}
+
+SessionExporter::CameraChannels& SessionExporter::cameraChannels(const std::string& cameraId) {
+    auto [it, inserted] = cameras_.try_emplace(cameraId);
+    if (inserted) {
+        const std::string topic = "/camera/" + cameraId;
+        it->second.image = writer_.addChannel(imageSchema_, topic + "/image_raw", "cdr");
+        it->second.info = writer_.addChannel(cameraInfoSchema_, topic + "/camera_info", "cdr");
+    }
+    return it->second;
+}
+
+}  // namespace nativesensor
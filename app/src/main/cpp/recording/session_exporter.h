@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "frame_pool.h"
+#include "imu_data.h"
+#include "mcap_writer.h"
+#include "sensor_types.h"
+
+namespace nativesensor {
+
+class CalibrationStore;
+
+struct SessionExportConfig {
+    McapCompression compression = McapCompression::Lz4;
+    size_t chunkSize = 1 << 20;         // Uncompressed bytes per MCAP chunk
+    int64_t frameIntervalNs = 0;        // Minimum spacing of exported frames per camera; 0 = all
+    size_t imuQueueCapacity = 8192;     // ~5 s of both IMU streams at 800 Hz
+    size_t frameQueueCapacity = 4;      // Also bounds the analysis buffers held back from the camera
+};
+
+/// Exporter counters
+struct SessionExportStats {
+    int64_t imuSamples = 0;             // Written
+    int64_t frames = 0;
+    int64_t droppedImu = 0;             // Queue full: the writer thread fell behind
+    int64_t droppedFrames = 0;
+    int64_t chunks = 0;
+    int64_t uncompressedBytes = 0;
+    int64_t bytesWritten = 0;
+    float compressMs = 0.0f;            // Total time spent compressing
+    float busyMs = 0.0f;                // Total writer-thread time serializing, compressing and writing
+};
+
+/// Streams a capture session into an MCAP file that ROS 2 tools (rosbag2
+/// with the MCAP storage plugin, Foxglove) open directly.
+///
+/// Topics: "/imu/accel" and "/imu/gyro" (sensor_msgs/msg/Imu, frame_id
+/// "imu"), "/camera/<id>/image_raw" (sensor_msgs/msg/Image, mono8) and
+/// "/camera/<id>/camera_info" (sensor_msgs/msg/CameraInfo) per camera, all in
+/// CDR. Each camera's calibration, including its pose in the IMU frame, is
+/// also written once as a "calibration/<id>" metadata record.
+///
+/// addImuSample() and addFrame() only push into lock-free queues (frames
+/// by reference to their pool buffer); serialization, compression and file
+/// I/O run on the exporter's own thread, which polls the queues. When it
+/// falls behind, new data is dropped and counted, never waited for.
+/// addImuSample() and addFrame() each have a single caller thread.
+class SessionExporter {
+public:
+    SessionExporter(std::string path, const CalibrationStore& calibration,
+                    const SessionExportConfig& config = {});
+    ~SessionExporter();
+
+    SessionExporter(const SessionExporter&) = delete;
+    SessionExporter& operator=(const SessionExporter&) = delete;
+
+    /// False if the file could not be created
+    [[nodiscard]]
+    bool ok() const noexcept { return opened_; }
+
+    void addImuSample(const ImuSample& sample) noexcept;
+    void addFrame(const FrameRef& frame);
+
+    /// Write what is queued, the summary and the footer, and publish the
+    /// file; later samples are ignored. Returns false on I/O errors.
+    bool finish();
+
+    [[nodiscard]]
+    SessionExportStats getStats() const;
+
+private:
+    struct CameraChannels {
+        uint16_t image = 0;
+        uint16_t info = 0;
+        bool calibrationWritten = false;
+    };
+
+    void writerLoop();
+    [[nodiscard]] bool drain();
+    [[nodiscard]] bool writeImu(const ImuSample& sample);
+    [[nodiscard]] bool writeFrame(const FrameRef& frame);
+    [[nodiscard]] CameraChannels& cameraChannels(const std::string& cameraId);
+
+    const std::string path_;
+    const CalibrationStore& calibration_;
+    const SessionExportConfig config_;
+
+    BoundedQueue<ImuSample> imuQueue_;
+    BoundedQueue<FrameRef> frameQueue_;
+    std::atomic<int64_t> droppedImu_{0};
+    std::atomic<int64_t> droppedFrames_{0};
+    std::atomic<bool> closed_{false};
+    std::unordered_map<std::string, TimestampNs> lastFrameNs_;  // addFrame() thread
+    bool opened_ = false;
+
+    // Writer thread only
+    McapWriter writer_;
+    bool failed_ = false;
+    uint16_t imuSchema_ = 0;
+    uint16_t imageSchema_ = 0;
+    uint16_t cameraInfoSchema_ = 0;
+    uint16_t accelChannel_ = 0;
+    uint16_t gyroChannel_ = 0;
+    std::unordered_map<std::string, CameraChannels> cameras_;
+    std::vector<uint8_t> message_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+    bool finished_ = false;
+    bool result_ = false;
+    SessionExportStats stats_;
+    std::thread thread_;
+};
+
+}  // namespace nativesensor
@@ -0,0 +1,87 @@
+#include "session_metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace nativesensor {
+
+namespace {
+
+constexpr float kNsToMs = 1e-6f;
+
+// Frame intervals averaged before gaps are counted, then slow smoothing
+constexpr int32_t kPeriodWarmupFrames = 8;
+constexpr float kPeriodSmoothing = 1.0f / 32.0f;
+
+}  // namespace
+
+SessionMetrics::SessionMetrics(std::string directory) : store_(std::move(directory)) {
+    accel_.series = store_.openSeries("imu.accel", {"x", "y", "z", "intervalMs"});
+    gyro_.series = store_.openSeries("imu.gyro", {"x", "y", "z", "intervalMs"});
+}
+
+void SessionMetrics::addFrame(const FrameMetadata& frame) {
+    auto [it, added] = cameras_.try_emplace(frame.cameraId);
+    CameraState& camera = it->second;
+    if (added) {
+        camera.series = store_.openSeries("camera." + frame.cameraId,
+                                          {"exposureMs", "latencyMs", "intervalMs", "droppedFrames"},
+                                          {"frameNumber"});
+    }
+    if (!camera.series) {
+        return;
+    }
+
+    float intervalMs = TimeSeries::missing();
+    float dropped = TimeSeries::missing();
+    const TimestampNs intervalNs = frame.timestampNs - camera.lastNs;
+    if (camera.lastNs != 0 && intervalNs > 0) {
+        const auto interval = static_cast<float>(intervalNs);
+        intervalMs = interval * kNsToMs;
+        bool gap = false;
+        if (camera.periodSamples >= kPeriodWarmupFrames) {
+            dropped = std::max(std::round(interval / camera.periodNs) - 1.0f, 0.0f);
+            gap = dropped > 0.0f;
+        }
+        // Intervals spanning drops don't feed the period estimate
+        if (!gap) {
+            ++camera.periodSamples;
+            const float alpha = std::max(1.0f / static_cast<float>(camera.periodSamples), kPeriodSmoothing);
+            camera.periodNs += alpha * (interval - camera.periodNs);
+        }
+    }
+    camera.lastNs = frame.timestampNs;
+
+    const float exposureMs = frame.exposureTimeNs > 0
+        ? static_cast<float>(frame.exposureTimeNs) * kNsToMs : TimeSeries::missing();
+    const float latencyMs = frame.resultNs > frame.timestampNs
+        ? static_cast<float>(frame.resultNs - frame.timestampNs) * kNsToMs : TimeSeries::missing();
+    const float values[4] = {exposureMs, latencyMs, intervalMs, dropped};
+    camera.series->append(frame.timestampNs, values, &frame.frameNumber);
+}
+
+void SessionMetrics::addImuSample(const ImuSample& sample) {
+    if (sample.sensorType == SensorType::Accelerometer) {
+        addImu(accel_, sample);
+    } else if (sample.sensorType == SensorType::Gyroscope) {
+        addImu(gyro_, sample);
+    }
+}
+
+void SessionMetrics::addImu(ImuState& state, const ImuSample& sample) {
+    if (!state.series) {
+        return;
+    }
+    const TimestampNs intervalNs = sample.timestampNs - state.lastNs;
+    const float values[4] = {
+        sample.x,
+        sample.y,
+        sample.z,
+        state.lastNs != 0 && intervalNs > 0 ? static_cast<float>(intervalNs) * kNsToMs : TimeSeries::missing()
+    };
+    state.lastNs = sample.timestampNs;
+    state.series->append(sample.timestampNs, values);
+}
+
+}  // namespace nativesensor
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "camera_data.h"
+#include "imu_data.h"
+#include "sensor_types.h"
+#include "time_series_store.h"
+
+namespace nativesensor {
+
+/// Per-frame and per-sample metrics of a capture session, kept in a
+/// TimeSeriesStore for offline analysis.
+///
+/// Series "camera.<id>": exposureMs, latencyMs (sensor timestamp to capture
+/// result), intervalMs and droppedFrames (frames missing before this one,
+/// from the interval against the smoothed frame period), plus the int column
+/// frameNumber. Series "imu.accel" and "imu.gyro": x, y, z and intervalMs.
+/// Unknown values are TimeSeries::missing(). addFrame() and addImuSample()
+/// may run on two different threads, each with a single caller.
+class SessionMetrics {
+public:
+    explicit SessionMetrics(std::string directory);
+
+    SessionMetrics(const SessionMetrics&) = delete;
+    SessionMetrics& operator=(const SessionMetrics&) = delete;
+
+    void addFrame(const FrameMetadata& frame);
+    void addImuSample(const ImuSample& sample);
+
+    [[nodiscard]]
+    TimeSeriesStore& store() noexcept { return store_; }
+
+private:
+    struct CameraState {
+        TimeSeries* series = nullptr;
+        TimestampNs lastNs = 0;
+        float periodNs = 0.0f;          // Smoothed frame interval
+        int32_t periodSamples = 0;
+    };
+
+    struct ImuState {
+        TimeSeries* series = nullptr;
+        TimestampNs lastNs = 0;
+    };
+
+    void addImu(ImuState& state, const ImuSample& sample);
+
+    TimeSeriesStore store_;
+    std::unordered_map<std::string, CameraState> cameras_;
+    ImuState accel_;
+    ImuState gyro_;
+};
+
+}  // namespace nativesensor
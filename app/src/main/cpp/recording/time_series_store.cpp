@@ -0,0 +1,531 @@
+#include "time_series_store.h"
+
+#include <algorithm>
+#include <android/log.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+#include "file_utils.h"
+#include "time_utils.h"
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.TimeSeries";
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+namespace {
+
+// Column names of a series, one per line: the files only hold values, so a
+// reopen with another column list would misread (or overwrite) them
+constexpr const char* kColumnsFile = "columns.txt";
+
+// Boot the rows were written under; timestamps only compare within one boot
+constexpr const char* kBootIdFile = "boot_id";
+constexpr const char* kKernelBootId = "/proc/sys/kernel/random/boot_id";
+
+// Suffix of int column names in the column list
+constexpr const char* kIntSuffix = ":i64";
+
+bool makeDirectory(const std::string& path) {
+    return ::mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+/// Series names become directory names
+std::string fileName(const std::string& name) {
+    std::string out = name;
+    for (char& c : out) {
+        const bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                          c == '.' || c == '_' || c == '-';
+        if (!safe) {
+            c = '_';
+        }
+    }
+    return out;
+}
+
+std::string joinLines(const std::vector<std::string>& lines) {
+    std::string out;
+    for (const std::string& line : lines) {
+        out += line;
+        out += '\n';
+    }
+    return out;
+}
+
+/// Whole file, trailing newline dropped; empty if it can't be read
+std::string readLine(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return {};
+    }
+    std::string out;
+    char buffer[256];
+    ssize_t received = 0;
+    while ((received = ::read(fd, buffer, sizeof(buffer))) > 0) {
+        out.append(buffer, static_cast<size_t>(received));
+    }
+    ::close(fd);
+    if (received < 0) {
+        return {};
+    }
+    while (!out.empty() && (out.back() == '\n' || out.back() == '\r')) {
+        out.pop_back();
+    }
+    return out;
+}
+
+/// Replace `path` with `content` through a synced temporary file
+bool writeFileAtomically(const std::string& path, const std::string& content) {
+    const std::string tmpPath = path + ".tmp";
+    const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = writeAll(fd, content.data(), content.size()) && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok || ::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool fileExists(const std::string& path, off_t* size = nullptr) {
+    struct stat st{};
+    if (::stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    if (size) {
+        *size = st.st_size;
+    }
+    return true;
+}
+
+float percentile(std::vector<float>& values, size_t& sortedUpTo, float p) {
+    // Nearest rank; ranks are requested in increasing order, so each
+    // partition only has to look at what the previous one left above it
+    const auto rank = static_cast<size_t>(p * static_cast<float>(values.size() - 1) + 0.5f);
+    std::nth_element(values.begin() + static_cast<ptrdiff_t>(sortedUpTo),
+                     values.begin() + static_cast<ptrdiff_t>(rank), values.end());
+    sortedUpTo = rank;
+    return values[rank];
+}
+
+WindowAggregate summarize(std::vector<float>& values, TimestampNs startNs) {
+    WindowAggregate window;
+    window.startNs = startNs;
+    window.count = static_cast<int64_t>(values.size());
+    const auto [minIt, maxIt] = std::minmax_element(values.begin(), values.end());
+    window.min = *minIt;
+    window.max = *maxIt;
+    double sum = 0.0;
+    for (const float value : values) {
+        sum += value;
+    }
+    window.mean = static_cast<float>(sum / static_cast<double>(values.size()));
+    size_t sortedUpTo = 0;
+    window.p50 = percentile(values, sortedUpTo, 0.50f);
+    window.p95 = percentile(values, sortedUpTo, 0.95f);
+    window.p99 = percentile(values, sortedUpTo, 0.99f);
+    return window;
+}
+
+}  // namespace
+
+TimeSeries::TimeSeries(std::string name, std::string directory, std::vector<std::string> columns,
+                       std::vector<std::string> intColumns, std::string bootId)
+    : name_(std::move(name)), directory_(std::move(directory)), columnNames_(std::move(columns)),
+      intColumnNames_(std::move(intColumns)),
+      bootId_(bootId.empty() ? readLine(kKernelBootId) : std::move(bootId)),
+      values_(columnNames_.size()), intValues_(intColumnNames_.size()) {
+    if (!open()) {
+        return;
+    }
+    if (rowCount() > 0 && fromEarlierBoot() && (!archive() || !open())) {
+        return;
+    }
+    if (!bootId_.empty() && !writeFileAtomically(directory_ + "/" + kBootIdFile, bootId_ + "\n")) {
+        LOGE("Failed to record the boot of series %s", name_.c_str());
+    }
+    if (const size_t rows = rowCount(); rows > 0) {
+        LOGI("Series %s continues after %zu rows", name_.c_str(), rows);
+    }
+}
+
+TimeSeries::~TimeSeries() {
+    close();
+}
+
+bool TimeSeries::open() {
+    if (!makeDirectory(directory_) || !checkColumns() ||
+        !openColumn(timestamps_, directory_ + "/timestamp.i64", sizeof(TimestampNs))) {
+        LOGE("Failed to open series %s in %s", name_.c_str(), directory_.c_str());
+        return false;
+    }
+    for (size_t i = 0; i < values_.size(); ++i) {
+        if (!openColumn(values_[i], directory_ + "/" + fileName(columnNames_[i]) + ".f32", sizeof(float))) {
+            LOGE("Failed to open column %s of series %s", columnNames_[i].c_str(), name_.c_str());
+            return false;
+        }
+    }
+    for (size_t i = 0; i < intValues_.size(); ++i) {
+        if (!openColumn(intValues_[i], directory_ + "/" + fileName(intColumnNames_[i]) + ".i64",
+                        sizeof(int64_t))) {
+            LOGE("Failed to open column %s of series %s", intColumnNames_[i].c_str(), name_.c_str());
+            return false;
+        }
+    }
+
+    const size_t rows = recoverRows();
+    rows_.store(rows, std::memory_order_release);
+    lastNs_ = rows > 0 ? at<TimestampNs>(timestamps_, rows - 1) : 0;
+    valid_ = true;
+    return true;
+}
+
+bool TimeSeries::fromEarlierBoot() const {
+    const std::string stored = readLine(directory_ + "/" + kBootIdFile);
+    if (!stored.empty() && !bootId_.empty()) {
+        return stored != bootId_;
+    }
+    // Without both IDs: the boot-time clock starts over on a reboot
+    return lastNs_ > getBootTimeNs();
+}
+
+bool TimeSeries::archive() {
+    // The rows stay loadable offline, but new timestamps can't follow them
+    const std::string storedId = readLine(directory_ + "/" + kBootIdFile);
+    const std::string base = directory_ + ".boot-" + (storedId.empty() ? "unknown" : fileName(storedId));
+    std::string target = base;
+    for (int i = 1; fileExists(target); ++i) {
+        target = base + "-" + std::to_string(i);
+    }
+    close();
+    valid_ = false;
+    rows_.store(0, std::memory_order_release);
+    lastNs_ = 0;
+    if (::rename(directory_.c_str(), target.c_str()) != 0) {
+        LOGE("Failed to move series %s from an earlier boot to %s", name_.c_str(), target.c_str());
+        return false;
+    }
+    LOGI("Series %s was written under an earlier boot; moved it to %s", name_.c_str(), target.c_str());
+    return true;
+}
+
+bool TimeSeries::checkColumns() {
+    const std::string path = directory_ + "/" + kColumnsFile;
+    std::string expected = joinLines(columnNames_);
+    for (const std::string& column : intColumnNames_) {
+        expected += column + kIntSuffix + "\n";
+    }
+    off_t size = 0;
+    if (fileExists(path, &size)) {
+        std::string stored(static_cast<size_t>(size), '\0');
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        const bool read = fd >= 0 && readAll(fd, stored.data(), stored.size());
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        if (!read || stored != expected) {
+            LOGE("Series %s in %s was written with other columns; not reopening it", name_.c_str(),
+                 directory_.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // No list: a new series, or rows from before lists were kept, which are
+    // only continued if every requested column already has its file
+    off_t timestampBytes = 0;
+    if (fileExists(directory_ + "/timestamp.i64", &timestampBytes) && timestampBytes > 0) {
+        auto missing = [this](const std::vector<std::string>& columns, const char* extension) {
+            for (const std::string& column : columns) {
+                if (!fileExists(directory_ + "/" + fileName(column) + extension)) {
+                    LOGE("Series %s in %s has rows but no column %s; not reopening it", name_.c_str(),
+                         directory_.c_str(), column.c_str());
+                    return true;
+                }
+            }
+            return false;
+        };
+        if (missing(columnNames_, ".f32") || missing(intColumnNames_, ".i64")) {
+            return false;
+        }
+    }
+    return writeFileAtomically(path, expected);
+}
+
+bool TimeSeries::openColumn(Column& column, const std::string& path, size_t elementSize) {
+    column.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    column.elementSize = elementSize;
+    column.segments = std::make_unique<std::atomic<uint8_t*>[]>(kMaxSegments);
+    return column.fd >= 0;
+}
+
+size_t TimeSeries::recoverRows() {
+    // Shortest column wins; a crash leaves zeroed rows of the last segment
+    // behind, and a timestamp is never 0
+    auto fileRows = [](const Column& column) {
+        struct stat st{};
+        return ::fstat(column.fd, &st) == 0 ? static_cast<size_t>(st.st_size) / column.elementSize : 0;
+    };
+    size_t rows = fileRows(timestamps_);
+    for (const Column& column : values_) {
+        rows = std::min(rows, fileRows(column));
+    }
+    for (const Column& column : intValues_) {
+        rows = std::min(rows, fileRows(column));
+    }
+    rows = std::min(rows, kSegmentRows * kMaxSegments);
+
+    const size_t segments = (rows + kSegmentRows - 1) / kSegmentRows;
+    for (size_t segment = 0; segment < segments; ++segment) {
+        if (!mapSegment(segment)) {
+            rows = segment * kSegmentRows;
+            break;
+        }
+    }
+    while (rows > 0 && at<TimestampNs>(timestamps_, rows - 1) == 0) {
+        --rows;
+    }
+    return rows;
+}
+
+bool TimeSeries::mapSegment(size_t segment) {
+    if (segment >= kMaxSegments) {
+        return false;
+    }
+    auto map = [segment](Column& column) {
+        if (column.segments[segment].load(std::memory_order_relaxed)) {
+            return true;    // Mapped before another column failed
+        }
+        const size_t bytes = kSegmentRows * column.elementSize;
+        const auto offset = static_cast<off_t>(segment * bytes);
+        const auto end = offset + static_cast<off_t>(bytes);
+        struct stat st{};
+        if (::fstat(column.fd, &st) != 0 || (st.st_size < end && ::ftruncate(column.fd, end) != 0)) {
+            return false;
+        }
+        void* data = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, column.fd, offset);
+        if (data == MAP_FAILED) {
+            return false;
+        }
+        // Published before any row in it; rows_ orders it for readers
+        column.segments[segment].store(static_cast<uint8_t*>(data), std::memory_order_relaxed);
+        return true;
+    };
+
+    if (!map(timestamps_)) {
+        return false;
+    }
+    for (Column& column : values_) {
+        if (!map(column)) {
+            return false;
+        }
+    }
+    for (Column& column : intValues_) {
+        if (!map(column)) {
+            return false;
+        }
+    }
+    mappedSegments_ = std::max(mappedSegments_, segment + 1);
+    return true;
+}
+
+void TimeSeries::close() {
+    // Trim the preallocated tail so the files hold exactly the rows; a
+    // series that failed to open leaves its files alone
+    const size_t rows = rows_.load(std::memory_order_acquire);
+    auto closeColumn = [this, rows](Column& column) {
+        if (column.fd < 0) {
+            return;
+        }
+        for (size_t segment = 0; segment < kMaxSegments; ++segment) {
+            if (uint8_t* data = column.segments[segment].exchange(nullptr, std::memory_order_relaxed)) {
+                ::munmap(data, kSegmentRows * column.elementSize);
+            }
+        }
+        if (valid_ && ::ftruncate(column.fd, static_cast<off_t>(rows * column.elementSize)) != 0) {
+            LOGE("Failed to trim a column to %zu rows", rows);
+        }
+        ::close(column.fd);
+        column.fd = -1;
+    };
+    closeColumn(timestamps_);
+    for (Column& column : values_) {
+        closeColumn(column);
+    }
+    for (Column& column : intValues_) {
+        closeColumn(column);
+    }
+    mappedSegments_ = 0;
+}
+
+bool TimeSeries::append(TimestampNs timestampNs, const float* values, const int64_t* intValues) noexcept {
+    const size_t row = rows_.load(std::memory_order_relaxed);
+    const size_t segment = row / kSegmentRows;
+    if (!valid_ || timestampNs <= 0 || timestampNs < lastNs_ || (!intValues_.empty() && !intValues) ||
+        (segment >= mappedSegments_ && !mapSegment(segment))) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const size_t index = row % kSegmentRows;
+    reinterpret_cast<TimestampNs*>(timestamps_.segments[segment].load(std::memory_order_relaxed))[index] =
+        timestampNs;
+    for (size_t i = 0; i < values_.size(); ++i) {
+        reinterpret_cast<float*>(values_[i].segments[segment].load(std::memory_order_relaxed))[index] = values[i];
+    }
+    for (size_t i = 0; i < intValues_.size(); ++i) {
+        reinterpret_cast<int64_t*>(intValues_[i].segments[segment].load(std::memory_order_relaxed))[index] =
+            intValues[i];
+    }
+    lastNs_ = timestampNs;
+    rows_.store(row + 1, std::memory_order_release);
+    return true;
+}
+
+int32_t TimeSeries::columnIndex(const std::string& column) const noexcept {
+    const auto it = std::find(columnNames_.begin(), columnNames_.end(), column);
+    return it != columnNames_.end() ? static_cast<int32_t>(it - columnNames_.begin()) : -1;
+}
+
+int32_t TimeSeries::intColumnIndex(const std::string& column) const noexcept {
+    const auto it = std::find(intColumnNames_.begin(), intColumnNames_.end(), column);
+    return it != intColumnNames_.end() ? static_cast<int32_t>(it - intColumnNames_.begin()) : -1;
+}
+
+size_t TimeSeries::lowerBound(TimestampNs timestampNs, size_t rows) const noexcept {
+    size_t first = 0;
+    size_t count = rows;
+    while (count > 0) {
+        const size_t half = count / 2;
+        if (at<TimestampNs>(timestamps_, first + half) < timestampNs) {
+            first += half + 1;
+            count -= half + 1;
+        } else {
+            count = half;
+        }
+    }
+    return first;
+}
+
+template<typename T>
+size_t TimeSeries::queryColumn(const Column& data, TimestampNs beginNs, TimestampNs endNs,
+                               std::vector<TimestampNs>* timestamps, std::vector<T>* values) const {
+    const size_t rows = rowCount();
+    size_t count = 0;
+    for (size_t row = lowerBound(beginNs, rows); row < rows; ++row, ++count) {
+        const TimestampNs timestampNs = at<TimestampNs>(timestamps_, row);
+        if (timestampNs > endNs) {
+            break;
+        }
+        if (timestamps) {
+            timestamps->push_back(timestampNs);
+        }
+        if (values) {
+            values->push_back(at<T>(data, row));
+        }
+    }
+    return count;
+}
+
+size_t TimeSeries::query(int32_t column, TimestampNs beginNs, TimestampNs endNs,
+                         std::vector<TimestampNs>* timestamps, std::vector<float>* values) const {
+    if (column < 0 || static_cast<size_t>(column) >= values_.size()) {
+        return 0;
+    }
+    return queryColumn(values_[static_cast<size_t>(column)], beginNs, endNs, timestamps, values);
+}
+
+size_t TimeSeries::queryInt(int32_t column, TimestampNs beginNs, TimestampNs endNs,
+                            std::vector<TimestampNs>* timestamps, std::vector<int64_t>* values) const {
+    if (column < 0 || static_cast<size_t>(column) >= intValues_.size()) {
+        return 0;
+    }
+    return queryColumn(intValues_[static_cast<size_t>(column)], beginNs, endNs, timestamps, values);
+}
+
+std::vector<WindowAggregate> TimeSeries::aggregate(int32_t column, TimestampNs beginNs, TimestampNs endNs,
+                                                   int64_t windowNs) const {
+    std::vector<WindowAggregate> result;
+    if (column < 0 || static_cast<size_t>(column) >= values_.size()) {
+        return result;
+    }
+    const Column& data = values_[static_cast<size_t>(column)];
+    const size_t rows = rowCount();
+
+    std::vector<float> window;
+    TimestampNs windowStartNs = beginNs;
+    for (size_t row = lowerBound(beginNs, rows); row < rows; ++row) {
+        const TimestampNs timestampNs = at<TimestampNs>(timestamps_, row);
+        if (timestampNs > endNs) {
+            break;
+        }
+        const TimestampNs startNs = windowNs > 0 ? beginNs + (timestampNs - beginNs) / windowNs * windowNs : beginNs;
+        if (startNs != windowStartNs && !window.empty()) {
+            result.push_back(summarize(window, windowStartNs));
+            window.clear();
+        }
+        windowStartNs = startNs;
+        const float value = at<float>(data, row);
+        if (!isMissing(value)) {
+            window.push_back(value);
+        }
+    }
+    if (!window.empty()) {
+        result.push_back(summarize(window, windowStartNs));
+    }
+    return result;
+}
+
+TimeSeriesStore::TimeSeriesStore(std::string directory) : directory_(std::move(directory)) {
+    if (!makeDirectory(directory_)) {
+        LOGE("Failed to create %s", directory_.c_str());
+    }
+}
+
+TimeSeries* TimeSeriesStore::openSeries(const std::string& name, const std::vector<std::string>& columns,
+                                         const std::vector<std::string>& intColumns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto it = series_.find(name); it != series_.end()) {
+        if (it->second->columns() != columns || it->second->intColumns() != intColumns) {
+            LOGE("Series %s is open with other columns", name.c_str());
+            return nullptr;
+        }
+        return it->second.get();
+    }
+    auto series = std::make_unique<TimeSeries>(name, directory_ + "/" + fileName(name), columns, intColumns);
+    if (!series->valid()) {
+        return nullptr;
+    }
+    auto* ptr = series.get();
+    series_[name] = std::move(series);
+    return ptr;
+}
+
+TimeSeries* TimeSeriesStore::find(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = series_.find(name);
+    return it != series_.end() ? it->second.get() : nullptr;
+}
+
+std::vector<TimeSeries*> TimeSeriesStore::series() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<TimeSeries*> result;
+    result.reserve(series_.size());
+    for (const auto& [name, series] : series_) {
+        result.push_back(series.get());
+    }
+    return result;
+}
+
+}  // namespace nativesensor
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sensor_types.h"
+
+namespace nativesensor {
+
+/// Aggregates of one column over one time window
+struct WindowAggregate {
+    TimestampNs startNs = 0;
+    int64_t count = 0;
+    float min = 0.0f;
+    float max = 0.0f;
+    float mean = 0.0f;
+    float p50 = 0.0f;
+    float p95 = 0.0f;
+    float p99 = 0.0f;
+};
+
+/// One append-only series: a timestamp column plus named float columns and,
+/// for counters that a float would round, named int64 columns.
+///
+/// Each column is a plain little-endian array in its own file (timestamp.i64,
+/// <column>.f32, <column>.i64) so recordings can be loaded offline with
+/// nothing more than numpy.fromfile; columns.txt lists the column names.
+/// Files grow by fixed segments that are mapped once and never moved, so
+/// readers work on the live mapping while the writer appends: a row becomes
+/// visible when the row count is published. Timestamps must not decrease; a
+/// query binary-searches them. The boot-time clock restarts on a reboot, so
+/// rows written under another boot are moved to <directory>.boot-<id> and the
+/// series starts over. append() has a single writer, queries may run on any
+/// thread.
+class TimeSeries {
+public:
+    static constexpr size_t kSegmentRows = 65536;
+    static constexpr size_t kMaxSegments = 4096;       // 268M rows
+
+    /// Value for "unknown" (a NaN); aggregates leave it out. Checked on the
+    /// bits since release builds use -ffast-math.
+    [[nodiscard]]
+    static float missing() noexcept { return std::numeric_limits<float>::quiet_NaN(); }
+
+    [[nodiscard]]
+    static bool isMissing(float value) noexcept {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return (bits & 0x7f800000u) == 0x7f800000u && (bits & 0x007fffffu) != 0;
+    }
+
+    /// Open or create the series in `directory`, continuing after any rows
+    /// already there. A series written with other columns is not reopened
+    /// (valid() is false): its rows would be misread or overwritten.
+    /// `bootId` defaults to the kernel's boot ID.
+    TimeSeries(std::string name, std::string directory, std::vector<std::string> columns,
+               std::vector<std::string> intColumns = {}, std::string bootId = {});
+    ~TimeSeries();
+
+    TimeSeries(const TimeSeries&) = delete;
+    TimeSeries& operator=(const TimeSeries&) = delete;
+
+    [[nodiscard]]
+    bool valid() const noexcept { return valid_; }
+
+    /// Append one row with a value per column and, if there are int columns,
+    /// per int column; false if out of order or the files can't grow
+    bool append(TimestampNs timestampNs, const float* values, const int64_t* intValues = nullptr) noexcept;
+
+    [[nodiscard]]
+    const std::string& name() const noexcept { return name_; }
+
+    [[nodiscard]]
+    const std::vector<std::string>& columns() const noexcept { return columnNames_; }
+
+    [[nodiscard]]
+    const std::vector<std::string>& intColumns() const noexcept { return intColumnNames_; }
+
+    /// Index of a column, -1 if unknown
+    [[nodiscard]]
+    int32_t columnIndex(const std::string& column) const noexcept;
+
+    /// Index of an int column, -1 if unknown
+    [[nodiscard]]
+    int32_t intColumnIndex(const std::string& column) const noexcept;
+
+    [[nodiscard]]
+    size_t rowCount() const noexcept { return rows_.load(std::memory_order_acquire); }
+
+    /// Rows rejected by append()
+    [[nodiscard]]
+    int64_t rejected() const noexcept { return rejected_.load(std::memory_order_relaxed); }
+
+    /// Raw rows with timestamps in [beginNs, endNs]; returns the count
+    size_t query(int32_t column, TimestampNs beginNs, TimestampNs endNs,
+                 std::vector<TimestampNs>* timestamps, std::vector<float>* values) const;
+
+    /// Raw rows of an int column with timestamps in [beginNs, endNs]
+    size_t queryInt(int32_t column, TimestampNs beginNs, TimestampNs endNs,
+                    std::vector<TimestampNs>* timestamps, std::vector<int64_t>* values) const;
+
+    /// Min/max/mean/percentiles of a column per `windowNs` window of
+    /// [beginNs, endNs]; windowNs <= 0 gives one window. Empty windows are skipped.
+    [[nodiscard]]
+    std::vector<WindowAggregate> aggregate(int32_t column, TimestampNs beginNs, TimestampNs endNs,
+                                           int64_t windowNs) const;
+
+private:
+    struct Column {
+        int fd = -1;
+        size_t elementSize = 0;
+        std::unique_ptr<std::atomic<uint8_t*>[]> segments;
+    };
+
+    [[nodiscard]] bool open();
+    [[nodiscard]] bool checkColumns();
+    [[nodiscard]] bool fromEarlierBoot() const;
+    [[nodiscard]] bool archive();
+    [[nodiscard]] bool openColumn(Column& column, const std::string& path, size_t elementSize);
+    [[nodiscard]] bool mapSegment(size_t segment);
+    [[nodiscard]] size_t recoverRows();
+    void close();
+
+    template<typename T>
+    [[nodiscard]] const T& at(const Column& column, size_t row) const noexcept {
+        const uint8_t* base = column.segments[row / kSegmentRows].load(std::memory_order_relaxed);
+        return reinterpret_cast<const T*>(base)[row % kSegmentRows];
+    }
+
+    /// First row with a timestamp >= timestampNs among `rows`
+    [[nodiscard]] size_t lowerBound(TimestampNs timestampNs, size_t rows) const noexcept;
+
+    template<typename T>
+    size_t queryColumn(const Column& data, TimestampNs beginNs, TimestampNs endNs,
+                       std::vector<TimestampNs>* timestamps, std::vector<T>* values) const;
+
+    const std::string name_;
+    const std::string directory_;
+    const std::vector<std::string> columnNames_;
+    const std::vector<std::string> intColumnNames_;
+    const std::string bootId_;
+    bool valid_ = false;
+
+    Column timestamps_;
+    std::vector<Column> values_;
+    std::vector<Column> intValues_;
+    size_t mappedSegments_ = 0;
+    std::atomic<size_t> rows_{0};
+    TimestampNs lastNs_ = 0;
+    std::atomic<int64_t> rejected_{0};
+};
+
+/// A directory of time series, one subdirectory each
+class TimeSeriesStore {
+public:
+    explicit TimeSeriesStore(std::string directory);
+
+    TimeSeriesStore(const TimeSeriesStore&) = delete;
+    TimeSeriesStore& operator=(const TimeSeriesStore&) = delete;
+
+    [[nodiscard]]
+    const std::string& directory() const noexcept { return directory_; }
+
+    /// Open or create a series; an open one is returned as is. Nullptr if
+    /// its files can't be created or the series has other columns.
+    TimeSeries* openSeries(const std::string& name, const std::vector<std::string>& columns,
+                           const std::vector<std::string>& intColumns = {});
+
+    /// Nullptr if not open
+    [[nodiscard]]
+    TimeSeries* find(const std::string& name) const;
+
+    [[nodiscard]]
+    std::vector<TimeSeries*> series() const;
+
+private:
+    const std::string directory_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::unique_ptr<TimeSeries>> series_;
+};
+
+}  // namespace nativesensor
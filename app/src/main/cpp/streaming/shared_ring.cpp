@@ -0,0 +1,323 @@
+#include "shared_ring.h"
+
+#include <android/log.h>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <type_traits>
+#include <unistd.h>
+
+#if defined(__ANDROID__)
+#include <android/sharedmem.h>
+#elif !defined(F_SEAL_FUTURE_WRITE)
+#define F_SEAL_FUTURE_WRITE 0x0010     // Linux 5.1
+#endif
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.SharedRing";
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, kLogTag, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+namespace {
+
+constexpr size_t kWordSize = sizeof(uint64_t);
+
+uint32_t roundUpPow2(uint32_t value) {
+    uint32_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Shared (not FUTEX_PRIVATE) futex ops: waiters live in other processes.
+// Waiting only needs read access to the word.
+long futexWake(std::atomic<uint32_t>* word) noexcept {
+    return ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+long futexWait(const std::atomic<uint32_t>* word, uint32_t expected, const timespec* timeout) noexcept {
+    auto* address = const_cast<uint32_t*>(reinterpret_cast<const uint32_t*>(word));
+    return ::syscall(SYS_futex, address, FUTEX_WAIT, expected, timeout, nullptr, 0);
+}
+
+/// Words of the slot of `message`; slotCount is a power of two
+template<typename Byte>
+auto* slotWords(Byte* slots, size_t slotCount, size_t slotSize, uint64_t message) noexcept {
+    using Word = std::conditional_t<std::is_const_v<Byte>, const std::atomic<uint64_t>, std::atomic<uint64_t>>;
+    const size_t index = static_cast<size_t>(message & (slotCount - 1));
+    return reinterpret_cast<Word*>(slots + index * slotSize);
+}
+
+}  // namespace
+
+SharedRingWriter::~SharedRingWriter() {
+    close();
+}
+
+bool SharedRingWriter::create(const std::string& name, uint32_t slotCount, uint32_t payloadCapacity,
+                              uint32_t payloadType) {
+    close();
+    slotCount = roundUpPow2(slotCount < 2 ? 2 : slotCount);
+    const size_t payloadWords = (payloadCapacity + kWordSize - 1) / kWordSize;
+    const size_t slotSize = ((shm::kSlotHeaderWords + payloadWords) * kWordSize + 63) & ~size_t{63};
+    const size_t headerSize = sizeof(shm::RingHeader);
+    const size_t size = headerSize + slotSize * slotCount;
+
+#if defined(__ANDROID__)
+    fd_ = ASharedMemory_create(name.c_str(), size);
+#else
+    fd_ = ::memfd_create(name.c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd_ >= 0 && ::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+#endif
+    if (fd_ < 0) {
+        LOGE("Failed to create shared memory %s (%zu bytes): %s", name.c_str(), size, std::strerror(errno));
+        return false;
+    }
+    void* mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapped == MAP_FAILED) {
+        LOGE("Failed to map shared memory %s: %s", name.c_str(), std::strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    base_ = static_cast<uint8_t*>(mapped);
+    mappedSize_ = size;
+
+    header_ = new (base_) shm::RingHeader{};
+    std::memcpy(header_->magic, shm::kMagic, sizeof(shm::kMagic));
+    header_->version = shm::kFormatVersion;
+    header_->headerSize = static_cast<uint32_t>(headerSize);
+    header_->slotSize = static_cast<uint32_t>(slotSize);
+    header_->slotCount = slotCount;
+    header_->payloadType = payloadType;
+    header_->payloadCapacity = static_cast<uint32_t>(payloadWords * kWordSize);
+    for (size_t word = 0; word < slotSize * slotCount / kWordSize; ++word) {
+        new (base_ + headerSize + word * kWordSize) std::atomic<uint64_t>(0);
+    }
+    slots_ = base_ + headerSize;
+    slotCount_ = slotCount;
+    slotSize_ = slotSize;
+    payloadCapacity_ = payloadWords * kWordSize;
+    next_ = 0;
+
+    // Read-only for every later mapping, consumers' included; ours stays
+    // writable (ashmem regions can't be resized once mapped)
+#if defined(__ANDROID__)
+    if (ASharedMemory_setProt(fd_, PROT_READ) != 0) {
+        LOGW("Could not make %s read-only for consumers: %s", name.c_str(), std::strerror(errno));
+    }
+#else
+    if (::fcntl(fd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_FUTURE_WRITE | F_SEAL_SEAL) != 0) {
+        LOGW("Could not seal %s against writes: %s", name.c_str(), std::strerror(errno));
+        if (::fcntl(fd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+            LOGW("Could not seal the size of %s: %s", name.c_str(), std::strerror(errno));
+        }
+    }
+#endif
+    LOGI("Shared ring %s: %u slots of %zu bytes", name.c_str(), slotCount, slotSize);
+    return true;
+}
+
+void SharedRingWriter::close() {
+    if (base_) {
+        ::munmap(base_, mappedSize_);
+        base_ = nullptr;
+        header_ = nullptr;
+        slots_ = nullptr;
+        mappedSize_ = 0;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool SharedRingWriter::publish(const void* payload, size_t size) noexcept {
+    if (!header_ || size > payloadCapacity_) {
+        return false;
+    }
+    std::atomic<uint64_t>* slot = slotWords(slots_, slotCount_, slotSize_, next_);
+    slot[0].store(2 * next_ + 1, std::memory_order_relaxed);
+    // Release on each word keeps the odd sequence ordered before the payload
+    slot[1].store(size, std::memory_order_release);
+    const auto* bytes = static_cast<const uint8_t*>(payload);
+    for (size_t offset = 0, word = shm::kSlotHeaderWords; offset < size; offset += kWordSize, ++word) {
+        uint64_t value = 0;
+        std::memcpy(&value, bytes + offset, size - offset < kWordSize ? size - offset : kWordSize);
+        slot[word].store(value, std::memory_order_release);
+    }
+    slot[0].store(2 * next_ + 2, std::memory_order_release);
+
+    ++next_;
+    header_->published.store(next_, std::memory_order_release);
+    // A reader that read `wakeup` before this bump either sees the message
+    // or has its FUTEX_WAIT fail on the changed word. Readers can't announce
+    // themselves in read-only memory, so every publish wakes.
+    header_->wakeup.fetch_add(1, std::memory_order_release);
+    futexWake(&header_->wakeup);
+    return true;
+}
+
+uint64_t SharedRingWriter::published() const noexcept {
+    return next_;
+}
+
+SharedRingReader::~SharedRingReader() {
+    close();
+}
+
+bool SharedRingReader::open(int fd) {
+    close();
+#if defined(__ANDROID__)
+    const size_t size = ASharedMemory_getSize(fd);
+#else
+    struct stat info{};
+    const size_t size = ::fstat(fd, &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+#endif
+    if (size < sizeof(shm::RingHeader)) {
+        LOGE("Shared ring fd %d too small (%zu bytes)", fd, size);
+        return false;
+    }
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        LOGE("Failed to map shared ring fd %d: %s", fd, std::strerror(errno));
+        return false;
+    }
+    base_ = static_cast<const uint8_t*>(mapped);
+    mappedSize_ = size;
+    header_ = reinterpret_cast<const shm::RingHeader*>(base_);
+
+    const size_t headerSize = header_->headerSize;
+    const size_t slotSize = header_->slotSize;
+    const size_t slotCount = header_->slotCount;
+    const size_t payloadCapacity = header_->payloadCapacity;
+    const bool valid = std::memcmp(header_->magic, shm::kMagic, sizeof(shm::kMagic)) == 0 &&
+        header_->version == shm::kFormatVersion &&
+        headerSize >= sizeof(shm::RingHeader) && headerSize % kWordSize == 0 &&
+        slotCount >= 2 && (slotCount & (slotCount - 1)) == 0 &&
+        slotSize % kWordSize == 0 &&
+        slotSize >= shm::kSlotHeaderWords * kWordSize + payloadCapacity &&
+        headerSize + slotSize * slotCount <= size;
+    if (!valid) {
+        LOGE("Shared ring fd %d has an unknown layout", fd);
+        close();
+        return false;
+    }
+    slots_ = base_ + headerSize;
+    slotCount_ = slotCount;
+    slotSize_ = slotSize;
+    payloadCapacity_ = payloadCapacity;
+    payloadType_ = header_->payloadType;
+    next_ = header_->published.load(std::memory_order_acquire);
+    dropped_ = 0;
+    return true;
+}
+
+void SharedRingReader::close() {
+    if (base_) {
+        ::munmap(const_cast<uint8_t*>(base_), mappedSize_);
+        base_ = nullptr;
+        header_ = nullptr;
+        slots_ = nullptr;
+        mappedSize_ = 0;
+        payloadType_ = 0;
+    }
+}
+
+bool SharedRingReader::read(void* out, size_t capacity, size_t& size) noexcept {
+    if (!header_) {
+        return false;
+    }
+    const uint64_t slotCount = slotCount_;
+    while (true) {
+        const uint64_t published = header_->published.load(std::memory_order_acquire);
+        if (next_ >= published) {
+            return false;
+        }
+        if (published - next_ > slotCount) {
+            // Lapped: resume half a ring behind the writer so it doesn't lap us again right away
+            const uint64_t resume = published - slotCount / 2;
+            dropped_ += resume - next_;
+            next_ = resume;
+        }
+
+        const std::atomic<uint64_t>* slot = slotWords(slots_, slotCount_, slotSize_, next_);
+        const uint64_t sequence = slot[0].load(std::memory_order_acquire);
+        if (sequence == 2 * next_ + 2) {
+            const size_t messageSize = static_cast<size_t>(slot[1].load(std::memory_order_acquire));
+            // A torn size is caught by the re-check, but must not copy past the slot
+            const size_t limit = capacity < payloadCapacity_ ? capacity : payloadCapacity_;
+            const size_t copied = messageSize < limit ? messageSize : limit;
+            auto* bytes = static_cast<uint8_t*>(out);
+            for (size_t offset = 0, word = shm::kSlotHeaderWords; offset < copied; offset += kWordSize, ++word) {
+                // Acquire on each word keeps the re-check below after the copy
+                const uint64_t value = slot[word].load(std::memory_order_acquire);
+                std::memcpy(bytes + offset, &value, copied - offset < kWordSize ? copied - offset : kWordSize);
+            }
+            if (slot[0].load(std::memory_order_relaxed) == sequence) {
+                ++next_;
+                size = messageSize;
+                return true;
+            }
+        }
+        // Overwritten before or during the copy: the writer is a lap ahead
+        const uint64_t resume = header_->published.load(std::memory_order_acquire) - slotCount / 2;
+        if (resume > next_) {
+            dropped_ += resume - next_;
+            next_ = resume;
+        } else {
+            ++dropped_;
+            ++next_;
+        }
+    }
+}
+
+bool SharedRingReader::wait(int timeoutMs) noexcept {
+    if (!header_) {
+        return false;
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    bool available = false;
+    while (true) {
+        // Read before the check so a publish in between fails the wait
+        const uint32_t wakeup = header_->wakeup.load(std::memory_order_acquire);
+        available = header_->published.load(std::memory_order_acquire) > next_;
+        if (available) {
+            break;
+        }
+        timespec timeout{};
+        if (timeoutMs >= 0) {
+            const auto remainingNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remainingNs <= 0) {
+                break;
+            }
+            timeout.tv_sec = static_cast<time_t>(remainingNs / 1'000'000'000);
+            timeout.tv_nsec = static_cast<long>(remainingNs % 1'000'000'000);
+        }
+        // Returns at once if a message was published since `wakeup` was read.
+        // The wake of a message already read (its publish raced our last
+        // read) goes round again rather than returning false early.
+        futexWait(&header_->wakeup, wakeup, timeoutMs >= 0 ? &timeout : nullptr);
+    }
+    return available;
+}
+
+}  // namespace nativesensor
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace nativesensor {
+
+/// Layout of a shared-memory broadcast ring:
+///   [RingHeader][slot * slotCount]
+/// A slot is slotSize bytes of 64-bit words: sequence, payload size, then
+/// the payload. Message n goes to slot n % slotCount; its sequence is
+/// 2n + 1 while being written and 2n + 2 once complete. All words are
+/// accessed atomically, so readers detect a slot overwritten mid-copy.
+/// Only the writer writes; consumers get the region read-only.
+namespace shm {
+
+constexpr char kMagic[8] = {'N', 'S', 'R', 'I', 'N', 'G', '\0', '\0'};
+constexpr uint32_t kFormatVersion = 3;
+
+struct alignas(64) RingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;            // Offset of slot 0
+    uint32_t slotSize;              // Bytes, a multiple of 64
+    uint32_t slotCount;             // Power of two
+    uint32_t payloadType;           // stream::MessageType of the payloads
+    uint32_t payloadCapacity;       // Largest payload in bytes
+    alignas(64) std::atomic<uint64_t> published;    // Messages written so far
+    alignas(64) std::atomic<uint32_t> wakeup;       // Futex word, bumped per message
+};
+
+constexpr size_t kSlotHeaderWords = 2;  // Sequence, payload size
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Ring words must be address-free");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Futex word must be address-free");
+static_assert(sizeof(RingHeader) == 192, "RingHeader layout");
+
+}  // namespace shm
+
+/// Single-producer side of a broadcast ring in shared memory (ASharedMemory
+/// on Android, memfd elsewhere) that any number of processes consume.
+///
+/// fd() is handed to consumers (binder, SCM_RIGHTS). The region is made
+/// read-only for every mapping after the writer's own (ASharedMemory_setProt,
+/// F_SEAL_FUTURE_WRITE on memfd) and sealed against resizing, and the writer
+/// keeps the layout in its own members, so a consumer can't corrupt the ring
+/// or steer the writer's stores. The writer never waits: a slow reader is
+/// lapped and loses the oldest messages. A publish wakes readers blocked in
+/// SharedRingReader::wait() through a futex on the header.
+class SharedRingWriter {
+public:
+    SharedRingWriter() = default;
+    ~SharedRingWriter();
+
+    SharedRingWriter(const SharedRingWriter&) = delete;
+    SharedRingWriter& operator=(const SharedRingWriter&) = delete;
+
+    /// slotCount is rounded up to a power of two
+    bool create(const std::string& name, uint32_t slotCount, uint32_t payloadCapacity, uint32_t payloadType);
+    void close();
+
+    /// Shared memory descriptor for consumers; -1 if not created
+    [[nodiscard]]
+    int fd() const noexcept { return fd_; }
+
+    /// Copy a payload (at most payloadCapacity bytes) into the next slot.
+    /// Only one thread may publish.
+    bool publish(const void* payload, size_t size) noexcept;
+
+    [[nodiscard]]
+    uint64_t published() const noexcept;
+
+private:
+    int fd_ = -1;
+    uint8_t* base_ = nullptr;
+    size_t mappedSize_ = 0;
+    shm::RingHeader* header_ = nullptr;
+    uint8_t* slots_ = nullptr;
+    size_t slotCount_ = 0;
+    size_t slotSize_ = 0;
+    size_t payloadCapacity_ = 0;
+    uint64_t next_ = 0;
+};
+
+/// Consumer side: maps a ring read-only and follows it from the newest
+/// message on. One reader per thread; any number per ring.
+class SharedRingReader {
+public:
+    SharedRingReader() = default;
+    ~SharedRingReader();
+
+    SharedRingReader(const SharedRingReader&) = delete;
+    SharedRingReader& operator=(const SharedRingReader&) = delete;
+
+    /// Map the ring behind `fd` (the descriptor stays owned by the caller)
+    bool open(int fd);
+    void close();
+
+    /// Copy the next message into `out`; false if there is none yet. When
+    /// the writer lapped this reader, it skips ahead and counts the loss.
+    bool read(void* out, size_t capacity, size_t& size) noexcept;
+
+    /// Block until a message newer than the last one read is published or
+    /// timeoutMs passes (< 0: no timeout); true if one is available
+    bool wait(int timeoutMs) noexcept;
+
+    [[nodiscard]]
+    uint64_t dropped() const noexcept { return dropped_; }
+
+    [[nodiscard]]
+    uint32_t payloadType() const noexcept { return payloadType_; }
+
+private:
+    const uint8_t* base_ = nullptr;
+    size_t mappedSize_ = 0;
+    const shm::RingHeader* header_ = nullptr;
+    // Layout checked at open(); the header isn't trusted again after that
+    const uint8_t* slots_ = nullptr;
+    size_t slotCount_ = 0;
+    size_t slotSize_ = 0;
+    size_t payloadCapacity_ = 0;
+    uint32_t payloadType_ = 0;
+    uint64_t next_ = 0;
+    uint64_t dropped_ = 0;
+};
+
+}  // namespace nativesensor
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nativesensor {
+
+/// Wire format of the sensor stream socket (StreamServer):
+///   [MessageHeader + payload] * n
+/// in both directions. The server greets every client with Hello; a client
+/// sends Subscribe (any number of times) to choose its streams and gets
+/// nothing else until it does. Little-endian, fields naturally aligned.
+namespace stream {
+
+constexpr char kMagic[4] = {'N', 'S', 'S', 'T'};
+constexpr uint32_t kProtocolVersion = 1;
+
+enum class MessageType : uint16_t {
+    Hello = 1,                      // Server -> client
+    Subscribe = 2,                  // Client -> server
+    Imu = 3,
+    Frame = 4,
+};
+
+// Stream bits of Hello::streams and Subscribe::streams
+constexpr uint32_t kStreamImu = 1u << 0;
+constexpr uint32_t kStreamFrames = 1u << 1;
+constexpr uint32_t kAllStreams = kStreamImu | kStreamFrames;
+
+struct MessageHeader {
+    MessageType type;
+    uint16_t payloadSize;           // Bytes following this header
+    uint32_t dropped;               // Messages this client lost (queue full) since the previous one
+};
+
+struct HelloMessage {
+    char magic[4];
+    uint32_t version;
+    uint32_t streams;               // Available streams
+    uint32_t reserved;
+};
+
+/// Replaces the client's subscription; 0 pauses it
+struct SubscribeMessage {
+    uint32_t streams;
+};
+
+/// One accelerometer or gyroscope sample
+struct ImuMessage {
+    int64_t timestampNs;
+    int32_t sensorType;             // SensorType
+    float x;
+    float y;
+    float z;
+};
+
+/// Capture result of one camera frame, followed by cameraIdLength bytes of id
+struct FrameMessage {
+    int64_t timestampNs;            // Start of exposure
+    int64_t frameNumber;
+    int64_t exposureTimeNs;         // 0 = unknown
+    int64_t rollingShutterSkewNs;   // 0 = unknown
+    int64_t resultNs;               // Boot time the capture result arrived (0 = unknown)
+    int32_t width;
+    int32_t height;
+    int32_t format;
+    uint16_t cameraIdLength;
+    uint16_t reserved;
+};
+
+constexpr size_t kMaxCameraIdLength = 32;
+constexpr size_t kMaxMessageSize = sizeof(MessageHeader) + sizeof(FrameMessage) + kMaxCameraIdLength;
+
+static_assert(sizeof(MessageHeader) == 8, "MessageHeader layout");
+static_assert(sizeof(HelloMessage) == 16, "HelloMessage layout");
+static_assert(sizeof(SubscribeMessage) == 4, "SubscribeMessage layout");
+static_assert(sizeof(ImuMessage) == 24, "ImuMessage layout");
+static_assert(sizeof(FrameMessage) == 56, "FrameMessage layout");
+
+}  // namespace stream
+
+}  // namespace nativesensor
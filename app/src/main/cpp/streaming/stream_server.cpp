@@ -0,0 +1,385 @@
+#include "stream_server.h"
+
+#include <algorithm>
+#include <android/log.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.Stream";
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, kLogTag, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+namespace {
+
+// Producers never signal the server; while anyone is subscribed it polls
+// the ingest queues this often, which bounds the added latency
+constexpr int kPollIntervalMs = 2;
+
+constexpr size_t kMaxClients = 8;
+constexpr size_t kBatchBytes = 64 * 1024;          // Per send()
+// Kernel send buffer per client (doubled by the kernel): what piles up there
+// is never dropped and only ages, so it is kept to ~0.3 s of IMU and the
+// per-client queue does the dropping
+constexpr int kSocketBufferBytes = 8 * 1024;
+constexpr size_t kDroppedOffset = offsetof(stream::MessageHeader, dropped);
+
+template<typename Payload>
+void encode(stream::MessageType type, const Payload& payload, uint8_t* out, size_t extra = 0) {
+    const stream::MessageHeader header{type, static_cast<uint16_t>(sizeof(Payload) + extra), 0};
+    std::memcpy(out, &header, sizeof(header));
+    std::memcpy(out + sizeof(header), &payload, sizeof(payload));
+}
+
+}  // namespace
+
+StreamServer::~StreamServer() {
+    stop();
+}
+
+bool StreamServer::start(const std::string& name) {
+    stop();
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    const bool abstract = !name.empty() && name[0] == '@';
+    if (name.size() < 2 || name.size() >= sizeof(address.sun_path)) {
+        LOGE("Invalid socket name '%s'", name.c_str());
+        return false;
+    }
+    // Abstract names start with a NUL byte and are not NUL-terminated
+    std::memcpy(address.sun_path, name.data(), name.size());
+    socklen_t addressLength = sizeof(address);
+    if (abstract) {
+        address.sun_path[0] = '\0';
+        addressLength = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + name.size());
+    } else {
+        ::unlink(name.c_str());     // Left behind by a previous run
+    }
+
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0 ||
+        ::bind(listenFd_, reinterpret_cast<const sockaddr*>(&address), addressLength) != 0 ||
+        ::listen(listenFd_, static_cast<int>(kMaxClients)) != 0) {
+        LOGE("Failed to listen on %s: %s", name.c_str(), std::strerror(errno));
+        if (listenFd_ >= 0) {
+            ::close(listenFd_);
+            listenFd_ = -1;
+        }
+        return false;
+    }
+    wakeFd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd_ < 0) {
+        LOGE("eventfd failed: %s", std::strerror(errno));
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+
+    name_ = name;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_ = {};
+    }
+    thread_ = std::thread(&StreamServer::serverLoop, this);
+    LOGI("Streaming on %s", name_.c_str());
+    return true;
+}
+
+void StreamServer::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    const uint64_t one = 1;
+    if (::write(wakeFd_, &one, sizeof(one)) != sizeof(one)) {
+        LOGW("Failed to wake the server thread: %s", std::strerror(errno));
+    }
+    thread_.join();
+    ::close(wakeFd_);
+    ::close(listenFd_);
+    wakeFd_ = -1;
+    listenFd_ = -1;
+    if (name_[0] != '@') {
+        ::unlink(name_.c_str());
+    }
+
+    subscribed_.store(0, std::memory_order_relaxed);
+    WireMessage message;
+    while (imuQueue_.tryPop(message) || frameQueue_.tryPop(message)) {}
+    LOGI("Stopped streaming on %s", name_.c_str());
+}
+
+void StreamServer::publish(const ImuSample& sample) noexcept {
+    if ((subscribed_.load(std::memory_order_relaxed) & stream::kStreamImu) == 0) {
+        return;
+    }
+    WireMessage message;
+    message.streams = stream::kStreamImu;
+    message.size = sizeof(stream::MessageHeader) + sizeof(stream::ImuMessage);
+    const stream::ImuMessage payload{sample.timestampNs, static_cast<int32_t>(sample.sensorType),
+                                     sample.x, sample.y, sample.z};
+    encode(stream::MessageType::Imu, payload, message.bytes);
+    ingest(message, imuQueue_);
+}
+
+void StreamServer::publish(const FrameMetadata& frame) noexcept {
+    if ((subscribed_.load(std::memory_order_relaxed) & stream::kStreamFrames) == 0) {
+        return;
+    }
+    const size_t idLength = std::min(frame.cameraId.size(), stream::kMaxCameraIdLength);
+    WireMessage message;
+    message.streams = stream::kStreamFrames;
+    message.size = static_cast<uint16_t>(sizeof(stream::MessageHeader) + sizeof(stream::FrameMessage) + idLength);
+    const stream::FrameMessage payload{frame.timestampNs, frame.frameNumber, frame.exposureTimeNs,
+                                       frame.rollingShutterSkewNs, frame.resultNs,
+                                       frame.width, frame.height, frame.format,
+                                       static_cast<uint16_t>(idLength), 0};
+    encode(stream::MessageType::Frame, payload, message.bytes, idLength);
+    std::memcpy(message.bytes + sizeof(stream::MessageHeader) + sizeof(payload), frame.cameraId.data(), idLength);
+    ingest(message, frameQueue_);
+}
+
+void StreamServer::ingest(const WireMessage& message, BoundedQueue<WireMessage>& queue) noexcept {
+    if (queue.tryPush(message)) {
+        return;
+    }
+    // Full: the server thread is behind, so the oldest message goes
+    WireMessage oldest;
+    if (queue.tryPop(oldest)) {
+        ingestDropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!queue.tryPush(message)) {
+        ingestDropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+StreamServerStats StreamServer::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    StreamServerStats stats = stats_;
+    stats.ingestDropped = ingestDropped_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void StreamServer::serverLoop() {
+    pthread_setname_np(pthread_self(), "ns-stream");
+    std::vector<pollfd> fds;
+    while (true) {
+        fds.clear();
+        fds.push_back({wakeFd_, POLLIN, 0});
+        fds.push_back({listenFd_, POLLIN, 0});
+        for (const Client& client : clients_) {
+            const bool pending = client.outputOffset < client.output.size() || !client.queue->empty();
+            fds.push_back({client.fd, static_cast<short>(POLLIN | (pending ? POLLOUT : 0)), 0});
+        }
+        const int timeout = subscribed_.load(std::memory_order_relaxed) != 0 ? kPollIntervalMs : -1;
+        if (::poll(fds.data(), fds.size(), timeout) < 0 && errno != EINTR) {
+            LOGE("poll failed: %s", std::strerror(errno));
+            break;
+        }
+        if (fds[0].revents != 0) {
+            break;
+        }
+
+        // Requests and hang-ups of the clients polled above
+        const size_t polled = clients_.size();
+        std::vector<bool> closed(polled, false);
+        for (size_t i = 0; i < polled; ++i) {
+            if ((fds[i + 2].revents & (POLLIN | POLLHUP | POLLERR)) != 0) {
+                closed[i] = !readRequests(clients_[i]);
+            }
+        }
+        if ((fds[1].revents & POLLIN) != 0) {
+            acceptClients();
+            closed.resize(clients_.size(), false);
+        }
+
+        distribute(imuQueue_);
+        distribute(frameQueue_);
+        for (size_t i = 0; i < clients_.size(); ++i) {
+            if (!closed[i] && !flush(clients_[i])) {
+                closed[i] = true;
+            }
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < clients_.size(); ++i) {
+            if (closed[i]) {
+                ::close(clients_[i].fd);
+                continue;
+            }
+            if (kept != i) {
+                clients_[kept] = std::move(clients_[i]);
+            }
+            ++kept;
+        }
+        if (kept != clients_.size()) {
+            LOGI("%zu clients disconnected", clients_.size() - kept);
+            clients_.resize(kept);
+        }
+        updateSubscriptions();
+    }
+
+    for (const Client& client : clients_) {
+        ::close(client.fd);
+    }
+    clients_.clear();
+    updateSubscriptions();
+}
+
+void StreamServer::acceptClients() {
+    while (true) {
+        const int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                LOGW("accept failed: %s", std::strerror(errno));
+            }
+            return;
+        }
+        if (clients_.size() >= kMaxClients) {
+            LOGW("Rejecting client: %zu connected", clients_.size());
+            ::close(fd);
+            continue;
+        }
+
+        if (::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &kSocketBufferBytes, sizeof(kSocketBufferBytes)) != 0) {
+            LOGW("SO_SNDBUF failed: %s", std::strerror(errno));
+        }
+        Client client;
+        client.fd = fd;
+        client.queue = std::make_unique<RingBuffer<WireMessage, kClientQueueCapacity>>();
+        WireMessage hello;
+        hello.size = sizeof(stream::MessageHeader) + sizeof(stream::HelloMessage);
+        stream::HelloMessage payload{};
+        std::memcpy(payload.magic, stream::kMagic, sizeof(payload.magic));
+        payload.version = stream::kProtocolVersion;
+        payload.streams = stream::kAllStreams;
+        encode(stream::MessageType::Hello, payload, hello.bytes);
+        enqueue(client, hello);
+        clients_.push_back(std::move(client));
+
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        ++stats_.accepted;
+        LOGI("Client connected (%zu total)", clients_.size());
+    }
+}
+
+bool StreamServer::readRequests(Client& client) {
+    constexpr size_t kHeaderSize = sizeof(stream::MessageHeader);
+    while (true) {
+        const ssize_t received = ::recv(client.fd, client.input + client.inputSize,
+                                        sizeof(client.input) - client.inputSize, MSG_DONTWAIT);
+        if (received == 0) {
+            return false;       // Hung up
+        }
+        if (received < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        client.inputSize += static_cast<size_t>(received);
+
+        if (client.inputSize >= kHeaderSize) {
+            stream::MessageHeader header{};
+            std::memcpy(&header, client.input, kHeaderSize);
+            if (header.type != stream::MessageType::Subscribe ||
+                header.payloadSize != sizeof(stream::SubscribeMessage)) {
+                LOGW("Unexpected request type %u (%u bytes), disconnecting",
+                     static_cast<unsigned>(header.type), header.payloadSize);
+                return false;
+            }
+        }
+        if (client.inputSize == sizeof(client.input)) {
+            stream::SubscribeMessage request{};
+            std::memcpy(&request, client.input + kHeaderSize, sizeof(request));
+            client.streams = request.streams & stream::kAllStreams;
+            client.inputSize = 0;
+        }
+    }
+}
+
+void StreamServer::enqueue(Client& client, const WireMessage& message) {
+    if (client.queue->size() == kClientQueueCapacity - 1) {
+        ++client.dropped;   // pushOverwrite() drops the oldest
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        ++stats_.dropped;
+    }
+    client.queue->pushOverwrite(message);
+}
+
+void StreamServer::distribute(BoundedQueue<WireMessage>& queue) {
+    int64_t published = 0;
+    WireMessage message;
+    while (queue.tryPop(message)) {
+        ++published;
+        for (Client& client : clients_) {
+            if ((client.streams & message.streams) != 0) {
+                enqueue(client, message);
+            }
+        }
+    }
+    if (published > 0) {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.published += published;
+    }
+}
+
+bool StreamServer::flush(Client& client) {
+    int64_t sent = 0;
+    int64_t bytesSent = 0;
+    bool ok = true;
+    WireMessage message;
+    while (true) {
+        if (client.outputOffset == client.output.size()) {
+            client.output.clear();
+            client.outputOffset = 0;
+            while (client.output.size() < kBatchBytes && client.queue->pop(message)) {
+                // Drops are reported in the first header after them
+                std::memcpy(message.bytes + kDroppedOffset, &client.dropped, sizeof(client.dropped));
+                client.dropped = 0;
+                client.output.insert(client.output.end(), message.bytes, message.bytes + message.size);
+                ++sent;
+            }
+            if (client.output.empty()) {
+                break;
+            }
+        }
+        const ssize_t written = ::send(client.fd, client.output.data() + client.outputOffset,
+                                       client.output.size() - client.outputOffset, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ok = errno == EAGAIN || errno == EWOULDBLOCK;
+            break;
+        }
+        client.outputOffset += static_cast<size_t>(written);
+        bytesSent += written;
+    }
+
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    stats_.sent += sent;
+    stats_.bytesSent += bytesSent;
+    return ok;
+}
+
+void StreamServer::updateSubscriptions() {
+    uint32_t streams = 0;
+    for (const Client& client : clients_) {
+        streams |= client.streams;
+    }
+    subscribed_.store(streams, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    stats_.clients = static_cast<int64_t>(clients_.size());
+}
+
+}  // namespace nativesensor
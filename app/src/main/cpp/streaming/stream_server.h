@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "camera_data.h"
+#include "imu_data.h"
+#include "ring_buffer.h"
+#include "stream_protocol.h"
+
+namespace nativesensor {
+
+/// Server counters
+struct StreamServerStats {
+    int64_t clients = 0;                // Connected now
+    int64_t accepted = 0;               // Ever
+    int64_t published = 0;              // Messages taken from the producers
+    int64_t sent = 0;                   // Messages written to clients
+    int64_t dropped = 0;                // Oldest messages dropped from full client queues
+    int64_t ingestDropped = 0;          // Oldest messages dropped before reaching the server thread
+    int64_t bytesSent = 0;
+};
+
+/// Serves live IMU samples and camera capture results to local processes
+/// over a Unix domain socket (stream_protocol.h), e.g. desktop tools through
+/// `adb forward tcp:<port> localabstract:<name>`.
+///
+/// publish() encodes the message and pushes it into a lock-free queue,
+/// only when some client is subscribed to its stream; when the queue is
+/// full the oldest message goes. The server thread moves messages into a
+/// bounded send queue per client and writes with non-blocking sends; a
+/// client that reads too slowly loses its oldest messages (counted in the
+/// next header it gets) and never holds back capture or other clients.
+/// publish() may be called from any thread.
+class StreamServer {
+public:
+    StreamServer() = default;
+    ~StreamServer();
+
+    StreamServer(const StreamServer&) = delete;
+    StreamServer& operator=(const StreamServer&) = delete;
+
+    /// Listen on `name`: a filesystem path, or an abstract socket name with
+    /// a leading '@'. Returns false if the socket cannot be bound.
+    bool start(const std::string& name);
+    void stop();
+
+    [[nodiscard]]
+    bool running() const noexcept { return thread_.joinable(); }
+
+    void publish(const ImuSample& sample) noexcept;
+    void publish(const FrameMetadata& frame) noexcept;
+
+    [[nodiscard]]
+    StreamServerStats getStats() const;
+
+private:
+    static constexpr size_t kClientQueueCapacity = 2048;
+
+    /// One encoded message (header included)
+    struct WireMessage {
+        uint32_t streams = 0;           // The stream bit it belongs to
+        uint16_t size = 0;
+        uint8_t bytes[stream::kMaxMessageSize];
+    };
+
+    struct Client {
+        int fd = -1;
+        uint32_t streams = 0;           // Subscription
+        uint32_t dropped = 0;           // Since the last message sent
+        std::unique_ptr<RingBuffer<WireMessage, kClientQueueCapacity>> queue;
+        std::vector<uint8_t> output;    // Batch being sent
+        size_t outputOffset = 0;
+        uint8_t input[sizeof(stream::MessageHeader) + sizeof(stream::SubscribeMessage)];
+        size_t inputSize = 0;
+    };
+
+    void serverLoop();
+    void acceptClients();
+    [[nodiscard]] bool readRequests(Client& client);
+    [[nodiscard]] bool flush(Client& client);
+    void enqueue(Client& client, const WireMessage& message);
+    void distribute(BoundedQueue<WireMessage>& queue);
+    void updateSubscriptions();
+    void ingest(const WireMessage& message, BoundedQueue<WireMessage>& queue) noexcept;
+
+    std::string name_;
+    int listenFd_ = -1;
+    int wakeFd_ = -1;
+    std::atomic<uint32_t> subscribed_{0};       // Union of all clients' streams
+    BoundedQueue<WireMessage> imuQueue_{4096};
+    BoundedQueue<WireMessage> frameQueue_{256};
+    std::atomic<int64_t> ingestDropped_{0};
+
+    std::vector<Client> clients_;               // Server thread only
+    mutable std::mutex statsMutex_;
+    StreamServerStats stats_;
+    std::thread thread_;
+};
+
+}  // namespace nativesensor
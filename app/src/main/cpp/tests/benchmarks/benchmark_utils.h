@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace nativesensor::benchmarks {
+
+/// Value below which `fraction` of the samples fall (nearest rank); sorts `samples`
+inline int64_t percentile(std::vector<int64_t>& samples, double fraction) {
+    if (samples.empty()) {
+        return 0;
+    }
+    const size_t rank = std::min(samples.size() - 1,
+                                 static_cast<size_t>(fraction * static_cast<double>(samples.size())));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(rank), samples.end());
+    return samples[rank];
+}
+
+/// Report p50/p99/p99.9/max of nanosecond samples as microsecond counters
+inline void reportLatencyUs(benchmark::State& state, std::vector<int64_t>& samplesNs) {
+    if (samplesNs.empty()) {
+        return;
+    }
+    auto us = [](int64_t ns) { return static_cast<double>(ns) / 1000.0; };
+    state.counters["p50_us"] = us(percentile(samplesNs, 0.50));
+    state.counters["p99_us"] = us(percentile(samplesNs, 0.99));
+    state.counters["p999_us"] = us(percentile(samplesNs, 0.999));
+    state.counters["max_us"] = us(*std::max_element(samplesNs.begin(), samplesNs.end()));
+}
+
+/// Directory under $TMPDIR for benchmarks that write files; removed with everything in it
+class ScratchDirectory {
+public:
+    ScratchDirectory() {
+        const char* base = std::getenv("TMPDIR");
+        std::string pattern = std::string(base && *base ? base : "/tmp") + "/nativesensor-bench-XXXXXX";
+        if (mkdtemp(pattern.data())) {
+            path_ = pattern;
+        }
+    }
+
+    ~ScratchDirectory() {
+        if (!path_.empty()) {
+            std::error_code error;
+            std::filesystem::remove_all(path_, error);
+        }
+    }
+
+    ScratchDirectory(const ScratchDirectory&) = delete;
+    ScratchDirectory& operator=(const ScratchDirectory&) = delete;
+
+    [[nodiscard]]
+    const std::string& path() const noexcept { return path_; }
+
+private:
+    std::string path_;
+};
+
+}  // namespace nativesensor::benchmarks
@@ -0,0 +1,205 @@
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark_utils.h"
+#include "eskf.h"
+#include "geometry.h"
+#include "pose_predictor.h"
+#include "seqlock.h"
+#include "time_utils.h"
+
+namespace nativesensor::benchmarks {
+namespace {
+
+constexpr int64_t kGyroPeriodNs = 2'500'000;     // 400 Hz
+constexpr float kPi = 3.14159265358979f;
+
+/// Head turn about a fixed tilted axis: angle(t) = A sin(2 pi f t)
+struct HeadTurn {
+    Vec3 axis = normalized(Vec3(0.2f, 1.0f, 0.1f));
+    float amplitude = 0.8f;     // rad
+    float frequency = 1.5f;     // Hz
+
+    [[nodiscard]]
+    float angle(float t) const { return amplitude * std::sin(2.0f * kPi * frequency * t); }
+
+    [[nodiscard]]
+    Vec3 rate(float t) const {
+        return axis * (amplitude * 2.0f * kPi * frequency * std::cos(2.0f * kPi * frequency * t));
+    }
+
+    /// Orientation relative to t = 0, as the predictor integrates it
+    [[nodiscard]]
+    Quat orientation(float t) const { return quat::fromRotationVector(axis * angle(t)); }
+};
+
+float seconds(int64_t ns) {
+    return static_cast<float>(ns) / static_cast<float>(kNsPerSecond);
+}
+
+ImuSample gyroAt(const HeadTurn& motion, int64_t timestampNs) {
+    const Vec3 rate = motion.rate(seconds(timestampNs));
+    return {rate.x, rate.y, rate.z, timestampNs, SensorType::Gyroscope};
+}
+
+/// Cost of one predictPose() on an idle producer
+void BM_PosePredictorQuery(benchmark::State& state) {
+    PosePredictor predictor;
+    const HeadTurn motion;
+    for (int64_t t = 0; t <= kNsPerSecond / 4; t += kGyroPeriodNs) {
+        predictor.addSample(gyroAt(motion, t));
+    }
+    TimestampNs targetNs = kNsPerSecond / 4 + 20 * kNsPerMs;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(predictor.predictPose(targetNs));
+        targetNs += 1;
+    }
+}
+BENCHMARK(BM_PosePredictorQuery);
+
+/// Cost of one predictPose() while the IMU thread publishes at full speed
+void BM_PosePredictorQueryContended(benchmark::State& state) {
+    PosePredictor predictor;
+    const HeadTurn motion;
+    std::atomic<bool> done{false};
+    std::thread producer([&] {
+        for (int64_t t = 0; !done.load(std::memory_order_relaxed); t += kGyroPeriodNs) {
+            predictor.addSample(gyroAt(motion, t));
+        }
+    });
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(predictor.predictPose(kNsPerSecond));
+    }
+    done = true;
+    producer.join();
+}
+BENCHMARK(BM_PosePredictorQueryContended)->UseRealTime();
+
+/// Cost of integrating and publishing one gyro sample
+void BM_PosePredictorAddSample(benchmark::State& state) {
+    PosePredictor predictor;
+    const HeadTurn motion;
+    int64_t t = 0;
+    for (auto _ : state) {
+        predictor.addSample(gyroAt(motion, t));
+        t += kGyroPeriodNs;
+    }
+}
+BENCHMARK(BM_PosePredictorAddSample);
+
+/// Prediction error at a horizon (ms) over a 1.5 Hz, 0.8 rad head turn;
+/// reports mean, p99 and max error in degrees
+void BM_PosePredictorError(benchmark::State& state) {
+    const int64_t horizonNs = state.range(0) * kNsPerMs;
+    const HeadTurn motion;
+    std::vector<int64_t> errorsMicroDeg;
+    double totalDeg = 0.0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        PosePredictor predictor;
+        errorsMicroDeg.clear();
+        totalDeg = 0.0;
+        state.ResumeTiming();
+        for (int64_t t = 0; t < 4 * kNsPerSecond; t += kGyroPeriodNs) {
+            predictor.addSample(gyroAt(motion, t));
+            const PredictedPose pose = predictor.predictPose(t + horizonNs);
+            // Log map rather than acos: keeps precision at small angles
+            const Quat error = conjugate(motion.orientation(seconds(t + horizonNs))) * pose.orientation;
+            const double errorDeg = norm(quat::toRotationVector(error)) * 180.0 / kPi;
+            totalDeg += errorDeg;
+            errorsMicroDeg.push_back(static_cast<int64_t>(errorDeg * 1e6));
+        }
+    }
+    state.counters["mean_deg"] = totalDeg / static_cast<double>(errorsMicroDeg.size());
+    state.counters["p99_deg"] = static_cast<double>(percentile(errorsMicroDeg, 0.99)) / 1e6;
+    state.counters["max_deg"] = static_cast<double>(percentile(errorsMicroDeg, 1.0)) / 1e6;
+}
+BENCHMARK(BM_PosePredictorError)->Arg(10)->Arg(20)->Arg(50)->Unit(benchmark::kMillisecond);
+
+/// SeqLock read of a pose-sized payload against a writer storing in a loop
+void BM_SeqLockLoadContended(benchmark::State& state) {
+    struct Payload {
+        double values[8];
+    };
+    SeqLock<Payload> lock;
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        Payload payload{};
+        while (!done.load(std::memory_order_relaxed)) {
+            payload.values[0] += 1.0;
+            lock.store(payload);
+        }
+    });
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lock.load());
+    }
+    done = true;
+    writer.join();
+}
+BENCHMARK(BM_SeqLockLoadContended)->UseRealTime();
+
+PoseMeasurement restMeasurement(TimestampNs timestampNs) {
+    PoseMeasurement measurement;
+    measurement.timestampNs = timestampNs;
+    return measurement;
+}
+
+/// One 15-state covariance propagation step
+void BM_EskfPropagate(benchmark::State& state) {
+    Eskf filter;
+    filter.initialize(0, Quat::identity());
+    const Vec3 accel(0.1f, 0.0f, 9.81f);
+    const Vec3 gyro(0.0f, 0.0f, 0.2f);
+    for (auto _ : state) {
+        filter.propagate(accel, gyro, 0.0025f);
+    }
+    benchmark::DoNotOptimize(filter.covariance());
+}
+BENCHMARK(BM_EskfPropagate);
+
+/// One 6-DoF pose update at the current filter time
+void BM_EskfUpdate(benchmark::State& state) {
+    Eskf filter;
+    filter.initialize(0, Quat::identity());
+    const PoseMeasurement measurement = restMeasurement(0);
+    for (auto _ : state) {
+        // Keep P from collapsing so every iteration does the same work
+        state.PauseTiming();
+        filter.propagate({0.0f, 0.0f, 9.81f}, {}, 0.0025f);
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(filter.update(measurement));
+    }
+}
+BENCHMARK(BM_EskfUpdate);
+
+/// A measurement arriving `range(0)` IMU steps late: rollback, update and
+/// re-propagation of the newer steps
+void BM_EskfLateUpdate(benchmark::State& state) {
+    const int lateSteps = static_cast<int>(state.range(0));
+    Eskf filter;
+    filter.initialize(0, Quat::identity());
+    TimestampNs nowNs = 0;
+    auto step = [&filter, &nowNs] {
+        nowNs += kGyroPeriodNs;
+        filter.addImuSample({0.0f, 0.0f, 9.81f, nowNs, SensorType::Accelerometer});
+        filter.addImuSample({0.0f, 0.0f, 0.0f, nowNs, SensorType::Gyroscope});
+    };
+    for (int i = 0; i < lateSteps; ++i) {
+        step();
+    }
+    for (auto _ : state) {
+        filter.submitMeasurement(restMeasurement(nowNs - lateSteps * kGyroPeriodNs));
+        step();     // Applies the measurement and replays the steps after it
+    }
+    state.counters["replayed_steps"] = benchmark::Counter(
+        static_cast<double>(filter.getStats().repropagatedSteps), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_EskfLateUpdate)->Arg(1)->Arg(10)->Arg(40);
+
+}  // namespace
+}  // namespace nativesensor::benchmarks
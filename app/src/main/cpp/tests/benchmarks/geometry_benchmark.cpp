@@ -0,0 +1,121 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "geometry.h"
+#include "small_matrix.h"
+
+// Built twice: into nativesensor_benchmarks (SIMD) and, on its own, into
+// nativesensor_benchmarks_scalar with NATIVESENSOR_NO_SIMD as the baseline
+namespace nativesensor::benchmarks {
+namespace {
+
+constexpr size_t kCount = 1024;
+
+float nextUniform(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return static_cast<float>(state >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+std::vector<Vec3> randomVectors(uint32_t seed) {
+    std::vector<Vec3> out(kCount);
+    for (auto& v : out) {
+        const float x = nextUniform(seed);
+        const float y = nextUniform(seed);
+        v = {x, y, nextUniform(seed)};
+    }
+    return out;
+}
+
+std::vector<Quat> randomQuats(uint32_t seed) {
+    std::vector<Quat> out(kCount);
+    for (auto& q : out) {
+        const float w = nextUniform(seed);
+        const float x = nextUniform(seed);
+        const float y = nextUniform(seed);
+        q = normalized(Quat{w, x, y, nextUniform(seed)});
+    }
+    return out;
+}
+
+void BM_QuatMultiply(benchmark::State& state) {
+    const auto a = randomQuats(1);
+    const auto b = randomQuats(2);
+    std::vector<Quat> out(kCount);
+    for (auto _ : state) {
+        for (size_t i = 0; i < kCount; ++i) {
+            out[i] = a[i] * b[i];
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kCount));
+}
+BENCHMARK(BM_QuatMultiply);
+
+void BM_Vec3Normalize(benchmark::State& state) {
+    const auto v = randomVectors(3);
+    std::vector<Vec3> out(kCount);
+    for (auto _ : state) {
+        for (size_t i = 0; i < kCount; ++i) {
+            out[i] = normalized(v[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kCount));
+}
+BENCHMARK(BM_Vec3Normalize);
+
+void BM_Vec3Rotate(benchmark::State& state) {
+    const auto q = randomQuats(4);
+    const auto v = randomVectors(5);
+    std::vector<Vec3> out(kCount);
+    for (auto _ : state) {
+        for (size_t i = 0; i < kCount; ++i) {
+            out[i] = rotate(q[i], v[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kCount));
+}
+BENCHMARK(BM_Vec3Rotate);
+
+void BM_Mat3Multiply(benchmark::State& state) {
+    const auto q = randomQuats(6);
+    std::vector<Mat3> m(kCount);
+    for (size_t i = 0; i < kCount; ++i) {
+        m[i] = toMat3(q[i]);
+    }
+    std::vector<Mat3> out(kCount);
+    for (auto _ : state) {
+        for (size_t i = 0; i + 1 < kCount; ++i) {
+            out[i] = m[i] * m[i + 1];
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kCount - 1));
+}
+BENCHMARK(BM_Mat3Multiply);
+
+/// 15x15 covariance product, as in one ESKF propagation (F P F^T)
+void BM_MatN15Multiply(benchmark::State& state) {
+    uint32_t seed = 7;
+    MatN<15, 15> a{};
+    MatN<15, 15> b{};
+    for (size_t r = 0; r < 15; ++r) {
+        for (size_t c = 0; c < 15; ++c) {
+            a.m[r][c] = nextUniform(seed);
+            b.m[r][c] = nextUniform(seed);
+        }
+    }
+    for (auto _ : state) {
+        MatN<15, 15> product = a * b;
+        benchmark::DoNotOptimize(product);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_MatN15Multiply);
+
+}  // namespace
+}  // namespace nativesensor::benchmarks
@@ -0,0 +1,180 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark_utils.h"
+#include "lz4_frame.h"
+#include "mcap_writer.h"
+#include "ros2_messages.h"
+#include "time_series_store.h"
+
+namespace nativesensor::benchmarks {
+namespace {
+
+constexpr TimestampNs kStartNs = 1'000'000'000;
+constexpr int64_t kAccelPeriodNs = 2'500'000;       // 400 Hz
+constexpr int64_t kHourNs = 3600LL * 1'000'000'000;
+
+/// "imu.accel"-shaped row i: x, y, z and the sample interval
+void accelRow(int64_t i, float* values) {
+    const float t = static_cast<float>(i) * 2.5e-3f;
+    values[0] = 0.3f * std::sin(t);
+    values[1] = 0.2f * std::cos(1.3f * t);
+    values[2] = 9.81f + 0.05f * std::sin(7.0f * t);
+    values[3] = 2.5f + 0.01f * static_cast<float>(i % 7);
+}
+
+/// Accel sample i as the exporter serializes it (CDR sensor_msgs/msg/Imu)
+void accelMessage(int64_t i, std::vector<uint8_t>& out) {
+    float values[4];
+    accelRow(i, values);
+    const ImuSample sample{values[0], values[1], values[2], kStartNs + i * kAccelPeriodNs, SensorType::Accelerometer};
+    ros2::serializeImu(sample, "imu", out);
+}
+
+/// One hour of accel at 400 Hz (1.44M rows), written once per benchmark
+struct HourOfAccel {
+    ScratchDirectory directory;
+    std::unique_ptr<TimeSeries> series;
+
+    HourOfAccel() {
+        series = std::make_unique<TimeSeries>("imu.accel", directory.path() + "/imu.accel",
+                                              std::vector<std::string>{"x", "y", "z", "intervalMs"});
+        float values[4];
+        for (int64_t i = 0; i < kHourNs / kAccelPeriodNs; ++i) {
+            accelRow(i, values);
+            series->append(kStartNs + i * kAccelPeriodNs, values);
+        }
+    }
+};
+
+/// Ingest of a whole hour into a fresh series per iteration; rows per second
+/// a single writer sustains (the device writes 800 IMU rows/s plus 30 per camera)
+void BM_TimeSeriesIngestHour(benchmark::State& state) {
+    const int64_t rows = kHourNs / kAccelPeriodNs;
+    float values[4];
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto directory = std::make_unique<ScratchDirectory>();
+        auto series = std::make_unique<TimeSeries>("imu.accel", directory->path() + "/imu.accel",
+                                                   std::vector<std::string>{"x", "y", "z", "intervalMs"});
+        state.ResumeTiming();
+        for (int64_t i = 0; i < rows; ++i) {
+            accelRow(i, values);
+            series->append(kStartNs + i * kAccelPeriodNs, values);
+        }
+        state.PauseTiming();
+        if (series->rowCount() != static_cast<size_t>(rows)) {
+            state.SkipWithError("append failed");
+        }
+        series.reset();
+        directory.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+BENCHMARK(BM_TimeSeriesIngestHour)->Unit(benchmark::kMillisecond);
+
+/// Raw rows of one second at a time out of the hour
+void BM_TimeSeriesQuerySecond(benchmark::State& state) {
+    const HourOfAccel hour;
+    std::vector<TimestampNs> timestamps;
+    std::vector<float> values;
+    std::vector<int64_t> latencyNs;
+    latencyNs.reserve(1 << 16);
+    uint32_t position = 12345;
+    for (auto _ : state) {
+        position = position * 1664525u + 1013904223u;
+        const TimestampNs beginNs = kStartNs + static_cast<int64_t>(position % 3599) * 1'000'000'000;
+        timestamps.clear();
+        values.clear();
+        const auto start = std::chrono::steady_clock::now();
+        hour.series->query(2, beginNs, beginNs + 999'999'999, &timestamps, &values);
+        latencyNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        benchmark::DoNotOptimize(values.data());
+    }
+    reportLatencyUs(state, latencyNs);
+}
+BENCHMARK(BM_TimeSeriesQuerySecond);
+
+/// Min/max/mean/p50/p95/p99 per window over the whole hour; arg: window in seconds
+void BM_TimeSeriesAggregateHour(benchmark::State& state) {
+    const HourOfAccel hour;
+    const int64_t windowNs = state.range(0) * 1'000'000'000;
+    size_t windows = 0;
+    for (auto _ : state) {
+        const std::vector<WindowAggregate> result = hour.series->aggregate(2, kStartNs, kStartNs + kHourNs, windowNs);
+        windows = result.size();
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.counters["windows"] = static_cast<double>(windows);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(hour.series->rowCount()));
+}
+BENCHMARK(BM_TimeSeriesAggregateHour)->Arg(1)->Arg(60)->Arg(3600)->Unit(benchmark::kMillisecond);
+
+/// One 1 MB MCAP chunk of IMU messages through the LZ4 frame compressor
+void BM_Lz4CompressImuChunk(benchmark::State& state) {
+    std::vector<uint8_t> chunk;
+    std::vector<uint8_t> message;
+    for (int64_t i = 0; chunk.size() < (1 << 20); ++i) {
+        accelMessage(i, message);
+        chunk.insert(chunk.end(), message.begin(), message.end());
+    }
+    std::vector<uint8_t> compressed;
+    for (auto _ : state) {
+        compressed.clear();
+        lz4CompressFrame(chunk.data(), chunk.size(), compressed);
+        benchmark::DoNotOptimize(compressed.data());
+    }
+    state.counters["ratio"] = static_cast<double>(chunk.size()) / static_cast<double>(compressed.size());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(chunk.size()));
+}
+BENCHMARK(BM_Lz4CompressImuChunk)->Unit(benchmark::kMillisecond);
+
+/// A minute of 400 Hz accel exported to a finished MCAP file per iteration;
+/// arg: McapCompression. Bytes are the uncompressed chunk records
+void BM_McapWriteImuMinute(benchmark::State& state) {
+    const ScratchDirectory directory;
+    const std::string path = directory.path() + "/imu.mcap";
+    McapWriterOptions options;
+    options.compression = static_cast<McapCompression>(state.range(0));
+    constexpr int64_t kMessages = 60 * 400;
+    std::vector<std::vector<uint8_t>> messages(kMessages);
+    for (int64_t i = 0; i < kMessages; ++i) {
+        accelMessage(i, messages[static_cast<size_t>(i)]);
+    }
+
+    McapWriterStats stats;
+    for (auto _ : state) {
+        McapWriter writer;
+        bool ok = writer.open(path, options);
+        const uint16_t channel = writer.addChannel(writer.addSchema(ros2::kImuSchemaName, "ros2msg", ros2::kImuSchema),
+                                                   "/imu/accel", "cdr");
+        for (int64_t i = 0; i < kMessages && ok; ++i) {
+            const std::vector<uint8_t>& message = messages[static_cast<size_t>(i)];
+            ok = writer.writeMessage(channel, kStartNs + i * kAccelPeriodNs, message.data(), message.size());
+        }
+        if (!ok || !writer.finish()) {
+            state.SkipWithError("write failed");
+            break;
+        }
+        stats = writer.stats();
+    }
+    state.counters["ratio"] = stats.bytesWritten > 0 ? static_cast<double>(stats.uncompressedBytes) /
+                                                           static_cast<double>(stats.bytesWritten) : 0.0;
+    state.counters["compress_ms"] = stats.compressMs;
+    state.SetBytesProcessed(state.iterations() * stats.uncompressedBytes);
+}
+BENCHMARK(BM_McapWriteImuMinute)
+    ->Arg(static_cast<int64_t>(McapCompression::None))
+    ->Arg(static_cast<int64_t>(McapCompression::Lz4))
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace nativesensor::benchmarks
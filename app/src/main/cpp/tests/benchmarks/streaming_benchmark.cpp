@@ -0,0 +1,138 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <new>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark_utils.h"
+#include "shared_ring.h"
+#include "stream_protocol.h"
+#include "time_utils.h"
+
+namespace nativesensor::benchmarks {
+namespace {
+
+constexpr uint32_t kRingSlots = 4096;
+constexpr int64_t kStopNs = -1;         // Timestamp that ends the reader process
+
+stream::ImuMessage imuMessage(int64_t timestampNs) {
+    return {timestampNs, 1, 0.1f, 0.2f, 9.8f};
+}
+
+/// Cost of one publish, futex wake included; arg 1: with a reader thread
+/// blocked in wait(), so the wake also has a thread to resume
+void BM_SharedRingPublish(benchmark::State& state) {
+    SharedRingWriter writer;
+    if (!writer.create("bench-ring", kRingSlots, sizeof(stream::ImuMessage), 3)) {
+        state.SkipWithError("create failed");
+        return;
+    }
+    std::atomic<bool> stop{false};
+    std::thread reader;
+    if (state.range(0) != 0) {
+        reader = std::thread([&] {
+            SharedRingReader ring;
+            if (!ring.open(writer.fd())) {
+                return;
+            }
+            stream::ImuMessage message{};
+            size_t size = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (ring.wait(100)) {
+                    while (ring.read(&message, sizeof(message), size)) {}
+                }
+            }
+        });
+    }
+    int64_t timestampNs = 0;
+    for (auto _ : state) {
+        const stream::ImuMessage message = imuMessage(++timestampNs);
+        benchmark::DoNotOptimize(writer.publish(&message, sizeof(message)));
+    }
+    stop.store(true, std::memory_order_relaxed);
+    if (reader.joinable()) {
+        reader.join();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SharedRingPublish)->Arg(0)->Arg(1);
+
+/// Shared with the reader process: the latency of the message it got last
+struct WakeReport {
+    std::atomic<bool> opened{false};
+    std::atomic<int64_t> acked{0};
+    std::atomic<int64_t> latencyNs{0};
+};
+
+/// Publish-to-read latency in another process blocked in wait(), one
+/// message at a time (as at the IMU rate, where the reader always sleeps)
+void BM_SharedRingWakeLatency(benchmark::State& state) {
+    SharedRingWriter writer;
+    void* shared = ::mmap(nullptr, sizeof(WakeReport), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED || !writer.create("bench-ring", kRingSlots, sizeof(stream::ImuMessage), 3)) {
+        state.SkipWithError("setup failed");
+        return;
+    }
+    auto* report = new (shared) WakeReport;
+
+    const pid_t child = ::fork();
+    if (child == 0) {
+        SharedRingReader reader;
+        if (!reader.open(writer.fd())) {
+            _exit(1);
+        }
+        report->opened.store(true, std::memory_order_release);
+        stream::ImuMessage message{};
+        size_t size = 0;
+        int64_t acked = 0;
+        while (true) {
+            reader.wait(-1);
+            while (reader.read(&message, sizeof(message), size)) {
+                if (message.timestampNs == kStopNs) {
+                    _exit(0);
+                }
+                report->latencyNs.store(getBootTimeNs() - message.timestampNs, std::memory_order_relaxed);
+                report->acked.store(++acked, std::memory_order_release);
+            }
+        }
+    }
+    if (child < 0) {
+        state.SkipWithError("fork failed");
+        return;
+    }
+
+    // The reader follows from the newest message at open()
+    while (!report->opened.load(std::memory_order_acquire)) {
+        sched_yield();
+    }
+    std::vector<int64_t> latencyNs;
+    int64_t sent = 0;
+    for (auto _ : state) {
+        // Readers can't announce themselves in the read-only ring: give this
+        // one time to block in wait() again
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        const stream::ImuMessage message = imuMessage(getBootTimeNs());
+        writer.publish(&message, sizeof(message));
+        ++sent;
+        while (report->acked.load(std::memory_order_acquire) != sent) {
+            sched_yield();
+        }
+        latencyNs.push_back(report->latencyNs.load(std::memory_order_relaxed));
+    }
+    const stream::ImuMessage stop = imuMessage(kStopNs);
+    writer.publish(&stop, sizeof(stop));
+    ::waitpid(child, nullptr, 0);
+    ::munmap(shared, sizeof(WakeReport));
+    reportLatencyUs(state, latencyNs);
+}
+BENCHMARK(BM_SharedRingWakeLatency)->UseRealTime();
+
+}  // namespace
+}  // namespace nativesensor::benchmarks
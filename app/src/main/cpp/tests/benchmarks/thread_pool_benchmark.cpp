@@ -0,0 +1,71 @@
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark_utils.h"
+#include "thread_pool.h"
+#include "time_utils.h"
+
+namespace nativesensor::benchmarks {
+namespace {
+
+constexpr int kBatch = 1024;
+
+/// Tasks per second through submit() and the workers, for a batch of empty tasks
+void BM_ThreadPoolThroughput(benchmark::State& state) {
+    ThreadPool pool(static_cast<size_t>(state.range(0)));
+    std::atomic<int64_t> executed{0};
+    for (auto _ : state) {
+        for (int i = 0; i < kBatch; ++i) {
+            pool.submit([&executed] { executed.fetch_add(1, std::memory_order_relaxed); });
+        }
+        pool.waitIdle();
+    }
+    state.SetItemsProcessed(state.iterations() * kBatch);
+}
+BENCHMARK(BM_ThreadPoolThroughput)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+/// Submit-to-start latency of tasks arriving in bursts, as a frame's analysis does
+void BM_ThreadPoolLatency(benchmark::State& state) {
+    ThreadPool pool(static_cast<size_t>(state.range(0)));
+    const int burst = static_cast<int>(state.range(1));
+    std::vector<int64_t> latencies;
+    std::vector<int64_t> burstLatencies(static_cast<size_t>(burst));
+    for (auto _ : state) {
+        for (int i = 0; i < burst; ++i) {
+            const int64_t submittedNs = getBootTimeNs();
+            pool.submit([&burstLatencies, i, submittedNs] {
+                burstLatencies[static_cast<size_t>(i)] = getBootTimeNs() - submittedNs;
+            });
+        }
+        pool.waitIdle();
+        latencies.insert(latencies.end(), burstLatencies.begin(), burstLatencies.end());
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+    reportLatencyUs(state, latencies);
+}
+BENCHMARK(BM_ThreadPoolLatency)->Args({2, 1})->Args({4, 16})->Args({4, 256})->UseRealTime();
+
+/// parallelFor over a frame-sized row loop, caller included
+void BM_ThreadPoolParallelFor(benchmark::State& state) {
+    ThreadPool pool(static_cast<size_t>(state.range(0)));
+    constexpr size_t kRows = 480;
+    std::vector<uint32_t> rows(kRows);
+    for (auto _ : state) {
+        pool.parallelFor(kRows, [&rows](size_t row) {
+            uint32_t hash = static_cast<uint32_t>(row);
+            for (int i = 0; i < 640; ++i) {
+                hash = hash * 31u + static_cast<uint32_t>(i);
+            }
+            rows[row] = hash;
+        });
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kRows));
+}
+BENCHMARK(BM_ThreadPoolParallelFor)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+}  // namespace
+}  // namespace nativesensor::benchmarks
@@ -0,0 +1,177 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "block_matcher.h"
+#include "calibration_store.h"
+#include "frame_pool.h"
+#include "frame_quality.h"
+#include "remap.h"
+#include "stereo_depth.h"
+#include "thread_pool.h"
+
+namespace nativesensor::benchmarks {
+namespace {
+
+constexpr int32_t kWidth = 640;
+constexpr int32_t kHeight = 480;
+constexpr int32_t kDisparity = 12;
+
+/// Tracking camera with a wide lens: strong barrel distortion
+CameraCalibration trackingCamera(float offsetX) {
+    CameraCalibration c;
+    c.fx = 420.0f;
+    c.fy = 420.0f;
+    c.cx = 322.5f;
+    c.cy = 238.0f;
+    c.distortion[0] = -0.28f;
+    c.distortion[1] = 0.09f;
+    c.distortion[3] = 0.0005f;
+    c.poseTranslation[0] = offsetX;
+    c.poseReference = LensPoseReference::Gyroscope;
+    c.activeArrayWidth = kWidth;
+    c.activeArrayHeight = kHeight;
+    c.hasIntrinsics = true;
+    c.hasDistortion = true;
+    c.hasPose = true;
+    return c;
+}
+
+uint8_t noise(int32_t x, int32_t y) {
+    uint32_t h = static_cast<uint32_t>(x) * 2654435761u ^ static_cast<uint32_t>(y) * 40503u;
+    h ^= h >> 13;
+    return static_cast<uint8_t>(h * 2246822519u >> 24);
+}
+
+/// Noise texture, shifted left by `shift` pixels
+void fill(uint8_t* data, int32_t stride, int32_t shift) {
+    for (int32_t y = 0; y < kHeight; ++y) {
+        for (int32_t x = 0; x < kWidth; ++x) {
+            data[static_cast<ptrdiff_t>(y) * stride + x] = noise(x + shift, y);
+        }
+    }
+}
+
+/// Undistortion of a VGA frame with the fixed-point table (NEON on arm64)
+void BM_RemapFixed(benchmark::State& state) {
+    const auto map = buildUndistortionMap(trackingCamera(0.0f), kWidth, kHeight);
+    const RemapTable table = buildRemapTable(*map, kWidth, kHeight, kWidth);
+    std::vector<uint8_t> src(static_cast<size_t>(kWidth) * kHeight);
+    std::vector<uint8_t> dst(src.size());
+    fill(src.data(), kWidth, 0);
+    for (auto _ : state) {
+        remap(table, src.data(), dst.data(), kWidth);
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kWidth * kHeight);
+}
+BENCHMARK(BM_RemapFixed);
+
+/// Same undistortion straight from the float map: the baseline
+void BM_RemapFloat(benchmark::State& state) {
+    const auto map = buildUndistortionMap(trackingCamera(0.0f), kWidth, kHeight);
+    std::vector<uint8_t> src(static_cast<size_t>(kWidth) * kHeight);
+    std::vector<uint8_t> dst(src.size());
+    fill(src.data(), kWidth, 0);
+    for (auto _ : state) {
+        remapFloat(*map, src.data(), kWidth, kHeight, kWidth, dst.data(), kWidth);
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kWidth * kHeight);
+}
+BENCHMARK(BM_RemapFloat);
+
+/// Block matching of a rectified VGA pair; arg: worker threads (0 = caller only)
+void BM_BlockMatcher(benchmark::State& state) {
+    std::vector<uint8_t> left(static_cast<size_t>(kWidth) * kHeight);
+    std::vector<uint8_t> right(left.size());
+    fill(left.data(), kWidth, 0);
+    fill(right.data(), kWidth, kDisparity);
+    const auto workers = static_cast<size_t>(state.range(0));
+    std::unique_ptr<ThreadPool> pool = workers > 0 ? std::make_unique<ThreadPool>(workers) : nullptr;
+    BlockMatcher matcher;
+    DisparityMap map;
+    for (auto _ : state) {
+        matcher.compute(left.data(), kWidth, right.data(), kWidth, kWidth, kHeight, map, pool.get());
+        benchmark::DoNotOptimize(map.data.data());
+    }
+    state.counters["fps"] = benchmark::Counter(static_cast<double>(state.iterations()),
+                                               benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_BlockMatcher)->Arg(0)->Arg(2)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+/// Full stereo stage on VGA pairs: pairing, rectification of both frames and
+/// matching; arg: worker threads
+void BM_StereoDepth(benchmark::State& state) {
+    CalibrationStore store("", "benchmark");
+    CameraInfo left;
+    left.id = "left";
+    left.calibration = trackingCamera(0.0f);
+    CameraInfo right;
+    right.id = "right";
+    right.calibration = trackingCamera(0.064f);
+    store.update({left, right});
+
+    ThreadPool pool(static_cast<size_t>(state.range(0)));
+    StereoDepth stereo(store, pool);
+    if (!stereo.setPair(left.id, right.id)) {
+        state.SkipWithError("pair can't be rectified");
+        return;
+    }
+
+    FramePool frames(kWidth, kHeight, 4);
+    FrameRef leftFrame = frames.acquire();
+    FrameRef rightFrame = frames.acquire();
+    fill(leftFrame->data(), leftFrame->stride(), 0);
+    fill(rightFrame->data(), rightFrame->stride(), kDisparity);
+    leftFrame->metadata.cameraId = left.id;
+    rightFrame->metadata.cameraId = right.id;
+
+    int64_t timestampNs = 0;
+    for (auto _ : state) {
+        timestampNs += 33'333'333;
+        leftFrame->metadata.timestampNs = timestampNs;
+        rightFrame->metadata.timestampNs = timestampNs;
+        std::shared_ptr<const StereoFrame> out;
+        stereo.process(leftFrame, out);
+        if (!stereo.process(rightFrame, out)) {
+            state.SkipWithError("pair not matched");
+            break;
+        }
+        benchmark::DoNotOptimize(out.get());
+    }
+    state.counters["fps"] = benchmark::Counter(static_cast<double>(state.iterations()),
+                                               benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_StereoDepth)->Arg(1)->Arg(2)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+/// Quality measures of a 1080p frame at the monitor's default sample budget
+/// (every 16th row); budget: 0.5 ms per frame
+void BM_FrameQuality1080p(benchmark::State& state) {
+    constexpr int32_t kFullWidth = 1920;
+    constexpr int32_t kFullHeight = 1080;
+    std::vector<uint8_t> image(static_cast<size_t>(kFullWidth) * kFullHeight);
+    for (int32_t y = 0; y < kFullHeight; ++y) {
+        for (int32_t x = 0; x < kFullWidth; ++x) {
+            image[static_cast<size_t>(y) * kFullWidth + static_cast<size_t>(x)] = noise(x, y);
+        }
+    }
+    const auto pixels = static_cast<size_t>(kFullWidth) * kFullHeight;
+    const auto rowStep = static_cast<int32_t>((pixels + FrameQualityMonitor::kDefaultSampleBudget - 1) /
+                                              FrameQualityMonitor::kDefaultSampleBudget);
+    FrameQuality quality;
+    for (auto _ : state) {
+        measureFrameQuality(image.data(), kFullWidth, kFullHeight, kFullWidth, rowStep, quality);
+        benchmark::DoNotOptimize(quality);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(pixels));
+}
+BENCHMARK(BM_FrameQuality1080p)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace nativesensor::benchmarks
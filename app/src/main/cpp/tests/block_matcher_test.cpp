@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "block_matcher.h"
+#include "thread_pool.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr int32_t kWidth = 160;
+constexpr int32_t kHeight = 96;
+
+/// Smoothed noise: enough texture to match, smooth enough to interpolate
+std::vector<float> texture(int32_t width, int32_t height, uint32_t seed) {
+    std::vector<float> noise(static_cast<size_t>(width) * static_cast<size_t>(height));
+    for (auto& value : noise) {
+        seed = seed * 1664525u + 1013904223u;
+        value = static_cast<float>(seed >> 24);
+    }
+    std::vector<float> out(noise.size());
+    for (int32_t y = 0; y < height; ++y) {
+        for (int32_t x = 0; x < width; ++x) {
+            const int32_t x1 = x + 1 < width ? x + 1 : x;
+            const int32_t y1 = y + 1 < height ? y + 1 : y;
+            out[static_cast<size_t>(y * width + x)] =
+                0.25f * (noise[static_cast<size_t>(y * width + x)] + noise[static_cast<size_t>(y * width + x1)] +
+                         noise[static_cast<size_t>(y1 * width + x)] + noise[static_cast<size_t>(y1 * width + x1)]);
+        }
+    }
+    return out;
+}
+
+/// Rectified pair of a fronto-parallel plane: right(x) = left(x + disparity)
+struct StereoPair {
+    std::vector<uint8_t> left;
+    std::vector<uint8_t> right;
+};
+
+StereoPair shiftedPair(float disparity, uint32_t seed) {
+    // The scene is wider than the images so the right one has no empty band
+    const int32_t margin = static_cast<int32_t>(std::ceil(disparity)) + 2;
+    const int32_t sceneWidth = kWidth + margin;
+    const std::vector<float> scene = texture(sceneWidth, kHeight, seed);
+    const auto sample = [&](int32_t y, float x) {
+        const auto x0 = static_cast<int32_t>(x);
+        const float f = x - static_cast<float>(x0);
+        const float* row = scene.data() + static_cast<size_t>(y) * static_cast<size_t>(sceneWidth);
+        return static_cast<uint8_t>(row[x0] + f * (row[x0 + 1] - row[x0]) + 0.5f);
+    };
+
+    StereoPair pair;
+    pair.left.resize(static_cast<size_t>(kWidth) * kHeight);
+    pair.right.resize(pair.left.size());
+    for (int32_t y = 0; y < kHeight; ++y) {
+        for (int32_t x = 0; x < kWidth; ++x) {
+            const size_t i = static_cast<size_t>(y * kWidth + x);
+            pair.left[i] = sample(y, static_cast<float>(x));
+            pair.right[i] = sample(y, static_cast<float>(x) + disparity);
+        }
+    }
+    return pair;
+}
+
+struct DisparityStats {
+    int valid = 0;
+    int candidates = 0;
+    int fractional = 0;
+    double sum = 0.0;
+    float maxError = 0.0f;
+};
+
+/// Statistics over pixels whose match lies inside the right image
+DisparityStats measure(const DisparityMap& map, float expected, int32_t blockSize) {
+    DisparityStats stats;
+    const int32_t radius = blockSize / 2;
+    const auto minX = radius + static_cast<int32_t>(std::ceil(expected));
+    for (int32_t y = radius; y < map.height - radius; ++y) {
+        for (int32_t x = minX; x < map.width - radius; ++x) {
+            ++stats.candidates;
+            const float d = map.disparity(x, y);
+            if (d < 0.0f) {
+                continue;
+            }
+            ++stats.valid;
+            stats.fractional += d != std::floor(d);
+            stats.sum += d;
+            stats.maxError = std::max(stats.maxError, std::fabs(d - expected));
+        }
+    }
+    return stats;
+}
+
+TEST(BlockMatcherTest, RecoversAWholePixelShift) {
+    const StereoPair pair = shiftedPair(11.0f, 1);
+    BlockMatcher matcher;
+    DisparityMap map;
+    matcher.compute(pair.left.data(), kWidth, pair.right.data(), kWidth, kWidth, kHeight, map);
+    ASSERT_EQ(map.width, kWidth);
+    ASSERT_EQ(map.height, kHeight);
+
+    const DisparityStats stats = measure(map, 11.0f, matcher.config().blockSize);
+    EXPECT_GT(stats.valid, stats.candidates * 95 / 100);
+    EXPECT_LT(stats.maxError, 0.5f);
+    EXPECT_NEAR(stats.sum / stats.valid, 11.0, 0.05);
+}
+
+TEST(BlockMatcherTest, RefinesSubpixelShifts) {
+    for (const float disparity : {4.25f, 7.5f, 20.75f}) {
+        const StereoPair pair = shiftedPair(disparity, 2);
+        BlockMatcher matcher;
+        DisparityMap map;
+        matcher.compute(pair.left.data(), kWidth, pair.right.data(), kWidth, kWidth, kHeight, map);
+
+        const DisparityStats stats = measure(map, disparity, matcher.config().blockSize);
+        EXPECT_GT(stats.valid, stats.candidates * 9 / 10) << disparity;
+        EXPECT_GT(stats.fractional, stats.valid / 2) << disparity;
+        // Parabola fits on SAD are pulled towards whole pixels (by up to a
+        // fifth of a pixel here), but stay well inside one pixel
+        EXPECT_LT(stats.maxError, 1.0f) << disparity;
+        EXPECT_NEAR(stats.sum / stats.valid, disparity, 0.25) << disparity;
+    }
+}
+
+TEST(BlockMatcherTest, BordersAndUnreachableMatchesAreInvalid) {
+    const StereoPair pair = shiftedPair(11.0f, 3);
+    BlockMatcher matcher(BlockMatcherConfig{32, 7, 15, 16});
+    DisparityMap map;
+    matcher.compute(pair.left.data(), kWidth, pair.right.data(), kWidth, kWidth, kHeight, map);
+
+    const int32_t radius = 3;
+    for (int32_t x = 0; x < kWidth; ++x) {
+        for (int32_t y = 0; y < radius; ++y) {
+            ASSERT_LT(map.disparity(x, y), 0.0f);
+            ASSERT_LT(map.disparity(x, kHeight - 1 - y), 0.0f);
+        }
+    }
+    for (int32_t y = 0; y < kHeight; ++y) {
+        for (int32_t x = 0; x < radius; ++x) {
+            ASSERT_LT(map.disparity(x, y), 0.0f);
+            ASSERT_LT(map.disparity(kWidth - 1 - x, y), 0.0f);
+        }
+        // Near the left edge the true match is outside the right image; the
+        // search is limited to what fits, so nothing can exceed x - radius
+        for (int32_t x = radius; x < radius + 11; ++x) {
+            ASSERT_LE(map.disparity(x, y), static_cast<float>(x - radius) + 0.5f) << x << "," << y;
+        }
+    }
+}
+
+TEST(BlockMatcherTest, TexturelessRegionsFailTheUniquenessCheck) {
+    const std::vector<uint8_t> flat(static_cast<size_t>(kWidth) * kHeight, 128);
+    BlockMatcher matcher;
+    DisparityMap map;
+    matcher.compute(flat.data(), kWidth, flat.data(), kWidth, kWidth, kHeight, map);
+    // Columns that can search two or more disparities have a tied rival
+    const int32_t radius = matcher.config().blockSize / 2;
+    for (int32_t y = 0; y < kHeight; ++y) {
+        for (int32_t x = radius + 2; x < kWidth; ++x) {
+            ASSERT_LT(map.disparity(x, y), 0.0f) << x << "," << y;
+        }
+    }
+
+    // Without the check the lowest tied disparity wins
+    BlockMatcher permissive(BlockMatcherConfig{64, 9, 0, 16});
+    permissive.compute(flat.data(), kWidth, flat.data(), kWidth, kWidth, kHeight, map);
+    EXPECT_EQ(map.disparity(kWidth / 2, kHeight / 2), 0.0f);
+}
+
+TEST(BlockMatcherTest, ParallelBandsMatchTheSingleThreadedResult) {
+    const StereoPair pair = shiftedPair(9.5f, 4);
+    BlockMatcher serial;
+    DisparityMap expected;
+    serial.compute(pair.left.data(), kWidth, pair.right.data(), kWidth, kWidth, kHeight, expected);
+
+    ThreadPool pool(4);
+    BlockMatcher parallel(BlockMatcherConfig{64, 9, 15, 8});
+    DisparityMap actual;
+    for (int i = 0; i < 3; ++i) {
+        parallel.compute(pair.left.data(), kWidth, pair.right.data(), kWidth, kWidth, kHeight, actual, &pool);
+        ASSERT_EQ(actual.data, expected.data) << i;
+    }
+}
+
+TEST(BlockMatcherTest, ImagesSmallerThanTheBlockAreAllInvalid) {
+    const std::vector<uint8_t> tiny(8 * 8, 50);
+    BlockMatcher matcher;
+    DisparityMap map;
+    matcher.compute(tiny.data(), 8, tiny.data(), 8, 8, 8, map);
+    ASSERT_EQ(map.data.size(), 64u);
+    for (const int16_t value : map.data) {
+        EXPECT_EQ(value, DisparityMap::kInvalid);
+    }
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
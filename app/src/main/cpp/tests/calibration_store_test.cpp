@@ -0,0 +1,228 @@
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "calibration_store.h"
+#include "geometry.h"
+#include "test_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+std::vector<std::filesystem::path> mapFiles(const std::string& dir) {
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        files.push_back(entry.path());
+    }
+    return files;
+}
+
+float angleError(const Quat& a, const Quat& b) {
+    return norm(quat::toRotationVector(conjugate(a) * b));
+}
+
+TEST(CalibrationStoreTest, ScalesIntrinsicsWithACenteredCrop) {
+    const CameraCalibration calibration = sampleCamera("0").calibration;
+
+    // Same aspect ratio: pure scale
+    const PinholeIntrinsics vga = scaledIntrinsics(calibration, 640, 480);
+    EXPECT_FLOAT_EQ(vga.fx, 256.0f);
+    EXPECT_FLOAT_EQ(vga.fy, 256.0f);
+    EXPECT_FLOAT_EQ(vga.cx, 320.0f);
+    EXPECT_FLOAT_EQ(vga.cy, 240.0f);
+
+    // 16:9 crops rows off the 4:3 array; the center stays the center
+    const PinholeIntrinsics hd = scaledIntrinsics(calibration, 1280, 720);
+    EXPECT_FLOAT_EQ(hd.fx, 512.0f);
+    EXPECT_FLOAT_EQ(hd.cx, 640.0f);
+    EXPECT_FLOAT_EQ(hd.cy, 360.0f);
+
+    const PinholeIntrinsics none = scaledIntrinsics(CameraCalibration{}, 640, 480);
+    EXPECT_EQ(none.fx, 0.0f);
+}
+
+TEST(CalibrationStoreTest, MapWithoutDistortionIsTheIdentity) {
+    CameraCalibration calibration = sampleCamera("0").calibration;
+    calibration.hasDistortion = false;
+    const auto map = buildUndistortionMap(calibration, 64, 48);
+    ASSERT_NE(map, nullptr);
+    ASSERT_EQ(map->coords.size(), 2u * 64 * 48);
+    for (int32_t y = 0; y < 48; ++y) {
+        for (int32_t x = 0; x < 64; ++x) {
+            const float* p = &map->coords[2 * (y * 64 + x)];
+            ASSERT_NEAR(p[0], static_cast<float>(x), 1e-3f) << x << "," << y;
+            ASSERT_NEAR(p[1], static_cast<float>(y), 1e-3f) << x << "," << y;
+        }
+    }
+
+    calibration.hasIntrinsics = false;
+    EXPECT_EQ(buildUndistortionMap(calibration, 64, 48), nullptr);
+}
+
+TEST(CalibrationStoreTest, MapFollowsTheDistortionModel) {
+    const CameraCalibration calibration = sampleCamera("0").calibration;
+    const auto map = buildUndistortionMap(calibration, 640, 480);
+    ASSERT_NE(map, nullptr);
+    const PinholeIntrinsics& k = map->intrinsics;
+
+    // Barrel distortion pulls the corners inwards, the principal point stays
+    const float* center = &map->coords[2 * (240 * 640 + 320)];
+    EXPECT_NEAR(center[0], 320.0f, 0.1f);
+    EXPECT_NEAR(center[1], 240.0f, 0.1f);
+    const float* corner = &map->coords[0];
+    EXPECT_GT(corner[0], 0.5f);
+    EXPECT_GT(corner[1], 0.5f);
+
+    for (const auto& [x, y] : {std::pair{0, 0}, {639, 0}, {100, 400}, {639, 479}}) {
+        const float yn = (static_cast<float>(y) - k.cy) / k.fy;
+        const float xn = (static_cast<float>(x) - k.cx - k.skew * yn) / k.fx;
+        float u = 0.0f;
+        float v = 0.0f;
+        projectDistorted(calibration, k, xn, yn, u, v);
+        const float* p = &map->coords[2 * (y * 640 + x)];
+        EXPECT_NEAR(p[0], u, 1e-3f) << x << "," << y;
+        EXPECT_NEAR(p[1], v, 1e-3f) << x << "," << y;
+    }
+}
+
+TEST(CalibrationStoreTest, UpdateTracksCamerasAndGeneration) {
+    CalibrationStore store("", "device");
+    EXPECT_EQ(store.cameraCount(), 0u);
+    EXPECT_FALSE(store.calibration("0").has_value());
+
+    store.update({sampleCamera("0"), sampleCamera("1")});
+    EXPECT_EQ(store.cameraCount(), 2u);
+    ASSERT_TRUE(store.calibration("1").has_value());
+    EXPECT_FLOAT_EQ(store.calibration("1")->fx, 1600.0f);
+    const uint64_t generation = store.generation();
+    EXPECT_GT(generation, 0u);
+
+    // Identical enumeration: nothing derived needs a rebuild
+    store.update({sampleCamera("0"), sampleCamera("1")});
+    EXPECT_EQ(store.generation(), generation);
+
+    CameraInfo changed = sampleCamera("1");
+    changed.calibration.cx += 1.0f;
+    store.update({sampleCamera("0"), changed});
+    EXPECT_EQ(store.generation(), generation + 1);
+
+    store.update({sampleCamera("0")});
+    EXPECT_EQ(store.generation(), generation + 2);
+    EXPECT_FALSE(store.calibration("1").has_value());
+}
+
+TEST(CalibrationStoreTest, ImuExtrinsicsOnlyForGyroscopeReferencedPoses) {
+    CameraInfo camera = sampleCamera("0");
+    const Quat cameraFromImu = quat::fromRotationVector({0.1f, -0.2f, 1.5f});
+    camera.calibration.poseRotation[0] = cameraFromImu.x;
+    camera.calibration.poseRotation[1] = cameraFromImu.y;
+    camera.calibration.poseRotation[2] = cameraFromImu.z;
+    camera.calibration.poseRotation[3] = cameraFromImu.w;
+    camera.calibration.poseTranslation[0] = 0.012f;
+    camera.calibration.poseTranslation[2] = -0.004f;
+    camera.calibration.hasPose = true;
+    camera.calibration.poseReference = LensPoseReference::PrimaryCamera;
+
+    CalibrationStore store("", "device");
+    store.update({camera});
+    EXPECT_FALSE(store.imuFromCamera("0").has_value());
+    EXPECT_FALSE(store.imuFromCamera("missing").has_value());
+
+    camera.calibration.poseReference = LensPoseReference::Gyroscope;
+    store.update({camera});
+    const auto imuFromCamera = store.imuFromCamera("0");
+    ASSERT_TRUE(imuFromCamera.has_value());
+    EXPECT_LT(angleError(imuFromCamera->rotation, conjugate(cameraFromImu)), 1e-5f);
+    EXPECT_FLOAT_EQ(imuFromCamera->translation.x, 0.012f);
+    EXPECT_FLOAT_EQ(imuFromCamera->translation.z, -0.004f);
+}
+
+TEST(CalibrationStoreTest, MapsAreBuiltOnceAndShared) {
+    CalibrationStore store("", "device");
+    CameraInfo noIntrinsics = sampleCamera("1");
+    noIntrinsics.calibration.hasIntrinsics = false;
+    store.update({sampleCamera("0"), noIntrinsics});
+
+    const auto first = store.undistortionMap("0", 320, 240);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->width, 320);
+    EXPECT_EQ(store.undistortionMap("0", 320, 240), first);
+    EXPECT_NE(store.undistortionMap("0", 640, 480), first);
+    EXPECT_EQ(store.undistortionMap("1", 320, 240), nullptr);
+    EXPECT_EQ(store.undistortionMap("missing", 320, 240), nullptr);
+
+    // A calibration change drops the cached map
+    CameraInfo changed = sampleCamera("0");
+    changed.calibration.distortion[0] = -0.1f;
+    store.update({changed, noIntrinsics});
+    const auto rebuilt = store.undistortionMap("0", 320, 240);
+    ASSERT_NE(rebuilt, nullptr);
+    EXPECT_NE(rebuilt, first);
+    EXPECT_NE(rebuilt->coords, first->coords);
+}
+
+TEST(CalibrationStoreTest, MapsPersistAcrossSessions) {
+    TempDir dir;
+    std::shared_ptr<const UndistortionMap> built;
+    {
+        CalibrationStore store(dir.path(), "device");
+        store.update({sampleCamera("0")});
+        built = store.undistortionMap("0", 160, 120);
+        ASSERT_NE(built, nullptr);
+    }
+    ASSERT_EQ(mapFiles(dir.path()).size(), 1u);
+
+    CalibrationStore store(dir.path(), "device");
+    store.update({sampleCamera("0")});
+    const auto loaded = store.undistortionMap("0", 160, 120);
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->coords, built->coords);
+    EXPECT_FLOAT_EQ(loaded->intrinsics.fx, built->intrinsics.fx);
+    EXPECT_EQ(mapFiles(dir.path()).size(), 1u);
+
+    // Another build fingerprint never reuses the file
+    CalibrationStore otherBuild(dir.path(), "device-ota");
+    otherBuild.update({sampleCamera("0")});
+    ASSERT_NE(otherBuild.undistortionMap("0", 160, 120), nullptr);
+    EXPECT_EQ(mapFiles(dir.path()).size(), 2u);
+}
+
+TEST(CalibrationStoreTest, CorruptMapFileIsRebuilt) {
+    TempDir dir;
+    std::shared_ptr<const UndistortionMap> built;
+    {
+        CalibrationStore store(dir.path(), "device");
+        store.update({sampleCamera("0")});
+        built = store.undistortionMap("0", 160, 120);
+        ASSERT_NE(built, nullptr);
+    }
+    const std::vector<std::filesystem::path> files = mapFiles(dir.path());
+    ASSERT_EQ(files.size(), 1u);
+    {
+        // Flip one payload byte; the checksum no longer matches
+        std::fstream file(files[0], std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(100);
+        file.put('\x7f');
+    }
+
+    CalibrationStore store(dir.path(), "device");
+    store.update({sampleCamera("0")});
+    const auto rebuilt = store.undistortionMap("0", 160, 120);
+    ASSERT_NE(rebuilt, nullptr);
+    EXPECT_EQ(rebuilt->coords, built->coords);
+
+    // Rewritten intact: the next session loads it
+    CalibrationStore next(dir.path(), "device");
+    next.update({sampleCamera("0")});
+    const auto loaded = next.undistortionMap("0", 160, 120);
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->coords, built->coords);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
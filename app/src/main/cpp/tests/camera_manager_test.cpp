@@ -0,0 +1,130 @@
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "camera_manager.h"
+#include "test_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+class CameraManagerTest : public SyntheticBackendTest {
+protected:
+    static SyntheticCamera camera(std::string id, uint8_t facing, int32_t width, int32_t height) {
+        SyntheticCamera spec;
+        spec.id = std::move(id);
+        spec.facing = facing;
+        spec.width = width;
+        spec.height = height;
+        return spec;
+    }
+
+    static const CameraInfo* find(const std::vector<CameraInfo>& cameras, const std::string& id) {
+        for (const auto& info : cameras) {
+            if (info.id == id) {
+                return &info;
+            }
+        }
+        return nullptr;
+    }
+};
+
+TEST_F(CameraManagerTest, EnumeratesAndClassifiesDefaultCameras) {
+    CameraManager manager;
+    ASSERT_TRUE(manager.isValid());
+    const auto cameras = manager.enumerateCameras();
+    ASSERT_EQ(cameras.size(), 4u);
+
+    const CameraInfo* passthrough = find(cameras, "0");
+    ASSERT_NE(passthrough, nullptr);
+    EXPECT_EQ(passthrough->facing, CameraFacing::Back);
+    EXPECT_EQ(passthrough->clusterType, CameraClusterType::Passthrough);
+    EXPECT_EQ(passthrough->width, 2048);
+    EXPECT_EQ(passthrough->height, 1536);
+    EXPECT_EQ(passthrough->maxFps, 30);
+    EXPECT_TRUE(passthrough->isPhysicalCamera);
+
+    const CameraInfo* tracking = find(cameras, "2");
+    ASSERT_NE(tracking, nullptr);
+    EXPECT_EQ(tracking->facing, CameraFacing::Front);
+    EXPECT_EQ(tracking->clusterType, CameraClusterType::Avatar);
+    EXPECT_EQ(tracking->maxFps, 60);
+    ASSERT_TRUE(tracking->calibration.hasIntrinsics);
+    EXPECT_FLOAT_EQ(tracking->calibration.fx, 0.8f * 640.0f);
+    EXPECT_FLOAT_EQ(tracking->calibration.cx, 320.0f);
+    EXPECT_EQ(tracking->calibration.activeArrayWidth, 640);
+    EXPECT_EQ(tracking->calibration.activeArrayHeight, 480);
+    ASSERT_TRUE(tracking->calibration.hasPose);
+    EXPECT_FLOAT_EQ(tracking->calibration.poseTranslation[0], 0.032f);
+    EXPECT_EQ(tracking->calibration.poseReference, LensPoseReference::Gyroscope);
+
+    const CameraInfo* eye = find(cameras, "eye0");
+    ASSERT_NE(eye, nullptr);
+    EXPECT_EQ(eye->clusterType, CameraClusterType::EyeTracking);
+    EXPECT_FALSE(eye->calibration.hasIntrinsics);
+    EXPECT_FALSE(eye->calibration.hasPose);
+}
+
+TEST_F(CameraManagerTest, ClassifierRules) {
+    setCameras({
+        camera("depth0", ACAMERA_LENS_FACING_BACK, 640, 480),
+        camera("tof", ACAMERA_LENS_FACING_BACK, 320, 240),
+        camera("slam_left", ACAMERA_LENS_FACING_BACK, 1920, 1080),
+        camera("gaze", ACAMERA_LENS_FACING_FRONT, 400, 400),
+        camera("10", ACAMERA_LENS_FACING_BACK, 1920, 1080),
+        camera("11", ACAMERA_LENS_FACING_BACK, 1280, 720),
+        camera("12", ACAMERA_LENS_FACING_EXTERNAL, 1280, 720),
+        camera("13", ACAMERA_LENS_FACING_FRONT, 1280, 720),
+    });
+    CameraManager manager;
+    const auto cameras = manager.enumerateCameras();
+    ASSERT_EQ(cameras.size(), 8u);
+
+    // Id keywords win over resolution
+    EXPECT_EQ(find(cameras, "depth0")->clusterType, CameraClusterType::Depth);
+    EXPECT_EQ(find(cameras, "tof")->clusterType, CameraClusterType::Depth);
+    EXPECT_EQ(find(cameras, "slam_left")->clusterType, CameraClusterType::Avatar);
+    EXPECT_EQ(find(cameras, "gaze")->clusterType, CameraClusterType::EyeTracking);
+    // Then 1080p and up is passthrough, anything smaller tracking
+    EXPECT_EQ(find(cameras, "10")->clusterType, CameraClusterType::Passthrough);
+    EXPECT_EQ(find(cameras, "11")->clusterType, CameraClusterType::Avatar);
+    EXPECT_EQ(find(cameras, "12")->clusterType, CameraClusterType::Avatar);
+    EXPECT_EQ(find(cameras, "13")->clusterType, CameraClusterType::Avatar);
+}
+
+TEST_F(CameraManagerTest, LogicalCameraListsEveryPhysicalId) {
+    auto logical = camera("20", ACAMERA_LENS_FACING_BACK, 4000, 3000);
+    logical.physicalIds = "21,22,23";
+    setCameras({logical, camera("21", ACAMERA_LENS_FACING_BACK, 4000, 3000)});
+
+    CameraManager manager;
+    const auto cameras = manager.enumerateCameras();
+    const CameraInfo* info = find(cameras, "20");
+    ASSERT_NE(info, nullptr);
+    EXPECT_FALSE(info->isPhysicalCamera);
+    EXPECT_EQ(info->physicalCameraIds, "21,22,23");
+    EXPECT_TRUE(find(cameras, "21")->isPhysicalCamera);
+}
+
+TEST_F(CameraManagerTest, EnumerationIsCachedUntilRefreshed) {
+    CameraManager manager;
+    ASSERT_EQ(manager.enumerateCameras().size(), 4u);
+
+    setCameras({camera("30", ACAMERA_LENS_FACING_BACK, 1920, 1080)});
+    EXPECT_EQ(manager.enumerateCameras().size(), 4u);
+    const auto refreshed = manager.enumerateCameras(true);
+    ASSERT_EQ(refreshed.size(), 1u);
+    EXPECT_EQ(refreshed[0].id, "30");
+}
+
+TEST_F(CameraManagerTest, SkipsCamerasWithoutStreamConfigurations) {
+    setCameras({camera("40", ACAMERA_LENS_FACING_BACK, 0, 0), camera("41", ACAMERA_LENS_FACING_BACK, 640, 480)});
+    CameraManager manager;
+    const auto cameras = manager.enumerateCameras();
+    ASSERT_EQ(cameras.size(), 1u);
+    EXPECT_EQ(cameras[0].id, "41");
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,228 @@
+#include <android/log.h>
+#include <camera/NdkCameraDevice.h>
+#include <camera/NdkCameraError.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "camera_manager.h"
+#include "camera_stream.h"
+#include "frame_pool.h"
+#include "test_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+class CameraStreamTest : public SyntheticBackendTest {
+protected:
+    void SetUp() override {
+        SyntheticBackendTest::SetUp();
+        manager_ = std::make_unique<CameraManager>();
+        window_ = createWindow(640, 480);
+    }
+
+    void TearDown() override {
+        manager_.reset();
+        ANativeWindow_release(window_);
+        SyntheticBackendTest::TearDown();
+    }
+
+    std::unique_ptr<CameraManager> manager_;
+    ANativeWindow* window_ = nullptr;
+};
+
+TEST_F(CameraStreamTest, StreamsAtTheAdvertisedRateAndLatency) {
+    CameraStream stream(*manager_);
+    ASSERT_TRUE(stream.startPreview("1", window_));
+    EXPECT_TRUE(stream.isStreaming());
+    EXPECT_EQ(stream.getCurrentCameraId(), "1");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    const CameraStats stats = stream.getStats();
+    stream.stopPreview();
+    EXPECT_FALSE(stream.isStreaming());
+
+    // Camera "1" runs at 60 fps with 20 ms from sensor timestamp to callback
+    EXPECT_NEAR(stats.frameRateHz, 60.0f, 6.0f);
+    EXPECT_GE(stats.latencyMs, 19.0f);
+    EXPECT_LT(stats.latencyMs, 60.0f);
+    EXPECT_GT(stats.frameCount, 15);
+    EXPECT_LT(stats.frameCount, 40);
+}
+
+TEST_F(CameraStreamTest, FrameCallbackCarriesCaptureResults) {
+    CameraStream stream(*manager_);
+    std::mutex mutex;
+    std::vector<FrameMetadata> frames;
+    stream.setFrameCallback([&](const FrameMetadata& frame) {
+        std::lock_guard<std::mutex> lock(mutex);
+        frames.push_back(frame);
+    });
+    ASSERT_TRUE(stream.startPreview("1", window_));
+    ASSERT_TRUE(waitUntil([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return frames.size() >= 3;
+    }));
+    stream.stopPreview();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(frames[0].cameraId, "1");
+    EXPECT_EQ(frames[0].width, 640);
+    EXPECT_EQ(frames[0].exposureTimeNs, 8'000'000);
+    EXPECT_EQ(frames[0].rollingShutterSkewNs, 5'000'000);
+    EXPECT_EQ(frames[1].frameNumber, frames[0].frameNumber + 1);
+    EXPECT_GT(frames[1].timestampNs, frames[0].timestampNs);
+    EXPECT_GE(frames[0].resultNs, frames[0].timestampNs);
+}
+
+TEST_F(CameraStreamTest, AnalysisOutputCopiesLumaIntoThePool) {
+    CameraStream stream(*manager_);
+    auto pool = std::make_shared<FramePool>(640, 480, 4);
+    std::mutex mutex;
+    std::vector<FrameRef> frames;
+    stream.setAnalysisOutput(pool, [&](const FrameRef& frame) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (frames.size() < 2) {
+            frames.push_back(frame);
+        }
+    });
+    ASSERT_TRUE(stream.startPreview("1", window_));
+    ASSERT_TRUE(waitUntil([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return frames.size() == 2;
+    }));
+    stream.stopPreview();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const FrameBuffer& frame = *frames[0];
+    EXPECT_EQ(frame.width(), 640);
+    EXPECT_EQ(frame.metadata.cameraId, "1");
+    EXPECT_GT(frame.metadata.timestampNs, 0);
+    // The synthetic gradient: luma = x + y + frame number
+    const uint8_t base = frame.row(0)[0];
+    EXPECT_EQ(frame.row(0)[5], static_cast<uint8_t>(base + 5));
+    EXPECT_EQ(frame.row(7)[0], static_cast<uint8_t>(base + 7));
+    frames.clear();
+}
+
+TEST_F(CameraStreamTest, CaptureStillDeliversJpeg) {
+    CameraStream stream(*manager_);
+    stream.setStillOutput(640, 480);
+    EXPECT_FALSE(stream.captureStill([](const uint8_t*, size_t, int64_t) {}));
+    ASSERT_TRUE(stream.startPreview("1", window_));
+
+    std::atomic<bool> received{false};
+    std::vector<uint8_t> jpeg;
+    ASSERT_TRUE(waitUntil([&] {
+        return stream.captureStill([&](const uint8_t* data, size_t size, int64_t) {
+            jpeg.assign(data, data + size);
+            received.store(true, std::memory_order_release);
+        });
+    }));
+    ASSERT_TRUE(waitUntil([&received] { return received.load(std::memory_order_acquire); }));
+    stream.stopPreview();
+
+    ASSERT_GE(jpeg.size(), 4u);
+    EXPECT_EQ(jpeg[0], 0xFF);
+    EXPECT_EQ(jpeg[1], 0xD8);
+    EXPECT_EQ(jpeg[jpeg.size() - 2], 0xFF);
+    EXPECT_EQ(jpeg[jpeg.size() - 1], 0xD9);
+}
+
+TEST_F(CameraStreamTest, EveryStillCallbackRunsOnceWithItsOwnOutcome) {
+    CameraStream stream(*manager_);
+    stream.setStillOutput(640, 480);
+    ASSERT_TRUE(stream.startPreview("1", window_));
+
+    // (still, JPEG size or 0 for a failure) in callback order
+    std::mutex mutex;
+    std::vector<std::pair<int, size_t>> results;
+    const auto onStill = [&](int still) {
+        return [&, still](const uint8_t* data, size_t size, int64_t) {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.emplace_back(still, data ? size : 0);
+        };
+    };
+    const auto resultCount = [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return results.size();
+    };
+    ASSERT_TRUE(waitUntil([&] { return stream.captureStill(onStill(0)); }));
+    ASSERT_TRUE(waitUntil([&] { return resultCount() == 1; }));
+
+    // A failed and a lost still must not take the JPEG of the one after them
+    failStills("1", 1);
+    ASSERT_TRUE(stream.captureStill(onStill(1)));
+    failStills("1", 1, true);
+    ASSERT_TRUE(stream.captureStill(onStill(2)));
+    ASSERT_TRUE(stream.captureStill(onStill(3)));
+    ASSERT_TRUE(waitUntil([&] { return resultCount() == 4; }));
+
+    // Stopping settles whatever is still pending
+    ASSERT_TRUE(stream.captureStill(onStill(4)));
+    stream.stopPreview();
+    ASSERT_EQ(resultCount(), 5u);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int still = 0; still < 5; ++still) {
+        EXPECT_EQ(results[static_cast<size_t>(still)].first, still);
+    }
+    EXPECT_GT(results[0].second, 0u);
+    EXPECT_EQ(results[1].second, 0u);
+    EXPECT_EQ(results[2].second, 0u);
+    EXPECT_GT(results[3].second, 0u);
+}
+
+TEST_F(CameraStreamTest, SwitchingCamerasReleasesThePreviousSession) {
+    CameraStream stream(*manager_);
+    ASSERT_TRUE(stream.startPreview("1", window_));
+    ASSERT_TRUE(stream.startPreview("2", window_));
+    EXPECT_EQ(stream.getCurrentCameraId(), "2");
+    EXPECT_EQ(liveHandles().cameraDevices, 1);
+    EXPECT_EQ(liveHandles().captureSessions, 1);
+    stream.stopPreview();
+}
+
+TEST_F(CameraStreamTest, OpenFailureCleansUp) {
+    setCameraOpenError("1", ACAMERA_ERROR_PERMISSION_DENIED);
+    CameraStream stream(*manager_);
+    EXPECT_FALSE(stream.startPreview("1", window_));
+    EXPECT_FALSE(stream.isStreaming());
+    EXPECT_EQ(liveHandles().cameraDevices, 0);
+    EXPECT_EQ(liveHandles().windows, 1);  // Only the test's own reference
+
+    EXPECT_FALSE(stream.startPreview("missing", window_));
+    EXPECT_GT(loggedCount(ANDROID_LOG_ERROR), 0);
+}
+
+TEST_F(CameraStreamTest, LostDeviceIsReleasedByStopAndRestart) {
+    CameraStream stream(*manager_);
+    ASSERT_TRUE(stream.startPreview("1", window_));
+    disconnectCamera("1");
+    EXPECT_FALSE(stream.isStreaming());
+    EXPECT_EQ(liveHandles().cameraDevices, 1);  // Ours until stopPreview()
+    stream.stopPreview();
+    EXPECT_EQ(liveHandles().cameraDevices, 0);
+    EXPECT_EQ(liveHandles().windows, 1);
+
+    // Restarting the same camera after an error reopens it instead of
+    // overwriting the failed device's handles
+    ASSERT_TRUE(stream.startPreview("1", window_));
+    failCamera("1", ERROR_CAMERA_DEVICE);
+    EXPECT_FALSE(stream.isStreaming());
+    ASSERT_TRUE(stream.startPreview("1", window_));
+    EXPECT_TRUE(stream.isStreaming());
+    EXPECT_EQ(liveHandles().cameraDevices, 1);
+    EXPECT_EQ(liveHandles().captureSessions, 1);
+    stream.stopPreview();
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,121 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "capability_cache.h"
+#include "test_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+std::vector<SensorInfo> sampleSensors() {
+    return {
+        {0, SensorType::Accelerometer, "Accel", "Vendor", 2500, 400.0f, 3000},
+        {1, SensorType::Gyroscope, "Gyro", "Vendor", 2500, 400.0f, 3000},
+    };
+}
+
+CameraInfo sampleCamera(const char* id, bool physical) {
+    CameraInfo camera;
+    camera.id = id;
+    camera.facing = CameraFacing::Front;
+    camera.clusterType = CameraClusterType::Avatar;
+    camera.width = 640;
+    camera.height = 480;
+    camera.maxFps = 60;
+    camera.isPhysicalCamera = physical;
+    camera.physicalCameraIds = physical ? "" : "22,23";
+    camera.calibration.fx = 512.0f;
+    camera.calibration.fy = 512.0f;
+    camera.calibration.cx = 320.0f;
+    camera.calibration.cy = 240.0f;
+    camera.calibration.distortion[0] = -0.1f;
+    camera.calibration.poseTranslation[0] = -0.032f;
+    camera.calibration.hasIntrinsics = true;
+    camera.calibration.hasDistortion = true;
+    camera.calibration.hasPose = true;
+    return camera;
+}
+
+std::vector<CameraInfo> sampleCameras() {
+    return {sampleCamera("1", true), sampleCamera("21", false)};
+}
+
+class CapabilityCacheTest : public ::testing::Test {
+protected:
+    std::string path() const { return dir_.path() + "/capabilities.bin"; }
+
+    TempDir dir_;
+};
+
+TEST_F(CapabilityCacheTest, MissingFileIsAMiss) {
+    CapabilityCache cache(path(), "device");
+    EXPECT_FALSE(cache.load());
+    EXPECT_FALSE(cache.isValid());
+    EXPECT_FALSE(cache.matches({}, {}));
+}
+
+TEST_F(CapabilityCacheTest, StoreThenLoadRoundTrips) {
+    ASSERT_TRUE(CapabilityCache(path(), "device").store(sampleSensors(), sampleCameras()));
+
+    CapabilityCache cache(path(), "device");
+    ASSERT_TRUE(cache.load());
+    ASSERT_EQ(cache.sensors().size(), 2u);
+    EXPECT_STREQ(cache.sensors()[1].name, "Gyro");
+    EXPECT_STREQ(cache.sensors()[1].vendor, "Vendor");
+    EXPECT_EQ(cache.sensors()[1].minDelayUs, 2500);
+    ASSERT_EQ(cache.cameras().size(), 2u);
+    EXPECT_EQ(cache.cameras()[1].physicalCameraIds, "22,23");
+    EXPECT_FLOAT_EQ(cache.cameras()[0].calibration.fx, 512.0f);
+    EXPECT_FLOAT_EQ(cache.cameras()[0].calibration.poseTranslation[0], -0.032f);
+    EXPECT_TRUE(cache.matches(sampleSensors(), sampleCameras()));
+
+    auto changed = sampleCameras();
+    changed[0].maxFps = 30;
+    EXPECT_FALSE(cache.matches(sampleSensors(), changed));
+    EXPECT_FALSE(cache.matches({}, sampleCameras()));
+}
+
+TEST_F(CapabilityCacheTest, OtherDeviceFingerprintIsRejected) {
+    ASSERT_TRUE(CapabilityCache(path(), "device").store(sampleSensors(), sampleCameras()));
+    CapabilityCache cache(path(), "other device");
+    EXPECT_FALSE(cache.load());
+    EXPECT_TRUE(cache.sensors().empty());
+}
+
+TEST_F(CapabilityCacheTest, CorruptedPayloadIsRejected) {
+    ASSERT_TRUE(CapabilityCache(path(), "device").store(sampleSensors(), sampleCameras()));
+    {
+        std::fstream file(path(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(0, std::ios::end);
+        const auto size = static_cast<std::streamoff>(file.tellg());
+        file.seekp(size - 3);
+        file.put('\x7f');
+    }
+    EXPECT_FALSE(CapabilityCache(path(), "device").load());
+
+    // Truncated to less than a header
+    std::FILE* file = std::fopen(path().c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fputs("NS", file);
+    std::fclose(file);
+    EXPECT_FALSE(CapabilityCache(path(), "device").load());
+}
+
+TEST_F(CapabilityCacheTest, StoreDoesNotDisturbTheMappedContents) {
+    ASSERT_TRUE(CapabilityCache(path(), "device").store(sampleSensors(), sampleCameras()));
+    CapabilityCache cache(path(), "device");
+    ASSERT_TRUE(cache.load());
+    ASSERT_TRUE(cache.store({}, {}));
+    EXPECT_STREQ(cache.sensors()[0].name, "Accel");
+
+    CapabilityCache reloaded(path(), "device");
+    ASSERT_TRUE(reloaded.load());
+    EXPECT_TRUE(reloaded.sensors().empty());
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,175 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bounded_queue.h"
+#include "seqlock.h"
+#include "thread_pool.h"
+#include "triple_buffer.h"
+
+namespace nativesensor::testing {
+namespace {
+
+TEST(BoundedQueueTest, RoundsCapacityUpAndRejectsWhenFull) {
+    BoundedQueue<int> queue(5);
+    EXPECT_EQ(queue.capacity(), 8u);
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_TRUE(queue.tryPush(i));
+    }
+    EXPECT_FALSE(queue.tryPush(8));
+    EXPECT_EQ(queue.sizeApprox(), 8u);
+
+    int value = -1;
+    ASSERT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(value, 0);
+}
+
+// Several producers and consumers: nothing lost, nothing delivered twice
+TEST(BoundedQueueTest, MpmcDeliversEveryItemOnce) {
+    constexpr int kProducers = 3;
+    constexpr int kConsumers = 3;
+    constexpr uint32_t kPerProducer = 50'000;
+    BoundedQueue<uint32_t> queue(256);
+    std::vector<std::atomic<uint8_t>> seen(kProducers * kPerProducer);
+    std::atomic<uint32_t> consumed{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&queue, p] {
+            for (uint32_t i = 0; i < kPerProducer; ++i) {
+                const uint32_t item = static_cast<uint32_t>(p) * kPerProducer + i;
+                while (!queue.tryPush(item)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < kConsumers; ++c) {
+        threads.emplace_back([&] {
+            uint32_t item = 0;
+            while (consumed.load(std::memory_order_relaxed) < kProducers * kPerProducer) {
+                if (queue.tryPop(item)) {
+                    seen[item].fetch_add(1, std::memory_order_relaxed);
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& count : seen) {
+        ASSERT_EQ(count.load(), 1);
+    }
+}
+
+struct Sample {
+    uint64_t a = 0;
+    uint64_t b = 0;
+    uint64_t c = 0;
+};
+
+// Readers racing the writer never see a torn value, and versions only grow
+TEST(TripleBufferTest, ReadersNeverSeeTornValues) {
+    TripleBuffer<Sample> buffer;
+    Sample out;
+    EXPECT_FALSE(buffer.load(out));
+
+    constexpr uint64_t kStores = 100'000;
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    std::atomic<int> torn{0};
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&] {
+            uint64_t last = 0;
+            Sample value;
+            while (!done.load(std::memory_order_acquire)) {
+                if (!buffer.load(value)) {
+                    continue;
+                }
+                if (value.b != value.a * 2 || value.c != value.a * 3 || value.a < last) {
+                    torn.fetch_add(1, std::memory_order_relaxed);
+                }
+                last = value.a;
+            }
+        });
+    }
+    for (uint64_t i = 1; i <= kStores; ++i) {
+        buffer.store({i, i * 2, i * 3});
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(buffer.version(), kStores);
+    ASSERT_TRUE(buffer.load(out));
+    EXPECT_EQ(out.a, kStores);
+}
+
+// Same check for the SeqLock, whose payload does not fill whole words
+TEST(SeqLockTest, ReadersNeverSeeTornValues) {
+    struct Odd {
+        uint64_t a = 0;
+        uint32_t b = 0;
+        uint8_t c = 0;
+    };
+    SeqLock<Odd> lock(Odd{7, 14, 21});
+    EXPECT_EQ(lock.version(), 1u);
+    EXPECT_EQ(lock.load().b, 14u);
+
+    constexpr uint64_t kStores = 100'000;
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    std::atomic<int> torn{0};
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&] {
+            uint64_t last = 0;
+            while (!done.load(std::memory_order_acquire)) {
+                const Odd value = lock.load();
+                if (value.b != static_cast<uint32_t>(value.a * 2) ||
+                    value.c != static_cast<uint8_t>(value.a * 3) || value.a < last) {
+                    torn.fetch_add(1, std::memory_order_relaxed);
+                }
+                last = value.a;
+            }
+        });
+    }
+    for (uint64_t i = 8; i < 8 + kStores; ++i) {
+        lock.store({i, static_cast<uint32_t>(i * 2), static_cast<uint8_t>(i * 3)});
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(lock.version(), kStores + 1);
+    EXPECT_EQ(lock.load().a, 8 + kStores - 1);
+}
+
+TEST(ThreadPoolTest, ParallelForCoversEveryIndexOnce) {
+    ThreadPool pool(3);
+    std::vector<std::atomic<int>> hits(1000);
+    pool.parallelFor(hits.size(), [&hits](size_t i) { hits[i].fetch_add(1, std::memory_order_relaxed); });
+    for (const auto& hit : hits) {
+        ASSERT_EQ(hit.load(), 1);
+    }
+
+    std::atomic<int> tasks{0};
+    for (int i = 0; i < 100; ++i) {
+        pool.submit([&tasks] { tasks.fetch_add(1, std::memory_order_relaxed); });
+    }
+    pool.waitIdle();
+    EXPECT_EQ(tasks.load(), 100);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
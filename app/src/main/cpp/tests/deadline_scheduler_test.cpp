@@ -0,0 +1,246 @@
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "deadline_scheduler.h"
+#include "test_utils.h"
+#include "time_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr int64_t kPeriodNs = 16'666'667;
+constexpr int64_t kWorkNs = 300'000;
+
+FrameTimeline frameAt(TimestampNs vsyncNs) {
+    FrameTimeline frame;
+    frame.vsyncNs = vsyncNs;
+    frame.deadlineNs = vsyncNs - 2 * kNsPerMs;
+    frame.presentNs = vsyncNs + kPeriodNs;
+    return frame;
+}
+
+/// Task that takes workNs of simulated time and reports the planned and actual start
+class SimulatedWork {
+public:
+    SimulatedWork(SimulatedFrameClock& clock, DeadlineScheduler& scheduler, int64_t workNs)
+        : clock_(clock), scheduler_(scheduler), workNs_(workNs) {}
+
+    DeadlineScheduler::FrameTask task() {
+        return [this](const FrameTimeline& frame) {
+            const TimestampNs startNs = clock_.nowNs();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                // The budget only changes after the task returns, so this is
+                // the start the scheduler planned for this frame
+                planned_.push_back(scheduler_.plannedStartNs(frame));
+                started_.push_back(startNs);
+                vsyncs_.push_back(frame.vsyncNs);
+            }
+            clock_.advance(workNs_);
+            return startNs - 2 * kNsPerMs;  // Input sampled 2 ms before the start
+        };
+    }
+
+    std::vector<TimestampNs> planned() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return planned_;
+    }
+
+    std::vector<TimestampNs> started() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return started_;
+    }
+
+    std::vector<TimestampNs> vsyncs() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return vsyncs_;
+    }
+
+private:
+    SimulatedFrameClock& clock_;
+    DeadlineScheduler& scheduler_;
+    const int64_t workNs_;
+    std::mutex mutex_;
+    std::vector<TimestampNs> planned_;
+    std::vector<TimestampNs> started_;
+    std::vector<TimestampNs> vsyncs_;
+};
+
+TEST(DeadlineSchedulerTest, StartsAtDeadlineMinusBudgetAndMargin) {
+    SimulatedFrameClock clock;
+    DeadlineScheduler scheduler(clock);
+    SimulatedWork work(clock, scheduler, kWorkNs);
+    const DeadlineSchedulerConfig config;
+
+    // No history: the budget is the configured minimum
+    const FrameTimeline first = frameAt(20 * kNsPerMs);
+    EXPECT_EQ(scheduler.plannedStartNs(first),
+              first.deadlineNs - config.minWorkEstimateNs - config.safetyMarginNs);
+    EXPECT_TRUE(scheduler.runFrame(first, work.task()));
+    EXPECT_EQ(work.started(), work.planned());
+    EXPECT_EQ(work.started().at(0), first.deadlineNs - config.minWorkEstimateNs - config.safetyMarginNs);
+
+    DeadlineStats stats = scheduler.getStats();
+    EXPECT_EQ(stats.frames, 1);
+    EXPECT_EQ(stats.misses, 0);
+    EXPECT_FLOAT_EQ(stats.avgWakeLateUs, 0.0f);
+    EXPECT_FLOAT_EQ(stats.avgWorkUs, 300.0f);
+    EXPECT_FLOAT_EQ(stats.avgInputAgeUs, 2300.0f);
+    // Finished 0.3 ms after a start 0.55 ms ahead of the deadline
+    EXPECT_FLOAT_EQ(stats.avgSlackUs, 250.0f);
+}
+
+TEST(DeadlineSchedulerTest, BudgetTracksMeanPlusFourDeviations) {
+    SimulatedFrameClock clock;
+    DeadlineScheduler scheduler(clock);
+    SimulatedWork work(clock, scheduler, kWorkNs);
+
+    // First sample seeds mean = w and deviation = w / 2: 3 w
+    TimestampNs vsync = 20 * kNsPerMs;
+    scheduler.runFrame(frameAt(vsync), work.task());
+    EXPECT_FLOAT_EQ(scheduler.getStats().workBudgetUs, 900.0f);
+    // Same duration again: the deviation decays by a quarter
+    vsync += kPeriodNs;
+    scheduler.runFrame(frameAt(vsync), work.task());
+    EXPECT_FLOAT_EQ(scheduler.getStats().workBudgetUs, 750.0f);
+
+    for (int i = 0; i < 100; ++i) {
+        vsync += kPeriodNs;
+        EXPECT_TRUE(scheduler.runFrame(frameAt(vsync), work.task()));
+    }
+    const DeadlineStats stats = scheduler.getStats();
+    EXPECT_NEAR(stats.workBudgetUs, 300.0f, 1.0f);
+    EXPECT_EQ(stats.misses, 0);
+    EXPECT_GT(stats.avgSlackUs, 0.0f);
+
+    // Every frame started exactly when planned
+    const auto planned = work.planned();
+    const auto started = work.started();
+    EXPECT_EQ(planned, started);
+    EXPECT_NEAR(static_cast<double>(planned.back()),
+                static_cast<double>(frameAt(vsync).deadlineNs - kWorkNs - DeadlineSchedulerConfig{}.safetyMarginNs),
+                1'000.0);
+}
+
+TEST(DeadlineSchedulerTest, BudgetIsClampedToOnePeriod) {
+    SimulatedFrameClock clock;
+    DeadlineScheduler scheduler(clock);
+    SimulatedWork work(clock, scheduler, 3 * kPeriodNs);
+
+    EXPECT_FALSE(scheduler.runFrame(frameAt(20 * kNsPerMs), work.task()));
+    const DeadlineStats stats = scheduler.getStats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_LT(stats.avgSlackUs, 0.0f);
+    EXPECT_NEAR(stats.workBudgetUs, static_cast<float>(kPeriodNs) / 1000.0f, 0.01f);
+}
+
+TEST(DeadlineSchedulerTest, LateWakeIsMeasuredFromThePlannedStart) {
+    SimulatedFrameClock clock;
+    DeadlineScheduler scheduler(clock);
+    SimulatedWork work(clock, scheduler, kWorkNs);
+
+    const FrameTimeline frame = frameAt(20 * kNsPerMs);
+    clock.sleepUntil(scheduler.plannedStartNs(frame) + 300'000);
+    EXPECT_FALSE(scheduler.runFrame(frame, work.task()));
+    EXPECT_FLOAT_EQ(scheduler.getStats().avgWakeLateUs, 300.0f);
+}
+
+TEST(DeadlineSchedulerTest, PeriodEstimateFollowsVsyncAndIgnoresMissedCallbacks) {
+    SimulatedFrameClock clock;
+    DeadlineScheduler scheduler(clock);
+    constexpr int64_t k90HzNs = 11'111'111;
+
+    TimestampNs vsync = kNsPerSecond;
+    for (int i = 0; i < 200; ++i) {
+        scheduler.onVsync(frameAt(vsync));
+        vsync += k90HzNs;
+    }
+    EXPECT_NEAR(scheduler.getStats().vsyncPeriodMs, 11.111f, 0.01f);
+
+    // Two callbacks lost: a three-period gap still counts as one period
+    vsync += 2 * k90HzNs;
+    scheduler.onVsync(frameAt(vsync));
+    EXPECT_NEAR(scheduler.getStats().vsyncPeriodMs, 11.111f, 0.01f);
+
+    // Later frames are extrapolated from the latest timeline: the earliest
+    // one whose planned start is still ahead
+    const TimestampNs nowNs = vsync + 5 * k90HzNs;
+    const FrameTimeline next = scheduler.nextFrame(nowNs);
+    EXPECT_GE(scheduler.plannedStartNs(next), nowNs);
+    EXPECT_LT(scheduler.plannedStartNs(next), nowNs + k90HzNs);
+    EXPECT_EQ(next.deadlineNs - next.vsyncNs, -2 * kNsPerMs);
+}
+
+/// Run the frame thread until the task has run `frames` times
+void runThread(DeadlineScheduler& scheduler, SimulatedWork& work, int frames) {
+    std::atomic<int> ran{0};
+    std::atomic<bool> holding{false};
+    std::atomic<bool> release{false};
+    auto task = work.task();
+    scheduler.start([&](const FrameTimeline& frame) {
+        const TimestampNs inputNs = task(frame);
+        if (ran.fetch_add(1) + 1 == frames) {
+            holding = true;
+            waitUntil([&release] { return release.load(); });
+        }
+        return inputNs;
+    });
+    ASSERT_TRUE(waitUntil([&holding] { return holding.load(); }));
+    // stop() joins the frame thread, so let the held frame go once stopping
+    std::thread stopper([&scheduler] { scheduler.stop(); });
+    ASSERT_TRUE(waitUntil([&scheduler] { return !scheduler.isRunning(); }));
+    release = true;
+    stopper.join();
+}
+
+TEST(DeadlineSchedulerTest, FrameThreadServesEveryFrameWhenWorkFits) {
+    SimulatedFrameClock clock(kNsPerSecond);
+    DeadlineScheduler scheduler(clock);
+    scheduler.onVsync(frameAt(kNsPerSecond + kPeriodNs));
+    SimulatedWork work(clock, scheduler, kWorkNs);
+    runThread(scheduler, work, 20);
+
+    const DeadlineStats stats = scheduler.getStats();
+    EXPECT_EQ(stats.frames, 20);
+    EXPECT_EQ(stats.misses, 0);
+    EXPECT_EQ(stats.skipped, 0);
+    EXPECT_FLOAT_EQ(stats.avgWakeLateUs, 0.0f);
+    const auto vsyncs = work.vsyncs();
+    for (size_t i = 1; i < vsyncs.size(); ++i) {
+        EXPECT_EQ(vsyncs[i] - vsyncs[i - 1], kPeriodNs);
+    }
+    EXPECT_EQ(work.planned(), work.started());
+}
+
+TEST(DeadlineSchedulerTest, FrameThreadCountsMissesAndSkippedFrames) {
+    SimulatedFrameClock clock(kNsPerSecond);
+    DeadlineScheduler scheduler(clock);
+    scheduler.onVsync(frameAt(kNsPerSecond + kPeriodNs));
+    // Each run overruns its deadline by half a period and lands past the
+    // next frame's start, so frames go by without a run
+    SimulatedWork work(clock, scheduler, kPeriodNs + kPeriodNs / 2);
+    runThread(scheduler, work, 20);
+
+    const DeadlineStats stats = scheduler.getStats();
+    EXPECT_EQ(stats.frames, 20);
+    EXPECT_EQ(stats.misses, 20);
+    // Skipped counts exactly the frames between the served ones
+    const auto vsyncs = work.vsyncs();
+    int64_t between = 0;
+    for (size_t i = 1; i < vsyncs.size(); ++i) {
+        const int64_t gap = vsyncs[i] - vsyncs[i - 1];
+        EXPECT_EQ(gap % kPeriodNs, 0);
+        EXPECT_GE(gap, 2 * kPeriodNs);
+        between += gap / kPeriodNs - 1;
+    }
+    EXPECT_EQ(stats.skipped, between);
+    EXPECT_GE(stats.skipped, 19);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,214 @@
+#include <cmath>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include "eskf.h"
+#include "geometry.h"
+#include "time_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr int64_t kImuPeriodNs = 2'500'000;     // 400 Hz
+constexpr float kDt = 0.0025f;
+constexpr float kGravity = 9.81f;
+constexpr TimestampNs kStartNs = kNsPerSecond;
+
+// Error-state layout: dp, dv, dtheta, dba, dbg
+constexpr size_t kPos = 0;
+constexpr size_t kVel = 3;
+constexpr size_t kAtt = 6;
+constexpr size_t kAccelBias = 9;
+
+float angleError(const Quat& a, const Quat& b) {
+    return norm(quat::toRotationVector(conjugate(a) * b));
+}
+
+PoseMeasurement measurementAt(TimestampNs timestampNs, const Vec3& position, const Quat& orientation = {}) {
+    PoseMeasurement measurement;
+    measurement.timestampNs = timestampNs;
+    measurement.position[0] = position.x;
+    measurement.position[1] = position.y;
+    measurement.position[2] = position.z;
+    measurement.orientation = orientation;
+    measurement.positionStdM = 0.01f;
+    measurement.orientationStdRad = 0.01f;
+    return measurement;
+}
+
+/// Feed one IMU step at rest (accel measures the reaction to gravity)
+void restStep(Eskf& filter, TimestampNs timestampNs) {
+    filter.addImuSample({0.0f, 0.0f, kGravity, timestampNs, SensorType::Accelerometer});
+    filter.addImuSample({0.0f, 0.0f, 0.0f, timestampNs, SensorType::Gyroscope});
+}
+
+bool isSymmetric(const Eskf::Covariance& p) {
+    for (size_t r = 0; r < Eskf::kStateDim; ++r) {
+        for (size_t c = 0; c < r; ++c) {
+            if (p.m[r][c] != p.m[c][r]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST(EskfTest, AlignsGravityBeforeReportingValid) {
+    Eskf filter;
+    const Vec3 measured = normalized(Vec3(0.0f, 3.0f, 9.0f)) * kGravity;   // Tilted about x
+    for (int i = 0; i < EskfConfig{}.alignmentSamples; ++i) {
+        EXPECT_FALSE(filter.getState().valid);
+        filter.addImuSample({measured.x, measured.y, measured.z, kStartNs + i * kImuPeriodNs,
+                             SensorType::Accelerometer});
+    }
+    const FusedState state = filter.getState();
+    ASSERT_TRUE(state.valid);
+    const Vec3 up = rotate(state.orientation, normalized(measured));
+    EXPECT_NEAR(up.x, 0.0f, 1e-5f);
+    EXPECT_NEAR(up.y, 0.0f, 1e-5f);
+    EXPECT_NEAR(up.z, 1.0f, 1e-5f);
+    EXPECT_NEAR(state.positionStdM, 0.01f, 1e-6f);
+}
+
+// Fresh filter: P is diagonal, so each measured axis is a scalar Kalman
+// update with K = P / (P + R) and P+ = P R / (P + R), and the unmeasured
+// states neither move nor lose variance
+TEST(EskfTest, UpdateMatchesScalarKalmanGainOnADiagonalPrior) {
+    Eskf filter;
+    filter.initialize(kStartNs, Quat::identity());
+    const Eskf::Covariance prior = filter.covariance();
+
+    const float yaw = 0.02f;
+    ASSERT_TRUE(filter.update(measurementAt(kStartNs, {0.02f, -0.01f, 0.0f},
+                                            quat::fromRotationVector({0.0f, 0.0f, yaw}))));
+    const Eskf::Covariance& posterior = filter.covariance();
+    const float r = 0.01f * 0.01f;
+    for (size_t i : {kPos, kPos + 1, kPos + 2, kAtt, kAtt + 1, kAtt + 2}) {
+        const float p = prior.m[i][i];
+        EXPECT_NEAR(posterior.m[i][i], p * r / (p + r), 1e-9f) << i;
+    }
+    for (size_t i : {kVel, kVel + 1, kVel + 2, kAccelBias, kAccelBias + 1}) {
+        EXPECT_FLOAT_EQ(posterior.m[i][i], prior.m[i][i]) << i;
+    }
+    EXPECT_TRUE(isSymmetric(posterior));
+
+    // Publish through a zero-length IMU step at the update time
+    filter.addImuSample({0.0f, 0.0f, kGravity, kStartNs, SensorType::Accelerometer});
+    filter.addImuSample({0.0f, 0.0f, 0.0f, kStartNs + 1, SensorType::Gyroscope});
+    const FusedState state = filter.getState();
+    const float posGain = prior.m[kPos][kPos] / (prior.m[kPos][kPos] + r);
+    const float yawGain = prior.m[kAtt + 2][kAtt + 2] / (prior.m[kAtt + 2][kAtt + 2] + r);
+    EXPECT_NEAR(state.position[0], 0.02f * posGain, 1e-5f);
+    EXPECT_NEAR(state.position[1], -0.01f * posGain, 1e-5f);
+    EXPECT_NEAR(state.velocity[0], 0.0f, 1e-6f);
+    EXPECT_NEAR(quat::toRotationVector(state.orientation).z, yaw * yawGain, 1e-4f);
+    EXPECT_LT(state.positionStdM, 0.01f);
+    EXPECT_EQ(filter.getStats().updates, 1);
+}
+
+TEST(EskfTest, GateRejectsOutliersWithoutTouchingTheState) {
+    Eskf filter;
+    filter.initialize(kStartNs, Quat::identity());
+    const Eskf::Covariance prior = filter.covariance();
+
+    EXPECT_FALSE(filter.update(measurementAt(kStartNs, {1.0f, 0.0f, 0.0f})));
+    EXPECT_EQ(filter.getStats().rejectedUpdates, 1);
+    EXPECT_EQ(filter.getStats().updates, 0);
+    for (size_t i = 0; i < Eskf::kStateDim; ++i) {
+        EXPECT_EQ(filter.covariance().m[i][i], prior.m[i][i]);
+    }
+}
+
+TEST(EskfTest, PropagatesKinematicsAndGrowsUncertainty) {
+    Eskf filter;
+    filter.initialize(kStartNs, Quat::identity());
+    const Eskf::Covariance prior = filter.covariance();
+
+    // Accelerate at 0.5 m/s^2 along x for 1 s, then coast for 1 s while
+    // yawing at 1 rad/s
+    for (int i = 0; i < 400; ++i) {
+        filter.propagate({0.5f, 0.0f, kGravity}, {0.0f, 0.0f, 0.0f}, kDt);
+    }
+    for (int i = 0; i < 400; ++i) {
+        filter.propagate({0.0f, 0.0f, kGravity}, {0.0f, 0.0f, 1.0f}, kDt);
+    }
+    filter.addImuSample({0.0f, 0.0f, kGravity, kStartNs, SensorType::Accelerometer});
+    filter.addImuSample({0.0f, 0.0f, 0.0f, kStartNs + 1, SensorType::Gyroscope});
+    const FusedState state = filter.getState();
+
+    // x = a t^2 / 2, then + (a t) t while coasting
+    EXPECT_NEAR(state.velocity[0], 0.5f, 1e-3f);
+    EXPECT_NEAR(state.position[0], 0.25f + 0.5f, 1e-3f);
+    EXPECT_NEAR(state.position[2], 0.0f, 1e-4f);
+    EXPECT_LT(angleError(state.orientation, quat::fromRotationVector({0.0f, 0.0f, 1.0f})), 1e-3f);
+
+    const Eskf::Covariance& p = filter.covariance();
+    EXPECT_TRUE(isSymmetric(p));
+    for (size_t i = 0; i < Eskf::kStateDim; ++i) {
+        EXPECT_GE(p.m[i][i], prior.m[i][i]) << i;
+    }
+    // Velocity noise alone adds accelNoise^2 per second
+    const float accelNoise = EskfConfig{}.accelNoise;
+    EXPECT_GT(p.m[kVel + 2][kVel + 2], prior.m[kVel + 2][kVel + 2] + 2.0f * accelNoise * accelNoise * 0.99f);
+    // Position picks up velocity uncertainty, so the two become correlated
+    EXPECT_GT(p.m[kPos][kVel], 0.0f);
+    EXPECT_EQ(filter.getStats().propagations, 801);
+}
+
+/// Run two filters over the same rest trace; `late` gets the measurement
+/// `lateSteps` IMU steps after its timestamp
+void runWithMeasurement(Eskf& filter, int lateSteps) {
+    filter.initialize(kStartNs, Quat::identity());
+    const int measuredStep = 40;
+    const PoseMeasurement measurement = measurementAt(kStartNs + measuredStep * kImuPeriodNs,
+                                                      {0.01f, 0.0f, -0.005f},
+                                                      quat::fromRotationVector({0.0f, 0.0f, 0.01f}));
+    for (int step = 1; step <= 100; ++step) {
+        if (step == measuredStep + lateSteps) {
+            filter.submitMeasurement(measurement);
+        }
+        restStep(filter, kStartNs + step * kImuPeriodNs);
+    }
+}
+
+TEST(EskfTest, LateMeasurementIsAppliedAtItsOwnTimestamp) {
+    Eskf onTime;
+    Eskf late;
+    runWithMeasurement(onTime, 0);
+    runWithMeasurement(late, 25);
+
+    const FusedState a = onTime.getState();
+    const FusedState b = late.getState();
+    EXPECT_EQ(a.timestampNs, b.timestampNs);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(a.position[i], b.position[i], 1e-6f) << i;
+        EXPECT_NEAR(a.velocity[i], b.velocity[i], 1e-6f) << i;
+    }
+    EXPECT_LT(angleError(a.orientation, b.orientation), 1e-5f);
+    EXPECT_NEAR(a.positionStdM, b.positionStdM, 1e-7f);
+
+    EXPECT_EQ(onTime.getStats().outOfOrderUpdates, 0);
+    const EskfStats stats = late.getStats();
+    EXPECT_EQ(stats.updates, 1);
+    EXPECT_EQ(stats.outOfOrderUpdates, 1);
+    EXPECT_EQ(stats.repropagatedSteps, 25);
+}
+
+TEST(EskfTest, MeasurementOlderThanHistoryIsRejected) {
+    EskfConfig config;
+    config.historySize = 8;
+    Eskf filter(config);
+    filter.initialize(kStartNs, Quat::identity());
+    for (int step = 1; step <= 20; ++step) {
+        restStep(filter, kStartNs + step * kImuPeriodNs);
+    }
+    ASSERT_TRUE(filter.submitMeasurement(measurementAt(kStartNs + 2 * kImuPeriodNs, {})));
+    restStep(filter, kStartNs + 21 * kImuPeriodNs);
+    const EskfStats stats = filter.getStats();
+    EXPECT_EQ(stats.updates, 0);
+    EXPECT_EQ(stats.rejectedUpdates, 1);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,117 @@
+#pragma once
+
+// State shared between the fake NDK translation units; tests use
+// synthetic_backend.h instead
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <android/looper.h>
+#include <android/native_window.h>
+#include <android/sensor.h>
+#include <media/NdkImageReader.h>
+
+#include "synthetic_backend.h"
+
+namespace nativesensor::testing::detail {
+
+constexpr int64_t kNsPerSecond = 1'000'000'000LL;
+
+[[nodiscard]] int64_t bootTimeNs() noexcept;
+[[nodiscard]] int64_t monotonicTimeNs() noexcept;
+
+/// steady_clock is CLOCK_MONOTONIC; boot time only differs across suspend
+[[nodiscard]] std::chrono::steady_clock::time_point steadyAtBootNs(int64_t bootNs) noexcept;
+
+/// Live handle bookkeeping behind liveHandles()
+enum class Handle {
+    SensorQueue,
+    CameraManager,
+    CameraDevice,
+    CaptureSession,
+    CaptureRequest,
+    OutputTarget,
+    SessionOutput,
+    OutputContainer,
+    CameraMetadata,
+    IdList,
+    ImageReader,
+    Image,
+    Window,
+    Count
+};
+
+void track(Handle handle, int delta) noexcept;
+
+/// Looper callback (Choreographer vsync), run unlocked from inside pollOnce
+struct LooperCallback {
+    std::chrono::steady_clock::time_point due;
+    std::function<void()> run;
+};
+
+/// Events due on a queue's registrations by nowBootNs are appended to its
+/// pending events. Caller holds the queue's looper mutex.
+void generateSensorEvents(ASensorEventQueue* queue, int64_t nowBootNs);
+
+/// Boot time the queue's next generated event is due, INT64_MAX if none.
+/// Caller holds the queue's looper mutex.
+[[nodiscard]] int64_t nextSensorEventNs(const ASensorEventQueue* queue);
+
+/// Hand a frame to the image reader behind a window, if any, and run its
+/// listener on the calling thread
+void deliverImage(ANativeWindow* window, int64_t timestampNs, int64_t frameNumber);
+
+/// Window owned by an image reader
+[[nodiscard]] ANativeWindow* createReaderWindow(AImageReader* reader, int32_t width, int32_t height,
+                                                int32_t format);
+
+/// Parts of resetSyntheticBackends(), defined next to the state they reset
+void resetSensorBackend();
+void resetCameraBackend();
+void resetDisplayBackend();
+void resetLogCounters();
+
+}  // namespace nativesensor::testing::detail
+
+struct ALooper {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool wakeRequested = false;
+    std::vector<ASensorEventQueue*> queues;
+    std::vector<nativesensor::testing::detail::LooperCallback> callbacks;
+};
+
+struct ASensor {
+    nativesensor::testing::SyntheticSensor spec;
+    int handle = 0;
+};
+
+struct ASensorEventQueue {
+    struct Registration {
+        const ASensor* sensor = nullptr;
+        int64_t periodNs = 0;
+        int64_t nextNs = 0;
+    };
+
+    // All guarded by looper->mutex
+    ALooper* looper = nullptr;
+    int ident = 0;
+    void* data = nullptr;
+    std::vector<Registration> registrations;
+    std::deque<ASensorEvent> pending;
+};
+
+struct ANativeWindow {
+    std::atomic<int> refs{1};
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t format = 0;
+    AImageReader* reader = nullptr;     // Guarded by the media registry mutex
+};
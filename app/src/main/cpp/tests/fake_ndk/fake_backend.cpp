@@ -0,0 +1,96 @@
+// Clocks, handle accounting and reset shared by the synthetic NDK backends
+
+#include <array>
+#include <ctime>
+#include <sstream>
+
+#include "backend_internal.h"
+
+namespace nativesensor::testing {
+
+namespace detail {
+
+namespace {
+
+std::array<std::atomic<int>, static_cast<size_t>(Handle::Count)> g_live{};
+
+int64_t clockNs(clockid_t clock) noexcept {
+    struct timespec t{};
+    clock_gettime(clock, &t);
+    return static_cast<int64_t>(t.tv_sec) * kNsPerSecond + t.tv_nsec;
+}
+
+}  // namespace
+
+int64_t bootTimeNs() noexcept {
+    return clockNs(CLOCK_BOOTTIME);
+}
+
+int64_t monotonicTimeNs() noexcept {
+    return clockNs(CLOCK_MONOTONIC);
+}
+
+std::chrono::steady_clock::time_point steadyAtBootNs(int64_t bootNs) noexcept {
+    const int64_t offsetNs = bootTimeNs() - monotonicTimeNs();
+    return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(bootNs - offsetNs));
+}
+
+void track(Handle handle, int delta) noexcept {
+    g_live[static_cast<size_t>(handle)].fetch_add(delta, std::memory_order_relaxed);
+}
+
+}  // namespace detail
+
+int LiveHandles::total() const noexcept {
+    return sensorQueues + cameraManagers + cameraDevices + captureSessions + captureRequests +
+           outputTargets + sessionOutputs + outputContainers + cameraMetadata + idLists + imageReaders +
+           images + windows;
+}
+
+std::string LiveHandles::toString() const {
+    std::ostringstream ss;
+    ss << "sensorQueues=" << sensorQueues
+       << " cameraManagers=" << cameraManagers
+       << " cameraDevices=" << cameraDevices
+       << " captureSessions=" << captureSessions
+       << " captureRequests=" << captureRequests
+       << " outputTargets=" << outputTargets
+       << " sessionOutputs=" << sessionOutputs
+       << " outputContainers=" << outputContainers
+       << " cameraMetadata=" << cameraMetadata
+       << " idLists=" << idLists
+       << " imageReaders=" << imageReaders
+       << " images=" << images
+       << " windows=" << windows;
+    return ss.str();
+}
+
+LiveHandles liveHandles() {
+    auto live = [](detail::Handle handle) {
+        return detail::g_live[static_cast<size_t>(handle)].load(std::memory_order_relaxed);
+    };
+    LiveHandles handles;
+    handles.sensorQueues = live(detail::Handle::SensorQueue);
+    handles.cameraManagers = live(detail::Handle::CameraManager);
+    handles.cameraDevices = live(detail::Handle::CameraDevice);
+    handles.captureSessions = live(detail::Handle::CaptureSession);
+    handles.captureRequests = live(detail::Handle::CaptureRequest);
+    handles.outputTargets = live(detail::Handle::OutputTarget);
+    handles.sessionOutputs = live(detail::Handle::SessionOutput);
+    handles.outputContainers = live(detail::Handle::OutputContainer);
+    handles.cameraMetadata = live(detail::Handle::CameraMetadata);
+    handles.idLists = live(detail::Handle::IdList);
+    handles.imageReaders = live(detail::Handle::ImageReader);
+    handles.images = live(detail::Handle::Image);
+    handles.windows = live(detail::Handle::Window);
+    return handles;
+}
+
+void resetSyntheticBackends() {
+    detail::resetSensorBackend();
+    detail::resetCameraBackend();
+    detail::resetDisplayBackend();
+    detail::resetLogCounters();
+}
+
+}  // namespace nativesensor::testing
@@ -0,0 +1,796 @@
+// Synthetic camera2 NDK: scripted cameras whose capture sessions run a frame
+// thread per repeating request. Each frame calls onCaptureStarted, hands
+// images to image readers among the request's targets, delivers (or fails)
+// queued stills and ends with onCaptureCompleted.
+//
+// g_camerasMutex guards the camera list and every device and session link.
+// Disconnect and error callbacks run under it; frame threads never take it,
+// so stopping a frame thread while holding it is safe.
+
+#include <camera/NdkCameraCaptureSession.h>
+#include <camera/NdkCameraDevice.h>
+#include <camera/NdkCameraManager.h>
+#include <camera/NdkCameraMetadata.h>
+#include <camera/NdkCaptureRequest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include "backend_internal.h"
+
+using nativesensor::testing::SyntheticCamera;
+
+struct ACameraMetadata {
+    struct Entry {
+        uint8_t type = 0;
+        uint32_t count = 0;
+        std::vector<int64_t> storage;   // 8-byte aligned for every entry type
+    };
+
+    template<typename T>
+    void set(uint32_t tag, uint8_t type, const std::vector<T>& values) {
+        Entry& entry = entries[tag];
+        entry.type = type;
+        entry.count = static_cast<uint32_t>(values.size());
+        entry.storage.assign((values.size() * sizeof(T) + sizeof(int64_t) - 1) / sizeof(int64_t), 0);
+        if (!values.empty()) {
+            std::memcpy(entry.storage.data(), values.data(), values.size() * sizeof(T));
+        }
+    }
+
+    camera_status_t get(uint32_t tag, ACameraMetadata_const_entry* out) const {
+        const auto it = entries.find(tag);
+        if (it == entries.end()) {
+            return ACAMERA_ERROR_METADATA_NOT_FOUND;
+        }
+        out->tag = tag;
+        out->type = it->second.type;
+        out->count = it->second.count;
+        out->data.u8 = reinterpret_cast<const uint8_t*>(it->second.storage.data());
+        return ACAMERA_OK;
+    }
+
+    std::map<uint32_t, Entry> entries;
+};
+
+struct ACameraManager {};
+
+struct ACameraOutputTarget {
+    ANativeWindow* window = nullptr;    // Holds a reference
+};
+
+struct ACaptureSessionOutput {
+    ANativeWindow* window = nullptr;    // Holds a reference
+};
+
+struct ACaptureSessionOutputContainer {
+    std::vector<const ACaptureSessionOutput*> outputs;
+};
+
+struct ACaptureRequest {
+    ACameraDevice_request_template templateId = TEMPLATE_PREVIEW;
+    std::vector<const ACameraOutputTarget*> targets;
+    ACameraMetadata settings;
+};
+
+struct ACameraDevice {
+    SyntheticCamera spec;
+    ACameraDevice_StateCallbacks callbacks{};
+    camera_status_t failure = ACAMERA_OK;       // Disconnected or failed
+    ACameraCaptureSession* session = nullptr;
+};
+
+struct ACameraCaptureSession {
+    enum class Fault { None, Failed, BufferLost };
+    struct Still {
+        ACaptureRequest* request = nullptr;
+        std::vector<ANativeWindow*> windows;
+        ACameraCaptureSession_captureCallbacks callbacks{};
+        int sequenceId = 0;
+        Fault fault = Fault::None;
+    };
+
+    // Guarded by g_camerasMutex
+    ACameraDevice* device = nullptr;
+    camera_status_t failure = ACAMERA_OK;
+
+    SyntheticCamera spec;
+    ACameraCaptureSession_stateCallbacks callbacks{};
+    std::vector<ANativeWindow*> outputs;        // Hold references
+
+    std::mutex stopMutex;                       // Serializes frame thread stops
+    std::thread driver;
+
+    // Guarded by mutex; the repeating request only changes while no frame thread runs
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopRequested = false;
+    ACameraCaptureSession_captureCallbacks repeating{};
+    ACaptureRequest* repeatingRequest = nullptr;
+    std::vector<ANativeWindow*> repeatingWindows;
+    std::deque<Still> stills;
+    int nextSequenceId = 0;
+};
+
+namespace nativesensor::testing::detail {
+
+namespace {
+
+constexpr int32_t kFormatYuv = 0x23;
+constexpr int32_t kFormatPrivate = 0x22;
+constexpr int32_t kFormatBlob = 0x21;
+constexpr int32_t kMinFps = 15;
+
+std::mutex g_camerasMutex;
+std::vector<SyntheticCamera> g_cameras = defaultCameras();
+std::map<std::string, camera_status_t> g_openErrors;
+struct StillFaults {
+    int count = 0;
+    bool bufferLost = false;
+};
+std::map<std::string, StillFaults> g_stillFaults;
+std::vector<ACameraDevice*> g_devices;
+
+const SyntheticCamera* findCamera(const std::string& id) {
+    for (const auto& camera : g_cameras) {
+        if (camera.id == id) {
+            return &camera;
+        }
+    }
+    return nullptr;
+}
+
+ACameraMetadata* characteristicsOf(const SyntheticCamera& camera) {
+    auto* metadata = new ACameraMetadata;
+    const int32_t w = camera.width;
+    const int32_t h = camera.height;
+    metadata->set<uint8_t>(ACAMERA_LENS_FACING, ACAMERA_TYPE_BYTE, {camera.facing});
+    metadata->set<int32_t>(ACAMERA_SCALER_AVAILABLE_STREAM_CONFIGURATIONS, ACAMERA_TYPE_INT32,
+                           {kFormatYuv, w, h, 0, kFormatPrivate, w, h, 0,
+                            kFormatYuv, w / 2, h / 2, 0, kFormatBlob, w, h, 0});
+    metadata->set<int32_t>(ACAMERA_CONTROL_AE_AVAILABLE_TARGET_FPS_RANGES, ACAMERA_TYPE_INT32,
+                           {kMinFps, camera.maxFps, camera.maxFps, camera.maxFps});
+
+    if (!camera.physicalIds.empty()) {
+        // Null-terminated ids back to back
+        std::vector<uint8_t> ids;
+        std::istringstream stream(camera.physicalIds);
+        std::string id;
+        while (std::getline(stream, id, ',')) {
+            ids.insert(ids.end(), id.begin(), id.end());
+            ids.push_back('\0');
+        }
+        metadata->set<uint8_t>(ACAMERA_LOGICAL_MULTI_CAMERA_PHYSICAL_IDS, ACAMERA_TYPE_BYTE, ids);
+    }
+
+    if (camera.calibrated) {
+        const auto fw = static_cast<float>(w);
+        const auto fh = static_cast<float>(h);
+        // (left, top, width, height), offset like most sensors' active arrays
+        metadata->set<int32_t>(ACAMERA_SENSOR_INFO_PRE_CORRECTION_ACTIVE_ARRAY_SIZE, ACAMERA_TYPE_INT32,
+                               {8, 4, w, h});
+        metadata->set<float>(ACAMERA_LENS_INTRINSIC_CALIBRATION, ACAMERA_TYPE_FLOAT,
+                             {0.8f * fw, 0.8f * fw, fw / 2.0f, fh / 2.0f, 0.0f});
+        metadata->set<float>(ACAMERA_LENS_DISTORTION, ACAMERA_TYPE_FLOAT, {0.01f, -0.005f, 0.001f, 0.0f, 0.0f});
+        metadata->set<float>(ACAMERA_LENS_POSE_ROTATION, ACAMERA_TYPE_FLOAT, {0.0f, 0.0f, 0.0f, 1.0f});
+        metadata->set<float>(ACAMERA_LENS_POSE_TRANSLATION, ACAMERA_TYPE_FLOAT, {camera.poseX, 0.0f, 0.0f});
+        metadata->set<uint8_t>(ACAMERA_LENS_POSE_REFERENCE, ACAMERA_TYPE_BYTE,
+                               {static_cast<uint8_t>(ACAMERA_LENS_POSE_REFERENCE_GYROSCOPE)});
+    }
+    return metadata;
+}
+
+/// Windows of the request's targets that are outputs of the session
+std::vector<ANativeWindow*> sessionWindows(const ACameraCaptureSession* session, const ACaptureRequest* request) {
+    std::vector<ANativeWindow*> windows;
+    for (const ACameraOutputTarget* target : request->targets) {
+        if (std::find(session->outputs.begin(), session->outputs.end(), target->window) !=
+            session->outputs.end()) {
+            windows.push_back(target->window);
+        }
+    }
+    return windows;
+}
+
+void runFrames(ACameraCaptureSession* session) {
+    const SyntheticCamera& spec = session->spec;
+    const int64_t periodNs = kNsPerSecond / std::max(spec.maxFps, 1);
+
+    if (session->callbacks.onActive) {
+        session->callbacks.onActive(session->callbacks.context, session);
+    }
+
+    int64_t frameNumber = 0;
+    int64_t nextNs = bootTimeNs() + periodNs;
+    std::unique_lock<std::mutex> lock(session->mutex);
+    while (!session->cv.wait_until(lock, steadyAtBootNs(nextNs), [session] { return session->stopRequested; })) {
+        const ACameraCaptureSession_captureCallbacks callbacks = session->repeating;
+        ACaptureRequest* request = session->repeatingRequest;
+        const std::vector<ANativeWindow*> windows = session->repeatingWindows;
+        std::deque<ACameraCaptureSession::Still> stills;
+        stills.swap(session->stills);
+        lock.unlock();
+
+        // Exposure started a fixed latency before delivery
+        const int64_t timestampNs = nextNs - spec.latencyNs;
+        if (callbacks.onCaptureStarted) {
+            callbacks.onCaptureStarted(callbacks.context, session, request, timestampNs);
+        }
+        for (ANativeWindow* window : windows) {
+            deliverImage(window, timestampNs, frameNumber);
+        }
+        for (const auto& still : stills) {
+            const ACameraCaptureSession_captureCallbacks& stillCallbacks = still.callbacks;
+            if (still.fault == ACameraCaptureSession::Fault::None) {
+                for (ANativeWindow* window : still.windows) {
+                    deliverImage(window, timestampNs, frameNumber);
+                }
+            } else if (still.fault == ACameraCaptureSession::Fault::BufferLost) {
+                for (ANativeWindow* window : still.windows) {
+                    if (stillCallbacks.onCaptureBufferLost) {
+                        stillCallbacks.onCaptureBufferLost(stillCallbacks.context, session, still.request, window,
+                                                           frameNumber);
+                    }
+                }
+            } else if (stillCallbacks.onCaptureFailed) {
+                ACameraCaptureFailure failure{frameNumber, CAPTURE_FAILURE_REASON_ERROR, still.sequenceId, false};
+                stillCallbacks.onCaptureFailed(stillCallbacks.context, session, still.request, &failure);
+            }
+            if (stillCallbacks.onCaptureSequenceCompleted) {
+                stillCallbacks.onCaptureSequenceCompleted(stillCallbacks.context, session, still.sequenceId,
+                                                          frameNumber);
+            }
+        }
+        if (callbacks.onCaptureCompleted) {
+            ACameraMetadata result;
+            result.set<int64_t>(ACAMERA_SENSOR_TIMESTAMP, ACAMERA_TYPE_INT64, {timestampNs});
+            result.set<int64_t>(ACAMERA_SENSOR_EXPOSURE_TIME, ACAMERA_TYPE_INT64, {spec.exposureNs});
+            result.set<int64_t>(ACAMERA_SENSOR_ROLLING_SHUTTER_SKEW, ACAMERA_TYPE_INT64,
+                                {spec.rollingShutterSkewNs});
+            result.set<int64_t>(ACAMERA_SENSOR_FRAME_DURATION, ACAMERA_TYPE_INT64, {periodNs});
+            callbacks.onCaptureCompleted(callbacks.context, session, request, &result);
+        }
+
+        ++frameNumber;
+        nextNs += periodNs;
+        // A stalled frame thread skips frames rather than bursting to catch up
+        const int64_t nowNs = bootTimeNs();
+        if (nextNs < nowNs) {
+            nextNs += (nowNs - nextNs) / periodNs * periodNs + periodNs;
+        }
+        lock.lock();
+    }
+}
+
+/// Stop the session's frame thread; true if one was running. Safe from
+/// several threads at once.
+bool stopFrames(ACameraCaptureSession* session) {
+    std::lock_guard<std::mutex> stopLock(session->stopMutex);
+    if (!session->driver.joinable()) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        session->stopRequested = true;
+        session->cv.notify_all();
+    }
+    session->driver.join();
+    std::lock_guard<std::mutex> lock(session->mutex);
+    session->stopRequested = false;
+    session->stills.clear();
+    return true;
+}
+
+/// Fail every open device of the camera and stop its capture; `notify` runs
+/// the device callback. Caller holds g_camerasMutex.
+template<typename Notify>
+void failDevices(const std::string& id, camera_status_t failure, Notify notify) {
+    for (ACameraDevice* device : g_devices) {
+        if (device->spec.id != id || device->failure != ACAMERA_OK) {
+            continue;
+        }
+        device->failure = failure;
+        if (ACameraCaptureSession* session = device->session) {
+            session->failure = failure;
+            stopFrames(session);
+        }
+        notify(device);
+    }
+}
+
+}  // namespace
+
+void resetCameraBackend() {
+    std::lock_guard<std::mutex> lock(g_camerasMutex);
+    g_cameras = defaultCameras();
+    g_openErrors.clear();
+    g_stillFaults.clear();
+}
+
+}  // namespace nativesensor::testing::detail
+
+namespace nativesensor::testing {
+
+std::vector<SyntheticCamera> defaultCameras() {
+    SyntheticCamera passthrough;
+    passthrough.id = "0";
+    passthrough.facing = ACAMERA_LENS_FACING_BACK;
+    passthrough.width = 2048;
+    passthrough.height = 1536;
+    passthrough.maxFps = 30;
+
+    SyntheticCamera left;
+    left.id = "1";
+    left.facing = ACAMERA_LENS_FACING_FRONT;
+    left.width = 640;
+    left.height = 480;
+    left.maxFps = 60;
+    left.poseX = -0.032f;
+
+    SyntheticCamera right = left;
+    right.id = "2";
+    right.poseX = 0.032f;
+
+    SyntheticCamera eye;
+    eye.id = "eye0";
+    eye.facing = ACAMERA_LENS_FACING_FRONT;
+    eye.width = 400;
+    eye.height = 400;
+    eye.maxFps = 60;
+    eye.calibrated = false;
+
+    return {passthrough, left, right, eye};
+}
+
+void setCameras(std::vector<SyntheticCamera> cameras) {
+    std::lock_guard<std::mutex> lock(detail::g_camerasMutex);
+    detail::g_cameras = std::move(cameras);
+}
+
+void disconnectCamera(const std::string& id) {
+    std::lock_guard<std::mutex> lock(detail::g_camerasMutex);
+    detail::failDevices(id, ACAMERA_ERROR_CAMERA_DISCONNECTED, [](ACameraDevice* device) {
+        if (device->callbacks.onDisconnected) {
+            device->callbacks.onDisconnected(device->callbacks.context, device);
+        }
+    });
+}
+
+void failCamera(const std::string& id, int error) {
+    std::lock_guard<std::mutex> lock(detail::g_camerasMutex);
+    detail::failDevices(id, ACAMERA_ERROR_CAMERA_DEVICE, [error](ACameraDevice* device) {
+        if (device->callbacks.onError) {
+            device->callbacks.onError(device->callbacks.context, device, error);
+        }
+    });
+}
+
+void setCameraOpenError(const std::string& id, int status) {
+    std::lock_guard<std::mutex> lock(detail::g_camerasMutex);
+    if (status == ACAMERA_OK) {
+        detail::g_openErrors.erase(id);
+    } else {
+        detail::g_openErrors[id] = static_cast<camera_status_t>(status);
+    }
+}
+
+void failStills(const std::string& id, int count, bool bufferLost) {
+    std::lock_guard<std::mutex> lock(detail::g_camerasMutex);
+    detail::g_stillFaults[id] = {count, bufferLost};
+}
+
+}  // namespace nativesensor::testing
+
+using namespace nativesensor::testing::detail;
+
+extern "C" {
+
+ACameraManager* ACameraManager_create() {
+    track(Handle::CameraManager, 1);
+    return new ACameraManager;
+}
+
+void ACameraManager_delete(ACameraManager* manager) {
+    if (manager) {
+        delete manager;
+        track(Handle::CameraManager, -1);
+    }
+}
+
+camera_status_t ACameraManager_getCameraIdList(ACameraManager* manager, ACameraIdList** cameraIdList) {
+    if (!manager || !cameraIdList) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    std::lock_guard<std::mutex> lock(g_camerasMutex);
+    auto* list = new ACameraIdList;
+    list->numCameras = static_cast<int>(g_cameras.size());
+    auto** ids = new const char*[g_cameras.size()];
+    for (size_t i = 0; i < g_cameras.size(); ++i) {
+        char* id = new char[g_cameras[i].id.size() + 1];
+        std::memcpy(id, g_cameras[i].id.c_str(), g_cameras[i].id.size() + 1);
+        ids[i] = id;
+    }
+    list->cameraIds = ids;
+    track(Handle::IdList, 1);
+    *cameraIdList = list;
+    return ACAMERA_OK;
+}
+
+void ACameraManager_deleteCameraIdList(ACameraIdList* cameraIdList) {
+    if (!cameraIdList) {
+        return;
+    }
+    for (int i = 0; i < cameraIdList->numCameras; ++i) {
+        delete[] cameraIdList->cameraIds[i];
+    }
+    delete[] cameraIdList->cameraIds;
+    delete cameraIdList;
+    track(Handle::IdList, -1);
+}
+
+camera_status_t ACameraManager_getCameraCharacteristics(ACameraManager* manager, const char* cameraId,
+                                                        ACameraMetadata** characteristics) {
+    if (!manager || !cameraId || !characteristics) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    std::lock_guard<std::mutex> lock(g_camerasMutex);
+    const SyntheticCamera* camera = findCamera(cameraId);
+    if (!camera) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    *characteristics = characteristicsOf(*camera);
+    track(Handle::CameraMetadata, 1);
+    return ACAMERA_OK;
+}
+
+camera_status_t ACameraManager_openCamera(ACameraManager* manager, const char* cameraId,
+                                          ACameraDevice_StateCallbacks* callback, ACameraDevice** device) {
+    if (!manager || !cameraId || !callback || !device) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    std::lock_guard<std::mutex> lock(g_camerasMutex);
+    if (const auto it = g_openErrors.find(cameraId); it != g_openErrors.end()) {
+        return it->second;
+    }
+    const SyntheticCamera* camera = findCamera(cameraId);
+    if (!camera) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    auto* opened = new ACameraDevice;
+    opened->spec = *camera;
+    opened->callbacks = *callback;
+    g_devices.push_back(opened);
+    track(Handle::CameraDevice, 1);
+    *device = opened;
+    return ACAMERA_OK;
+}
+
+camera_status_t ACameraMetadata_getConstEntry(const ACameraMetadata* metadata, uint32_t tag,
+                                              ACameraMetadata_const_entry* entry) {
+    if (!metadata || !entry) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    return metadata->get(tag, entry);
+}
+
+void ACameraMetadata_free(ACameraMetadata* metadata) {
+    if (metadata) {
+        delete metadata;
+        track(Handle::CameraMetadata, -1);
+    }
+}
+
+camera_status_t ACameraDevice_close(ACameraDevice* device) {
+    if (!device) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    std::lock_guard<std::mutex> lock(g_camerasMutex);
+    if (ACameraCaptureSession* session = device->session) {
+        // The app still owns the session; it just stops capturing
+        session->device = nullptr;
+        session->failure = ACAMERA_ERROR_SESSION_CLOSED;
+        stopFrames(session);
+    }
+    g_devices.erase(std::remove(g_devices.begin(), g_devices.end(), device), g_devices.end());
+    delete device;
+    track(Handle::CameraDevice, -1);
+    return ACAMERA_OK;
+}
+
+const char* ACameraDevice_getId(const ACameraDevice* device) {
+    return device ? device->spec.id.c_str() : nullptr;
+}
+
+camera_status_t ACameraDevice_createCaptureRequest(const ACameraDevice* device,
+                                                   ACameraDevice_request_template templateId,
+                                                   ACaptureRequest** request) {
+    if (!device || !request) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_camerasMutex);
+        if (device->failure != ACAMERA_OK) {
+            return device->failure;
+        }
+    }
+    auto* created = new ACaptureRequest;
+    created->templateId = templateId;
+    track(Handle::CaptureRequest, 1);
+    *request = created;
+    return ACAMERA_OK;
+}
+
+camera_status_t ACameraOutputTarget_create(ANativeWindow* window, ACameraOutputTarget** output) {
+    if (!window || !output) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    ANativeWindow_acquire(window);
+    *output = new ACameraOutputTarget{window};
+    track(Handle::OutputTarget, 1);
+    return ACAMERA_OK;
+}
+
+void ACameraOutputTarget_free(ACameraOutputTarget* output) {
+    if (output) {
+        ANativeWindow_release(output->window);
+        delete output;
+        track(Handle::OutputTarget, -1);
+    }
+}
+
+camera_status_t ACaptureRequest_addTarget(ACaptureRequest* request, const ACameraOutputTarget* output) {
+    if (!request || !output) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    if (std::find(request->targets.begin(), request->targets.end(), output) == request->targets.end()) {
+        request->targets.push_back(output);
+    }
+    return ACAMERA_OK;
+}
+
+camera_status_t ACaptureRequest_removeTarget(ACaptureRequest* request, const ACameraOutputTarget* output) {
+    if (!request || !output) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    auto& targets = request->targets;
+    targets.erase(std::remove(targets.begin(), targets.end(), output), targets.end());
+    return ACAMERA_OK;
+}
+
+camera_status_t ACaptureRequest_getConstEntry(const ACaptureRequest* request, uint32_t tag,
+                                              ACameraMetadata_const_entry* entry) {
+    if (!request || !entry) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    return request->settings.get(tag, entry);
+}
+
+camera_status_t ACaptureRequest_setEntry_u8(ACaptureRequest* request, uint32_t tag, uint32_t count,
+                                            const uint8_t* data) {
+    if (!request || (count > 0 && !data)) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    request->settings.set<uint8_t>(tag, ACAMERA_TYPE_BYTE, std::vector<uint8_t>(data, data + count));
+    return ACAMERA_OK;
+}
+
+camera_status_t ACaptureRequest_setEntry_i32(ACaptureRequest* request, uint32_t tag, uint32_t count,
+                                             const int32_t* data) {
+    if (!request || (count > 0 && !data)) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    request->settings.set<int32_t>(tag, ACAMERA_TYPE_INT32, std::vector<int32_t>(data, data + count));
+    return ACAMERA_OK;
+}
+
+camera_status_t ACaptureRequest_setEntry_i64(ACaptureRequest* request, uint32_t tag, uint32_t count,
+                                             const int64_t* data) {
+    if (!request || (count > 0 && !data)) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    request->settings.set<int64_t>(tag, ACAMERA_TYPE_INT64, std::vector<int64_t>(data, data + count));
+    return ACAMERA_OK;
+}
+
+void ACaptureRequest_free(ACaptureRequest* request) {
+    if (request) {
+        delete request;
+        track(Handle::CaptureRequest, -1);
+    }
+}
+
+camera_status_t ACaptureSessionOutputContainer_create(ACaptureSessionOutputContainer** container) {
+    if (!container) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    *container = new ACaptureSessionOutputContainer;
+    track(Handle::OutputContainer, 1);
+    return ACAMERA_OK;
+}
+
+void ACaptureSessionOutputContainer_free(ACaptureSessionOutputContainer* container) {
+    if (container) {
+        delete container;
+        track(Handle::OutputContainer, -1);
+    }
+}
+
+camera_status_t ACaptureSessionOutput_create(ANativeWindow* anw, ACaptureSessionOutput** output) {
+    if (!anw || !output) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    ANativeWindow_acquire(anw);
+    *output = new ACaptureSessionOutput{anw};
+    track(Handle::SessionOutput, 1);
+    return ACAMERA_OK;
+}
+
+void ACaptureSessionOutput_free(ACaptureSessionOutput* output) {
+    if (output) {
+        ANativeWindow_release(output->window);
+        delete output;
+        track(Handle::SessionOutput, -1);
+    }
+}
+
+camera_status_t ACaptureSessionOutputContainer_add(ACaptureSessionOutputContainer* container,
+                                                   const ACaptureSessionOutput* output) {
+    if (!container || !output) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    container->outputs.push_back(output);
+    return ACAMERA_OK;
+}
+
+camera_status_t ACaptureSessionOutputContainer_remove(ACaptureSessionOutputContainer* container,
+                                                      const ACaptureSessionOutput* output) {
+    if (!container || !output) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    auto& outputs = container->outputs;
+    outputs.erase(std::remove(outputs.begin(), outputs.end(), output), outputs.end());
+    return ACAMERA_OK;
+}
+
+camera_status_t ACameraDevice_createCaptureSession(ACameraDevice* device,
+                                                   const ACaptureSessionOutputContainer* outputs,
+                                                   const ACameraCaptureSession_stateCallbacks* callbacks,
+                                                   ACameraCaptureSession** session) {
+    if (!device || !outputs || !callbacks || !session) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    std::lock_guard<std::mutex> lock(g_camerasMutex);
+    if (device->failure != ACAMERA_OK) {
+        return device->failure;
+    }
+    // A new session closes the device's previous one; the app still frees it
+    if (ACameraCaptureSession* previous = device->session) {
+        previous->device = nullptr;
+        previous->failure = ACAMERA_ERROR_SESSION_CLOSED;
+        stopFrames(previous);
+    }
+
+    auto* created = new ACameraCaptureSession;
+    created->device = device;
+    created->spec = device->spec;
+    created->callbacks = *callbacks;
+    for (const ACaptureSessionOutput* output : outputs->outputs) {
+        ANativeWindow_acquire(output->window);
+        created->outputs.push_back(output->window);
+    }
+    device->session = created;
+    track(Handle::CaptureSession, 1);
+    *session = created;
+    return ACAMERA_OK;
+}
+
+void ACameraCaptureSession_close(ACameraCaptureSession* session) {
+    if (!session) {
+        return;
+    }
+    stopFrames(session);
+    {
+        std::lock_guard<std::mutex> lock(g_camerasMutex);
+        if (session->device && session->device->session == session) {
+            session->device->session = nullptr;
+        }
+    }
+    if (session->callbacks.onClosed) {
+        session->callbacks.onClosed(session->callbacks.context, session);
+    }
+    for (ANativeWindow* window : session->outputs) {
+        ANativeWindow_release(window);
+    }
+    delete session;
+    track(Handle::CaptureSession, -1);
+}
+
+camera_status_t ACameraCaptureSession_capture(ACameraCaptureSession* session,
+                                              ACameraCaptureSession_captureCallbacks* callbacks,
+                                              int numRequests, ACaptureRequest** requests,
+                                              int* captureSequenceId) {
+    if (!session || numRequests < 1 || !requests) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    std::vector<ACameraCaptureSession::Fault> faults(static_cast<size_t>(numRequests),
+                                                     ACameraCaptureSession::Fault::None);
+    {
+        std::lock_guard<std::mutex> lock(g_camerasMutex);
+        if (session->failure != ACAMERA_OK) {
+            return session->failure;
+        }
+        if (const auto it = g_stillFaults.find(session->spec.id); it != g_stillFaults.end()) {
+            for (auto& fault : faults) {
+                if (it->second.count > 0) {
+                    --it->second.count;
+                    fault = it->second.bufferLost ? ACameraCaptureSession::Fault::BufferLost
+                                                  : ACameraCaptureSession::Fault::Failed;
+                }
+            }
+        }
+    }
+    // Stills ride along with the next repeating frame
+    std::lock_guard<std::mutex> stopLock(session->stopMutex);
+    if (!session->driver.joinable()) {
+        return ACAMERA_ERROR_INVALID_OPERATION;
+    }
+    std::lock_guard<std::mutex> lock(session->mutex);
+    const int sequenceId = session->nextSequenceId++;
+    for (int i = 0; i < numRequests; ++i) {
+        session->stills.push_back({requests[i], sessionWindows(session, requests[i]),
+                                   callbacks ? *callbacks : ACameraCaptureSession_captureCallbacks{},
+                                   sequenceId, faults[static_cast<size_t>(i)]});
+    }
+    if (captureSequenceId) {
+        *captureSequenceId = sequenceId;
+    }
+    return ACAMERA_OK;
+}
+
+camera_status_t ACameraCaptureSession_setRepeatingRequest(ACameraCaptureSession* session,
+                                                          ACameraCaptureSession_captureCallbacks* callbacks,
+                                                          int numRequests, ACaptureRequest** requests,
+                                                          int* captureSequenceId) {
+    if (!session || numRequests < 1 || !requests) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_camerasMutex);
+        if (session->failure != ACAMERA_OK) {
+            return session->failure;
+        }
+    }
+    stopFrames(session);
+
+    std::lock_guard<std::mutex> stopLock(session->stopMutex);
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        session->repeating = callbacks ? *callbacks : ACameraCaptureSession_captureCallbacks{};
+        session->repeatingRequest = requests[0];
+        session->repeatingWindows = sessionWindows(session, requests[0]);
+    }
+    session->driver = std::thread(runFrames, session);
+    if (captureSequenceId) {
+        *captureSequenceId = 0;
+    }
+    return ACAMERA_OK;
+}
+
+camera_status_t ACameraCaptureSession_stopRepeating(ACameraCaptureSession* session) {
+    if (!session) {
+        return ACAMERA_ERROR_INVALID_PARAMETER;
+    }
+    if (stopFrames(session) && session->callbacks.onReady) {
+        session->callbacks.onReady(session->callbacks.context, session);
+    }
+    return ACAMERA_OK;
+}
+
+camera_status_t ACameraCaptureSession_abortCaptures(ACameraCaptureSession* session) {
+    return ACameraCaptureSession_stopRepeating(session);
+}
+
+}
@@ -0,0 +1,206 @@
+// Synthetic JNI: strings, arrays and surfaces are plain C++ objects owned by
+// the FakeJniEnv that created them; the fake VM attaches one env per thread
+
+#include <jni.h>
+#include <android/native_window_jni.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "backend_internal.h"
+
+namespace {
+
+class FakeString : public _jstring {
+public:
+    explicit FakeString(std::string value) : value(std::move(value)) {}
+    std::string value;
+};
+
+class FakeFloatArray : public _jfloatArray {
+public:
+    explicit FakeFloatArray(size_t length) : values(length, 0.0f) {}
+    std::vector<float> values;
+};
+
+class FakeIntArray : public _jintArray {
+public:
+    explicit FakeIntArray(size_t length) : values(length, 0) {}
+    std::vector<int32_t> values;
+};
+
+class FakeSurface : public _jobject {
+public:
+    explicit FakeSurface(ANativeWindow* window) : window(window) { ANativeWindow_acquire(window); }
+    ~FakeSurface() override { ANativeWindow_release(window); }
+
+    FakeSurface(const FakeSurface&) = delete;
+    FakeSurface& operator=(const FakeSurface&) = delete;
+
+    ANativeWindow* const window;
+};
+
+/// Array length/region helpers shared by the float and int arrays
+jsize lengthOf(jarray array) {
+    if (auto* floats = dynamic_cast<FakeFloatArray*>(array)) {
+        return static_cast<jsize>(floats->values.size());
+    }
+    if (auto* ints = dynamic_cast<FakeIntArray*>(array)) {
+        return static_cast<jsize>(ints->values.size());
+    }
+    return 0;
+}
+
+bool inRange(size_t size, jsize start, jsize length) {
+    return start >= 0 && length >= 0 && static_cast<size_t>(start) + static_cast<size_t>(length) <= size;
+}
+
+class FakeJavaVM : public JavaVM {
+public:
+    jint GetEnv(void** env, jint /* version */) override {
+        if (!t_env) {
+            *env = nullptr;
+            return JNI_EDETACHED;
+        }
+        *env = t_env.get();
+        return JNI_OK;
+    }
+
+    jint AttachCurrentThread(JNIEnv** env, void* /* args */) override {
+        if (!t_env) {
+            t_env = std::make_unique<nativesensor::testing::FakeJniEnv>();
+        }
+        *env = t_env.get();
+        return JNI_OK;
+    }
+
+    jint DetachCurrentThread() override {
+        t_env.reset();
+        return JNI_OK;
+    }
+
+private:
+    static thread_local std::unique_ptr<nativesensor::testing::FakeJniEnv> t_env;
+};
+
+thread_local std::unique_ptr<nativesensor::testing::FakeJniEnv> FakeJavaVM::t_env;
+
+}  // namespace
+
+namespace nativesensor::testing {
+
+FakeJniEnv::FakeJniEnv() = default;
+FakeJniEnv::~FakeJniEnv() = default;
+
+template<typename T>
+T* FakeJniEnv::adopt(std::unique_ptr<T> object) {
+    T* raw = object.get();
+    objects_.push_back(std::move(object));
+    return raw;
+}
+
+jstring FakeJniEnv::string(const std::string& value) {
+    return adopt(std::make_unique<FakeString>(value));
+}
+
+jfloatArray FakeJniEnv::floatArray(const std::vector<float>& values) {
+    auto* array = adopt(std::make_unique<FakeFloatArray>(values.size()));
+    array->values = values;
+    return array;
+}
+
+jobject FakeJniEnv::surface(ANativeWindow* window) {
+    return adopt(std::make_unique<FakeSurface>(window));
+}
+
+std::string FakeJniEnv::text(jstring value) {
+    auto* string = dynamic_cast<FakeString*>(value);
+    return string ? string->value : std::string();
+}
+
+std::vector<float> FakeJniEnv::floats(jfloatArray values) {
+    auto* array = dynamic_cast<FakeFloatArray*>(values);
+    return array ? array->values : std::vector<float>();
+}
+
+std::vector<int32_t> FakeJniEnv::ints(jintArray values) {
+    auto* array = dynamic_cast<FakeIntArray*>(values);
+    return array ? array->values : std::vector<int32_t>();
+}
+
+jstring FakeJniEnv::NewStringUTF(const char* bytes) {
+    return bytes ? string(bytes) : nullptr;
+}
+
+const char* FakeJniEnv::GetStringUTFChars(jstring string, jboolean* isCopy) {
+    if (isCopy) {
+        *isCopy = JNI_FALSE;
+    }
+    auto* value = dynamic_cast<FakeString*>(string);
+    return value ? value->value.c_str() : nullptr;
+}
+
+void FakeJniEnv::ReleaseStringUTFChars(jstring /* string */, const char* /* utf */) {}
+
+jsize FakeJniEnv::GetArrayLength(jarray array) {
+    return lengthOf(array);
+}
+
+jintArray FakeJniEnv::NewIntArray(jsize length) {
+    return length < 0 ? nullptr : adopt(std::make_unique<FakeIntArray>(static_cast<size_t>(length)));
+}
+
+jfloatArray FakeJniEnv::NewFloatArray(jsize length) {
+    return length < 0 ? nullptr : adopt(std::make_unique<FakeFloatArray>(static_cast<size_t>(length)));
+}
+
+void FakeJniEnv::GetFloatArrayRegion(jfloatArray array, jsize start, jsize length, jfloat* buf) {
+    auto* values = dynamic_cast<FakeFloatArray*>(array);
+    if (values && inRange(values->values.size(), start, length)) {
+        std::copy_n(values->values.begin() + start, length, buf);
+    }
+}
+
+void FakeJniEnv::SetFloatArrayRegion(jfloatArray array, jsize start, jsize length, const jfloat* buf) {
+    auto* values = dynamic_cast<FakeFloatArray*>(array);
+    if (values && inRange(values->values.size(), start, length)) {
+        std::copy_n(buf, length, values->values.begin() + start);
+    }
+}
+
+void FakeJniEnv::SetIntArrayRegion(jintArray array, jsize start, jsize length, const jint* buf) {
+    auto* values = dynamic_cast<FakeIntArray*>(array);
+    if (values && inRange(values->values.size(), start, length)) {
+        std::copy_n(buf, length, values->values.begin() + start);
+    }
+}
+
+jobject FakeJniEnv::NewGlobalRef(jobject obj) {
+    // Objects live as long as the env that made them
+    return obj;
+}
+
+void FakeJniEnv::DeleteGlobalRef(jobject /* globalRef */) {}
+
+void FakeJniEnv::DeleteLocalRef(jobject localRef) {
+    objects_.erase(std::remove_if(objects_.begin(), objects_.end(),
+                                  [localRef](const auto& object) { return object.get() == localRef; }),
+                   objects_.end());
+}
+
+JavaVM* javaVm() {
+    static FakeJavaVM vm;
+    return &vm;
+}
+
+}  // namespace nativesensor::testing
+
+extern "C" ANativeWindow* ANativeWindow_fromSurface(JNIEnv* /* env */, jobject surface) {
+    auto* fake = dynamic_cast<FakeSurface*>(surface);
+    if (!fake) {
+        return nullptr;
+    }
+    ANativeWindow_acquire(fake->window);
+    return fake->window;
+}
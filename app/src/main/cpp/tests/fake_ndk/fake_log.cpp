@@ -0,0 +1,82 @@
+// Synthetic <android/log.h>: messages at or above NATIVESENSOR_LOG_LEVEL
+// (verbose/debug/info/warn/error, default warn) go to stderr
+
+#include <android/log.h>
+
+#include <array>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "backend_internal.h"
+
+namespace {
+
+std::array<std::atomic<int64_t>, ANDROID_LOG_SILENT + 1> g_logged{};
+
+int thresholdFromEnvironment() {
+    const char* level = std::getenv("NATIVESENSOR_LOG_LEVEL");
+    if (!level) {
+        return ANDROID_LOG_WARN;
+    }
+    constexpr std::array<std::pair<const char*, int>, 5> kLevels{{
+        {"verbose", ANDROID_LOG_VERBOSE},
+        {"debug", ANDROID_LOG_DEBUG},
+        {"info", ANDROID_LOG_INFO},
+        {"warn", ANDROID_LOG_WARN},
+        {"error", ANDROID_LOG_ERROR},
+    }};
+    for (const auto& [name, priority] : kLevels) {
+        if (std::strcmp(level, name) == 0) {
+            return priority;
+        }
+    }
+    return ANDROID_LOG_WARN;
+}
+
+char priorityLetter(int prio) {
+    constexpr char kLetters[] = "??VDIWEFS";
+    return prio >= 0 && prio <= ANDROID_LOG_SILENT ? kLetters[prio] : '?';
+}
+
+}  // namespace
+
+extern "C" int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+    static const int threshold = thresholdFromEnvironment();
+    if (prio >= 0 && prio <= ANDROID_LOG_SILENT) {
+        g_logged[static_cast<size_t>(prio)].fetch_add(1, std::memory_order_relaxed);
+    }
+    if (prio < threshold) {
+        return 0;
+    }
+
+    char message[1024];
+    va_list args;
+    va_start(args, fmt);
+    std::vsnprintf(message, sizeof(message), fmt, args);
+    va_end(args);
+    return std::fprintf(stderr, "%c/%s: %s\n", priorityLetter(prio), tag, message);
+}
+
+namespace nativesensor::testing {
+
+int64_t loggedCount(int priority) {
+    if (priority < 0 || priority > ANDROID_LOG_SILENT) {
+        return 0;
+    }
+    return g_logged[static_cast<size_t>(priority)].load(std::memory_order_relaxed);
+}
+
+namespace detail {
+
+void resetLogCounters() {
+    for (auto& count : g_logged) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace detail
+
+}  // namespace nativesensor::testing
@@ -0,0 +1,245 @@
+// Synthetic <android/looper.h> and <android/choreographer.h>: loopers are
+// condition variables woken by sensor queues, vsync callbacks and
+// ALooper_wake(). Loopers are pooled rather than freed, so waking the looper
+// of a thread that already exited is harmless, as it is on Android.
+
+#include <android/choreographer.h>
+#include <android/looper.h>
+
+#include <algorithm>
+#include <climits>
+#include <memory>
+
+#include "backend_internal.h"
+
+struct AChoreographer {
+    ALooper* looper = nullptr;
+    int64_t lastVsyncNs = 0;            // CLOCK_MONOTONIC
+};
+
+struct AChoreographerFrameCallbackData {
+    static constexpr size_t kTimelines = 3;
+
+    struct Timeline {
+        AVsyncId vsyncId = 0;
+        int64_t expectedPresentNs = 0;
+        int64_t deadlineNs = 0;
+    };
+
+    int64_t frameTimeNs = 0;
+    Timeline timelines[kTimelines];
+    size_t preferredIndex = 0;
+};
+
+namespace nativesensor::testing::detail {
+
+namespace {
+
+constexpr double kDefaultRefreshHz = 90.0;
+constexpr int64_t kDeadlineMarginNs = 1'000'000;
+
+std::atomic<double> g_refreshHz{kDefaultRefreshHz};
+std::atomic<AVsyncId> g_nextVsyncId{1};
+
+std::mutex g_poolMutex;
+std::vector<std::unique_ptr<ALooper>> g_loopers;   // Never shrinks
+std::vector<ALooper*> g_idleLoopers;
+
+/// The calling thread's looper and Choreographer, handed back at thread exit
+struct ThreadLooper {
+    ALooper* looper = nullptr;
+    std::unique_ptr<AChoreographer> choreographer;
+
+    ~ThreadLooper() {
+        if (!looper) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(looper->mutex);
+            looper->callbacks.clear();
+            looper->wakeRequested = false;
+        }
+        std::lock_guard<std::mutex> lock(g_poolMutex);
+        g_idleLoopers.push_back(looper);
+    }
+};
+
+thread_local ThreadLooper t_looper;
+
+ALooper* acquireLooper() {
+    std::lock_guard<std::mutex> lock(g_poolMutex);
+    if (!g_idleLoopers.empty()) {
+        ALooper* looper = g_idleLoopers.back();
+        g_idleLoopers.pop_back();
+        return looper;
+    }
+    g_loopers.push_back(std::make_unique<ALooper>());
+    return g_loopers.back().get();
+}
+
+}  // namespace
+
+void resetDisplayBackend() {
+    g_refreshHz.store(kDefaultRefreshHz, std::memory_order_relaxed);
+}
+
+}  // namespace nativesensor::testing::detail
+
+namespace nativesensor::testing {
+
+void setDisplayRefreshRate(double hz) {
+    detail::g_refreshHz.store(hz > 0.0 ? hz : detail::kDefaultRefreshHz, std::memory_order_relaxed);
+}
+
+}  // namespace nativesensor::testing
+
+using namespace nativesensor::testing::detail;
+
+extern "C" {
+
+ALooper* ALooper_forThread() {
+    return t_looper.looper;
+}
+
+ALooper* ALooper_prepare(int /* opts */) {
+    if (!t_looper.looper) {
+        t_looper.looper = acquireLooper();
+    }
+    return t_looper.looper;
+}
+
+int ALooper_pollOnce(int timeoutMillis, int* outFd, int* outEvents, void** outData) {
+    ALooper* looper = t_looper.looper;
+    if (!looper) {
+        return ALOOPER_POLL_ERROR;
+    }
+    if (outFd) {
+        *outFd = -1;
+    }
+    if (outEvents) {
+        *outEvents = 0;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = timeoutMillis < 0 ? std::chrono::steady_clock::time_point::max()
+                                            : start + std::chrono::milliseconds(timeoutMillis);
+    std::unique_lock<std::mutex> lock(looper->mutex);
+    while (true) {
+        if (looper->wakeRequested) {
+            looper->wakeRequested = false;
+            return ALOOPER_POLL_WAKE;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        auto wakeAt = deadline;
+        for (auto it = looper->callbacks.begin(); it != looper->callbacks.end(); ++it) {
+            if (it->due <= now) {
+                auto run = std::move(it->run);
+                looper->callbacks.erase(it);
+                lock.unlock();
+                run();
+                return ALOOPER_POLL_CALLBACK;
+            }
+            wakeAt = std::min(wakeAt, it->due);
+        }
+
+        const int64_t nowBootNs = bootTimeNs();
+        int64_t nextEventNs = INT64_MAX;
+        for (ASensorEventQueue* queue : looper->queues) {
+            generateSensorEvents(queue, nowBootNs);
+            if (!queue->pending.empty()) {
+                if (outData) {
+                    *outData = queue->data;
+                }
+                return queue->ident;
+            }
+            nextEventNs = std::min(nextEventNs, nextSensorEventNs(queue));
+        }
+        if (nextEventNs != INT64_MAX) {
+            wakeAt = std::min(wakeAt, now + std::chrono::nanoseconds(nextEventNs - nowBootNs));
+        }
+
+        if (now >= deadline) {
+            return ALOOPER_POLL_TIMEOUT;
+        }
+        looper->cv.wait_until(lock, wakeAt);
+    }
+}
+
+void ALooper_wake(ALooper* looper) {
+    if (!looper) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(looper->mutex);
+    looper->wakeRequested = true;
+    looper->cv.notify_all();
+}
+
+AChoreographer* AChoreographer_getInstance() {
+    if (!t_looper.looper) {
+        return nullptr;
+    }
+    if (!t_looper.choreographer) {
+        t_looper.choreographer = std::make_unique<AChoreographer>();
+        t_looper.choreographer->looper = t_looper.looper;
+    }
+    return t_looper.choreographer.get();
+}
+
+int AChoreographer_postVsyncCallback(AChoreographer* choreographer, AChoreographer_vsyncCallback callback,
+                                     void* data) {
+    if (!choreographer || !callback) {
+        return -1;
+    }
+
+    // Next vsync on the display's grid, strictly after the last one delivered
+    const auto periodNs = static_cast<int64_t>(1e9 / g_refreshHz.load(std::memory_order_relaxed));
+    const int64_t after = std::max(monotonicTimeNs(), choreographer->lastVsyncNs);
+    const int64_t vsyncNs = (after / periodNs + 1) * periodNs;
+    choreographer->lastVsyncNs = vsyncNs;
+
+    AChoreographerFrameCallbackData frame;
+    frame.frameTimeNs = vsyncNs;
+    for (size_t i = 0; i < AChoreographerFrameCallbackData::kTimelines; ++i) {
+        const auto offset = static_cast<int64_t>(i);
+        frame.timelines[i].vsyncId = g_nextVsyncId.fetch_add(1, std::memory_order_relaxed);
+        frame.timelines[i].expectedPresentNs = vsyncNs + (offset + 2) * periodNs;
+        frame.timelines[i].deadlineNs = vsyncNs + (offset + 1) * periodNs - kDeadlineMarginNs;
+    }
+
+    ALooper* looper = choreographer->looper;
+    std::lock_guard<std::mutex> lock(looper->mutex);
+    looper->callbacks.push_back({std::chrono::steady_clock::time_point(std::chrono::nanoseconds(vsyncNs)),
+                                 [callback, data, frame] { callback(&frame, data); }});
+    looper->cv.notify_all();
+    return 0;
+}
+
+int64_t AChoreographerFrameCallbackData_getFrameTimeNanos(const AChoreographerFrameCallbackData* data) {
+    return data->frameTimeNs;
+}
+
+size_t AChoreographerFrameCallbackData_getFrameTimelinesLength(const AChoreographerFrameCallbackData* /* data */) {
+    return AChoreographerFrameCallbackData::kTimelines;
+}
+
+size_t AChoreographerFrameCallbackData_getPreferredFrameTimelineIndex(const AChoreographerFrameCallbackData* data) {
+    return data->preferredIndex;
+}
+
+AVsyncId AChoreographerFrameCallbackData_getFrameTimelineVsyncId(const AChoreographerFrameCallbackData* data,
+                                                                 size_t index) {
+    return index < AChoreographerFrameCallbackData::kTimelines ? data->timelines[index].vsyncId : 0;
+}
+
+int64_t AChoreographerFrameCallbackData_getFrameTimelineExpectedPresentationTimeNanos(
+    const AChoreographerFrameCallbackData* data, size_t index) {
+    return index < AChoreographerFrameCallbackData::kTimelines ? data->timelines[index].expectedPresentNs : 0;
+}
+
+int64_t AChoreographerFrameCallbackData_getFrameTimelineDeadlineNanos(const AChoreographerFrameCallbackData* data,
+                                                                      size_t index) {
+    return index < AChoreographerFrameCallbackData::kTimelines ? data->timelines[index].deadlineNs : 0;
+}
+
+}
@@ -0,0 +1,294 @@
+// Synthetic <media/NdkImageReader.h>: readers queue frames that capture
+// sessions deliver to their window and fill them in when acquired. YUV frames
+// are a gradient that moves one pixel per frame, JPEGs a minimal SOI..EOI blob.
+
+#include <media/NdkImage.h>
+#include <media/NdkImageReader.h>
+
+#include <memory>
+
+#include "backend_internal.h"
+
+namespace {
+
+/// Outlives the reader while images are out
+struct ReaderShared {
+    std::mutex mutex;
+    int acquired = 0;
+};
+
+struct QueuedFrame {
+    int64_t timestampNs = 0;
+    int64_t frameNumber = 0;
+};
+
+// Guards ANativeWindow::reader, so a delivery never races a reader's deletion
+std::mutex g_mediaMutex;
+
+}  // namespace
+
+struct AImageReader {
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t format = 0;
+    int32_t maxImages = 0;
+    ANativeWindow* window = nullptr;
+    std::shared_ptr<ReaderShared> shared = std::make_shared<ReaderShared>();
+
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::deque<QueuedFrame> queued;
+    AImageReader_ImageListener listener{};
+    int callbacksRunning = 0;
+};
+
+struct AImage {
+    std::shared_ptr<ReaderShared> reader;
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t format = 0;
+    int64_t timestampNs = 0;
+    struct Plane {
+        std::vector<uint8_t> data;
+        int32_t rowStride = 0;
+        int32_t pixelStride = 1;
+    };
+    std::vector<Plane> planes;
+};
+
+namespace {
+
+void fillImage(AImage& image, const QueuedFrame& frame) {
+    if (image.format == AIMAGE_FORMAT_JPEG) {
+        AImage::Plane plane;
+        plane.data = {0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00,
+                      static_cast<uint8_t>(frame.frameNumber), 0xFF, 0xD9};
+        plane.rowStride = 0;
+        image.planes.push_back(std::move(plane));
+        return;
+    }
+
+    AImage::Plane luma;
+    luma.rowStride = image.width;
+    luma.data.resize(static_cast<size_t>(image.width) * static_cast<size_t>(image.height));
+    for (int32_t y = 0; y < image.height; ++y) {
+        uint8_t* row = luma.data.data() + static_cast<size_t>(y) * static_cast<size_t>(image.width);
+        for (int32_t x = 0; x < image.width; ++x) {
+            row[x] = static_cast<uint8_t>(x + y + frame.frameNumber);
+        }
+    }
+    image.planes.push_back(std::move(luma));
+    for (int i = 0; i < 2; ++i) {
+        AImage::Plane chroma;
+        chroma.rowStride = image.width / 2;
+        chroma.data.assign(static_cast<size_t>(image.width / 2) * static_cast<size_t>(image.height / 2), 128);
+        image.planes.push_back(std::move(chroma));
+    }
+}
+
+media_status_t acquire(AImageReader* reader, AImage** image, bool latest) {
+    if (!reader || !image) {
+        return AMEDIA_ERROR_INVALID_PARAMETER;
+    }
+    QueuedFrame frame;
+    {
+        std::lock_guard<std::mutex> lock(reader->mutex);
+        if (reader->queued.empty()) {
+            return AMEDIA_IMGREADER_NO_BUFFER_AVAILABLE;
+        }
+        std::lock_guard<std::mutex> sharedLock(reader->shared->mutex);
+        if (reader->shared->acquired >= reader->maxImages) {
+            return AMEDIA_IMGREADER_MAX_IMAGES_ACQUIRED;
+        }
+        if (latest) {
+            frame = reader->queued.back();
+            reader->queued.clear();
+        } else {
+            frame = reader->queued.front();
+            reader->queued.pop_front();
+        }
+        ++reader->shared->acquired;
+    }
+
+    auto* result = new AImage;
+    result->reader = reader->shared;
+    result->width = reader->width;
+    result->height = reader->height;
+    result->format = reader->format;
+    result->timestampNs = frame.timestampNs;
+    fillImage(*result, frame);
+    nativesensor::testing::detail::track(nativesensor::testing::detail::Handle::Image, 1);
+    *image = result;
+    return AMEDIA_OK;
+}
+
+const AImage::Plane* planeAt(const AImage* image, int planeIdx) {
+    if (!image || planeIdx < 0 || static_cast<size_t>(planeIdx) >= image->planes.size()) {
+        return nullptr;
+    }
+    return &image->planes[static_cast<size_t>(planeIdx)];
+}
+
+}  // namespace
+
+namespace nativesensor::testing::detail {
+
+void deliverImage(ANativeWindow* window, int64_t timestampNs, int64_t frameNumber) {
+    AImageReader* reader = nullptr;
+    AImageReader_ImageListener listener{};
+    {
+        std::lock_guard<std::mutex> registryLock(g_mediaMutex);
+        reader = window->reader;
+        if (!reader) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(reader->mutex);
+        reader->queued.push_back({timestampNs, frameNumber});
+        while (reader->queued.size() > static_cast<size_t>(reader->maxImages)) {
+            reader->queued.pop_front();
+        }
+        listener = reader->listener;
+        ++reader->callbacksRunning;
+    }
+
+    if (listener.onImageAvailable) {
+        listener.onImageAvailable(listener.context, reader);
+    }
+
+    std::lock_guard<std::mutex> lock(reader->mutex);
+    --reader->callbacksRunning;
+    reader->idle.notify_all();
+}
+
+}  // namespace nativesensor::testing::detail
+
+using namespace nativesensor::testing::detail;
+
+extern "C" {
+
+media_status_t AImageReader_new(int32_t width, int32_t height, int32_t format, int32_t maxImages,
+                                AImageReader** reader) {
+    if (!reader || width <= 0 || height <= 0 || maxImages <= 0) {
+        return AMEDIA_ERROR_INVALID_PARAMETER;
+    }
+    auto* result = new AImageReader;
+    result->width = width;
+    result->height = height;
+    result->format = format;
+    result->maxImages = maxImages;
+    result->window = createReaderWindow(result, width, height, format);
+    track(Handle::ImageReader, 1);
+    *reader = result;
+    return AMEDIA_OK;
+}
+
+void AImageReader_delete(AImageReader* reader) {
+    if (!reader) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> registryLock(g_mediaMutex);
+        reader->window->reader = nullptr;
+    }
+    {
+        // Like the NDK, wait for a listener call in progress to return
+        std::unique_lock<std::mutex> lock(reader->mutex);
+        reader->listener = {};
+        reader->idle.wait(lock, [reader] { return reader->callbacksRunning == 0; });
+    }
+    ANativeWindow_release(reader->window);
+    delete reader;
+    track(Handle::ImageReader, -1);
+}
+
+media_status_t AImageReader_getWindow(AImageReader* reader, ANativeWindow** window) {
+    if (!reader || !window) {
+        return AMEDIA_ERROR_INVALID_PARAMETER;
+    }
+    *window = reader->window;
+    return AMEDIA_OK;
+}
+
+media_status_t AImageReader_acquireNextImage(AImageReader* reader, AImage** image) {
+    return acquire(reader, image, false);
+}
+
+media_status_t AImageReader_acquireLatestImage(AImageReader* reader, AImage** image) {
+    return acquire(reader, image, true);
+}
+
+media_status_t AImageReader_setImageListener(AImageReader* reader, AImageReader_ImageListener* listener) {
+    if (!reader) {
+        return AMEDIA_ERROR_INVALID_PARAMETER;
+    }
+    std::lock_guard<std::mutex> lock(reader->mutex);
+    reader->listener = listener ? *listener : AImageReader_ImageListener{};
+    return AMEDIA_OK;
+}
+
+void AImage_delete(AImage* image) {
+    if (!image) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(image->reader->mutex);
+        --image->reader->acquired;
+    }
+    delete image;
+    track(Handle::Image, -1);
+}
+
+media_status_t AImage_getWidth(const AImage* image, int32_t* width) {
+    *width = image->width;
+    return AMEDIA_OK;
+}
+
+media_status_t AImage_getHeight(const AImage* image, int32_t* height) {
+    *height = image->height;
+    return AMEDIA_OK;
+}
+
+media_status_t AImage_getFormat(const AImage* image, int32_t* format) {
+    *format = image->format;
+    return AMEDIA_OK;
+}
+
+media_status_t AImage_getTimestamp(const AImage* image, int64_t* timestampNs) {
+    *timestampNs = image->timestampNs;
+    return AMEDIA_OK;
+}
+
+media_status_t AImage_getNumberOfPlanes(const AImage* image, int32_t* numPlanes) {
+    *numPlanes = static_cast<int32_t>(image->planes.size());
+    return AMEDIA_OK;
+}
+
+media_status_t AImage_getPlanePixelStride(const AImage* image, int planeIdx, int32_t* pixelStride) {
+    const AImage::Plane* plane = planeAt(image, planeIdx);
+    if (!plane) {
+        return AMEDIA_ERROR_INVALID_PARAMETER;
+    }
+    *pixelStride = plane->pixelStride;
+    return AMEDIA_OK;
+}
+
+media_status_t AImage_getPlaneRowStride(const AImage* image, int planeIdx, int32_t* rowStride) {
+    const AImage::Plane* plane = planeAt(image, planeIdx);
+    if (!plane) {
+        return AMEDIA_ERROR_INVALID_PARAMETER;
+    }
+    *rowStride = plane->rowStride;
+    return AMEDIA_OK;
+}
+
+media_status_t AImage_getPlaneData(const AImage* image, int planeIdx, uint8_t** data, int* dataLength) {
+    const AImage::Plane* plane = planeAt(image, planeIdx);
+    if (!plane) {
+        return AMEDIA_ERROR_INVALID_PARAMETER;
+    }
+    *data = const_cast<uint8_t*>(plane->data.data());
+    *dataLength = static_cast<int>(plane->data.size());
+    return AMEDIA_OK;
+}
+
+}
@@ -0,0 +1,370 @@
+// Synthetic <android/sensor.h>: a scripted sensor list whose queues generate
+// events lazily on each registration's period grid when polled. Replaced
+// sensor lists stay alive, so ASensor pointers never dangle.
+//
+// Lock order: g_registryMutex, then a looper's mutex.
+
+#include <android/sensor.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <memory>
+#include <set>
+
+#include "backend_internal.h"
+
+struct ASensorManager {};
+
+namespace nativesensor::testing::detail {
+
+namespace {
+
+constexpr int64_t kNsPerUs = 1'000;
+constexpr int64_t kDefaultPeriodNs = 5'000'000;
+constexpr size_t kDefaultFifo = 1024;
+constexpr float kWobbleAmplitude = 0.01f;
+constexpr double kWobbleHz = 1.0;
+
+std::mutex g_registryMutex;
+std::vector<std::unique_ptr<ASensor>> g_allSensors;    // Every sensor ever listed
+std::vector<const ASensor*> g_sensorList;
+std::set<ASensorEventQueue*> g_queues;
+std::atomic<bool> g_generation{true};
+ASensorManager g_manager;
+
+void listSensors(std::vector<SyntheticSensor> sensors) {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    g_sensorList.clear();
+    for (auto& spec : sensors) {
+        auto sensor = std::make_unique<ASensor>();
+        sensor->handle = static_cast<int>(g_sensorList.size());
+        sensor->spec = std::move(spec);
+        g_sensorList.push_back(sensor.get());
+        g_allSensors.push_back(std::move(sensor));
+    }
+}
+
+bool isUncalibrated(int type) {
+    return type == ASENSOR_TYPE_ACCELEROMETER_UNCALIBRATED || type == ASENSOR_TYPE_GYROSCOPE_UNCALIBRATED;
+}
+
+ASensorEvent makeEvent(const ASensor& sensor, float x, float y, float z, int64_t timestampNs) {
+    ASensorEvent event{};
+    event.version = sizeof(ASensorEvent);
+    event.sensor = sensor.handle;
+    event.type = sensor.spec.type;
+    event.timestamp = timestampNs;
+    event.data[0] = x;
+    event.data[1] = y;
+    event.data[2] = z;
+    if (isUncalibrated(sensor.spec.type)) {
+        event.uncalibrated_gyro.x_bias = 0.0f;
+        event.uncalibrated_gyro.y_bias = 0.0f;
+        event.uncalibrated_gyro.z_bias = 0.0f;
+    }
+    return event;
+}
+
+size_t fifoCapacity(const ASensor& sensor) {
+    return sensor.spec.fifoMax > 0 ? static_cast<size_t>(sensor.spec.fifoMax) : kDefaultFifo;
+}
+
+/// Queue an event, dropping the oldest once the sensor's FIFO is full
+void enqueue(ASensorEventQueue* queue, const ASensor& sensor, const ASensorEvent& event) {
+    queue->pending.push_back(event);
+    while (queue->pending.size() > fifoCapacity(sensor)) {
+        queue->pending.pop_front();
+    }
+}
+
+int64_t periodFor(const ASensor& sensor, int32_t requestedUs) {
+    const int64_t minNs = static_cast<int64_t>(sensor.spec.minDelayUs) * kNsPerUs;
+    const int64_t requestedNs = static_cast<int64_t>(requestedUs) * kNsPerUs;
+    const int64_t periodNs = std::max(minNs, requestedNs);
+    return periodNs > 0 ? periodNs : kDefaultPeriodNs;
+}
+
+}  // namespace
+
+void generateSensorEvents(ASensorEventQueue* queue, int64_t nowBootNs) {
+    if (!g_generation.load(std::memory_order_relaxed)) {
+        // Nothing piles up to burst out once generation is back on
+        for (auto& registration : queue->registrations) {
+            registration.nextNs = std::max(registration.nextNs, nowBootNs + registration.periodNs);
+        }
+        return;
+    }
+    for (auto& registration : queue->registrations) {
+        const ASensor& sensor = *registration.sensor;
+        // After a long stall only the FIFO's worth of events survives anyway
+        const auto capacity = static_cast<int64_t>(fifoCapacity(sensor));
+        if (nowBootNs - registration.nextNs > capacity * registration.periodNs) {
+            registration.nextNs += (nowBootNs - registration.nextNs) / registration.periodNs * registration.periodNs -
+                                   (capacity - 1) * registration.periodNs;
+        }
+        while (registration.nextNs <= nowBootNs) {
+            const double phase = 2.0 * M_PI * kWobbleHz * static_cast<double>(registration.nextNs) / kNsPerSecond;
+            const float wobble = kWobbleAmplitude * static_cast<float>(std::sin(phase));
+            enqueue(queue, sensor,
+                    makeEvent(sensor, sensor.spec.x + wobble, sensor.spec.y - wobble, sensor.spec.z + wobble,
+                              registration.nextNs));
+            registration.nextNs += registration.periodNs;
+        }
+    }
+}
+
+int64_t nextSensorEventNs(const ASensorEventQueue* queue) {
+    if (!g_generation.load(std::memory_order_relaxed)) {
+        return INT64_MAX;
+    }
+    int64_t next = INT64_MAX;
+    for (const auto& registration : queue->registrations) {
+        next = std::min(next, registration.nextNs);
+    }
+    return next;
+}
+
+void resetSensorBackend() {
+    listSensors(defaultSensors());
+    g_generation.store(true, std::memory_order_relaxed);
+}
+
+}  // namespace nativesensor::testing::detail
+
+namespace nativesensor::testing {
+
+std::vector<SyntheticSensor> defaultSensors() {
+    SyntheticSensor accel;
+    accel.type = ASENSOR_TYPE_ACCELEROMETER;
+    accel.name = "Synthetic Accelerometer";
+    accel.minDelayUs = 2500;
+    accel.fifoReserved = 3000;
+    accel.fifoMax = 4000;
+    accel.x = 0.1f;
+    accel.y = 0.2f;
+    accel.z = 9.81f;
+
+    SyntheticSensor gyro;
+    gyro.type = ASENSOR_TYPE_GYROSCOPE;
+    gyro.name = "Synthetic Gyroscope";
+    gyro.minDelayUs = 2500;
+    gyro.fifoReserved = 3000;
+    gyro.fifoMax = 4000;
+    gyro.x = 0.01f;
+    gyro.y = -0.02f;
+    gyro.z = 0.03f;
+
+    SyntheticSensor magnetometer;
+    magnetometer.type = ASENSOR_TYPE_MAGNETIC_FIELD;
+    magnetometer.name = "Synthetic Magnetometer";
+    magnetometer.minDelayUs = 10000;
+    magnetometer.x = 20.0f;
+    magnetometer.y = -5.0f;
+    magnetometer.z = -40.0f;
+
+    SyntheticSensor uncalAccel = accel;
+    uncalAccel.type = ASENSOR_TYPE_ACCELEROMETER_UNCALIBRATED;
+    uncalAccel.name = "Synthetic Uncalibrated Accelerometer";
+    uncalAccel.minDelayUs = 5000;
+    uncalAccel.fifoReserved = 0;
+
+    SyntheticSensor uncalGyro = gyro;
+    uncalGyro.type = ASENSOR_TYPE_GYROSCOPE_UNCALIBRATED;
+    uncalGyro.name = "Synthetic Uncalibrated Gyroscope";
+    uncalGyro.minDelayUs = 5000;
+    uncalGyro.fifoReserved = 0;
+
+    return {accel, gyro, magnetometer, uncalAccel, uncalGyro};
+}
+
+void setSensors(std::vector<SyntheticSensor> sensors) {
+    detail::listSensors(std::move(sensors));
+}
+
+void setSensorGeneration(bool enabled) {
+    detail::g_generation.store(enabled, std::memory_order_relaxed);
+}
+
+void injectSensorEvent(int type, float x, float y, float z, int64_t timestampNs) {
+    if (timestampNs == 0) {
+        timestampNs = detail::bootTimeNs();
+    }
+    std::lock_guard<std::mutex> registryLock(detail::g_registryMutex);
+    for (ASensorEventQueue* queue : detail::g_queues) {
+        std::lock_guard<std::mutex> lock(queue->looper->mutex);
+        for (const auto& registration : queue->registrations) {
+            if (registration.sensor->spec.type == type) {
+                detail::enqueue(queue, *registration.sensor,
+                                detail::makeEvent(*registration.sensor, x, y, z, timestampNs));
+                queue->looper->cv.notify_all();
+                break;
+            }
+        }
+    }
+}
+
+}  // namespace nativesensor::testing
+
+using namespace nativesensor::testing::detail;
+
+extern "C" {
+
+ASensorManager* ASensorManager_getInstanceForPackage(const char* /* packageName */) {
+    bool listed = false;
+    {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        listed = !g_allSensors.empty();
+    }
+    if (!listed) {
+        listSensors(nativesensor::testing::defaultSensors());
+    }
+    return &g_manager;
+}
+
+int ASensorManager_getSensorList(ASensorManager* /* manager */, ASensorList* list) {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    *list = g_sensorList.data();
+    return static_cast<int>(g_sensorList.size());
+}
+
+ASensor const* ASensorManager_getDefaultSensor(ASensorManager* /* manager */, int type) {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    for (const ASensor* sensor : g_sensorList) {
+        if (sensor->spec.type == type) {
+            return sensor;
+        }
+    }
+    return nullptr;
+}
+
+ASensorEventQueue* ASensorManager_createEventQueue(ASensorManager* /* manager */, ALooper* looper, int ident,
+                                                   ALooper_callbackFunc /* callback */, void* data) {
+    if (!looper) {
+        return nullptr;
+    }
+    auto* queue = new ASensorEventQueue;
+    queue->looper = looper;
+    queue->ident = ident;
+    queue->data = data;
+
+    std::lock_guard<std::mutex> registryLock(g_registryMutex);
+    g_queues.insert(queue);
+    std::lock_guard<std::mutex> lock(looper->mutex);
+    looper->queues.push_back(queue);
+    track(Handle::SensorQueue, 1);
+    return queue;
+}
+
+int ASensorManager_destroyEventQueue(ASensorManager* /* manager */, ASensorEventQueue* queue) {
+    if (!queue) {
+        return -1;
+    }
+    {
+        std::lock_guard<std::mutex> registryLock(g_registryMutex);
+        g_queues.erase(queue);
+        std::lock_guard<std::mutex> lock(queue->looper->mutex);
+        auto& queues = queue->looper->queues;
+        queues.erase(std::remove(queues.begin(), queues.end(), queue), queues.end());
+    }
+    delete queue;
+    track(Handle::SensorQueue, -1);
+    return 0;
+}
+
+int ASensorEventQueue_registerSensor(ASensorEventQueue* queue, ASensor const* sensor, int32_t samplingPeriodUs,
+                                     int64_t /* maxBatchReportLatencyUs */) {
+    if (!queue || !sensor) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(queue->looper->mutex);
+    auto& registrations = queue->registrations;
+    registrations.erase(std::remove_if(registrations.begin(), registrations.end(),
+                                       [sensor](const auto& r) { return r.sensor == sensor; }),
+                        registrations.end());
+    const int64_t periodNs = periodFor(*sensor, samplingPeriodUs);
+    registrations.push_back({sensor, periodNs, bootTimeNs() + periodNs});
+    queue->looper->cv.notify_all();
+    return 0;
+}
+
+int ASensorEventQueue_enableSensor(ASensorEventQueue* queue, ASensor const* sensor) {
+    return ASensorEventQueue_registerSensor(queue, sensor, sensor ? sensor->spec.minDelayUs : 0, 0);
+}
+
+int ASensorEventQueue_disableSensor(ASensorEventQueue* queue, ASensor const* sensor) {
+    if (!queue || !sensor) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(queue->looper->mutex);
+    auto& registrations = queue->registrations;
+    registrations.erase(std::remove_if(registrations.begin(), registrations.end(),
+                                       [sensor](const auto& r) { return r.sensor == sensor; }),
+                        registrations.end());
+    return 0;
+}
+
+int ASensorEventQueue_setEventRate(ASensorEventQueue* queue, ASensor const* sensor, int32_t usec) {
+    if (!queue || !sensor) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(queue->looper->mutex);
+    for (auto& registration : queue->registrations) {
+        if (registration.sensor == sensor) {
+            registration.periodNs = periodFor(*sensor, usec);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int ASensorEventQueue_hasEvents(ASensorEventQueue* queue) {
+    std::lock_guard<std::mutex> lock(queue->looper->mutex);
+    generateSensorEvents(queue, bootTimeNs());
+    return queue->pending.empty() ? 0 : 1;
+}
+
+ssize_t ASensorEventQueue_getEvents(ASensorEventQueue* queue, ASensorEvent* events, size_t count) {
+    std::lock_guard<std::mutex> lock(queue->looper->mutex);
+    generateSensorEvents(queue, bootTimeNs());
+    size_t n = 0;
+    while (n < count && !queue->pending.empty()) {
+        events[n++] = queue->pending.front();
+        queue->pending.pop_front();
+    }
+    return static_cast<ssize_t>(n);
+}
+
+const char* ASensor_getName(ASensor const* sensor) {
+    return sensor->spec.name.c_str();
+}
+
+const char* ASensor_getVendor(ASensor const* sensor) {
+    return sensor->spec.vendor.c_str();
+}
+
+int ASensor_getType(ASensor const* sensor) {
+    return sensor->spec.type;
+}
+
+float ASensor_getResolution(ASensor const* /* sensor */) {
+    return 0.001f;
+}
+
+int ASensor_getMinDelay(ASensor const* sensor) {
+    return sensor->spec.minDelayUs;
+}
+
+int ASensor_getFifoMaxEventCount(ASensor const* sensor) {
+    return sensor->spec.fifoMax;
+}
+
+int ASensor_getFifoReservedEventCount(ASensor const* sensor) {
+    return sensor->spec.fifoReserved;
+}
+
+int ASensor_getHandle(ASensor const* sensor) {
+    return sensor->handle;
+}
+
+}
@@ -0,0 +1,56 @@
+// Synthetic <android/native_window.h>: refcounted windows, either preview
+// surfaces made by tests or owned by an image reader
+
+#include <android/native_window.h>
+
+#include "backend_internal.h"
+
+namespace nativesensor::testing {
+
+ANativeWindow* createWindow(int32_t width, int32_t height, int32_t format) {
+    auto* window = new ANativeWindow;
+    window->width = width;
+    window->height = height;
+    window->format = format;
+    detail::track(detail::Handle::Window, 1);
+    return window;
+}
+
+namespace detail {
+
+ANativeWindow* createReaderWindow(AImageReader* reader, int32_t width, int32_t height, int32_t format) {
+    ANativeWindow* window = createWindow(width, height, format);
+    window->reader = reader;
+    return window;
+}
+
+}  // namespace detail
+
+}  // namespace nativesensor::testing
+
+extern "C" {
+
+void ANativeWindow_acquire(ANativeWindow* window) {
+    window->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ANativeWindow_release(ANativeWindow* window) {
+    if (window->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete window;
+        nativesensor::testing::detail::track(nativesensor::testing::detail::Handle::Window, -1);
+    }
+}
+
+int32_t ANativeWindow_getWidth(ANativeWindow* window) {
+    return window->width;
+}
+
+int32_t ANativeWindow_getHeight(ANativeWindow* window) {
+    return window->height;
+}
+
+int32_t ANativeWindow_getFormat(ANativeWindow* window) {
+    return window->format;
+}
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// Host stand-in for the NDK's <android/choreographer.h>: vsync callbacks at
+// the synthetic display rate; see fake_looper.cpp
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct AChoreographer AChoreographer;
+typedef struct AChoreographerFrameCallbackData AChoreographerFrameCallbackData;
+typedef int64_t AVsyncId;
+
+typedef void (*AChoreographer_vsyncCallback)(const AChoreographerFrameCallbackData* callbackData, void* data);
+
+extern "C" {
+
+AChoreographer* AChoreographer_getInstance();
+int AChoreographer_postVsyncCallback(AChoreographer* choreographer, AChoreographer_vsyncCallback callback,
+                                     void* data);
+
+int64_t AChoreographerFrameCallbackData_getFrameTimeNanos(const AChoreographerFrameCallbackData* data);
+size_t AChoreographerFrameCallbackData_getFrameTimelinesLength(const AChoreographerFrameCallbackData* data);
+size_t AChoreographerFrameCallbackData_getPreferredFrameTimelineIndex(const AChoreographerFrameCallbackData* data);
+AVsyncId AChoreographerFrameCallbackData_getFrameTimelineVsyncId(const AChoreographerFrameCallbackData* data,
+                                                                 size_t index);
+int64_t AChoreographerFrameCallbackData_getFrameTimelineExpectedPresentationTimeNanos(
+    const AChoreographerFrameCallbackData* data, size_t index);
+int64_t AChoreographerFrameCallbackData_getFrameTimelineDeadlineNanos(const AChoreographerFrameCallbackData* data,
+                                                                      size_t index);
+
+}
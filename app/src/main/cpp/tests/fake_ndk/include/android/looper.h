@@ -0,0 +1,28 @@
+#pragma once
+
+// Host stand-in for the NDK's <android/looper.h>: poll-only loopers, woken by
+// synthetic sensor queues and Choreographer callbacks; see fake_looper.cpp
+
+typedef struct ALooper ALooper;
+
+typedef int (*ALooper_callbackFunc)(int fd, int events, void* data);
+
+enum {
+    ALOOPER_PREPARE_ALLOW_NON_CALLBACKS = 1 << 0
+};
+
+enum {
+    ALOOPER_POLL_WAKE = -1,
+    ALOOPER_POLL_CALLBACK = -2,
+    ALOOPER_POLL_TIMEOUT = -3,
+    ALOOPER_POLL_ERROR = -4,
+};
+
+extern "C" {
+
+ALooper* ALooper_forThread();
+ALooper* ALooper_prepare(int opts);
+int ALooper_pollOnce(int timeoutMillis, int* outFd, int* outEvents, void** outData);
+void ALooper_wake(ALooper* looper);
+
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+// Host stand-in for the NDK's <android/native_window.h>: refcounted windows
+// made by tests (preview surfaces) or image readers; see fake_window.cpp
+
+#include <stdint.h>
+
+typedef struct ANativeWindow ANativeWindow;
+
+enum {
+    WINDOW_FORMAT_RGBA_8888 = 1,
+    WINDOW_FORMAT_RGBX_8888 = 2,
+    WINDOW_FORMAT_RGB_565 = 4,
+};
+
+extern "C" {
+
+void ANativeWindow_acquire(ANativeWindow* window);
+void ANativeWindow_release(ANativeWindow* window);
+int32_t ANativeWindow_getWidth(ANativeWindow* window);
+int32_t ANativeWindow_getHeight(ANativeWindow* window);
+int32_t ANativeWindow_getFormat(ANativeWindow* window);
+
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+// Host stand-in for the NDK's <android/native_window_jni.h>; surfaces come
+// from nativesensor::testing::FakeJniEnv::surface()
+
+#include <android/native_window.h>
+#include <jni.h>
+
+extern "C" {
+
+/// Window behind a Surface with a reference for the caller, null for other objects
+ANativeWindow* ANativeWindow_fromSurface(JNIEnv* env, jobject surface);
+
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+// Host stand-in for the NDK's <android/sensor.h>: a scripted sensor list whose
+// queues generate events at their registered rate; see fake_sensor.cpp
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <android/looper.h>
+
+enum {
+    ASENSOR_TYPE_INVALID = -1,
+    ASENSOR_TYPE_ACCELEROMETER = 1,
+    ASENSOR_TYPE_MAGNETIC_FIELD = 2,
+    ASENSOR_TYPE_GYROSCOPE = 4,
+    ASENSOR_TYPE_LIGHT = 5,
+    ASENSOR_TYPE_PRESSURE = 6,
+    ASENSOR_TYPE_PROXIMITY = 8,
+    ASENSOR_TYPE_GRAVITY = 9,
+    ASENSOR_TYPE_LINEAR_ACCELERATION = 10,
+    ASENSOR_TYPE_ROTATION_VECTOR = 11,
+    ASENSOR_TYPE_GYROSCOPE_UNCALIBRATED = 16,
+    ASENSOR_TYPE_ACCELEROMETER_UNCALIBRATED = 35,
+};
+
+enum {
+    ASENSOR_STATUS_NO_CONTACT = -1,
+    ASENSOR_STATUS_UNRELIABLE = 0,
+    ASENSOR_STATUS_ACCURACY_LOW = 1,
+    ASENSOR_STATUS_ACCURACY_MEDIUM = 2,
+    ASENSOR_STATUS_ACCURACY_HIGH = 3,
+};
+
+typedef struct ASensorVector {
+    union {
+        float v[3];
+        struct {
+            float x;
+            float y;
+            float z;
+        };
+        struct {
+            float azimuth;
+            float pitch;
+            float roll;
+        };
+    };
+    int8_t status;
+    uint8_t reserved[3];
+} ASensorVector;
+
+typedef struct AUncalibratedEvent {
+    union {
+        float uncalib[3];
+        struct {
+            float x_uncalib;
+            float y_uncalib;
+            float z_uncalib;
+        };
+    };
+    union {
+        float bias[3];
+        struct {
+            float x_bias;
+            float y_bias;
+            float z_bias;
+        };
+    };
+} AUncalibratedEvent;
+
+typedef struct ASensorEvent {
+    int32_t version;    // sizeof(struct ASensorEvent)
+    int32_t sensor;     // Sensor handle
+    int32_t type;
+    int32_t reserved0;
+    int64_t timestamp;  // CLOCK_BOOTTIME nanoseconds
+    union {
+        float data[16];
+        ASensorVector vector;
+        ASensorVector acceleration;
+        ASensorVector gyro;
+        ASensorVector magnetic;
+        AUncalibratedEvent uncalibrated_acceleration;
+        AUncalibratedEvent uncalibrated_gyro;
+    };
+    uint32_t flags;
+    int32_t reserved1[3];
+} ASensorEvent;
+
+typedef struct ASensorManager ASensorManager;
+typedef struct ASensorEventQueue ASensorEventQueue;
+typedef struct ASensor ASensor;
+typedef ASensor const* ASensorRef;
+typedef ASensorRef const* ASensorList;
+
+extern "C" {
+
+ASensorManager* ASensorManager_getInstanceForPackage(const char* packageName);
+int ASensorManager_getSensorList(ASensorManager* manager, ASensorList* list);
+ASensor const* ASensorManager_getDefaultSensor(ASensorManager* manager, int type);
+ASensorEventQueue* ASensorManager_createEventQueue(ASensorManager* manager, ALooper* looper, int ident,
+                                                   ALooper_callbackFunc callback, void* data);
+int ASensorManager_destroyEventQueue(ASensorManager* manager, ASensorEventQueue* queue);
+
+int ASensorEventQueue_registerSensor(ASensorEventQueue* queue, ASensor const* sensor, int32_t samplingPeriodUs,
+                                     int64_t maxBatchReportLatencyUs);
+int ASensorEventQueue_enableSensor(ASensorEventQueue* queue, ASensor const* sensor);
+int ASensorEventQueue_disableSensor(ASensorEventQueue* queue, ASensor const* sensor);
+int ASensorEventQueue_setEventRate(ASensorEventQueue* queue, ASensor const* sensor, int32_t usec);
+int ASensorEventQueue_hasEvents(ASensorEventQueue* queue);
+ssize_t ASensorEventQueue_getEvents(ASensorEventQueue* queue, ASensorEvent* events, size_t count);
+
+const char* ASensor_getName(ASensor const* sensor);
+const char* ASensor_getVendor(ASensor const* sensor);
+int ASensor_getType(ASensor const* sensor);
+float ASensor_getResolution(ASensor const* sensor);
+int ASensor_getMinDelay(ASensor const* sensor);
+int ASensor_getFifoMaxEventCount(ASensor const* sensor);
+int ASensor_getFifoReservedEventCount(ASensor const* sensor);
+int ASensor_getHandle(ASensor const* sensor);
+
+}
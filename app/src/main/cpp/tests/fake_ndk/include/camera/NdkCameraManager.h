@@ -0,0 +1,28 @@
+#pragma once
+
+// Host stand-in for the NDK's <camera/NdkCameraManager.h>: cameras come from
+// nativesensor::testing::setCameras(); see fake_camera.cpp
+
+#include <camera/NdkCameraDevice.h>
+#include <camera/NdkCameraError.h>
+#include <camera/NdkCameraMetadata.h>
+
+typedef struct ACameraManager ACameraManager;
+
+typedef struct ACameraIdList {
+    int numCameras;
+    const char** cameraIds;
+} ACameraIdList;
+
+extern "C" {
+
+ACameraManager* ACameraManager_create();
+void ACameraManager_delete(ACameraManager* manager);
+camera_status_t ACameraManager_getCameraIdList(ACameraManager* manager, ACameraIdList** cameraIdList);
+void ACameraManager_deleteCameraIdList(ACameraIdList* cameraIdList);
+camera_status_t ACameraManager_getCameraCharacteristics(ACameraManager* manager, const char* cameraId,
+                                                        ACameraMetadata** characteristics);
+camera_status_t ACameraManager_openCamera(ACameraManager* manager, const char* cameraId,
+                                          ACameraDevice_StateCallbacks* callback, ACameraDevice** device);
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+// Host stand-in for the NDK's <camera/NdkCameraMetadataTags.h>: the tags this
+// library reads or sets, with their NDK values
+
+typedef enum acamera_metadata_tag {
+    ACAMERA_CONTROL_AE_AVAILABLE_TARGET_FPS_RANGES = 0x10013,
+    ACAMERA_JPEG_QUALITY = 0x70004,
+    ACAMERA_LENS_FACING = 0x80005,
+    ACAMERA_LENS_POSE_ROTATION = 0x80006,
+    ACAMERA_LENS_POSE_TRANSLATION = 0x80007,
+    ACAMERA_LENS_INTRINSIC_CALIBRATION = 0x8000A,
+    ACAMERA_LENS_DISTORTION = 0x8000B,
+    ACAMERA_LENS_POSE_REFERENCE = 0x8000C,
+    ACAMERA_SCALER_AVAILABLE_STREAM_CONFIGURATIONS = 0xD000A,
+    ACAMERA_SENSOR_EXPOSURE_TIME = 0xE0000,
+    ACAMERA_SENSOR_FRAME_DURATION = 0xE0001,
+    ACAMERA_SENSOR_SENSITIVITY = 0xE0002,
+    ACAMERA_SENSOR_TIMESTAMP = 0xE0010,
+    ACAMERA_SENSOR_ROLLING_SHUTTER_SKEW = 0xE001A,
+    ACAMERA_SENSOR_INFO_ACTIVE_ARRAY_SIZE = 0xF0000,
+    ACAMERA_SENSOR_INFO_PIXEL_ARRAY_SIZE = 0xF0006,
+    ACAMERA_SENSOR_INFO_TIMESTAMP_SOURCE = 0xF0008,
+    ACAMERA_SENSOR_INFO_PRE_CORRECTION_ACTIVE_ARRAY_SIZE = 0xF000A,
+    ACAMERA_LOGICAL_MULTI_CAMERA_PHYSICAL_IDS = 0x1A0000,
+} acamera_metadata_tag_t;
+
+typedef enum acamera_metadata_enum_acamera_lens_facing {
+    ACAMERA_LENS_FACING_FRONT = 0,
+    ACAMERA_LENS_FACING_BACK = 1,
+    ACAMERA_LENS_FACING_EXTERNAL = 2,
+} acamera_metadata_enum_android_lens_facing_t;
+
+typedef enum acamera_metadata_enum_acamera_lens_pose_reference {
+    ACAMERA_LENS_POSE_REFERENCE_PRIMARY_CAMERA = 0,
+    ACAMERA_LENS_POSE_REFERENCE_GYROSCOPE = 1,
+    ACAMERA_LENS_POSE_REFERENCE_UNDEFINED = 2,
+    ACAMERA_LENS_POSE_REFERENCE_AUTOMOTIVE = 3,
+} acamera_metadata_enum_android_lens_pose_reference_t;
@@ -0,0 +1,31 @@
+#pragma once
+
+// Host stand-in for the NDK's <camera/NdkCaptureRequest.h>
+
+#include <stdint.h>
+
+#include <android/native_window.h>
+#include <camera/NdkCameraError.h>
+#include <camera/NdkCameraMetadata.h>
+
+typedef struct ACameraOutputTarget ACameraOutputTarget;
+typedef struct ACaptureRequest ACaptureRequest;
+
+extern "C" {
+
+camera_status_t ACameraOutputTarget_create(ANativeWindow* window, ACameraOutputTarget** output);
+void ACameraOutputTarget_free(ACameraOutputTarget* output);
+
+camera_status_t ACaptureRequest_addTarget(ACaptureRequest* request, const ACameraOutputTarget* output);
+camera_status_t ACaptureRequest_removeTarget(ACaptureRequest* request, const ACameraOutputTarget* output);
+camera_status_t ACaptureRequest_getConstEntry(const ACaptureRequest* request, uint32_t tag,
+                                              ACameraMetadata_const_entry* entry);
+camera_status_t ACaptureRequest_setEntry_u8(ACaptureRequest* request, uint32_t tag, uint32_t count,
+                                            const uint8_t* data);
+camera_status_t ACaptureRequest_setEntry_i32(ACaptureRequest* request, uint32_t tag, uint32_t count,
+                                             const int32_t* data);
+camera_status_t ACaptureRequest_setEntry_i64(ACaptureRequest* request, uint32_t tag, uint32_t count,
+                                             const int64_t* data);
+void ACaptureRequest_free(ACaptureRequest* request);
+
+}
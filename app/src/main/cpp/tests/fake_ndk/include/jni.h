@@ -0,0 +1,93 @@
+#pragma once
+
+// Host stand-in for <jni.h>: the JNIEnv and JavaVM calls this library makes,
+// as virtual functions implemented by nativesensor::testing::FakeJniEnv and
+// the fake VM; see fake_jni.cpp
+
+#include <stdarg.h>
+#include <stdint.h>
+
+typedef uint8_t jboolean;
+typedef int8_t jbyte;
+typedef uint16_t jchar;
+typedef int16_t jshort;
+typedef int32_t jint;
+typedef int64_t jlong;
+typedef float jfloat;
+typedef double jdouble;
+typedef jint jsize;
+
+class _jobject {
+public:
+    virtual ~_jobject() = default;
+};
+class _jclass : public _jobject {};
+class _jstring : public _jobject {};
+class _jarray : public _jobject {};
+class _jobjectArray : public _jarray {};
+class _jbooleanArray : public _jarray {};
+class _jbyteArray : public _jarray {};
+class _jintArray : public _jarray {};
+class _jlongArray : public _jarray {};
+class _jfloatArray : public _jarray {};
+class _jdoubleArray : public _jarray {};
+
+typedef _jobject* jobject;
+typedef _jclass* jclass;
+typedef _jstring* jstring;
+typedef _jarray* jarray;
+typedef _jobjectArray* jobjectArray;
+typedef _jbooleanArray* jbooleanArray;
+typedef _jbyteArray* jbyteArray;
+typedef _jintArray* jintArray;
+typedef _jlongArray* jlongArray;
+typedef _jfloatArray* jfloatArray;
+typedef _jdoubleArray* jdoubleArray;
+
+#define JNI_FALSE 0
+#define JNI_TRUE 1
+
+#define JNI_VERSION_1_6 0x00010006
+
+#define JNI_OK (0)
+#define JNI_ERR (-1)
+#define JNI_EDETACHED (-2)
+#define JNI_EVERSION (-3)
+
+#define JNIEXPORT __attribute__((visibility("default")))
+#define JNIIMPORT
+#define JNICALL
+
+struct _JNIEnv {
+    virtual jstring NewStringUTF(const char* bytes) = 0;
+    virtual const char* GetStringUTFChars(jstring string, jboolean* isCopy) = 0;
+    virtual void ReleaseStringUTFChars(jstring string, const char* utf) = 0;
+
+    virtual jsize GetArrayLength(jarray array) = 0;
+    virtual jintArray NewIntArray(jsize length) = 0;
+    virtual jfloatArray NewFloatArray(jsize length) = 0;
+    virtual void GetFloatArrayRegion(jfloatArray array, jsize start, jsize length, jfloat* buf) = 0;
+    virtual void SetFloatArrayRegion(jfloatArray array, jsize start, jsize length, const jfloat* buf) = 0;
+    virtual void SetIntArrayRegion(jintArray array, jsize start, jsize length, const jint* buf) = 0;
+
+    virtual jobject NewGlobalRef(jobject obj) = 0;
+    virtual void DeleteGlobalRef(jobject globalRef) = 0;
+    virtual void DeleteLocalRef(jobject localRef) = 0;
+
+protected:
+    _JNIEnv() = default;
+    ~_JNIEnv() = default;
+};
+
+struct _JavaVM {
+    virtual jint GetEnv(void** env, jint version) = 0;
+    virtual jint AttachCurrentThread(_JNIEnv** env, void* args) = 0;
+    virtual jint DetachCurrentThread() = 0;
+
+protected:
+    _JavaVM() = default;
+    ~_JavaVM() = default;
+};
+
+typedef _JNIEnv JNIEnv;
+typedef _JavaVM JavaVM;
@@ -0,0 +1,30 @@
+#pragma once
+
+// Host stand-in for the NDK's <media/NdkImage.h>
+
+#include <stdint.h>
+
+#include <media/NdkMediaError.h>
+
+typedef struct AImage AImage;
+
+enum AIMAGE_FORMATS {
+    AIMAGE_FORMAT_RGBA_8888 = 0x1,
+    AIMAGE_FORMAT_YUV_420_888 = 0x23,
+    AIMAGE_FORMAT_JPEG = 0x100,
+    AIMAGE_FORMAT_PRIVATE = 0x22,
+};
+
+extern "C" {
+
+void AImage_delete(AImage* image);
+media_status_t AImage_getWidth(const AImage* image, int32_t* width);
+media_status_t AImage_getHeight(const AImage* image, int32_t* height);
+media_status_t AImage_getFormat(const AImage* image, int32_t* format);
+media_status_t AImage_getTimestamp(const AImage* image, int64_t* timestampNs);
+media_status_t AImage_getNumberOfPlanes(const AImage* image, int32_t* numPlanes);
+media_status_t AImage_getPlanePixelStride(const AImage* image, int planeIdx, int32_t* pixelStride);
+media_status_t AImage_getPlaneRowStride(const AImage* image, int planeIdx, int32_t* rowStride);
+media_status_t AImage_getPlaneData(const AImage* image, int planeIdx, uint8_t** data, int* dataLength);
+
+}
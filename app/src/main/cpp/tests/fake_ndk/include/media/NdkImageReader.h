@@ -0,0 +1,29 @@
+#pragma once
+
+// Host stand-in for the NDK's <media/NdkImageReader.h>: readers receive frames
+// from synthetic capture sessions that target their window; see fake_media.cpp
+
+#include <android/native_window.h>
+#include <media/NdkImage.h>
+#include <media/NdkMediaError.h>
+
+typedef struct AImageReader AImageReader;
+
+typedef void (*AImageReader_ImageCallback)(void* context, AImageReader* reader);
+
+typedef struct AImageReader_ImageListener {
+    void* context;
+    AImageReader_ImageCallback onImageAvailable;
+} AImageReader_ImageListener;
+
+extern "C" {
+
+media_status_t AImageReader_new(int32_t width, int32_t height, int32_t format, int32_t maxImages,
+                                AImageReader** reader);
+void AImageReader_delete(AImageReader* reader);
+media_status_t AImageReader_getWindow(AImageReader* reader, ANativeWindow** window);
+media_status_t AImageReader_acquireNextImage(AImageReader* reader, AImage** image);
+media_status_t AImageReader_acquireLatestImage(AImageReader* reader, AImage** image);
+media_status_t AImageReader_setImageListener(AImageReader* reader, AImageReader_ImageListener* listener);
+
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+// Control surface of the synthetic NDK backends the host tests link against:
+// scripted sensors and cameras, fault injection and leak accounting
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <android/native_window.h>
+#include <jni.h>
+
+namespace nativesensor::testing {
+
+/// One entry of the synthetic ASensorManager list; the list index is the handle
+struct SyntheticSensor {
+    int type = 0;
+    std::string name;
+    std::string vendor = "Synthetic";
+    int minDelayUs = 0;
+    int fifoReserved = 0;
+    int fifoMax = 0;                    // Pending events per queue before the oldest drops
+    float x = 0.0f;                     // Resting value; events add a small 1 Hz wobble
+    float y = 0.0f;
+    float z = 0.0f;
+};
+
+/// Accelerometer and gyroscope at 400 Hz, a magnetometer and uncalibrated
+/// accelerometer and gyroscope at 200 Hz
+[[nodiscard]] std::vector<SyntheticSensor> defaultSensors();
+void setSensors(std::vector<SyntheticSensor> sensors);
+
+/// Switch periodic event generation on registered sensors on or off; injected
+/// events are delivered either way
+void setSensorGeneration(bool enabled);
+
+/// Queue an event on every queue with a sensor of this type enabled.
+/// @param timestampNs CLOCK_BOOTTIME timestamp, 0 for now
+void injectSensorEvent(int type, float x, float y, float z, int64_t timestampNs = 0);
+
+/// One entry of the synthetic ACameraManager
+struct SyntheticCamera {
+    std::string id;
+    uint8_t facing = 1;                 // ACAMERA_LENS_FACING_*
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t maxFps = 30;                // Advertised and delivered frame rate
+    std::string physicalIds;            // Comma-separated; makes this a logical camera
+    bool calibrated = true;             // Intrinsics, distortion and pose tags
+    float poseX = 0.0f;                 // Lens position along the device x axis (m)
+    int64_t exposureNs = 8'000'000;
+    int64_t rollingShutterSkewNs = 5'000'000;
+    int64_t latencyNs = 20'000'000;     // Sensor timestamp to capture callback
+};
+
+/// "0" back 2048x1536@30 (passthrough), "1" and "2" front 640x480@60
+/// (tracking pair, 64 mm apart) and an "eye0" 400x400@60 camera
+[[nodiscard]] std::vector<SyntheticCamera> defaultCameras();
+void setCameras(std::vector<SyntheticCamera> cameras);
+
+/// Disconnect every open device of the camera (onDisconnected), stopping its capture
+void disconnectCamera(const std::string& id);
+
+/// Fail every open device of the camera with `error` (onError, ERROR_CAMERA_*)
+void failCamera(const std::string& id, int error);
+
+/// Make ACameraManager_openCamera() of this camera return `status`
+/// (camera_status_t); ACAMERA_OK clears it
+void setCameraOpenError(const std::string& id, int status);
+
+/// Make the next `count` stills captured on the camera come back without a
+/// JPEG: onCaptureFailed, or onCaptureBufferLost with `bufferLost`
+void failStills(const std::string& id, int count, bool bufferLost = false);
+
+/// Rate of synthetic Choreographer vsync callbacks
+void setDisplayRefreshRate(double hz);
+
+/// Preview surface; the caller owns one reference
+[[nodiscard]] ANativeWindow* createWindow(int32_t width, int32_t height, int32_t format = WINDOW_FORMAT_RGBA_8888);
+
+/// NDK objects currently alive, for leak checks
+struct LiveHandles {
+    int sensorQueues = 0;
+    int cameraManagers = 0;
+    int cameraDevices = 0;
+    int captureSessions = 0;
+    int captureRequests = 0;
+    int outputTargets = 0;
+    int sessionOutputs = 0;
+    int outputContainers = 0;
+    int cameraMetadata = 0;
+    int idLists = 0;
+    int imageReaders = 0;
+    int images = 0;
+    int windows = 0;
+
+    [[nodiscard]] int total() const noexcept;
+    [[nodiscard]] std::string toString() const;
+};
+
+[[nodiscard]] LiveHandles liveHandles();
+
+/// Messages logged at `priority` (android_LogPriority) since the last reset
+[[nodiscard]] int64_t loggedCount(int priority);
+
+/// Default sensors, cameras and display rate, generation on, no injected faults
+void resetSyntheticBackends();
+
+/// JNIEnv whose local references are plain C++ objects, freed with the env
+class FakeJniEnv : public JNIEnv {
+public:
+    FakeJniEnv();
+    FakeJniEnv(const FakeJniEnv&) = delete;
+    FakeJniEnv& operator=(const FakeJniEnv&) = delete;
+    virtual ~FakeJniEnv();
+
+    [[nodiscard]] jstring string(const std::string& value);
+    [[nodiscard]] jfloatArray floatArray(const std::vector<float>& values);
+    /// Surface object holding a reference to `window`
+    [[nodiscard]] jobject surface(ANativeWindow* window);
+
+    [[nodiscard]] static std::string text(jstring value);
+    [[nodiscard]] static std::vector<float> floats(jfloatArray values);
+    [[nodiscard]] static std::vector<int32_t> ints(jintArray values);
+
+    /// Local references created through this env and not deleted
+    [[nodiscard]] size_t localRefs() const noexcept { return objects_.size(); }
+
+    jstring NewStringUTF(const char* bytes) override;
+    const char* GetStringUTFChars(jstring string, jboolean* isCopy) override;
+    void ReleaseStringUTFChars(jstring string, const char* utf) override;
+    jsize GetArrayLength(jarray array) override;
+    jintArray NewIntArray(jsize length) override;
+    jfloatArray NewFloatArray(jsize length) override;
+    void GetFloatArrayRegion(jfloatArray array, jsize start, jsize length, jfloat* buf) override;
+    void SetFloatArrayRegion(jfloatArray array, jsize start, jsize length, const jfloat* buf) override;
+    void SetIntArrayRegion(jintArray array, jsize start, jsize length, const jint* buf) override;
+    jobject NewGlobalRef(jobject obj) override;
+    void DeleteGlobalRef(jobject globalRef) override;
+    void DeleteLocalRef(jobject localRef) override;
+
+private:
+    template<typename T>
+    T* adopt(std::unique_ptr<T> object);
+
+    std::vector<std::unique_ptr<_jobject>> objects_;
+};
+
+/// VM whose GetEnv/AttachCurrentThread hand out a FakeJniEnv per thread
+[[nodiscard]] JavaVM* javaVm();
+
+}  // namespace nativesensor::testing
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "frame_pool.h"
+#include "frame_quality.h"
+
+namespace nativesensor::testing {
+namespace {
+
+// Odd width so the scalar tail runs after the 8-wide NEON steps
+constexpr int32_t kWidth = 203;
+constexpr int32_t kHeight = 120;
+constexpr int32_t kStride = 224;
+
+struct Image {
+    std::vector<uint8_t> data = std::vector<uint8_t>(static_cast<size_t>(kStride) * kHeight, 0);
+
+    uint8_t& at(int32_t x, int32_t y) { return data[static_cast<size_t>(y) * kStride + static_cast<size_t>(x)]; }
+};
+
+Image flat(uint8_t value) {
+    Image image;
+    for (int32_t y = 0; y < kHeight; ++y) {
+        std::fill_n(&image.at(0, y), kWidth, value);
+    }
+    return image;
+}
+
+/// Gray 128 plus white Gaussian noise of the given sigma
+Image noisy(float sigma) {
+    Image image;
+    std::mt19937 rng(7);
+    std::normal_distribution<float> gauss(128.0f, sigma);
+    for (int32_t y = 0; y < kHeight; ++y) {
+        for (int32_t x = 0; x < kWidth; ++x) {
+            image.at(x, y) = static_cast<uint8_t>(std::clamp(std::lround(gauss(rng)), 0L, 255L));
+        }
+    }
+    return image;
+}
+
+FrameQuality measure(const Image& image, int32_t rowStep = 1) {
+    FrameQuality quality;
+    measureFrameQuality(image.data.data(), kWidth, kHeight, kStride, rowStep, quality);
+    return quality;
+}
+
+TEST(FrameQualityTest, FlatFrameHasNoDetailAndOneHistogramBin) {
+    const FrameQuality quality = measure(flat(100));
+    EXPECT_FLOAT_EQ(quality.meanLuma, 100.0f);
+    EXPECT_FLOAT_EQ(quality.sharpness, 0.0f);
+    EXPECT_FLOAT_EQ(quality.noiseSigma, 0.0f);
+    EXPECT_FLOAT_EQ(quality.darkClipRatio, 0.0f);
+    EXPECT_FLOAT_EQ(quality.brightClipRatio, 0.0f);
+    for (size_t bin = 0; bin < FrameQuality::kHistogramBins; ++bin) {
+        EXPECT_FLOAT_EQ(quality.histogram[bin], bin == 100 / 8 ? 1.0f : 0.0f) << bin;
+    }
+}
+
+TEST(FrameQualityTest, CountsClippedSamplesAtBothEnds) {
+    // Measured columns 1..202: a quarter crushed, a quarter blown out
+    Image image = flat(128);
+    for (int32_t y = 0; y < kHeight; ++y) {
+        for (int32_t x = 0; x < kWidth; ++x) {
+            if (x < 51) {
+                image.at(x, y) = FrameQuality::kDarkClip;
+            } else if (x >= kWidth - 51) {
+                image.at(x, y) = FrameQuality::kBrightClip;
+            }
+        }
+    }
+    const FrameQuality quality = measure(image);
+    const float measured = static_cast<float>(kWidth - 2);
+    EXPECT_FLOAT_EQ(quality.darkClipRatio, 50.0f / measured);
+    EXPECT_FLOAT_EQ(quality.brightClipRatio, 50.0f / measured);
+    EXPECT_FLOAT_EQ(quality.histogram[0] + quality.histogram[16] + quality.histogram[31], 1.0f);
+    EXPECT_GT(quality.histogram[0], 0.2f);
+    EXPECT_GT(quality.histogram[31], 0.2f);
+}
+
+TEST(FrameQualityTest, WhiteNoiseMatchesItsSigma) {
+    // Immerkaer recovers sigma; the Laplacian of iid noise has variance 20 sigma^2
+    for (const float sigma : {3.0f, 8.0f}) {
+        const FrameQuality quality = measure(noisy(sigma));
+        EXPECT_NEAR(quality.meanLuma, 128.0f, 0.2f) << sigma;
+        EXPECT_NEAR(quality.noiseSigma, sigma, 0.05f * sigma) << sigma;
+        EXPECT_NEAR(quality.sharpness, 20.0f * sigma * sigma, 0.06f * 20.0f * sigma * sigma) << sigma;
+    }
+}
+
+TEST(FrameQualityTest, BlurLowersSharpnessAndEdgesBarelyReadAsNoise) {
+    // 8 px checkerboard, then a 3x3 box blur of it
+    Image sharp;
+    for (int32_t y = 0; y < kHeight; ++y) {
+        for (int32_t x = 0; x < kWidth; ++x) {
+            sharp.at(x, y) = ((x / 8 + y / 8) & 1) != 0 ? 200 : 50;
+        }
+    }
+    Image blurred = sharp;
+    for (int32_t y = 1; y < kHeight - 1; ++y) {
+        for (int32_t x = 1; x < kWidth - 1; ++x) {
+            int sum = 0;
+            for (int32_t dy = -1; dy <= 1; ++dy) {
+                for (int32_t dx = -1; dx <= 1; ++dx) {
+                    sum += sharp.at(x + dx, y + dy);
+                }
+            }
+            blurred.at(x, y) = static_cast<uint8_t>((sum + 4) / 9);
+        }
+    }
+    const FrameQuality sharpQuality = measure(sharp);
+    const FrameQuality blurredQuality = measure(blurred);
+    EXPECT_GT(sharpQuality.sharpness, 3.0f * blurredQuality.sharpness);
+    EXPECT_GT(blurredQuality.sharpness, 0.0f);
+    // Straight edges cancel in the noise kernel; only the corners leak
+    EXPECT_LT(sharpQuality.noiseSigma, 0.1f * std::sqrt(sharpQuality.sharpness));
+}
+
+TEST(FrameQualityTest, RowSubsamplingKeepsTheStatistics) {
+    const Image image = noisy(6.0f);
+    const FrameQuality full = measure(image);
+    const FrameQuality sparse = measure(image, 4);
+    EXPECT_NEAR(sparse.meanLuma, full.meanLuma, 0.5f);
+    EXPECT_NEAR(sparse.noiseSigma, full.noiseSigma, 0.05f * full.noiseSigma);
+    EXPECT_NEAR(sparse.sharpness, full.sharpness, 0.1f * full.sharpness);
+
+    // Non-positive steps measure every row
+    const FrameQuality zeroStep = measure(image, 0);
+    EXPECT_FLOAT_EQ(zeroStep.sharpness, full.sharpness);
+}
+
+TEST(FrameQualityTest, FramesBelowThreeByThreeAreZeroed) {
+    const Image image = flat(200);
+    FrameQuality quality;
+    quality.meanLuma = 42.0f;
+    measureFrameQuality(image.data.data(), 2, kHeight, kStride, 1, quality);
+    EXPECT_FLOAT_EQ(quality.meanLuma, 0.0f);
+    measureFrameQuality(image.data.data(), 3, 3, kStride, 1, quality);
+    EXPECT_FLOAT_EQ(quality.meanLuma, 200.0f);
+}
+
+TEST(FrameQualityMonitorTest, KeepsTheNewestMeasuresPerCamera) {
+    FramePool frames(64, 48, 3);
+    FrameQualityMonitor monitor;
+    EXPECT_FALSE(monitor.latest("0").has_value());
+
+    const auto submit = [&](const char* cameraId, uint8_t value, int64_t timestampNs) {
+        FrameRef frame = frames.acquire();
+        ASSERT_TRUE(frame);
+        for (int32_t y = 0; y < frame->height(); ++y) {
+            std::fill_n(frame->row(y), frame->width(), value);
+        }
+        frame->metadata.cameraId = cameraId;
+        frame->metadata.timestampNs = timestampNs;
+        monitor.process(frame);
+    };
+    submit("0", 10, 1'000);
+    submit("1", 240, 2'000);
+    submit("0", 90, 3'000);
+
+    const auto first = monitor.latest("0");
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first->timestampNs, 3'000);
+    EXPECT_FLOAT_EQ(first->meanLuma, 90.0f);
+    const auto second = monitor.latest("1");
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second->timestampNs, 2'000);
+    EXPECT_FLOAT_EQ(second->meanLuma, 240.0f);
+    EXPECT_FALSE(monitor.latest("2").has_value());
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,250 @@
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include "geometry.h"
+#include "small_matrix.h"
+
+// The math types take the SIMD path at runtime and the scalar path in
+// constant evaluation. Each case is computed both ways from the same
+// inputs: once into a constexpr reference, once at runtime.
+namespace nativesensor::testing {
+namespace {
+
+constexpr size_t kCases = 32;
+constexpr float kTolerance = 2e-6f;
+
+constexpr float nextUniform(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return static_cast<float>(state >> 8) * (2.0f / 16777216.0f) - 1.0f;    // [-1, 1)
+}
+
+constexpr Vec3 nextVec3(uint32_t& state, float scale) {
+    const float x = nextUniform(state) * scale;
+    const float y = nextUniform(state) * scale;
+    const float z = nextUniform(state) * scale;
+    return {x, y, z};
+}
+
+struct Inputs {
+    Vec3 a[kCases];
+    Vec3 b[kCases];
+    Quat p[kCases];
+    Quat q[kCases];
+    float s[kCases] = {};
+};
+
+constexpr Inputs makeInputs() {
+    Inputs in;
+    uint32_t state = 12345;
+    for (size_t i = 0; i < kCases; ++i) {
+        in.a[i] = nextVec3(state, 10.0f);
+        in.b[i] = nextVec3(state, 0.5f);
+        const Vec3 pv = nextVec3(state, 1.0f);
+        in.p[i] = {nextUniform(state), pv.x, pv.y, pv.z};
+        const Vec3 qv = nextVec3(state, 1.0f);
+        in.q[i] = {nextUniform(state), qv.x, qv.y, qv.z};
+        in.s[i] = nextUniform(state) * 3.0f;
+    }
+    return in;
+}
+
+struct Results {
+    Vec3 sum[kCases];
+    Vec3 difference[kCases];
+    Vec3 scaled[kCases];
+    Vec3 cross[kCases];
+    Vec3 matVec[kCases];
+    Mat3 matMat[kCases];
+    Quat product[kCases];
+    Vec3 rotated[kCases];
+};
+
+constexpr Mat3 matrixOf(const Inputs& in, size_t i) {
+    return Mat3::fromRows(in.a[i], in.b[i], in.a[(i + 1) % kCases]);
+}
+
+constexpr Results compute(const Inputs& in) {
+    Results out;
+    for (size_t i = 0; i < kCases; ++i) {
+        out.sum[i] = in.a[i] + in.b[i];
+        out.difference[i] = in.a[i] - in.b[i];
+        out.scaled[i] = in.a[i] * in.s[i];
+        out.cross[i] = cross(in.a[i], in.b[i]);
+        out.matVec[i] = matrixOf(in, i) * in.b[i];
+        out.matMat[i] = matrixOf(in, i) * matrixOf(in, (i + 5) % kCases);
+        out.product[i] = in.p[i] * in.q[i];
+        out.rotated[i] = rotate(in.p[i], in.a[i]);
+    }
+    return out;
+}
+
+constexpr Inputs kInputs = makeInputs();
+constexpr Results kScalar = compute(kInputs);
+
+void expectNear(const Vec3& actual, const Vec3& expected, const char* what, size_t i) {
+    const float tolerance = kTolerance * (1.0f + std::fabs(expected.x) + std::fabs(expected.y) + std::fabs(expected.z));
+    EXPECT_NEAR(actual.x, expected.x, tolerance) << what << " case " << i;
+    EXPECT_NEAR(actual.y, expected.y, tolerance) << what << " case " << i;
+    EXPECT_NEAR(actual.z, expected.z, tolerance) << what << " case " << i;
+    EXPECT_EQ(actual.pad, 0.0f) << what << " case " << i << ": pad lane must stay zero";
+}
+
+void expectNear(const Quat& actual, const Quat& expected, const char* what, size_t i) {
+    const float tolerance = kTolerance * (1.0f + std::fabs(expected.w) + norm(expected.vec()));
+    EXPECT_NEAR(actual.w, expected.w, tolerance) << what << " case " << i;
+    EXPECT_NEAR(actual.x, expected.x, tolerance) << what << " case " << i;
+    EXPECT_NEAR(actual.y, expected.y, tolerance) << what << " case " << i;
+    EXPECT_NEAR(actual.z, expected.z, tolerance) << what << " case " << i;
+}
+
+TEST(GeometryTest, SimdMatchesScalarForVec3Mat3AndQuat) {
+    // A runtime copy, so compute() below is not constant-evaluated
+    Inputs inputs = kInputs;
+    const Results simd = compute(inputs);
+    for (size_t i = 0; i < kCases; ++i) {
+        expectNear(simd.sum[i], kScalar.sum[i], "a + b", i);
+        expectNear(simd.difference[i], kScalar.difference[i], "a - b", i);
+        expectNear(simd.scaled[i], kScalar.scaled[i], "a * s", i);
+        expectNear(simd.cross[i], kScalar.cross[i], "cross", i);
+        expectNear(simd.matVec[i], kScalar.matVec[i], "M * v", i);
+        for (size_t c = 0; c < 3; ++c) {
+            expectNear(simd.matMat[i].col[c], kScalar.matMat[i].col[c], "M * N", i);
+        }
+        expectNear(simd.product[i], kScalar.product[i], "p * q", i);
+        expectNear(simd.rotated[i], kScalar.rotated[i], "rotate", i);
+    }
+}
+
+TEST(GeometryTest, QuatProductAgreesWithRotationMatrices) {
+    for (size_t i = 0; i < kCases; ++i) {
+        const Quat p = normalized(kInputs.p[i]);
+        const Quat q = normalized(kInputs.q[i]);
+        const Mat3 composed = toMat3(p) * toMat3(q);
+        const Mat3 product = toMat3(p * q);
+        for (size_t c = 0; c < 3; ++c) {
+            expectNear(product.col[c], composed.col[c], "toMat3(p * q)", i);
+        }
+        expectNear(rotate(p * q, kInputs.a[i]), rotate(p, rotate(q, kInputs.a[i])), "rotate(p * q)", i);
+    }
+}
+
+TEST(GeometryTest, NormalizeMatchesDoublePrecision) {
+    for (size_t i = 0; i < kCases; ++i) {
+        const Vec3& v = kInputs.a[i];
+        const double length = std::sqrt(double{v.x} * v.x + double{v.y} * v.y + double{v.z} * v.z);
+        const Vec3 unit = normalized(v);
+        EXPECT_NEAR(unit.x, v.x / length, 1e-6) << i;
+        EXPECT_NEAR(unit.y, v.y / length, 1e-6) << i;
+        EXPECT_NEAR(unit.z, v.z / length, 1e-6) << i;
+        EXPECT_EQ(unit.pad, 0.0f);
+
+        const Quat& q = kInputs.q[i];
+        const double qLength = std::sqrt(double{q.w} * q.w + double{q.x} * q.x + double{q.y} * q.y +
+                                         double{q.z} * q.z);
+        const Quat unitQ = normalized(q);
+        EXPECT_NEAR(unitQ.w, q.w / qLength, 1e-6) << i;
+        EXPECT_NEAR(unitQ.x, q.x / qLength, 1e-6) << i;
+        EXPECT_NEAR(unitQ.z, q.z / qLength, 1e-6) << i;
+    }
+    EXPECT_EQ(norm(normalized(Vec3{})), 0.0f);
+    EXPECT_EQ(normalized(Quat{0.0f, 0.0f, 0.0f, 0.0f}).w, 1.0f);
+}
+
+TEST(GeometryTest, InversesRoundTrip) {
+    for (size_t i = 0; i < kCases; ++i) {
+        // Unit quaternion inverse is its conjugate
+        const Quat q = normalized(kInputs.q[i]);
+        expectNear(q * conjugate(q), Quat::identity(), "q * q^-1", i);
+        expectNear(rotate(conjugate(q), rotate(q, kInputs.a[i])), kInputs.a[i], "rotate back", i);
+
+        // Rotation matrix inverse is its transpose
+        const Mat3 r = toMat3(q);
+        const Mat3 eye = r * r.transposed();
+        for (size_t c = 0; c < 3; ++c) {
+            expectNear(eye.col[c], Mat3::identity().col[c], "R * R^T", i);
+        }
+
+        // Exponential and logarithmic maps are inverses within pi
+        const Vec3 rotation = kInputs.b[i] * 2.0f;
+        expectNear(quat::toRotationVector(quat::fromRotationVector(rotation)), rotation, "log(exp(r))", i);
+    }
+}
+
+// Dimensions cover whole SIMD groups and the scalar tail (7 = 4 + 3)
+constexpr size_t kN = 15;
+constexpr size_t kTail = 7;
+
+constexpr MatN<kN, kN> makeSpd() {
+    uint32_t state = 777;
+    MatN<kN, kN> a{};
+    for (size_t r = 0; r < kN; ++r) {
+        for (size_t c = 0; c < kN; ++c) {
+            // Mostly sparse like the filter Jacobians, so the zero skip is exercised
+            a.m[r][c] = (r + c) % 3 == 0 ? nextUniform(state) : 0.0f;
+        }
+    }
+    // A A^T + N I is symmetric positive definite
+    MatN<kN, kN> spd = a * a.transposed();
+    for (size_t i = 0; i < kN; ++i) {
+        spd.m[i][i] += static_cast<float>(kN);
+    }
+    return spd;
+}
+
+constexpr MatN<kN, kTail> makeRhs() {
+    uint32_t state = 4242;
+    MatN<kN, kTail> b{};
+    for (size_t r = 0; r < kN; ++r) {
+        for (size_t c = 0; c < kTail; ++c) {
+            b.m[r][c] = nextUniform(state);
+        }
+    }
+    return b;
+}
+
+constexpr MatN<kN, kN> kSpd = makeSpd();
+constexpr MatN<kN, kTail> kRhs = makeRhs();
+constexpr MatN<kN, kTail> kScalarProduct = kSpd * kRhs;
+constexpr MatN<kTail, kTail> kScalarGram = kRhs.transposed() * kRhs;
+
+template<size_t R, size_t C>
+void expectNear(const MatN<R, C>& actual, const MatN<R, C>& expected, float tolerance, const char* what) {
+    for (size_t r = 0; r < R; ++r) {
+        for (size_t c = 0; c < C; ++c) {
+            EXPECT_NEAR(actual.m[r][c], expected.m[r][c], tolerance * (1.0f + std::fabs(expected.m[r][c])))
+                << what << " (" << r << ", " << c << ")";
+        }
+    }
+}
+
+TEST(GeometryTest, MatNProductMatchesScalar) {
+    MatN<kN, kN> spd = kSpd;
+    MatN<kN, kTail> rhs = kRhs;
+    expectNear(spd * rhs, kScalarProduct, 1e-5f, "A * B");
+    expectNear(rhs.transposed() * rhs, kScalarGram, 1e-5f, "B^T * B");
+}
+
+TEST(GeometryTest, SolveSpdInvertsTheMatrix) {
+    MatN<kN, kN> spd = kSpd;
+    MatN<kN, kN> inverse{};
+    ASSERT_TRUE(solveSpd(spd, MatN<kN, kN>::identity(), inverse));
+    expectNear(spd * inverse, MatN<kN, kN>::identity(), 1e-5f, "A * A^-1");
+
+    MatN<kN, kTail> x{};
+    ASSERT_TRUE(solveSpd(spd, kRhs, x));
+    expectNear(spd * x, kRhs, 1e-5f, "A * solve(A, B)");
+
+    // Not positive definite: rejected, output untouched
+    MatN<kN, kN> indefinite = spd;
+    indefinite.m[3][3] = -1.0f;
+    MatN<kN, kTail> untouched{};
+    EXPECT_FALSE(solveSpd(indefinite, kRhs, untouched));
+    EXPECT_EQ(untouched.m[0][0], 0.0f);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
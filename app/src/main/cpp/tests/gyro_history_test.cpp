@@ -0,0 +1,157 @@
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "geometry.h"
+#include "gyro_history.h"
+#include "time_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr int64_t kPeriodNs = 2'500'000;     // 400 Hz
+constexpr TimestampNs kStartNs = kNsPerSecond;
+
+ImuSample gyro(TimestampNs timestampNs, const Vec3& rate) {
+    return {rate.x, rate.y, rate.z, timestampNs, SensorType::Gyroscope};
+}
+
+float seconds(int64_t ns) {
+    return static_cast<float>(ns) * 1e-9f;
+}
+
+TEST(GyroHistoryTest, EmptyHistoryCoversNothing) {
+    GyroHistory history;
+    EXPECT_EQ(history.latestTimestampNs(), 0);
+    EXPECT_FALSE(history.integrate(0, kStartNs).has_value());
+
+    // Accelerometer samples are not gyro history
+    history.addSample({1.0f, 0.0f, 0.0f, kStartNs, SensorType::Accelerometer});
+    EXPECT_EQ(history.latestTimestampNs(), 0);
+}
+
+TEST(GyroHistoryTest, IntegratesAConstantRate) {
+    GyroHistory history;
+    const Vec3 rate{0.5f, -1.0f, 2.0f};
+    for (int i = 0; i <= 40; ++i) {
+        history.addSample(gyro(kStartNs + i * kPeriodNs, rate));
+    }
+    EXPECT_EQ(history.latestTimestampNs(), kStartNs + 40 * kPeriodNs);
+
+    // Window boundaries between samples
+    const TimestampNs beginNs = kStartNs + 3 * kPeriodNs + 700'000;
+    const TimestampNs endNs = kStartNs + 20 * kPeriodNs + 1'100'000;
+    const auto rotation = history.integrate(beginNs, endNs);
+    ASSERT_TRUE(rotation.has_value());
+    EXPECT_LT(norm(*rotation - rate * seconds(endNs - beginNs)), 1e-5f);
+
+    const auto empty = history.integrate(beginNs, beginNs);
+    ASSERT_TRUE(empty.has_value());
+    EXPECT_LT(norm(*empty), 1e-9f);
+    EXPECT_FALSE(history.integrate(endNs, beginNs).has_value());
+}
+
+TEST(GyroHistoryTest, TrapezoidsAreExactForALinearRamp) {
+    GyroHistory history;
+    // rate(t) = a t: rotation over [t0, t1] is a (t1^2 - t0^2) / 2
+    const Vec3 a{0.0f, 0.0f, 8.0f};
+    for (int i = 0; i <= 80; ++i) {
+        history.addSample(gyro(kStartNs + i * kPeriodNs, a * seconds(i * kPeriodNs)));
+    }
+    const int64_t t0 = 5 * kPeriodNs + 1'234'567;
+    const int64_t t1 = 61 * kPeriodNs + 321'000;
+    const auto rotation = history.integrate(kStartNs + t0, kStartNs + t1);
+    ASSERT_TRUE(rotation.has_value());
+    const float expected = 0.5f * a.z * (seconds(t1) * seconds(t1) - seconds(t0) * seconds(t0));
+    EXPECT_NEAR(rotation->z, expected, 1e-5f);
+}
+
+TEST(GyroHistoryTest, HoldsTheNewestRateOnlyBriefly) {
+    GyroHistory history;
+    const Vec3 rate{1.0f, 0.0f, 0.0f};
+    for (int i = 0; i <= 10; ++i) {
+        history.addSample(gyro(kStartNs + i * kPeriodNs, rate));
+    }
+    const TimestampNs lastNs = kStartNs + 10 * kPeriodNs;
+
+    // A frame ending just after the newest sample is still covered
+    const auto held = history.integrate(lastNs - kPeriodNs, lastNs + GyroHistory::kMaxHoldNs);
+    ASSERT_TRUE(held.has_value());
+    EXPECT_NEAR(held->x, seconds(kPeriodNs + GyroHistory::kMaxHoldNs), 1e-5f);
+
+    // Gyro stopped (or lags) further than that
+    EXPECT_FALSE(history.integrate(lastNs - kPeriodNs, lastNs + GyroHistory::kMaxHoldNs + 1).has_value());
+    // Window starts before the first sample
+    EXPECT_FALSE(history.integrate(kStartNs - 1, lastNs).has_value());
+}
+
+TEST(GyroHistoryTest, OverwrittenSamplesAreNoLongerCovered) {
+    GyroHistory history;
+    const auto total = static_cast<int64_t>(GyroHistory::kCapacity) + 100;
+    for (int64_t i = 0; i < total; ++i) {
+        history.addSample(gyro(kStartNs + i * kPeriodNs, {0.0f, 1.0f, 0.0f}));
+    }
+    // The oldest slot is the one the writer fills next, so it never counts
+    const TimestampNs lastNs = kStartNs + (total - 1) * kPeriodNs;
+    const TimestampNs oldestNs = lastNs - static_cast<int64_t>(GyroHistory::kCapacity - 2) * kPeriodNs;
+    EXPECT_TRUE(history.integrate(oldestNs, lastNs).has_value());
+    EXPECT_FALSE(history.integrate(oldestNs - 1, lastNs).has_value());
+}
+
+TEST(GyroHistoryTest, WindowCopiesTheSpanningSamplesOldestFirst) {
+    GyroHistory history;
+    for (int i = 0; i <= 20; ++i) {
+        history.addSample(gyro(kStartNs + i * kPeriodNs, {static_cast<float>(i), 0.0f, 0.0f}));
+    }
+    std::vector<GyroReading> readings{{0, {}}};
+    // From the last sample at or before the start through the newest one
+    ASSERT_TRUE(history.window(kStartNs + 4 * kPeriodNs + 1, kStartNs + 9 * kPeriodNs, readings));
+    ASSERT_EQ(readings.size(), 17u);
+    EXPECT_EQ(readings.front().timestampNs, kStartNs + 4 * kPeriodNs);
+    EXPECT_FLOAT_EQ(readings.front().rate.x, 4.0f);
+    EXPECT_EQ(readings.back().timestampNs, kStartNs + 20 * kPeriodNs);
+    for (size_t i = 1; i < readings.size(); ++i) {
+        EXPECT_GT(readings[i].timestampNs, readings[i - 1].timestampNs);
+    }
+
+    EXPECT_FALSE(history.window(kStartNs - 1, kStartNs + 9 * kPeriodNs, readings));
+    EXPECT_TRUE(readings.empty());
+}
+
+TEST(GyroHistoryTest, ReadersRacingTheWriterSeeConsistentRotations) {
+    GyroHistory history;
+    const Vec3 rate{0.0f, 0.0f, 3.0f};
+    std::atomic<bool> stop{false};
+    std::atomic<TimestampNs> publishedNs{0};
+    std::thread writer([&] {
+        for (int64_t i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+            history.addSample(gyro(kStartNs + i * kPeriodNs, rate));
+            publishedNs.store(kStartNs + i * kPeriodNs, std::memory_order_release);
+        }
+    });
+
+    // Every window either fails coverage or integrates the constant rate
+    int checked = 0;
+    for (int attempt = 0; attempt < 200'000 && checked < 2'000; ++attempt) {
+        const TimestampNs endNs = publishedNs.load(std::memory_order_acquire);
+        if (endNs < kStartNs + 10 * kPeriodNs) {
+            std::this_thread::yield();
+            continue;
+        }
+        const TimestampNs beginNs = endNs - 8 * kPeriodNs - 300'000;
+        if (const auto rotation = history.integrate(beginNs, endNs)) {
+            EXPECT_NEAR(rotation->z, rate.z * seconds(endNs - beginNs), 1e-4f);
+            ++checked;
+        }
+    }
+    stop = true;
+    writer.join();
+    EXPECT_GT(checked, 0);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
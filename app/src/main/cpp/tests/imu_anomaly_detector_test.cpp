@@ -0,0 +1,347 @@
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "imu_anomaly_detector.h"
+#include "imu_data.h"
+#include "time_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr int64_t kPeriodNs = 2'500'000;        // 400 Hz accel and gyro
+constexpr float kGravity = 9.81f;
+
+/// Synthetic IMU trace fed straight into a detector: both sensors at 400 Hz
+/// with a little deterministic noise, so a device at rest never repeats a
+/// sample bit for bit
+class ImuAnomalyDetectorTest : public ::testing::Test {
+protected:
+    explicit ImuAnomalyDetectorTest(const ImuAnomalyConfig& config = {}) : detector_(config) {}
+
+    float jitter(int salt) {
+        uint32_t h = static_cast<uint32_t>(step_) * 2654435761u ^ static_cast<uint32_t>(salt) * 40503u;
+        h ^= h >> 15;
+        h *= 2246822519u;
+        h ^= h >> 13;
+        return static_cast<float>(h & 0xFFFF) / 65535.0f * 0.04f - 0.02f;
+    }
+
+    void accel(float x, float y, float z) {
+        detector_.process({x, y, z, nowNs_, SensorType::Accelerometer});
+    }
+
+    void gyro(float x, float y, float z) {
+        detector_.process({x, y, z, nowNs_ + 1'000, SensorType::Gyroscope});
+    }
+
+    /// One period with the given accel and a gyro at rest
+    void stepAccel(float x, float y, float z) {
+        accel(x, y, z);
+        gyro(jitter(3), jitter(4), jitter(5));
+        advance();
+    }
+
+    /// One period with the given gyro and an accel at rest
+    void stepGyro(float x, float y, float z) {
+        accel(jitter(0), jitter(1), kGravity + jitter(2));
+        gyro(x, y, z);
+        advance();
+    }
+
+    void rest(int periods) {
+        for (int i = 0; i < periods; ++i) {
+            stepAccel(jitter(0), jitter(1), kGravity + jitter(2));
+        }
+    }
+
+    void advance(int64_t ns = kPeriodNs) {
+        nowNs_ += ns;
+        ++step_;
+    }
+
+    std::vector<ImuAnomaly> drain() {
+        std::vector<ImuAnomaly> events;
+        ImuAnomaly event;
+        while (detector_.poll(event)) {
+            events.push_back(event);
+        }
+        return events;
+    }
+
+    ImuAnomalyDetector detector_;
+    TimestampNs nowNs_ = kNsPerSecond;
+    int64_t step_ = 0;
+};
+
+TEST_F(ImuAnomalyDetectorTest, DeviceAtRestRaisesNothing) {
+    rest(4000);
+    EXPECT_TRUE(drain().empty());
+    EXPECT_EQ(detector_.droppedEvents(), 0);
+}
+
+TEST_F(ImuAnomalyDetectorTest, ShockIsReportedOnceWithItsPeak) {
+    rest(100);
+    const TimestampNs impactNs = nowNs_;
+    stepAccel(30.0f, 2.0f, 35.0f);
+    stepAccel(55.0f, -3.0f, 40.0f);
+    stepAccel(20.0f, 1.0f, 38.0f);
+    rest(2);
+
+    const std::vector<ImuAnomaly> events = drain();
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].type, ImuAnomalyType::Shock);
+    EXPECT_EQ(events[0].sensor, SensorType::Accelerometer);
+    EXPECT_EQ(events[0].timestampNs, impactNs);
+    EXPECT_EQ(events[0].durationNs, 3 * kPeriodNs);
+    EXPECT_NEAR(events[0].value, std::sqrt(55.0f * 55.0f + 9.0f + 40.0f * 40.0f), 1e-3f);
+    EXPECT_EQ(detector_.count(ImuAnomalyType::Shock), 1);
+}
+
+TEST_F(ImuAnomalyDetectorTest, ReboundsWithinTheHoldoffBelongToTheFirstImpact) {
+    rest(100);
+    stepAccel(60.0f, 0.0f, 0.0f);
+    // Rings 50 ms apart: each starts within 200 ms of the previous end
+    for (int ring = 0; ring < 6; ++ring) {
+        rest(19);
+        stepAccel(0.0f, 45.0f, 0.0f);
+    }
+    rest(1);
+    EXPECT_EQ(detector_.count(ImuAnomalyType::Shock), 1);
+
+    // A second impact once the holdoff passed
+    rest(80);
+    stepAccel(0.0f, 0.0f, 50.0f);
+    rest(1);
+    EXPECT_EQ(detector_.count(ImuAnomalyType::Shock), 2);
+}
+
+TEST_F(ImuAnomalyDetectorTest, FreeFallIsReportedOnceItLastedLongEnough) {
+    rest(100);
+    const TimestampNs dropNs = nowNs_;
+    // 150 ms of near weightlessness, deepest at 0.1 m/s^2
+    for (int i = 0; i < 60; ++i) {
+        stepAccel(i == 30 ? 0.1f : 0.5f, 0.3f, 0.2f);
+        if (i == 30) {
+            EXPECT_EQ(detector_.count(ImuAnomalyType::FreeFall), 0);
+        }
+    }
+    rest(10);
+
+    const std::vector<ImuAnomaly> events = drain();
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].type, ImuAnomalyType::FreeFall);
+    EXPECT_EQ(events[0].timestampNs, dropNs);
+    EXPECT_EQ(events[0].durationNs, ImuAnomalyConfig{}.freeFallMinNs);
+    EXPECT_NEAR(events[0].value, std::sqrt(0.01f + 0.09f + 0.04f), 1e-4f);
+
+    // A short dip (a toss of the hand) is not a fall
+    for (int i = 0; i < 20; ++i) {
+        stepAccel(0.5f, 0.3f, 0.2f);
+    }
+    rest(10);
+    EXPECT_EQ(detector_.count(ImuAnomalyType::FreeFall), 1);
+}
+
+TEST_F(ImuAnomalyDetectorTest, OtherSensorTypesAreIgnored) {
+    for (int i = 0; i < 200; ++i) {
+        detector_.process({80.0f, 80.0f, 80.0f, nowNs_, SensorType::AccelerometerUncalibrated});
+        advance(i == 100 ? kNsPerSecond : kPeriodNs);
+    }
+    EXPECT_TRUE(drain().empty());
+}
+
+class ImuSaturationTest : public ImuAnomalyDetectorTest {
+protected:
+    static ImuAnomalyConfig withRange() {
+        ImuAnomalyConfig config;
+        config.accelRangeMs2 = 78.4f;   // 8 g
+        config.gyroRangeRadS = 34.9f;   // 2000 dps
+        return config;
+    }
+
+    ImuSaturationTest() : ImuAnomalyDetectorTest(withRange()) {}
+};
+
+TEST_F(ImuSaturationTest, SamplesAtFullScaleAreOneSaturationEpisode) {
+    rest(100);
+    const TimestampNs clipNs = nowNs_;
+    stepAccel(78.1f, 5.0f, 20.0f);
+    stepAccel(78.4f, 6.0f, 25.0f);
+    stepAccel(-78.3f, 4.0f, 22.0f);
+    rest(2);
+
+    const std::vector<ImuAnomaly> events = drain();
+    ASSERT_EQ(events.size(), 2u);
+    // Saturation ends on the first sample back in range, before the shock does
+    EXPECT_EQ(events[0].type, ImuAnomalyType::Saturation);
+    EXPECT_EQ(events[0].sensor, SensorType::Accelerometer);
+    EXPECT_EQ(events[0].timestampNs, clipNs);
+    EXPECT_EQ(events[0].durationNs, 3 * kPeriodNs);
+    EXPECT_FLOAT_EQ(events[0].value, 78.4f);
+    EXPECT_EQ(events[1].type, ImuAnomalyType::Shock);
+
+    // Gyro at its full scale on one axis
+    stepGyro(0.1f, -34.8f, 0.2f);
+    stepGyro(0.1f, 0.1f, 0.1f);
+    const std::vector<ImuAnomaly> gyroEvents = drain();
+    ASSERT_EQ(gyroEvents.size(), 1u);
+    EXPECT_EQ(gyroEvents[0].type, ImuAnomalyType::Saturation);
+    EXPECT_EQ(gyroEvents[0].sensor, SensorType::Gyroscope);
+    EXPECT_FLOAT_EQ(gyroEvents[0].value, 34.8f);
+}
+
+TEST_F(ImuAnomalyDetectorTest, FlatTopsAtAPeakCountAsClippedWithoutAKnownRange) {
+    rest(100);
+    // A spin pinned at one value on z: clipped from the third equal sample
+    stepGyro(0.3f, 0.2f, 9.5f);
+    const TimestampNs flatNs = nowNs_ + 2 * kPeriodNs;
+    for (int i = 0; i < 4; ++i) {
+        stepGyro(0.3f + 0.01f * static_cast<float>(i), 0.2f, 12.0f);
+    }
+    stepGyro(0.1f, 0.1f, 6.0f);
+
+    const std::vector<ImuAnomaly> events = drain();
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].type, ImuAnomalyType::Saturation);
+    EXPECT_EQ(events[0].sensor, SensorType::Gyroscope);
+    EXPECT_EQ(events[0].timestampNs, flatNs + 1'000);
+    EXPECT_EQ(events[0].durationNs, 2 * kPeriodNs);
+    EXPECT_FLOAT_EQ(events[0].value, 12.0f);
+
+    // Equal values below the flat-top floor are just a steady rate, and one
+    // sample at a peak is not a flat top
+    for (int i = 0; i < 5; ++i) {
+        stepGyro(jitter(3), 2.0f, jitter(5));
+    }
+    stepAccel(70.0f, 0.0f, 0.0f);
+    rest(2);
+    for (const ImuAnomaly& event : drain()) {
+        EXPECT_NE(event.type, ImuAnomalyType::Saturation);
+    }
+    EXPECT_EQ(detector_.count(ImuAnomalyType::Saturation), 1);
+}
+
+TEST_F(ImuAnomalyDetectorTest, StuckSensorIsReportedOncePerRun) {
+    rest(100);
+    const TimestampNs stuckNs = nowNs_;
+    for (int i = 0; i < 150; ++i) {
+        stepGyro(0.0125f, -0.002f, 0.004f);
+    }
+    std::vector<ImuAnomaly> events = drain();
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].type, ImuAnomalyType::StuckAt);
+    EXPECT_EQ(events[0].sensor, SensorType::Gyroscope);
+    EXPECT_FLOAT_EQ(events[0].value, 0.0125f);
+    // Reported on the 100th equal sample, dated back by the nominal period
+    EXPECT_NEAR(static_cast<double>(events[0].durationNs), 99.0 * kPeriodNs, 1'000.0);
+    EXPECT_NEAR(static_cast<double>(events[0].timestampNs), static_cast<double>(stuckNs + 1'000), 1'000.0);
+
+    // A new run after a change is a new event
+    stepGyro(0.01f, 0.01f, 0.01f);
+    for (int i = 0; i < 100; ++i) {
+        stepGyro(0.0f, 0.0f, 0.0f);
+    }
+    events = drain();
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_FLOAT_EQ(events[0].value, 0.0f);
+    EXPECT_EQ(detector_.count(ImuAnomalyType::StuckAt), 2);
+}
+
+TEST_F(ImuAnomalyDetectorTest, GapsFarAboveTheNominalPeriodAreDropouts) {
+    // Gaps while the period is being learned don't count
+    rest(5);
+    advance(100'000'000);
+    rest(100);
+    EXPECT_TRUE(drain().empty());
+
+    // 4 periods: below the 20 ms floor
+    advance(4 * kPeriodNs);
+    rest(10);
+    EXPECT_TRUE(drain().empty());
+
+    const TimestampNs lastNs = nowNs_ - kPeriodNs;
+    advance(40'000'000);
+    rest(10);
+    const std::vector<ImuAnomaly> events = drain();
+    ASSERT_EQ(events.size(), 2u);
+    for (const ImuAnomaly& event : events) {
+        EXPECT_EQ(event.type, ImuAnomalyType::Dropout);
+        EXPECT_EQ(event.durationNs, kPeriodNs + 40'000'000);
+        EXPECT_FLOAT_EQ(event.value, 42.5f);
+    }
+    EXPECT_EQ(events[0].sensor, SensorType::Accelerometer);
+    EXPECT_EQ(events[0].timestampNs, lastNs);
+    EXPECT_EQ(events[1].sensor, SensorType::Gyroscope);
+    EXPECT_EQ(events[1].timestampNs, lastNs + 1'000);
+}
+
+TEST_F(ImuAnomalyDetectorTest, ResetForgetsTheStreamButKeepsCounters) {
+    rest(100);
+    stepAccel(60.0f, 0.0f, 0.0f);
+    rest(1);
+    ASSERT_EQ(detector_.count(ImuAnomalyType::Shock), 1);
+
+    // A restarted sensor: the gap is not a dropout, the next impact is not a rebound
+    detector_.reset();
+    advance(kNsPerSecond / 20);
+    rest(1);
+    stepAccel(60.0f, 0.0f, 0.0f);
+    rest(1);
+    EXPECT_EQ(detector_.count(ImuAnomalyType::Dropout), 0);
+    EXPECT_EQ(detector_.count(ImuAnomalyType::Shock), 2);
+}
+
+TEST_F(ImuAnomalyDetectorTest, ConfigChangesApplyToTheNextSample) {
+    rest(100);
+    stepAccel(25.0f, 0.0f, 0.0f);
+    rest(1);
+    EXPECT_EQ(detector_.count(ImuAnomalyType::Shock), 0);
+
+    ImuAnomalyConfig config = detector_.config();
+    config.shockThresholdMs2 = 20.0f;
+    detector_.setConfig(config);
+    EXPECT_FLOAT_EQ(detector_.config().shockThresholdMs2, 20.0f);
+    stepAccel(25.0f, 0.0f, 0.0f);
+    rest(1);
+    EXPECT_EQ(detector_.count(ImuAnomalyType::Shock), 1);
+}
+
+TEST_F(ImuAnomalyDetectorTest, ConcurrentConfigUpdatesKeepEachOthersFields) {
+    constexpr int kUpdates = 2000;
+    std::thread shock([this] {
+        for (int i = 1; i <= kUpdates; ++i) {
+            detector_.updateConfig([i](ImuAnomalyConfig& config) { config.shockThresholdMs2 = static_cast<float>(i); });
+        }
+    });
+    for (int i = 1; i <= kUpdates; ++i) {
+        detector_.updateConfig([i](ImuAnomalyConfig& config) { config.gyroRangeRadS = static_cast<float>(i); });
+    }
+    shock.join();
+    EXPECT_FLOAT_EQ(detector_.config().shockThresholdMs2, static_cast<float>(kUpdates));
+    EXPECT_FLOAT_EQ(detector_.config().gyroRangeRadS, static_cast<float>(kUpdates));
+}
+
+TEST_F(ImuAnomalyDetectorTest, CallbackSeesEveryEventWhenTheQueueOverflows) {
+    int64_t delivered = 0;
+    detector_.setEventCallback([&delivered](const ImuAnomaly& event) {
+        delivered += event.type == ImuAnomalyType::Dropout ? 1 : 0;
+    });
+    rest(100);
+    // A gyro that only reports every 40 ms from now on
+    constexpr int kGaps = 300;
+    for (int i = 0; i < kGaps; ++i) {
+        advance(40'000'000);
+        gyro(jitter(3), jitter(4), jitter(5));
+    }
+    EXPECT_EQ(delivered, kGaps);
+    EXPECT_EQ(detector_.count(ImuAnomalyType::Dropout), kGaps);
+    EXPECT_EQ(static_cast<int64_t>(drain().size()), static_cast<int64_t>(ImuAnomalyDetector::kQueueCapacity));
+    EXPECT_EQ(detector_.droppedEvents(), kGaps - static_cast<int64_t>(ImuAnomalyDetector::kQueueCapacity));
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,156 @@
+#include <android/sensor.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "imu_manager.h"
+#include "mailbox_registry.h"
+#include "test_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+class ImuManagerTest : public SyntheticBackendTest {
+protected:
+    /// Handle of the first enumerated sensor of `type`, -1 if none
+    int32_t handleOf(ImuManager& manager, SensorType type) {
+        for (const auto& sensor : manager.enumerateSensors(true)) {
+            if (sensor.type == type) {
+                return sensor.handle;
+            }
+        }
+        return -1;
+    }
+
+    MailboxRegistry mailboxes_;
+};
+
+TEST_F(ImuManagerTest, DeliversBothStreamsAtTheSensorRate) {
+    ImuManager manager(mailboxes_);
+    ASSERT_TRUE(manager.isValid());
+
+    std::atomic<int> accel{0};
+    std::atomic<int> gyro{0};
+    manager.start([&](const ImuSample& sample) {
+        (sample.sensorType == SensorType::Accelerometer ? accel : gyro).fetch_add(1, std::memory_order_relaxed);
+    });
+    ASSERT_TRUE(waitUntil([&] { return accel.load() > 0 && gyro.load() > 0; }));
+    (void)manager.getStats();
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    const ImuStats stats = manager.getStats();
+    manager.stop();
+
+    // 2500 us min delay = 400 Hz; events are timestamped on that grid
+    EXPECT_NEAR(stats.accelFrequencyHz, 400.0f, 80.0f);
+    EXPECT_NEAR(stats.gyroFrequencyHz, 400.0f, 80.0f);
+    EXPECT_GE(stats.accelLatencyMs, 0.0f);
+    EXPECT_LT(stats.accelLatencyMs, 50.0f);
+
+    const ImuSample latest = manager.getLatestAccel();
+    EXPECT_NEAR(latest.z, 9.81f, 0.02f);
+    EXPECT_GT(latest.timestampNs, 0);
+    EXPECT_GT(manager.getFirstSampleTimeNs(), 0);
+
+    const ImuSensorMetadata metadata = manager.getMetadata();
+    EXPECT_EQ(metadata.accelMinDelayUs, 2500);
+    EXPECT_EQ(metadata.accelFifoReserved, 3000);
+    EXPECT_EQ(liveHandles().sensorQueues, 0);
+}
+
+TEST_F(ImuManagerTest, InjectedEventsReachCallbackAndMailbox) {
+    ImuManager manager(mailboxes_);
+    std::mutex mutex;
+    std::vector<ImuSample> injected;
+    std::atomic<int> samples{0};
+    manager.start([&](const ImuSample& sample) {
+        samples.fetch_add(1, std::memory_order_relaxed);
+        if (sample.x > 100.0f) {
+            std::lock_guard<std::mutex> lock(mutex);
+            injected.push_back(sample);
+        }
+    });
+    // Both sensors are registered once generated events of each arrive
+    ASSERT_TRUE(waitUntil([&] {
+        return manager.getLatestAccel().timestampNs > 0 && manager.getLatestGyro().timestampNs > 0;
+    }));
+    setSensorGeneration(false);
+
+    injectSensorEvent(ASENSOR_TYPE_ACCELEROMETER, 101.0f, 2.0f, 3.0f);
+    injectSensorEvent(ASENSOR_TYPE_GYROSCOPE, 201.0f, 5.0f, 6.0f);
+    ASSERT_TRUE(waitUntil([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return injected.size() == 2;
+    }));
+    manager.stop();
+
+    EXPECT_EQ(injected[0].sensorType, SensorType::Accelerometer);
+    EXPECT_FLOAT_EQ(injected[0].y, 2.0f);
+    EXPECT_EQ(injected[1].sensorType, SensorType::Gyroscope);
+    EXPECT_FLOAT_EQ(injected[1].z, 6.0f);
+    EXPECT_FLOAT_EQ(manager.getLatestGyro().x, 201.0f);
+
+    // The mailboxes carry the same sample for readers without a callback
+    std::vector<float> flattened;
+    ASSERT_TRUE(mailboxes_.readFloats(streams::kAccel, flattened));
+    ASSERT_EQ(flattened.size(), 4u);
+    EXPECT_FLOAT_EQ(flattened[0], 101.0f);
+}
+
+TEST_F(ImuManagerTest, EnumerationListsImuSensorsAndIsCached) {
+    ImuManager manager(mailboxes_);
+    const auto sensors = manager.enumerateSensors();
+    ASSERT_EQ(sensors.size(), 4u);  // The magnetometer is filtered out
+    for (const auto& sensor : sensors) {
+        EXPECT_NE(sensor.type, static_cast<SensorType>(ASENSOR_TYPE_MAGNETIC_FIELD));
+        EXPECT_GT(sensor.maxFrequencyHz, 0.0f);
+    }
+    EXPECT_FLOAT_EQ(sensors[0].maxFrequencyHz, 400.0f);
+
+    auto fewer = defaultSensors();
+    fewer.resize(1);
+    setSensors(fewer);
+    EXPECT_EQ(manager.enumerateSensors().size(), 4u);
+    EXPECT_EQ(manager.enumerateSensors(true).size(), 1u);
+}
+
+TEST_F(ImuManagerTest, SwitchSensorsRestartsOnTheSelectedHandles) {
+    ImuManager manager(mailboxes_);
+    const int32_t accelUncalibrated = handleOf(manager, SensorType::AccelerometerUncalibrated);
+    const int32_t gyroUncalibrated = handleOf(manager, SensorType::GyroscopeUncalibrated);
+    ASSERT_GE(accelUncalibrated, 0);
+    ASSERT_GE(gyroUncalibrated, 0);
+
+    std::atomic<int> samples{0};
+    manager.start([&samples](const ImuSample&) { samples.fetch_add(1, std::memory_order_relaxed); });
+    ASSERT_TRUE(waitUntil([&samples] { return samples.load() > 0; }));
+
+    manager.switchSensors(accelUncalibrated, gyroUncalibrated);
+    EXPECT_TRUE(manager.isRunning());
+    ASSERT_TRUE(waitUntil([&manager] { return manager.getMetadata().gyroMinDelayUs == 5000; }));
+    (void)manager.getStats();
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    const ImuStats stats = manager.getStats();
+    manager.stop();
+
+    EXPECT_NEAR(stats.accelFrequencyHz, 200.0f, 40.0f);
+    EXPECT_NEAR(stats.gyroFrequencyHz, 200.0f, 40.0f);
+}
+
+// stop() right after start() races the sensor thread setting up its looper
+TEST_F(ImuManagerTest, ImmediateStopNeverHangsOrLeaks) {
+    ImuManager manager(mailboxes_);
+    for (int i = 0; i < 50; ++i) {
+        manager.start([](const ImuSample&) {});
+        manager.stop();
+        EXPECT_FALSE(manager.isRunning());
+    }
+    EXPECT_EQ(liveHandles().sensorQueues, 0);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
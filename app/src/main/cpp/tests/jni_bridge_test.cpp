@@ -0,0 +1,261 @@
+#include <jni.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "capability_cache.h"
+#include "mailbox_registry.h"
+#include "test_utils.h"
+
+// JNI exports of libnativesensor, as the Kotlin bridges bind them
+extern "C" {
+jint JNI_OnLoad(JavaVM* vm, void* reserved);
+void JNI_OnUnload(JavaVM* vm, void* reserved);
+void Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativePrepare(JNIEnv*, jobject, jstring,
+                                                                                   jboolean);
+void Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeInit(JNIEnv*, jobject);
+void Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeStop(JNIEnv*, jobject);
+jboolean Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeIsRunning(JNIEnv*, jobject);
+jfloatArray Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetAccelData(JNIEnv*, jobject);
+jfloatArray Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetStats(JNIEnv*, jobject);
+jintArray Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetMetadata(JNIEnv*, jobject);
+jstring Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeEnumerateSensors(JNIEnv*, jobject);
+jstring Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetStartupTimings(JNIEnv*, jobject);
+jstring Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetPipelineStats(JNIEnv*, jobject);
+jstring Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeListStreams(JNIEnv*, jobject);
+jfloatArray Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeReadStream(JNIEnv*, jobject, jint);
+jstring Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeEnumerateCameras(JNIEnv*, jobject);
+jboolean Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeStartPreview(JNIEnv*, jobject, jstring,
+                                                                                     jobject);
+void Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeStopCameraPreview(JNIEnv*, jobject, jstring);
+jboolean Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeIsCameraStreaming(JNIEnv*, jobject, jstring);
+jfloatArray Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetCameraStatsById(JNIEnv*, jobject,
+                                                                                              jstring);
+jint Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetActiveStreamCount(JNIEnv*, jobject);
+jstring Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetCurrentCameraId(JNIEnv*, jobject);
+jfloatArray Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetCameraCalibration(JNIEnv*, jobject,
+                                                                                               jstring);
+}
+
+namespace nativesensor::testing {
+namespace {
+
+std::vector<std::string> lines(const std::string& text) {
+    std::vector<std::string> result;
+    std::istringstream stream(text);
+    for (std::string line; std::getline(stream, line);) {
+        result.push_back(line);
+    }
+    return result;
+}
+
+std::vector<std::string> fields(const std::string& line) {
+    std::vector<std::string> result;
+    std::istringstream stream(line);
+    for (std::string field; std::getline(stream, field, '|');) {
+        result.push_back(field);
+    }
+    return result;
+}
+
+/// The library keeps process-wide state, so the whole suite shares one
+/// startup and ends with JNI_OnUnload, which must leave nothing behind
+class JniBridgeTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        resetSyntheticBackends();
+        // System.loadLibrary() runs JNI_OnLoad on an attached thread
+        JNIEnv* env = nullptr;
+        ASSERT_EQ(javaVm()->AttachCurrentThread(&env, nullptr), JNI_OK);
+        ASSERT_EQ(JNI_OnLoad(javaVm(), nullptr), JNI_VERSION_1_6);
+    }
+
+    static void TearDownTestSuite() {
+        JNI_OnUnload(javaVm(), nullptr);
+        javaVm()->DetachCurrentThread();
+        EXPECT_EQ(liveHandles().total(), 0) << liveHandles().toString();
+    }
+
+    FakeJniEnv env_;
+};
+
+/// Prepares with a valid cache for this device that lists nothing, e.g. one
+/// written before the sensors came up: enumeration finds nothing new in it,
+/// yet the refresh must still run and replace it
+void prepareRewritesStaleCapabilityCache(FakeJniEnv& env) {
+    TempDir cacheDir;
+    ASSERT_FALSE(cacheDir.path().empty());
+    const std::string path = cacheDir.path() + "/capabilities.bin";
+    ASSERT_TRUE(CapabilityCache(path, CapabilityCache::deviceFingerprint()).store({}, {}));
+
+    Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativePrepare(
+        &env, nullptr, env.string(cacheDir.path()), JNI_TRUE);
+
+    std::vector<std::string> timings;
+    auto readyOf = [&timings](const std::string& name) {
+        for (const auto& line : timings) {
+            const auto timing = fields(line);
+            if (timing.size() == 4 && timing[0] == name) {
+                return timing[3];
+            }
+        }
+        return std::string();
+    };
+    ASSERT_TRUE(waitUntil([&env, &timings, &readyOf] {
+        timings = lines(FakeJniEnv::text(
+            Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetStartupTimings(&env, nullptr)));
+        return readyOf("capabilityRefresh") == "1";
+    }));
+    EXPECT_EQ(readyOf("capabilityCache"), "1");
+    EXPECT_EQ(readyOf("sensorEnum"), "1");
+    EXPECT_EQ(readyOf("cameraEnum"), "1");
+
+    CapabilityCache refreshed(path, CapabilityCache::deviceFingerprint());
+    ASSERT_TRUE(refreshed.load());
+    EXPECT_EQ(refreshed.sensors().size(), 4u);
+    EXPECT_EQ(refreshed.cameras().size(), 4u);
+}
+
+// Startup is launched once per process, with the cache directory of the
+// first entry point to run, so the test runs in a freshly executed process
+TEST_F(JniBridgeTest, PrepareRewritesStaleCapabilityCache) {
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    EXPECT_EXIT(
+        {
+            prepareRewritesStaleCapabilityCache(env_);
+            // Skip static destructors: startup workers are still running
+            std::fflush(nullptr);
+            std::_Exit(HasFailure() ? 1 : 0);
+        },
+        ::testing::ExitedWithCode(0), "");
+}
+
+TEST_F(JniBridgeTest, EnumerateSensorsFormat) {
+    // handle|type|name|vendor|minDelayUs|maxFrequencyHz|fifoReserved
+    const auto sensors = lines(FakeJniEnv::text(
+        Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeEnumerateSensors(&env_, nullptr)));
+    ASSERT_EQ(sensors.size(), 4u);
+    EXPECT_EQ(fields(sensors[0]),
+              (std::vector<std::string>{"0", "1", "Synthetic Accelerometer", "Synthetic", "2500", "400", "3000"}));
+    EXPECT_EQ(fields(sensors[1])[1], "4");
+}
+
+TEST_F(JniBridgeTest, EnumerateCamerasFormat) {
+    // id|facing|cluster|width|height|maxFps|isPhysical|physicalIds
+    const auto cameras = lines(FakeJniEnv::text(
+        Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeEnumerateCameras(&env_, nullptr)));
+    ASSERT_EQ(cameras.size(), 4u);
+    EXPECT_EQ(cameras[0], "0|1|1|2048|1536|30|1|");
+    EXPECT_EQ(cameras[1], "1|0|2|640|480|60|1|");
+    EXPECT_EQ(cameras[3], "eye0|0|3|400|400|60|1|");
+
+    const auto calibration = FakeJniEnv::floats(
+        Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetCameraCalibration(
+            &env_, nullptr, env_.string("1")));
+    ASSERT_EQ(calibration.size(), 23u);
+    EXPECT_FLOAT_EQ(calibration[0], 512.0f);
+    EXPECT_FLOAT_EQ(calibration[14], -0.032f);
+    EXPECT_FLOAT_EQ(calibration[20], 1.0f);
+}
+
+TEST_F(JniBridgeTest, ImuSamplesStatsAndMetadata) {
+    Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeInit(&env_, nullptr);
+    ASSERT_TRUE(waitUntil([this] {
+        return Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeIsRunning(&env_, nullptr) ==
+               JNI_TRUE;
+    }));
+    std::vector<float> accel;
+    ASSERT_TRUE(waitUntil([this, &accel] {
+        accel = FakeJniEnv::floats(
+            Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetAccelData(&env_, nullptr));
+        return accel.size() == 4 && accel[3] > 0.0f;
+    }));
+    EXPECT_NEAR(accel[2], 9.81f, 0.02f);
+
+    const auto stats = FakeJniEnv::floats(
+        Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetStats(&env_, nullptr));
+    EXPECT_EQ(stats.size(), 4u);
+    const auto metadata = FakeJniEnv::ints(
+        Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetMetadata(&env_, nullptr));
+    EXPECT_EQ(metadata, (std::vector<int32_t>{2500, 3000, 2500, 3000}));
+
+    // The mailbox registry serves the same sample by stream id
+    const auto streams = FakeJniEnv::text(
+        Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeListStreams(&env_, nullptr));
+    EXPECT_NE(streams.find("|imu.accel|"), std::string::npos);
+    EXPECT_EQ(FakeJniEnv::floats(Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeReadStream(
+                  &env_, nullptr, static_cast<jint>(streams::kAccel))).size(), 4u);
+
+    // name|startOffsetMs|durationMs|ready; every subsystem but the capability
+    // refresh (no cache directory unless prepared) comes up, and the first
+    // sample is timed
+    std::vector<std::string> timings;
+    ASSERT_TRUE(waitUntil([this, &timings] {
+        timings = lines(FakeJniEnv::text(
+            Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetStartupTimings(&env_, nullptr)));
+        return std::all_of(timings.begin(), timings.end(),
+                           [](const std::string& line) { return fields(line).at(2) != "-1"; });
+    }));
+    for (const auto& line : timings) {
+        const auto timing = fields(line);
+        ASSERT_EQ(timing.size(), 4u) << line;
+        if (timing[0] != "capabilityRefresh") {
+            EXPECT_EQ(timing[3], "1") << line;
+        }
+    }
+
+    Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeStop(&env_, nullptr);
+    EXPECT_EQ(Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeIsRunning(&env_, nullptr),
+              JNI_FALSE);
+}
+
+TEST_F(JniBridgeTest, CameraPreviewRoundTrip) {
+    ANativeWindow* window = createWindow(640, 480);
+    const jstring id = env_.string("1");
+    ASSERT_EQ(Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeStartPreview(
+                  &env_, nullptr, id, env_.surface(window)), JNI_TRUE);
+    ANativeWindow_release(window);
+    EXPECT_EQ(Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeIsCameraStreaming(&env_, nullptr, id),
+              JNI_TRUE);
+    EXPECT_EQ(Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetActiveStreamCount(&env_, nullptr), 1);
+    EXPECT_EQ(FakeJniEnv::text(
+                  Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetCurrentCameraId(&env_, nullptr)),
+              "1");
+
+    // [fps, latencyMs, frameCount, droppedFrames, ...]
+    std::vector<float> stats;
+    ASSERT_TRUE(waitUntil([this, id, &stats] {
+        stats = FakeJniEnv::floats(
+            Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetCameraStatsById(&env_, nullptr, id));
+        return stats.size() >= 4 && stats[2] >= 10.0f;
+    }));
+    // The exact rate is CameraStreamTest's job; sanitizer builds may drop frames
+    EXPECT_GT(stats[0], 0.0f);
+    EXPECT_LE(stats[0], 66.0f);
+
+    // Capture results and analysis frames flow through the pipeline
+    ASSERT_TRUE(waitUntil([this] {
+        for (const auto& line : lines(FakeJniEnv::text(
+                 Java_com_tw0b33rs_nativesensoraccess_sensor_NativeSensorBridge_nativeGetPipelineStats(&env_,
+                                                                                                      nullptr)))) {
+            const auto node = fields(line);
+            if (node.size() == 6 && node[0] == "frameMailbox" && std::stoll(node[1]) > 0) {
+                return true;
+            }
+        }
+        return false;
+    }));
+
+    Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeStopCameraPreview(&env_, nullptr, id);
+    EXPECT_EQ(Java_com_tw0b33rs_nativesensoraccess_sensor_CameraBridge_nativeGetActiveStreamCount(&env_, nullptr), 0);
+    EXPECT_EQ(liveHandles().cameraDevices, 0);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
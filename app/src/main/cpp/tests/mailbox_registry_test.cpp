@@ -0,0 +1,165 @@
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "mailbox_registry.h"
+
+namespace nativesensor::testing {
+namespace {
+
+struct Reading {
+    uint64_t index = 0;
+    float value = 0.0f;
+};
+
+struct OtherReading {
+    double value = 0.0;
+};
+
+void flattenReading(const Reading& reading, std::vector<float>& out) {
+    out.push_back(static_cast<float>(reading.index));
+    out.push_back(reading.value);
+}
+
+TEST(MailboxRegistryTest, CreatesOnFirstUseAndReturnsTheSameMailbox) {
+    MailboxRegistry registry;
+    EXPECT_EQ(registry.find<Reading>(streams::kFirstCustom), nullptr);
+
+    TripleBuffer<Reading>* box = registry.mailbox<Reading>(streams::kFirstCustom, "reading");
+    ASSERT_NE(box, nullptr);
+    EXPECT_EQ(registry.mailbox<Reading>(streams::kFirstCustom, "renamed"), box);
+    EXPECT_EQ(registry.find<Reading>(streams::kFirstCustom), box);
+
+    // Reads through find() see the writer's stores
+    Reading out;
+    EXPECT_FALSE(registry.find<Reading>(streams::kFirstCustom)->load(out));
+    box->store({3, 1.5f});
+    ASSERT_TRUE(registry.find<Reading>(streams::kFirstCustom)->load(out));
+    EXPECT_EQ(out.index, 3u);
+    EXPECT_EQ(out.value, 1.5f);
+}
+
+TEST(MailboxRegistryTest, RefusesAnotherPayloadTypeForAnExistingId) {
+    MailboxRegistry registry;
+    ASSERT_NE(registry.mailbox<Reading>(streams::kFirstCustom, "reading"), nullptr);
+    EXPECT_EQ(registry.mailbox<OtherReading>(streams::kFirstCustom, "other"), nullptr);
+    EXPECT_EQ(registry.find<OtherReading>(streams::kFirstCustom), nullptr);
+    EXPECT_NE(registry.find<Reading>(streams::kFirstCustom), nullptr);
+    EXPECT_EQ(registry.streams().size(), 1u);
+}
+
+TEST(MailboxRegistryTest, RefusesNewStreamsWhenFull) {
+    MailboxRegistry registry;
+    for (StreamId i = 0; i < MailboxRegistry::kMaxStreams; ++i) {
+        ASSERT_NE(registry.mailbox<Reading>(streams::kFirstCustom + i, "reading"), nullptr);
+    }
+    EXPECT_EQ(registry.mailbox<Reading>(streams::kFirstCustom + MailboxRegistry::kMaxStreams, "extra"), nullptr);
+    EXPECT_EQ(registry.find<Reading>(streams::kFirstCustom + MailboxRegistry::kMaxStreams), nullptr);
+
+    // Existing streams are still handed out
+    EXPECT_NE(registry.mailbox<Reading>(streams::kFirstCustom, "reading"), nullptr);
+    EXPECT_EQ(registry.streams().size(), MailboxRegistry::kMaxStreams);
+}
+
+TEST(MailboxRegistryTest, ListsStreamsInRegistrationOrderWithVersions) {
+    MailboxRegistry registry;
+    TripleBuffer<Reading>* accel = registry.mailbox<Reading>(streams::kAccel, "accel");
+    TripleBuffer<OtherReading>* custom = registry.mailbox<OtherReading>(streams::kFirstCustom, "custom");
+    ASSERT_NE(accel, nullptr);
+    ASSERT_NE(custom, nullptr);
+    accel->store({1, 0.0f});
+    accel->store({2, 0.0f});
+    custom->store({4.0});
+
+    const std::vector<MailboxRegistry::StreamInfo> listed = registry.streams();
+    ASSERT_EQ(listed.size(), 2u);
+    EXPECT_EQ(listed[0].id, streams::kAccel);
+    EXPECT_EQ(listed[0].name, "accel");
+    EXPECT_EQ(listed[0].version, 2u);
+    EXPECT_EQ(listed[1].id, streams::kFirstCustom);
+    EXPECT_EQ(listed[1].name, "custom");
+    EXPECT_EQ(listed[1].version, 1u);
+}
+
+TEST(MailboxRegistryTest, ReadFloatsNeedsAValueAndAFlattenFunction) {
+    MailboxRegistry registry;
+    TripleBuffer<Reading>* flattened = registry.mailbox<Reading>(streams::kAccel, "accel", flattenReading);
+    TripleBuffer<Reading>* opaque = registry.mailbox<Reading>(streams::kGyro, "gyro");
+    ASSERT_NE(flattened, nullptr);
+    ASSERT_NE(opaque, nullptr);
+
+    std::vector<float> out{42.0f};
+    EXPECT_FALSE(registry.readFloats(streams::kAccel, out));
+    EXPECT_FALSE(registry.readFloats(streams::kImuStats, out));
+    EXPECT_EQ(out, std::vector<float>{42.0f});
+
+    // The output is replaced, not appended to
+    flattened->store({7, 2.5f});
+    ASSERT_TRUE(registry.readFloats(streams::kAccel, out));
+    EXPECT_EQ(out, (std::vector<float>{7.0f, 2.5f}));
+
+    opaque->store({8, 1.0f});
+    EXPECT_FALSE(registry.readFloats(streams::kGyro, out));
+}
+
+// Readers look streams up while another thread keeps registering and storing:
+// every stream a reader finds is complete and holds only its own values
+TEST(MailboxRegistryTest, LookupsRaceRegistration) {
+    MailboxRegistry registry;
+    constexpr StreamId kStreams = MailboxRegistry::kMaxStreams;
+    constexpr uint64_t kStoresPerStream = 500;
+    std::atomic<bool> done{false};
+    std::atomic<int> bad{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&] {
+            Reading value;
+            std::vector<float> floats;
+            while (!done.load(std::memory_order_acquire)) {
+                for (StreamId i = 0; i < kStreams; ++i) {
+                    const StreamId id = streams::kFirstCustom + i;
+                    const TripleBuffer<Reading>* box = registry.find<Reading>(id);
+                    if (box && box->load(value) && value.index / kStoresPerStream != i) {
+                        bad.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    if (registry.readFloats(id, floats) && (floats.size() != 2 || floats[1] != static_cast<float>(i))) {
+                        bad.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                for (const auto& info : registry.streams()) {
+                    if (info.name != "stream-" + std::to_string(info.id - streams::kFirstCustom)) {
+                        bad.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+        });
+    }
+    for (StreamId i = 0; i < kStreams; ++i) {
+        const std::string name = "stream-" + std::to_string(i);
+        TripleBuffer<Reading>* box = registry.mailbox<Reading>(streams::kFirstCustom + i, name.c_str(), flattenReading);
+        if (!box) {
+            ADD_FAILURE() << "stream " << i << " not registered";
+            break;
+        }
+        for (uint64_t n = 0; n < kStoresPerStream; ++n) {
+            box->store({i * kStoresPerStream + n, static_cast<float>(i)});
+        }
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(bad.load(), 0);
+    for (const auto& info : registry.streams()) {
+        EXPECT_EQ(info.version, kStoresPerStream);
+    }
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
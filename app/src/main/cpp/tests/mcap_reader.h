@@ -0,0 +1,410 @@
+#pragma once
+
+// Strict readers for the LZ4 frames and MCAP files the recording code
+// writes, shared by the writer and exporter tests
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+namespace nativesensor::testing {
+
+inline constexpr size_t kLz4BlockSize = 4 << 20;
+
+inline uint32_t littleEndian32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+/// One LZ4 block, strictly: offsets inside the output so far, and the end
+/// rules the reference decoder relies on (the last 5 bytes are literals,
+/// no match starts in the last 12)
+inline ::testing::AssertionResult decodeLz4Block(const uint8_t* src, size_t size, std::vector<uint8_t>& out) {
+    const size_t base = out.size();
+    size_t lastMatchStart = 0;
+    bool matched = false;
+    size_t ip = 0;
+    auto length = [&](size_t value, size_t& result) {
+        uint8_t byte = 255;
+        while (value == 15 && byte == 255) {
+            if (ip >= size) {
+                return false;
+            }
+            byte = src[ip++];
+            result += byte;
+        }
+        return true;
+    };
+    while (true) {
+        if (ip >= size) {
+            return ::testing::AssertionFailure() << "missing token at " << ip;
+        }
+        const uint8_t token = src[ip++];
+        size_t literals = token >> 4;
+        if (!length(literals, literals) || literals > size - ip) {
+            return ::testing::AssertionFailure() << "literals overrun the block at " << ip;
+        }
+        out.insert(out.end(), src + ip, src + ip + literals);
+        ip += literals;
+        if (ip == size) {
+            const size_t decoded = out.size() - base;
+            if ((token & 15) != 0 || literals < std::min<size_t>(5, decoded)) {
+                return ::testing::AssertionFailure() << "block doesn't end with 5 literals";
+            }
+            if (matched && lastMatchStart + 12 > decoded) {
+                return ::testing::AssertionFailure() << "match starts in the last 12 bytes";
+            }
+            return ::testing::AssertionSuccess();
+        }
+
+        if (size - ip < 2) {
+            return ::testing::AssertionFailure() << "truncated match offset";
+        }
+        const size_t offset = static_cast<size_t>(src[ip]) | static_cast<size_t>(src[ip + 1]) << 8;
+        ip += 2;
+        size_t matchLength = token & 15;
+        if (!length(matchLength, matchLength)) {
+            return ::testing::AssertionFailure() << "truncated match length";
+        }
+        matchLength += 4;
+        if (offset == 0 || offset > out.size() - base) {
+            return ::testing::AssertionFailure() << "offset " << offset << " outside the block";
+        }
+        matched = true;
+        lastMatchStart = out.size() - base;
+        for (size_t i = 0; i < matchLength; ++i) {
+            out.push_back(out[out.size() - offset]);    // Overlapping copies repeat
+        }
+    }
+}
+
+/// Reader for what lz4CompressFrame writes: the fixed header (4 MB
+/// independent blocks, no checksums), raw or compressed blocks, end mark
+inline ::testing::AssertionResult decodeLz4Frame(const std::vector<uint8_t>& frame, std::vector<uint8_t>& out,
+                                                 size_t* rawBlocks = nullptr, size_t* blocks = nullptr) {
+    // Magic 0x184D2204, FLG 0x60, BD 0x70, then xxh32(FLG, BD) >> 8
+    static constexpr uint8_t kHeader[7] = {0x04, 0x22, 0x4D, 0x18, 0x60, 0x70, 0x73};
+    if (frame.size() < sizeof(kHeader) || std::memcmp(frame.data(), kHeader, sizeof(kHeader)) != 0) {
+        return ::testing::AssertionFailure() << "bad frame header";
+    }
+    size_t raw = 0;
+    size_t count = 0;
+    for (size_t offset = sizeof(kHeader);;) {
+        if (frame.size() - offset < 4) {
+            return ::testing::AssertionFailure() << "missing end mark";
+        }
+        const uint32_t word = littleEndian32(&frame[offset]);
+        offset += 4;
+        if (word == 0) {
+            if (offset != frame.size()) {
+                return ::testing::AssertionFailure() << frame.size() - offset << " bytes after the end mark";
+            }
+            break;
+        }
+        const size_t size = word & 0x7FFFFFFFu;
+        if (size > kLz4BlockSize || size > frame.size() - offset) {
+            return ::testing::AssertionFailure() << "block of " << size << " bytes at " << offset;
+        }
+        const size_t before = out.size();
+        if (word & 0x80000000u) {
+            out.insert(out.end(), &frame[offset], &frame[offset] + size);
+            ++raw;
+        } else if (::testing::AssertionResult block = decodeLz4Block(&frame[offset], size, out); !block) {
+            return block;
+        }
+        if (out.size() - before > kLz4BlockSize) {
+            return ::testing::AssertionFailure() << "block decodes past 4 MB";
+        }
+        offset += size;
+        ++count;
+    }
+    if (rawBlocks) {
+        *rawBlocks = raw;
+    }
+    if (blocks) {
+        *blocks = count;
+    }
+    return ::testing::AssertionSuccess();
+}
+
+inline constexpr uint8_t kMcapMagic[8] = {0x89, 'M', 'C', 'A', 'P', '0', '\r', '\n'};
+
+/// Bounds-checked little-endian fields; reading past the end yields zeros
+/// and clears `ok`
+struct Fields {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t position = 0;
+    bool ok = true;
+
+    template<typename T>
+    T le() {
+        if (size - position < sizeof(T)) {
+            ok = false;
+            position = size;
+            return 0;
+        }
+        uint64_t value = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            value |= static_cast<uint64_t>(data[position + i]) << (8 * i);
+        }
+        position += sizeof(T);
+        return static_cast<T>(value);
+    }
+
+    std::string string() {
+        const uint32_t length = le<uint32_t>();
+        if (size - position < length) {
+            ok = false;
+            position = size;
+            return {};
+        }
+        std::string value(reinterpret_cast<const char*>(data + position), length);
+        position += length;
+        return value;
+    }
+
+    [[nodiscard]]
+    bool done() const noexcept { return ok && position == size; }
+};
+
+struct Record {
+    uint8_t opcode = 0;
+    uint64_t offset = 0;
+    Fields body;            // The record's content, past opcode and length
+};
+
+/// The record at `offset` of `bytes`; opcode 0 if it doesn't fit
+inline Record recordAt(const std::vector<uint8_t>& bytes, uint64_t offset) {
+    Record record;
+    Fields header{bytes.data(), bytes.size(), static_cast<size_t>(offset)};
+    const auto opcode = header.le<uint8_t>();
+    const auto length = header.le<uint64_t>();
+    if (!header.ok || length > bytes.size() - header.position) {
+        return record;
+    }
+    record.opcode = opcode;
+    record.offset = offset;
+    record.body = {bytes.data() + header.position, static_cast<size_t>(length)};
+    return record;
+}
+
+inline uint64_t recordEnd(const Record& record) {
+    return record.offset + 9 + record.body.size;
+}
+
+struct ChunkIndex {
+    uint64_t startNs = 0;
+    uint64_t endNs = 0;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    std::map<uint16_t, uint64_t> messageIndexOffsets;
+    uint64_t messageIndexLength = 0;
+    std::string compression;
+    uint64_t compressedSize = 0;
+    uint64_t uncompressedSize = 0;
+};
+
+struct Summary {
+    std::map<uint8_t, std::pair<uint64_t, uint64_t>> groups;        // Opcode: start, length
+    std::map<uint16_t, std::string> topics;
+    std::map<uint16_t, std::string> schemas;
+    uint64_t messageCount = 0;
+    uint32_t chunkCount = 0;
+    uint64_t messageStartNs = 0;
+    uint64_t messageEndNs = 0;
+    std::map<uint16_t, uint64_t> channelMessageCounts;
+    std::vector<ChunkIndex> chunks;
+    std::map<std::string, std::pair<uint64_t, uint64_t>> metadata;  // Name: offset, length
+};
+
+/// Read an MCAP file back from its end: magics, footer, summary offsets,
+/// then every group they point at
+inline ::testing::AssertionResult readSummary(const std::vector<uint8_t>& file, Summary& summary) {
+    constexpr size_t kFooterSize = 1 + 8 + 8 + 8 + 4;
+    if (file.size() < 2 * sizeof(kMcapMagic) + kFooterSize ||
+        std::memcmp(file.data(), kMcapMagic, sizeof(kMcapMagic)) != 0 ||
+        std::memcmp(&file[file.size() - sizeof(kMcapMagic)], kMcapMagic, sizeof(kMcapMagic)) != 0) {
+        return ::testing::AssertionFailure() << "missing magic";
+    }
+    if (recordAt(file, sizeof(kMcapMagic)).opcode != 0x01) {
+        return ::testing::AssertionFailure() << "no header record after the magic";
+    }
+
+    const uint64_t footerOffset = file.size() - sizeof(kMcapMagic) - kFooterSize;
+    Record footer = recordAt(file, footerOffset);
+    const auto summaryStart = footer.body.le<uint64_t>();
+    const auto summaryOffsetStart = footer.body.le<uint64_t>();
+    const auto summaryCrc = footer.body.le<uint32_t>();
+    if (footer.opcode != 0x02 || !footer.body.done() || summaryCrc != 0) {
+        return ::testing::AssertionFailure() << "bad footer";
+    }
+    if (summaryStart == 0 || summaryStart > summaryOffsetStart || summaryOffsetStart > footerOffset) {
+        return ::testing::AssertionFailure() << "summary at " << summaryStart << ", offsets at " << summaryOffsetStart;
+    }
+    Record dataEnd = recordAt(file, summaryStart - 13);
+    if (dataEnd.opcode != 0x0F || dataEnd.body.le<uint32_t>() != 0 || !dataEnd.body.done()) {
+        return ::testing::AssertionFailure() << "no data end record before the summary";
+    }
+
+    // Summary offsets: contiguous groups covering the whole summary section
+    uint64_t expectedStart = summaryStart;
+    for (uint64_t offset = summaryOffsetStart; offset < footerOffset;) {
+        Record record = recordAt(file, offset);
+        const auto opcode = record.body.le<uint8_t>();
+        const auto start = record.body.le<uint64_t>();
+        const auto length = record.body.le<uint64_t>();
+        if (record.opcode != 0x0E || !record.body.done() || start != expectedStart || length == 0 ||
+            !summary.groups.emplace(opcode, std::make_pair(start, length)).second) {
+            return ::testing::AssertionFailure() << "bad summary offset at " << offset;
+        }
+        expectedStart = start + length;
+        offset = recordEnd(record);
+    }
+    if (expectedStart != summaryOffsetStart) {
+        return ::testing::AssertionFailure() << "summary groups end at " << expectedStart;
+    }
+
+    for (const auto& [opcode, range] : summary.groups) {
+        for (uint64_t offset = range.first; offset < range.first + range.second;) {
+            Record record = recordAt(file, offset);
+            Fields& body = record.body;
+            if (record.opcode != opcode) {
+                return ::testing::AssertionFailure() << "record " << int{record.opcode} << " in group " << int{opcode};
+            }
+            if (opcode == 0x03) {
+                const auto id = body.le<uint16_t>();
+                summary.schemas[id] = body.string();
+                body.string();
+                body.string();
+            } else if (opcode == 0x04) {
+                const auto id = body.le<uint16_t>();
+                body.le<uint16_t>();
+                summary.topics[id] = body.string();
+                body.string();
+                body.position += body.le<uint32_t>();
+            } else if (opcode == 0x0B) {
+                summary.messageCount = body.le<uint64_t>();
+                body.le<uint16_t>();
+                body.le<uint32_t>();
+                body.le<uint32_t>();
+                body.le<uint32_t>();
+                summary.chunkCount = body.le<uint32_t>();
+                summary.messageStartNs = body.le<uint64_t>();
+                summary.messageEndNs = body.le<uint64_t>();
+                for (auto bytes = body.le<uint32_t>(); bytes >= 10 && body.ok; bytes -= 10) {
+                    const auto id = body.le<uint16_t>();
+                    summary.channelMessageCounts[id] = body.le<uint64_t>();
+                }
+            } else if (opcode == 0x08) {
+                ChunkIndex index;
+                index.startNs = body.le<uint64_t>();
+                index.endNs = body.le<uint64_t>();
+                index.offset = body.le<uint64_t>();
+                index.length = body.le<uint64_t>();
+                for (auto bytes = body.le<uint32_t>(); bytes >= 10 && body.ok; bytes -= 10) {
+                    const auto id = body.le<uint16_t>();
+                    index.messageIndexOffsets[id] = body.le<uint64_t>();
+                }
+                index.messageIndexLength = body.le<uint64_t>();
+                index.compression = body.string();
+                index.compressedSize = body.le<uint64_t>();
+                index.uncompressedSize = body.le<uint64_t>();
+                summary.chunks.push_back(index);
+            } else if (opcode == 0x0D) {
+                const auto metadataOffset = body.le<uint64_t>();
+                const auto length = body.le<uint64_t>();
+                summary.metadata[body.string()] = {metadataOffset, length};
+            } else {
+                return ::testing::AssertionFailure() << "unexpected summary group " << int{opcode};
+            }
+            if (!body.done()) {
+                return ::testing::AssertionFailure() << "malformed record " << int{opcode} << " at " << offset;
+            }
+            offset = recordEnd(record);
+        }
+    }
+    return ::testing::AssertionSuccess();
+}
+
+/// The chunk an index points at: fields match the index, records decompress
+/// to the stored size and CRC
+inline ::testing::AssertionResult readChunk(const std::vector<uint8_t>& file, const ChunkIndex& index,
+                                            std::vector<uint8_t>& records) {
+    Record chunk = recordAt(file, index.offset);
+    Fields& body = chunk.body;
+    const auto startNs = body.le<uint64_t>();
+    const auto endNs = body.le<uint64_t>();
+    const auto uncompressedSize = body.le<uint64_t>();
+    const auto crc = body.le<uint32_t>();
+    const std::string compression = body.string();
+    const auto size = body.le<uint64_t>();
+    if (chunk.opcode != 0x06 || recordEnd(chunk) - index.offset != index.length || size != body.size - body.position) {
+        return ::testing::AssertionFailure() << "no chunk of " << index.length << " bytes at " << index.offset;
+    }
+    if (startNs != index.startNs || endNs != index.endNs || uncompressedSize != index.uncompressedSize ||
+        compression != index.compression || size != index.compressedSize) {
+        return ::testing::AssertionFailure() << "chunk at " << index.offset << " doesn't match its index";
+    }
+
+    records.clear();
+    const std::vector<uint8_t> stored(body.data + body.position, body.data + body.size);
+    if (compression == "lz4") {
+        if (::testing::AssertionResult decoded = decodeLz4Frame(stored, records); !decoded) {
+            return decoded;
+        }
+    } else if (compression.empty()) {
+        records = stored;
+    } else {
+        return ::testing::AssertionFailure() << "unknown compression " << compression;
+    }
+    if (records.size() != uncompressedSize ||
+        static_cast<uint32_t>(crc32(0L, records.data(), static_cast<uInt>(records.size()))) != crc) {
+        return ::testing::AssertionFailure() << "chunk at " << index.offset << " fails its size or CRC";
+    }
+    return ::testing::AssertionSuccess();
+}
+
+struct Message {
+    uint16_t channelId = 0;
+    uint32_t sequence = 0;
+    uint64_t logTimeNs = 0;
+    std::vector<uint8_t> data;
+};
+
+inline std::vector<uint8_t> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+/// Message records of a decompressed chunk, in order
+inline ::testing::AssertionResult readMessages(const std::vector<uint8_t>& records, std::vector<Message>& out) {
+    for (uint64_t offset = 0; offset < records.size();) {
+        Record record = recordAt(records, offset);
+        if (record.opcode != 0x05) {
+            return ::testing::AssertionFailure() << "record " << int{record.opcode} << " at " << offset;
+        }
+        Message message;
+        message.channelId = record.body.le<uint16_t>();
+        message.sequence = record.body.le<uint32_t>();
+        message.logTimeNs = record.body.le<uint64_t>();
+        record.body.le<uint64_t>();
+        if (!record.body.ok) {
+            return ::testing::AssertionFailure() << "truncated message at " << offset;
+        }
+        message.data.assign(record.body.data + record.body.position, record.body.data + record.body.size);
+        out.push_back(std::move(message));
+        offset = recordEnd(record);
+    }
+    return ::testing::AssertionSuccess();
+}
+
+}  // namespace nativesensor::testing
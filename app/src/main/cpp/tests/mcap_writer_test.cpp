@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "lz4_frame.h"
+#include "mcap_reader.h"
+#include "mcap_writer.h"
+#include "test_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+/// Sensor-record-like bytes: small headers and slowly changing values
+std::vector<uint8_t> compressibleData(size_t size) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        const size_t record = i / 48;
+        data[i] = i % 48 < 8 ? static_cast<uint8_t>("IMU\0acc\0"[i % 48]) : static_cast<uint8_t>((record >> 3) + i % 5);
+    }
+    return data;
+}
+
+std::vector<uint8_t> randomData(size_t size, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::vector<uint8_t> data(size);
+    for (uint8_t& byte : data) {
+        byte = static_cast<uint8_t>(random());
+    }
+    return data;
+}
+
+TEST(Lz4FrameTest, RoundTripsShortAndCompressibleInputs) {
+    for (const size_t size : {size_t{0}, size_t{1}, size_t{5}, size_t{12}, size_t{13}, size_t{17}, size_t{64},
+                              size_t{1000}, size_t{65536 + 300}}) {
+        const std::vector<uint8_t> data = compressibleData(size);
+        std::vector<uint8_t> frame{0xAB};       // Appended after what's there
+        lz4CompressFrame(data.data(), data.size(), frame);
+        ASSERT_EQ(frame[0], 0xAB);
+        frame.erase(frame.begin());
+
+        std::vector<uint8_t> decoded;
+        ASSERT_TRUE(decodeLz4Frame(frame, decoded)) << size;
+        EXPECT_EQ(decoded, data) << size;
+    }
+
+    const std::vector<uint8_t> data = compressibleData(1 << 20);
+    std::vector<uint8_t> frame;
+    lz4CompressFrame(data.data(), data.size(), frame);
+    EXPECT_LT(frame.size(), data.size() / 4);
+}
+
+TEST(Lz4FrameTest, LongRunsRoundTrip) {
+    // Literal and match lengths past 15 + 255 take extra length bytes;
+    // runs are overlapping copies
+    std::vector<uint8_t> data(3000, 'a');
+    const std::vector<uint8_t> noise = randomData(2000, 1);
+    data.insert(data.end(), noise.begin(), noise.end());
+    data.insert(data.end(), 3000, 'b');
+
+    std::vector<uint8_t> frame;
+    lz4CompressFrame(data.data(), data.size(), frame);
+    std::vector<uint8_t> decoded;
+    ASSERT_TRUE(decodeLz4Frame(frame, decoded));
+    EXPECT_EQ(decoded, data);
+    EXPECT_LT(frame.size(), noise.size() + 200);
+}
+
+TEST(Lz4FrameTest, IncompressibleBlocksAreStoredRaw) {
+    const std::vector<uint8_t> data = randomData(100'000, 2);
+    std::vector<uint8_t> frame;
+    lz4CompressFrame(data.data(), data.size(), frame);
+    std::vector<uint8_t> decoded;
+    size_t raw = 0;
+    ASSERT_TRUE(decodeLz4Frame(frame, decoded, &raw));
+    EXPECT_EQ(decoded, data);
+    EXPECT_EQ(raw, 1u);
+    EXPECT_EQ(frame.size(), data.size() + 7 + 4 + 4);
+}
+
+TEST(Lz4FrameTest, SplitsInputIntoFourMegabyteBlocks) {
+    // Two compressible blocks around a random one, the last one short
+    std::vector<uint8_t> data = compressibleData(kLz4BlockSize);
+    const std::vector<uint8_t> noise = randomData(kLz4BlockSize, 3);
+    data.insert(data.end(), noise.begin(), noise.end());
+    const std::vector<uint8_t> tail = compressibleData(12345);
+    data.insert(data.end(), tail.begin(), tail.end());
+
+    std::vector<uint8_t> frame;
+    lz4CompressFrame(data.data(), data.size(), frame);
+    std::vector<uint8_t> decoded;
+    size_t raw = 0;
+    size_t blocks = 0;
+    ASSERT_TRUE(decodeLz4Frame(frame, decoded, &raw, &blocks));
+    EXPECT_EQ(blocks, 3u);
+    EXPECT_EQ(raw, 1u);
+    EXPECT_TRUE(decoded == data);
+}
+
+std::vector<uint8_t> payload(size_t i) {
+    std::vector<uint8_t> data(24 + i % 7);
+    for (size_t j = 0; j < data.size(); ++j) {
+        data[j] = static_cast<uint8_t>(i / 4 + j);
+    }
+    return data;
+}
+
+constexpr uint64_t kStartNs = 1'000'000'000;
+constexpr size_t kMessages = 3000;
+
+/// Time of message i: 1 ms apart, every 10th pair swapped
+uint64_t messageTimeNs(size_t i) {
+    const size_t slot = i % 20 == 0 ? i + 1 : i % 20 == 1 ? i - 1 : i;
+    return kStartNs + slot * 1'000'000;
+}
+
+class McapWriterTest : public ::testing::TestWithParam<McapCompression> {
+protected:
+    TempDir dir_;
+};
+
+TEST_P(McapWriterTest, SummaryLocatesEveryChunkAndMessage) {
+    const std::string path = dir_.path() + "/session.mcap";
+    McapWriterOptions options;
+    options.compression = GetParam();
+    options.chunkSize = 8192;
+    McapWriter writer;
+    ASSERT_TRUE(writer.open(path, options));
+    const uint16_t schema = writer.addSchema("sensor_msgs/msg/Imu", "ros2msg", "float64 x");
+    ASSERT_EQ(schema, 1);
+    const uint16_t accel = writer.addChannel(schema, "/imu/accel", "cdr", {{"frame", "imu"}});
+    const uint16_t gyro = writer.addChannel(schema, "/imu/gyro", "cdr");
+    ASSERT_TRUE(writer.writeMetadata("device", {{"model", "test"}, {"sdk", "34"}}));
+    for (size_t i = 0; i < kMessages; ++i) {
+        const std::vector<uint8_t> data = payload(i);
+        ASSERT_TRUE(writer.writeMessage(i % 3 == 0 ? gyro : accel, static_cast<TimestampNs>(messageTimeNs(i)),
+                                        data.data(), data.size()));
+    }
+    EXPECT_FALSE(std::filesystem::exists(path));
+    ASSERT_TRUE(writer.finish());
+    EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+
+    const std::vector<uint8_t> file = readFile(path);
+    EXPECT_EQ(writer.stats().bytesWritten, static_cast<int64_t>(file.size()));
+    Summary summary;
+    ASSERT_TRUE(readSummary(file, summary));
+    EXPECT_EQ(summary.groups.size(), 5u);
+    EXPECT_EQ(summary.schemas[schema], "sensor_msgs/msg/Imu");
+    EXPECT_EQ(summary.topics[accel], "/imu/accel");
+    EXPECT_EQ(summary.topics[gyro], "/imu/gyro");
+    EXPECT_EQ(summary.messageCount, kMessages);
+    EXPECT_EQ(summary.channelMessageCounts[gyro], kMessages / 3);
+    EXPECT_EQ(summary.channelMessageCounts[accel], kMessages - kMessages / 3);
+    EXPECT_EQ(summary.messageStartNs, kStartNs);
+    EXPECT_EQ(summary.messageEndNs, messageTimeNs(kMessages - 1));
+    ASSERT_GT(summary.chunks.size(), 1u);
+    EXPECT_EQ(summary.chunkCount, summary.chunks.size());
+    EXPECT_EQ(static_cast<int64_t>(summary.chunks.size()), writer.stats().chunks);
+
+    // Walk each chunk in index order: messages come back in write order, and
+    // every message index entry points at its message
+    std::vector<Message> messages;
+    uint64_t uncompressed = 0;
+    for (const ChunkIndex& index : summary.chunks) {
+        std::vector<uint8_t> records;
+        ASSERT_TRUE(readChunk(file, index, records));
+        EXPECT_EQ(index.compression, GetParam() == McapCompression::Lz4 ? "lz4" : "");
+        uncompressed += records.size();
+
+        std::map<uint64_t, size_t> byOffset;
+        uint64_t startNs = UINT64_MAX;
+        uint64_t endNs = 0;
+        for (uint64_t offset = 0; offset < records.size();) {
+            Record record = recordAt(records, offset);
+            ASSERT_EQ(record.opcode, 0x05) << offset;
+            Message message;
+            message.channelId = record.body.le<uint16_t>();
+            message.sequence = record.body.le<uint32_t>();
+            message.logTimeNs = record.body.le<uint64_t>();
+            EXPECT_EQ(record.body.le<uint64_t>(), message.logTimeNs);
+            message.data.assign(record.body.data + record.body.position, record.body.data + record.body.size);
+            ASSERT_TRUE(record.body.ok);
+            startNs = std::min(startNs, message.logTimeNs);
+            endNs = std::max(endNs, message.logTimeNs);
+            byOffset[offset] = messages.size();
+            messages.push_back(std::move(message));
+            offset = recordEnd(record);
+        }
+        EXPECT_EQ(index.startNs, startNs);
+        EXPECT_EQ(index.endNs, endNs);
+
+        // Message indexes follow the chunk back to back
+        uint64_t offset = index.offset + index.length;
+        size_t indexed = 0;
+        for (const auto& [channelId, indexOffset] : index.messageIndexOffsets) {
+            ASSERT_EQ(indexOffset, offset);
+            Record record = recordAt(file, indexOffset);
+            ASSERT_EQ(record.opcode, 0x07);
+            EXPECT_EQ(record.body.le<uint16_t>(), channelId);
+            for (auto bytes = record.body.le<uint32_t>(); bytes >= 16 && record.body.ok; bytes -= 16) {
+                const auto timeNs = record.body.le<uint64_t>();
+                const auto messageOffset = record.body.le<uint64_t>();
+                ASSERT_EQ(byOffset.count(messageOffset), 1u) << messageOffset;
+                const Message& message = messages[byOffset[messageOffset]];
+                EXPECT_EQ(message.channelId, channelId);
+                EXPECT_EQ(message.logTimeNs, timeNs);
+                ++indexed;
+            }
+            EXPECT_TRUE(record.body.done());
+            offset = recordEnd(record);
+        }
+        EXPECT_EQ(offset - index.offset - index.length, index.messageIndexLength);
+        EXPECT_EQ(indexed, byOffset.size());
+    }
+    EXPECT_EQ(static_cast<int64_t>(uncompressed), writer.stats().uncompressedBytes);
+
+    ASSERT_EQ(messages.size(), kMessages);
+    std::map<uint16_t, uint32_t> sequences;
+    for (size_t i = 0; i < kMessages; ++i) {
+        EXPECT_EQ(messages[i].channelId, i % 3 == 0 ? gyro : accel) << i;
+        EXPECT_EQ(messages[i].sequence, sequences[messages[i].channelId]++) << i;
+        EXPECT_EQ(messages[i].logTimeNs, messageTimeNs(i)) << i;
+        EXPECT_EQ(messages[i].data, payload(i)) << i;
+    }
+
+    // The metadata index points at the metadata record
+    ASSERT_EQ(summary.metadata.count("device"), 1u);
+    const auto [metadataOffset, metadataLength] = summary.metadata["device"];
+    Record metadata = recordAt(file, metadataOffset);
+    ASSERT_EQ(metadata.opcode, 0x0C);
+    EXPECT_EQ(recordEnd(metadata) - metadataOffset, metadataLength);
+    EXPECT_EQ(metadata.body.string(), "device");
+    EXPECT_EQ(metadata.body.le<uint32_t>(), 4u * 4 + 5 + 4 + 3 + 2);
+    EXPECT_EQ(metadata.body.string(), "model");
+}
+
+INSTANTIATE_TEST_SUITE_P(Compression, McapWriterTest,
+                         ::testing::Values(McapCompression::Lz4, McapCompression::None),
+                         [](const ::testing::TestParamInfo<McapCompression>& info) {
+                             return info.param == McapCompression::Lz4 ? "Lz4" : "None";
+                         });
+
+TEST(McapWriterFileTest, UnfinishedFilesAreRemoved) {
+    TempDir dir;
+    const std::string path = dir.path() + "/partial.mcap";
+    {
+        McapWriter writer;
+        ASSERT_TRUE(writer.open(path));
+        const uint16_t channel = writer.addChannel(writer.addSchema("s", "ros2msg", ""), "/t", "cdr");
+        const uint8_t byte = 1;
+        ASSERT_TRUE(writer.writeMessage(channel, 1, &byte, 1));
+        EXPECT_TRUE(std::filesystem::exists(path + ".tmp"));
+    }
+    EXPECT_FALSE(std::filesystem::exists(path));
+    EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+
+    McapWriter writer;
+    EXPECT_FALSE(writer.open(dir.path() + "/missing/file.mcap"));
+    const uint8_t byte = 1;
+    EXPECT_FALSE(writer.writeMessage(0, 1, &byte, 1));
+    EXPECT_FALSE(writer.finish());
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,150 @@
+#include <cmath>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include "calibration_store.h"
+#include "frame_pool.h"
+#include "geometry.h"
+#include "gyro_history.h"
+#include "motion_blur.h"
+#include "time_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr int32_t kWidth = 640;
+constexpr int32_t kHeight = 480;
+constexpr int64_t kPeriodNs = 2'500'000;
+constexpr TimestampNs kFrameNs = kNsPerSecond;
+constexpr int64_t kExposureNs = 10'000'000;
+constexpr float kFocalPx = 400.0f;
+
+/// Camera "rig" mounted with its axes rotated against the IMU's, and "bare"
+/// without any calibration
+CameraInfo rigCamera(const Quat& cameraFromImu) {
+    CameraInfo camera;
+    camera.id = "rig";
+    CameraCalibration& c = camera.calibration;
+    c.fx = kFocalPx;
+    c.fy = kFocalPx;
+    c.cx = 0.5f * kWidth;
+    c.cy = 0.5f * kHeight;
+    c.activeArrayWidth = kWidth;
+    c.activeArrayHeight = kHeight;
+    c.poseRotation[0] = cameraFromImu.x;
+    c.poseRotation[1] = cameraFromImu.y;
+    c.poseRotation[2] = cameraFromImu.z;
+    c.poseRotation[3] = cameraFromImu.w;
+    c.poseReference = LensPoseReference::Gyroscope;
+    c.hasIntrinsics = true;
+    c.hasPose = true;
+    return camera;
+}
+
+class MotionBlurGateTest : public ::testing::Test {
+protected:
+    MotionBlurGateTest() : store_("", "device"), frames_(kWidth, kHeight, 4) {
+        CameraInfo bare;
+        bare.id = "bare";
+        // Camera z is IMU x: a yaw of the camera is an IMU roll
+        store_.update({rigCamera(quat::fromRotationVector({0.0f, -1.5707964f, 0.0f})), bare});
+    }
+
+    /// Gyro at a constant IMU-frame rate around the test frame's exposure
+    void spin(const Vec3& rate) {
+        for (TimestampNs t = kFrameNs - 20 * kPeriodNs; t <= kFrameNs + 20 * kPeriodNs; t += kPeriodNs) {
+            gyro_.addSample({rate.x, rate.y, rate.z, t, SensorType::Gyroscope});
+        }
+    }
+
+    static FrameMetadata metadata(const char* cameraId, int64_t exposureNs = kExposureNs) {
+        FrameMetadata m;
+        m.cameraId = cameraId;
+        m.timestampNs = kFrameNs;
+        m.exposureTimeNs = exposureNs;
+        return m;
+    }
+
+    FrameRef frame(const char* cameraId, int64_t exposureNs = kExposureNs) {
+        FrameRef ref = frames_.acquire();
+        ref->metadata = metadata(cameraId, exposureNs);
+        return ref;
+    }
+
+    GyroHistory gyro_;
+    CalibrationStore store_;
+    FramePool frames_;
+};
+
+TEST_F(MotionBlurGateTest, PanShiftsEveryPixelByFocalTimesAngle) {
+    // IMU y stays camera y under the mounting: a pan of the camera
+    spin({0.0f, 1.0f, 0.0f});
+    MotionBlurGate gate(gyro_, store_);
+    const float angle = 1.0f * 1e-9f * static_cast<float>(kExposureNs);
+    EXPECT_NEAR(gate.blurScore(metadata("rig"), kWidth, kHeight), kFocalPx * angle, 0.01f);
+    // Half-size stream: half the focal length in pixels
+    EXPECT_NEAR(gate.blurScore(metadata("rig"), kWidth / 2, kHeight / 2), 0.5f * kFocalPx * angle, 0.01f);
+}
+
+TEST_F(MotionBlurGateTest, RollAboutTheOpticalAxisMovesTheCorners) {
+    // IMU x is the camera's optical axis under the mounting
+    spin({1.0f, 0.0f, 0.0f});
+    MotionBlurGate gate(gyro_, store_);
+    const float angle = 1e-9f * static_cast<float>(kExposureNs);
+    const float cornerRadius = 0.5f * std::hypot(static_cast<float>(kWidth), static_cast<float>(kHeight));
+    EXPECT_NEAR(gate.blurScore(metadata("rig"), kWidth, kHeight), cornerRadius * angle, 0.01f);
+}
+
+TEST_F(MotionBlurGateTest, UncalibratedCamerasAssumeTheWorstAxis) {
+    spin({0.0f, 0.0f, 1.0f});
+    MotionBlurGate gate(gyro_, store_);
+    const float angle = 1e-9f * static_cast<float>(kExposureNs);
+    // The fallback f = w / 2 (90 degree field of view) is below the corner
+    // radius, so an unknown axis is scored as a roll
+    const float cornerRadius = 0.5f * std::hypot(static_cast<float>(kWidth), static_cast<float>(kHeight));
+    EXPECT_NEAR(gate.blurScore(metadata("bare"), kWidth, kHeight), cornerRadius * angle, 0.01f);
+}
+
+TEST_F(MotionBlurGateTest, FramesThatCantBeScoredAreUnscored) {
+    MotionBlurGate gate(gyro_, store_);
+    EXPECT_LT(gate.blurScore(metadata("rig"), kWidth, kHeight), 0.0f);     // No gyro yet
+    spin({0.0f, 1.0f, 0.0f});
+    EXPECT_LT(gate.blurScore(metadata("rig", 0), kWidth, kHeight), 0.0f);  // No exposure time
+    EXPECT_LT(gate.blurScore(metadata("rig"), 0, kHeight), 0.0f);
+    EXPECT_GE(gate.blurScore(metadata("rig"), kWidth, kHeight), 0.0f);
+}
+
+TEST_F(MotionBlurGateTest, GatesOnTheThresholdAndKeepsStats) {
+    // 0.5 rad/s over 10 ms: 2 px at f = 400
+    spin({0.0f, 0.5f, 0.0f});
+    MotionBlurGate gate(gyro_, store_, 2.5f);
+
+    FrameRef out;
+    FrameRef sharp = frame("rig");
+    EXPECT_TRUE(gate.process(sharp, out));
+    EXPECT_EQ(out.get(), sharp.get());
+    EXPECT_NEAR(sharp->metadata.motionBlurPx, 2.0f, 0.01f);
+
+    gate.setMaxBlurPx(1.5f);
+    out.reset();
+    FrameRef blurred = frame("rig");
+    EXPECT_FALSE(gate.process(blurred, out));
+    EXPECT_FALSE(out);
+
+    // Unscored frames pass whatever the threshold
+    FrameRef unknown = frame("rig", 0);
+    EXPECT_TRUE(gate.process(unknown, out));
+    EXPECT_LT(unknown->metadata.motionBlurPx, 0.0f);
+
+    const MotionBlurStats stats = gate.getStats();
+    EXPECT_EQ(stats.passed, 2);
+    EXPECT_EQ(stats.skipped, 1);
+    EXPECT_EQ(stats.unscored, 1);
+    EXPECT_NEAR(stats.meanBlurPx, 2.0f, 0.01f);
+    EXPECT_NEAR(stats.maxBlurPx, 2.0f, 0.01f);
+    EXPECT_FLOAT_EQ(stats.thresholdPx, 1.5f);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "analysis_frames.h"
+#include "frame_pool.h"
+#include "pipeline.h"
+#include "test_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+/// Thread-safe record of the items a sink saw
+class Collected {
+public:
+    void add(int value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        values_.push_back(value);
+    }
+
+    std::vector<int> values() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return values_;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return values_.size();
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<int> values_;
+};
+
+const NodeStats& statsOf(const std::vector<NodeStats>& stats, const std::string& name) {
+    const auto it = std::find_if(stats.begin(), stats.end(),
+                                 [&name](const NodeStats& node) { return node.name == name; });
+    EXPECT_NE(it, stats.end()) << name;
+    return *it;
+}
+
+TEST(PipelineTest, StagesTransformFilterAndFanOutInOrder) {
+    ThreadPool pool(3);
+    Pipeline pipeline(pool);
+    Collected doubled;
+    Collected raw;
+    auto* source = pipeline.addSource<int>("source");
+    auto* evens = pipeline.addStage<int, int>("double-evens", [](const int& in, int& out) {
+        out = in * 2;
+        return in % 2 == 0;
+    });
+    auto* doubledSink = pipeline.addSink<int>("doubled", [&doubled](const int& v) { doubled.add(v); });
+    auto* rawSink = pipeline.addSink<int>("raw", [&raw](const int& v) { raw.add(v); });
+    pipeline.connect<int>(source, evens, 1024);
+    pipeline.connect<int>(evens, doubledSink, 1024);
+    pipeline.connect<int>(source, rawSink, 1024);
+
+    for (int i = 0; i < 1000; ++i) {
+        source->push(i);
+    }
+    ASSERT_TRUE(waitUntil([&] { return doubled.size() == 500 && raw.size() == 1000; }));
+
+    // One producer and a node never runs concurrently with itself: FIFO end to end
+    const auto doubledValues = doubled.values();
+    const auto rawValues = raw.values();
+    for (int i = 0; i < 500; ++i) {
+        ASSERT_EQ(doubledValues[static_cast<size_t>(i)], i * 4);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(rawValues[static_cast<size_t>(i)], i);
+    }
+
+    pipeline.stop();
+    const auto stats = pipeline.getStats();
+    ASSERT_EQ(stats.size(), 4u);
+    EXPECT_EQ(stats[0].name, "source");
+    EXPECT_EQ(statsOf(stats, "source").processed, 1000);
+    EXPECT_EQ(statsOf(stats, "double-evens").processed, 1000);
+    EXPECT_EQ(statsOf(stats, "doubled").processed, 500);
+    EXPECT_GE(statsOf(stats, "raw").runs, 1);
+    for (const auto& node : stats) {
+        EXPECT_EQ(node.dropped, 0) << node.name;
+        EXPECT_EQ(node.queued, 0) << node.name;
+    }
+}
+
+TEST(PipelineTest, NodeNeverRunsConcurrentlyWithItself) {
+    ThreadPool pool(4);
+    Pipeline pipeline(pool);
+    std::atomic<int> inside{0};
+    std::atomic<bool> overlapped{false};
+    std::atomic<int> seen{0};
+    auto* source = pipeline.addSource<int>("source");
+    auto* sink = pipeline.addSink<int>("sink", [&](const int&) {
+        if (inside.fetch_add(1, std::memory_order_acq_rel) != 0) {
+            overlapped = true;
+        }
+        std::this_thread::yield();
+        inside.fetch_sub(1, std::memory_order_acq_rel);
+        seen.fetch_add(1, std::memory_order_relaxed);
+    });
+    pipeline.connect<int>(source, sink, 64, BackpressurePolicy::Block);
+
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 2000;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([source] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                source->push(i);
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    ASSERT_TRUE(waitUntil([&] { return seen.load() == kProducers * kPerProducer; }));
+    EXPECT_FALSE(overlapped.load());
+}
+
+TEST(PipelineTest, DisabledEdgeNeverRunsItsConsumer) {
+    ThreadPool pool(2);
+    Pipeline pipeline(pool);
+    Collected gated;
+    Collected raw;
+    auto* source = pipeline.addSource<int>("source");
+    auto* gatedSink = pipeline.addSink<int>("gated", [&gated](const int& v) { gated.add(v); });
+    auto* rawSink = pipeline.addSink<int>("raw", [&raw](const int& v) { raw.add(v); });
+    auto* edge = pipeline.connect<int>(source, gatedSink, 16);
+    pipeline.connect<int>(source, rawSink, 16);
+
+    edge->setEnabled(false);
+    for (int i = 0; i < 5; ++i) {
+        source->push(i);
+    }
+    ASSERT_TRUE(waitUntil([&raw] { return raw.size() == 5; }));
+    edge->setEnabled(true);
+    source->push(5);
+    ASSERT_TRUE(waitUntil([&raw] { return raw.size() == 6; }));
+    ASSERT_TRUE(waitUntil([&gated] { return gated.size() == 1; }));
+    pipeline.stop();
+
+    EXPECT_EQ(gated.values(), (std::vector<int>{5}));
+    const auto stats = pipeline.getStats();
+    EXPECT_EQ(statsOf(stats, "gated").runs, 1);
+    EXPECT_EQ(statsOf(stats, "gated").dropped, 0);
+}
+
+TEST(PipelineTest, AnalysisPoolOutlastsEveryFullAnalysisEdge) {
+    // Each analysis edge full of frames of its own while its consumer is
+    // stalled: the pool still has a buffer for every other holder
+    FramePool frames(64, 48, analysis::kPoolCapacity);
+    ThreadPool pool(1);
+    Pipeline pipeline(pool);
+    BusyWorker busy;
+    busy.occupy(pool);
+    size_t edgeFrames = 0;
+    for (const size_t capacity : {analysis::kBlurGateEdgeCapacity, analysis::kFrameQualityEdgeCapacity,
+                                  analysis::kSnapshotEdgeCapacity, analysis::kPreTriggerEdgeCapacity,
+                                  analysis::kExportFramesEdgeCapacity, analysis::kRectifyEdgeCapacity,
+                                  analysis::kStereoEdgeCapacity}) {
+        auto* source = pipeline.addSource<FrameRef>("source");
+        auto* sink = pipeline.addSink<FrameRef>("sink", [](const FrameRef&) {});
+        pipeline.connect<FrameRef>(source, sink, capacity);
+        // Twice over, so the later pushes evict
+        for (size_t i = 0; i < 2 * boundedQueueCapacity(capacity); ++i) {
+            FrameRef frame = frames.acquire();
+            ASSERT_TRUE(frame);
+            source->push(frame);
+        }
+        edgeFrames += boundedQueueCapacity(capacity);
+    }
+    EXPECT_EQ(edgeFrames, analysis::kEdgeFrames);
+    EXPECT_EQ(frames.available(), analysis::kPoolCapacity - analysis::kEdgeFrames);
+
+    std::vector<FrameRef> others;
+    for (size_t i = 0; i < analysis::kEvictedFrames + analysis::kOtherFrames; ++i) {
+        others.push_back(frames.acquire());
+        ASSERT_TRUE(others.back()) << i;
+    }
+    others.clear();
+    busy.release();
+    pipeline.stop();
+}
+
+/// Push 0..9 through a 4-slot edge while its consumer's only worker is busy
+std::vector<int> pushWhileStalled(BackpressurePolicy policy, int64_t& dropped) {
+    ThreadPool pool(1);
+    Pipeline pipeline(pool);
+    Collected collected;
+    auto* source = pipeline.addSource<int>("source");
+    auto* sink = pipeline.addSink<int>("sink", [&collected](const int& v) { collected.add(v); });
+    pipeline.connect<int>(source, sink, 4, policy);
+
+    BusyWorker busy;
+    busy.occupy(pool);
+    for (int i = 0; i < 10; ++i) {
+        source->push(i);
+    }
+    EXPECT_EQ(pipeline.getStats()[1].queued, 4);
+    busy.release();
+    EXPECT_TRUE(waitUntil([&collected] { return collected.size() == 4; }));
+    pipeline.stop();
+    dropped = pipeline.getStats()[1].dropped;
+    return collected.values();
+}
+
+TEST(PipelineTest, DropNewestKeepsTheFirstItems) {
+    int64_t dropped = 0;
+    EXPECT_EQ(pushWhileStalled(BackpressurePolicy::DropNewest, dropped), (std::vector<int>{0, 1, 2, 3}));
+    EXPECT_EQ(dropped, 6);
+}
+
+TEST(PipelineTest, DropOldestKeepsTheLatestItems) {
+    int64_t dropped = 0;
+    EXPECT_EQ(pushWhileStalled(BackpressurePolicy::DropOldest, dropped), (std::vector<int>{6, 7, 8, 9}));
+    EXPECT_EQ(dropped, 6);
+}
+
+TEST(PipelineTest, BlockWaitsForSpaceAndDropsNothing) {
+    ThreadPool pool(1);
+    Pipeline pipeline(pool);
+    Collected collected;
+    auto* source = pipeline.addSource<int>("source");
+    auto* sink = pipeline.addSink<int>("sink", [&collected](const int& v) { collected.add(v); });
+    pipeline.connect<int>(source, sink, 4, BackpressurePolicy::Block);
+
+    BusyWorker busy;
+    busy.occupy(pool);
+    std::atomic<int> pushed{0};
+    std::thread producer([&] {
+        for (int i = 0; i < 10; ++i) {
+            source->push(i);
+            pushed.fetch_add(1, std::memory_order_release);
+        }
+    });
+    // The producer fills the edge, then waits on the stalled consumer
+    ASSERT_TRUE(waitUntil([&pushed] { return pushed.load(std::memory_order_acquire) == 4; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(pushed.load(std::memory_order_acquire), 4);
+
+    busy.release();
+    producer.join();
+    ASSERT_TRUE(waitUntil([&collected] { return collected.size() == 10; }));
+    pipeline.stop();
+    EXPECT_EQ(collected.values(), (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    EXPECT_EQ(pipeline.getStats()[1].dropped, 0);
+}
+
+TEST(PipelineTest, StopWaitsForRunsAndSchedulesNoMore) {
+    ThreadPool pool(2);
+    Pipeline pipeline(pool);
+    std::atomic<bool> inSink{false};
+    std::atomic<bool> finishSink{false};
+    std::atomic<int> seen{0};
+    auto* source = pipeline.addSource<int>("source");
+    auto* sink = pipeline.addSink<int>("sink", [&](const int&) {
+        inSink.store(true, std::memory_order_release);
+        waitUntil([&finishSink] { return finishSink.load(std::memory_order_acquire); });
+        seen.fetch_add(1, std::memory_order_acq_rel);
+    });
+    pipeline.connect<int>(source, sink, 16);
+
+    source->push(1);
+    ASSERT_TRUE(waitUntil([&inSink] { return inSink.load(std::memory_order_acquire); }));
+    std::atomic<bool> stopped{false};
+    std::thread stopper([&] {
+        pipeline.stop();
+        stopped.store(true, std::memory_order_release);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(stopped.load(std::memory_order_acquire));  // The run is still in flight
+    finishSink.store(true, std::memory_order_release);
+    stopper.join();
+    EXPECT_EQ(seen.load(), 1);
+
+    source->push(2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(seen.load(), 1);
+    EXPECT_EQ(pipeline.getStats()[1].queued, 1);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,152 @@
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "geometry.h"
+#include "pose_predictor.h"
+#include "time_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr int64_t kGyroPeriodNs = 2'500'000;     // 400 Hz
+constexpr TimestampNs kStartNs = kNsPerSecond;
+
+ImuSample gyro(TimestampNs timestampNs, const Vec3& omega) {
+    return {omega.x, omega.y, omega.z, timestampNs, SensorType::Gyroscope};
+}
+
+/// Angle between two orientations; the log map keeps precision at small angles
+float angleError(const Quat& a, const Quat& b) {
+    return norm(quat::toRotationVector(conjugate(a) * b));
+}
+
+float seconds(int64_t ns) {
+    return static_cast<float>(ns) / static_cast<float>(kNsPerSecond);
+}
+
+/// Feed `count` gyro samples at 400 Hz from kStartNs; returns the last timestamp
+template<typename Rate>
+TimestampNs feed(PosePredictor& predictor, int count, Rate rate) {
+    TimestampNs timestampNs = kStartNs;
+    for (int i = 0; i < count; ++i) {
+        timestampNs = kStartNs + i * kGyroPeriodNs;
+        predictor.addSample(gyro(timestampNs, rate(seconds(timestampNs - kStartNs))));
+    }
+    return timestampNs;
+}
+
+TEST(PosePredictorTest, InvalidUntilTheFirstGyroSample) {
+    PosePredictor predictor;
+    EXPECT_FALSE(predictor.predictPose(kStartNs).valid);
+    predictor.addSample({0.0f, 0.0f, 9.81f, kStartNs, SensorType::Accelerometer});
+    EXPECT_FALSE(predictor.predictPose(kStartNs).valid);
+
+    predictor.addSample(gyro(kStartNs, {0.0f, 0.0f, 1.0f}));
+    const PredictedPose pose = predictor.predictPose(kStartNs);
+    ASSERT_TRUE(pose.valid);
+    EXPECT_EQ(pose.sourceNs, kStartNs);
+    EXPECT_EQ(pose.targetNs, kStartNs);
+    EXPECT_LT(angleError(pose.orientation, Quat::identity()), 1e-3f);
+
+    predictor.reset();
+    EXPECT_FALSE(predictor.predictPose(kStartNs).valid);
+}
+
+// Constant rate about a tilted axis: integration and extrapolation are exact
+TEST(PosePredictorTest, ExtrapolatesAConstantRateRotation) {
+    PosePredictor predictor;
+    const Vec3 omega = normalized(Vec3(1.0f, -2.0f, 2.0f)) * 1.5f;
+    const TimestampNs lastNs = feed(predictor, 401, [&omega](float) { return omega; });
+    ASSERT_EQ(lastNs, kStartNs + kNsPerSecond);
+
+    for (const int64_t horizonNs : {int64_t{0}, 20 * kNsPerMs, 50 * kNsPerMs}) {
+        const PredictedPose pose = predictor.predictPose(lastNs + horizonNs);
+        ASSERT_TRUE(pose.valid);
+        EXPECT_EQ(pose.sourceNs, lastNs);
+        const Quat expected = quat::fromRotationVector(omega * (1.0f + seconds(horizonNs)));
+        EXPECT_LT(angleError(pose.orientation, expected), 2e-3f) << horizonNs;
+        EXPECT_NEAR(pose.angularVelocity[0], omega.x, 1e-4f);
+        EXPECT_NEAR(pose.angularVelocity[1], omega.y, 1e-4f);
+        EXPECT_NEAR(pose.angularVelocity[2], omega.z, 1e-4f);
+    }
+}
+
+// Constant angular acceleration about z: the second-order term predicts
+// the rate, and the orientation, at the target time
+TEST(PosePredictorTest, ExtrapolatesAngularAcceleration) {
+    PosePredictor predictor;
+    constexpr float kAccel = 4.0f;     // rad/s^2
+    const TimestampNs lastNs = feed(predictor, 201, [](float t) { return Vec3(0.0f, 0.0f, kAccel * t); });
+    const float t = seconds(lastNs - kStartNs);
+
+    const int64_t horizonNs = 30 * kNsPerMs;
+    const float h = seconds(horizonNs);
+    const PredictedPose pose = predictor.predictPose(lastNs + horizonNs);
+    EXPECT_NEAR(pose.angularVelocity[2], kAccel * (t + h), 1e-2f);
+    const float angle = 0.5f * kAccel * (t + h) * (t + h);
+    EXPECT_LT(angleError(pose.orientation, quat::fromRotationVector({0.0f, 0.0f, angle})), 2e-3f);
+
+    // First order only would lag by a * h^2 / 2 in angle and a * h in rate
+    PosePredictor firstOrder(PosePredictorConfig{100'000'000, 100'000'000, 0.0f, 100.0f});
+    feed(firstOrder, 201, [](float s) { return Vec3(0.0f, 0.0f, kAccel * s); });
+    EXPECT_NEAR(firstOrder.predictPose(lastNs + horizonNs).angularVelocity[2], kAccel * t, 1e-3f);
+}
+
+TEST(PosePredictorTest, ClampsHorizonAndRestartsAfterGaps) {
+    PosePredictorConfig config;
+    PosePredictor predictor(config);
+    const Vec3 omega(0.0f, 1.0f, 0.0f);
+    const TimestampNs lastNs = feed(predictor, 41, [&omega](float) { return omega; });  // 0.1 s
+
+    // Far-future targets stop at the horizon
+    const PredictedPose clamped = predictor.predictPose(lastNs + 10 * kNsPerSecond);
+    const PredictedPose horizon = predictor.predictPose(lastNs + config.maxHorizonNs);
+    EXPECT_LT(angleError(clamped.orientation, horizon.orientation), 1e-4f);
+    EXPECT_EQ(clamped.targetNs, lastNs + 10 * kNsPerSecond);
+
+    // Stale and duplicate samples are ignored
+    predictor.addSample(gyro(lastNs, {5.0f, 0.0f, 0.0f}));
+    predictor.addSample(gyro(lastNs - kGyroPeriodNs, {5.0f, 0.0f, 0.0f}));
+    EXPECT_NEAR(predictor.predictPose(lastNs).angularVelocity[0], 0.0f, 1e-6f);
+
+    // After a long gap integration restarts from the kept orientation: no
+    // rotation is integrated across the gap
+    const Quat before = predictor.predictPose(lastNs).orientation;
+    const TimestampNs resumedNs = lastNs + 2 * config.maxGapNs;
+    predictor.addSample(gyro(resumedNs, {0.0f, 0.0f, 2.0f}));
+    const PredictedPose resumed = predictor.predictPose(resumedNs);
+    EXPECT_EQ(resumed.sourceNs, resumedNs);
+    EXPECT_LT(angleError(resumed.orientation, before), 1e-3f);
+    EXPECT_NEAR(resumed.angularVelocity[2], 2.0f, 1e-6f);
+}
+
+TEST(PosePredictorTest, QueriesRacingTheProducerStayConsistent) {
+    PosePredictor predictor;
+    std::atomic<bool> done{false};
+    std::atomic<int> bad{0};
+    std::thread reader([&] {
+        TimestampNs lastSourceNs = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            const PredictedPose pose = predictor.predictPose(kStartNs + 5 * kNsPerSecond);
+            if (!pose.valid) {
+                continue;
+            }
+            if (std::fabs(dot(pose.orientation, pose.orientation) - 1.0f) > 1e-3f ||
+                pose.sourceNs < lastSourceNs || std::fabs(pose.angularVelocity[1] - 0.5f) > 1e-3f) {
+                bad.fetch_add(1, std::memory_order_relaxed);
+            }
+            lastSourceNs = pose.sourceNs;
+        }
+    });
+    feed(predictor, 20'000, [](float) { return Vec3(0.0f, 0.5f, 0.0f); });
+    done.store(true, std::memory_order_release);
+    reader.join();
+    EXPECT_EQ(bad.load(), 0);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,332 @@
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "frame_pool.h"
+#include "pre_trigger_buffer.h"
+#include "recording_format.h"
+#include "recording_writer.h"
+#include "test_utils.h"
+#include "time_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr TimestampNs kStartNs = 10 * kNsPerSecond;
+constexpr int64_t kImuPeriodNs = 10'000'000;    // 100 Hz per sensor
+constexpr int64_t kFramePeriodNs = 50'000'000;  // 20 fps
+
+struct Record {
+    recording::RecordHeader header{};
+    std::vector<uint8_t> payload;
+};
+
+struct Recording {
+    recording::RecordingHeader header{};
+    std::vector<Record> records;
+};
+
+bool exists(const std::string& path) {
+    struct stat info{};
+    return ::stat(path.c_str(), &info) == 0;
+}
+
+/// Parse a .nsrec file; fails on a bad header or a truncated record
+::testing::AssertionResult readRecording(const std::string& path, Recording& out) {
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    if (bytes.size() < sizeof(out.header)) {
+        return ::testing::AssertionFailure() << path << ": " << bytes.size() << " bytes";
+    }
+    std::memcpy(&out.header, bytes.data(), sizeof(out.header));
+    if (std::memcmp(out.header.magic, recording::kMagic, sizeof(recording::kMagic)) != 0 ||
+        out.header.version != recording::kFormatVersion || out.header.headerSize != sizeof(out.header)) {
+        return ::testing::AssertionFailure() << "bad recording header";
+    }
+    out.records.clear();
+    for (size_t offset = sizeof(out.header); offset < bytes.size();) {
+        Record record;
+        if (offset + sizeof(record.header) > bytes.size()) {
+            return ::testing::AssertionFailure() << "truncated record header at " << offset;
+        }
+        std::memcpy(&record.header, &bytes[offset], sizeof(record.header));
+        offset += sizeof(record.header);
+        if (offset + record.header.payloadSize > bytes.size()) {
+            return ::testing::AssertionFailure() << "truncated payload at " << offset;
+        }
+        record.payload.assign(bytes.begin() + static_cast<ptrdiff_t>(offset),
+                              bytes.begin() + static_cast<ptrdiff_t>(offset + record.header.payloadSize));
+        offset += record.header.payloadSize;
+        out.records.push_back(std::move(record));
+    }
+    if (out.records.size() != out.header.recordCount) {
+        return ::testing::AssertionFailure() << out.records.size() << " records, header says "
+                                             << out.header.recordCount;
+    }
+    return ::testing::AssertionSuccess();
+}
+
+recording::ImuRecord imuRecord(const Record& record) {
+    recording::ImuRecord imu{};
+    std::memcpy(&imu, record.payload.data(), sizeof(imu));
+    return imu;
+}
+
+recording::FrameRecord frameRecord(const Record& record, std::string* cameraId = nullptr) {
+    recording::FrameRecord frame{};
+    std::memcpy(&frame, record.payload.data(), sizeof(frame));
+    if (cameraId) {
+        cameraId->assign(reinterpret_cast<const char*>(record.payload.data() + sizeof(frame)), frame.cameraIdLength);
+    }
+    return frame;
+}
+
+TEST(RecordingWriterTest, WritesHeaderAndRecordsAndPublishesOnFinish) {
+    TempDir dir;
+    const std::string path = dir.path() + "/capture.nsrec";
+    RecordingWriter writer;
+    ASSERT_TRUE(writer.open(path, 100, 900, 900));
+    ASSERT_TRUE(writer.writeImu({1.0f, 2.0f, 3.0f, 200, SensorType::Gyroscope}));
+
+    // 3x2 pixels out of a stride-4 buffer
+    const uint8_t pixels[8] = {1, 2, 3, 99, 4, 5, 6, 99};
+    FrameMetadata metadata;
+    metadata.cameraId = "front";
+    metadata.timestampNs = 300;
+    metadata.frameNumber = 7;
+    metadata.exposureTimeNs = 5'000;
+    metadata.width = 12;
+    metadata.height = 8;
+    ASSERT_TRUE(writer.writeFrame(metadata, pixels, 3, 2, 4));
+    EXPECT_EQ(writer.recordCount(), 2u);
+    EXPECT_FALSE(exists(path));
+    ASSERT_TRUE(writer.finish());
+    EXPECT_FALSE(exists(path + ".tmp"));
+
+    Recording recording;
+    ASSERT_TRUE(readRecording(path, recording));
+    EXPECT_EQ(recording.header.startNs, 100);
+    EXPECT_EQ(recording.header.endNs, 900);
+    EXPECT_EQ(recording.header.triggerNs, 900);
+    ASSERT_EQ(recording.records.size(), 2u);
+
+    const Record& imu = recording.records[0];
+    EXPECT_EQ(imu.header.type, recording::RecordType::Imu);
+    EXPECT_EQ(imu.header.timestampNs, 200);
+    EXPECT_EQ(imuRecord(imu).sensorType, static_cast<int32_t>(SensorType::Gyroscope));
+    EXPECT_FLOAT_EQ(imuRecord(imu).z, 3.0f);
+
+    const Record& frame = recording.records[1];
+    EXPECT_EQ(frame.header.type, recording::RecordType::Frame);
+    std::string cameraId;
+    const recording::FrameRecord fixed = frameRecord(frame, &cameraId);
+    EXPECT_EQ(cameraId, "front");
+    EXPECT_EQ(fixed.frameNumber, 7);
+    EXPECT_EQ(fixed.width, 3);
+    EXPECT_EQ(fixed.sourceWidth, 12);
+    ASSERT_EQ(frame.payload.size(), sizeof(fixed) + cameraId.size() + 6);
+    const std::vector<uint8_t> packed(frame.payload.end() - 6, frame.payload.end());
+    EXPECT_EQ(packed, (std::vector<uint8_t>{1, 2, 3, 4, 5, 6}));
+    EXPECT_EQ(writer.bytesWritten(), sizeof(recording.header) + 2 * sizeof(recording::RecordHeader) +
+                                         imu.payload.size() + frame.payload.size());
+}
+
+TEST(RecordingWriterTest, UnfinishedRecordingsLeaveNothingBehind) {
+    TempDir dir;
+    const std::string path = dir.path() + "/capture.nsrec";
+    {
+        RecordingWriter writer;
+        ASSERT_TRUE(writer.open(path, 0, 1));
+        ASSERT_TRUE(writer.writeImu({0.0f, 0.0f, 9.8f, 1, SensorType::Accelerometer}));
+        EXPECT_TRUE(exists(path + ".tmp"));
+    }
+    EXPECT_FALSE(exists(path + ".tmp"));
+    EXPECT_FALSE(exists(path));
+
+    RecordingWriter writer;
+    EXPECT_FALSE(writer.open(dir.path() + "/missing/capture.nsrec", 0, 1));
+    EXPECT_FALSE(writer.writeImu({0.0f, 0.0f, 9.8f, 1, SensorType::Accelerometer}));
+    EXPECT_FALSE(writer.finish());
+}
+
+class PreTriggerBufferTest : public ::testing::Test {
+protected:
+    static constexpr int32_t kCameraWidth = 64;
+    static constexpr int32_t kCameraHeight = 48;
+
+    PreTriggerBufferTest() : frames_(kCameraWidth, kCameraHeight, 4) {}
+
+    static PreTriggerConfig config() {
+        PreTriggerConfig c;
+        c.windowNs = kNsPerSecond;
+        c.imuCapacity = 1024;
+        c.frameIntervalNs = 200'000'000;
+        c.maxFrameWidth = 32;
+        c.maxFrameHeight = 32;
+        return c;
+    }
+
+    /// Accel and gyro at 100 Hz each over [fromNs, toNs); x carries the time in ms
+    static void feedImu(PreTriggerBuffer& buffer, TimestampNs fromNs, TimestampNs toNs) {
+        for (TimestampNs t = fromNs; t < toNs; t += kImuPeriodNs) {
+            const auto ms = static_cast<float>(t / 1'000'000);
+            buffer.addImuSample({ms, 0.0f, 9.8f, t, SensorType::Accelerometer});
+            buffer.addImuSample({ms, 0.0f, 0.0f, t + 1, SensorType::Gyroscope});
+        }
+    }
+
+    /// Analysis frames at 20 fps; each aligned 2x2 block averages to one value
+    void feedFrames(PreTriggerBuffer& buffer, const std::string& cameraId, TimestampNs fromNs, TimestampNs toNs) {
+        for (TimestampNs t = fromNs; t < toNs; t += kFramePeriodNs) {
+            FrameRef frame = frames_.acquire();
+            ASSERT_TRUE(frame);
+            for (int32_t y = 0; y < kCameraHeight; ++y) {
+                for (int32_t x = 0; x < kCameraWidth; ++x) {
+                    frame->row(y)[x] = static_cast<uint8_t>((x / 2) * 4 + (y / 2) + ((x + y) & 1));
+                }
+            }
+            frame->metadata.cameraId = cameraId;
+            frame->metadata.timestampNs = t;
+            frame->metadata.frameNumber = (t - fromNs) / kFramePeriodNs;
+            buffer.addFrame(frame);
+        }
+    }
+
+    TempDir dir_;
+    FramePool frames_;
+};
+
+TEST_F(PreTriggerBufferTest, WritesTheWindowBeforeTheTriggerMergedInTimeOrder) {
+    PreTriggerBuffer buffer(config());
+    const TimestampNs triggerNs = kStartNs + 2 * kNsPerSecond;
+    feedImu(buffer, kStartNs, triggerNs + 1);
+    feedFrames(buffer, "0", kStartNs, triggerNs + 1);
+    feedFrames(buffer, "1", kStartNs + 25'000'000, triggerNs + 1);
+
+    const std::string path = dir_.path() + "/trigger.nsrec";
+    ASSERT_TRUE(buffer.trigger(path, triggerNs));
+    ASSERT_TRUE(waitUntil([&] { return buffer.getStats().written == 1; }));
+
+    Recording recording;
+    ASSERT_TRUE(readRecording(path, recording));
+    EXPECT_EQ(recording.header.startNs, triggerNs - kNsPerSecond);
+    EXPECT_EQ(recording.header.triggerNs, triggerNs);
+
+    int64_t imuCount = 0;
+    int64_t frameCount = 0;
+    TimestampNs previousNs = 0;
+    for (const Record& record : recording.records) {
+        const TimestampNs t = record.header.timestampNs;
+        EXPECT_GE(t, triggerNs - kNsPerSecond);
+        EXPECT_LE(t, triggerNs);
+        EXPECT_GE(t, previousNs);
+        previousNs = t;
+        if (record.header.type == recording::RecordType::Imu) {
+            ++imuCount;
+            EXPECT_FLOAT_EQ(imuRecord(record).x, static_cast<float>(t / 1'000'000));
+            continue;
+        }
+        ++frameCount;
+        std::string cameraId;
+        const recording::FrameRecord frame = frameRecord(record, &cameraId);
+        // 64x48 into 32x32: halved, with the source size kept
+        EXPECT_EQ(frame.width, 32);
+        EXPECT_EQ(frame.height, 24);
+        EXPECT_EQ(frame.sourceWidth, kCameraWidth);
+        EXPECT_EQ(frame.sourceHeight, kCameraHeight);
+        const uint8_t* pixels = record.payload.data() + sizeof(frame) + cameraId.size();
+        EXPECT_EQ(pixels[5 * 32 + 7], 7 * 4 + 5 + 1) << cameraId;   // 2x2 box average, rounded
+    }
+    // [1 s, 2 s] of both 100 Hz sensors (the gyro at exactly 2 s is 1 ns late)
+    EXPECT_EQ(imuCount, 2 * 100 + 1);
+    // One frame per camera every 200 ms: 1.0, 1.2, ... 2.0 and 1.025, ... 1.825
+    EXPECT_EQ(frameCount, 6 + 5);
+
+    const PreTriggerStats stats = buffer.getStats();
+    EXPECT_EQ(stats.lastImuSamples, imuCount);
+    EXPECT_EQ(stats.lastFrames, frameCount);
+    EXPECT_EQ(stats.droppedFrames, 0);
+}
+
+TEST_F(PreTriggerBufferTest, KeepsOnlySamplesTheRingStillHolds) {
+    PreTriggerConfig c = config();
+    c.imuCapacity = 100;
+    PreTriggerBuffer buffer(c);
+    feedImu(buffer, kStartNs, kStartNs + kNsPerSecond);     // 200 samples
+
+    const std::string path = dir_.path() + "/trigger.nsrec";
+    ASSERT_TRUE(buffer.trigger(path, kStartNs + kNsPerSecond));
+    ASSERT_TRUE(waitUntil([&] { return buffer.getStats().written == 1; }));
+
+    Recording recording;
+    ASSERT_TRUE(readRecording(path, recording));
+    // The oldest slot may be mid-write when the ring is full, so it's left out
+    ASSERT_EQ(recording.records.size(), 99u);
+    EXPECT_EQ(recording.records.front().header.timestampNs, kStartNs + 50 * kImuPeriodNs + 1);
+    EXPECT_EQ(recording.records.back().header.timestampNs, kStartNs + 99 * kImuPeriodNs + 1);
+}
+
+TEST_F(PreTriggerBufferTest, RejectsTriggersWhileAWindowIsBeingWritten) {
+    PreTriggerBuffer buffer(config());
+    feedImu(buffer, kStartNs, kStartNs + kNsPerSecond);
+
+    // A FIFO in place of the temp file blocks the dump until it is read
+    const std::string path = dir_.path() + "/blocked.nsrec";
+    ASSERT_EQ(::mkfifo((path + ".tmp").c_str(), 0600), 0);
+    ASSERT_TRUE(buffer.trigger(path, kStartNs + kNsPerSecond));
+    EXPECT_FALSE(buffer.trigger(dir_.path() + "/second.nsrec", kStartNs + kNsPerSecond));
+
+    const int fd = ::open((path + ".tmp").c_str(), O_RDONLY | O_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    uint8_t chunk[4096];
+    while (::read(fd, chunk, sizeof(chunk)) > 0) {
+    }
+    ::close(fd);
+    // A pipe can't be synced: the window fails and the next trigger is taken
+    ASSERT_TRUE(waitUntil([&] { return buffer.getStats().failed == 1; }));
+    EXPECT_FALSE(exists(path));
+    ASSERT_TRUE(waitUntil([&] { return buffer.trigger(dir_.path() + "/third.nsrec", kStartNs + kNsPerSecond); }));
+    ASSERT_TRUE(waitUntil([&] { return buffer.getStats().written == 1; }));
+
+    const PreTriggerStats stats = buffer.getStats();
+    EXPECT_GE(stats.triggers, 3);
+    EXPECT_EQ(stats.rejected, stats.triggers - 2);
+}
+
+TEST_F(PreTriggerBufferTest, CameraSizeChangesStartANewRing) {
+    PreTriggerBuffer buffer(config());
+    feedFrames(buffer, "0", kStartNs, kStartNs + 500'000'000);
+
+    // Same camera at a size that fits as is
+    FramePool small(24, 16, 2);
+    FrameRef frame = small.acquire();
+    for (int32_t y = 0; y < 16; ++y) {
+        std::fill_n(frame->row(y), 24, uint8_t{77});
+    }
+    frame->metadata.cameraId = "0";
+    frame->metadata.timestampNs = kStartNs + 600'000'000;
+    buffer.addFrame(frame);
+    frame.reset();
+
+    const std::string path = dir_.path() + "/trigger.nsrec";
+    ASSERT_TRUE(buffer.trigger(path, kStartNs + kNsPerSecond));
+    ASSERT_TRUE(waitUntil([&] { return buffer.getStats().written == 1; }));
+    Recording recording;
+    ASSERT_TRUE(readRecording(path, recording));
+    ASSERT_EQ(recording.records.size(), 1u);
+    const recording::FrameRecord fixed = frameRecord(recording.records[0]);
+    EXPECT_EQ(fixed.width, 24);
+    EXPECT_EQ(fixed.sourceWidth, 24);
+    EXPECT_EQ(recording.records[0].payload.back(), 77);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
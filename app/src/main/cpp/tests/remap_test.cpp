@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "calibration_store.h"
+#include "remap.h"
+
+namespace nativesensor::testing {
+namespace {
+
+/// White noise: the worst case for interpolation error
+std::vector<uint8_t> noiseImage(int32_t stride, int32_t height, uint32_t seed) {
+    std::vector<uint8_t> image(static_cast<size_t>(stride) * static_cast<size_t>(height));
+    for (auto& pixel : image) {
+        seed = seed * 1664525u + 1013904223u;
+        pixel = static_cast<uint8_t>(seed >> 24);
+    }
+    return image;
+}
+
+CameraCalibration distortedCamera() {
+    CameraCalibration c;
+    c.fx = 300.0f;
+    c.fy = 300.0f;
+    c.cx = 161.3f;
+    c.cy = 118.7f;
+    c.distortion[0] = 0.25f;
+    c.distortion[1] = 0.07f;
+    c.distortion[3] = 0.002f;
+    c.distortion[4] = -0.001f;
+    c.activeArrayWidth = 320;
+    c.activeArrayHeight = 240;
+    c.hasIntrinsics = true;
+    c.hasDistortion = true;
+    return c;
+}
+
+/// Map sampling the source at (x + dx, y + dy)
+UndistortionMap shiftMap(int32_t width, int32_t height, float dx, float dy) {
+    UndistortionMap map;
+    map.width = width;
+    map.height = height;
+    map.coords.resize(2 * static_cast<size_t>(width) * static_cast<size_t>(height));
+    for (int32_t y = 0; y < height; ++y) {
+        for (int32_t x = 0; x < width; ++x) {
+            float* p = &map.coords[2 * (static_cast<size_t>(y) * static_cast<size_t>(width) + static_cast<size_t>(x))];
+            p[0] = static_cast<float>(x) + dx;
+            p[1] = static_cast<float>(y) + dy;
+        }
+    }
+    return map;
+}
+
+TEST(RemapTest, FixedPointMatchesTheFloatReference) {
+    // Odd width and padded rows exercise the vector tail and the stride
+    constexpr int32_t kWidth = 317;
+    constexpr int32_t kHeight = 240;
+    constexpr int32_t kStride = 384;
+    CameraCalibration calibration = distortedCamera();
+    calibration.activeArrayWidth = kWidth;
+    const auto map = buildUndistortionMap(calibration, kWidth, kHeight);
+    ASSERT_NE(map, nullptr);
+    const std::vector<uint8_t> src = noiseImage(kStride, kHeight, 7);
+    const RemapTable table = buildRemapTable(*map, kWidth, kHeight, kStride);
+
+    std::vector<uint8_t> fixed(static_cast<size_t>(kStride) * kHeight, 0xAA);
+    std::vector<uint8_t> reference(static_cast<size_t>(kStride) * kHeight, 0xAA);
+    remap(table, src.data(), fixed.data(), kStride);
+    remapFloat(*map, src.data(), kWidth, kHeight, kStride, reference.data(), kStride);
+
+    // 7-bit fractions are within 1/256 px of the float position: at most one
+    // gray level on a full-range edge, plus rounding
+    int maxError = 0;
+    int64_t totalError = 0;
+    int masked = 0;
+    for (int32_t y = 0; y < kHeight; ++y) {
+        for (int32_t x = 0; x < kWidth; ++x) {
+            const size_t i = static_cast<size_t>(y) * kStride + static_cast<size_t>(x);
+            const int error = std::abs(fixed[i] - reference[i]);
+            maxError = std::max(maxError, error);
+            totalError += error;
+            masked += table.mask[static_cast<size_t>(y) * kWidth + static_cast<size_t>(x)] == 0;
+        }
+        // Padding past the output width is never written
+        EXPECT_EQ(fixed[static_cast<size_t>(y) * kStride + kWidth], 0xAA);
+    }
+    EXPECT_LE(maxError, 2);
+    EXPECT_LT(static_cast<double>(totalError) / (kWidth * kHeight), 0.5);
+    // Pincushion distortion: the corners of the ideal image fall outside the sensor
+    EXPECT_GT(masked, 0);
+    EXPECT_EQ(fixed[0], 0);
+}
+
+TEST(RemapTest, WholePixelShiftIsExact) {
+    constexpr int32_t kWidth = 64;
+    constexpr int32_t kHeight = 32;
+    const std::vector<uint8_t> src = noiseImage(kWidth, kHeight, 3);
+    const UndistortionMap map = shiftMap(kWidth, kHeight, 3.0f, -2.0f);
+    const RemapTable table = buildRemapTable(map, kWidth, kHeight, kWidth);
+    std::vector<uint8_t> dst(src.size());
+    remap(table, src.data(), dst.data(), kWidth);
+
+    for (int32_t y = 0; y < kHeight; ++y) {
+        for (int32_t x = 0; x < kWidth; ++x) {
+            const size_t i = static_cast<size_t>(y * kWidth + x);
+            if (x + 3 < kWidth && y >= 2) {
+                ASSERT_EQ(dst[i], src[static_cast<size_t>((y - 2) * kWidth + x + 3)]) << x << "," << y;
+            } else {
+                ASSERT_EQ(dst[i], 0) << x << "," << y;
+            }
+        }
+    }
+}
+
+TEST(RemapTest, HalfPixelSlackAtTheBorderIsClamped) {
+    constexpr int32_t kWidth = 16;
+    constexpr int32_t kHeight = 8;
+    const std::vector<uint8_t> src(static_cast<size_t>(kWidth) * kHeight, 200);
+    RemapTable table;
+    resizeRemapTable(table, 4, 1, kWidth, kHeight, kWidth);
+    setRemapEntry(table, 0, -0.4f, 0.0f);
+    setRemapEntry(table, 1, static_cast<float>(kWidth) - 0.6f, 7.4f);
+    setRemapEntry(table, 2, -0.6f, 0.0f);
+    setRemapEntry(table, 3, 3.0f, 7.6f);
+    std::vector<uint8_t> dst(4, 1);
+    remap(table, src.data(), dst.data(), 4);
+    EXPECT_EQ(dst[0], 200);
+    EXPECT_EQ(dst[1], 200);
+    EXPECT_EQ(dst[2], 0);
+    EXPECT_EQ(dst[3], 0);
+}
+
+TEST(RemapTest, RowBandsComposeTheFullImage) {
+    constexpr int32_t kWidth = 96;
+    constexpr int32_t kHeight = 64;
+    const std::vector<uint8_t> src = noiseImage(kWidth, kHeight, 11);
+    const UndistortionMap map = shiftMap(kWidth, kHeight, 0.3f, 0.7f);
+    const RemapTable table = buildRemapTable(map, kWidth, kHeight, kWidth);
+
+    std::vector<uint8_t> whole(src.size());
+    std::vector<uint8_t> banded(src.size());
+    remap(table, src.data(), whole.data(), kWidth);
+    for (const auto& [begin, end] : {std::pair{-4, 10}, {10, 37}, {37, 80}}) {
+        remapRows(table, src.data(), banded.data(), kWidth, begin, end);
+    }
+    EXPECT_EQ(banded, whole);
+}
+
+TEST(RemapTest, TableScalesAMapToAnotherSourceSize) {
+    // A map for 64x32 applied to a 128x64 source samples twice as far
+    const UndistortionMap map = shiftMap(64, 32, 0.0f, 0.0f);
+    const RemapTable table = buildRemapTable(map, 128, 64, 128);
+    ASSERT_EQ(table.width, 64);
+    ASSERT_EQ(table.srcWidth, 128);
+    const size_t i = 5 * 64 + 9;
+    EXPECT_EQ(table.offsets[i], 10 * 128 + 18);
+    EXPECT_EQ(table.fracX[i], 0);
+    EXPECT_EQ(table.mask[i], 0xFF);
+
+    EXPECT_TRUE(buildRemapTable(map, 1, 64, 1).offsets.empty());
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
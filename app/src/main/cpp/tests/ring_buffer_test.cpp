@@ -0,0 +1,84 @@
+#include <cstdint>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "ring_buffer.h"
+
+namespace nativesensor {
+namespace {
+
+TEST(RingBufferTest, HoldsOneLessThanCapacity) {
+    RingBuffer<int, 8> buffer;
+    EXPECT_TRUE(buffer.empty());
+    for (int i = 0; i < 7; ++i) {
+        EXPECT_TRUE(buffer.push(i));
+    }
+    EXPECT_FALSE(buffer.push(7));
+    EXPECT_EQ(buffer.size(), 7u);
+
+    int value = -1;
+    for (int i = 0; i < 7; ++i) {
+        ASSERT_TRUE(buffer.pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(buffer.pop(value));
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(RingBufferTest, PushOverwriteDropsOldest) {
+    RingBuffer<int, 4> buffer;
+    for (int i = 0; i < 10; ++i) {
+        buffer.pushOverwrite(i);
+    }
+    EXPECT_EQ(buffer.size(), 3u);
+
+    int value = -1;
+    for (int expected : {7, 8, 9}) {
+        ASSERT_TRUE(buffer.pop(value));
+        EXPECT_EQ(value, expected);
+    }
+}
+
+TEST(RingBufferTest, ClearEmptiesAndStaysUsable) {
+    RingBuffer<int, 4> buffer;
+    buffer.push(1);
+    buffer.push(2);
+    buffer.clear();
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_TRUE(buffer.push(3));
+
+    int value = 0;
+    ASSERT_TRUE(buffer.pop(value));
+    EXPECT_EQ(value, 3);
+}
+
+// One producer and one consumer: every item arrives once, in order
+TEST(RingBufferTest, SpscTransfersEveryItemInOrder) {
+    constexpr uint64_t kItems = 200'000;
+    RingBuffer<uint64_t, 64> buffer;
+
+    std::thread producer([&buffer] {
+        for (uint64_t i = 1; i <= kItems; ++i) {
+            while (!buffer.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint64_t expected = 1;
+    uint64_t value = 0;
+    while (expected <= kItems) {
+        if (buffer.pop(value)) {
+            ASSERT_EQ(value, expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(buffer.empty());
+}
+
+}  // namespace
+}  // namespace nativesensor
@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "calibration_store.h"
+#include "frame_pool.h"
+#include "geometry.h"
+#include "gyro_history.h"
+#include "rolling_shutter.h"
+#include "thread_pool.h"
+#include "time_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr int32_t kWidth = 240;
+constexpr int32_t kHeight = 160;
+constexpr float kFocalPx = 200.0f;
+constexpr int64_t kPeriodNs = 1'000'000;        // 1 kHz gyro
+constexpr TimestampNs kFrameNs = kNsPerSecond;
+constexpr int64_t kExposureNs = 4'000'000;
+constexpr int64_t kSkewNs = 20'000'000;
+constexpr float kPanRate = 2.0f;                // rad/s about the camera's y axis
+
+float seconds(int64_t ns) {
+    return static_cast<float>(ns) * 1e-9f;
+}
+
+/// Angle between two rotation matrices; from the Frobenius distance, which
+/// (unlike acos of the trace) keeps its precision at small angles
+float angleBetween(const Mat3& a, const Mat3& b) {
+    float sum = 0.0f;
+    for (int i = 0; i < 3; ++i) {
+        const Vec3 d = a.col[i] - b.col[i];
+        sum += dot(d, d);
+    }
+    return 2.0f * std::asin(std::min(std::sqrt(sum / 8.0f), 1.0f));
+}
+
+std::vector<GyroReading> constantRate(const Vec3& rate, TimestampNs fromNs, TimestampNs toNs) {
+    std::vector<GyroReading> readings;
+    for (TimestampNs t = fromNs; t <= toNs; t += kPeriodNs) {
+        readings.push_back({t, rate});
+    }
+    return readings;
+}
+
+TEST(RowRotationsTest, ConstantRateRotatesRowsLinearlyAboutTheCenterRow) {
+    const Vec3 rate{0.3f, kPanRate, -0.5f};
+    const std::vector<GyroReading> readings = constantRate(rate, 0, 30 * kPeriodNs);
+    RowRotationTable table;
+    ASSERT_TRUE(computeRowRotations(readings, kPeriodNs, kSkewNs, kHeight, table));
+    ASSERT_EQ(table.rows.size(), static_cast<size_t>(kHeight));
+
+    const int32_t referenceRow = (kHeight - 1) / 2;
+    const auto rowNs = [](int32_t row) { return kPeriodNs + kSkewNs * row / (kHeight - 1); };
+    EXPECT_EQ(table.referenceNs, rowNs(referenceRow));
+    for (const int32_t row : {0, 17, referenceRow, 120, kHeight - 1}) {
+        const Mat3 expected = toMat3(quat::fromRotationVector(rate * seconds(rowNs(row) - table.referenceNs)));
+        EXPECT_LT(angleBetween(table.rows[static_cast<size_t>(row)], expected), 2e-4f) << row;
+    }
+    const float lastRowAngle = norm(rate) * seconds(rowNs(kHeight - 1) - table.referenceNs);
+    EXPECT_NEAR(table.maxAngleRad, lastRowAngle, 2e-4f);
+}
+
+TEST(RowRotationsTest, RejectsReadoutsItCantDescribe) {
+    const std::vector<GyroReading> readings = constantRate({0.0f, 1.0f, 0.0f}, 0, 30 * kPeriodNs);
+    RowRotationTable table;
+    EXPECT_FALSE(computeRowRotations({}, 0, kSkewNs, kHeight, table));
+    EXPECT_FALSE(computeRowRotations(readings, 0, 0, kHeight, table));
+    EXPECT_FALSE(computeRowRotations(readings, 0, kSkewNs, 1, table));
+}
+
+/// Undistorted pinhole camera mounted with the IMU's axes
+CameraInfo camera(const char* id, bool hasPose) {
+    CameraInfo info;
+    info.id = id;
+    CameraCalibration& c = info.calibration;
+    c.fx = kFocalPx;
+    c.fy = kFocalPx;
+    c.cx = 0.5f * kWidth;
+    c.cy = 0.5f * kHeight;
+    c.activeArrayWidth = kWidth;
+    c.activeArrayHeight = kHeight;
+    c.poseReference = LensPoseReference::Gyroscope;
+    c.hasIntrinsics = true;
+    c.hasPose = hasPose;
+    return info;
+}
+
+class RollingShutterCorrectorTest : public ::testing::Test {
+protected:
+    RollingShutterCorrectorTest() : store_("", "device"), pool_(2), frames_(kWidth, kHeight, 6) {
+        store_.update({camera("tracking", true), camera("unmounted", false)});
+        const Vec3 rate{0.0f, kPanRate, 0.0f};
+        for (TimestampNs t = kFrameNs - 10 * kPeriodNs; t <= kFrameNs + 40 * kPeriodNs; t += kPeriodNs) {
+            gyro_.addSample({rate.x, rate.y, rate.z, t, SensorType::Gyroscope});
+        }
+    }
+
+    /// Horizontal ramp: the value of a pixel is its column
+    FrameRef frame(const char* cameraId, int64_t skewNs = kSkewNs) {
+        FrameRef ref = frames_.acquire();
+        for (int32_t y = 0; y < kHeight; ++y) {
+            uint8_t* row = ref->row(y);
+            for (int32_t x = 0; x < kWidth; ++x) {
+                row[x] = static_cast<uint8_t>(x);
+            }
+        }
+        ref->metadata.cameraId = cameraId;
+        ref->metadata.timestampNs = kFrameNs;
+        ref->metadata.exposureTimeNs = kExposureNs;
+        ref->metadata.rollingShutterSkewNs = skewNs;
+        return ref;
+    }
+
+    GyroHistory gyro_;
+    CalibrationStore store_;
+    ThreadPool pool_;
+    FramePool frames_;
+};
+
+TEST_F(RollingShutterCorrectorTest, PointsMoveByTheRotationSinceTheirRow) {
+    RollingShutterCorrector corrector(gyro_, store_, pool_);
+    std::shared_ptr<const ShutterCorrectedFrame> out;
+    ASSERT_TRUE(corrector.process(frame("tracking"), out));
+    ASSERT_FALSE(out->rotations.empty());
+    EXPECT_FALSE(out->warped);
+    // Rows are read out from mid-exposure of the first row
+    EXPECT_EQ(out->rotations.referenceNs,
+              kFrameNs + kExposureNs / 2 + kSkewNs * ((kHeight - 1) / 2) / (kHeight - 1));
+
+    // A pan shifts points horizontally by f * angle, opposite for the first
+    // and last rows, not at all on the reference row
+    const float points[6] = {120.0f, 0.0f, 120.0f, 79.0f, 120.0f, 159.0f};
+    float corrected[6];
+    out->correctPoints(points, corrected, 3);
+    const float halfReadoutShift = kFocalPx * kPanRate * seconds(kSkewNs / 2);
+    EXPECT_NEAR(std::fabs(corrected[0] - points[0]), halfReadoutShift, 0.1f);
+    EXPECT_NEAR(corrected[2], points[2], 0.01f);
+    EXPECT_NEAR(corrected[4] - points[4], points[0] - corrected[0], 0.1f);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_NEAR(corrected[2 * i + 1], points[2 * i + 1], 0.05f) << i;
+    }
+
+    // In place gives the same answer
+    float inPlace[6] = {120.0f, 0.0f, 120.0f, 79.0f, 120.0f, 159.0f};
+    out->correctPoints(inPlace, inPlace, 3);
+    for (int i = 0; i < 6; ++i) {
+        EXPECT_FLOAT_EQ(inPlace[i], corrected[i]);
+    }
+}
+
+TEST_F(RollingShutterCorrectorTest, WarpAgreesWithPointCorrection) {
+    RollingShutterCorrector corrector(gyro_, store_, pool_);
+    std::shared_ptr<const ShutterCorrectedFrame> plain;
+    ASSERT_TRUE(corrector.process(frame("tracking"), plain));
+
+    corrector.setWarpEnabled(true);
+    std::shared_ptr<const ShutterCorrectedFrame> warped;
+    ASSERT_TRUE(corrector.process(frame("tracking"), warped));
+    ASSERT_TRUE(warped->warped);
+
+    // A point seen at p in the raw frame is at correctPoints(p) in the warped
+    // one; on the ramp its value is its source column
+    for (const float row : {4.0f, 40.0f, 79.0f, 120.0f, 155.0f}) {
+        for (const float column : {60.0f, 120.0f, 180.0f}) {
+            const float point[2] = {column, row};
+            float moved[2];
+            plain->correctPoints(point, moved, 1);
+            const auto x = static_cast<int32_t>(std::lround(moved[0]));
+            const auto y = static_cast<int32_t>(std::lround(moved[1]));
+            const float value = static_cast<float>(warped->frame->row(y)[x]);
+            EXPECT_NEAR(value, column + (static_cast<float>(x) - moved[0]), 1.0f) << column << "," << row;
+        }
+    }
+    // Points of a warped frame are already corrected
+    const float point[2] = {120.0f, 0.0f};
+    float same[2];
+    warped->correctPoints(point, same, 1);
+    EXPECT_FLOAT_EQ(same[0], point[0]);
+
+    const RollingShutterStats stats = corrector.getStats();
+    EXPECT_EQ(stats.corrected, 2);
+    EXPECT_EQ(stats.warped, 1);
+    EXPECT_FLOAT_EQ(stats.lastSkewMs, 20.0f);
+    EXPECT_NEAR(stats.lastMaxAngleDeg, kPanRate * seconds(kSkewNs / 2) * 57.29578f, 0.05f);
+}
+
+TEST_F(RollingShutterCorrectorTest, FramesWithoutSkewExtrinsicsOrGyroPassUncorrected) {
+    RollingShutterCorrector corrector(gyro_, store_, pool_);
+    std::shared_ptr<const ShutterCorrectedFrame> out;
+    ASSERT_TRUE(corrector.process(frame("tracking", 0), out));
+    EXPECT_TRUE(out->rotations.empty());
+    ASSERT_TRUE(corrector.process(frame("unmounted"), out));
+    EXPECT_TRUE(out->rotations.empty());
+
+    // Readout past the end of the gyro history
+    FrameRef late = frame("tracking");
+    late->metadata.timestampNs = kFrameNs + 60 * kPeriodNs;
+    ASSERT_TRUE(corrector.process(late, out));
+    EXPECT_TRUE(out->rotations.empty());
+
+    // Uncorrected points are copied as they are
+    const float point[2] = {10.0f, 0.0f};
+    float copy[2];
+    out->correctPoints(point, copy, 1);
+    EXPECT_FLOAT_EQ(copy[0], 10.0f);
+    EXPECT_EQ(corrector.getStats().uncorrected, 3);
+}
+
+TEST_F(RollingShutterCorrectorTest, DropsFramesWhileEveryOutputIsHeld) {
+    RollingShutterCorrector corrector(gyro_, store_, pool_);
+    std::vector<std::shared_ptr<const ShutterCorrectedFrame>> held;
+    std::shared_ptr<const ShutterCorrectedFrame> out;
+    while (corrector.process(frame("tracking"), out)) {
+        held.push_back(out);
+        out.reset();
+        ASSERT_LE(held.size(), 8u);
+    }
+    EXPECT_EQ(corrector.getStats().dropped, 1);
+
+    // Released outputs also release the frames they pinned
+    const size_t available = frames_.available();
+    held.clear();
+    EXPECT_TRUE(corrector.process(frame("tracking"), out));
+    EXPECT_GT(frames_.available(), available);
+}
+
+TEST_F(RollingShutterCorrectorTest, OutputsOutliveTheCorrector) {
+    std::shared_ptr<const ShutterCorrectedFrame> out;
+    {
+        RollingShutterCorrector corrector(gyro_, store_, pool_);
+        ASSERT_TRUE(corrector.process(frame("tracking"), out));
+    }
+    ASSERT_TRUE(out->frame);
+    EXPECT_EQ(out->frame->metadata.cameraId, "tracking");
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
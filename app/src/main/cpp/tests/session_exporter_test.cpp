@@ -0,0 +1,411 @@
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "calibration_store.h"
+#include "frame_pool.h"
+#include "mcap_reader.h"
+#include "ros2_messages.h"
+#include "session_exporter.h"
+#include "test_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+/// Little-endian CDR as the ros2 serializers write it: alignment counts
+/// from after the 4-byte encapsulation header
+class CdrReader {
+public:
+    explicit CdrReader(const std::vector<uint8_t>& data) : data_(data) {
+        static constexpr uint8_t kCdrLe[4] = {0x00, 0x01, 0x00, 0x00};
+        ok_ = data_.size() >= 4 && std::memcmp(data_.data(), kCdrLe, 4) == 0;
+    }
+
+    template<typename T>
+    T get() {
+        position_ += (sizeof(T) - (position_ - 4) % sizeof(T)) % sizeof(T);
+        T value{};
+        if (!ok_ || data_.size() < position_ + sizeof(T)) {
+            ok_ = false;
+            return value;
+        }
+        std::memcpy(&value, data_.data() + position_, sizeof(T));
+        position_ += sizeof(T);
+        return value;
+    }
+
+    std::vector<double> f64s(size_t count) {
+        std::vector<double> values(count);
+        for (double& value : values) {
+            value = get<double>();
+        }
+        return values;
+    }
+
+    /// Length-prefixed, NUL-terminated
+    std::string string() {
+        const auto length = get<uint32_t>();
+        if (!ok_ || length == 0 || data_.size() - position_ < length || data_[position_ + length - 1] != 0) {
+            ok_ = false;
+            return {};
+        }
+        std::string value(reinterpret_cast<const char*>(data_.data() + position_), length - 1);
+        position_ += length;
+        return value;
+    }
+
+    std::vector<uint8_t> bytes() {
+        const auto length = get<uint32_t>();
+        if (!ok_ || data_.size() - position_ < length) {
+            ok_ = false;
+            return {};
+        }
+        std::vector<uint8_t> value(data_.begin() + static_cast<ptrdiff_t>(position_),
+                                   data_.begin() + static_cast<ptrdiff_t>(position_ + length));
+        position_ += length;
+        return value;
+    }
+
+    /// std_msgs/Header
+    TimestampNs stamp(std::string& frameId) {
+        const auto sec = get<int32_t>();
+        const auto nanosec = get<uint32_t>();
+        frameId = string();
+        return static_cast<TimestampNs>(sec) * 1'000'000'000 + nanosec;
+    }
+
+    [[nodiscard]]
+    bool done() const noexcept { return ok_ && position_ == data_.size(); }
+
+private:
+    const std::vector<uint8_t>& data_;
+    size_t position_ = 4;
+    bool ok_ = false;
+};
+
+std::vector<float> parseFloats(const std::string& text) {
+    std::istringstream stream(text);
+    std::vector<float> values;
+    float value = 0.0f;
+    while (stream >> value) {
+        values.push_back(value);
+    }
+    return values;
+}
+
+TEST(Ros2MessagesTest, ImuFillsOnlyItsSensorsVector) {
+    std::vector<uint8_t> message;
+    for (const SensorType type : {SensorType::Accelerometer, SensorType::Gyroscope}) {
+        const bool gyro = type == SensorType::Gyroscope;
+        ros2::serializeImu({0.25f, -1.5f, 9.75f, 12'345'678'901, type}, "imu", message);
+        CdrReader cdr(message);
+        std::string frameId;
+        EXPECT_EQ(cdr.stamp(frameId), 12'345'678'901);
+        EXPECT_EQ(frameId, "imu");
+        EXPECT_EQ(cdr.f64s(4), (std::vector<double>{0.0, 0.0, 0.0, 1.0}));
+        EXPECT_EQ(cdr.f64s(9)[0], -1.0);            // No orientation
+        const std::vector<double> angularVelocity = cdr.f64s(3);
+        EXPECT_EQ(cdr.f64s(9)[0], gyro ? 0.0 : -1.0);
+        const std::vector<double> linearAcceleration = cdr.f64s(3);
+        EXPECT_EQ(cdr.f64s(9)[0], gyro ? -1.0 : 0.0);
+        EXPECT_TRUE(cdr.done());
+
+        const std::vector<double> sample = {0.25, -1.5, 9.75};
+        const std::vector<double> zero(3, 0.0);
+        EXPECT_EQ(angularVelocity, gyro ? sample : zero);
+        EXPECT_EQ(linearAcceleration, gyro ? zero : sample);
+    }
+}
+
+TEST(Ros2MessagesTest, ImageDropsRowPadding) {
+    constexpr int32_t kWidth = 3;
+    constexpr int32_t kHeight = 2;
+    constexpr int32_t kStride = 5;
+    const uint8_t pixels[kStride * kHeight] = {1, 2, 3, 99, 99, 4, 5, 6, 99, 99};
+    std::vector<uint8_t> message;
+    ros2::serializeImage(7'000'000'001, "camera_0", pixels, kWidth, kHeight, kStride, message);
+
+    CdrReader cdr(message);
+    std::string frameId;
+    EXPECT_EQ(cdr.stamp(frameId), 7'000'000'001);
+    EXPECT_EQ(frameId, "camera_0");
+    EXPECT_EQ(cdr.get<uint32_t>(), 2u);
+    EXPECT_EQ(cdr.get<uint32_t>(), 3u);
+    EXPECT_EQ(cdr.string(), "mono8");
+    EXPECT_EQ(cdr.get<uint8_t>(), 0);
+    EXPECT_EQ(cdr.get<uint32_t>(), 3u);
+    EXPECT_EQ(cdr.bytes(), (std::vector<uint8_t>{1, 2, 3, 4, 5, 6}));
+    EXPECT_TRUE(cdr.done());
+}
+
+TEST(Ros2MessagesTest, CameraInfoUsesScaledIntrinsicsAndPlumbBobOrder) {
+    const CameraCalibration calibration = sampleCamera("0").calibration;
+    const PinholeIntrinsics k = scaledIntrinsics(calibration, 640, 480);
+    std::vector<uint8_t> message;
+    ros2::serializeCameraInfo(1, "camera_0", 640, 480, calibration, message);
+
+    CdrReader cdr(message);
+    std::string frameId;
+    cdr.stamp(frameId);
+    EXPECT_EQ(cdr.get<uint32_t>(), 480u);
+    EXPECT_EQ(cdr.get<uint32_t>(), 640u);
+    EXPECT_EQ(cdr.string(), "plumb_bob");
+    ASSERT_EQ(cdr.get<uint32_t>(), 5u);
+    const std::vector<double> d = cdr.f64s(5);
+    EXPECT_EQ(d, (std::vector<double>{-0.08f, 0.02f, 0.001f, -0.002f, -0.004f}));     // k1 k2 p1 p2 k3
+    EXPECT_EQ(cdr.f64s(9), (std::vector<double>{k.fx, k.skew, k.cx, 0.0, k.fy, k.cy, 0.0, 0.0, 1.0}));
+    EXPECT_EQ(cdr.f64s(9), (std::vector<double>{1, 0, 0, 0, 1, 0, 0, 0, 1}));
+    EXPECT_EQ(cdr.f64s(12), (std::vector<double>{k.fx, k.skew, k.cx, 0.0, 0.0, k.fy, k.cy, 0.0, 0.0, 0.0, 1.0, 0.0}));
+    EXPECT_EQ(cdr.get<uint32_t>(), 1u);         // Binning
+    EXPECT_EQ(cdr.get<uint32_t>(), 1u);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(cdr.get<uint32_t>(), 0u);     // Full-frame ROI
+    }
+    EXPECT_EQ(cdr.get<uint8_t>(), 0);
+    EXPECT_TRUE(cdr.done());
+
+    // Uncalibrated: all zero rather than made up
+    ros2::serializeCameraInfo(1, "camera_0", 640, 480, CameraCalibration{}, message);
+    CdrReader empty(message);
+    empty.stamp(frameId);
+    empty.get<uint32_t>();
+    empty.get<uint32_t>();
+    empty.string();
+    ASSERT_EQ(empty.get<uint32_t>(), 5u);
+    EXPECT_EQ(empty.f64s(5), std::vector<double>(5, 0.0));
+    EXPECT_EQ(empty.f64s(9), std::vector<double>(9, 0.0));
+}
+
+/// Messages of every chunk of an MCAP file, with the topic of each channel
+struct ExportedFile {
+    Summary summary;
+    std::vector<Message> messages;
+
+    [[nodiscard]]
+    std::vector<const Message*> on(const std::string& topic) const {
+        std::vector<const Message*> result;
+        for (const Message& message : messages) {
+            const auto it = summary.topics.find(message.channelId);
+            if (it != summary.topics.end() && it->second == topic) {
+                result.push_back(&message);
+            }
+        }
+        return result;
+    }
+
+    /// Key/value pairs of a metadata record
+    [[nodiscard]]
+    std::map<std::string, std::string> metadata(const std::vector<uint8_t>& file, const std::string& name) const {
+        std::map<std::string, std::string> values;
+        const auto it = summary.metadata.find(name);
+        if (it == summary.metadata.end()) {
+            return values;
+        }
+        Record record = recordAt(file, it->second.first);
+        if (record.opcode != 0x0C || record.body.string() != name) {
+            return values;
+        }
+        const size_t end = record.body.position + record.body.le<uint32_t>();
+        while (record.body.ok && record.body.position < end) {
+            std::string key = record.body.string();
+            values[key] = record.body.string();
+        }
+        return values;
+    }
+};
+
+::testing::AssertionResult readExport(const std::vector<uint8_t>& file, ExportedFile& exported) {
+    if (::testing::AssertionResult summary = readSummary(file, exported.summary); !summary) {
+        return summary;
+    }
+    for (const ChunkIndex& index : exported.summary.chunks) {
+        std::vector<uint8_t> records;
+        if (::testing::AssertionResult chunk = readChunk(file, index, records); !chunk) {
+            return chunk;
+        }
+        if (::testing::AssertionResult messages = readMessages(records, exported.messages); !messages) {
+            return messages;
+        }
+    }
+    return ::testing::AssertionSuccess();
+}
+
+class SessionExporterTest : public ::testing::Test {
+protected:
+    SessionExporterTest() : calibration_("", "test-device") {
+        calibration_.update({sampleCamera("1")});
+    }
+
+    /// A frame of `frames_` with a gradient that depends on `seed`
+    FrameRef frame(const char* cameraId, TimestampNs timestampNs, uint8_t seed) {
+        FrameRef frame = frames_.acquire();
+        if (!frame) {
+            return frame;
+        }
+        for (int32_t y = 0; y < frame->height(); ++y) {
+            for (int32_t x = 0; x < frame->stride(); ++x) {
+                frame->row(y)[x] = x < frame->width() ? static_cast<uint8_t>(seed + x + 3 * y) : 0xEE;
+            }
+        }
+        frame->metadata.cameraId = cameraId;
+        frame->metadata.timestampNs = timestampNs;
+        return frame;
+    }
+
+    TempDir dir_;
+    CalibrationStore calibration_;
+    FramePool frames_{60, 45, 6};           // Rows padded to 64 bytes
+};
+
+TEST_F(SessionExporterTest, WritesImuFramesAndCalibrationAsRos2Topics) {
+    constexpr TimestampNs kStartNs = 5'000'000'000;
+    constexpr TimestampNs kFrameSpacingNs = 20'000'000;
+    const std::string path = dir_.path() + "/session.mcap";
+    SessionExportConfig config;
+    config.chunkSize = 4096;
+    config.frameIntervalNs = 50'000'000;
+    SessionExporter exporter(path, calibration_, config);
+    ASSERT_TRUE(exporter.ok());
+
+    for (int i = 0; i < 200; ++i) {
+        const SensorType type = i % 2 == 0 ? SensorType::Accelerometer : SensorType::Gyroscope;
+        exporter.addImuSample({0.1f * static_cast<float>(i), 0.0f, 9.8f, kStartNs + i * 1'250'000, type});
+    }
+    // 20 ms apart with a 50 ms minimum spacing: frames 0, 3, 6 and 9 are kept
+    for (int i = 0; i < 10; ++i) {
+        FrameRef f = frame("1", kStartNs + i * kFrameSpacingNs, static_cast<uint8_t>(i));
+        ASSERT_TRUE(f);
+        exporter.addFrame(f);
+    }
+    ASSERT_TRUE(exporter.finish());
+    EXPECT_EQ(frames_.available(), frames_.capacity());
+
+    const SessionExportStats stats = exporter.getStats();
+    EXPECT_EQ(stats.imuSamples, 200);
+    EXPECT_EQ(stats.frames, 4);
+    EXPECT_EQ(stats.droppedImu, 0);
+    EXPECT_EQ(stats.droppedFrames, 0);
+    EXPECT_GT(stats.chunks, 1);
+
+    const std::vector<uint8_t> file = readFile(path);
+    EXPECT_EQ(stats.bytesWritten, static_cast<int64_t>(file.size()));
+    ExportedFile exported;
+    ASSERT_TRUE(readExport(file, exported));
+    EXPECT_EQ(exported.summary.chunkCount, static_cast<uint32_t>(stats.chunks));
+    EXPECT_EQ(exported.summary.messageCount, 200u + 2 * 4);
+
+    // IMU: one message per sample, on the topic of its sensor, stamped with its time
+    const std::vector<const Message*> accel = exported.on("/imu/accel");
+    const std::vector<const Message*> gyro = exported.on("/imu/gyro");
+    ASSERT_EQ(accel.size(), 100u);
+    ASSERT_EQ(gyro.size(), 100u);
+    for (size_t i = 0; i < accel.size(); ++i) {
+        EXPECT_EQ(accel[i]->logTimeNs, static_cast<uint64_t>(kStartNs + 2 * i * 1'250'000));
+        CdrReader cdr(accel[i]->data);
+        std::string frameId;
+        EXPECT_EQ(cdr.stamp(frameId), static_cast<TimestampNs>(accel[i]->logTimeNs));
+        EXPECT_EQ(frameId, "imu");
+    }
+    EXPECT_EQ(gyro.back()->logTimeNs, static_cast<uint64_t>(kStartNs + 199 * 1'250'000));
+
+    // Images: the kept frames, without row padding, each with its camera info
+    const std::vector<const Message*> images = exported.on("/camera/1/image_raw");
+    const std::vector<const Message*> infos = exported.on("/camera/1/camera_info");
+    ASSERT_EQ(images.size(), 4u);
+    ASSERT_EQ(infos.size(), 4u);
+    for (size_t i = 0; i < images.size(); ++i) {
+        const auto kept = static_cast<int32_t>(3 * i);
+        EXPECT_EQ(images[i]->logTimeNs, static_cast<uint64_t>(kStartNs + kept * kFrameSpacingNs));
+        EXPECT_EQ(infos[i]->logTimeNs, images[i]->logTimeNs);
+
+        CdrReader cdr(images[i]->data);
+        std::string frameId;
+        cdr.stamp(frameId);
+        EXPECT_EQ(frameId, "camera_1");
+        EXPECT_EQ(cdr.get<uint32_t>(), 45u);
+        EXPECT_EQ(cdr.get<uint32_t>(), 60u);
+        EXPECT_EQ(cdr.string(), "mono8");
+        cdr.get<uint8_t>();
+        EXPECT_EQ(cdr.get<uint32_t>(), 60u);
+        const std::vector<uint8_t> pixels = cdr.bytes();
+        ASSERT_EQ(pixels.size(), 60u * 45u);
+        EXPECT_EQ(pixels[0], static_cast<uint8_t>(kept));
+        EXPECT_EQ(pixels[60 * 44 + 59], static_cast<uint8_t>(kept + 59 + 3 * 44));
+        EXPECT_TRUE(cdr.done());
+    }
+
+    // Calibration metadata, once, at the size the frames came in
+    const std::map<std::string, std::string> values = exported.metadata(file, "calibration/1");
+    ASSERT_FALSE(values.empty());
+    EXPECT_EQ(exported.summary.metadata.size(), 1u);
+    EXPECT_EQ(values.at("camera_id"), "1");
+    EXPECT_EQ(values.at("width"), "60");
+    EXPECT_EQ(values.at("height"), "45");
+    const PinholeIntrinsics k = scaledIntrinsics(sampleCamera("1").calibration, 60, 45);
+    const std::vector<float> intrinsics = parseFloats(values.at("intrinsics"));
+    ASSERT_EQ(intrinsics.size(), 5u);
+    EXPECT_FLOAT_EQ(intrinsics[0], k.fx);
+    EXPECT_FLOAT_EQ(intrinsics[1], k.fy);
+    EXPECT_FLOAT_EQ(intrinsics[2], k.cx);
+    EXPECT_FLOAT_EQ(intrinsics[3], k.cy);
+    EXPECT_FLOAT_EQ(intrinsics[4], k.skew);
+    EXPECT_EQ(parseFloats(values.at("distortion")), (std::vector<float>{-0.08f, 0.02f, -0.004f, 0.001f, -0.002f}));
+    EXPECT_EQ(parseFloats(values.at("imu_from_camera.translation")), (std::vector<float>{0.5f, 0.0f, 0.0f}));
+    EXPECT_EQ(parseFloats(values.at("imu_from_camera.rotation")).size(), 4u);
+}
+
+TEST_F(SessionExporterTest, DropsWhatTheWriterCannotTakeAndIgnoresDataAfterFinish) {
+    constexpr int kSamples = 20'000;
+    const std::string path = dir_.path() + "/session.mcap";
+    SessionExportConfig config;
+    config.compression = McapCompression::None;
+    config.imuQueueCapacity = 16;
+    config.frameQueueCapacity = 2;
+    SessionExporter exporter(path, calibration_, config);
+    ASSERT_TRUE(exporter.ok());
+
+    // Far faster than the writer's 10 ms polls drain 16 samples
+    for (int i = 0; i < kSamples; ++i) {
+        exporter.addImuSample({0.0f, 0.0f, 9.8f, 1'000'000 + i, SensorType::Accelerometer});
+    }
+    // The queue holds the frame buffers back from the pool; the rest are dropped
+    for (int i = 0; i < 4; ++i) {
+        exporter.addFrame(frame("1", 1'000'000 + i, 0));
+    }
+    ASSERT_TRUE(exporter.finish());
+    const SessionExportStats stats = exporter.getStats();
+    EXPECT_GT(stats.droppedImu, 0);
+    EXPECT_EQ(stats.imuSamples + stats.droppedImu, kSamples);
+    EXPECT_GE(stats.frames, 2);
+    EXPECT_EQ(stats.frames + stats.droppedFrames, 4);
+    EXPECT_EQ(frames_.available(), frames_.capacity());
+
+    exporter.addImuSample({0.0f, 0.0f, 9.8f, 2'000'000'000, SensorType::Accelerometer});
+    exporter.addFrame(frame("1", 2'000'000'000, 0));
+    EXPECT_TRUE(exporter.finish());
+    EXPECT_EQ(exporter.getStats().imuSamples, stats.imuSamples);
+    EXPECT_EQ(exporter.getStats().droppedImu, stats.droppedImu);
+
+    const std::vector<uint8_t> file = readFile(path);
+    ExportedFile exported;
+    ASSERT_TRUE(readExport(file, exported));
+    EXPECT_EQ(exported.on("/imu/accel").size(), static_cast<size_t>(stats.imuSamples));
+    EXPECT_EQ(exported.on("/camera/1/image_raw").size(), static_cast<size_t>(stats.frames));
+    EXPECT_EQ(exported.summary.chunks.front().compression, "");
+}
+
+TEST_F(SessionExporterTest, UnwritablePathFailsUpFront) {
+    SessionExporter exporter(dir_.path() + "/missing/session.mcap", calibration_);
+    EXPECT_FALSE(exporter.ok());
+    exporter.addImuSample({0.0f, 0.0f, 9.8f, 1, SensorType::Accelerometer});
+    EXPECT_FALSE(exporter.finish());
+    EXPECT_EQ(exporter.getStats().imuSamples, 0);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
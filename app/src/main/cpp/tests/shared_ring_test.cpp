@@ -0,0 +1,222 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "shared_ring.h"
+#include "test_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr uint32_t kPayloadType = 3;
+
+struct TestMessage {
+    uint64_t index = 0;
+    uint64_t check = 0;         // ~index
+    uint8_t filler[24] = {};
+};
+
+TestMessage message(uint64_t index) {
+    TestMessage result;
+    result.index = index;
+    result.check = ~index;
+    std::memset(result.filler, static_cast<int>(index & 0xFF), sizeof(result.filler));
+    return result;
+}
+
+TEST(SharedRingTest, ReadersStartAtTheNewestMessageAndReadInOrder) {
+    SharedRingWriter writer;
+    ASSERT_TRUE(writer.create("test-ring", 6, sizeof(TestMessage), kPayloadType));
+    for (uint64_t i = 0; i < 3; ++i) {
+        const TestMessage m = message(i);
+        ASSERT_TRUE(writer.publish(&m, sizeof(m)));
+    }
+
+    SharedRingReader reader;
+    ASSERT_TRUE(reader.open(writer.fd()));
+    EXPECT_EQ(reader.payloadType(), kPayloadType);
+    TestMessage out;
+    size_t size = 0;
+    EXPECT_FALSE(reader.read(&out, sizeof(out), size));
+
+    // Payloads of any size up to the capacity; longer ones are refused
+    for (uint64_t i = 3; i < 8; ++i) {
+        const TestMessage m = message(i);
+        ASSERT_TRUE(writer.publish(&m, 16 + i));
+    }
+    const uint8_t tooLong[sizeof(TestMessage) + 8] = {};
+    EXPECT_FALSE(writer.publish(tooLong, sizeof(tooLong)));
+    EXPECT_EQ(writer.published(), 8u);
+    for (uint64_t i = 3; i < 8; ++i) {
+        out = {};
+        ASSERT_TRUE(reader.read(&out, sizeof(out), size));
+        EXPECT_EQ(size, 16 + i);
+        EXPECT_EQ(out.index, i);
+        EXPECT_EQ(out.check, ~i);
+    }
+    EXPECT_FALSE(reader.read(&out, sizeof(out), size));
+
+    // A smaller buffer gets the start of the payload and its full size
+    const TestMessage m = message(8);
+    ASSERT_TRUE(writer.publish(&m, sizeof(m)));
+    uint64_t index = 0;
+    ASSERT_TRUE(reader.read(&index, sizeof(index), size));
+    EXPECT_EQ(index, 8u);
+    EXPECT_EQ(size, sizeof(TestMessage));
+    EXPECT_EQ(reader.dropped(), 0u);
+}
+
+TEST(SharedRingTest, LappedReadersSkipAheadAndCountTheLoss) {
+    SharedRingWriter writer;
+    ASSERT_TRUE(writer.create("test-ring", 8, sizeof(TestMessage), kPayloadType));
+    SharedRingReader reader;
+    ASSERT_TRUE(reader.open(writer.fd()));
+    for (uint64_t i = 0; i < 20; ++i) {
+        const TestMessage m = message(i);
+        ASSERT_TRUE(writer.publish(&m, sizeof(m)));
+    }
+
+    // Half a ring behind the writer
+    TestMessage out;
+    size_t size = 0;
+    for (uint64_t i = 16; i < 20; ++i) {
+        ASSERT_TRUE(reader.read(&out, sizeof(out), size));
+        EXPECT_EQ(out.index, i);
+    }
+    EXPECT_FALSE(reader.read(&out, sizeof(out), size));
+    EXPECT_EQ(reader.dropped(), 16u);
+}
+
+TEST(SharedRingTest, BlockedReadersWakeOnPublish) {
+    SharedRingWriter writer;
+    ASSERT_TRUE(writer.create("test-ring", 8, sizeof(TestMessage), kPayloadType));
+    SharedRingReader reader;
+    ASSERT_TRUE(reader.open(writer.fd()));
+
+    // Timed out: nothing published
+    EXPECT_FALSE(reader.wait(10));
+
+    std::atomic<bool> woken{false};
+    std::atomic<bool> returned{false};
+    std::thread thread([&] {
+        woken.store(reader.wait(-1), std::memory_order_release);
+        returned.store(true, std::memory_order_release);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(returned.load(std::memory_order_acquire));
+    const TestMessage m = message(0);
+    ASSERT_TRUE(writer.publish(&m, sizeof(m)));
+    thread.join();
+    EXPECT_TRUE(woken.load(std::memory_order_acquire));
+
+    // An unread message returns at once
+    EXPECT_TRUE(reader.wait(-1));
+}
+
+TEST(SharedRingTest, ConsumersGetTheRingReadOnly) {
+    SharedRingWriter writer;
+    ASSERT_TRUE(writer.create("test-ring", 8, sizeof(TestMessage), kPayloadType));
+    const auto bytes = static_cast<size_t>(::lseek(writer.fd(), 0, SEEK_END));
+    EXPECT_EQ(::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, writer.fd(), 0), MAP_FAILED);
+    const uint8_t zeros[sizeof(shm::RingHeader)] = {};
+    EXPECT_LT(::pwrite(writer.fd(), zeros, sizeof(zeros), 0), 0);
+    EXPECT_NE(::ftruncate(writer.fd(), 0), 0);
+
+    // The writer keeps its own mapping
+    SharedRingReader reader;
+    ASSERT_TRUE(reader.open(writer.fd()));
+    const TestMessage m = message(0);
+    ASSERT_TRUE(writer.publish(&m, sizeof(m)));
+    TestMessage out;
+    size_t size = 0;
+    ASSERT_TRUE(reader.read(&out, sizeof(out), size));
+    EXPECT_EQ(out.index, 0u);
+}
+
+/// Progress of the reader process, in memory shared with the test
+struct ReaderProgress {
+    std::atomic<bool> opened{false};
+    std::atomic<uint64_t> received{0};
+    std::atomic<uint64_t> dropped{0};
+};
+
+/// Body of the reader process: reads until message `last`; every index is
+/// either received or counted as dropped. Returns the exit code.
+int runReader(int fd, uint64_t last, ReaderProgress& progress) {
+    SharedRingReader reader;
+    if (!reader.open(fd)) {
+        return 10;
+    }
+    progress.opened.store(true, std::memory_order_release);
+    uint64_t received = 0;
+    TestMessage out;
+    size_t size = 0;
+    while (true) {
+        if (!reader.wait(5000)) {
+            return 11;
+        }
+        while (reader.read(&out, sizeof(out), size)) {
+            if (size != sizeof(out) || out.check != ~out.index || out.filler[23] != (out.index & 0xFF)) {
+                return 12;
+            }
+            if (out.index != received + reader.dropped()) {
+                return 13;
+            }
+            ++received;
+            progress.dropped.store(reader.dropped(), std::memory_order_relaxed);
+            progress.received.store(received, std::memory_order_release);
+            if (out.index == last) {
+                return 0;
+            }
+        }
+    }
+}
+
+TEST(SharedRingForkTest, ReaderProcessGetsEveryMessageOrCountsItsLoss) {
+    constexpr uint32_t kSlots = 1024;
+    constexpr uint64_t kBurst = 1000;           // Fits the ring: nothing lost
+    constexpr uint64_t kFlood = 200'000;        // Laps a reader that can't keep up
+    SharedRingWriter writer;
+    ASSERT_TRUE(writer.create("test-ring", kSlots, sizeof(TestMessage), kPayloadType));
+    void* shared = ::mmap(nullptr, sizeof(ReaderProgress), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(shared, MAP_FAILED);
+    auto* progress = new (shared) ReaderProgress;
+
+    const pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        _exit(runReader(writer.fd(), kBurst + kFlood - 1, *progress));
+    }
+
+    // Published only once the reader is open, so it starts at message 0
+    EXPECT_TRUE(waitUntil([&] { return progress->opened.load(std::memory_order_acquire); }));
+    for (uint64_t i = 0; i < kBurst; ++i) {
+        const TestMessage m = message(i);
+        writer.publish(&m, sizeof(m));
+    }
+    EXPECT_TRUE(waitUntil([&] { return progress->received.load(std::memory_order_acquire) == kBurst; }));
+    EXPECT_EQ(progress->dropped.load(std::memory_order_relaxed), 0u);
+
+    for (uint64_t i = kBurst; i < kBurst + kFlood; ++i) {
+        const TestMessage m = message(i);
+        writer.publish(&m, sizeof(m));
+    }
+    int status = 0;
+    ASSERT_EQ(::waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    EXPECT_EQ(progress->received.load(std::memory_order_acquire) + progress->dropped.load(std::memory_order_relaxed),
+              kBurst + kFlood);
+    ::munmap(shared, sizeof(ReaderProgress));
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
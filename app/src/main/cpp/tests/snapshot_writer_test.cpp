@@ -0,0 +1,211 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include "frame_pool.h"
+#include "snapshot_writer.h"
+#include "test_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr int32_t kWidth = 37;
+constexpr int32_t kHeight = 23;
+constexpr int32_t kStride = 48;
+
+uint32_t bigEndian(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 |
+           static_cast<uint32_t>(p[2]) << 8 | static_cast<uint32_t>(p[3]);
+}
+
+struct DecodedPng {
+    int32_t width = 0;
+    int32_t height = 0;
+    std::vector<uint8_t> pixels;        // Tightly packed
+};
+
+/// Minimal reader for the grayscale PNGs encodeGrayPng writes: checks the
+/// chunk CRCs and undoes the Sub filter
+::testing::AssertionResult decodeGrayPng(const std::vector<uint8_t>& png, DecodedPng& out) {
+    static constexpr uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (png.size() < sizeof(kSignature) || std::memcmp(png.data(), kSignature, sizeof(kSignature)) != 0) {
+        return ::testing::AssertionFailure() << "bad signature";
+    }
+    std::vector<uint8_t> deflated;
+    bool ended = false;
+    for (size_t offset = sizeof(kSignature); offset + 12 <= png.size() && !ended;) {
+        const uint32_t length = bigEndian(&png[offset]);
+        if (offset + 12 + length > png.size()) {
+            return ::testing::AssertionFailure() << "truncated chunk at " << offset;
+        }
+        const std::string type(reinterpret_cast<const char*>(&png[offset + 4]), 4);
+        const uint8_t* data = &png[offset + 8];
+        const uLong crc = crc32(crc32(0L, Z_NULL, 0), &png[offset + 4], length + 4);
+        if (bigEndian(data + length) != static_cast<uint32_t>(crc)) {
+            return ::testing::AssertionFailure() << "bad CRC of " << type;
+        }
+        if (type == "IHDR") {
+            out.width = static_cast<int32_t>(bigEndian(data));
+            out.height = static_cast<int32_t>(bigEndian(data + 4));
+            if (length != 13 || data[8] != 8 || data[9] != 0) {
+                return ::testing::AssertionFailure() << "not 8-bit gray";
+            }
+        } else if (type == "IDAT") {
+            deflated.insert(deflated.end(), data, data + length);
+        } else if (type == "IEND") {
+            ended = offset + 12 == png.size();
+        }
+        offset += 12 + length;
+    }
+    if (!ended) {
+        return ::testing::AssertionFailure() << "missing or misplaced IEND";
+    }
+
+    const auto rowBytes = static_cast<size_t>(out.width) + 1;
+    std::vector<uint8_t> filtered(rowBytes * static_cast<size_t>(out.height));
+    uLongf size = filtered.size();
+    if (uncompress(filtered.data(), &size, deflated.data(), deflated.size()) != Z_OK || size != filtered.size()) {
+        return ::testing::AssertionFailure() << "bad IDAT stream";
+    }
+    out.pixels.resize(static_cast<size_t>(out.width) * static_cast<size_t>(out.height));
+    for (size_t y = 0; y < static_cast<size_t>(out.height); ++y) {
+        const uint8_t* row = &filtered[y * rowBytes];
+        if (row[0] != 1) {
+            return ::testing::AssertionFailure() << "row " << y << " not Sub filtered";
+        }
+        uint8_t left = 0;
+        for (size_t x = 0; x < static_cast<size_t>(out.width); ++x) {
+            left = static_cast<uint8_t>(left + row[x + 1]);
+            out.pixels[y * static_cast<size_t>(out.width) + x] = left;
+        }
+    }
+    return ::testing::AssertionSuccess();
+}
+
+uint8_t pattern(int32_t x, int32_t y) {
+    return static_cast<uint8_t>(x * 7 + y * 13 + (x * y) % 5);
+}
+
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+TEST(EncodeGrayPngTest, RoundTripsThroughAPngReader) {
+    std::vector<uint8_t> image(static_cast<size_t>(kStride) * kHeight, 0xEE);
+    for (int32_t y = 0; y < kHeight; ++y) {
+        for (int32_t x = 0; x < kWidth; ++x) {
+            image[static_cast<size_t>(y * kStride + x)] = pattern(x, y);
+        }
+    }
+    std::vector<uint8_t> png{1, 2, 3};
+    ASSERT_TRUE(encodeGrayPng(image.data(), kWidth, kHeight, kStride, png));
+
+    DecodedPng decoded;
+    ASSERT_TRUE(decodeGrayPng(png, decoded));
+    EXPECT_EQ(decoded.width, kWidth);
+    EXPECT_EQ(decoded.height, kHeight);
+    for (int32_t y = 0; y < kHeight; ++y) {
+        for (int32_t x = 0; x < kWidth; ++x) {
+            ASSERT_EQ(decoded.pixels[static_cast<size_t>(y * kWidth + x)], pattern(x, y)) << x << "," << y;
+        }
+    }
+}
+
+TEST(EncodeGrayPngTest, RejectsEmptyImages) {
+    const uint8_t pixel = 0;
+    std::vector<uint8_t> png{1, 2, 3};
+    EXPECT_FALSE(encodeGrayPng(&pixel, 0, 1, 1, png));
+    EXPECT_TRUE(png.empty());
+    EXPECT_FALSE(encodeGrayPng(&pixel, 1, 0, 1, png));
+
+    // A single pixel is a valid image
+    ASSERT_TRUE(encodeGrayPng(&pixel, 1, 1, 1, png));
+    DecodedPng decoded;
+    EXPECT_TRUE(decodeGrayPng(png, decoded));
+}
+
+class SnapshotWriterTest : public ::testing::Test {
+protected:
+    SnapshotWriterTest() : frames_(kWidth, kHeight, 4) {}
+
+    FrameRef frame(const std::string& cameraId) {
+        FrameRef ref = frames_.acquire();
+        for (int32_t y = 0; y < kHeight; ++y) {
+            for (int32_t x = 0; x < kWidth; ++x) {
+                ref->row(y)[x] = pattern(x, y);
+            }
+        }
+        ref->metadata.cameraId = cameraId;
+        return ref;
+    }
+
+    TempDir dir_;
+    FramePool frames_;
+};
+
+TEST_F(SnapshotWriterTest, WritesTheNextFrameOfTheRequestedCamera) {
+    SnapshotWriter writer;
+    const std::string path = dir_.path() + "/still.png";
+    ASSERT_TRUE(writer.request("1", path));
+    writer.process(frame("0"));
+    writer.process(frame("1"));
+    ASSERT_TRUE(waitUntil([&] { return writer.getStats().written == 1; }));
+
+    DecodedPng decoded;
+    ASSERT_TRUE(decodeGrayPng(readFile(path), decoded));
+    EXPECT_EQ(decoded.width, kWidth);
+    EXPECT_EQ(decoded.pixels[static_cast<size_t>(kWidth + 3)], pattern(3, 1));
+    // The frame went back to its pool once written
+    EXPECT_TRUE(waitUntil([&] { return frames_.available() == 4; }));
+
+    const SnapshotStats stats = writer.getStats();
+    EXPECT_EQ(stats.requested, 1);
+    EXPECT_EQ(stats.hardware, 0);
+    EXPECT_EQ(stats.lastBytes, static_cast<int64_t>(readFile(path).size()));
+}
+
+TEST_F(SnapshotWriterTest, WritesEncodedBytesAsTheyAre) {
+    SnapshotWriter writer;
+    const std::string path = dir_.path() + "/still.jpg";
+    const std::vector<uint8_t> jpeg{0xFF, 0xD8, 0x00, 0x42, 0xFF, 0xD9};
+    ASSERT_TRUE(writer.submitEncoded(path, jpeg.data(), jpeg.size()));
+    ASSERT_TRUE(waitUntil([&] { return writer.getStats().written == 1; }));
+    EXPECT_EQ(readFile(path), jpeg);
+    EXPECT_EQ(writer.getStats().hardware, 1);
+}
+
+TEST_F(SnapshotWriterTest, BoundsPendingSnapshotsAndCancelsStoppedStreams) {
+    SnapshotWriter writer(1);
+    EXPECT_TRUE(writer.request("0", dir_.path() + "/a.png"));
+    EXPECT_FALSE(writer.request("0", dir_.path() + "/b.png"));
+    const uint8_t byte = 0;
+    EXPECT_FALSE(writer.submitEncoded(dir_.path() + "/c.jpg", &byte, 1));
+
+    // Cancelling frees the slot
+    writer.cancel("0");
+    EXPECT_TRUE(writer.request("1", dir_.path() + "/d.png"));
+    const SnapshotStats stats = writer.getStats();
+    EXPECT_EQ(stats.requested, 4);
+    EXPECT_EQ(stats.rejected, 2);
+    EXPECT_EQ(stats.failed, 1);
+}
+
+TEST_F(SnapshotWriterTest, FailedWritesLeaveNoFileBehind) {
+    SnapshotWriter writer;
+    const std::string path = dir_.path() + "/missing/still.png";
+    ASSERT_TRUE(writer.request("0", path));
+    writer.process(frame("0"));
+    ASSERT_TRUE(waitUntil([&] { return writer.getStats().failed == 1; }));
+    EXPECT_TRUE(readFile(path).empty());
+    EXPECT_EQ(writer.getStats().written, 0);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,498 @@
+// Soak mode: randomized start/stop/switch/disconnect/error sequences and
+// surface churn against the synthetic backends, checking invariants as it
+// goes and reporting throughput and memory over time. ctest runs a few
+// seconds of it on a fixed seed; a long soak (NATIVESENSOR_SOAK_SECONDS set)
+// picks a random one unless given, and a run replays from its printed seed:
+//
+//   NATIVESENSOR_SOAK_SECONDS=3600 NATIVESENSOR_SOAK_SEED=1234 ./build/tests/nativesensor_tests --gtest_filter='Soak*'
+
+#include <camera/NdkCameraDevice.h>
+#include <camera/NdkCameraError.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "camera_manager.h"
+#include "camera_stream.h"
+#include "frame_pool.h"
+#include "imu_manager.h"
+#include "mailbox_registry.h"
+#include "test_utils.h"
+#include "time_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+constexpr bool kSanitized = true;
+#else
+constexpr bool kSanitized = false;
+#endif
+
+/// Longest a single lifecycle call may block before the run counts as hung
+constexpr auto kStuckAfter = std::chrono::seconds(10);
+/// Worst sensor/camera timestamp-to-callback delay within one report interval
+constexpr double kMaxLatencyMs = kSanitized ? 500.0 : 250.0;
+/// Resident set growth allowed over the run after warm-up; sanitizer builds
+/// quarantine freed memory, so there the trend is only reported
+constexpr int64_t kMaxRssGrowthKb = 32 * 1024;
+/// Analysis frames each camera holds on to, like a pipeline stage would
+constexpr size_t kHeldFrames = 2;
+/// Seed of the short ctest run, so a failure there replays as is
+constexpr uint64_t kDefaultSeed = 20240611;
+
+int64_t envOr(const char* name, int64_t fallback) {
+    const char* value = std::getenv(name);
+    return value && *value ? std::strtoll(value, nullptr, 10) : fallback;
+}
+
+int64_t residentKb() {
+    std::ifstream statm("/proc/self/statm");
+    int64_t sizePages = 0;
+    int64_t residentPages = 0;
+    statm >> sizePages >> residentPages;
+    return residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/// NDK objects alive besides the CameraManager's own ACameraManager
+int strayHandles() {
+    LiveHandles handles = liveHandles();
+    handles.cameraManagers = 0;
+    return handles.total();
+}
+
+/// Aborts naming the operation if one blocks longer than kStuckAfter: a
+/// deadlocked stop() would otherwise only show up as a ctest timeout
+class Watchdog {
+public:
+    explicit Watchdog(uint64_t seed) : seed_(seed), thread_([this] { run(); }) {}
+
+    ~Watchdog() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    void enter(const char* operation) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        operation_ = operation;
+        since_ = std::chrono::steady_clock::now();
+    }
+
+    void leave() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        operation_ = nullptr;
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopped_) {
+            cv_.wait_for(lock, std::chrono::milliseconds(100));
+            if (operation_ && std::chrono::steady_clock::now() - since_ > kStuckAfter) {
+                std::fprintf(stderr, "Soak: %s stuck for over %llds (seed %llu)\n", operation_,
+                             static_cast<long long>(kStuckAfter.count()), static_cast<unsigned long long>(seed_));
+                std::abort();
+            }
+        }
+    }
+
+    const uint64_t seed_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopped_ = false;
+    const char* operation_ = nullptr;
+    std::chrono::steady_clock::time_point since_;
+    std::thread thread_;
+};
+
+/// Updated from the sensor, camera and reader threads; snapshotted per report
+struct Activity {
+    std::atomic<int64_t> operations{0};
+    std::atomic<int64_t> imuSamples{0};
+    std::atomic<int64_t> frames{0};
+    std::atomic<int64_t> analysisFrames{0};
+    std::atomic<int64_t> stills{0};
+    std::atomic<int64_t> reads{0};
+    std::atomic<int64_t> maxLatencyNs{0};  // Since the last report
+
+    void latency(int64_t timestampNs) {
+        const int64_t latencyNs = getBootTimeNs() - timestampNs;
+        int64_t seen = maxLatencyNs.load(std::memory_order_relaxed);
+        while (latencyNs > seen &&
+               !maxLatencyNs.compare_exchange_weak(seen, latencyNs, std::memory_order_relaxed)) {}
+    }
+};
+
+/// One camera as the app holds it: a stream, its analysis pool and the
+/// frames a consumer currently keeps
+struct CameraSlot {
+    CameraInfo info;
+    std::string id;
+    std::shared_ptr<FramePool> pool;
+    std::unique_ptr<CameraStream> stream;
+    bool openFails = false;
+
+    std::mutex heldMutex;
+    std::deque<FrameRef> held;
+};
+
+struct Report {
+    double seconds = 0.0;
+    int64_t operations = 0;
+    int64_t imuSamples = 0;
+    int64_t frames = 0;
+    int64_t analysisFrames = 0;
+    int64_t stills = 0;
+    int64_t reads = 0;
+    double maxLatencyMs = 0.0;
+    int64_t rssKb = 0;
+};
+
+/// Drives the IMU and every synthetic camera through random lifecycle
+/// operations from one thread while a reader thread polls stats the way
+/// the UI does
+class Soak {
+public:
+    explicit Soak(uint64_t seed) : random_(seed), imu_(mailboxes_), watchdog_(seed) {
+        for (const auto& sensor : imu_.enumerateSensors(true)) {
+            if (sensor.type == SensorType::Accelerometer || sensor.type == SensorType::AccelerometerUncalibrated) {
+                accelHandles_.push_back(sensor.handle);
+            } else if (sensor.type == SensorType::Gyroscope || sensor.type == SensorType::GyroscopeUncalibrated) {
+                gyroHandles_.push_back(sensor.handle);
+            }
+        }
+        for (const auto& info : cameras_.enumerateCameras(true)) {
+            auto slot = std::make_unique<CameraSlot>();
+            slot->info = info;
+            slot->id = info.id;
+            slot->pool = std::make_shared<FramePool>(info.width, info.height, kHeldFrames + 2);
+            slots_.push_back(std::move(slot));
+        }
+        for (auto& slot : slots_) {
+            createStream(*slot);
+        }
+        reader_ = std::thread([this] { readLoop(); });
+    }
+
+    ~Soak() {
+        readerStopped_.store(true, std::memory_order_release);
+        reader_.join();
+        std::lock_guard<std::mutex> lock(slotsMutex_);
+        for (auto& slot : slots_) {
+            slot->stream.reset();
+            setCameraOpenError(slot->id, ACAMERA_OK);
+        }
+        imu_.stop();
+    }
+
+    Soak(const Soak&) = delete;
+    Soak& operator=(const Soak&) = delete;
+
+    [[nodiscard]] bool ready() const { return !accelHandles_.empty() && !gyroHandles_.empty() && !slots_.empty(); }
+
+    /// One random operation, with the invariants that must hold right after it
+    void step() {
+        enum Op { ImuStart, ImuStop, ImuSwitch, ImuBurst, CameraStart, CameraStop, CameraDisconnect, CameraError,
+                  CameraOpenFault, CameraRecreate, CameraStill, CameraEnumerate, kOpCount };
+        static constexpr std::array<int, kOpCount> kWeights = {6, 4, 4, 3, 12, 6, 3, 3, 2, 2, 3, 1};
+        std::discrete_distribution<int> pick(kWeights.begin(), kWeights.end());
+        CameraSlot& slot = *slots_[std::uniform_int_distribution<size_t>(0, slots_.size() - 1)(random_)];
+
+        switch (pick(random_)) {
+        case ImuStart:
+            guarded("ImuManager::start", [this] {
+                if (!imu_.isRunning()) {
+                    imu_.start([this](const ImuSample& sample) {
+                        activity_.imuSamples.fetch_add(1, std::memory_order_relaxed);
+                        activity_.latency(sample.timestampNs);
+                    });
+                }
+            });
+            break;
+        case ImuStop:
+            guarded("ImuManager::stop", [this] { imu_.stop(); });
+            EXPECT_FALSE(imu_.isRunning());
+            EXPECT_EQ(liveHandles().sensorQueues, 0);
+            break;
+        case ImuSwitch:
+            guarded("ImuManager::switchSensors", [this] {
+                imu_.switchSensors(pickFrom(accelHandles_), pickFrom(gyroHandles_));
+            });
+            break;
+        case ImuBurst:
+            for (int i = 0; i < 32; ++i) {
+                injectSensorEvent(static_cast<int>(SensorType::Accelerometer), 0.0f, 0.0f, 9.81f);
+                injectSensorEvent(static_cast<int>(SensorType::Gyroscope), 0.01f, 0.0f, 0.0f);
+            }
+            break;
+        case CameraStart: {
+            // A fresh surface each time; the stream keeps its own reference
+            ANativeWindow* window = createWindow(slot.info.width, slot.info.height);
+            const bool wasStreaming = slot.stream->isStreaming();  // Then it's kept, not reopened
+            bool started = false;
+            guarded("CameraStream::startPreview", [&] { started = slot.stream->startPreview(slot.id, window); });
+            ANativeWindow_release(window);
+            EXPECT_EQ(started, wasStreaming || !slot.openFails) << slot.id;
+            EXPECT_EQ(slot.stream->isStreaming(), started) << slot.id;
+            break;
+        }
+        case CameraStop:
+            guarded("CameraStream::stopPreview", [&] { slot.stream->stopPreview(); });
+            EXPECT_FALSE(slot.stream->isStreaming()) << slot.id;
+            break;
+        case CameraDisconnect:
+            guarded("disconnectCamera", [&] { disconnectCamera(slot.id); });
+            EXPECT_FALSE(slot.stream->isStreaming()) << slot.id;
+            break;
+        case CameraError: {
+            static constexpr std::array<int, 3> kErrors = {ERROR_CAMERA_DEVICE, ERROR_CAMERA_SERVICE,
+                                                           ERROR_CAMERA_IN_USE};
+            const int error = kErrors[std::uniform_int_distribution<size_t>(0, kErrors.size() - 1)(random_)];
+            guarded("failCamera", [&] { failCamera(slot.id, error); });
+            EXPECT_FALSE(slot.stream->isStreaming()) << slot.id;
+            break;
+        }
+        case CameraOpenFault:
+            slot.openFails = !slot.openFails;
+            setCameraOpenError(slot.id, slot.openFails ? ACAMERA_ERROR_CAMERA_IN_USE : ACAMERA_OK);
+            break;
+        case CameraRecreate:
+            guarded("CameraStream::~CameraStream", [&] {
+                std::lock_guard<std::mutex> lock(slotsMutex_);
+                createStream(slot);
+            });
+            break;
+        case CameraStill:
+            // Refused unless streaming with a still output
+            slot.stream->captureStill([this](const uint8_t*, size_t, int64_t) {
+                activity_.stills.fetch_add(1, std::memory_order_relaxed);
+            });
+            break;
+        case CameraEnumerate:
+            guarded("CameraManager::enumerateCameras", [this] {
+                EXPECT_EQ(cameras_.enumerateCameras(true).size(), slots_.size());
+            });
+            break;
+        default:
+            break;
+        }
+        activity_.operations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Stop everything and check nothing outlives it: no NDK handles, no
+    /// frame or sensor callbacks from threads that should be gone, every
+    /// analysis buffer back in its pool
+    void checkpoint() {
+        guarded("checkpoint stop", [this] {
+            imu_.stop();
+            for (auto& slot : slots_) {
+                slot->stream->stopPreview();
+                std::lock_guard<std::mutex> lock(slot->heldMutex);
+                slot->held.clear();
+            }
+        });
+
+        // Objects may be released by threads winding down just after stop
+        EXPECT_TRUE(waitUntil([] { return strayHandles() == 0; }, std::chrono::seconds(2)))
+            << liveHandles().toString();
+        const int64_t frames = activity_.frames.load();
+        const int64_t samples = activity_.imuSamples.load();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_EQ(activity_.frames.load(), frames) << "Frame callbacks after every stream stopped";
+        EXPECT_EQ(activity_.imuSamples.load(), samples) << "Sensor callbacks after the IMU stopped";
+        for (auto& slot : slots_) {
+            EXPECT_EQ(slot->pool->available(), slot->pool->capacity()) << slot->id;
+        }
+    }
+
+    /// Activity since the previous report
+    Report report(double seconds) {
+        Report now;
+        now.seconds = seconds;
+        now.operations = activity_.operations.load();
+        now.imuSamples = activity_.imuSamples.load();
+        now.frames = activity_.frames.load();
+        now.analysisFrames = activity_.analysisFrames.load();
+        now.stills = activity_.stills.load();
+        now.reads = activity_.reads.load();
+        now.maxLatencyMs = static_cast<double>(activity_.maxLatencyNs.exchange(0)) / kNsPerMs;
+        now.rssKb = residentKb();
+
+        Report delta = now;
+        delta.operations -= last_.operations;
+        delta.imuSamples -= last_.imuSamples;
+        delta.frames -= last_.frames;
+        delta.analysisFrames -= last_.analysisFrames;
+        delta.stills -= last_.stills;
+        delta.reads -= last_.reads;
+        const double interval = std::max(seconds - last_.seconds, 1e-3);
+        std::printf("[ SOAK     ] %7.1fs  ops %6.0f/s  imu %6.0f/s  frames %5.0f/s  analysis %5.0f/s  "
+                    "reads %6.0f/s  max latency %6.1f ms  rss %7lld kB\n",
+                    seconds, static_cast<double>(delta.operations) / interval,
+                    static_cast<double>(delta.imuSamples) / interval, static_cast<double>(delta.frames) / interval,
+                    static_cast<double>(delta.analysisFrames) / interval,
+                    static_cast<double>(delta.reads) / interval, now.maxLatencyMs,
+                    static_cast<long long>(now.rssKb));
+        std::fflush(stdout);
+        last_ = now;
+        return delta;
+    }
+
+private:
+    template<typename Action>
+    void guarded(const char* operation, Action&& action) {
+        watchdog_.enter(operation);
+        action();
+        watchdog_.leave();
+    }
+
+    int32_t pickFrom(const std::vector<int32_t>& handles) {
+        return handles[std::uniform_int_distribution<size_t>(0, handles.size() - 1)(random_)];
+    }
+
+    /// Replace the slot's stream; the old one stops in its destructor
+    void createStream(CameraSlot& slot) {
+        slot.stream = std::make_unique<CameraStream>(cameras_);
+        slot.stream->setFrameCallback([this](const FrameMetadata& frame) {
+            activity_.frames.fetch_add(1, std::memory_order_relaxed);
+            activity_.latency(frame.timestampNs);
+        });
+        slot.stream->setAnalysisOutput(slot.pool, [this, &slot](const FrameRef& frame) {
+            activity_.analysisFrames.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(slot.heldMutex);
+            slot.held.push_back(frame);
+            if (slot.held.size() > kHeldFrames) {
+                slot.held.pop_front();
+            }
+        });
+        slot.stream->setStillOutput(slot.info.width, slot.info.height);
+    }
+
+    void readLoop() {
+        while (!readerStopped_.load(std::memory_order_acquire)) {
+            (void)imu_.getStats();
+            (void)imu_.getLatestAccel();
+            (void)imu_.getLatestGyro();
+            (void)imu_.getMetadata();
+            {
+                std::lock_guard<std::mutex> lock(slotsMutex_);
+                for (const auto& slot : slots_) {
+                    (void)slot->stream->getStats();
+                    (void)slot->stream->isStreaming();
+                    (void)slot->stream->getCurrentCameraId();
+                }
+            }
+            activity_.reads.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    std::mt19937_64 random_;
+    MailboxRegistry mailboxes_;
+    ImuManager imu_;
+    CameraManager cameras_;
+    std::vector<int32_t> accelHandles_;
+    std::vector<int32_t> gyroHandles_;
+
+    std::mutex slotsMutex_;                     // Streams being replaced vs. the reader
+    std::vector<std::unique_ptr<CameraSlot>> slots_;
+
+    Activity activity_;
+    Report last_;
+    Watchdog watchdog_;
+    std::atomic<bool> readerStopped_{false};
+    std::thread reader_;
+};
+
+class SoakTest : public SyntheticBackendTest {};
+
+TEST_F(SoakTest, RandomizedLifecycleKeepsInvariants) {
+    const auto duration = std::chrono::seconds(envOr("NATIVESENSOR_SOAK_SECONDS", 3));
+    const bool longSoak = std::getenv("NATIVESENSOR_SOAK_SECONDS") != nullptr;
+    const auto seed = static_cast<uint64_t>(
+        envOr("NATIVESENSOR_SOAK_SEED", longSoak ? std::random_device{}() : static_cast<int64_t>(kDefaultSeed)));
+    // About 60 reports over a long soak, one per second over a short one
+    const auto interval = std::max<std::chrono::steady_clock::duration>(duration / 60, std::chrono::seconds(1));
+    std::printf("[ SOAK     ] %llds, seed %llu\n", static_cast<long long>(duration.count()),
+                static_cast<unsigned long long>(seed));
+    RecordProperty("seed", std::to_string(seed));
+    SCOPED_TRACE("NATIVESENSOR_SOAK_SEED=" + std::to_string(seed));
+
+    std::vector<Report> reports;
+    {
+        Soak soak(seed);
+        ASSERT_TRUE(soak.ready());
+
+        std::mt19937 pacing(static_cast<uint32_t>(seed));
+        const auto start = std::chrono::steady_clock::now();
+        auto nextReport = start + interval;
+        while (std::chrono::steady_clock::now() - start < duration && !HasFailure()) {
+            soak.step();
+            // Mostly back to back, now and then long enough for frames to flow
+            if (std::uniform_int_distribution<int>(0, 9)(pacing) == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(
+                    std::uniform_int_distribution<int>(1, 20)(pacing)));
+            }
+            if (std::chrono::steady_clock::now() >= nextReport) {
+                soak.checkpoint();
+                const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                reports.push_back(soak.report(elapsed.count()));
+                EXPECT_LT(reports.back().maxLatencyMs, kMaxLatencyMs);
+                nextReport += interval;
+            }
+        }
+        soak.checkpoint();
+    }
+
+    if (HasFailure()) {
+        return;
+    }
+    ASSERT_FALSE(reports.empty());
+    int64_t operations = 0;
+    int64_t frames = 0;
+    int64_t stills = 0;
+    for (const auto& report : reports) {
+        operations += report.operations;
+        frames += report.frames;
+        stills += report.stills;
+    }
+    EXPECT_GT(operations, 0);
+    EXPECT_GT(frames, 0);
+
+    // Measured past the first quarter: pools, readers and allocator arenas warm up first
+    const int64_t rssGrowthKb = reports.back().rssKb - reports[reports.size() / 4].rssKb;
+    std::printf("[ SOAK     ] %lld operations, %lld frames, %lld stills, rss %+lld kB over %zu reports\n",
+                static_cast<long long>(operations), static_cast<long long>(frames), static_cast<long long>(stills),
+                static_cast<long long>(rssGrowthKb), reports.size());
+    RecordProperty("operations", std::to_string(operations));
+    RecordProperty("rssGrowthKb", std::to_string(rssGrowthKb));
+    if (!kSanitized) {
+        EXPECT_LT(rssGrowthKb, kMaxRssGrowthKb);
+    }
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,109 @@
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "startup_orchestrator.h"
+#include "test_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+TEST(StartupOrchestratorTest, IndependentSubsystemsRunConcurrently) {
+    StartupOrchestrator startup;
+    std::atomic<bool> aStarted{false};
+    std::atomic<bool> bStarted{false};
+    // Each only finishes once it saw the other running
+    startup.add("a", [&] {
+        aStarted = true;
+        return waitUntil([&] { return bStarted.load(); });
+    });
+    startup.add("b", [&] {
+        bStarted = true;
+        return waitUntil([&] { return aStarted.load(); });
+    });
+    startup.launch();
+    EXPECT_TRUE(startup.waitFor("a"));
+    EXPECT_TRUE(startup.waitFor("b"));
+}
+
+TEST(StartupOrchestratorTest, DependentsRunAfterAndSkipFailedDependencies) {
+    StartupOrchestrator startup;
+    std::atomic<bool> baseDone{false};
+    std::atomic<bool> dependentSawBase{false};
+    std::atomic<bool> skippedRan{false};
+    startup.add("base", [&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        baseDone = true;
+        return true;
+    });
+    startup.add("broken", [] { return false; });
+    startup.add("dependent", [&] {
+        dependentSawBase = baseDone.load();
+        return true;
+    }, {"base"});
+    startup.add("skipped", [&] {
+        skippedRan = true;
+        return true;
+    }, {"base", "broken"});
+    startup.launch();
+
+    EXPECT_TRUE(startup.waitFor("dependent"));
+    EXPECT_TRUE(dependentSawBase.load());
+    EXPECT_FALSE(startup.waitFor("broken"));
+    EXPECT_FALSE(startup.waitFor("skipped"));
+    EXPECT_FALSE(skippedRan.load());
+}
+
+TEST(StartupOrchestratorTest, OnReadyRunsOnceReadyAndNeverOnFailure) {
+    StartupOrchestrator startup;
+    std::atomic<bool> release{false};
+    startup.add("slow", [&] { return waitUntil([&] { return release.load(); }); });
+    startup.add("broken", [] { return false; });
+    startup.launch();
+
+    std::atomic<int> slowContinuations{0};
+    std::atomic<int> brokenContinuations{0};
+    startup.onReady("slow", [&] { ++slowContinuations; });
+    startup.onReady("broken", [&] { ++brokenContinuations; });
+    EXPECT_EQ(slowContinuations.load(), 0);
+    release = true;
+    ASSERT_TRUE(startup.waitFor("slow"));
+    EXPECT_TRUE(waitUntil([&] { return slowContinuations.load() == 1; }));
+
+    // Already ready: runs inline
+    startup.onReady("slow", [&] { ++slowContinuations; });
+    EXPECT_EQ(slowContinuations.load(), 2);
+    EXPECT_FALSE(startup.waitFor("broken"));
+    EXPECT_EQ(brokenContinuations.load(), 0);
+}
+
+TEST(StartupOrchestratorTest, TimingsAndUnknownNames) {
+    StartupOrchestrator startup;
+    startup.add("a", [] { return true; });
+    startup.add("b", [] { return false; }, {"a"});
+    EXPECT_FALSE(startup.waitFor("a"));  // Not launched yet
+    startup.add("a", [] { return false; });  // Duplicate, ignored
+    startup.launch();
+    ASSERT_TRUE(startup.waitFor("a"));
+    ASSERT_FALSE(startup.waitFor("b"));
+    EXPECT_FALSE(startup.waitFor("missing"));
+
+    const std::vector<SubsystemTiming> timings = startup.getTimings();
+    ASSERT_EQ(timings.size(), 2u);
+    EXPECT_EQ(timings[0].name, "a");
+    EXPECT_TRUE(timings[0].ready);
+    EXPECT_FALSE(timings[1].ready);
+    for (const auto& timing : timings) {
+        EXPECT_GE(timing.startNs, startup.getLaunchTimeNs());
+        EXPECT_GE(timing.endNs, timing.startNs);
+    }
+    // The dependent starts once its dependency finished
+    EXPECT_GE(timings[1].startNs, timings[0].endNs);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,169 @@
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "calibration_store.h"
+#include "frame_pool.h"
+#include "stereo_depth.h"
+#include "thread_pool.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr int32_t kWidth = 160;
+constexpr int32_t kHeight = 96;
+constexpr float kFocalPx = 100.0f;
+constexpr float kBaseline = 0.05f;
+constexpr int32_t kDisparity = 8;
+
+/// Undistorted camera looking along +z, `offsetX` meters right of the IMU
+CameraInfo camera(const char* id, float offsetX) {
+    CameraInfo info;
+    info.id = id;
+    info.width = kWidth;
+    info.height = kHeight;
+    CameraCalibration& c = info.calibration;
+    c.fx = kFocalPx;
+    c.fy = kFocalPx;
+    c.cx = 0.5f * kWidth;
+    c.cy = 0.5f * kHeight;
+    c.activeArrayWidth = kWidth;
+    c.activeArrayHeight = kHeight;
+    c.poseTranslation[0] = offsetX;
+    c.poseReference = LensPoseReference::Gyroscope;
+    c.hasIntrinsics = true;
+    c.hasPose = true;
+    return info;
+}
+
+/// Texture seen by the camera at x = 0 (left); the other one sees it
+/// kDisparity pixels further left
+FrameRef frame(FramePool& pool, const std::string& cameraId, int32_t shift, int64_t timestampNs) {
+    FrameRef ref = pool.acquire();
+    if (!ref) {
+        return ref;
+    }
+    for (int32_t y = 0; y < kHeight; ++y) {
+        uint8_t* row = ref->row(y);
+        for (int32_t x = 0; x < kWidth; ++x) {
+            uint32_t h = static_cast<uint32_t>(x + shift) * 2654435761u ^ static_cast<uint32_t>(y) * 40503u;
+            h ^= h >> 13;
+            row[x] = static_cast<uint8_t>(h * 2246822519u >> 24);
+        }
+    }
+    ref->metadata.cameraId = cameraId;
+    ref->metadata.timestampNs = timestampNs;
+    return ref;
+}
+
+class StereoDepthTest : public ::testing::Test {
+protected:
+    StereoDepthTest() : store_("", "device"), pool_(2), frames_(kWidth, kHeight, 6) {
+        store_.update({camera("0", 0.0f), camera("1", kBaseline), withoutPose("2")});
+    }
+
+    static CameraInfo withoutPose(const char* id) {
+        CameraInfo info = camera(id, 0.0f);
+        info.calibration.hasPose = false;
+        return info;
+    }
+
+    CalibrationStore store_;
+    ThreadPool pool_;
+    FramePool frames_;
+};
+
+TEST_F(StereoDepthTest, RejectsPairsThatCantBeRectified) {
+    StereoDepth stereo(store_, pool_);
+    EXPECT_FALSE(stereo.setPair("0", "0"));
+    EXPECT_FALSE(stereo.setPair("0", "2"));
+    EXPECT_FALSE(stereo.setPair("0", "missing"));
+    EXPECT_TRUE(stereo.setPair("0", "1"));
+}
+
+TEST_F(StereoDepthTest, DepthOfAFrontoParallelPlane) {
+    StereoDepth stereo(store_, pool_);
+    // Given right first: the rectifier still makes "0" the left camera
+    ASSERT_TRUE(stereo.setPair("1", "0"));
+
+    std::shared_ptr<const StereoFrame> out;
+    EXPECT_FALSE(stereo.process(frame(frames_, "0", 0, 1'000'000), out));
+    ASSERT_TRUE(stereo.process(frame(frames_, "1", kDisparity, 1'500'000), out));
+    ASSERT_NE(out, nullptr);
+    EXPECT_EQ(out->leftId, "0");
+    EXPECT_EQ(out->rightId, "1");
+    EXPECT_EQ(out->timestampNs, 1'000'000);
+    EXPECT_FLOAT_EQ(out->focalPx, kFocalPx);
+    EXPECT_NEAR(out->baseline, kBaseline, 1e-6f);
+
+    const float expectedDepth = kFocalPx * kBaseline / kDisparity;
+    int valid = 0;
+    int close = 0;
+    for (int32_t y = 8; y < kHeight - 8; ++y) {
+        for (int32_t x = 16; x < kWidth - 8; ++x) {
+            const float depth = out->depthAt(x, y);
+            valid += depth > 0.0f;
+            close += std::abs(depth - expectedDepth) < 0.02f * expectedDepth;
+        }
+    }
+    const int total = (kHeight - 16) * (kWidth - 24);
+    EXPECT_GT(valid, total * 9 / 10);
+    EXPECT_GT(close, total * 9 / 10);
+}
+
+TEST_F(StereoDepthTest, FramesTooFarApartAreNotPaired) {
+    StereoDepth stereo(store_, pool_);
+    ASSERT_TRUE(stereo.setPair("0", "1"));
+    std::shared_ptr<const StereoFrame> out;
+    EXPECT_FALSE(stereo.process(frame(frames_, "0", 0, 0), out));
+    EXPECT_FALSE(stereo.process(frame(frames_, "1", kDisparity, StereoDepth::kMaxPairSkewNs + 1), out));
+    EXPECT_FALSE(stereo.process(frame(frames_, "2", 0, StereoDepth::kMaxPairSkewNs + 1), out));
+    // The stale left frame was dropped; the next one completes the pair
+    EXPECT_TRUE(stereo.process(frame(frames_, "0", 0, StereoDepth::kMaxPairSkewNs), out));
+    EXPECT_EQ(out->timestampNs, StereoDepth::kMaxPairSkewNs);
+}
+
+TEST_F(StereoDepthTest, OutputsAreRecycledOnceReleased) {
+    StereoDepth stereo(store_, pool_);
+    ASSERT_TRUE(stereo.setPair("0", "1"));
+    std::vector<std::shared_ptr<const StereoFrame>> held;
+    int64_t timestampNs = 0;
+    for (int i = 0; i < 4; ++i) {
+        timestampNs += 33'000'000;
+        std::shared_ptr<const StereoFrame> out;
+        EXPECT_FALSE(stereo.process(frame(frames_, "0", 0, timestampNs), out));
+        const bool paired = stereo.process(frame(frames_, "1", kDisparity, timestampNs), out);
+        EXPECT_EQ(paired, i < 3) << i;
+        if (paired) {
+            held.push_back(out);
+        }
+    }
+    EXPECT_EQ(stereo.droppedPairs(), 1);
+
+    const StereoFrame* first = held.front().get();
+    held.clear();
+    std::shared_ptr<const StereoFrame> out;
+    timestampNs += 33'000'000;
+    EXPECT_FALSE(stereo.process(frame(frames_, "0", 0, timestampNs), out));
+    ASSERT_TRUE(stereo.process(frame(frames_, "1", kDisparity, timestampNs), out));
+    EXPECT_EQ(out.get(), first);
+}
+
+TEST_F(StereoDepthTest, OutputsOutliveTheStage) {
+    std::shared_ptr<const StereoFrame> out;
+    {
+        StereoDepth stereo(store_, pool_);
+        ASSERT_TRUE(stereo.setPair("0", "1"));
+        EXPECT_FALSE(stereo.process(frame(frames_, "0", 0, 33'000'000), out));
+        ASSERT_TRUE(stereo.process(frame(frames_, "1", kDisparity, 33'000'000), out));
+    }
+    EXPECT_EQ(out->leftId, "0");
+    EXPECT_FALSE(out->disparity.data.empty());
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "calibration_store.h"
+#include "geometry.h"
+#include "stereo_rectify.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr int32_t kWidth = 320;
+constexpr int32_t kHeight = 240;
+
+/// Distorted camera at `center`, turned by `rotationVector` (reference to
+/// camera) away from looking along +z
+CameraCalibration camera(const Vec3& center, const Vec3& rotationVector, float focal) {
+    CameraCalibration c;
+    c.fx = focal;
+    c.fy = focal * 1.01f;
+    c.cx = 0.5f * kWidth + 3.0f;
+    c.cy = 0.5f * kHeight - 2.0f;
+    c.distortion[0] = -0.05f;
+    c.distortion[1] = 0.01f;
+    c.distortion[3] = 0.0005f;
+    const Quat rotation = quat::fromRotationVector(rotationVector);
+    c.poseRotation[0] = rotation.x;
+    c.poseRotation[1] = rotation.y;
+    c.poseRotation[2] = rotation.z;
+    c.poseRotation[3] = rotation.w;
+    c.poseTranslation[0] = center.x;
+    c.poseTranslation[1] = center.y;
+    c.poseTranslation[2] = center.z;
+    c.poseReference = LensPoseReference::Gyroscope;
+    c.activeArrayWidth = kWidth;
+    c.activeArrayHeight = kHeight;
+    c.hasIntrinsics = true;
+    c.hasDistortion = true;
+    c.hasPose = true;
+    return c;
+}
+
+const Vec3 kLeftCenter{0.0f, 0.0f, 0.0f};
+const Vec3 kRightCenter{0.06f, 0.002f, -0.001f};
+
+CameraCalibration leftCamera() {
+    return camera(kLeftCenter, {0.02f, -0.03f, 0.01f}, 200.0f);
+}
+
+CameraCalibration rightCamera() {
+    return camera(kRightCenter, {-0.01f, 0.02f, 0.005f}, 210.0f);
+}
+
+/// Raw stream pixel at which `c` sees the reference-frame point `p`
+void project(const CameraCalibration& c, const Vec3& p, float& u, float& v) {
+    const Quat rotation{c.poseRotation[3], c.poseRotation[0], c.poseRotation[1], c.poseRotation[2]};
+    const Vec3 center{c.poseTranslation[0], c.poseTranslation[1], c.poseTranslation[2]};
+    const Vec3 inCamera = toMat3(normalized(rotation)) * (p - center);
+    projectDistorted(c, scaledIntrinsics(c, kWidth, kHeight), inCamera.x / inCamera.z, inCamera.y / inCamera.z, u, v);
+}
+
+/// Source pixel a rectification map samples for rectified pixel (u, v)
+void lookUp(const UndistortionMap& map, int32_t u, int32_t v, float& x, float& y) {
+    const size_t index = 2 * (static_cast<size_t>(v) * static_cast<size_t>(map.width) + static_cast<size_t>(u));
+    x = map.coords[index];
+    y = map.coords[index + 1];
+}
+
+// A point seen at rectified pixel (u, v) on the left is at (u - d, v) on the
+// right, d = f * baseline / depth, and both maps sample where the raw
+// (rotated, distorted) cameras actually see it
+TEST(StereoRectifyTest, RectifiedRowsMatchAndDisparityGivesDepth) {
+    const CameraCalibration left = leftCamera();
+    const CameraCalibration right = rightCamera();
+    const auto rectification = computeStereoRectification("L", left, "R", right, kWidth, kHeight);
+    ASSERT_NE(rectification, nullptr);
+    EXPECT_EQ(rectification->leftId, "L");
+    EXPECT_EQ(rectification->rightId, "R");
+    EXPECT_NEAR(rectification->baseline, norm(kRightCenter - kLeftCenter), 1e-6f);
+
+    // One pinhole model with the shorter focal length, centered
+    const PinholeIntrinsics& k = rectification->intrinsics;
+    EXPECT_FLOAT_EQ(k.fx, 200.0f);
+    EXPECT_FLOAT_EQ(k.fy, 200.0f);
+    EXPECT_FLOAT_EQ(k.cx, 0.5f * kWidth);
+    EXPECT_FLOAT_EQ(k.cy, 0.5f * kHeight);
+    EXPECT_EQ(k.skew, 0.0f);
+
+    // The rectified x axis is the baseline
+    const Vec3 baselineAxis = rectification->rectifiedFromReference * (kRightCenter - kLeftCenter);
+    EXPECT_NEAR(baselineAxis.x, rectification->baseline, 1e-6f);
+    EXPECT_NEAR(baselineAxis.y, 0.0f, 1e-6f);
+    EXPECT_NEAR(baselineAxis.z, 0.0f, 1e-6f);
+
+    const Mat3 referenceFromRectified = rectification->rectifiedFromReference.transposed();
+    float worst = 0.0f;
+    for (int32_t v = 30; v < kHeight - 30; v += 45) {
+        for (int32_t u = 60; u < kWidth - 30; u += 50) {
+            for (const int32_t disparity : {4, 12, 30}) {
+                const float depth = rectification->depthFromDisparity(static_cast<float>(disparity));
+                EXPECT_NEAR(depth, k.fx * rectification->baseline / static_cast<float>(disparity), 1e-5f);
+                const Vec3 inRectified{(static_cast<float>(u) - k.cx) * depth / k.fx,
+                                       (static_cast<float>(v) - k.cy) * depth / k.fy, depth};
+                const Vec3 point = kLeftCenter + referenceFromRectified * inRectified;
+
+                float expectedX = 0.0f;
+                float expectedY = 0.0f;
+                float x = 0.0f;
+                float y = 0.0f;
+                project(left, point, expectedX, expectedY);
+                lookUp(rectification->left, u, v, x, y);
+                worst = std::max({worst, std::fabs(x - expectedX), std::fabs(y - expectedY)});
+                project(right, point, expectedX, expectedY);
+                lookUp(rectification->right, u - disparity, v, x, y);
+                worst = std::max({worst, std::fabs(x - expectedX), std::fabs(y - expectedY)});
+            }
+        }
+    }
+    EXPECT_LT(worst, 1e-3f);
+    EXPECT_EQ(rectification->depthFromDisparity(0.0f), 0.0f);
+}
+
+TEST(StereoRectifyTest, PairGivenRightFirstIsSwapped) {
+    const auto forward = computeStereoRectification("L", leftCamera(), "R", rightCamera(), kWidth, kHeight);
+    const auto swapped = computeStereoRectification("R", rightCamera(), "L", leftCamera(), kWidth, kHeight);
+    ASSERT_NE(forward, nullptr);
+    ASSERT_NE(swapped, nullptr);
+    EXPECT_EQ(swapped->leftId, "L");
+    EXPECT_EQ(swapped->rightId, "R");
+    EXPECT_FLOAT_EQ(swapped->baseline, forward->baseline);
+    ASSERT_EQ(swapped->left.coords.size(), forward->left.coords.size());
+    float worst = 0.0f;
+    for (size_t i = 0; i < forward->left.coords.size(); ++i) {
+        worst = std::max({worst, std::fabs(swapped->left.coords[i] - forward->left.coords[i]),
+                          std::fabs(swapped->right.coords[i] - forward->right.coords[i])});
+    }
+    EXPECT_LT(worst, 1e-3f);
+}
+
+TEST(StereoRectifyTest, NeedsIntrinsicsAndPosesInOneFrameApart) {
+    const CameraCalibration left = leftCamera();
+    EXPECT_TRUE(canRectify(left, rightCamera()));
+
+    CameraCalibration right = rightCamera();
+    right.hasIntrinsics = false;
+    EXPECT_FALSE(canRectify(left, right));
+    right = rightCamera();
+    right.hasPose = false;
+    EXPECT_FALSE(canRectify(left, right));
+    right = rightCamera();
+    right.poseReference = LensPoseReference::PrimaryCamera;
+    EXPECT_FALSE(canRectify(left, right));
+
+    CameraCalibration undefined = left;
+    undefined.poseReference = LensPoseReference::Undefined;
+    right = rightCamera();
+    right.poseReference = LensPoseReference::Undefined;
+    EXPECT_FALSE(canRectify(undefined, right));
+
+    // 4 mm apart, or the same camera twice
+    right = camera({0.004f, 0.0f, 0.0f}, {}, 200.0f);
+    EXPECT_FALSE(canRectify(left, right));
+    EXPECT_FALSE(canRectify(left, left));
+    EXPECT_EQ(computeStereoRectification("L", left, "L", left, kWidth, kHeight), nullptr);
+    EXPECT_EQ(computeStereoRectification("L", left, "R", rightCamera(), 0, kHeight), nullptr);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
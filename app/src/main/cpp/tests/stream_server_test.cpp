@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "stream_server.h"
+#include "test_utils.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr TimestampNs kProbeNs = 1;     // Marks messages sent only to sync on a subscription
+
+struct Received {
+    stream::MessageHeader header{};
+    std::vector<uint8_t> payload;
+
+    template<typename Payload>
+    Payload as() const {
+        Payload value{};
+        std::memcpy(&value, payload.data(), std::min(payload.size(), sizeof(value)));
+        return value;
+    }
+};
+
+/// Client end of the stream socket: blocking, with a receive timeout so a
+/// missing message fails the test instead of hanging it
+class StreamClient {
+public:
+    explicit StreamClient(const std::string& name) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, name.data(), name.size());
+        socklen_t length = sizeof(address);
+        if (name[0] == '@') {
+            address.sun_path[0] = '\0';
+            length = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + name.size());
+        }
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        const timeval timeout{5, 0};
+        if (::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0 ||
+            ::connect(fd_, reinterpret_cast<const sockaddr*>(&address), length) != 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    ~StreamClient() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    StreamClient(const StreamClient&) = delete;
+    StreamClient& operator=(const StreamClient&) = delete;
+
+    [[nodiscard]]
+    bool connected() const noexcept { return fd_ >= 0; }
+
+    ::testing::AssertionResult read(Received& message) {
+        if (!receive(&message.header, sizeof(message.header))) {
+            return ::testing::AssertionFailure() << "no message header";
+        }
+        message.payload.resize(message.header.payloadSize);
+        if (!receive(message.payload.data(), message.payload.size())) {
+            return ::testing::AssertionFailure() << "truncated payload";
+        }
+        return ::testing::AssertionSuccess();
+    }
+
+    bool send(stream::MessageType type, const void* payload, uint16_t size) {
+        std::vector<uint8_t> bytes(sizeof(stream::MessageHeader) + size);
+        const stream::MessageHeader header{type, size, 0};
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        std::memcpy(bytes.data() + sizeof(header), payload, size);
+        return ::send(fd_, bytes.data(), bytes.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(bytes.size());
+    }
+
+    bool subscribe(uint32_t streams) {
+        const stream::SubscribeMessage request{streams};
+        return send(stream::MessageType::Subscribe, &request, sizeof(request));
+    }
+
+    /// Nothing arrives (or the server hangs up) within `timeoutMs`
+    bool quiet(int timeoutMs) {
+        pollfd fd{fd_, POLLIN, 0};
+        return ::poll(&fd, 1, timeoutMs) == 0;
+    }
+
+    /// The server closed the connection (a reset if it left our bytes unread)
+    bool hungUp() {
+        uint8_t byte;
+        const ssize_t received = ::recv(fd_, &byte, 1, 0);
+        return received == 0 || (received < 0 && errno == ECONNRESET);
+    }
+
+private:
+    bool receive(void* data, size_t size) {
+        return size == 0 || ::recv(fd_, data, size, MSG_WAITALL) == static_cast<ssize_t>(size);
+    }
+
+    int fd_ = -1;
+};
+
+ImuSample imuSample(TimestampNs timestampNs) {
+    return {0.5f, -1.25f, 9.75f, timestampNs, SensorType::Gyroscope};
+}
+
+FrameMetadata frameMetadata(const std::string& cameraId, int64_t frameNumber) {
+    FrameMetadata frame;
+    frame.cameraId = cameraId;
+    frame.timestampNs = 5'000'000'000 + frameNumber * 33'000'000;
+    frame.frameNumber = frameNumber;
+    frame.exposureTimeNs = 8'000'000;
+    frame.rollingShutterSkewNs = 20'000'000;
+    frame.resultNs = frame.timestampNs + 40'000'000;
+    frame.width = 1920;
+    frame.height = 1080;
+    frame.format = 35;
+    return frame;
+}
+
+bool isProbe(const Received& message) {
+    return message.header.type == stream::MessageType::Imu ? message.as<stream::ImuMessage>().timestampNs == kProbeNs
+                                                           : message.as<stream::FrameMessage>().timestampNs == kProbeNs;
+}
+
+class StreamServerTest : public ::testing::Test {
+protected:
+    StreamServerTest() : name_("@nativesensor-test-" + std::to_string(::getpid()) + "-" + std::to_string(++next_)) {}
+
+    void SetUp() override { ASSERT_TRUE(server_.start(name_)); }
+
+    /// Connect and check the greeting
+    ::testing::AssertionResult connect(StreamClient& client) {
+        Received hello;
+        if (!client.connected() || !client.read(hello)) {
+            return ::testing::AssertionFailure() << "no connection to " << name_;
+        }
+        const auto payload = hello.as<stream::HelloMessage>();
+        if (hello.header.type != stream::MessageType::Hello || hello.header.payloadSize != sizeof(payload) ||
+            hello.header.dropped != 0 || std::memcmp(payload.magic, stream::kMagic, 4) != 0 ||
+            payload.version != stream::kProtocolVersion || payload.streams != stream::kAllStreams) {
+            return ::testing::AssertionFailure() << "bad hello";
+        }
+        return ::testing::AssertionSuccess();
+    }
+
+    /// Subscribe and wait until the server applies it: probes of `probe`, a
+    /// stream the previous subscription left out, get through. The probes
+    /// are read back.
+    ::testing::AssertionResult subscribe(StreamClient& client, uint32_t streams, uint32_t probe) {
+        const int64_t before = server_.getStats().published;
+        const bool applied = client.subscribe(streams) && waitUntil([&] {
+            if (probe == stream::kStreamImu) {
+                server_.publish(imuSample(kProbeNs));
+            } else {
+                FrameMetadata frame = frameMetadata("probe", 0);
+                frame.timestampNs = kProbeNs;
+                server_.publish(frame);
+            }
+            return server_.getStats().published > before;
+        });
+        if (!applied) {
+            return ::testing::AssertionFailure() << "subscription not applied";
+        }
+        // Probes published after the check are on their way too
+        while (!client.quiet(100)) {
+            Received message;
+            if (!client.read(message) || !isProbe(message)) {
+                return ::testing::AssertionFailure() << "expected only probes";
+            }
+        }
+        return ::testing::AssertionSuccess();
+    }
+
+    static inline std::atomic<int> next_{0};
+    const std::string name_;
+    StreamServer server_;
+};
+
+TEST_F(StreamServerTest, GreetsClientsAndSendsNothingBeforeTheySubscribe) {
+    StreamClient client(name_);
+    ASSERT_TRUE(connect(client));
+    ASSERT_TRUE(waitUntil([&] { return server_.getStats().clients == 1; }));
+
+    server_.publish(imuSample(1000));
+    server_.publish(frameMetadata("0", 1));
+    EXPECT_TRUE(client.quiet(50));
+    const StreamServerStats stats = server_.getStats();
+    EXPECT_EQ(stats.accepted, 1);
+    EXPECT_EQ(stats.published, 0);
+    EXPECT_EQ(stats.sent, 1);
+    EXPECT_EQ(stats.bytesSent, static_cast<int64_t>(sizeof(stream::MessageHeader) + sizeof(stream::HelloMessage)));
+}
+
+TEST_F(StreamServerTest, FramesImuAndFrameMessages) {
+    StreamClient client(name_);
+    ASSERT_TRUE(connect(client));
+    ASSERT_TRUE(subscribe(client, stream::kAllStreams, stream::kStreamImu));
+
+    server_.publish(imuSample(1000));
+    Received imu;
+    ASSERT_TRUE(client.read(imu));
+    EXPECT_EQ(imu.header.type, stream::MessageType::Imu);
+    EXPECT_EQ(imu.header.payloadSize, sizeof(stream::ImuMessage));
+    EXPECT_EQ(imu.header.dropped, 0u);
+    const auto sample = imu.as<stream::ImuMessage>();
+    EXPECT_EQ(sample.timestampNs, 1000);
+    EXPECT_EQ(sample.sensorType, static_cast<int32_t>(SensorType::Gyroscope));
+    EXPECT_EQ(sample.x, 0.5f);
+    EXPECT_EQ(sample.y, -1.25f);
+    EXPECT_EQ(sample.z, 9.75f);
+
+    // Camera ids longer than the limit are cut
+    const std::string longId(stream::kMaxCameraIdLength + 8, 'c');
+    for (const std::string& id : {std::string("1"), longId}) {
+        server_.publish(frameMetadata(id, 7));
+        Received message;
+        ASSERT_TRUE(client.read(message));
+        const size_t idLength = std::min(id.size(), stream::kMaxCameraIdLength);
+        EXPECT_EQ(message.header.type, stream::MessageType::Frame);
+        ASSERT_EQ(message.header.payloadSize, sizeof(stream::FrameMessage) + idLength);
+        const auto frame = message.as<stream::FrameMessage>();
+        const FrameMetadata expected = frameMetadata(id, 7);
+        EXPECT_EQ(frame.timestampNs, expected.timestampNs);
+        EXPECT_EQ(frame.frameNumber, 7);
+        EXPECT_EQ(frame.exposureTimeNs, expected.exposureTimeNs);
+        EXPECT_EQ(frame.rollingShutterSkewNs, expected.rollingShutterSkewNs);
+        EXPECT_EQ(frame.resultNs, expected.resultNs);
+        EXPECT_EQ(frame.width, 1920);
+        EXPECT_EQ(frame.height, 1080);
+        EXPECT_EQ(frame.format, 35);
+        EXPECT_EQ(frame.cameraIdLength, idLength);
+        EXPECT_EQ(std::string(message.payload.begin() + sizeof(frame), message.payload.end()), id.substr(0, idLength));
+    }
+}
+
+TEST_F(StreamServerTest, SubscribeReplacesTheSubscription) {
+    StreamClient client(name_);
+    ASSERT_TRUE(connect(client));
+    ASSERT_TRUE(subscribe(client, stream::kStreamImu, stream::kStreamImu));
+    ASSERT_TRUE(subscribe(client, stream::kStreamFrames, stream::kStreamFrames));
+
+    const int64_t published = server_.getStats().published;
+    server_.publish(imuSample(1000));
+    server_.publish(frameMetadata("0", 3));
+    Received message;
+    ASSERT_TRUE(client.read(message));
+    EXPECT_EQ(message.header.type, stream::MessageType::Frame);
+    EXPECT_TRUE(client.quiet(50));
+    EXPECT_EQ(server_.getStats().published, published + 1);
+}
+
+TEST_F(StreamServerTest, StalledClientsLoseTheirOldestMessages) {
+    StreamClient client(name_);
+    ASSERT_TRUE(connect(client));
+    ASSERT_TRUE(subscribe(client, stream::kStreamImu, stream::kStreamImu));
+
+    // The client stops reading; batches stay below the ingest queue so only
+    // its own queue drops
+    constexpr int64_t kSamples = 20'000;
+    constexpr int64_t kBatch = 1000;
+    const int64_t published = server_.getStats().published;
+    for (int64_t i = 0; i < kSamples; i += kBatch) {
+        for (int64_t j = i; j < i + kBatch; ++j) {
+            server_.publish(imuSample(1000 + j));
+        }
+        ASSERT_TRUE(waitUntil([&] { return server_.getStats().published == published + i + kBatch; }));
+    }
+    const int64_t dropped = server_.getStats().dropped;
+    EXPECT_GT(dropped, kSamples / 2);
+    EXPECT_EQ(server_.getStats().ingestDropped, 0);
+
+    // What arrives is in order, each gap announced by the next header, and
+    // ends with the newest sample
+    int64_t expected = 0;
+    int64_t announced = 0;
+    int64_t received = 0;
+    while (expected < kSamples) {
+        Received message;
+        ASSERT_TRUE(client.read(message)) << expected;
+        ASSERT_EQ(message.header.type, stream::MessageType::Imu);
+        expected += message.header.dropped;
+        announced += message.header.dropped;
+        ASSERT_EQ(message.as<stream::ImuMessage>().timestampNs, 1000 + expected);
+        ++expected;
+        ++received;
+    }
+    EXPECT_EQ(announced, dropped);
+    EXPECT_EQ(received + dropped, kSamples);
+    EXPECT_TRUE(client.quiet(50));
+    EXPECT_EQ(server_.getStats().dropped, dropped);
+}
+
+TEST_F(StreamServerTest, DisconnectsClientsOnHangUpOrBadRequests) {
+    {
+        StreamClient client(name_);
+        ASSERT_TRUE(connect(client));
+        ASSERT_TRUE(subscribe(client, stream::kStreamImu, stream::kStreamImu));
+    }
+    ASSERT_TRUE(waitUntil([&] { return server_.getStats().clients == 0; }));
+    // Nobody subscribed: publishing is a no-op again
+    const int64_t published = server_.getStats().published;
+    server_.publish(imuSample(1000));
+    EXPECT_EQ(server_.getStats().published, published);
+
+    StreamClient client(name_);
+    ASSERT_TRUE(connect(client));
+    const stream::HelloMessage hello{};
+    ASSERT_TRUE(client.send(stream::MessageType::Hello, &hello, sizeof(hello)));
+    EXPECT_TRUE(client.hungUp());
+    EXPECT_TRUE(waitUntil([&] { return server_.getStats().clients == 0; }));
+    EXPECT_EQ(server_.getStats().accepted, 2);
+}
+
+TEST(StreamServerPathTest, ListensOnFilesystemPathsAndRemovesThemOnStop) {
+    TempDir dir;
+    const std::string path = dir.path() + "/stream.sock";
+    StreamServer server;
+    ASSERT_TRUE(server.start(path));
+    EXPECT_TRUE(server.running());
+    EXPECT_TRUE(std::filesystem::exists(path));
+    {
+        StreamClient client(path);
+        Received hello;
+        ASSERT_TRUE(client.read(hello));
+        EXPECT_EQ(hello.header.type, stream::MessageType::Hello);
+    }
+    server.stop();
+    EXPECT_FALSE(server.running());
+    EXPECT_FALSE(std::filesystem::exists(path));
+
+    EXPECT_FALSE(server.start("@"));
+    EXPECT_FALSE(server.start(dir.path() + "/missing/stream.sock"));
+    EXPECT_FALSE(server.running());
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
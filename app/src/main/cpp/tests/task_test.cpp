@@ -0,0 +1,340 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "async_channel.h"
+#include "task.h"
+#include "test_utils.h"
+#include "thread_pool.h"
+
+namespace nativesensor::testing {
+namespace {
+
+/// Counts its destruction, so a test can see when a coroutine frame is freed
+class Token {
+public:
+    explicit Token(std::atomic<int>* destroyed) : destroyed_(destroyed) {}
+    Token(Token&& other) noexcept : destroyed_(std::exchange(other.destroyed_, nullptr)) {}
+    Token& operator=(Token&&) = delete;
+
+    ~Token() {
+        if (destroyed_) {
+            destroyed_->fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    std::atomic<int>* destroyed_;
+};
+
+/// The id of the single worker of `pool`
+std::thread::id workerId(ThreadPool& pool) {
+    std::thread::id id;
+    pool.submit([&id] { id = std::this_thread::get_id(); });
+    pool.waitIdle();
+    return id;
+}
+
+Task<int> square(int value, std::atomic<bool>& started) {
+    started.store(true, std::memory_order_release);
+    co_return value * value;
+}
+
+Task<int> sumOfSquares(int a, int b, std::atomic<bool>& started) {
+    const int first = co_await square(a, started);
+    co_return first + co_await square(b, started);
+}
+
+Task<void> addInto(Task<int> task, std::atomic<int>& total) {
+    total.fetch_add(co_await std::move(task), std::memory_order_relaxed);
+}
+
+Task<void> record(Task<void> task, std::atomic<bool>& done) {
+    co_await std::move(task);
+    done.store(true, std::memory_order_release);
+}
+
+Task<void> holdToken(Token, std::atomic<bool>& started) {
+    started.store(true, std::memory_order_release);
+    co_return;
+}
+
+/// Address of a local of a fresh stack frame, to compare stack depths
+[[gnu::noinline]] uintptr_t stackPosition() {
+    volatile char marker = 0;
+    return reinterpret_cast<uintptr_t>(&marker);
+}
+
+/// n nested awaits that all complete without suspending; the innermost
+/// records how deep the stack is at that point
+Task<int> depth(int n, uintptr_t& innermost) {
+    if (n == 0) {
+        innermost = stackPosition();
+        co_return 0;
+    }
+    co_return 1 + co_await depth(n - 1, innermost);
+}
+
+Task<void> measureDepth(int n, int& result, uintptr_t& outermost, uintptr_t& innermost) {
+    outermost = stackPosition();
+    result = co_await depth(n, innermost);
+}
+
+Task<void> hop(ThreadPool& to, std::thread::id& before, std::thread::id& after) {
+    before = std::this_thread::get_id();
+    co_await resumeOn(to);
+    after = std::this_thread::get_id();
+}
+
+TEST(TaskTest, StartsOnlyWhenAwaitedAndReturnsTheValue) {
+    ThreadPool pool(1);
+    std::atomic<bool> started{false};
+    std::atomic<int> total{0};
+    Task<void> task = addInto(sumOfSquares(3, 4, started), total);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_FALSE(started.load(std::memory_order_acquire));
+
+    std::atomic<bool> done{false};
+    spawn(pool, record(std::move(task), done));
+    ASSERT_TRUE(waitUntil([&done] { return done.load(std::memory_order_acquire); }));
+    EXPECT_TRUE(started.load(std::memory_order_acquire));
+    EXPECT_EQ(total.load(), 25);
+    pool.waitIdle();
+}
+
+TEST(TaskTest, DestroyingAnUnstartedTaskFreesItsFrame) {
+    std::atomic<int> destroyed{0};
+    std::atomic<bool> started{false};
+    {
+        Task<void> task = holdToken(Token(&destroyed), started);
+        EXPECT_EQ(destroyed.load(), 0);
+
+        // Moving hands over the frame; the moved-from task owns nothing
+        Task<void> moved = std::move(task);
+        EXPECT_EQ(destroyed.load(), 0);
+    }
+    EXPECT_EQ(destroyed.load(), 1);
+    EXPECT_FALSE(started.load(std::memory_order_acquire));
+
+    // A finished task frees its frame too, once the awaiter is done with it
+    ThreadPool pool(1);
+    std::atomic<bool> done{false};
+    spawn(pool, record(holdToken(Token(&destroyed), started), done));
+    ASSERT_TRUE(waitUntil([&done] { return done.load(std::memory_order_acquire); }));
+    pool.waitIdle();
+    EXPECT_TRUE(started.load(std::memory_order_acquire));
+    EXPECT_EQ(destroyed.load(), 2);
+}
+
+// Symmetric transfer: a long chain of awaits that never suspend doesn't grow
+// the stack of the thread running it
+TEST(TaskTest, DeepSynchronousChainsDoNotGrowTheStack) {
+#if !defined(__clang__) && !defined(__OPTIMIZE__)
+    GTEST_SKIP() << "GCC emits symmetric transfer as a tail call only when optimizing";
+#endif
+    constexpr int kDepth = 200'000;
+    ThreadPool pool(1);
+    int result = 0;
+    uintptr_t outermost = 0;
+    uintptr_t innermost = 0;
+    std::atomic<bool> done{false};
+    spawn(pool, record(measureDepth(kDepth, result, outermost, innermost), done));
+    ASSERT_TRUE(waitUntil([&done] { return done.load(std::memory_order_acquire); }));
+    pool.waitIdle();
+    EXPECT_EQ(result, kDepth);
+    // A frame per level would take megabytes
+    EXPECT_LT(outermost > innermost ? outermost - innermost : innermost - outermost, 4096u);
+}
+
+TEST(TaskTest, SpawnRunsOnThePoolAndResumeOnMovesToAnother) {
+    ThreadPool first(1);
+    ThreadPool second(1);
+    const std::thread::id firstWorker = workerId(first);
+    const std::thread::id secondWorker = workerId(second);
+
+    std::thread::id before;
+    std::thread::id after;
+    std::atomic<bool> done{false};
+    spawn(first, record(hop(second, before, after), done));
+    ASSERT_TRUE(waitUntil([&done] { return done.load(std::memory_order_acquire); }));
+    first.waitIdle();
+    second.waitIdle();
+    EXPECT_EQ(before, firstWorker);
+    EXPECT_EQ(after, secondWorker);
+}
+
+struct Item {
+    TimestampNs timestampNs = 0;
+};
+
+/// What the consumer got from each await, and the thread it ran on after it
+struct Consumed {
+    std::vector<std::vector<Item>> batches;
+    std::vector<std::optional<Item>> singles;
+    std::vector<std::thread::id> threads;
+};
+
+Task<void> consume(AsyncChannel<Item>& channel, Consumed& out, std::atomic<int>& step) {
+    for (int i = 0; i < 2; ++i) {
+        out.batches.push_back(co_await channel.nextBatch(2));
+        out.threads.push_back(std::this_thread::get_id());
+        step.fetch_add(1, std::memory_order_release);
+    }
+    while (true) {
+        out.singles.push_back(co_await channel.next());
+        out.threads.push_back(std::this_thread::get_id());
+        step.fetch_add(1, std::memory_order_release);
+        if (!out.singles.back()) {
+            break;
+        }
+    }
+}
+
+TEST(AsyncChannelTest, ConsumerTakesBatchesAndItemsAndSeesTheClose) {
+    ThreadPool pool(1);
+    const std::thread::id worker = workerId(pool);
+    AsyncChannel<Item> channel(pool, 16);
+    for (TimestampNs t = 1; t <= 5; ++t) {
+        channel.push({t});
+    }
+
+    Consumed consumed;
+    std::atomic<int> step{0};
+    spawn(pool, consume(channel, consumed, step));
+    // Two batches of two, then the fifth item; then the consumer waits
+    ASSERT_TRUE(waitUntil([&step] { return step.load(std::memory_order_acquire) == 3; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(step.load(std::memory_order_acquire), 3);
+
+    // Pushed from this thread; the consumer still resumes on the pool
+    channel.push({6});
+    ASSERT_TRUE(waitUntil([&step] { return step.load(std::memory_order_acquire) == 4; }));
+    channel.close();
+    channel.push({7});
+    ASSERT_TRUE(waitUntil([&step] { return step.load(std::memory_order_acquire) == 5; }));
+    pool.waitIdle();
+
+    ASSERT_EQ(consumed.batches.size(), 2u);
+    ASSERT_EQ(consumed.batches[0].size(), 2u);
+    ASSERT_EQ(consumed.batches[1].size(), 2u);
+    EXPECT_EQ(consumed.batches[0][0].timestampNs, 1);
+    EXPECT_EQ(consumed.batches[1][1].timestampNs, 4);
+    ASSERT_EQ(consumed.singles.size(), 3u);
+    ASSERT_TRUE(consumed.singles[0]);
+    EXPECT_EQ(consumed.singles[0]->timestampNs, 5);
+    ASSERT_TRUE(consumed.singles[1]);
+    EXPECT_EQ(consumed.singles[1]->timestampNs, 6);
+    EXPECT_FALSE(consumed.singles[2]);
+    for (const std::thread::id& thread : consumed.threads) {
+        EXPECT_EQ(thread, worker);
+    }
+    EXPECT_EQ(channel.dropped(), 0);
+}
+
+TEST(AsyncChannelTest, FullQueueDropsTheOldestItems) {
+    ThreadPool pool(1);
+    AsyncChannel<Item> channel(pool, 4);
+    for (TimestampNs t = 1; t <= 10; ++t) {
+        channel.push({t});
+    }
+    EXPECT_EQ(channel.dropped(), 6);
+
+    Consumed consumed;
+    std::atomic<int> step{0};
+    channel.close();
+    spawn(pool, consume(channel, consumed, step));
+    ASSERT_TRUE(waitUntil([&step] { return step.load(std::memory_order_acquire) == 3; }));
+    pool.waitIdle();
+
+    // The newest four, then the close
+    ASSERT_EQ(consumed.batches.size(), 2u);
+    ASSERT_EQ(consumed.batches[0].size(), 2u);
+    ASSERT_EQ(consumed.batches[1].size(), 2u);
+    EXPECT_EQ(consumed.batches[0][0].timestampNs, 7);
+    EXPECT_EQ(consumed.batches[1][1].timestampNs, 10);
+    ASSERT_EQ(consumed.singles.size(), 1u);
+    EXPECT_FALSE(consumed.singles[0]);
+}
+
+Task<void> collectUntil(AsyncChannel<Item>& channel, TimestampNs target,
+                        std::vector<Item>& out, std::atomic<bool>& done) {
+    out = co_await channel.until(target);
+    done.store(true, std::memory_order_release);
+}
+
+Task<void> drain(AsyncChannel<Item>& channel, std::atomic<int64_t>& count, std::atomic<bool>& done) {
+    while (true) {
+        const auto batch = co_await channel.nextBatch();
+        if (batch.empty()) {
+            break;
+        }
+        count.fetch_add(static_cast<int64_t>(batch.size()), std::memory_order_relaxed);
+    }
+    done.store(true, std::memory_order_release);
+}
+
+TEST(AsyncChannelTest, UntilCompletesAtTargetAndKeepsTheRest) {
+    ThreadPool pool(2);
+    AsyncChannel<Item> channel(pool, 16);
+    std::vector<Item> collected;
+    std::atomic<bool> done{false};
+    spawn(pool, collectUntil(channel, 30, collected, done));
+
+    channel.push({10});
+    channel.push({20});
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(done.load(std::memory_order_acquire));
+
+    channel.push({30});
+    channel.push({40});
+    ASSERT_TRUE(waitUntil([&done] { return done.load(std::memory_order_acquire); }));
+    ASSERT_EQ(collected.size(), 3u);
+    EXPECT_EQ(collected.back().timestampNs, 30);
+
+    // 40 stays queued for the next consumer, which ends when the channel closes
+    std::atomic<int64_t> count{0};
+    std::atomic<bool> drained{false};
+    spawn(pool, drain(channel, count, drained));
+    channel.close();
+    ASSERT_TRUE(waitUntil([&drained] { return drained.load(std::memory_order_acquire); }));
+    EXPECT_EQ(count.load(), 1);
+    pool.waitIdle();
+}
+
+// Producers on several threads, a slow-ish consumer: every item is either
+// consumed or counted as dropped
+TEST(AsyncChannelTest, ConcurrentProducersAccountForEveryItem) {
+    ThreadPool pool(2);
+    AsyncChannel<Item> channel(pool, 64);
+    std::atomic<int64_t> count{0};
+    std::atomic<bool> done{false};
+    spawn(pool, drain(channel, count, done));
+
+    constexpr int kProducers = 3;
+    constexpr int kPerProducer = 20'000;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&channel] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                channel.push({i});
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    channel.close();
+
+    ASSERT_TRUE(waitUntil([&done] { return done.load(std::memory_order_acquire); }));
+    EXPECT_EQ(count.load() + channel.dropped(), kProducers * kPerProducer);
+    pool.waitIdle();
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "camera_data.h"
+#include "synthetic_backend.h"
+#include "thread_pool.h"
+
+namespace nativesensor::testing {
+
+/// Poll `predicate` every millisecond until it holds or `timeout` passes
+template<typename Predicate>
+bool waitUntil(Predicate predicate, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+/// 4:3 active array with intrinsics, full distortion and a pose in the IMU
+/// frame; the principal point sits at the array center
+inline CameraInfo sampleCamera(const char* id) {
+    CameraInfo camera;
+    camera.id = id;
+    camera.width = 640;
+    camera.height = 480;
+    CameraCalibration& c = camera.calibration;
+    c.fx = 1600.0f;
+    c.fy = 1600.0f;
+    c.cx = 2000.0f;
+    c.cy = 1500.0f;
+    c.skew = 0.5f;
+    c.distortion[0] = -0.08f;       // k1
+    c.distortion[1] = 0.02f;        // k2
+    c.distortion[2] = -0.004f;      // k3
+    c.distortion[3] = 0.001f;       // p1
+    c.distortion[4] = -0.002f;      // p2
+    c.poseTranslation[0] = 0.5f;
+    c.poseReference = LensPoseReference::Gyroscope;
+    c.activeArrayWidth = 4000;
+    c.activeArrayHeight = 3000;
+    c.hasIntrinsics = true;
+    c.hasDistortion = true;
+    c.hasPose = true;
+    return camera;
+}
+
+/// Fresh directory under $TMPDIR (or /tmp), removed with its contents
+class TempDir {
+public:
+    TempDir() {
+        const char* base = std::getenv("TMPDIR");
+        std::string pattern = std::string(base && *base ? base : "/tmp") + "/nativesensor-XXXXXX";
+        if (mkdtemp(pattern.data())) {
+            path_ = pattern;
+        }
+    }
+
+    ~TempDir() {
+        if (!path_.empty()) {
+            std::error_code error;
+            std::filesystem::remove_all(path_, error);
+        }
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    [[nodiscard]]
+    const std::string& path() const noexcept { return path_; }
+
+private:
+    std::string path_;
+};
+
+/// Occupies one pool worker until released
+class BusyWorker {
+public:
+    void occupy(ThreadPool& pool) {
+        pool.submit([this] {
+            thread_ = std::this_thread::get_id();
+            running_.store(true, std::memory_order_release);
+            waitUntil([this] { return released_.load(std::memory_order_acquire); });
+        });
+        ASSERT_TRUE(waitUntil([this] { return running_.load(std::memory_order_acquire); }));
+    }
+
+    void release() { released_.store(true, std::memory_order_release); }
+
+    /// Worker thread it occupies (valid once occupy() returned)
+    [[nodiscard]]
+    std::thread::id thread() const { return thread_; }
+
+private:
+    std::atomic<bool> running_{false};
+    std::atomic<bool> released_{false};
+    std::thread::id thread_;
+};
+
+/// Fresh synthetic backends per test, and no NDK object left behind by it
+class SyntheticBackendTest : public ::testing::Test {
+protected:
+    void SetUp() override { resetSyntheticBackends(); }
+
+    void TearDown() override {
+        // Objects may be released by threads winding down just after the test body
+        waitUntil([] { return liveHandles().total() == 0; }, std::chrono::seconds(2));
+        EXPECT_EQ(liveHandles().total(), 0) << liveHandles().toString();
+    }
+};
+
+}  // namespace nativesensor::testing
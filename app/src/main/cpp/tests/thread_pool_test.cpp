@@ -0,0 +1,183 @@
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "test_utils.h"
+#include "thread_pool.h"
+
+namespace nativesensor::testing {
+namespace {
+
+/// Order in which tasks ran, by label
+class RunLog {
+public:
+    ThreadPool::Task record(std::string label) {
+        return [this, label = std::move(label)] {
+            std::lock_guard<std::mutex> lock(mutex_);
+            order_.push_back(label);
+            threads_.push_back(std::this_thread::get_id());
+        };
+    }
+
+    std::vector<std::string> order() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return order_;
+    }
+
+    std::vector<std::thread::id> threads() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return threads_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::string> order_;
+    std::vector<std::thread::id> threads_;
+};
+
+TEST(ThreadPoolTest, OwnerRunsHigherPriorityFirstNewestFirst) {
+    ThreadPool pool(1);
+    BusyWorker busy;
+    busy.occupy(pool);
+
+    RunLog log;
+    pool.submit(log.record("logging"), TaskPriority::Logging);
+    pool.submit(log.record("analysis1"), TaskPriority::Analysis);
+    pool.submit(log.record("tracking1"), TaskPriority::Tracking);
+    pool.submit(log.record("analysis2"), TaskPriority::Analysis);
+    pool.submit(log.record("tracking2"), TaskPriority::Tracking);
+    busy.release();
+    pool.waitIdle();
+
+    EXPECT_EQ(log.order(), (std::vector<std::string>{
+        "tracking2", "tracking1", "analysis2", "analysis1", "logging"}));
+    const ThreadPoolStats stats = pool.getStats();
+    EXPECT_EQ(stats.submitted, 6);
+    EXPECT_EQ(stats.executed, 6);
+    EXPECT_EQ(stats.stolen, 0);
+}
+
+TEST(ThreadPoolTest, IdleWorkerStealsOldestHighestPriorityFirst) {
+    ThreadPool pool(2);
+    BusyWorker thief;
+    thief.occupy(pool);
+
+    RunLog log;
+    std::atomic<int> childrenDone{0};
+    std::atomic<bool> childrenQueued{false};
+    std::atomic<bool> parentSawChildren{false};
+    std::thread::id parentThread;
+
+    // Tasks submitted from a worker go to its own deque; the parent then
+    // blocks its worker, so only the other one can run them once released
+    pool.submit([&] {
+        parentThread = std::this_thread::get_id();
+        auto child = [&](std::string label) {
+            return [&, task = log.record(std::move(label))] {
+                task();
+                childrenDone.fetch_add(1, std::memory_order_acq_rel);
+            };
+        };
+        for (int i = 0; i < 4; ++i) {
+            pool.submit(child("logging" + std::to_string(i)), TaskPriority::Logging);
+        }
+        for (int i = 0; i < 4; ++i) {
+            pool.submit(child("tracking" + std::to_string(i)), TaskPriority::Tracking);
+        }
+        childrenQueued.store(true, std::memory_order_release);
+        parentSawChildren = waitUntil([&] { return childrenDone.load(std::memory_order_acquire) == 8; });
+    });
+    ASSERT_TRUE(waitUntil([&] { return childrenQueued.load(std::memory_order_acquire); }));
+    thief.release();
+    pool.waitIdle();
+
+    ASSERT_TRUE(parentSawChildren.load());
+    EXPECT_EQ(log.order(), (std::vector<std::string>{
+        "tracking0", "tracking1", "tracking2", "tracking3",
+        "logging0", "logging1", "logging2", "logging3"}));
+    for (const auto& thread : log.threads()) {
+        EXPECT_EQ(thread, thief.thread());
+        EXPECT_NE(thread, parentThread);
+    }
+    EXPECT_GE(pool.getStats().stolen, 8);
+}
+
+TEST(ThreadPoolTest, WorkerTakesHigherPriorityWorkFromOthersBeforeItsOwn) {
+    ThreadPool pool(2);
+    RunLog log;
+    std::atomic<int> childrenDone{0};
+    auto child = [&](std::string label) {
+        return [&, task = log.record(std::move(label))] {
+            task();
+            childrenDone.fetch_add(1, std::memory_order_acq_rel);
+        };
+    };
+
+    // The owner queues a low-priority task on its own deque once released
+    std::atomic<bool> ownerRunning{false};
+    std::atomic<bool> ownerReleased{false};
+    pool.submit([&] {
+        ownerRunning.store(true, std::memory_order_release);
+        waitUntil([&] { return ownerReleased.load(std::memory_order_acquire); });
+        pool.submit(child("logging"), TaskPriority::Logging);
+    });
+    ASSERT_TRUE(waitUntil([&] { return ownerRunning.load(std::memory_order_acquire); }));
+
+    // The other worker queues tracking work on its deque and blocks
+    std::atomic<bool> trackingQueued{false};
+    std::atomic<bool> parentSawChildren{false};
+    pool.submit([&] {
+        pool.submit(child("tracking"), TaskPriority::Tracking);
+        trackingQueued.store(true, std::memory_order_release);
+        parentSawChildren = waitUntil([&] { return childrenDone.load(std::memory_order_acquire) == 2; });
+    });
+    ASSERT_TRUE(waitUntil([&] { return trackingQueued.load(std::memory_order_acquire); }));
+    ownerReleased.store(true, std::memory_order_release);
+    pool.waitIdle();
+
+    ASSERT_TRUE(parentSawChildren.load());
+    EXPECT_EQ(log.order(), (std::vector<std::string>{"tracking", "logging"}));
+    const auto threads = log.threads();
+    ASSERT_EQ(threads.size(), 2u);
+    EXPECT_EQ(threads[0], threads[1]);
+}
+
+TEST(ThreadPoolTest, ParallelForCallerDoesTheWorkWhenWorkersAreBusy) {
+    ThreadPool pool(2);
+    BusyWorker busy[2];
+    busy[0].occupy(pool);
+    busy[1].occupy(pool);
+
+    std::vector<std::thread::id> ranOn(64);
+    pool.parallelFor(ranOn.size(), [&ranOn](size_t i) { ranOn[i] = std::this_thread::get_id(); });
+    for (const auto& thread : ranOn) {
+        EXPECT_EQ(thread, std::this_thread::get_id());
+    }
+
+    // The helpers queued for it find nothing left and finish without running fn
+    busy[0].release();
+    busy[1].release();
+    pool.waitIdle();
+    const ThreadPoolStats stats = pool.getStats();
+    EXPECT_EQ(stats.executed, stats.submitted);
+}
+
+TEST(ThreadPoolTest, ParallelForInsideATaskDoesNotDeadlock) {
+    ThreadPool pool(1);
+    std::atomic<int> sum{0};
+    std::atomic<bool> done{false};
+    pool.submit([&] {
+        pool.parallelFor(100, [&sum](size_t i) { sum.fetch_add(static_cast<int>(i), std::memory_order_relaxed); });
+        done.store(true, std::memory_order_release);
+    });
+    ASSERT_TRUE(waitUntil([&done] { return done.load(std::memory_order_acquire); }));
+    pool.waitIdle();
+    EXPECT_EQ(sum.load(), 99 * 100 / 2);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
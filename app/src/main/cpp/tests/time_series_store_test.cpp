@@ -0,0 +1,304 @@
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "camera_data.h"
+#include "session_metrics.h"
+#include "test_utils.h"
+#include "time_series_store.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr TimestampNs kStartNs = 1'000'000'000;
+constexpr int64_t kPeriodNs = 1'000'000;
+
+TEST(TimeSeriesTest, AppendsInOrderAndQueriesTimeRanges) {
+    TempDir dir;
+    TimeSeries series("imu", dir.path() + "/imu", {"x", "y"});
+    ASSERT_TRUE(series.valid());
+    EXPECT_EQ(series.columnIndex("y"), 1);
+    EXPECT_EQ(series.columnIndex("z"), -1);
+
+    for (int i = 0; i < 100; ++i) {
+        const float values[2] = {static_cast<float>(i), static_cast<float>(-i)};
+        ASSERT_TRUE(series.append(kStartNs + i * kPeriodNs, values));
+    }
+    // Equal timestamps are fine; going back or a zero timestamp is not
+    const float values[2] = {1000.0f, 1000.0f};
+    EXPECT_TRUE(series.append(kStartNs + 99 * kPeriodNs, values));
+    EXPECT_FALSE(series.append(kStartNs + 98 * kPeriodNs, values));
+    EXPECT_FALSE(series.append(0, values));
+    EXPECT_EQ(series.rowCount(), 101u);
+    EXPECT_EQ(series.rejected(), 2);
+
+    std::vector<TimestampNs> timestamps;
+    std::vector<float> ys;
+    EXPECT_EQ(series.query(1, kStartNs + 10 * kPeriodNs - 1, kStartNs + 20 * kPeriodNs, &timestamps, &ys), 11u);
+    ASSERT_EQ(ys.size(), 11u);
+    EXPECT_EQ(timestamps.front(), kStartNs + 10 * kPeriodNs);
+    EXPECT_FLOAT_EQ(ys.front(), -10.0f);
+    EXPECT_FLOAT_EQ(ys.back(), -20.0f);
+
+    EXPECT_EQ(series.query(0, kStartNs + 99 * kPeriodNs, kStartNs + 1000 * kPeriodNs, nullptr, nullptr), 2u);
+    EXPECT_EQ(series.query(0, 0, kStartNs - 1, nullptr, nullptr), 0u);
+    EXPECT_EQ(series.query(2, 0, kStartNs * 2, nullptr, nullptr), 0u);
+}
+
+TEST(TimeSeriesTest, AggregatesPerWindowWithNearestRankPercentiles) {
+    TempDir dir;
+    TimeSeries series("latency", dir.path() + "/latency", {"ms"});
+    ASSERT_TRUE(series.valid());
+    // Window 0: 1..100 shuffled; window 1: a single value; window 2 empty;
+    // window 3: only missing values
+    for (int i = 0; i < 100; ++i) {
+        const float value = static_cast<float>((i * 37) % 100 + 1);
+        ASSERT_TRUE(series.append(kStartNs + i * kPeriodNs, &value));
+    }
+    const float single = 7.5f;
+    ASSERT_TRUE(series.append(kStartNs + 150 * kPeriodNs, &single));
+    const float missing = TimeSeries::missing();
+    ASSERT_TRUE(series.append(kStartNs + 350 * kPeriodNs, &missing));
+
+    const std::vector<WindowAggregate> windows =
+        series.aggregate(0, kStartNs, kStartNs + 400 * kPeriodNs, 100 * kPeriodNs);
+    ASSERT_EQ(windows.size(), 2u);
+    const WindowAggregate& first = windows[0];
+    EXPECT_EQ(first.startNs, kStartNs);
+    EXPECT_EQ(first.count, 100);
+    EXPECT_FLOAT_EQ(first.min, 1.0f);
+    EXPECT_FLOAT_EQ(first.max, 100.0f);
+    EXPECT_FLOAT_EQ(first.mean, 50.5f);
+    // Ranks round(p * 99): 50, 94 and 98 of 0..99
+    EXPECT_FLOAT_EQ(first.p50, 51.0f);
+    EXPECT_FLOAT_EQ(first.p95, 95.0f);
+    EXPECT_FLOAT_EQ(first.p99, 99.0f);
+
+    EXPECT_EQ(windows[1].startNs, kStartNs + 100 * kPeriodNs);
+    EXPECT_EQ(windows[1].count, 1);
+    EXPECT_FLOAT_EQ(windows[1].p99, 7.5f);
+
+    // One window over everything; missing values left out
+    const std::vector<WindowAggregate> whole = series.aggregate(0, 0, kStartNs * 2, 0);
+    ASSERT_EQ(whole.size(), 1u);
+    EXPECT_EQ(whole[0].count, 101);
+    EXPECT_FLOAT_EQ(whole[0].min, 1.0f);
+    EXPECT_TRUE(series.aggregate(0, kStartNs + 300 * kPeriodNs, kStartNs * 2, 0).empty());
+}
+
+TEST(TimeSeriesTest, RowsSpanSegments) {
+    TempDir dir;
+    TimeSeries series("long", dir.path() + "/long", {"v"});
+    ASSERT_TRUE(series.valid());
+    const size_t rows = TimeSeries::kSegmentRows + 10;
+    for (size_t i = 0; i < rows; ++i) {
+        const auto value = static_cast<float>(i);
+        ASSERT_TRUE(series.append(kStartNs + static_cast<int64_t>(i), &value));
+    }
+    std::vector<float> values;
+    const auto boundary = static_cast<int64_t>(TimeSeries::kSegmentRows);
+    EXPECT_EQ(series.query(0, kStartNs + boundary - 2, kStartNs + boundary + 1, nullptr, &values), 4u);
+    EXPECT_FLOAT_EQ(values.front(), static_cast<float>(boundary - 2));
+    EXPECT_FLOAT_EQ(values.back(), static_cast<float>(boundary + 1));
+}
+
+TEST(TimeSeriesTest, ReopeningContinuesAfterTheStoredRows) {
+    TempDir dir;
+    const std::string path = dir.path() + "/s";
+    {
+        TimeSeries series("s", path, {"a", "b"});
+        ASSERT_TRUE(series.valid());
+        for (int i = 0; i < 10; ++i) {
+            const float values[2] = {static_cast<float>(i), 0.0f};
+            ASSERT_TRUE(series.append(kStartNs + i * kPeriodNs, values));
+        }
+    }
+    TimeSeries series("s", path, {"a", "b"});
+    ASSERT_TRUE(series.valid());
+    EXPECT_EQ(series.rowCount(), 10u);
+    const float earlier[2] = {0.0f, 0.0f};
+    EXPECT_FALSE(series.append(kStartNs, earlier));
+    const float values[2] = {10.0f, 0.0f};
+    EXPECT_TRUE(series.append(kStartNs + 10 * kPeriodNs, values));
+
+    std::vector<float> a;
+    EXPECT_EQ(series.query(0, 0, kStartNs * 2, nullptr, &a), 11u);
+    EXPECT_FLOAT_EQ(a[9], 9.0f);
+    EXPECT_FLOAT_EQ(a[10], 10.0f);
+}
+
+TEST(TimeSeriesTest, ReopeningWithOtherColumnsLeavesTheRowsAlone) {
+    TempDir dir;
+    const std::string path = dir.path() + "/s";
+    {
+        TimeSeries series("s", path, {"a", "b"});
+        for (int i = 0; i < 5; ++i) {
+            const float values[2] = {static_cast<float>(i), 1.0f};
+            ASSERT_TRUE(series.append(kStartNs + i * kPeriodNs, values));
+        }
+    }
+    for (const std::vector<std::string>& columns :
+         {std::vector<std::string>{"a", "b", "c"}, {"a"}, {"b", "a"}, {}}) {
+        TimeSeries other("s", path, columns);
+        EXPECT_FALSE(other.valid()) << columns.size();
+        const float values[3] = {0.0f, 0.0f, 0.0f};
+        EXPECT_FALSE(other.append(kStartNs, values));
+    }
+
+    // Without the column list (older series) every column needs its file
+    ASSERT_TRUE(std::filesystem::remove(path + "/columns.txt"));
+    EXPECT_FALSE(TimeSeries("s", path, {"a", "b", "c"}).valid());
+    EXPECT_FALSE(std::filesystem::exists(path + "/c.f32"));
+
+    TimeSeries series("s", path, {"a", "b"});
+    ASSERT_TRUE(series.valid());
+    EXPECT_TRUE(std::filesystem::exists(path + "/columns.txt"));
+    std::vector<TimestampNs> timestamps;
+    std::vector<float> a;
+    EXPECT_EQ(series.query(0, 0, kStartNs * 2, &timestamps, &a), 5u);
+    EXPECT_EQ(timestamps.front(), kStartNs);
+    EXPECT_FLOAT_EQ(a.back(), 4.0f);
+}
+
+TEST(TimeSeriesTest, RowsFromAnEarlierBootAreMovedAside) {
+    TempDir dir;
+    const std::string path = dir.path() + "/s";
+    {
+        TimeSeries series("s", path, {"a"}, {}, "boot-a");
+        for (int i = 0; i < 5; ++i) {
+            const auto value = static_cast<float>(i);
+            ASSERT_TRUE(series.append(kStartNs + (10 + i) * kPeriodNs, &value));
+        }
+    }
+    {
+        // Same boot: the rows continue
+        TimeSeries series("s", path, {"a"}, {}, "boot-a");
+        EXPECT_EQ(series.rowCount(), 5u);
+    }
+
+    // The boot-time clock restarted below the stored rows
+    TimeSeries series("s", path, {"a"}, {}, "boot-b");
+    ASSERT_TRUE(series.valid());
+    EXPECT_EQ(series.rowCount(), 0u);
+    const float value = 1.0f;
+    EXPECT_TRUE(series.append(kStartNs, &value));
+    EXPECT_EQ(series.rejected(), 0);
+
+    TimeSeries archived("s", path + ".boot-boot-a", {"a"}, {}, "boot-a");
+    ASSERT_TRUE(archived.valid());
+    std::vector<float> a;
+    EXPECT_EQ(archived.query(0, 0, kStartNs * 2, nullptr, &a), 5u);
+    EXPECT_FLOAT_EQ(a.back(), 4.0f);
+}
+
+TEST(TimeSeriesTest, IntColumnsKeepLargeValuesExact) {
+    TempDir dir;
+    const std::string path = dir.path() + "/s";
+    constexpr int64_t kBase = (int64_t{1} << 40) + 1;    // Rounded by a float
+    {
+        TimeSeries series("s", path, {"a"}, {"n"});
+        ASSERT_TRUE(series.valid());
+        for (int i = 0; i < 3; ++i) {
+            const auto value = static_cast<float>(i);
+            const int64_t n = kBase + i;
+            ASSERT_TRUE(series.append(kStartNs + i * kPeriodNs, &value, &n));
+        }
+        const float value = 0.0f;
+        EXPECT_FALSE(series.append(kStartNs + 3 * kPeriodNs, &value));    // Int value missing
+    }
+    EXPECT_FALSE(TimeSeries("s", path, {"a", "n"}).valid());
+
+    TimeSeries series("s", path, {"a"}, {"n"});
+    ASSERT_TRUE(series.valid());
+    EXPECT_EQ(series.intColumnIndex("n"), 0);
+    EXPECT_EQ(series.columnIndex("n"), -1);
+    std::vector<int64_t> n;
+    EXPECT_EQ(series.queryInt(0, 0, kStartNs * 2, nullptr, &n), 3u);
+    EXPECT_EQ(n, (std::vector<int64_t>{kBase, kBase + 1, kBase + 2}));
+}
+
+TEST(TimeSeriesTest, ReadersSeeOnlyPublishedRowsWhileTheWriterAppends) {
+    TempDir dir;
+    TimeSeries series("live", dir.path() + "/live", {"v"});
+    ASSERT_TRUE(series.valid());
+    constexpr int kRows = 200'000;
+    std::thread writer([&] {
+        for (int i = 0; i < kRows; ++i) {
+            const auto value = static_cast<float>(i);
+            series.append(kStartNs + i, &value);
+        }
+    });
+
+    // Every visible row holds the value written with its timestamp
+    std::vector<TimestampNs> timestamps;
+    std::vector<float> values;
+    do {
+        timestamps.clear();
+        values.clear();
+        const size_t rows = series.rowCount();
+        const auto from = static_cast<int64_t>(rows > 100 ? rows - 100 : 0);
+        series.query(0, kStartNs + from, kStartNs + kRows, &timestamps, &values);
+        for (size_t i = 0; i < values.size(); ++i) {
+            EXPECT_FLOAT_EQ(values[i], static_cast<float>(timestamps[i] - kStartNs));
+        }
+    } while (series.rowCount() < static_cast<size_t>(kRows));
+    writer.join();
+    EXPECT_EQ(series.rejected(), 0);
+}
+
+TEST(TimeSeriesStoreTest, OpenSeriesReturnsTheOpenSeriesOnlyForTheSameColumns) {
+    TempDir dir;
+    TimeSeriesStore store(dir.path() + "/store");
+    TimeSeries* first = store.openSeries("camera/0", {"a"});
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(store.openSeries("camera/0", {"a"}), first);
+    EXPECT_EQ(store.openSeries("camera/0", {"a", "b"}), nullptr);
+    EXPECT_EQ(store.find("camera/0"), first);
+    EXPECT_EQ(store.find("camera/1"), nullptr);
+    EXPECT_EQ(store.series().size(), 1u);
+}
+
+TEST(SessionMetricsTest, FrameSeriesCountsDroppedFrames) {
+    TempDir dir;
+    SessionMetrics metrics(dir.path() + "/metrics");
+    constexpr int64_t kFrameNs = 33'000'000;
+    FrameMetadata frame;
+    frame.cameraId = "0";
+    frame.exposureTimeNs = 8'000'000;
+    TimestampNs t = kStartNs;
+    for (int i = 0; i < 20; ++i) {
+        // Two frames missing after the 15th
+        t += i == 15 ? 3 * kFrameNs : kFrameNs;
+        frame.timestampNs = t;
+        frame.frameNumber = i;
+        frame.resultNs = t + 12'000'000;
+        metrics.addFrame(frame);
+    }
+
+    TimeSeries* series = metrics.store().find("camera.0");
+    ASSERT_NE(series, nullptr);
+    EXPECT_EQ(series->rowCount(), 20u);
+    std::vector<float> dropped;
+    series->query(series->columnIndex("droppedFrames"), 0, t, nullptr, &dropped);
+    ASSERT_EQ(dropped.size(), 20u);
+    EXPECT_TRUE(TimeSeries::isMissing(dropped[0]));
+    EXPECT_FLOAT_EQ(dropped[15], 2.0f);
+    EXPECT_FLOAT_EQ(dropped[16], 0.0f);
+    std::vector<int64_t> frameNumbers;
+    series->queryInt(series->intColumnIndex("frameNumber"), 0, t, nullptr, &frameNumbers);
+    ASSERT_EQ(frameNumbers.size(), 20u);
+    EXPECT_EQ(frameNumbers[19], 19);
+
+    const std::vector<WindowAggregate> latency =
+        series->aggregate(series->columnIndex("latencyMs"), 0, t, 0);
+    ASSERT_EQ(latency.size(), 1u);
+    EXPECT_NEAR(latency[0].min, 12.0f, 1e-4f);
+    EXPECT_NEAR(latency[0].max, 12.0f, 1e-4f);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
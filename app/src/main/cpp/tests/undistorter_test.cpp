@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "calibration_store.h"
+#include "frame_pool.h"
+#include "remap.h"
+#include "undistorter.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr int32_t kWidth = 160;
+constexpr int32_t kHeight = 120;
+
+/// 4:3 camera with strong barrel distortion
+CameraInfo distortedCamera(const char* id, float k1) {
+    CameraInfo info;
+    info.id = id;
+    info.width = kWidth;
+    info.height = kHeight;
+    CameraCalibration& c = info.calibration;
+    c.fx = 600.0f;
+    c.fy = 600.0f;
+    c.cx = 322.0f;
+    c.cy = 238.0f;
+    c.distortion[0] = k1;
+    c.distortion[1] = 0.05f;
+    c.activeArrayWidth = 640;
+    c.activeArrayHeight = 480;
+    c.hasIntrinsics = true;
+    c.hasDistortion = true;
+    return info;
+}
+
+/// Pooled frame of `cameraId` filled with a diagonal ramp
+FrameRef rampFrame(FramePool& pool, const std::string& cameraId, int64_t timestampNs) {
+    FrameRef frame = pool.acquire();
+    if (!frame) {
+        return frame;
+    }
+    for (int32_t y = 0; y < frame->height(); ++y) {
+        for (int32_t x = 0; x < frame->width(); ++x) {
+            frame->row(y)[x] = static_cast<uint8_t>((x + 2 * y) * 255 / (frame->width() + 2 * frame->height()));
+        }
+    }
+    frame->metadata.cameraId = cameraId;
+    frame->metadata.timestampNs = timestampNs;
+    frame->metadata.frameNumber = 7;
+    return frame;
+}
+
+/// Largest difference between `out` and the float remap of `in` with `map`
+int maxErrorAgainstReference(const UndistortionMap& map, const FrameRef& in, const FrameRef& out) {
+    std::vector<uint8_t> reference(static_cast<size_t>(out->stride()) * static_cast<size_t>(out->height()));
+    remapFloat(map, in->data(), in->width(), in->height(), in->stride(), reference.data(), out->stride());
+    int maxError = 0;
+    for (int32_t y = 0; y < out->height(); ++y) {
+        for (int32_t x = 0; x < out->width(); ++x) {
+            const int error = std::abs(out->row(y)[x] - reference[static_cast<size_t>(y * out->stride() + x)]);
+            maxError = std::max(maxError, error);
+        }
+    }
+    return maxError;
+}
+
+class UndistorterTest : public ::testing::Test {
+protected:
+    UndistorterTest() : store_("", "device"), frames_(kWidth, kHeight, 4) {
+        CameraInfo uncalibrated;
+        uncalibrated.id = "raw";
+        store_.update({distortedCamera("0", -0.3f), uncalibrated});
+    }
+
+    CalibrationStore store_;
+    FramePool frames_;
+};
+
+TEST_F(UndistorterTest, RectifiesWithTheCamerasMapAndKeepsMetadata) {
+    Undistorter undistorter(store_);
+    const FrameRef in = rampFrame(frames_, "0", 1'000);
+    ASSERT_TRUE(in);
+    FrameRef out;
+    ASSERT_TRUE(undistorter.process(in, out));
+    ASSERT_TRUE(out);
+    EXPECT_EQ(out->width(), kWidth);
+    EXPECT_EQ(out->height(), kHeight);
+    EXPECT_EQ(out->metadata.cameraId, "0");
+    EXPECT_EQ(out->metadata.timestampNs, 1'000);
+    EXPECT_EQ(out->metadata.frameNumber, 7);
+    EXPECT_EQ(out->metadata.width, kWidth);
+    EXPECT_EQ(out->metadata.height, kHeight);
+
+    const auto map = store_.undistortionMap("0", kWidth, kHeight);
+    ASSERT_NE(map, nullptr);
+    EXPECT_LE(maxErrorAgainstReference(*map, in, out), 2);
+    // Barrel distortion pulled in: the center row is stretched, not copied
+    EXPECT_NE(std::vector<uint8_t>(out->row(kHeight / 2), out->row(kHeight / 2) + kWidth),
+              std::vector<uint8_t>(in->row(kHeight / 2), in->row(kHeight / 2) + kWidth));
+
+    // No intrinsics: nothing to rectify with
+    FrameRef raw = rampFrame(frames_, "raw", 2'000);
+    FrameRef rawOut;
+    EXPECT_FALSE(undistorter.process(raw, rawOut));
+    EXPECT_FALSE(rawOut);
+}
+
+TEST_F(UndistorterTest, FailsWhenItsOutputPoolIsExhausted) {
+    Undistorter undistorter(store_, 2);
+    const FrameRef in = rampFrame(frames_, "0", 1'000);
+    FrameRef first;
+    FrameRef second;
+    FrameRef third;
+    ASSERT_TRUE(undistorter.process(in, first));
+    ASSERT_TRUE(undistorter.process(in, second));
+    EXPECT_FALSE(undistorter.process(in, third));
+    EXPECT_FALSE(third);
+
+    first = FrameRef{};
+    EXPECT_TRUE(undistorter.process(in, third));
+}
+
+TEST_F(UndistorterTest, FollowsCalibrationAndStreamSizeChanges) {
+    Undistorter undistorter(store_);
+    const FrameRef in = rampFrame(frames_, "0", 1'000);
+    FrameRef before;
+    ASSERT_TRUE(undistorter.process(in, before));
+
+    // New calibration: a new map, same output size
+    store_.update({distortedCamera("0", -0.1f)});
+    FrameRef after;
+    ASSERT_TRUE(undistorter.process(in, after));
+    const auto map = store_.undistortionMap("0", kWidth, kHeight);
+    ASSERT_NE(map, nullptr);
+    EXPECT_LE(maxErrorAgainstReference(*map, in, after), 2);
+    EXPECT_GT(maxErrorAgainstReference(*map, in, before), 2);
+
+    // New stream size: outputs come from a new pool, while frames of the old
+    // one stay valid until released
+    FramePool small(kWidth / 2, kHeight / 2, 2);
+    const FrameRef smallIn = rampFrame(small, "0", 3'000);
+    FrameRef smallOut;
+    ASSERT_TRUE(undistorter.process(smallIn, smallOut));
+    EXPECT_EQ(smallOut->width(), kWidth / 2);
+    EXPECT_EQ(smallOut->metadata.width, kWidth / 2);
+    const auto smallMap = store_.undistortionMap("0", kWidth / 2, kHeight / 2);
+    ASSERT_NE(smallMap, nullptr);
+    EXPECT_LE(maxErrorAgainstReference(*smallMap, smallIn, smallOut), 2);
+    EXPECT_LE(maxErrorAgainstReference(*map, in, after), 2);
+
+    // The old pool goes away once its frames are back
+    before = FrameRef{};
+    after = FrameRef{};
+    ASSERT_TRUE(undistorter.process(smallIn, smallOut));
+    EXPECT_EQ(smallOut->width(), kWidth / 2);
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,118 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "test_utils.h"
+#include "time_utils.h"
+#include "vsync_source.h"
+
+namespace nativesensor::testing {
+namespace {
+
+constexpr double kRefreshHz = 100.0;
+constexpr int64_t kPeriodNs = 10'000'000;
+
+/// Timelines a VsyncSource delivered, with the boot time each arrived at
+class TimelineLog {
+public:
+    VsyncSource::TimelineCallback callback() {
+        return [this](const FrameTimeline& timeline) {
+            const TimestampNs arrivedNs = getBootTimeNs();
+            std::lock_guard<std::mutex> lock(mutex_);
+            timelines_.push_back(timeline);
+            arrivals_.push_back(arrivedNs);
+        };
+    }
+
+    [[nodiscard]]
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return timelines_.size();
+    }
+
+    [[nodiscard]]
+    std::vector<FrameTimeline> timelines() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return timelines_;
+    }
+
+    [[nodiscard]]
+    std::vector<TimestampNs> arrivals() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return arrivals_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<FrameTimeline> timelines_;
+    std::vector<TimestampNs> arrivals_;
+};
+
+class VsyncSourceTest : public SyntheticBackendTest {
+protected:
+    void SetUp() override {
+        SyntheticBackendTest::SetUp();
+        setDisplayRefreshRate(kRefreshHz);
+    }
+};
+
+TEST_F(VsyncSourceTest, DeliversTimelinesInBootTimeAtTheDisplayRate) {
+    VsyncSource source;
+    TimelineLog log;
+    source.start(log.callback());
+    EXPECT_TRUE(source.isRunning());
+    ASSERT_TRUE(waitUntil([&log] { return log.size() >= 20; }));
+    source.stop();
+
+    const std::vector<FrameTimeline> timelines = log.timelines();
+    const std::vector<TimestampNs> arrivals = log.arrivals();
+    for (size_t i = 0; i < timelines.size(); ++i) {
+        const FrameTimeline& timeline = timelines[i];
+        // Callbacks run at the vsync, so the converted vsync is just behind the boot clock
+        EXPECT_GE(arrivals[i], timeline.vsyncNs - kNsPerMs);
+        EXPECT_LT(arrivals[i] - timeline.vsyncNs, 100 * kNsPerMs);
+        // The preferred timeline: latch a millisecond before the next vsync, present two frames out
+        EXPECT_EQ(timeline.deadlineNs - timeline.vsyncNs, kPeriodNs - kNsPerMs);
+        EXPECT_EQ(timeline.presentNs - timeline.vsyncNs, 2 * kPeriodNs);
+        if (i > 0) {
+            // One frame apart, or whole frames if the thread was late; the
+            // clock offset is resampled per frame, so allow some jitter
+            const int64_t gapNs = timeline.vsyncNs - timelines[i - 1].vsyncNs;
+            const int64_t frames = (gapNs + kPeriodNs / 2) / kPeriodNs;
+            EXPECT_GE(frames, 1);
+            EXPECT_NEAR(static_cast<double>(gapNs), static_cast<double>(frames * kPeriodNs), 2.0 * kNsPerMs);
+        }
+    }
+    const int64_t spanNs = timelines.back().vsyncNs - timelines.front().vsyncNs;
+    EXPECT_LT(spanNs, static_cast<int64_t>(timelines.size()) * 2 * kPeriodNs);
+}
+
+TEST_F(VsyncSourceTest, StopEndsCallbacksAndStartResumesThem) {
+    VsyncSource source;
+    TimelineLog log;
+    source.start(log.callback());
+    ASSERT_TRUE(waitUntil([&log] { return log.size() >= 2; }));
+
+    // A second start() keeps the running source and its callback
+    TimelineLog ignored;
+    source.start(ignored.callback());
+    source.stop();
+    EXPECT_FALSE(source.isRunning());
+    const size_t delivered = log.size();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5 * kPeriodNs / kNsPerMs));
+    EXPECT_EQ(log.size(), delivered);
+    EXPECT_EQ(ignored.size(), 0u);
+
+    source.start(log.callback());
+    ASSERT_TRUE(waitUntil([&log, delivered] { return log.size() >= delivered + 2; }));
+    source.stop();
+    source.stop();
+    EXPECT_FALSE(source.isRunning());
+}
+
+}  // namespace
+}  // namespace nativesensor::testing
@@ -0,0 +1,299 @@
+#include "block_matcher.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace nativesensor {
+
+namespace {
+
+constexpr int32_t kDisparityStep = 16;      // Column updates run 16 disparities per vector
+constexpr int32_t kMaxDisparity = 256;
+constexpr int32_t kMinBlockSize = 3;
+constexpr int32_t kMaxBlockSize = 15;       // 15 * 15 * 255 still fits a uint16 cost
+constexpr uint16_t kNoCost = 0xFFFF;
+
+BlockMatcherConfig normalized(BlockMatcherConfig c) {
+    c.maxDisparity = (c.maxDisparity + kDisparityStep - 1) / kDisparityStep * kDisparityStep;
+    c.maxDisparity = std::clamp(c.maxDisparity, kDisparityStep, kMaxDisparity);
+    c.blockSize = std::clamp(c.blockSize | 1, kMinBlockSize, kMaxBlockSize);
+    c.uniquenessRatio = std::clamp(c.uniquenessRatio, 0, 99);
+    c.minBandRows = std::max(c.minBandRows, 1);
+    return c;
+}
+
+/// out[k] = row[width - 1 - k], padded with row[0] up to width + disparities,
+/// so right pixel x - d for d = 0, 1, ... is out[width - 1 - x + d]:
+/// contiguous in d, which is the vector direction
+void reverseRow(const uint8_t* row, int32_t width, int32_t disparities, uint8_t* out) {
+    for (int32_t k = 0; k < width; ++k) {
+        out[k] = row[width - 1 - k];
+    }
+    std::memset(out + width, row[0], static_cast<size_t>(disparities));
+}
+
+/// Fixed-point parabola fit through the costs around the winner
+int16_t refineSubpixel(const uint16_t* cost, int32_t best, int32_t maxD) {
+    int32_t value = best * DisparityMap::kScale;
+    if (best > 0 && best < maxD) {
+        const int32_t prev = cost[best - 1];
+        const int32_t next = cost[best + 1];
+        const int32_t denom = std::max(prev + next - 2 * static_cast<int32_t>(cost[best]), 1);
+        value += ((prev - next) * DisparityMap::kScale + denom) / (2 * denom);
+    }
+    return static_cast<int16_t>(value);
+}
+
+/// Smallest cost a rival disparity may have without making the match ambiguous.
+/// A tie is always ambiguous, also at zero cost (a perfectly flat region).
+uint32_t uniquenessThreshold(uint32_t minCost, int32_t ratio) {
+    const auto keep = static_cast<uint32_t>(100 - ratio);
+    return std::min<uint32_t>(std::max((minCost * 100 + keep - 1) / keep, minCost + 1), kNoCost);
+}
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+alignas(16) constexpr uint16_t kLaneIndex[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+/// columns[x][d] += |L(x) - R(x - d)| of the entering row, minus the same
+/// for the leaving row if there is one
+void updateColumns(const uint8_t* enterLeft, const uint8_t* enterRev, const uint8_t* leaveLeft,
+                   const uint8_t* leaveRev, int32_t width, int32_t disparities, uint16_t* columns) {
+    for (int32_t x = 0; x < width; ++x) {
+        const uint8x16_t a = vdupq_n_u8(enterLeft[x]);
+        const uint8_t* ra = enterRev + (width - 1 - x);
+        uint16_t* c = columns + static_cast<size_t>(x) * static_cast<size_t>(disparities);
+        if (leaveLeft) {
+            const uint8x16_t b = vdupq_n_u8(leaveLeft[x]);
+            const uint8_t* rb = leaveRev + (width - 1 - x);
+            for (int32_t d = 0; d < disparities; d += 16) {
+                const uint8x16_t enter = vabdq_u8(a, vld1q_u8(ra + d));
+                const uint8x16_t leave = vabdq_u8(b, vld1q_u8(rb + d));
+                uint16x8_t lo = vaddw_u8(vld1q_u16(c + d), vget_low_u8(enter));
+                uint16x8_t hi = vaddw_u8(vld1q_u16(c + d + 8), vget_high_u8(enter));
+                vst1q_u16(c + d, vsubw_u8(lo, vget_low_u8(leave)));
+                vst1q_u16(c + d + 8, vsubw_u8(hi, vget_high_u8(leave)));
+            }
+        } else {
+            for (int32_t d = 0; d < disparities; d += 16) {
+                const uint8x16_t enter = vabdq_u8(a, vld1q_u8(ra + d));
+                vst1q_u16(c + d, vaddw_u8(vld1q_u16(c + d), vget_low_u8(enter)));
+                vst1q_u16(c + d + 8, vaddw_u8(vld1q_u16(c + d + 8), vget_high_u8(enter)));
+            }
+        }
+    }
+}
+
+/// box[d] += enter[d] - leave[d] (leave may be null); wraps like the scalar path
+void slideBox(uint16_t* box, const uint16_t* enter, const uint16_t* leave, int32_t disparities) {
+    for (int32_t d = 0; d < disparities; d += 8) {
+        uint16x8_t sum = vaddq_u16(vld1q_u16(box + d), vld1q_u16(enter + d));
+        if (leave) {
+            sum = vsubq_u16(sum, vld1q_u16(leave + d));
+        }
+        vst1q_u16(box + d, sum);
+    }
+}
+
+/// Winner-take-all over d <= maxD (lowest d on ties) with uniqueness check
+int16_t selectDisparity(const uint16_t* cost, int32_t maxD, int32_t uniquenessRatio) {
+    const uint16x8_t lanes = vld1q_u16(kLaneIndex);
+    const uint16x8_t step = vdupq_n_u16(8);
+    const uint16x8_t limit = vdupq_n_u16(static_cast<uint16_t>(maxD));
+
+    uint16x8_t best = vdupq_n_u16(kNoCost);
+    uint16x8_t bestIndex = vdupq_n_u16(0);
+    uint16x8_t index = lanes;
+    for (int32_t d = 0; d <= maxD; d += 8) {
+        // Lanes past maxD would match outside the right image: never win
+        const uint16x8_t c = vorrq_u16(vld1q_u16(cost + d), vcgtq_u16(index, limit));
+        const uint16x8_t better = vcltq_u16(c, best);
+        best = vbslq_u16(better, c, best);
+        bestIndex = vbslq_u16(better, index, bestIndex);
+        index = vaddq_u16(index, step);
+    }
+    const uint16_t minCost = vminvq_u16(best);
+    const uint16x8_t winners = vceqq_u16(best, vdupq_n_u16(minCost));
+    const int32_t bestD = vminvq_u16(vbslq_u16(winners, bestIndex, vdupq_n_u16(kNoCost)));
+
+    if (uniquenessRatio > 0) {
+        const uint16x8_t threshold =
+            vdupq_n_u16(static_cast<uint16_t>(uniquenessThreshold(minCost, uniquenessRatio)));
+        const uint16x8_t winner = vdupq_n_u16(static_cast<uint16_t>(bestD));
+        const uint16x8_t one = vdupq_n_u16(1);
+        uint16x8_t rivals = vdupq_n_u16(0);
+        index = lanes;
+        for (int32_t d = 0; d <= maxD; d += 8) {
+            const uint16x8_t c = vorrq_u16(vld1q_u16(cost + d), vcgtq_u16(index, limit));
+            const uint16x8_t close = vcltq_u16(c, threshold);
+            const uint16x8_t apart = vcgtq_u16(vabdq_u16(index, winner), one);
+            rivals = vorrq_u16(rivals, vandq_u16(close, apart));
+            index = vaddq_u16(index, step);
+        }
+        if (vmaxvq_u16(rivals) != 0) {
+            return DisparityMap::kInvalid;
+        }
+    }
+    return refineSubpixel(cost, bestD, maxD);
+}
+
+#else
+
+void updateColumns(const uint8_t* enterLeft, const uint8_t* enterRev, const uint8_t* leaveLeft,
+                   const uint8_t* leaveRev, int32_t width, int32_t disparities, uint16_t* columns) {
+    for (int32_t x = 0; x < width; ++x) {
+        const int32_t a = enterLeft[x];
+        const uint8_t* ra = enterRev + (width - 1 - x);
+        uint16_t* c = columns + static_cast<size_t>(x) * static_cast<size_t>(disparities);
+        if (leaveLeft) {
+            const int32_t b = leaveLeft[x];
+            const uint8_t* rb = leaveRev + (width - 1 - x);
+            for (int32_t d = 0; d < disparities; ++d) {
+                c[d] = static_cast<uint16_t>(c[d] + std::abs(a - ra[d]) - std::abs(b - rb[d]));
+            }
+        } else {
+            for (int32_t d = 0; d < disparities; ++d) {
+                c[d] = static_cast<uint16_t>(c[d] + std::abs(a - ra[d]));
+            }
+        }
+    }
+}
+
+void slideBox(uint16_t* box, const uint16_t* enter, const uint16_t* leave, int32_t disparities) {
+    for (int32_t d = 0; d < disparities; ++d) {
+        box[d] = static_cast<uint16_t>(box[d] + enter[d] - (leave ? leave[d] : 0));
+    }
+}
+
+int16_t selectDisparity(const uint16_t* cost, int32_t maxD, int32_t uniquenessRatio) {
+    uint32_t minCost = kNoCost;
+    int32_t bestD = 0;
+    for (int32_t d = 0; d <= maxD; ++d) {
+        if (cost[d] < minCost) {
+            minCost = cost[d];
+            bestD = d;
+        }
+    }
+
+    if (uniquenessRatio > 0) {
+        const uint32_t threshold = uniquenessThreshold(minCost, uniquenessRatio);
+        for (int32_t d = 0; d <= maxD; ++d) {
+            if (cost[d] < threshold && std::abs(d - bestD) > 1) {
+                return DisparityMap::kInvalid;
+            }
+        }
+    }
+    return refineSubpixel(cost, bestD, maxD);
+}
+
+#endif
+
+}  // namespace
+
+BlockMatcher::BlockMatcher(BlockMatcherConfig config) : config_(normalized(config)) {}
+
+void BlockMatcher::compute(const uint8_t* left, int32_t leftStride, const uint8_t* right,
+                           int32_t rightStride, int32_t width, int32_t height, DisparityMap& out,
+                           ThreadPool* pool) {
+    out.width = width;
+    out.height = height;
+    out.data.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+    if (width <= config_.blockSize || height <= config_.blockSize) {
+        std::fill(out.data.begin(), out.data.end(), DisparityMap::kInvalid);
+        return;
+    }
+
+    // One band per worker; bands are claimed dynamically, so uneven bands
+    // just finish on whichever thread is free
+    const int32_t workers = pool ? static_cast<int32_t>(std::max<size_t>(pool->workerCount(), 1)) : 1;
+    const int32_t bands = std::clamp(height / config_.minBandRows, 1, workers);
+    if (scratch_.size() < static_cast<size_t>(bands)) {
+        scratch_.resize(static_cast<size_t>(bands));
+    }
+
+    const Images images{left, leftStride, right, rightStride, width, height};
+    const std::function<void(size_t)> band = [&](size_t i) {
+        const auto index = static_cast<int32_t>(i);
+        computeBand(images, height * index / bands, height * (index + 1) / bands, scratch_[i], out);
+    };
+    if (pool && bands > 1) {
+        pool->parallelFor(static_cast<size_t>(bands), band);
+    } else {
+        for (int32_t i = 0; i < bands; ++i) {
+            band(static_cast<size_t>(i));
+        }
+    }
+}
+
+void BlockMatcher::computeBand(const Images& images, int32_t rowBegin, int32_t rowEnd,
+                               Scratch& scratch, DisparityMap& out) const {
+    const int32_t width = images.width;
+    const int32_t disparities = config_.maxDisparity;
+    const int32_t radius = config_.blockSize / 2;
+    const auto columnStride = static_cast<size_t>(disparities);
+
+    // Rows without a full window above and below stay invalid
+    const int32_t yBegin = std::max(rowBegin, radius);
+    const int32_t yEnd = std::min(rowEnd, images.height - radius);
+    for (int32_t y = rowBegin; y < rowEnd; ++y) {
+        if (y < yBegin || y >= yEnd) {
+            int16_t* dst = out.data.data() + static_cast<size_t>(y) * static_cast<size_t>(width);
+            std::fill(dst, dst + width, DisparityMap::kInvalid);
+        }
+    }
+    if (yBegin >= yEnd) {
+        return;
+    }
+
+    scratch.columns.assign(static_cast<size_t>(width) * columnStride, 0);
+    scratch.box.resize(columnStride);
+    scratch.entering.resize(static_cast<size_t>(width + disparities));
+    scratch.leaving.resize(static_cast<size_t>(width + disparities));
+    uint16_t* columns = scratch.columns.data();
+    uint16_t* box = scratch.box.data();
+
+    const auto leftRow = [&](int32_t y) { return images.left + static_cast<ptrdiff_t>(y) * images.leftStride; };
+    const auto rightRow = [&](int32_t y) { return images.right + static_cast<ptrdiff_t>(y) * images.rightStride; };
+
+    for (int32_t y = yBegin - radius; y <= yBegin + radius; ++y) {
+        reverseRow(rightRow(y), width, disparities, scratch.entering.data());
+        updateColumns(leftRow(y), scratch.entering.data(), nullptr, nullptr, width, disparities, columns);
+    }
+
+    for (int32_t y = yBegin; y < yEnd; ++y) {
+        if (y > yBegin) {
+            const int32_t enter = y + radius;
+            const int32_t leave = y - radius - 1;
+            reverseRow(rightRow(enter), width, disparities, scratch.entering.data());
+            reverseRow(rightRow(leave), width, disparities, scratch.leaving.data());
+            updateColumns(leftRow(enter), scratch.entering.data(), leftRow(leave),
+                          scratch.leaving.data(), width, disparities, columns);
+        }
+
+        int16_t* dst = out.data.data() + static_cast<size_t>(y) * static_cast<size_t>(width);
+        std::fill(dst, dst + radius, DisparityMap::kInvalid);
+        std::fill(dst + width - radius, dst + width, DisparityMap::kInvalid);
+
+        std::fill(scratch.box.begin(), scratch.box.end(), 0);
+        for (int32_t x = 0; x <= 2 * radius; ++x) {
+            slideBox(box, columns + static_cast<size_t>(x) * columnStride, nullptr, disparities);
+        }
+        for (int32_t x = radius; x < width - radius; ++x) {
+            if (x > radius) {
+                slideBox(box, columns + static_cast<size_t>(x + radius) * columnStride,
+                         columns + static_cast<size_t>(x - radius - 1) * columnStride, disparities);
+            }
+            // The window in the right image must start at column 0 or later
+            const int32_t maxD = std::min(disparities - 1, x - radius);
+            dst[x] = selectDisparity(box, maxD, config_.uniquenessRatio);
+        }
+    }
+}
+
+}  // namespace nativesensor
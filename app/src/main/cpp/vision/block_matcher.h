@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "thread_pool.h"
+
+namespace nativesensor {
+
+/// Per-pixel disparity of the left image of a rectified pair in fixed point
+struct DisparityMap {
+    static constexpr int kSubpixelBits = 4;
+    static constexpr int kScale = 1 << kSubpixelBits;
+    static constexpr int16_t kInvalid = -1;
+
+    int32_t width = 0;
+    int32_t height = 0;
+    std::vector<int16_t> data;      // Disparity * kScale, row-major; kInvalid where unmatched
+
+    /// Disparity in pixels at (x, y); negative if invalid
+    [[nodiscard]]
+    float disparity(int32_t x, int32_t y) const noexcept {
+        const int16_t value = data[static_cast<size_t>(y) * static_cast<size_t>(width) + static_cast<size_t>(x)];
+        return value < 0 ? -1.0f : static_cast<float>(value) * (1.0f / kScale);
+    }
+};
+
+struct BlockMatcherConfig {
+    int32_t maxDisparity = 64;      // Searched disparities [0, maxDisparity); rounded up to 16, at most 256
+    int32_t blockSize = 9;          // Odd SAD window side, 3..15
+    int32_t uniquenessRatio = 15;   // Margin (%) the best cost needs over non-adjacent disparities
+    int32_t minBandRows = 16;       // Smallest row band handed to one worker
+};
+
+/// Sum-of-absolute-differences block matching on rectified 8-bit images.
+///
+/// Window costs are kept incrementally: per column, the SAD of the window's
+/// rows is updated by one entering and one leaving row, then summed along the
+/// row with a running box filter, all vectorized across disparities (NEON on
+/// arm64). Winner-take-all with a uniqueness check and parabolic subpixel
+/// refinement. Row bands run in parallel on a ThreadPool.
+/// Not thread-safe: one compute() at a time per instance.
+class BlockMatcher {
+public:
+    explicit BlockMatcher(BlockMatcherConfig config = {});
+
+    BlockMatcher(const BlockMatcher&) = delete;
+    BlockMatcher& operator=(const BlockMatcher&) = delete;
+
+    /// Disparity of `left` against `right` (both width x height). Pixels
+    /// closer to the border than half a block, and matches that would fall
+    /// outside the right image, are invalid.
+    /// @param pool Workers for row bands; null runs on the calling thread
+    void compute(const uint8_t* left, int32_t leftStride, const uint8_t* right, int32_t rightStride,
+                 int32_t width, int32_t height, DisparityMap& out, ThreadPool* pool = nullptr);
+
+    [[nodiscard]]
+    const BlockMatcherConfig& config() const noexcept { return config_; }
+
+private:
+    /// Per-band working memory, kept between frames
+    struct Scratch {
+        std::vector<uint16_t> columns;      // [x][d] SAD over the window rows
+        std::vector<uint16_t> box;          // [d] SAD over the full window at the current x
+        std::vector<uint8_t> entering;      // Reversed, padded right rows (see reverseRow)
+        std::vector<uint8_t> leaving;
+    };
+
+    struct Images {
+        const uint8_t* left;
+        int32_t leftStride;
+        const uint8_t* right;
+        int32_t rightStride;
+        int32_t width;
+        int32_t height;
+    };
+
+    void computeBand(const Images& images, int32_t rowBegin, int32_t rowEnd, Scratch& scratch,
+                     DisparityMap& out) const;
+
+    BlockMatcherConfig config_;
+    std::vector<Scratch> scratch_;
+};
+
+}  // namespace nativesensor
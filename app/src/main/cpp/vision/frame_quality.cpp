@@ -0,0 +1,151 @@
+#include "frame_quality.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace nativesensor {
+
+namespace {
+
+// Histogram samples every kHistogramStep-th pixel of a measured row
+constexpr int32_t kHistogramStep = 4;
+constexpr int kHistogramShift = 3;  // 256 levels into 32 bins
+
+// Immerkaer: sigma = sqrt(pi / 2) / 6 * mean |I * N| for the 3x3 kernel
+// N = [1 -2 1; -2 4 -2; 1 -2 1], which cancels planes and (mostly) edges
+constexpr double kImmerkaerScale = 1.2533141373155 / 6.0;
+
+/// Per-row totals; the Laplacian is edges - 4 * center
+struct RowSums {
+    uint64_t luma = 0;
+    uint64_t dark = 0;
+    uint64_t bright = 0;
+    int64_t laplacian = 0;
+    uint64_t laplacianSq = 0;
+    uint64_t noise = 0;             // Sum of |I * N|
+};
+
+/// Accumulate pixels [1, width - 1) of row `mid`
+void accumulateRow(const uint8_t* top, const uint8_t* mid, const uint8_t* bottom, int32_t width,
+                   RowSums& sums) {
+    int32_t x = 1;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    // 8 pixels per step; 32-bit lane accumulators are widened once per row
+    // (width / 4 squares of at most 1020^2 per lane: fine below 16K pixels)
+    uint32x4_t luma = vdupq_n_u32(0);
+    uint16x8_t dark = vdupq_n_u16(0);
+    uint16x8_t bright = vdupq_n_u16(0);
+    int32x4_t laplacian = vdupq_n_s32(0);
+    uint32x4_t laplacianSq = vdupq_n_u32(0);
+    uint32x4_t noise = vdupq_n_u32(0);
+    const uint8x8_t darkClip = vdup_n_u8(FrameQuality::kDarkClip);
+    const uint8x8_t brightClip = vdup_n_u8(FrameQuality::kBrightClip);
+    for (; x + 8 <= width - 1; x += 8) {
+        const uint8x8_t t = vld1_u8(top + x);
+        const uint8x8_t m = vld1_u8(mid + x);
+        const uint8x8_t b = vld1_u8(bottom + x);
+        const uint16x8_t edges = vaddq_u16(vaddl_u8(t, b), vaddl_u8(vld1_u8(mid + x - 1), vld1_u8(mid + x + 1)));
+        const uint16x8_t corners = vaddq_u16(vaddl_u8(vld1_u8(top + x - 1), vld1_u8(top + x + 1)),
+                                             vaddl_u8(vld1_u8(bottom + x - 1), vld1_u8(bottom + x + 1)));
+        const int16x8_t center4 = vreinterpretq_s16_u16(vshll_n_u8(m, 2));
+        const int16x8_t lap = vsubq_s16(vreinterpretq_s16_u16(edges), center4);
+        const int16x8_t n = vaddq_s16(vsubq_s16(vreinterpretq_s16_u16(corners),
+                                                vreinterpretq_s16_u16(vshlq_n_u16(edges, 1))), center4);
+
+        luma = vpadalq_u16(luma, vmovl_u8(m));
+        dark = vsubq_u16(dark, vreinterpretq_u16_s16(vmovl_s8(vreinterpret_s8_u8(vcle_u8(m, darkClip)))));
+        bright = vsubq_u16(bright, vreinterpretq_u16_s16(vmovl_s8(vreinterpret_s8_u8(vcge_u8(m, brightClip)))));
+        laplacian = vpadalq_s16(laplacian, lap);
+        const int16x8_t lapAbs = vabsq_s16(lap);
+        laplacianSq = vmlal_u16(laplacianSq, vget_low_u16(vreinterpretq_u16_s16(lapAbs)),
+                                vget_low_u16(vreinterpretq_u16_s16(lapAbs)));
+        laplacianSq = vmlal_u16(laplacianSq, vget_high_u16(vreinterpretq_u16_s16(lapAbs)),
+                                vget_high_u16(vreinterpretq_u16_s16(lapAbs)));
+        noise = vpadalq_u16(noise, vreinterpretq_u16_s16(vabsq_s16(n)));
+    }
+    sums.luma += vaddvq_u32(luma);
+    sums.dark += vaddvq_u16(dark);
+    sums.bright += vaddvq_u16(bright);
+    sums.laplacian += vaddvq_s32(laplacian);
+    sums.laplacianSq += vaddlvq_u32(laplacianSq);
+    sums.noise += vaddvq_u32(noise);
+#endif
+    for (; x < width - 1; ++x) {
+        const int m = mid[x];
+        const int edges = top[x] + bottom[x] + mid[x - 1] + mid[x + 1];
+        const int corners = top[x - 1] + top[x + 1] + bottom[x - 1] + bottom[x + 1];
+        const int lap = edges - 4 * m;
+        sums.luma += static_cast<uint64_t>(m);
+        sums.dark += m <= FrameQuality::kDarkClip ? 1 : 0;
+        sums.bright += m >= FrameQuality::kBrightClip ? 1 : 0;
+        sums.laplacian += lap;
+        sums.laplacianSq += static_cast<uint64_t>(lap * lap);
+        sums.noise += static_cast<uint64_t>(std::abs(corners - 2 * edges + 4 * m));
+    }
+}
+
+}  // namespace
+
+void measureFrameQuality(const uint8_t* data, int32_t width, int32_t height, int32_t stride,
+                         int32_t rowStep, FrameQuality& out) {
+    const auto start = std::chrono::steady_clock::now();
+    if (width < 3 || height < 3) {
+        out = FrameQuality{};
+        return;
+    }
+    rowStep = std::max(rowStep, 1);
+
+    RowSums sums;
+    std::array<uint32_t, FrameQuality::kHistogramBins> histogram{};
+    uint64_t histogramSamples = 0;
+    uint64_t samples = 0;
+    for (int32_t y = 1; y < height - 1; y += rowStep) {
+        const uint8_t* mid = data + static_cast<ptrdiff_t>(y) * stride;
+        accumulateRow(mid - stride, mid, mid + stride, width, sums);
+        samples += static_cast<uint64_t>(width - 2);
+        for (int32_t x = 1; x < width - 1; x += kHistogramStep) {
+            ++histogram[mid[x] >> kHistogramShift];
+            ++histogramSamples;
+        }
+    }
+
+    const auto n = static_cast<double>(samples);
+    const double lapMean = static_cast<double>(sums.laplacian) / n;
+    out.meanLuma = static_cast<float>(static_cast<double>(sums.luma) / n);
+    out.darkClipRatio = static_cast<float>(static_cast<double>(sums.dark) / n);
+    out.brightClipRatio = static_cast<float>(static_cast<double>(sums.bright) / n);
+    out.sharpness = static_cast<float>(std::max(0.0, static_cast<double>(sums.laplacianSq) / n - lapMean * lapMean));
+    out.noiseSigma = static_cast<float>(kImmerkaerScale * static_cast<double>(sums.noise) / n);
+    const float histogramScale = 1.0f / static_cast<float>(histogramSamples);
+    for (size_t bin = 0; bin < histogram.size(); ++bin) {
+        out.histogram[bin] = static_cast<float>(histogram[bin]) * histogramScale;
+    }
+    out.computeUs = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+void FrameQualityMonitor::process(const FrameRef& frame) {
+    const size_t pixels = static_cast<size_t>(frame->width()) * static_cast<size_t>(frame->height());
+    const size_t budget = std::max<size_t>(sampleBudget_, 1);
+    const auto rowStep = static_cast<int32_t>((pixels + budget - 1) / budget);
+    measureFrameQuality(frame->data(), frame->width(), frame->height(), frame->stride(), rowStep, scratch_);
+    scratch_.timestampNs = frame->metadata.timestampNs;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    latest_[frame->metadata.cameraId] = scratch_;
+}
+
+std::optional<FrameQuality> FrameQualityMonitor::latest(const std::string& cameraId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = latest_.find(cameraId);
+    if (it == latest_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+}  // namespace nativesensor
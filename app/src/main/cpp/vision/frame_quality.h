@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "frame_pool.h"
+
+namespace nativesensor {
+
+/// Cheap exposure, sharpness and noise measures of one luma frame
+struct FrameQuality {
+    static constexpr size_t kHistogramBins = 32;
+    static constexpr uint8_t kDarkClip = 4;         // Samples at or below count as crushed
+    static constexpr uint8_t kBrightClip = 251;     // Samples at or above count as blown out
+
+    int64_t timestampNs = 0;
+    float meanLuma = 0.0f;              // 0..255
+    float darkClipRatio = 0.0f;
+    float brightClipRatio = 0.0f;
+    float sharpness = 0.0f;             // Variance of the 3x3 Laplacian; drops with blur and defocus
+    float noiseSigma = 0.0f;            // Immerkaer estimate in gray levels; texture inflates it
+    float computeUs = 0.0f;
+    std::array<float, kHistogramBins> histogram{};  // Share of samples per bin of 8 gray levels
+};
+
+/// Measure a width x height luma image (at least 3x3) on every rowStep-th
+/// interior row: sums, clip counts and both 3x3 filters over whole rows
+/// (NEON on arm64, scalar elsewhere), the histogram on every 4th sample.
+void measureFrameQuality(const uint8_t* data, int32_t width, int32_t height, int32_t stride,
+                         int32_t rowStep, FrameQuality& out);
+
+/// Pipeline sink keeping the newest quality measures of each camera's
+/// analysis frames for camera health monitoring. Rows are subsampled so a
+/// frame of any size costs about the same. process() runs on one pipeline
+/// thread; latest() may be called from anywhere.
+class FrameQualityMonitor {
+public:
+    /// Pixels measured per frame: every 16th row of 1080p, every 3rd row of VGA
+    static constexpr size_t kDefaultSampleBudget = 128 * 1024;
+
+    explicit FrameQualityMonitor(size_t sampleBudget = kDefaultSampleBudget)
+        : sampleBudget_(sampleBudget) {}
+
+    FrameQualityMonitor(const FrameQualityMonitor&) = delete;
+    FrameQualityMonitor& operator=(const FrameQualityMonitor&) = delete;
+
+    void process(const FrameRef& frame);
+
+    /// Measures of the camera's newest frame; empty before the first one
+    [[nodiscard]]
+    std::optional<FrameQuality> latest(const std::string& cameraId) const;
+
+private:
+    const size_t sampleBudget_;
+    FrameQuality scratch_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, FrameQuality> latest_;
+};
+
+}  // namespace nativesensor
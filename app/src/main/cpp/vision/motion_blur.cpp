@@ -0,0 +1,78 @@
+#include "motion_blur.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace nativesensor {
+
+namespace {
+
+// Focal length as a fraction of the width for cameras without intrinsics
+// (a 90 degree horizontal field of view, typical of tracking cameras)
+constexpr float kFallbackFocalPerWidth = 0.5f;
+
+}  // namespace
+
+MotionBlurGate::MotionBlurGate(const GyroHistory& gyro, CalibrationStore& store, float maxBlurPx)
+    : gyro_(gyro), store_(store), maxBlurPx_(maxBlurPx) {}
+
+float MotionBlurGate::blurScore(const FrameMetadata& metadata, int32_t width, int32_t height) const {
+    if (metadata.exposureTimeNs <= 0 || width <= 0 || height <= 0) {
+        return -1.0f;
+    }
+    const auto rotation = gyro_.integrate(metadata.timestampNs,
+                                          metadata.timestampNs + metadata.exposureTimeNs);
+    if (!rotation) {
+        return -1.0f;
+    }
+
+    float focal = kFallbackFocalPerWidth * static_cast<float>(width);
+    if (const auto calibration = store_.calibration(metadata.cameraId);
+        calibration && calibration->hasIntrinsics) {
+        const PinholeIntrinsics k = scaledIntrinsics(*calibration, width, height);
+        focal = std::max(k.fx, k.fy);
+    }
+    const float cornerRadius = 0.5f * std::hypot(static_cast<float>(width), static_cast<float>(height));
+
+    const auto imuFromCamera = store_.imuFromCamera(metadata.cameraId);
+    if (!imuFromCamera) {
+        // Unknown mounting: assume the worst axis
+        return std::max(focal, cornerRadius) * norm(*rotation);
+    }
+    const Vec3 inCamera = rotate(conjugate(imuFromCamera->rotation), *rotation);
+    return focal * std::hypot(inCamera.x, inCamera.y) + cornerRadius * std::fabs(inCamera.z);
+}
+
+bool MotionBlurGate::process(const FrameRef& in, FrameRef& out) {
+    const float blur = blurScore(in->metadata, in->width(), in->height());
+    const float threshold = maxBlurPx_.load(std::memory_order_relaxed);
+    in->metadata.motionBlurPx = blur;
+    const bool pass = blur < 0.0f || blur <= threshold;
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        if (blur < 0.0f) {
+            ++stats_.unscored;
+        } else {
+            blurSum_ += blur;
+            stats_.maxBlurPx = std::max(stats_.maxBlurPx, blur);
+        }
+        ++(pass ? stats_.passed : stats_.skipped);
+    }
+
+    if (pass) {
+        out = in;
+    }
+    return pass;
+}
+
+MotionBlurStats MotionBlurGate::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    MotionBlurStats stats = stats_;
+    const int64_t scored = stats.passed + stats.skipped - stats.unscored;
+    stats.meanBlurPx = scored > 0 ? static_cast<float>(blurSum_ / static_cast<double>(scored)) : 0.0f;
+    stats.thresholdPx = maxBlurPx_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace nativesensor
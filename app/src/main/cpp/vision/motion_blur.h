@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "calibration_store.h"
+#include "frame_pool.h"
+#include "gyro_history.h"
+
+namespace nativesensor {
+
+/// Motion blur gate counters
+struct MotionBlurStats {
+    int64_t passed = 0;
+    int64_t skipped = 0;            // Blurred beyond the threshold and dropped
+    int64_t unscored = 0;           // No exposure time or gyro coverage; passed on
+    float meanBlurPx = 0.0f;        // Over scored frames
+    float maxBlurPx = 0.0f;
+    float thresholdPx = 0.0f;
+};
+
+/// Pipeline stage that drops frames smeared by head motion before they reach
+/// expensive processing.
+///
+/// The blur of a frame is estimated from the rotation the gyro measured
+/// during its exposure, projected through the camera's intrinsics: rotation
+/// about the x/y axes shifts every pixel by about f * angle, roll about the
+/// optical axis moves the corners by radius * angle. Frames without an
+/// exposure time or gyro coverage are passed on unscored. process() runs on a
+/// single thread; the threshold and stats may be accessed from anywhere.
+class MotionBlurGate {
+public:
+    /// Default threshold: about where corner detection and patch tracking degrade
+    static constexpr float kDefaultMaxBlurPx = 2.0f;
+
+    MotionBlurGate(const GyroHistory& gyro, CalibrationStore& store,
+                   float maxBlurPx = kDefaultMaxBlurPx);
+
+    MotionBlurGate(const MotionBlurGate&) = delete;
+    MotionBlurGate& operator=(const MotionBlurGate&) = delete;
+
+    /// Estimated blur in pixels of a width x height frame; negative if it
+    /// can't be scored
+    [[nodiscard]]
+    float blurScore(const FrameMetadata& metadata, int32_t width, int32_t height) const;
+
+    /// Score `in` (stored in its metadata) and pass it on unless too blurred
+    bool process(const FrameRef& in, FrameRef& out);
+
+    void setMaxBlurPx(float maxBlurPx) noexcept { maxBlurPx_.store(maxBlurPx, std::memory_order_relaxed); }
+
+    [[nodiscard]]
+    MotionBlurStats getStats() const;
+
+private:
+    const GyroHistory& gyro_;
+    CalibrationStore& store_;
+    std::atomic<float> maxBlurPx_;
+
+    mutable std::mutex statsMutex_;
+    MotionBlurStats stats_;
+    double blurSum_ = 0.0;
+};
+
+}  // namespace nativesensor
@@ -0,0 +1,178 @@
+#include "remap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace nativesensor {
+
+namespace {
+
+constexpr int kRoundShift = 2 * RemapTable::kFracBits;
+constexpr uint32_t kRound = 1u << (kRoundShift - 1);
+
+/// Fixed-point bilinear sample at table index i
+inline uint8_t sampleFixed(const RemapTable& table, const uint8_t* src, size_t i) {
+    const uint8_t* p = src + table.offsets[i];
+    const uint32_t fx = table.fracX[i];
+    const uint32_t fy = table.fracY[i];
+    const uint32_t top = p[0] * (RemapTable::kFracOne - fx) + p[1] * fx;
+    const uint32_t bottom = p[table.srcStride] * (RemapTable::kFracOne - fx) +
+                            p[table.srcStride + 1] * fx;
+    const uint32_t value = (top * (RemapTable::kFracOne - fy) + bottom * fy + kRound) >> kRoundShift;
+    return static_cast<uint8_t>(value & table.mask[i]);
+}
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+/// Eight output pixels: scalar gathers of the two source pixel pairs, the
+/// interpolation itself in 16/32-bit lanes
+inline void sample8Neon(const RemapTable& table, const uint8_t* src, size_t i, uint8_t* dst) {
+    uint16_t topPairs[8];
+    uint16_t bottomPairs[8];
+    const int32_t* offsets = table.offsets.data() + i;
+    for (int lane = 0; lane < 8; ++lane) {
+        const uint8_t* p = src + offsets[lane];
+        std::memcpy(&topPairs[lane], p, sizeof(uint16_t));
+        std::memcpy(&bottomPairs[lane], p + table.srcStride, sizeof(uint16_t));
+    }
+    const uint16x8_t top = vld1q_u16(topPairs);
+    const uint16x8_t bottom = vld1q_u16(bottomPairs);
+
+    // Little endian: low byte is the left pixel of each pair
+    const uint8x8_t p00 = vmovn_u16(top);
+    const uint8x8_t p01 = vshrn_n_u16(top, 8);
+    const uint8x8_t p10 = vmovn_u16(bottom);
+    const uint8x8_t p11 = vshrn_n_u16(bottom, 8);
+
+    const uint8x8_t one = vdup_n_u8(RemapTable::kFracOne);
+    const uint8x8_t fx = vld1_u8(table.fracX.data() + i);
+    const uint8x8_t fy = vld1_u8(table.fracY.data() + i);
+    const uint8x8_t ifx = vsub_u8(one, fx);
+
+    const uint16x8_t h0 = vmlal_u8(vmull_u8(p00, ifx), p01, fx);
+    const uint16x8_t h1 = vmlal_u8(vmull_u8(p10, ifx), p11, fx);
+    const uint16x8_t wy = vmovl_u8(fy);
+    const uint16x8_t iwy = vmovl_u8(vsub_u8(one, fy));
+
+    uint32x4_t lo = vmull_u16(vget_low_u16(h0), vget_low_u16(iwy));
+    lo = vmlal_u16(lo, vget_low_u16(h1), vget_low_u16(wy));
+    uint32x4_t hi = vmull_u16(vget_high_u16(h0), vget_high_u16(iwy));
+    hi = vmlal_u16(hi, vget_high_u16(h1), vget_high_u16(wy));
+
+    const uint16x8_t value = vcombine_u16(vrshrn_n_u32(lo, kRoundShift), vrshrn_n_u32(hi, kRoundShift));
+    vst1_u8(dst, vand_u8(vmovn_u16(value), vld1_u8(table.mask.data() + i)));
+}
+
+#endif
+
+}  // namespace
+
+void resizeRemapTable(RemapTable& table, int32_t width, int32_t height, int32_t srcWidth,
+                      int32_t srcHeight, int32_t srcStride) {
+    table.width = width;
+    table.height = height;
+    table.srcWidth = srcWidth;
+    table.srcHeight = srcHeight;
+    table.srcStride = srcStride;
+
+    const size_t count = static_cast<size_t>(width) * static_cast<size_t>(height);
+    table.offsets.resize(count);
+    table.fracX.resize(count);
+    table.fracY.resize(count);
+    table.mask.resize(count);
+}
+
+void setRemapEntry(RemapTable& table, size_t index, float x, float y) {
+    const float maxX = static_cast<float>(table.srcWidth - 1);
+    const float maxY = static_cast<float>(table.srcHeight - 1);
+    // Half a pixel of slack at the borders is clamped, anything further is masked
+    if (!(x >= -0.5f && x <= maxX + 0.5f && y >= -0.5f && y <= maxY + 0.5f)) {
+        table.offsets[index] = 0;
+        table.fracX[index] = 0;
+        table.fracY[index] = 0;
+        table.mask[index] = 0;
+        return;
+    }
+    const float cx = std::clamp(x, 0.0f, maxX);
+    const float cy = std::clamp(y, 0.0f, maxY);
+    // Keep x0 + 1 and y0 + 1 inside the image; the fraction absorbs the rest
+    const int32_t x0 = std::min(static_cast<int32_t>(cx), table.srcWidth - 2);
+    const int32_t y0 = std::min(static_cast<int32_t>(cy), table.srcHeight - 2);
+    const auto fx = static_cast<int32_t>(std::lround((cx - static_cast<float>(x0)) * RemapTable::kFracOne));
+    const auto fy = static_cast<int32_t>(std::lround((cy - static_cast<float>(y0)) * RemapTable::kFracOne));
+    table.offsets[index] = y0 * table.srcStride + x0;
+    table.fracX[index] = static_cast<uint8_t>(std::min(fx, RemapTable::kFracOne));
+    table.fracY[index] = static_cast<uint8_t>(std::min(fy, RemapTable::kFracOne));
+    table.mask[index] = 0xFF;
+}
+
+RemapTable buildRemapTable(const UndistortionMap& map, int32_t srcWidth, int32_t srcHeight,
+                           int32_t srcStride) {
+    RemapTable table;
+    if (srcWidth < 2 || srcHeight < 2 || map.width <= 0 || map.height <= 0) {
+        return table;
+    }
+    resizeRemapTable(table, map.width, map.height, srcWidth, srcHeight, srcStride);
+
+    // Map coordinates are in map pixels; scale if the source has another size
+    const float scaleX = static_cast<float>(srcWidth) / static_cast<float>(map.width);
+    const float scaleY = static_cast<float>(srcHeight) / static_cast<float>(map.height);
+    for (size_t i = 0; i < table.offsets.size(); ++i) {
+        setRemapEntry(table, i, map.coords[2 * i] * scaleX, map.coords[2 * i + 1] * scaleY);
+    }
+    return table;
+}
+
+void remapRows(const RemapTable& table, const uint8_t* src, uint8_t* dst, int32_t dstStride,
+               int32_t rowBegin, int32_t rowEnd) {
+    rowEnd = std::min(rowEnd, table.height);
+    for (int32_t y = std::max(rowBegin, 0); y < rowEnd; ++y) {
+        const size_t rowStart = static_cast<size_t>(y) * static_cast<size_t>(table.width);
+        uint8_t* out = dst + static_cast<ptrdiff_t>(y) * dstStride;
+        int32_t x = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        for (; x + 8 <= table.width; x += 8) {
+            sample8Neon(table, src, rowStart + static_cast<size_t>(x), out + x);
+        }
+#endif
+        for (; x < table.width; ++x) {
+            out[x] = sampleFixed(table, src, rowStart + static_cast<size_t>(x));
+        }
+    }
+}
+
+void remapFloat(const UndistortionMap& map, const uint8_t* src, int32_t srcWidth, int32_t srcHeight,
+                int32_t srcStride, uint8_t* dst, int32_t dstStride) {
+    const float maxX = static_cast<float>(srcWidth - 1);
+    const float maxY = static_cast<float>(srcHeight - 1);
+    const float* coords = map.coords.data();
+    for (int32_t y = 0; y < map.height; ++y) {
+        uint8_t* out = dst + static_cast<ptrdiff_t>(y) * dstStride;
+        for (int32_t x = 0; x < map.width; ++x, coords += 2) {
+            const float sx = coords[0];
+            const float sy = coords[1];
+            if (!(sx >= -0.5f && sx <= maxX + 0.5f && sy >= -0.5f && sy <= maxY + 0.5f)) {
+                out[x] = 0;
+                continue;
+            }
+            const float cx = std::clamp(sx, 0.0f, maxX);
+            const float cy = std::clamp(sy, 0.0f, maxY);
+            const int32_t x0 = std::min(static_cast<int32_t>(cx), srcWidth - 2);
+            const int32_t y0 = std::min(static_cast<int32_t>(cy), srcHeight - 2);
+            const float fx = cx - static_cast<float>(x0);
+            const float fy = cy - static_cast<float>(y0);
+            const uint8_t* p = src + static_cast<ptrdiff_t>(y0) * srcStride + x0;
+            const float top = static_cast<float>(p[0]) + fx * static_cast<float>(p[1] - p[0]);
+            const float bottom = static_cast<float>(p[srcStride]) +
+                                 fx * static_cast<float>(p[srcStride + 1] - p[srcStride]);
+            out[x] = static_cast<uint8_t>(top + fy * (bottom - top) + 0.5f);
+        }
+    }
+}
+
+}  // namespace nativesensor
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "calibration_store.h"
+
+namespace nativesensor {
+
+/// Fixed-point form of an UndistortionMap for one source image geometry:
+/// per output pixel the offset of its top-left source pixel and 7-bit
+/// bilinear fractions, so the per-frame kernel is integer-only.
+struct RemapTable {
+    static constexpr int kFracBits = 7;
+    static constexpr int kFracOne = 1 << kFracBits;
+
+    int32_t width = 0;                  // Output size
+    int32_t height = 0;
+    int32_t srcWidth = 0;
+    int32_t srcHeight = 0;
+    int32_t srcStride = 0;
+    std::vector<int32_t> offsets;       // y0 * srcStride + x0
+    std::vector<uint8_t> fracX;         // 0..kFracOne
+    std::vector<uint8_t> fracY;
+    std::vector<uint8_t> mask;          // 0xFF if the source position is inside the image, else 0
+};
+
+/// Quantize a map for a source image of the given geometry (at least 2x2)
+[[nodiscard]]
+RemapTable buildRemapTable(const UndistortionMap& map, int32_t srcWidth, int32_t srcHeight,
+                           int32_t srcStride);
+
+/// Size `table` for a width x height output sampling the given source
+/// geometry (at least 2x2), reusing its storage; entries are left unset
+void resizeRemapTable(RemapTable& table, int32_t width, int32_t height, int32_t srcWidth,
+                      int32_t srcHeight, int32_t srcStride);
+
+/// Quantize the source position (x, y) of output pixel `index` (row-major).
+/// Lets per-frame warps fill a table row by row without a float map.
+void setRemapEntry(RemapTable& table, size_t index, float x, float y);
+
+/// Bilinear remap of output rows [rowBegin, rowEnd) with the fixed-point
+/// table (NEON on arm64, scalar elsewhere). Pixels sampled from outside
+/// the source are 0.
+void remapRows(const RemapTable& table, const uint8_t* src, uint8_t* dst, int32_t dstStride,
+               int32_t rowBegin, int32_t rowEnd);
+
+/// Bilinear remap of the whole image
+inline void remap(const RemapTable& table, const uint8_t* src, uint8_t* dst, int32_t dstStride) {
+    remapRows(table, src, dst, dstStride, 0, table.height);
+}
+
+/// Floating-point reference remap straight from the map (benchmark baseline);
+/// the source must have the map's size
+void remapFloat(const UndistortionMap& map, const uint8_t* src, int32_t srcWidth, int32_t srcHeight,
+                int32_t srcStride, uint8_t* dst, int32_t dstStride);
+
+}  // namespace nativesensor
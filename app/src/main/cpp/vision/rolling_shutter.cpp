@@ -0,0 +1,359 @@
+#include "rolling_shutter.h"
+
+#include <android/log.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.RollingShutter";
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+namespace {
+
+constexpr float kNsToSeconds = 1e-9f;
+constexpr float kRadToDeg = 57.2957795f;
+
+// Rays this close to the image plane don't project
+constexpr float kMinRayZ = 1e-3f;
+
+// Fixed-point steps finding the sensor row an output pixel was read from
+constexpr int kWarpIterations = 2;
+
+// The warp is solved exactly every kWarpGridStep pixels and interpolated
+// bilinearly in between; at a 2 rad/s head turn this stays within 0.15 px
+// of the per-pixel solution at under a third of the cost
+constexpr int32_t kWarpGridStep = 8;
+
+/// Walks gyro readings forward in time, interpolating the rate linearly
+/// between them and holding it outside
+class RateCursor {
+public:
+    explicit RateCursor(const std::vector<GyroReading>& rates) : rates_(rates) {}
+
+    /// Rate at t; t must not decrease between calls
+    Vec3 at(TimestampNs t) {
+        while (index_ + 1 < rates_.size() && rates_[index_ + 1].timestampNs <= t) {
+            ++index_;
+        }
+        const GyroReading& older = rates_[index_];
+        if (index_ + 1 == rates_.size() || t <= older.timestampNs) {
+            return older.rate;
+        }
+        const GyroReading& newer = rates_[index_ + 1];
+        const float alpha = static_cast<float>(t - older.timestampNs) /
+                            static_cast<float>(newer.timestampNs - older.timestampNs);
+        return older.rate + (newer.rate - older.rate) * alpha;
+    }
+
+    /// Rotation vector over [from, to], trapezoids split at every reading
+    Vec3 integrate(TimestampNs from, TimestampNs to) {
+        Vec3 rotation;
+        Vec3 rateFrom = at(from);
+        while (from < to) {
+            const TimestampNs next = index_ + 1 < rates_.size() && rates_[index_ + 1].timestampNs < to
+                                         ? rates_[index_ + 1].timestampNs
+                                         : to;
+            const Vec3 rateNext = at(next);
+            rotation += (rateFrom + rateNext) * (0.5f * static_cast<float>(next - from) * kNsToSeconds);
+            from = next;
+            rateFrom = rateNext;
+        }
+        return rotation;
+    }
+
+private:
+    const std::vector<GyroReading>& rates_;
+    size_t index_ = 0;
+};
+
+/// Normalized ray of an undistorted pixel
+Vec3 unproject(const PinholeIntrinsics& k, float u, float v) {
+    const float y = (v - k.cy) / k.fy;
+    return {(u - k.cx - k.skew * y) / k.fx, y, 1.0f};
+}
+
+/// Pixel of a ray; false if it points behind the camera
+bool project(const PinholeIntrinsics& k, const Vec3& ray, float& u, float& v) {
+    if (ray.z < kMinRayZ) {
+        return false;
+    }
+    const float inv = 1.0f / ray.z;
+    const float x = ray.x * inv;
+    const float y = ray.y * inv;
+    u = k.fx * x + k.skew * y + k.cx;
+    v = k.fy * y + k.cy;
+    return true;
+}
+
+/// Sensor row that undistorted pixel (u, v) was read out from
+size_t sensorRow(const UndistortionMap& map, size_t rowCount, float u, float v) {
+    const auto x = static_cast<size_t>(std::clamp(u + 0.5f, 0.0f, static_cast<float>(map.width - 1)));
+    const auto y = static_cast<size_t>(std::clamp(v + 0.5f, 0.0f, static_cast<float>(map.height - 1)));
+    const float row = map.coords[2 * (y * static_cast<size_t>(map.width) + x) + 1];
+    return static_cast<size_t>(std::clamp(row + 0.5f, 0.0f, static_cast<float>(rowCount - 1)));
+}
+
+}  // namespace
+
+bool computeRowRotations(const std::vector<GyroReading>& cameraRates, TimestampNs firstRowNs,
+                         int64_t skewNs, int32_t rowCount, RowRotationTable& table) {
+    if (cameraRates.empty() || skewNs <= 0 || rowCount < 2) {
+        return false;
+    }
+    const auto rows = static_cast<size_t>(rowCount);
+    const int32_t referenceRow = (rowCount - 1) / 2;
+    const auto rowTime = [&](int32_t row) { return firstRowNs + skewNs * row / (rowCount - 1); };
+    table.rows.resize(rows);
+
+    // Orientation of each row's camera frame relative to the first row's,
+    // advanced by the rotation since the previous row
+    RateCursor cursor(cameraRates);
+    Quat orientation;
+    Quat reference;
+    TimestampNs previous = firstRowNs;
+    table.rows[0] = Mat3::identity();
+    for (int32_t row = 1; row < rowCount; ++row) {
+        const TimestampNs t = rowTime(row);
+        orientation = normalized(orientation * quat::fromRotationVector(cursor.integrate(previous, t)));
+        previous = t;
+        table.rows[static_cast<size_t>(row)] = toMat3(orientation);
+        if (row == referenceRow) {
+            reference = orientation;
+        }
+    }
+
+    // Re-express relative to the reference row
+    const Mat3 toReference = toMat3(conjugate(reference));
+    for (Mat3& rotation : table.rows) {
+        rotation = toReference * rotation;
+    }
+    table.referenceNs = rowTime(referenceRow);
+    table.maxAngleRad = std::max(quat::angleBetween(reference, Quat{}),
+                                 quat::angleBetween(reference, orientation));
+    return true;
+}
+
+void ShutterCorrectedFrame::correctPoints(const float* in, float* out, size_t count) const {
+    if (warped || rotations.empty() || !map) {
+        if (in != out) {
+            std::copy(in, in + 2 * count, out);
+        }
+        return;
+    }
+    const PinholeIntrinsics& k = map->intrinsics;
+    for (size_t i = 0; i < count; ++i) {
+        const float u = in[2 * i];
+        const float v = in[2 * i + 1];
+        const Mat3& rotation = rotations.rows[sensorRow(*map, rotations.rows.size(), u, v)];
+        float cu = u;
+        float cv = v;
+        if (!project(k, rotation * unproject(k, u, v), cu, cv)) {
+            cu = u;
+            cv = v;
+        }
+        out[2 * i] = cu;
+        out[2 * i + 1] = cv;
+    }
+}
+
+RollingShutterCorrector::RollingShutterCorrector(const GyroHistory& gyro, CalibrationStore& store,
+                                                 ThreadPool& pool, size_t poolCapacity)
+    : gyro_(gyro), store_(store), pool_(pool), poolCapacity_(poolCapacity) {}
+
+bool RollingShutterCorrector::process(const FrameRef& in, std::shared_ptr<const ShutterCorrectedFrame>& out) {
+    std::erase_if(retiredPools_, [](const auto& pool) { return pool->idle(); });
+
+    auto output = acquireOutput();
+    if (!output) {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        ++stats_.dropped;
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    output->frame = in;
+    output->warped = false;
+    output->map = store_.undistortionMap(in->metadata.cameraId, in->width(), in->height());
+    const bool corrected = output->map && computeRotations(in->metadata, in->height(), output->rotations);
+    if (!corrected) {
+        output->rotations.rows.clear();
+    } else if (warpEnabled_.load(std::memory_order_relaxed)) {
+        if (FrameRef warped = warp(in, *output->map, output->rotations)) {
+            output->frame = std::move(warped);
+            output->warped = true;
+        }
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        if (corrected) {
+            ++stats_.corrected;
+            stats_.warped += output->warped ? 1 : 0;
+            computeUsSum_ += std::chrono::duration<double, std::micro>(elapsed).count();
+            stats_.lastSkewMs = static_cast<float>(in->metadata.rollingShutterSkewNs) * 1e-6f;
+            stats_.lastMaxAngleDeg = output->rotations.maxAngleRad * kRadToDeg;
+        } else {
+            ++stats_.uncorrected;
+        }
+    }
+
+    out = std::move(output);
+    return true;
+}
+
+RollingShutterStats RollingShutterCorrector::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    RollingShutterStats stats = stats_;
+    stats.avgComputeUs = stats.corrected > 0
+        ? static_cast<float>(computeUsSum_ / static_cast<double>(stats.corrected))
+        : 0.0f;
+    return stats;
+}
+
+bool RollingShutterCorrector::computeRotations(const FrameMetadata& metadata, int32_t rowCount,
+                                               RowRotationTable& table) {
+    table.rows.clear();
+    const int64_t skewNs = metadata.rollingShutterSkewNs;
+    if (skewNs <= 0) {
+        return false;
+    }
+    const auto imuFromCamera = store_.imuFromCamera(metadata.cameraId);
+    if (!imuFromCamera) {
+        return false;
+    }
+
+    // Rows are exposed for exposureTimeNs each, starting skew / (rows - 1) apart
+    const TimestampNs firstRowNs = metadata.timestampNs + metadata.exposureTimeNs / 2;
+    if (!gyro_.window(firstRowNs, firstRowNs + skewNs, rates_)) {
+        return false;
+    }
+    const Quat cameraFromImu = conjugate(imuFromCamera->rotation);
+    for (GyroReading& reading : rates_) {
+        reading.rate = rotate(cameraFromImu, reading.rate);
+    }
+    return computeRowRotations(rates_, firstRowNs, skewNs, rowCount, table);
+}
+
+FrameRef RollingShutterCorrector::warp(const FrameRef& in, const UndistortionMap& map,
+                                       const RowRotationTable& table) {
+    const FrameMetadata& meta = in->metadata;
+    auto& pool = warpPools_[meta.cameraId];
+    if (!pool || pool->width() != in->width() || pool->height() != in->height()) {
+        if (pool) {
+            retiredPools_.push_back(std::move(pool));
+        }
+        pool = std::make_unique<FramePool>(in->width(), in->height(), poolCapacity_);
+        LOGI("Warp pool ready for camera %s (%dx%d)", meta.cameraId.c_str(), in->width(), in->height());
+    }
+    FrameRef out = pool->acquire();
+    if (!out) {
+        return out;
+    }
+
+    const size_t rowCount = table.rows.size();
+    inverseRows_.resize(rowCount);
+    for (size_t row = 0; row < rowCount; ++row) {
+        inverseRows_[row] = table.rows[row].transposed();
+    }
+
+    // Each grid point samples where its ray was seen by the row that read it
+    // out; that row depends on the answer, so iterate from the point's own
+    const PinholeIntrinsics& k = map.intrinsics;
+    const int32_t width = in->width();
+    const int32_t height = in->height();
+    const int32_t gridWidth = (width - 1 + kWarpGridStep - 1) / kWarpGridStep + 1;
+    const int32_t gridHeight = (height - 1 + kWarpGridStep - 1) / kWarpGridStep + 1;
+    warpGrid_.resize(2 * static_cast<size_t>(gridWidth) * static_cast<size_t>(gridHeight));
+    size_t node = 0;
+    for (int32_t gy = 0; gy < gridHeight; ++gy) {
+        const auto y = static_cast<float>(std::min(gy * kWarpGridStep, height - 1));
+        for (int32_t gx = 0; gx < gridWidth; ++gx, node += 2) {
+            const auto x = static_cast<float>(std::min(gx * kWarpGridStep, width - 1));
+            const Vec3 ray = unproject(k, x, y);
+            float u = x;
+            float v = y;
+            size_t row = sensorRow(map, rowCount, u, v);
+            for (int iteration = 0; iteration < kWarpIterations; ++iteration) {
+                if (!project(k, inverseRows_[row] * ray, u, v)) {
+                    u = -1.0f - static_cast<float>(width);   // Masked
+                    break;
+                }
+                row = sensorRow(map, rowCount, u, v);
+            }
+            warpGrid_[node] = u;
+            warpGrid_[node + 1] = v;
+        }
+    }
+
+    // Interpolate, quantize and remap in row bands
+    resizeRemapTable(warpTable_, width, height, width, height, in->stride());
+    const auto bands = std::max<size_t>(pool_.workerCount(), 1);
+    const std::function<void(size_t)> warpBand = [&](size_t i) {
+        const auto rowBegin = static_cast<int32_t>(static_cast<size_t>(height) * i / bands);
+        const auto rowEnd = static_cast<int32_t>(static_cast<size_t>(height) * (i + 1) / bands);
+        for (int32_t y = rowBegin; y < rowEnd; ++y) {
+            const int32_t gy = std::min(y / kWarpGridStep, gridHeight - 2);
+            const int32_t y0 = gy * kWarpGridStep;
+            const float wy = static_cast<float>(y - y0) / static_cast<float>(std::min(y0 + kWarpGridStep, height - 1) - y0);
+            const float* top = warpGrid_.data() + 2 * static_cast<size_t>(gy) * static_cast<size_t>(gridWidth);
+            const float* bottom = top + 2 * static_cast<size_t>(gridWidth);
+            size_t index = static_cast<size_t>(y) * static_cast<size_t>(width);
+            for (int32_t gx = 0; gx + 1 < gridWidth; ++gx) {
+                const int32_t x0 = gx * kWarpGridStep;
+                const int32_t x1 = std::min(x0 + kWarpGridStep, width - 1);
+                const size_t n = 2 * static_cast<size_t>(gx);
+                const float u0 = top[n] + (bottom[n] - top[n]) * wy;
+                const float v0 = top[n + 1] + (bottom[n + 1] - top[n + 1]) * wy;
+                const float u1 = top[n + 2] + (bottom[n + 2] - top[n + 2]) * wy;
+                const float v1 = top[n + 3] + (bottom[n + 3] - top[n + 3]) * wy;
+                const float inv = 1.0f / static_cast<float>(x1 - x0);
+                const float du = (u1 - u0) * inv;
+                const float dv = (v1 - v0) * inv;
+                // The last cell also covers the right edge pixel
+                const int32_t end = x1 == width - 1 ? x1 + 1 : x1;
+                for (int32_t x = x0; x < end; ++x, ++index) {
+                    const auto t = static_cast<float>(x - x0);
+                    setRemapEntry(warpTable_, index, u0 + du * t, v0 + dv * t);
+                }
+            }
+        }
+        remapRows(warpTable_, in->data(), out->data(), out->stride(), rowBegin, rowEnd);
+    };
+    pool_.parallelFor(bands, warpBand);
+
+    out->metadata = meta;
+    return out;
+}
+
+std::shared_ptr<ShutterCorrectedFrame> RollingShutterCorrector::acquireOutput() {
+    std::shared_ptr<OutputSlot> free;
+    for (const auto& slot : outputs_) {
+        // Cleared with release by the last consumer's deleter, so once this
+        // sees false their reads are done: reuse its buffers and stop
+        // pinning its frame in the upstream pool
+        if (!slot->held.load(std::memory_order_acquire)) {
+            slot->frame.frame.reset();
+            if (!free) { free = slot; }
+        }
+    }
+    if (!free && outputs_.size() < kMaxOutputs) {
+        free = outputs_.emplace_back(std::make_shared<OutputSlot>());
+    }
+    if (!free) {
+        return nullptr;
+    }
+    free->held.store(true, std::memory_order_relaxed);
+    // The deleter keeps the slot alive, so a frame may outlive the corrector
+    return {&free->frame, [slot = free](ShutterCorrectedFrame*) {
+        slot->held.store(false, std::memory_order_release);
+    }};
+}
+
+}  // namespace nativesensor
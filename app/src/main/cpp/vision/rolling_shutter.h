@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "calibration_store.h"
+#include "frame_pool.h"
+#include "geometry.h"
+#include "gyro_history.h"
+#include "remap.h"
+#include "thread_pool.h"
+
+namespace nativesensor {
+
+/// Camera rotation across the readout of one rolling-shutter frame: rows[r]
+/// takes a ray seen by sensor row r into the camera frame at referenceNs, the
+/// mid-exposure time of the center row. Empty if the frame wasn't corrected.
+struct RowRotationTable {
+    TimestampNs referenceNs = 0;
+    float maxAngleRad = 0.0f;           // Rotation of the first or last row, whichever is larger
+    std::vector<Mat3> rows;
+
+    [[nodiscard]]
+    bool empty() const noexcept { return rows.empty(); }
+};
+
+/// Fill `table` for `rowCount` rows read out over skewNs starting at
+/// firstRowNs, from gyro readings already rotated into the camera frame that
+/// span the readout (GyroHistory::window). Built incrementally: one small
+/// rotation step per row, integrating the linearly interpolated rate, so the
+/// cost is O(rows + samples). False if the inputs can't describe the readout.
+bool computeRowRotations(const std::vector<GyroReading>& cameraRates, TimestampNs firstRowNs,
+                         int64_t skewNs, int32_t rowCount, RowRotationTable& table);
+
+/// An undistorted frame with the camera motion during its readout
+struct ShutterCorrectedFrame {
+    FrameRef frame;                             // Warped to referenceNs if `warped`
+    std::shared_ptr<const UndistortionMap> map; // Pinhole intrinsics and raw sensor rows of `frame`
+    RowRotationTable rotations;
+    bool warped = false;
+
+    /// Move feature points (interleaved x, y in undistorted pixels) detected
+    /// in `frame` to where a global shutter at referenceNs would have seen
+    /// them. Copies the points if the frame is warped or wasn't corrected.
+    /// `in` and `out` may alias.
+    void correctPoints(const float* in, float* out, size_t count) const;
+};
+
+/// Rolling-shutter stage counters
+struct RollingShutterStats {
+    int64_t corrected = 0;
+    int64_t uncorrected = 0;            // No readout skew, gyro coverage or camera-IMU extrinsics
+    int64_t warped = 0;
+    int64_t dropped = 0;                // Every output still held downstream
+    float avgComputeUs = 0.0f;          // Rotation table plus warp, per corrected frame
+    float lastSkewMs = 0.0f;
+    float lastMaxAngleDeg = 0.0f;
+};
+
+/// Pipeline stage attaching per-row camera rotations to undistorted tracking
+/// frames, so feature points can be corrected for the rolling shutter, and
+/// optionally warping the image itself to the center row's time.
+///
+/// Row times come from ACAMERA_SENSOR_ROLLING_SHUTTER_SKEW and the exposure;
+/// rotations come from the gyro history rotated into the camera frame with
+/// the lens pose, so cameras without extrinsics are passed on uncorrected.
+/// The warp maps a grid of output pixels back through their rows' rotations
+/// and interpolates in between, split into row bands on the thread pool.
+/// Outputs and warped frames are recycled, so steady state does not allocate.
+/// process() must run on a single thread; the warp switch and stats may be
+/// used from anywhere.
+class RollingShutterCorrector {
+public:
+    RollingShutterCorrector(const GyroHistory& gyro, CalibrationStore& store, ThreadPool& pool,
+                            size_t poolCapacity = 4);
+
+    RollingShutterCorrector(const RollingShutterCorrector&) = delete;
+    RollingShutterCorrector& operator=(const RollingShutterCorrector&) = delete;
+
+    /// Correct an undistorted frame (Undistorter output)
+    bool process(const FrameRef& in, std::shared_ptr<const ShutterCorrectedFrame>& out);
+
+    /// Also warp frames to the reference time (off by default: costs a remap)
+    void setWarpEnabled(bool enabled) noexcept { warpEnabled_.store(enabled, std::memory_order_relaxed); }
+
+    [[nodiscard]]
+    RollingShutterStats getStats() const;
+
+private:
+    static constexpr size_t kMaxOutputs = 4;
+
+    /// An output frame and whether a handed-out pointer to it is still alive
+    struct OutputSlot {
+        ShutterCorrectedFrame frame;
+        std::atomic<bool> held{false};
+    };
+
+    bool computeRotations(const FrameMetadata& metadata, int32_t rowCount, RowRotationTable& table);
+    [[nodiscard]] FrameRef warp(const FrameRef& in, const UndistortionMap& map,
+                                const RowRotationTable& table);
+    [[nodiscard]] std::shared_ptr<ShutterCorrectedFrame> acquireOutput();
+
+    const GyroHistory& gyro_;
+    CalibrationStore& store_;
+    ThreadPool& pool_;
+    const size_t poolCapacity_;
+    std::atomic<bool> warpEnabled_{false};
+
+    // Stage-thread state
+    std::vector<GyroReading> rates_;
+    std::vector<Mat3> inverseRows_;                 // Transposed row rotations for the warp
+    std::vector<float> warpGrid_;                   // Source (x, y) at every kWarpGridStep-th pixel
+    RemapTable warpTable_;
+    std::unordered_map<std::string, std::unique_ptr<FramePool>> warpPools_;
+    // Pools replaced after a size change, freed once their frames are back
+    std::vector<std::unique_ptr<FramePool>> retiredPools_;
+    std::vector<std::shared_ptr<OutputSlot>> outputs_;
+
+    mutable std::mutex statsMutex_;
+    RollingShutterStats stats_;
+    double computeUsSum_ = 0.0;
+};
+
+}  // namespace nativesensor
@@ -0,0 +1,179 @@
+#include "stereo_depth.h"
+
+#include <android/log.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.Stereo";
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+namespace {
+
+/// Rebuild a remap table if the rectification or the source layout changed
+void ensureTable(RemapTable& table, const UndistortionMap& map, const FrameBuffer& source) {
+    if (table.width != map.width || table.height != map.height ||
+        table.srcWidth != source.width() || table.srcHeight != source.height() ||
+        table.srcStride != source.stride()) {
+        table = buildRemapTable(map, source.width(), source.height(), source.stride());
+    }
+}
+
+}  // namespace
+
+StereoDepth::StereoDepth(CalibrationStore& store, ThreadPool& pool, BlockMatcherConfig config)
+    : store_(store), pool_(pool), matcher_(config) {}
+
+bool StereoDepth::setPair(const std::string& cameraA, const std::string& cameraB) {
+    const auto a = store_.calibration(cameraA);
+    const auto b = store_.calibration(cameraB);
+    if (cameraA == cameraB || !a || !b || !canRectify(*a, *b)) {
+        LOGW("Cameras %s and %s can't be rectified as a stereo pair",
+             cameraA.c_str(), cameraB.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(pairMutex_);
+    pairA_ = cameraA;
+    pairB_ = cameraB;
+    ++pairVersion_;
+    LOGI("Stereo pair %s / %s", cameraA.c_str(), cameraB.c_str());
+    return true;
+}
+
+bool StereoDepth::process(const FrameRef& frame, std::shared_ptr<const StereoFrame>& out) {
+    {
+        std::lock_guard<std::mutex> lock(pairMutex_);
+        if (pairVersion_ != appliedPairVersion_) {
+            appliedPairVersion_ = pairVersion_;
+            cameraA_ = pairA_;
+            cameraB_ = pairB_;
+            pending_[0].reset();
+            pending_[1].reset();
+            rectification_.reset();
+        }
+    }
+
+    const std::string& cameraId = frame->metadata.cameraId;
+    const int side = cameraId == cameraA_ ? 0 : (cameraId == cameraB_ ? 1 : -1);
+    if (side < 0) {
+        return false;
+    }
+    pending_[side] = frame;
+    FrameRef& partner = pending_[1 - side];
+    if (!partner) {
+        return false;
+    }
+
+    // Whichever frame is older than the skew window can never be matched
+    const int64_t skew = frame->metadata.timestampNs - partner->metadata.timestampNs;
+    if (std::llabs(skew) > kMaxPairSkewNs) {
+        (skew > 0 ? partner : pending_[side]).reset();
+        return false;
+    }
+    const FrameRef frameA = std::move(pending_[0]);
+    const FrameRef frameB = std::move(pending_[1]);
+    if (frameA->width() != frameB->width() || frameA->height() != frameB->height() ||
+        !prepare(frameA->width(), frameA->height())) {
+        return false;
+    }
+
+    auto output = acquireOutput();
+    if (!output) {
+        droppedPairs_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const StereoRectification& rect = *rectification_;
+    const FrameRef& left = rect.leftId == cameraA_ ? frameA : frameB;
+    const FrameRef& right = rect.leftId == cameraA_ ? frameB : frameA;
+    ensureTable(leftTable_, rect.left, *left);
+    ensureTable(rightTable_, rect.right, *right);
+
+    const int32_t width = rect.width;
+    const int32_t height = rect.height;
+    const auto bands = std::max<size_t>(pool_.workerCount(), 1);
+    const std::function<void(size_t)> rectifyBand = [&](size_t i) {
+        const auto rowBegin = static_cast<int32_t>(static_cast<size_t>(height) * i / bands);
+        const auto rowEnd = static_cast<int32_t>(static_cast<size_t>(height) * (i + 1) / bands);
+        remapRows(leftTable_, left->data(), rectifiedLeft_.data(), width, rowBegin, rowEnd);
+        remapRows(rightTable_, right->data(), rectifiedRight_.data(), width, rowBegin, rowEnd);
+    };
+    pool_.parallelFor(bands, rectifyBand);
+    matcher_.compute(rectifiedLeft_.data(), width, rectifiedRight_.data(), width, width, height,
+                     output->disparity, &pool_);
+
+    output->leftId = rect.leftId;
+    output->rightId = rect.rightId;
+    output->timestampNs = left->metadata.timestampNs;
+    output->focalPx = rect.intrinsics.fx;
+    output->baseline = rect.baseline;
+    output->computeMs = std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    out = std::move(output);
+    return true;
+}
+
+bool StereoDepth::prepare(int32_t width, int32_t height) {
+    const uint64_t generation = store_.generation();
+    if (rectification_ && rectification_->width == width && rectification_->height == height &&
+        generation == calibrationGeneration_) {
+        return true;
+    }
+
+    rectification_.reset();
+    calibrationGeneration_ = generation;
+    const auto a = store_.calibration(cameraA_);
+    const auto b = store_.calibration(cameraB_);
+    if (!a || !b) {
+        return false;
+    }
+    auto rect = computeStereoRectification(cameraA_, *a, cameraB_, *b, width, height);
+    if (!rect) {
+        LOGW("Stereo pair %s / %s lost its calibration", cameraA_.c_str(), cameraB_.c_str());
+        return false;
+    }
+
+    const size_t pixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+    rectifiedLeft_.resize(pixels);
+    rectifiedRight_.resize(pixels);
+    LOGI("Stereo rectification %dx%d: left %s, right %s, baseline %.1f mm, f %.1f px",
+         width, height, rect->leftId.c_str(), rect->rightId.c_str(), rect->baseline * 1000.0f,
+         rect->intrinsics.fx);
+    rectification_ = std::move(rect);
+    // Tables are rebuilt against the new maps on first use
+    leftTable_ = {};
+    rightTable_ = {};
+    return true;
+}
+
+std::shared_ptr<StereoFrame> StereoDepth::acquireOutput() {
+    std::shared_ptr<OutputSlot> free;
+    for (const auto& slot : outputs_) {
+        // Cleared with release by the last consumer's deleter, so once this
+        // sees false their reads of the frame are done
+        if (!slot->held.load(std::memory_order_acquire)) {
+            free = slot;
+            break;
+        }
+    }
+    if (!free && outputs_.size() < kMaxOutputs) {
+        free = outputs_.emplace_back(std::make_shared<OutputSlot>());
+    }
+    if (!free) {
+        return nullptr;
+    }
+    free->held.store(true, std::memory_order_relaxed);
+    // The deleter keeps the slot alive, so a frame may outlive this stage
+    return {&free->frame, [slot = free](StereoFrame*) { slot->held.store(false, std::memory_order_release); }};
+}
+
+}  // namespace nativesensor
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "block_matcher.h"
+#include "calibration_store.h"
+#include "frame_pool.h"
+#include "remap.h"
+#include "stereo_rectify.h"
+#include "thread_pool.h"
+
+namespace nativesensor {
+
+/// Disparity of one synchronized stereo pair, in the rectified left image
+struct StereoFrame {
+    std::string leftId;
+    std::string rightId;
+    int64_t timestampNs = 0;        // Left frame sensor timestamp
+    float focalPx = 0.0f;           // Rectified focal length
+    float baseline = 0.0f;          // m
+    float computeMs = 0.0f;         // Rectification plus matching
+    DisparityMap disparity;
+
+    /// Depth in meters at (x, y); 0 where the disparity is invalid or zero
+    [[nodiscard]]
+    float depthAt(int32_t x, int32_t y) const noexcept {
+        const float d = disparity.disparity(x, y);
+        return d > 0.0f ? focalPx * baseline / d : 0.0f;
+    }
+};
+
+/// Pipeline stage turning analysis frames of a calibrated camera pair into
+/// disparity maps.
+///
+/// Frames of the two cameras are paired by sensor timestamp; a frame whose
+/// partner never shows up is dropped when a newer frame replaces it. Each pair
+/// is rectified with fixed-point remap tables and block matched, both split
+/// into row bands on the thread pool. Output frames are recycled once every
+/// consumer has released them, so steady state does not allocate.
+/// process() must run on a single thread (one pipeline stage); setPair() may
+/// be called from anywhere.
+class StereoDepth {
+public:
+    /// Largest sensor timestamp difference of a synchronized pair
+    static constexpr int64_t kMaxPairSkewNs = 2'000'000;
+
+    StereoDepth(CalibrationStore& store, ThreadPool& pool, BlockMatcherConfig config = {});
+
+    StereoDepth(const StereoDepth&) = delete;
+    StereoDepth& operator=(const StereoDepth&) = delete;
+
+    /// Select the cameras to match, in either order. Returns false (and keeps
+    /// the current pair) if their calibration can't be rectified.
+    bool setPair(const std::string& cameraA, const std::string& cameraB);
+
+    /// Feed one analysis frame; returns true with `out` set when it completes
+    /// a synchronized pair
+    bool process(const FrameRef& frame, std::shared_ptr<const StereoFrame>& out);
+
+    /// Pairs skipped because every output frame was still held downstream
+    [[nodiscard]]
+    int64_t droppedPairs() const noexcept { return droppedPairs_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kMaxOutputs = 3;
+
+    /// An output frame and whether a handed-out pointer to it is still alive
+    struct OutputSlot {
+        StereoFrame frame;
+        std::atomic<bool> held{false};
+    };
+
+    bool prepare(int32_t width, int32_t height);
+    [[nodiscard]] std::shared_ptr<StereoFrame> acquireOutput();
+
+    CalibrationStore& store_;
+    ThreadPool& pool_;
+    BlockMatcher matcher_;
+
+    std::mutex pairMutex_;
+    std::string pairA_;
+    std::string pairB_;
+    uint64_t pairVersion_ = 0;
+
+    // Stage-thread state
+    uint64_t appliedPairVersion_ = 0;
+    uint64_t calibrationGeneration_ = 0;
+    std::string cameraA_;
+    std::string cameraB_;
+    FrameRef pending_[2];                           // Newest unmatched frame of A and B
+    std::shared_ptr<const StereoRectification> rectification_;
+    RemapTable leftTable_;
+    RemapTable rightTable_;
+    std::vector<uint8_t> rectifiedLeft_;            // width x height, tightly packed
+    std::vector<uint8_t> rectifiedRight_;
+    std::vector<std::shared_ptr<OutputSlot>> outputs_;
+    std::atomic<int64_t> droppedPairs_{0};
+};
+
+}  // namespace nativesensor
@@ -0,0 +1,123 @@
+#include "stereo_rectify.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace nativesensor {
+
+namespace {
+
+// Shorter baselines give no usable depth resolution (and catch a camera
+// paired with itself)
+constexpr float kMinBaseline = 0.005f;
+
+// Marks a rectified pixel whose ray points away from the source camera; far
+// outside any image, so remap tables mask it out
+constexpr float kBehindCamera = -1.0e6f;
+
+/// Reference-to-camera rotation from the HAL's (x, y, z, w) quaternion
+Mat3 cameraFromReference(const CameraCalibration& c) {
+    return toMat3(normalized(Quat{c.poseRotation[3], c.poseRotation[0], c.poseRotation[1],
+                                  c.poseRotation[2]}));
+}
+
+Vec3 opticalCenter(const CameraCalibration& c) {
+    return {c.poseTranslation[0], c.poseTranslation[1], c.poseTranslation[2]};
+}
+
+/// Sampling map from the rectified image into one raw stream
+void buildRectifyMap(const CameraCalibration& calibration, const Mat3& cameraFromRectified,
+                     const PinholeIntrinsics& rectified, int32_t width, int32_t height,
+                     UndistortionMap& map) {
+    map.width = width;
+    map.height = height;
+    map.intrinsics = rectified;
+    map.coords.resize(2 * static_cast<size_t>(width) * static_cast<size_t>(height));
+
+    const PinholeIntrinsics source = scaledIntrinsics(calibration, width, height);
+    const float invF = 1.0f / rectified.fx;
+    float* out = map.coords.data();
+    for (int32_t v = 0; v < height; ++v) {
+        const float y = (static_cast<float>(v) - rectified.cy) * invF;
+        for (int32_t u = 0; u < width; ++u) {
+            const float x = (static_cast<float>(u) - rectified.cx) * invF;
+            const Vec3 ray = cameraFromRectified * Vec3{x, y, 1.0f};
+            if (ray.z > 0.0f) {
+                const float invZ = 1.0f / ray.z;
+                projectDistorted(calibration, source, ray.x * invZ, ray.y * invZ, out[0], out[1]);
+            } else {
+                out[0] = kBehindCamera;
+                out[1] = kBehindCamera;
+            }
+            out += 2;
+        }
+    }
+}
+
+}  // namespace
+
+bool canRectify(const CameraCalibration& a, const CameraCalibration& b) {
+    if (!a.hasIntrinsics || !b.hasIntrinsics || !a.hasPose || !b.hasPose ||
+        a.poseReference != b.poseReference || a.poseReference == LensPoseReference::Undefined) {
+        return false;
+    }
+    return norm(opticalCenter(b) - opticalCenter(a)) >= kMinBaseline;
+}
+
+std::shared_ptr<StereoRectification> computeStereoRectification(
+        const std::string& idA, const CameraCalibration& a,
+        const std::string& idB, const CameraCalibration& b,
+        int32_t width, int32_t height) {
+    if (width <= 0 || height <= 0 || !canRectify(a, b)) {
+        return nullptr;
+    }
+
+    const Mat3 rotationA = cameraFromReference(a);
+    const Mat3 rotationB = cameraFromReference(b);
+    // Camera axes in the reference frame are the rows of camera-from-reference
+    const Mat3 axesA = rotationA.transposed();
+    const Mat3 axesB = rotationB.transposed();
+
+    // Left camera's x axis points at the right camera
+    Vec3 baseline = opticalCenter(b) - opticalCenter(a);
+    const bool swap = dot(baseline, axesA.col[0] + axesB.col[0]) < 0.0f;
+    const CameraCalibration& left = swap ? b : a;
+    const CameraCalibration& right = swap ? a : b;
+    const Mat3& leftRotation = swap ? rotationB : rotationA;
+    const Mat3& rightRotation = swap ? rotationA : rotationB;
+    if (swap) {
+        baseline = -baseline;
+    }
+
+    // Rectified frame: x along the baseline, z as close to the mean optical
+    // axis as orthogonality allows, y completing the right-handed frame
+    auto result = std::make_shared<StereoRectification>();
+    const Vec3 ex = normalized(baseline);
+    const Vec3 meanAxis = axesA.col[2] + axesB.col[2];
+    const Vec3 ez = normalized(meanAxis - ex * dot(meanAxis, ex));
+    const Vec3 ey = cross(ez, ex);
+    result->rectifiedFromReference = Mat3::fromRows(ex, ey, ez);
+
+    // Shared pinhole model: the shorter focal length of the two keeps the
+    // field of view of both, principal point centered so disparity has no offset
+    const PinholeIntrinsics ka = scaledIntrinsics(a, width, height);
+    const PinholeIntrinsics kb = scaledIntrinsics(b, width, height);
+    const float focal = std::min(std::min(ka.fx, ka.fy), std::min(kb.fx, kb.fy));
+    result->intrinsics = {focal, focal, 0.5f * static_cast<float>(width),
+                          0.5f * static_cast<float>(height), 0.0f};
+
+    result->leftId = swap ? idB : idA;
+    result->rightId = swap ? idA : idB;
+    result->width = width;
+    result->height = height;
+    result->baseline = norm(baseline);
+
+    const Mat3 referenceFromRectified = result->rectifiedFromReference.transposed();
+    buildRectifyMap(left, leftRotation * referenceFromRectified, result->intrinsics,
+                    width, height, result->left);
+    buildRectifyMap(right, rightRotation * referenceFromRectified, result->intrinsics,
+                    width, height, result->right);
+    return result;
+}
+
+}  // namespace nativesensor
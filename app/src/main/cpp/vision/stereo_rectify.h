@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "calibration_store.h"
+#include "geometry.h"
+
+namespace nativesensor {
+
+/// Rectifying transform of a stereo pair: both cameras are virtually rotated
+/// so their image rows are parallel to the baseline and share one pinhole
+/// model, which turns correspondence search into a 1-D scan along a row.
+///
+/// Left is the camera whose x axis points towards the other one, so a point
+/// in front of the rig appears further right in the left image
+/// (disparity = xLeft - xRight >= 0).
+struct StereoRectification {
+    std::string leftId;
+    std::string rightId;
+    int32_t width = 0;
+    int32_t height = 0;
+    PinholeIntrinsics intrinsics;       // Shared by both rectified images
+    float baseline = 0.0f;              // Optical center distance (m)
+    // Rotation from the lens pose reference frame into the rectified frame
+    Mat3 rectifiedFromReference = Mat3::identity();
+    UndistortionMap left;               // Rectified pixel -> raw left stream pixel
+    UndistortionMap right;              // Rectified pixel -> raw right stream pixel
+
+    /// Depth along the rectified optical axis for a disparity in pixels
+    [[nodiscard]]
+    float depthFromDisparity(float disparity) const noexcept {
+        return disparity > 0.0f ? intrinsics.fx * baseline / disparity : 0.0f;
+    }
+};
+
+/// Both cameras have intrinsics and lens poses in the same reference frame
+/// with a usable baseline
+[[nodiscard]]
+bool canRectify(const CameraCalibration& a, const CameraCalibration& b);
+
+/// Rectification for two width x height streams of a camera pair (given in
+/// either order); nullptr unless canRectify(a, b)
+[[nodiscard]]
+std::shared_ptr<StereoRectification> computeStereoRectification(
+        const std::string& idA, const CameraCalibration& a,
+        const std::string& idB, const CameraCalibration& b,
+        int32_t width, int32_t height);
+
+}  // namespace nativesensor
@@ -0,0 +1,48 @@
+#include "undistorter.h"
+
+#include <android/log.h>
+
+namespace {
+constexpr const char* kLogTag = "NativeSensor.Undistort";
+}
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
+
+namespace nativesensor {
+
+bool Undistorter::process(const FrameRef& in, FrameRef& out) {
+    std::erase_if(retiredPools_, [](const auto& pool) { return pool->idle(); });
+
+    const FrameMetadata& meta = in->metadata;
+    auto map = store_.undistortionMap(meta.cameraId, in->width(), in->height());
+    if (!map) {
+        return false;
+    }
+
+    CameraState& state = cameras_[meta.cameraId];
+    if (state.map != map) {
+        // New camera, new calibration or new stream size
+        state.table = buildRemapTable(*map, in->width(), in->height(), in->stride());
+        if (!state.pool || state.pool->width() != map->width || state.pool->height() != map->height) {
+            if (state.pool) {
+                retiredPools_.push_back(std::move(state.pool));
+            }
+            state.pool = std::make_unique<FramePool>(map->width, map->height, poolCapacity_);
+        }
+        state.map = std::move(map);
+        LOGI("Remap table ready for camera %s (%dx%d)", meta.cameraId.c_str(),
+             state.table.width, state.table.height);
+    }
+
+    out = state.pool->acquire();
+    if (!out) {
+        return false;
+    }
+    remap(state.table, in->data(), out->data(), out->stride());
+    out->metadata = meta;
+    out->metadata.width = out->width();
+    out->metadata.height = out->height();
+    return true;
+}
+
+}  // namespace nativesensor
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "calibration_store.h"
+#include "frame_pool.h"
+#include "remap.h"
+
+namespace nativesensor {
+
+/// Rectifies pooled luma frames with each camera's undistortion map.
+///
+/// Remap tables are derived per camera from CalibrationStore maps and rebuilt
+/// when the calibration or frame size changes. Output frames come from
+/// per-camera pools owned by this object, which must outlive them.
+/// Not thread-safe: run it from a single pipeline stage.
+class Undistorter {
+public:
+    explicit Undistorter(CalibrationStore& store, size_t poolCapacity = 6)
+        : store_(store), poolCapacity_(poolCapacity) {}
+
+    Undistorter(const Undistorter&) = delete;
+    Undistorter& operator=(const Undistorter&) = delete;
+
+    /// Rectify `in` into a new pooled frame. Returns false if the camera has
+    /// no intrinsics or the output pool is exhausted.
+    bool process(const FrameRef& in, FrameRef& out);
+
+private:
+    struct CameraState {
+        std::shared_ptr<const UndistortionMap> map;
+        RemapTable table;
+        std::unique_ptr<FramePool> pool;
+    };
+
+    CalibrationStore& store_;
+    const size_t poolCapacity_;
+    std::unordered_map<std::string, CameraState> cameras_;
+    // Pools replaced after a size change, freed once their frames are back
+    std::vector<std::unique_ptr<FramePool>> retiredPools_;
+};
+
+}  // namespace nativesensor
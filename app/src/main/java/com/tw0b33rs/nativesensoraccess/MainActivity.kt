@@ -82,6 +82,7 @@ import com.tw0b33rs.nativesensoraccess.sensor.ImuMetadata
 import com.tw0b33rs.nativesensoraccess.sensor.ImuSample
 import com.tw0b33rs.nativesensoraccess.sensor.ImuStats
 import com.tw0b33rs.nativesensoraccess.sensor.NavigationDestination
+import com.tw0b33rs.nativesensoraccess.sensor.NativeSensorBridge
 import com.tw0b33rs.nativesensoraccess.sensor.SensorInfo
 import com.tw0b33rs.nativesensoraccess.sensor.SensorUiState
 import com.tw0b33rs.nativesensoraccess.sensor.SensorViewModel
@@ -95,6 +96,9 @@ class MainActivity : ComponentActivity() {
         super.onCreate(savedInstanceState)
         enableEdgeToEdge()
 
+        // Kick off native subsystem startup in parallel with UI setup
+        NativeSensorBridge.prepare(cacheDir.absolutePath)
+
         setContent {
             NativeSensorAccessTheme {
                 val viewModel: SensorViewModel = viewModel()
@@ -63,6 +63,113 @@ data class CameraInfo(
         get() = "Cam $id"
 }
 
+/**
+ * Reference frame of the lens pose, matching C++ LensPoseReference enum.
+ */
+enum class LensPoseReference(val value: Int) {
+    PRIMARY_CAMERA(0),
+    GYROSCOPE(1),
+    UNDEFINED(2),
+    AUTOMOTIVE(3);
+
+    companion object {
+        fun fromValue(value: Int): LensPoseReference =
+            entries.find { it.value == value } ?: UNDEFINED
+    }
+}
+
+/**
+ * Static lens calibration reported by the camera HAL.
+ * Intrinsics are in pixels of the pre-correction active array.
+ */
+data class CameraCalibration(
+    val fx: Float,
+    val fy: Float,
+    val cx: Float,
+    val cy: Float,
+    val skew: Float,
+    val distortion: List<Float>,        // k1, k2, k3, p1, p2
+    val poseRotation: List<Float>,      // Quaternion x, y, z, w (reference -> camera)
+    val poseTranslation: List<Float>,   // Optical center in the reference frame (m)
+    val poseReference: LensPoseReference,
+    val activeArrayWidth: Int,
+    val activeArrayHeight: Int,
+    val hasIntrinsics: Boolean,
+    val hasDistortion: Boolean,
+    val hasPose: Boolean
+)
+
+/**
+ * Newest disparity result of the selected stereo camera pair.
+ */
+data class StereoDepthInfo(
+    val baselineM: Float,
+    val focalPx: Float,
+    val width: Int,
+    val height: Int,
+    val validFraction: Float,   // Share of pixels with a unique match
+    val medianDepthM: Float,
+    val computeMs: Float,       // Rectification plus block matching
+    val droppedPairs: Long
+)
+
+/**
+ * Motion blur gate counters for analysis frames.
+ */
+data class MotionBlurStats(
+    val passed: Long,
+    val skipped: Long,          // Too blurred; dropped before rectification and stereo
+    val unscored: Long,         // No exposure time or gyro data; passed on
+    val meanBlurPx: Float,
+    val maxBlurPx: Float,
+    val thresholdPx: Float,
+    val savedCpuMs: Float       // Estimated processing time the skipped frames would have cost
+)
+
+/**
+ * Rolling-shutter correction counters for rectified tracking frames.
+ */
+data class RollingShutterStats(
+    val corrected: Long,
+    val uncorrected: Long,      // No readout skew, gyro data or camera-IMU extrinsics
+    val warped: Long,
+    val dropped: Long,
+    val avgComputeUs: Float,    // Per-row rotations plus the optional warp
+    val lastSkewMs: Float,      // Readout time from first to last row
+    val lastMaxAngleDeg: Float  // Rotation between the center and an edge row
+)
+
+/**
+ * On-demand snapshot counters.
+ */
+data class SnapshotStats(
+    val requested: Long,
+    val written: Long,
+    val failed: Long,           // Encode or file errors, or the stream stopped first
+    val rejected: Long,         // Too many snapshots pending
+    val hardware: Long,         // Written from a camera-encoded JPEG
+    val lastEncodeMs: Float,    // Software PNG encode
+    val lastWriteMs: Float,
+    val lastBytes: Long
+)
+
+/**
+ * Image quality of a camera's newest analysis frame, for health monitoring.
+ */
+data class FrameQuality(
+    val meanLuma: Float,            // 0..255
+    val darkClipRatio: Float,       // Share of crushed blacks
+    val brightClipRatio: Float,     // Share of blown-out highlights
+    val sharpness: Float,           // Laplacian variance; drops with blur and defocus
+    val noiseSigma: Float,          // Estimated noise in gray levels
+    val computeUs: Float,
+    val histogram: List<Float>      // Share of pixels per bin of 8 gray levels
+) {
+    companion object {
+        const val HISTOGRAM_BINS = 32
+    }
+}
+
 /**
  * Camera streaming statistics.
  */
@@ -70,7 +177,8 @@ data class CameraStats(
     val frameRateHz: Float,
     val latencyMs: Float,
     val frameCount: Long,
-    val droppedFrames: Long
+    val droppedFrames: Long,
+    val quality: FrameQuality? = null   // Only with frame quality enabled, for CPU analysis frames
 )
 
 /**
@@ -101,6 +209,19 @@ object CameraBridge {
     private external fun nativeIsCameraStreaming(cameraId: String): Boolean
     private external fun nativeGetCurrentCameraId(): String
     private external fun nativeGetActiveStreamCount(): Int
+    private external fun nativeGetCameraCalibration(cameraId: String): FloatArray
+    private external fun nativeSetStereoPair(cameraA: String, cameraB: String): Boolean
+    private external fun nativeGetStereoDepth(): FloatArray
+    private external fun nativeGetMotionBlurStats(): FloatArray
+    private external fun nativeSetMaxMotionBlur(maxBlurPx: Float)
+    private external fun nativeGetRollingShutterStats(): FloatArray
+    private external fun nativeSetRollingShutterWarp(enabled: Boolean)
+    private external fun nativeSetRectificationEnabled(enabled: Boolean)
+    private external fun nativeSetFrameQualityEnabled(enabled: Boolean)
+    private external fun nativeCorrectFeaturePoints(cameraId: String, points: FloatArray): FloatArray
+    private external fun nativeRequestSnapshot(cameraId: String, path: String): Boolean
+    private external fun nativeSetHardwareSnapshots(enabled: Boolean)
+    private external fun nativeGetSnapshotStats(): FloatArray
 
     /**
      * Enumerate all available cameras with metadata.
@@ -208,7 +329,188 @@ object CameraBridge {
             frameRateHz = data.getOrElse(0) { 0f },
             latencyMs = data.getOrElse(1) { 0f },
             frameCount = data.getOrElse(2) { 0f }.toLong(),
-            droppedFrames = data.getOrElse(3) { 0f }.toLong()
+            droppedFrames = data.getOrElse(3) { 0f }.toLong(),
+            quality = parseFrameQuality(data, 4)
+        )
+    }
+
+    /**
+     * Get the lens calibration of a camera.
+     * @param cameraId Camera ID from enumeration
+     * @return Calibration, or null if the camera is unknown
+     */
+    @Suppress("unused")  // Part of public API
+    fun getCalibration(cameraId: String): CameraCalibration? {
+        val data = nativeGetCameraCalibration(cameraId)
+        if (data.size < 23) {
+            return null
+        }
+        return CameraCalibration(
+            fx = data[0],
+            fy = data[1],
+            cx = data[2],
+            cy = data[3],
+            skew = data[4],
+            distortion = data.slice(5 until 10),
+            poseRotation = data.slice(10 until 14),
+            poseTranslation = data.slice(14 until 17),
+            poseReference = LensPoseReference.fromValue(data[17].toInt()),
+            activeArrayWidth = data[18].toInt(),
+            activeArrayHeight = data[19].toInt(),
+            hasIntrinsics = data[20] != 0f,
+            hasDistortion = data[21] != 0f,
+            hasPose = data[22] != 0f
+        )
+    }
+
+    /**
+     * Select the two cameras used for stereo depth (order doesn't matter).
+     * Both must be streaming with CPU analysis frames, i.e. tracking cameras.
+     * @return false if their calibration can't be rectified as a pair
+     */
+    @Suppress("unused")  // Part of public API
+    fun setStereoPair(cameraA: String, cameraB: String): Boolean =
+        nativeSetStereoPair(cameraA, cameraB)
+
+    /**
+     * Get the newest stereo depth result.
+     * @return Depth summary, or null before the first synchronized pair
+     */
+    @Suppress("unused")  // Part of public API
+    fun getStereoDepth(): StereoDepthInfo? {
+        val data = nativeGetStereoDepth()
+        if (data.size < 8) {
+            return null
+        }
+        return StereoDepthInfo(
+            baselineM = data[0],
+            focalPx = data[1],
+            width = data[2].toInt(),
+            height = data[3].toInt(),
+            validFraction = data[4],
+            medianDepthM = data[5],
+            computeMs = data[6],
+            droppedPairs = data[7].toLong()
+        )
+    }
+
+    /**
+     * Get motion blur gate statistics.
+     * @return Counters, or null before the processing pipeline is running
+     */
+    @Suppress("unused")  // Part of public API
+    fun getMotionBlurStats(): MotionBlurStats? {
+        val data = nativeGetMotionBlurStats()
+        if (data.size < 7) {
+            return null
+        }
+        return MotionBlurStats(
+            passed = data[0].toLong(),
+            skipped = data[1].toLong(),
+            unscored = data[2].toLong(),
+            meanBlurPx = data[3],
+            maxBlurPx = data[4],
+            thresholdPx = data[5],
+            savedCpuMs = data[6]
+        )
+    }
+
+    /**
+     * Set the blur (in pixels) above which analysis frames are skipped.
+     */
+    @Suppress("unused")  // Part of public API
+    fun setMaxMotionBlur(maxBlurPx: Float) = nativeSetMaxMotionBlur(maxBlurPx)
+
+    /**
+     * Get rolling-shutter correction statistics.
+     * @return Counters, or null before the processing pipeline is running
+     */
+    @Suppress("unused")  // Part of public API
+    fun getRollingShutterStats(): RollingShutterStats? {
+        val data = nativeGetRollingShutterStats()
+        if (data.size < 7) {
+            return null
+        }
+        return RollingShutterStats(
+            corrected = data[0].toLong(),
+            uncorrected = data[1].toLong(),
+            warped = data[2].toLong(),
+            dropped = data[3].toLong(),
+            avgComputeUs = data[4],
+            lastSkewMs = data[5],
+            lastMaxAngleDeg = data[6]
+        )
+    }
+
+    /**
+     * Also warp rectified frames to the center row's capture time (costs a remap per frame).
+     */
+    @Suppress("unused")  // Part of public API
+    fun setRollingShutterWarp(enabled: Boolean) = nativeSetRollingShutterWarp(enabled)
+
+    /**
+     * Rectify and rolling-shutter correct analysis frames (off by default). Feature point
+     * correction needs it on.
+     */
+    @Suppress("unused")  // Part of public API
+    fun setRectificationEnabled(enabled: Boolean) = nativeSetRectificationEnabled(enabled)
+
+    /**
+     * Compute image quality metrics for every analysis frame (off by default).
+     */
+    @Suppress("unused")  // Part of public API
+    fun setFrameQualityEnabled(enabled: Boolean) = nativeSetFrameQualityEnabled(enabled)
+
+    /**
+     * Correct feature points detected in the newest rectified frame of a camera for the
+     * rolling shutter.
+     * @param points Interleaved x, y pixel coordinates
+     * @return Corrected points, or null if the camera has no rectified frame yet (or the
+     *         array has an odd length)
+     */
+    @Suppress("unused")  // Part of public API
+    fun correctFeaturePoints(cameraId: String, points: FloatArray): FloatArray? {
+        val corrected = nativeCorrectFeaturePoints(cameraId, points)
+        return if (corrected.size == points.size) corrected else null
+    }
+
+    /**
+     * Write the next frame of a streaming camera to a file in the background. With hardware
+     * snapshots enabled this is a camera-encoded JPEG, otherwise a grayscale PNG of the next
+     * CPU analysis frame (tracking cameras only).
+     * @param path Destination; the file appears complete or not at all
+     * @return false if the camera isn't streaming, has no usable output or too many
+     *         snapshots are pending
+     */
+    @Suppress("unused")  // Part of public API
+    fun requestSnapshot(cameraId: String, path: String): Boolean = nativeRequestSnapshot(cameraId, path)
+
+    /**
+     * Give cameras a JPEG still output for snapshots, from their next preview start. Off by
+     * default: not every device supports the extra stream next to the analysis output.
+     */
+    @Suppress("unused")  // Part of public API
+    fun setHardwareSnapshots(enabled: Boolean) = nativeSetHardwareSnapshots(enabled)
+
+    /**
+     * Get snapshot statistics.
+     * @return Counters, or null before the processing pipeline is running
+     */
+    @Suppress("unused")  // Part of public API
+    fun getSnapshotStats(): SnapshotStats? {
+        val data = nativeGetSnapshotStats()
+        if (data.size < 8) {
+            return null
+        }
+        return SnapshotStats(
+            requested = data[0].toLong(),
+            written = data[1].toLong(),
+            failed = data[2].toLong(),
+            rejected = data[3].toLong(),
+            hardware = data[4].toLong(),
+            lastEncodeMs = data[5],
+            lastWriteMs = data[6],
+            lastBytes = data[7].toLong()
         )
     }
 
@@ -249,6 +551,22 @@ object CameraBridge {
     fun getDepthCameras(): List<CameraInfo> =
         enumerateCameras().filter { it.clusterType == CameraClusterType.DEPTH }
 
+    private fun parseFrameQuality(data: FloatArray, offset: Int): FrameQuality? {
+        val histogramOffset = offset + 6
+        if (data.size < histogramOffset + FrameQuality.HISTOGRAM_BINS) {
+            return null
+        }
+        return FrameQuality(
+            meanLuma = data[offset],
+            darkClipRatio = data[offset + 1],
+            brightClipRatio = data[offset + 2],
+            sharpness = data[offset + 3],
+            noiseSigma = data[offset + 4],
+            computeUs = data[offset + 5],
+            histogram = data.copyOfRange(histogramOffset, histogramOffset + FrameQuality.HISTOGRAM_BINS).toList()
+        )
+    }
+
     private fun parseCameraInfo(line: String): CameraInfo? {
         // Format: id|facing|clusterType|width|height|maxFps|isPhysical|physicalIds
         val parts = line.split("|")
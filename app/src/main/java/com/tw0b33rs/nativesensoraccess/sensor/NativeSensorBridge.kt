@@ -1,5 +1,6 @@
 package com.tw0b33rs.nativesensoraccess.sensor
 
+import android.os.ParcelFileDescriptor
 import com.tw0b33rs.nativesensoraccess.logging.SensorLogExtensions.logSensorDiscovery
 import com.tw0b33rs.nativesensoraccess.logging.SensorLogInfo
 import com.tw0b33rs.nativesensoraccess.logging.SensorLogger
@@ -22,6 +23,7 @@ object NativeSensorBridge {
     }
 
     // Native method declarations
+    private external fun nativePrepare(cacheDir: String, useCapabilityCache: Boolean)
     private external fun nativeInit()
     private external fun nativeStop()
     private external fun nativeGetAccelData(): FloatArray
@@ -31,6 +33,50 @@ object NativeSensorBridge {
     private external fun nativeEnumerateSensors(): String
     private external fun nativeSwitchSensors(accelHandle: Int, gyroHandle: Int)
     private external fun nativeIsRunning(): Boolean
+    private external fun nativeGetStartupTimings(): String
+    private external fun nativeGetPipelineStats(): String
+    private external fun nativeGetFrameDeadlineStats(): FloatArray
+    private external fun nativePredictPose(targetNs: Long): FloatArray
+    private external fun nativeGetFramePose(): FloatArray
+    private external fun nativeGetFusedState(): FloatArray
+    private external fun nativeSubmitPoseMeasurement(timestampNs: Long, pose: FloatArray): Boolean
+    private external fun nativeTriggerCapture(path: String): Boolean
+    private external fun nativeSetPreTriggerFrames(enabled: Boolean)
+    private external fun nativeGetPreTriggerStats(): FloatArray
+    private external fun nativeSetAnomalyThresholds(
+        shockMs2: Float, freeFallMs2: Float, accelRangeMs2: Float, gyroRangeRadS: Float
+    )
+    private external fun nativePollImuAnomalies(): String
+    private external fun nativeGetAnomalyCounts(): FloatArray
+    private external fun nativeStartMetrics(directory: String): Boolean
+    private external fun nativeStopMetrics()
+    private external fun nativeGetMetricSeries(): String
+    private external fun nativeQueryMetrics(
+        series: String, column: String, beginNs: Long, endNs: Long, windowNs: Long
+    ): FloatArray
+    private external fun nativeStartExport(path: String, compress: Boolean): Boolean
+    private external fun nativeStopExport(): Boolean
+    private external fun nativeGetExportStats(): FloatArray
+    private external fun nativeStartStreamServer(name: String): Boolean
+    private external fun nativeStopStreamServer()
+    private external fun nativeGetStreamServerStats(): FloatArray
+    private external fun nativeGetSharedImuRing(): Int
+    private external fun nativeListStreams(): String
+    private external fun nativeReadStream(streamId: Int): FloatArray
+
+    /**
+     * Start native subsystem initialization in the background.
+     * Call as early as possible (e.g. Activity.onCreate); returns immediately.
+     * @param cacheDir Directory for the persistent device-capability cache
+     * @param useCapabilityCache Set false to measure cold start without the cache
+     */
+    fun prepare(cacheDir: String, useCapabilityCache: Boolean = true) {
+        log.info("Preparing native subsystems", mapOf(
+            "cacheDir" to cacheDir,
+            "useCapabilityCache" to useCapabilityCache
+        ))
+        nativePrepare(cacheDir, useCapabilityCache)
+    }
 
     /**
      * Initialize and start IMU sensors at maximum hardware rate.
@@ -153,6 +199,420 @@ object NativeSensorBridge {
         }
     }
 
+    /**
+     * Get the native startup timing breakdown per subsystem.
+     * Subsystems start in parallel when the library is loaded.
+     */
+    fun getStartupTimings(): List<StartupTiming> {
+        val rawData = nativeGetStartupTimings()
+        if (rawData.isEmpty()) return emptyList()
+
+        return rawData.trim().split("\n").mapNotNull { line ->
+            val parts = line.split("|")
+            if (parts.size == 4) {
+                try {
+                    StartupTiming(
+                        name = parts[0],
+                        startOffsetMs = parts[1].toFloat(),
+                        durationMs = parts[2].toFloat(),
+                        ready = parts[3] == "1"
+                    )
+                } catch (e: Exception) {
+                    log.warn("Failed to parse startup timing: $line", throwable = e)
+                    null
+                }
+            } else {
+                null
+            }
+        }
+    }
+
+    /**
+     * Get per-node statistics of the native processing pipeline.
+     * Empty until the worker pool has started.
+     */
+    fun getPipelineStats(): List<PipelineNodeStats> {
+        val rawData = nativeGetPipelineStats()
+        if (rawData.isEmpty()) return emptyList()
+
+        return rawData.trim().split("\n").mapNotNull { line ->
+            val parts = line.split("|")
+            if (parts.size == 6) {
+                try {
+                    PipelineNodeStats(
+                        name = parts[0],
+                        processed = parts[1].toLong(),
+                        avgItemUs = parts[2].toFloat(),
+                        maxItemUs = parts[3].toFloat(),
+                        dropped = parts[4].toLong(),
+                        queued = parts[5].toLong()
+                    )
+                } catch (e: Exception) {
+                    log.warn("Failed to parse pipeline stats: $line", throwable = e)
+                    null
+                }
+            } else {
+                null
+            }
+        }
+    }
+
+    /**
+     * Get deadline statistics of the vsync-paced frame task (runs while IMU is started).
+     */
+    fun getFrameDeadlineStats(): FrameDeadlineStats {
+        val data = nativeGetFrameDeadlineStats()
+        return FrameDeadlineStats(
+            frames = data[0].toLong(),
+            misses = data[1].toLong(),
+            skipped = data[2].toLong(),
+            avgWorkUs = data[3],
+            workBudgetUs = data[4],
+            avgSlackUs = data[5],
+            avgWakeLateUs = data[6],
+            avgInputAgeUs = data[7],
+            vsyncPeriodMs = data[8]
+        )
+    }
+
+    /**
+     * Predict orientation at a target time (lock-free, constant time).
+     * @param targetNs Target in SystemClock.elapsedRealtimeNanos() timebase; 0 = now
+     */
+    fun predictPose(targetNs: Long = 0L): PredictedPose = nativePredictPose(targetNs).toPredictedPose()
+
+    /**
+     * Pose the frame task predicted for the upcoming display presentation.
+     */
+    fun getFramePose(): PredictedPose = nativeGetFramePose().toPredictedPose()
+
+    /**
+     * Latest state of the native error-state Kalman filter.
+     */
+    fun getFusedState(): FusedState {
+        val data = nativeGetFusedState()
+        return FusedState(
+            position = Triple(data[0], data[1], data[2]),
+            velocity = Triple(data[3], data[4], data[5]),
+            qw = data[6],
+            qx = data[7],
+            qy = data[8],
+            qz = data[9],
+            positionStdM = data[10],
+            orientationStdRad = data[11],
+            valid = data[12] != 0f
+        )
+    }
+
+    /**
+     * Feed a camera-derived world pose (visual odometry, marker tracking) into the filter.
+     * Late measurements are applied at their own timestamp.
+     * @param timestampNs Frame exposure time (CLOCK_BOOTTIME)
+     * @return false if the measurement queue is full
+     */
+    fun submitPoseMeasurement(
+        timestampNs: Long,
+        position: Triple<Float, Float, Float>,
+        orientation: FloatArray,
+        positionStdM: Float = 0.01f,
+        orientationStdRad: Float = 0.01f
+    ): Boolean {
+        require(orientation.size == 4) { "orientation must be [qw, qx, qy, qz]" }
+        val pose = floatArrayOf(
+            position.first, position.second, position.third,
+            orientation[0], orientation[1], orientation[2], orientation[3],
+            positionStdM, orientationStdRad
+        )
+        return nativeSubmitPoseMeasurement(timestampNs, pose)
+    }
+
+    /**
+     * Write the last 10 seconds of IMU samples and downscaled tracking-camera frames to a
+     * recording file in the background; streaming continues meanwhile.
+     * @return false if the previous capture is still being written
+     */
+    @Suppress("unused")  // Part of public API
+    fun triggerCapture(path: String): Boolean = nativeTriggerCapture(path)
+
+    /**
+     * Keep downscaled frames for pre-trigger captures (off by default; IMU history is
+     * always kept).
+     */
+    @Suppress("unused")  // Part of public API
+    fun setPreTriggerFrames(enabled: Boolean) = nativeSetPreTriggerFrames(enabled)
+
+    /**
+     * Get pre-trigger capture statistics.
+     * @return Counters, or null before the processing pipeline is running
+     */
+    @Suppress("unused")  // Part of public API
+    fun getPreTriggerStats(): PreTriggerStats? {
+        val data = nativeGetPreTriggerStats()
+        if (data.size < 9) {
+            return null
+        }
+        return PreTriggerStats(
+            triggers = data[0].toLong(),
+            rejected = data[1].toLong(),
+            written = data[2].toLong(),
+            failed = data[3].toLong(),
+            droppedFrames = data[4].toLong(),
+            lastImuSamples = data[5].toLong(),
+            lastFrames = data[6].toLong(),
+            lastBytes = data[7].toLong(),
+            lastDumpMs = data[8]
+        )
+    }
+
+    /**
+     * Set IMU anomaly thresholds. Shock and free fall are accel magnitudes in m/s²; the
+     * ranges are the sensors' full scale (0 if unknown, then only flat-topped peaks count
+     * as clipping).
+     */
+    @Suppress("unused")  // Part of public API
+    fun setAnomalyThresholds(
+        shockMs2: Float = 39.2f,
+        freeFallMs2: Float = 2.0f,
+        accelRangeMs2: Float = 0f,
+        gyroRangeRadS: Float = 0f
+    ) = nativeSetAnomalyThresholds(shockMs2, freeFallMs2, accelRangeMs2, gyroRangeRadS)
+
+    /**
+     * Take the IMU anomalies detected since the last call, oldest first.
+     */
+    @Suppress("unused")  // Part of public API
+    fun pollImuAnomalies(): List<ImuAnomaly> {
+        val rawData = nativePollImuAnomalies()
+        if (rawData.isEmpty()) {
+            return emptyList()
+        }
+        return rawData.trim().split("\n").mapNotNull { line ->
+            val parts = line.split("|")
+            if (parts.size != 5) {
+                return@mapNotNull null
+            }
+            try {
+                ImuAnomaly(
+                    type = ImuAnomaly.Type.entries.first { it.code == parts[0].toInt() },
+                    sensorType = parts[1].toInt(),
+                    timestampNs = parts[2].toLong(),
+                    durationNs = parts[3].toLong(),
+                    value = parts[4].toFloat()
+                )
+            } catch (e: Exception) {
+                log.warn("Failed to parse IMU anomaly: $line", throwable = e)
+                null
+            }
+        }
+    }
+
+    /**
+     * Get IMU anomaly counts since start.
+     */
+    @Suppress("unused")  // Part of public API
+    fun getAnomalyCounts(): ImuAnomalyCounts {
+        val data = nativeGetAnomalyCounts()
+        return ImuAnomalyCounts(
+            shocks = data[0].toLong(),
+            freeFalls = data[1].toLong(),
+            saturations = data[2].toLong(),
+            stuckAt = data[3].toLong(),
+            dropouts = data[4].toLong(),
+            droppedEvents = data[5].toLong()
+        )
+    }
+
+    /**
+     * Start recording per-frame camera metrics and every IMU sample into column files
+     * under [directory] (created if missing; its parent must exist). Series are
+     * "camera.<id>", "imu.accel" and "imu.gyro"; an existing recording there is continued.
+     * Replaces any running metrics session.
+     */
+    @Suppress("unused")  // Part of public API
+    fun startMetrics(directory: String): Boolean = nativeStartMetrics(directory)
+
+    /**
+     * Stop recording metrics; the column files are trimmed and closed.
+     */
+    @Suppress("unused")  // Part of public API
+    fun stopMetrics() = nativeStopMetrics()
+
+    /**
+     * List the series of the running metrics session.
+     */
+    @Suppress("unused")  // Part of public API
+    fun getMetricSeries(): List<MetricSeries> {
+        val rawData = nativeGetMetricSeries()
+        if (rawData.isEmpty()) {
+            return emptyList()
+        }
+        return rawData.trim().split("\n").mapNotNull { line ->
+            val parts = line.split("|")
+            if (parts.size != 4) {
+                return@mapNotNull null
+            }
+            MetricSeries(
+                name = parts[0],
+                rows = parts[1].toLongOrNull() ?: 0L,
+                rejected = parts[2].toLongOrNull() ?: 0L,
+                columns = parts[3].split(",")
+            )
+        }
+    }
+
+    /**
+     * Aggregate one metric column over [beginNs, endNs] (boot-time nanoseconds) in
+     * windows of [windowNs], or one window if [windowNs] is 0. Empty windows are skipped.
+     */
+    @Suppress("unused")  // Part of public API
+    fun queryMetrics(
+        series: String,
+        column: String,
+        beginNs: Long,
+        endNs: Long,
+        windowNs: Long = 0L
+    ): List<MetricWindow> {
+        val data = nativeQueryMetrics(series, column, beginNs, endNs, windowNs)
+        return (0 until data.size / 8).map { i ->
+            val o = i * 8
+            MetricWindow(
+                startNs = beginNs + (data[o].toDouble() * 1e6).toLong(),
+                count = data[o + 1].toLong(),
+                min = data[o + 2],
+                max = data[o + 3],
+                mean = data[o + 4],
+                p50 = data[o + 5],
+                p95 = data[o + 6],
+                p99 = data[o + 7]
+            )
+        }
+    }
+
+    /**
+     * Start exporting the session to an MCAP file at [path]: IMU samples, analysis frames
+     * (mono8) and camera calibration as ROS 2 messages, readable by rosbag2 and Foxglove.
+     * Chunks are LZ4-compressed if [compress]. Replaces any running export.
+     */
+    @Suppress("unused")  // Part of public API
+    fun startExport(path: String, compress: Boolean = true): Boolean = nativeStartExport(path, compress)
+
+    /**
+     * Finish the running export; the file appears at its path once complete.
+     * Returns false if there was none or writing failed.
+     */
+    @Suppress("unused")  // Part of public API
+    fun stopExport(): Boolean = nativeStopExport()
+
+    /**
+     * Counters of the running export, or of the last finished one.
+     */
+    @Suppress("unused")  // Part of public API
+    fun getExportStats(): ExportStats {
+        val data = nativeGetExportStats()
+        return ExportStats(
+            imuSamples = data[0].toLong(),
+            frames = data[1].toLong(),
+            droppedImu = data[2].toLong(),
+            droppedFrames = data[3].toLong(),
+            chunks = data[4].toLong(),
+            uncompressedMb = data[5],
+            writtenMb = data[6],
+            compressMs = data[7],
+            busyMs = data[8]
+        )
+    }
+
+    /**
+     * Serve live IMU samples and camera capture results over a Unix domain socket.
+     * [name] is a filesystem path, or an abstract socket name with a leading '@'
+     * (reachable from a desktop through `adb forward tcp:<port> localabstract:<name>`).
+     * Restarts the server if it is running.
+     */
+    @Suppress("unused")  // Part of public API
+    fun startStreamServer(name: String = "@nativesensor"): Boolean = nativeStartStreamServer(name)
+
+    /**
+     * Stop the stream server and disconnect its clients.
+     */
+    @Suppress("unused")  // Part of public API
+    fun stopStreamServer() = nativeStopStreamServer()
+
+    /**
+     * Counters of the stream server since it was started.
+     */
+    @Suppress("unused")  // Part of public API
+    fun getStreamServerStats(): StreamServerStats {
+        val data = nativeGetStreamServerStats()
+        return StreamServerStats(
+            clients = data[0].toInt(),
+            accepted = data[1].toLong(),
+            published = data[2].toLong(),
+            sent = data[3].toLong(),
+            dropped = data[4].toLong(),
+            ingestDropped = data[5].toLong(),
+            sentMb = data[6]
+        )
+    }
+
+    /**
+     * Shared-memory ring carrying every IMU sample, for other processes (tracking
+     * service, recorder, UI) to map instead of opening their own sensor queues.
+     * Created on the first call. The returned descriptor is a duplicate for
+     * handing over through binder and can only be mapped read-only; consumers
+     * read it with SharedRingReader (streaming/shared_ring.h), payloads are
+     * stream::ImuMessage.
+     */
+    @Suppress("unused")  // Part of public API
+    fun getSharedImuRing(): ParcelFileDescriptor? {
+        val fd = nativeGetSharedImuRing()
+        return if (fd >= 0) ParcelFileDescriptor.fromFd(fd) else null
+    }
+
+    /**
+     * Streams with a native latest-value mailbox (see [StreamIds]), with the
+     * number of values published to each so far.
+     */
+    @Suppress("unused")  // Part of public API
+    fun listStreams(): List<StreamInfo> {
+        val rawData = nativeListStreams()
+        if (rawData.isEmpty()) return emptyList()
+
+        return rawData.trim().split("\n").mapNotNull { line ->
+            val parts = line.split("|")
+            if (parts.size == 3) {
+                try {
+                    StreamInfo(
+                        id = parts[0].toInt(),
+                        name = parts[1],
+                        version = parts[2].toLong()
+                    )
+                } catch (e: Exception) {
+                    log.warn("Failed to parse stream info: $line", throwable = e)
+                    null
+                }
+            } else {
+                null
+            }
+        }
+    }
+
+    /**
+     * Newest value of a stream, lock-free on the native side; null until the
+     * stream has a value. The layout is per stream, see [StreamIds].
+     */
+    @Suppress("unused")  // Part of public API
+    fun readStream(streamId: Int): FloatArray? = nativeReadStream(streamId).takeIf { it.isNotEmpty() }
+
+    private fun FloatArray.toPredictedPose() = PredictedPose(
+        qw = this[0],
+        qx = this[1],
+        qy = this[2],
+        qz = this[3],
+        angularVelocity = Triple(this[4], this[5], this[6]),
+        horizonMs = this[7],
+        valid = this[8] != 0f
+    )
+
     /**
      * Switch to specific sensors by handle.
      * @param accelHandle Accelerometer handle from enumeration (-1 for default)
@@ -199,6 +659,24 @@ object NativeSensorBridge {
         )
     }
 
+    /**
+     * Log the native startup timing breakdown, including time to first IMU sample.
+     */
+    fun logStartupTimings() {
+        val timings = getStartupTimings()
+        if (timings.isEmpty()) return
+
+        SensorLogger.perf.table("Native Startup", timings.map { timing ->
+            timing.name to if (timing.durationMs >= 0f) {
+                "start +${"%.2f".format(timing.startOffsetMs)} ms, " +
+                    "took ${"%.2f".format(timing.durationMs)} ms" +
+                    if (timing.ready) "" else " (unavailable)"
+            } else {
+                "pending"
+            }
+        })
+    }
+
     /**
      * Convert SensorInfo to SensorLogInfo for logging
      */
@@ -59,3 +59,197 @@ data class ImuMetadata(
     val gyroFifoReserved: Int
 )
 
+
+/**
+ * Native subsystem startup timing (offsets relative to library load).
+ * Negative values mean the subsystem has not started/finished yet.
+ */
+data class StartupTiming(
+    val name: String,
+    val startOffsetMs: Float,
+    val durationMs: Float,
+    val ready: Boolean
+)
+
+/**
+ * Native processing pipeline node statistics.
+ */
+data class PipelineNodeStats(
+    val name: String,
+    val processed: Long,
+    val avgItemUs: Float,
+    val maxItemUs: Float,
+    val dropped: Long,
+    val queued: Long
+)
+
+/**
+ * Frame-deadline scheduling statistics of the vsync-paced native frame task.
+ */
+data class FrameDeadlineStats(
+    val frames: Long,
+    val misses: Long,
+    val skipped: Long,
+    val avgWorkUs: Float,
+    val workBudgetUs: Float,
+    val avgSlackUs: Float,
+    val avgWakeLateUs: Float,
+    val avgInputAgeUs: Float,
+    val vsyncPeriodMs: Float
+) {
+    val missRate: Float
+        get() = if (frames > 0) misses.toFloat() / frames else 0f
+}
+
+/**
+ * Pre-trigger ("last 10 seconds") capture counters.
+ */
+data class PreTriggerStats(
+    val triggers: Long,
+    val rejected: Long,         // Triggered while the previous window was still being written
+    val written: Long,
+    val failed: Long,
+    val droppedFrames: Long,    // Frame buffers all held by a running dump
+    val lastImuSamples: Long,
+    val lastFrames: Long,
+    val lastBytes: Long,
+    val lastDumpMs: Float
+)
+
+/**
+ * One anomaly detected on the IMU streams.
+ * [value] is the peak magnitude (shock, saturation), the minimum magnitude (free fall),
+ * the stuck x value, or the gap in milliseconds (dropout).
+ */
+data class ImuAnomaly(
+    val type: Type,
+    val sensorType: Int,
+    val timestampNs: Long,      // Start of the episode
+    val durationNs: Long,
+    val value: Float
+) {
+    enum class Type(val code: Int) {
+        SHOCK(1),
+        FREE_FALL(2),
+        SATURATION(3),
+        STUCK_AT(4),
+        DROPOUT(5)
+    }
+}
+
+/**
+ * IMU anomaly counts by type.
+ */
+data class ImuAnomalyCounts(
+    val shocks: Long,
+    val freeFalls: Long,
+    val saturations: Long,
+    val stuckAt: Long,
+    val dropouts: Long,
+    val droppedEvents: Long     // Events lost because nobody polled
+)
+
+/**
+ * One series of the native metrics store.
+ */
+data class MetricSeries(
+    val name: String,
+    val rows: Long,
+    val rejected: Long,         // Out-of-order rows
+    val columns: List<String>   // Columns queryMetrics aggregates
+)
+
+/**
+ * Aggregates of one metric column over one time window.
+ */
+data class MetricWindow(
+    val startNs: Long,
+    val count: Long,
+    val min: Float,
+    val max: Float,
+    val mean: Float,
+    val p50: Float,
+    val p95: Float,
+    val p99: Float
+)
+
+/**
+ * Counters of the native MCAP session exporter.
+ */
+data class ExportStats(
+    val imuSamples: Long,
+    val frames: Long,
+    val droppedImu: Long,       // Exporter fell behind
+    val droppedFrames: Long,
+    val chunks: Long,
+    val uncompressedMb: Float,
+    val writtenMb: Float,
+    val compressMs: Float,      // Total time spent compressing
+    val busyMs: Float           // Total exporter-thread time
+)
+
+/**
+ * Counters of the native sensor stream server.
+ */
+data class StreamServerStats(
+    val clients: Int,           // Connected now
+    val accepted: Long,
+    val published: Long,
+    val sent: Long,
+    val dropped: Long,          // Oldest messages dropped for slow clients
+    val ingestDropped: Long,    // Oldest messages dropped before the server thread
+    val sentMb: Float
+)
+
+/**
+ * A native latest-value stream and the number of values published to it.
+ */
+data class StreamInfo(
+    val id: Int,
+    val name: String,
+    val version: Long
+)
+
+/**
+ * Ids of the well-known native streams (common/mailbox_registry.h) and the
+ * layout of their values.
+ */
+object StreamIds {
+    const val ACCEL = 1             // [x, y, z, timestampMs]
+    const val GYRO = 2              // [x, y, z, timestampMs]
+    const val IMU_STATS = 3         // [accelHz, accelLatencyMs, gyroHz, gyroLatencyMs] over the last second
+    const val FUSED_STATE = 4       // As getFusedState()
+    const val FRAME_POSE = 5        // As getFramePose()
+    const val CAMERA_FRAME = 6      // [frameNumber, timestampMs, exposureMs, resultLatencyMs, width, height, format]
+    const val FRAME_IMU_SYNC = 7    // [frameNumber, timestampMs, exposureEndMs, samples, waitMs]
+}
+
+/**
+ * Orientation predicted by the native gyro predictor.
+ * Quaternion is relative to the orientation when the IMU started.
+ */
+data class PredictedPose(
+    val qw: Float,
+    val qx: Float,
+    val qy: Float,
+    val qz: Float,
+    val angularVelocity: Triple<Float, Float, Float>,
+    val horizonMs: Float,
+    val valid: Boolean
+)
+
+/**
+ * Visual-inertial fused device state (world frame, z up).
+ * Invalid until the filter has aligned to gravity.
+ */
+data class FusedState(
+    val position: Triple<Float, Float, Float>,
+    val velocity: Triple<Float, Float, Float>,
+    val qw: Float,
+    val qx: Float,
+    val qy: Float,
+    val qz: Float,
+    val positionStdM: Float,
+    val orientationStdRad: Float,
+    val valid: Boolean
+)
@@ -107,6 +107,7 @@ class SensorViewModel : ViewModel() {
 
     private var isPolling = false
     private var perfLogCounter = 0
+    private var startupTimingsLogged = false
     private var activeCameraSurface: Surface? = null
 
     // ==========================================================================
@@ -181,6 +182,18 @@ class SensorViewModel : ViewModel() {
         }
     }
 
+    private fun logFrameDeadlineStats() {
+        val stats = NativeSensorBridge.getFrameDeadlineStats()
+        if (stats.frames == 0L) return
+        perfLog.debug("Frame deadlines", mapOf(
+            "frames" to stats.frames,
+            "missRate" to "${"%.2f".format(stats.missRate * 100)} %",
+            "slack" to "${"%.0f".format(stats.avgSlackUs)} us",
+            "imuAge" to "${"%.0f".format(stats.avgInputAgeUs)} us",
+            "vsync" to "${"%.2f".format(stats.vsyncPeriodMs)} ms"
+        ))
+    }
+
     /**
      * Stop sensors and release resources.
      */
@@ -402,6 +415,11 @@ class SensorViewModel : ViewModel() {
                     perfLogCounter = 0
                     perfLog.logPerformanceStats("Accelerometer", sensorData.stats.accelFrequencyHz, sensorData.stats.accelLatencyMs)
                     perfLog.logPerformanceStats("Gyroscope", sensorData.stats.gyroFrequencyHz, sensorData.stats.gyroLatencyMs)
+                    logFrameDeadlineStats()
+                    if (!startupTimingsLogged) {
+                        NativeSensorBridge.logStartupTimings()
+                        startupTimingsLogged = true
+                    }
                 }
 
                 updateCameraStats()